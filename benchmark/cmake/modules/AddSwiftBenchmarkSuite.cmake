@@ -258,12 +258,63 @@ function (swift_benchmark_compile_archopts)
           ${bench_flags}
           "-parse-as-library"
           "-module-name" "${module_name}"
+          "-emit-module"
+          "-emit-module-path" "${objdir}/${module_name}.swiftmodule"
           "-I" "${objdir}"
           "-output-file-map" "${objdir}/${module_name}/outputmap.json"
           ${sources})
     endif()
   endforeach()
 
+  foreach(module_name_path ${SWIFT_CROSSMODULE_BENCHES})
+    get_filename_component(module_name "${module_name_path}" NAME)
+
+    # Each library of a cross-module benchmark is a separate module, so
+    # whether its code can be inlined or specialized into the benchmark
+    # depends on the configuration (see BENCHOPTS_SERIALIZED).
+    set(library_objects)
+    foreach(library_path ${${module_name}_libraries})
+      get_filename_component(library_name "${library_path}" NAME)
+      set(objfile "${objdir}/${library_name}.o")
+      set(swiftmodule "${objdir}/${library_name}.swiftmodule")
+      set(source "${srcdir}/${library_path}.swift")
+      list(APPEND library_objects "${objfile}")
+      add_custom_command(
+          OUTPUT "${objfile}"
+          DEPENDS
+            ${stdlib_dependencies} ${bench_library_objects} "${source}"
+          COMMAND "${SWIFT_EXEC}"
+          ${common_options}
+          "-parse-as-library"
+          ${bench_flags}
+          "-module-name" "${library_name}"
+          "-emit-module" "-emit-module-path" "${swiftmodule}"
+          "-I" "${objdir}"
+          "-o" "${objfile}"
+          "${source}")
+    endforeach()
+    list(APPEND SWIFT_BENCH_OBJFILES ${library_objects})
+
+    set(objfile "${objdir}/${module_name}.o")
+    set(swiftmodule "${objdir}/${module_name}.swiftmodule")
+    set(source "${srcdir}/${module_name_path}/${module_name}.swift")
+    list(APPEND SWIFT_BENCH_OBJFILES "${objfile}")
+    add_custom_command(
+        OUTPUT "${objfile}"
+        DEPENDS
+          ${stdlib_dependencies} ${bench_library_objects} ${library_objects}
+          "${source}"
+        COMMAND "${SWIFT_EXEC}"
+        ${common_options}
+        "-parse-as-library"
+        ${bench_flags}
+        "-module-name" "${module_name}"
+        "-emit-module" "-emit-module-path" "${swiftmodule}"
+        "-I" "${objdir}"
+        "-o" "${objfile}"
+        "${source}")
+  endforeach()
+
   set(module_name "main")
   set(source "${srcdir}/utils/${module_name}.swift")
   add_custom_command(
@@ -406,6 +457,29 @@ function(swift_benchmark_compile)
                   "--swift-repo" "${SWIFT_SOURCE_DIR}"
                   "--compare-script"
                   "${SWIFT_SOURCE_DIR}/benchmark/scripts/compare_perf_tests.py")
+
+      # Runs every benchmark in a process of its own, sharded over the CPUs
+      # in SWIFT_BENCHMARK_PERF_CPUS, and fails if a benchmark regressed
+      # significantly against the baseline in SWIFT_BENCHMARK_PERF_BASELINE_DIR.
+      # The first run records the baseline.
+      if(NOT SWIFT_BENCHMARK_PERF_BASELINE_DIR)
+        set(SWIFT_BENCHMARK_PERF_BASELINE_DIR
+            "${CMAKE_CURRENT_BINARY_DIR}/perf-baseline")
+      endif()
+      string(REPLACE ";" "," perf_cpus "${SWIFT_BENCHMARK_PERF_CPUS}")
+      set(perf_check_commands)
+      foreach(optset "O" "Onone")
+        list(APPEND perf_check_commands
+            COMMAND "${swift-bin-dir}/Benchmark_Driver" "check"
+                    "-o" "${optset}"
+                    "--cpus=${perf_cpus}"
+                    "--baseline-dir" "${SWIFT_BENCHMARK_PERF_BASELINE_DIR}"
+                    "--compare-script"
+                    "${SWIFT_SOURCE_DIR}/benchmark/scripts/compare_perf_tests.py")
+      endforeach()
+      add_custom_target("check-swift-benchmark-perf"
+          ${perf_check_commands}
+          DEPENDS "${executable_target}")
     endif()
   endforeach()
 endfunction()
@@ -0,0 +1,37 @@
+//===--- CrossModuleAccessors.swift ---------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Accesses properties and calls small methods of another module's types in a
+// hot loop. Compare the default configuration with _SERIALIZED to see the
+// effect of inlining them across the module boundary.
+import TestsUtils
+import CrossModuleAccessorsLib
+
+@inline(never)
+public func run_CrossModuleAccessors(_ N: Int) {
+  var particles: [Particle] = []
+  for i in 0..<100 {
+    particles.append(Particle(position: Vector(x: Double(i), y: 0),
+                              velocity: Vector(x: 0, y: 1)))
+  }
+  var total = 0.0
+  for _ in 0..<N * 100 {
+    for p in particles {
+      p.step()
+      total += p.position.lengthSquared - p.position.x * p.position.x
+    }
+  }
+  let steps = Double(N * 100)
+  CheckResults(particles[0].position.y == steps,
+               "Incorrect results in CrossModuleAccessors")
+  CheckResults(total > 0, "Incorrect results in CrossModuleAccessors")
+}
@@ -0,0 +1,47 @@
+//===--- CrossModuleAccessorsLib.swift ------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Small types whose properties and methods are used by CrossModuleAccessors.
+// Unless the module's SIL is serialized, every access from the benchmark is a
+// call.
+
+public struct Vector {
+  public var x: Double
+  public var y: Double
+
+  public init(x: Double, y: Double) {
+    self.x = x
+    self.y = y
+  }
+
+  public var lengthSquared: Double {
+    return x * x + y * y
+  }
+
+  public func adding(_ other: Vector) -> Vector {
+    return Vector(x: x + other.x, y: y + other.y)
+  }
+}
+
+public final class Particle {
+  public var position: Vector
+  public var velocity: Vector
+
+  public init(position: Vector, velocity: Vector) {
+    self.position = position
+    self.velocity = velocity
+  }
+
+  public func step() {
+    position = position.adding(velocity)
+  }
+}
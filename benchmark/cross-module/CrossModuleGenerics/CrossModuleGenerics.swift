@@ -0,0 +1,33 @@
+//===--- CrossModuleGenerics.swift ----------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Calls generic code of another module in a hot loop. Compare the default
+// configuration with _SERIALIZED to see the effect of specializing it across
+// the module boundary.
+import TestsUtils
+import CrossModuleGenericsLib
+
+@inline(never)
+public func run_CrossModuleGenerics(_ N: Int) {
+  var total = 0
+  for _ in 0..<N * 10 {
+    var acc = Accumulator<Int>()
+    for i in 0..<1000 {
+      acc.append(i)
+    }
+    total = total &+ acc.reduce(0) { $0 &+ $1 }
+    total = total &+ sum(0..<1000)
+    total = total &+ (maxElement([3, 1, 4, 1, 5, 9, 2, 6]) ?? 0)
+  }
+  CheckResults(total == N * 10 * (499500 * 2 + 9),
+               "Incorrect results in CrossModuleGenerics")
+}
@@ -0,0 +1,48 @@
+//===--- CrossModuleGenericsLib.swift -------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Generic code used by CrossModuleGenerics. The benchmark can only specialize
+// it if the module was compiled with its SIL serialized.
+
+public struct Accumulator<T> {
+  var values: [T] = []
+
+  public init() {}
+
+  public mutating func append(_ value: T) {
+    values.append(value)
+  }
+
+  public func reduce<R>(_ initial: R, _ combine: (R, T) -> R) -> R {
+    var result = initial
+    for value in values {
+      result = combine(result, value)
+    }
+    return result
+  }
+}
+
+public func sum<S : Sequence where S.Iterator.Element == Int>(_ s: S) -> Int {
+  var result = 0
+  for x in s {
+    result = result &+ x
+  }
+  return result
+}
+
+public func maxElement<T : Comparable>(_ a: [T]) -> T? {
+  guard var result = a.first else { return nil }
+  for x in a where x > result {
+    result = x
+  }
+  return result
+}
@@ -0,0 +1,33 @@
+//===--- MultiFileDispatch.swift ------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Calls protocol requirements and class methods declared in another file of
+// the same module. With whole-module optimization they can be devirtualized
+// and inlined; in the _SINGLEFILE configuration they cannot.
+import TestsUtils
+
+@inline(never)
+public func run_MultiFileDispatch(_ N: Int) {
+  let shapes = makeShapes()
+  let polygons: [Polygon] = [Triangle(), Polygon(sides: 4), Triangle()]
+  var total = 0.0
+  for _ in 0..<N * 1000 {
+    for s in shapes {
+      total += s.area
+    }
+    for p in polygons {
+      total += p.perimeter(1)
+    }
+  }
+  CheckResults(total == Double(N * 1000) * (50 * 4 + 50 * 3 + 10),
+               "Incorrect results in MultiFileDispatch")
+}
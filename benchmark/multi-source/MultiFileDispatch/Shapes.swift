@@ -0,0 +1,49 @@
+//===--- Shapes.swift -----------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+protocol Shape {
+  var area: Double { get }
+}
+
+struct Square : Shape {
+  var side: Double
+  var area: Double { return side * side }
+}
+
+struct Rectangle : Shape {
+  var width: Double
+  var height: Double
+  var area: Double { return width * height }
+}
+
+class Polygon {
+  var sides: Int
+  init(sides: Int) { self.sides = sides }
+  func perimeter(_ length: Double) -> Double { return Double(sides) * length }
+}
+
+final class Triangle : Polygon {
+  init() { super.init(sides: 3) }
+  override func perimeter(_ length: Double) -> Double { return 3 * length }
+}
+
+func makeShapes() -> [Shape] {
+  var shapes: [Shape] = []
+  for i in 0..<100 {
+    if i % 2 == 0 {
+      shapes.append(Square(side: 2))
+    } else {
+      shapes.append(Rectangle(width: 1, height: 3))
+    }
+  }
+  return shapes
+}
@@ -24,6 +24,10 @@ MAX = 4
 MEAN = 5
 SD = 6
 MEDIAN = 7
+# Optional columns, such as the ones of adaptive sampling (--ci-threshold)
+# and of --metrics, are found by the name in the header.
+MEDIAN_LO = "MEDIAN_LO"
+MEDIAN_HI = "MEDIAN_HI"
 
 HTML = """
 <!DOCTYPE html>
@@ -80,6 +84,9 @@ def main():
     new_results = {}
     old_max_results = {}
     new_max_results = {}
+    old_median_ci = {}
+    new_median_ci = {}
+    noise_list = set()
     ratio_list = {}
     delta_list = {}
     unknown_list = {}
@@ -107,6 +114,9 @@ def main():
                         help='Name of the old branch', default="OLD_MIN")
     parser.add_argument('--delta-threshold',
                         help='delta threshold', default="0.05")
+    parser.add_argument('--fail-on-regression',
+                        help='Exit with status 1 if any test regressed',
+                        action='store_true')
 
     args = parser.parse_args()
 
@@ -122,7 +132,10 @@ def main():
     RATIO_MIN = 1 - float(args.delta_threshold)
     RATIO_MAX = 1 + float(args.delta_threshold)
 
+    old_columns = {}
     for row in old_data:
+        if row and row[0] == "#":
+            old_columns = header_columns(row)
         if (len(row) > 7 and row[MIN].isdigit()):
             if row[TESTNAME] in old_results:
                 if old_results[row[TESTNAME]] > int(row[MIN]):
@@ -132,8 +145,12 @@ def main():
             else:
                 old_results[row[TESTNAME]] = int(row[MIN])
                 old_max_results[row[TESTNAME]] = int(row[MAX])
+            add_median_ci(old_median_ci, row, old_columns)
 
+    new_columns = {}
     for row in new_data:
+        if row and row[0] == "#":
+            new_columns = header_columns(row)
         if (len(row) > 7 and row[MIN].isdigit()):
             if row[TESTNAME] in new_results:
                 if int(new_results[row[TESTNAME]]) > int(row[MIN]):
@@ -143,6 +160,7 @@ def main():
             else:
                 new_results[row[TESTNAME]] = int(row[MIN])
                 new_max_results[row[TESTNAME]] = int(row[MAX])
+            add_median_ci(new_median_ci, row, new_columns)
 
     ratio_total = 0
     for key in new_results.keys():
@@ -152,7 +170,15 @@ def main():
             delta = (((float(new_results[key]+0.001) /
                       (old_results[key]+0.001)) - 1) * 100)
             delta_list[key] = round(delta, 2)
-            if ((old_results[key] < new_results[key] and
+            if key in old_median_ci and key in new_median_ci:
+                # Both runs sampled adaptively: the change is only significant
+                # if the confidence intervals of the medians are disjoint.
+                (old_lo, old_hi) = old_median_ci[key]
+                (new_lo, new_hi) = new_median_ci[key]
+                if old_lo <= new_hi and new_lo <= old_hi:
+                    noise_list.add(key)
+                unknown_list[key] = ""
+            elif ((old_results[key] < new_results[key] and
                 new_results[key] < old_max_results[key]) or
                 (new_results[key] < old_results[key] and
                     old_results[key] < new_max_results[key])):
@@ -163,7 +189,8 @@ def main():
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
-     normal_perf_list) = sort_ratio_list(ratio_list, args.changes_only)
+     normal_perf_list) = sort_ratio_list(ratio_list, args.changes_only,
+                                         noise_list)
 
     """
     Create markdown formatted table
@@ -251,7 +278,8 @@ def main():
             """
             html_data = convert_to_html(ratio_list, old_results, new_results,
                                         delta_list, unknown_list, old_branch,
-                                        new_branch, args.changes_only)
+                                        new_branch, args.changes_only,
+                                        noise_list)
 
             if args.output:
                 write_to_file(args.output, html_data)
@@ -265,17 +293,52 @@ def main():
             print("{0} is unknown format.".format(args.format))
             sys.exit(1)
 
+    # Regressions within the noise of adaptively sampled runs are not in
+    # decreased_perf_list.
+    if args.fail_on_regression and decreased_perf_list:
+        return 1
+
+
+def header_columns(row):
+    """
+    Map the column names of a header row, without units, to their index.
+    """
+    return dict((name.split("(")[0], i) for i, name in enumerate(row))
+
+
+def add_median_ci(median_ci, row, columns):
+    """
+    Record the confidence interval of the median of a row, widening the
+    interval of earlier rows of the same test.
+    """
+    if MEDIAN_LO not in columns or MEDIAN_HI not in columns:
+        return
+    lo_index = columns[MEDIAN_LO]
+    hi_index = columns[MEDIAN_HI]
+    if len(row) <= max(lo_index, hi_index) or not row[lo_index].isdigit():
+        return
+    lo = int(row[lo_index])
+    hi = int(row[hi_index])
+    if row[TESTNAME] in median_ci:
+        (old_lo, old_hi) = median_ci[row[TESTNAME]]
+        lo = min(lo, old_lo)
+        hi = max(hi, old_hi)
+    median_ci[row[TESTNAME]] = (lo, hi)
+
 
 def convert_to_html(ratio_list, old_results, new_results, delta_list,
-                    unknown_list, old_branch, new_branch, changes_only):
+                    unknown_list, old_branch, new_branch, changes_only,
+                    noise_list):
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
-     normal_perf_list) = sort_ratio_list(ratio_list, changes_only)
+     normal_perf_list) = sort_ratio_list(ratio_list, changes_only, noise_list)
 
     html_rows = ""
     for key in complete_perf_list:
-        if ratio_list[key] < RATIO_MIN:
+        if key in noise_list:
+            color = "black"
+        elif ratio_list[key] < RATIO_MIN:
             color = "red"
         elif ratio_list[key] > RATIO_MAX:
             color = "green"
@@ -316,9 +379,10 @@ def write_to_file(file_name, data):
     file.close
 
 
-def sort_ratio_list(ratio_list, changes_only=False):
+def sort_ratio_list(ratio_list, changes_only=False, noise_list=()):
     """
-    Return 3 sorted list improvement, regression and normal.
+    Return 3 sorted list improvement, regression and normal. Tests in
+    noise_list are normal regardless of their ratio.
     """
     decreased_perf_list = []
     increased_perf_list = []
@@ -326,7 +390,9 @@ def sort_ratio_list(ratio_list, changes_only=False):
     normal_perf_list = {}
 
     for key, v in sorted(ratio_list.items(), key=lambda x: x[1]):
-        if ratio_list[key] < RATIO_MIN:
+        if key in noise_list:
+            normal_perf_list[key] = v
+        elif ratio_list[key] < RATIO_MIN:
             decreased_perf_list.append(key)
         elif ratio_list[key] > RATIO_MAX:
             increased_perf_list.append(key)
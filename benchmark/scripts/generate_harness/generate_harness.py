@@ -24,6 +24,7 @@ script_dir = os.path.dirname(os.path.realpath(__file__))
 perf_dir = os.path.realpath(os.path.join(script_dir, '../..'))
 single_source_dir = os.path.join(perf_dir, 'single-source')
 multi_source_dir = os.path.join(perf_dir, 'multi-source')
+cross_module_dir = os.path.join(perf_dir, 'cross-module')
 
 template_map = {
     'CMakeLists.txt_template': os.path.join(perf_dir, 'CMakeLists.txt'),
@@ -56,29 +57,54 @@ if __name__ == '__main__':
     else:
         multisource_benches = []
 
+    # CMakeList cross-module
+    class CrossModuleBench(object):
+
+        def __init__(self, path):
+            # <name>.swift contains the benchmark; every other file is a
+            # separate library module it imports.
+            self.name = os.path.basename(path)
+            self.libraries = sorted(
+                [x.split('.')[0] for x in os.listdir(path)
+                 if x.endswith('.swift') and x != self.name + '.swift'])
+    if os.path.isdir(cross_module_dir):
+        crossmodule_benches = [
+            CrossModuleBench(os.path.join(cross_module_dir, x))
+            for x in os.listdir(cross_module_dir)
+            if os.path.isdir(os.path.join(cross_module_dir, x))
+        ]
+    else:
+        crossmodule_benches = []
+
     # main.swift imports
-    imports = sorted(tests + [msb.name for msb in multisource_benches])
+    imports = sorted(tests + [msb.name for msb in multisource_benches] +
+                     [cmb.name for cmb in crossmodule_benches])
 
     # main.swift run functions
-    def get_run_funcs(filepath):
+    def get_run_funcs(filepath, prefix='run_'):
         content = open(filepath).read()
-        matches = re.findall(r'func run_(.*?)\(', content)
+        matches = re.findall(r'func ' + prefix + r'(.*?)\(', content)
         return filter(lambda x: x not in ignored_run_funcs, matches)
 
-    def find_run_funcs(dirs):
+    def find_run_funcs(dirs, prefix='run_'):
         ret_run_funcs = []
         for d in dirs:
             for root, _, files in os.walk(d):
                 for name in filter(lambda x: x.endswith('.swift'), files):
-                    run_funcs = get_run_funcs(os.path.join(root, name))
+                    run_funcs = get_run_funcs(os.path.join(root, name),
+                                              prefix)
                     ret_run_funcs.extend(run_funcs)
         return ret_run_funcs
+    bench_dirs = [single_source_dir, multi_source_dir, cross_module_dir]
     run_funcs = sorted(
-        [(x, x)
-         for x in find_run_funcs([single_source_dir, multi_source_dir])],
+        [(x, x) for x in find_run_funcs(bench_dirs)],
         key=lambda x: x[0]
     )
 
+    # main.swift concurrent run functions, which take a thread count
+    concurrent_run_funcs = sorted(
+        find_run_funcs(bench_dirs, prefix='runConcurrent_'))
+
     # Replace originals with files generated from templates
     for template_file in template_map:
         template_path = os.path.join(script_dir, template_file)
@@ -87,6 +113,8 @@ if __name__ == '__main__':
         open(template_map[template_file], 'w').write(
             template.render(tests=tests,
                             multisource_benches=multisource_benches,
+                            crossmodule_benches=crossmodule_benches,
                             imports=imports,
-                            run_funcs=run_funcs)
+                            run_funcs=run_funcs,
+                            concurrent_run_funcs=concurrent_run_funcs)
         )
@@ -0,0 +1,55 @@
+//===--- DictionaryLookup.swift -------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Dictionary lookup benchmarks with integer keys, which hash with the cheap
+// multiply mixer. The aligned keys differ only in their high bits, like
+// pointers, and would all collide if the hash weren't mixed.
+import TestsUtils
+
+@inline(never)
+func lookupAll(_ dict: [Int: Int], _ keys: [Int], _ N: Int) -> Int {
+  var sum = 0
+  for _ in 1...N {
+    for k in keys {
+      sum = sum &+ dict[k]!
+    }
+  }
+  return sum
+}
+
+func makeDictionary(_ keys: [Int]) -> [Int: Int] {
+  var dict = [Int: Int](minimumCapacity: keys.count)
+  for (i, k) in keys.enumerated() {
+    dict[k] = i
+  }
+  return dict
+}
+
+let size = 5000
+
+@inline(never)
+public func run_DictionaryLookupInt(_ N: Int) {
+  let keys = Array(0..<size)
+  let dict = makeDictionary(keys)
+  let sum = lookupAll(dict, keys, 20*N)
+  CheckResults(sum == 20 * N * (size * (size - 1) / 2),
+               "Incorrect results in DictionaryLookupInt")
+}
+
+@inline(never)
+public func run_DictionaryLookupAlignedInt(_ N: Int) {
+  let keys = (0..<size).map { $0 << 12 }
+  let dict = makeDictionary(keys)
+  let sum = lookupAll(dict, keys, 20*N)
+  CheckResults(sum == 20 * N * (size * (size - 1) / 2),
+               "Incorrect results in DictionaryLookupAlignedInt")
+}
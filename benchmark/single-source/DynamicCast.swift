@@ -0,0 +1,69 @@
+//===--- DynamicCast.swift ------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of repeated dynamic casts from Any to
+// protocol existentials, between the same few pairs of types.
+import TestsUtils
+
+protocol Weighted {
+  var weight: Int { get }
+}
+
+protocol Named {
+  var name: String { get }
+}
+
+struct Apple : Weighted, Named {
+  var weight: Int { return 3 }
+  var name: String { return "apple" }
+}
+
+struct Brick : Weighted {
+  var weight: Int { return 5 }
+}
+
+final class Cloud : Named {
+  var name: String { return "cloud" }
+}
+
+@inline(never)
+func totalWeight(_ values: [Any]) -> Int {
+  var s = 0
+  for value in values {
+    if let w = value as? Weighted {
+      s += w.weight
+    }
+    if value is protocol<Weighted, Named> {
+      s += 1
+    }
+  }
+  return s
+}
+
+@inline(never)
+public func run_DynamicCastToProtocol(_ N: Int) {
+  var values: [Any] = []
+  for i in 0..<300 {
+    switch i % 4 {
+    case 0: values.append(Apple())
+    case 1: values.append(Brick())
+    case 2: values.append(Cloud())
+    default: values.append(i)
+    }
+  }
+
+  var s = 0
+  for _ in 0..<N {
+    s = totalWeight(values)
+  }
+  CheckResults(s == 75 * (3 + 5 + 1), "Incorrect results in DynamicCastToProtocol")
+}
@@ -0,0 +1,53 @@
+//===--- EmptyCollectionContention.swift ----------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test copies empty arrays on several threads at once. Every empty array
+// shares the same storage object, so this measures how much the threads
+// contend on its reference count.
+import TestsUtils
+
+let EmptyCollectionThreads = 4
+
+@inline(never)
+func countElements(_ a: [Int]) -> Int {
+  return a.count
+}
+
+@inline(never)
+func copyEmptyArrays(_ n: Int) -> Int {
+  var s = 0
+  for _ in 0..<n {
+    let a: [Int] = []
+    let b = a
+    s += countElements(a) + countElements(b) + 1
+  }
+  return s
+}
+
+@inline(never)
+public func run_EmptyArrayCopyConcurrent(_ N: Int) {
+  var Results = [Int](repeating: 0, count: EmptyCollectionThreads)
+  Results.withUnsafeMutableBufferPointer { results in
+    runConcurrently(EmptyCollectionThreads) { t in
+      var s = 0
+      for _ in 0..<N {
+        s += copyEmptyArrays(10000)
+      }
+      results[t] = s
+    }
+  }
+
+  for s in Results {
+    CheckResults(s == N * 10000,
+                 "Incorrect results in EmptyArrayCopyConcurrent")
+  }
+}
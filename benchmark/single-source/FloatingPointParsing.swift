@@ -0,0 +1,51 @@
+//===--- FloatingPointParsing.swift ---------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of parsing floating-point values from
+// strings like the ones found in CSV files.
+import TestsUtils
+
+func makeNumberStrings() -> [String] {
+  SRand()
+  var strings: [String] = []
+  for i in 0..<500 {
+    let value = Double(Random() % 10000000) / 1000
+    switch i % 4 {
+    case 0: strings.append(String(value))
+    case 1: strings.append(String(-value))
+    case 2: strings.append(String(Random() % 100000))
+    default: strings.append(String(value) + "e-7")
+    }
+  }
+  return strings
+}
+
+@inline(never)
+func parseAll(_ strings: [String]) -> Int {
+  var parsed = 0
+  for string in strings {
+    if Double(string) != nil {
+      parsed += 1
+    }
+  }
+  return parsed
+}
+
+@inline(never)
+public func run_DoubleFromString(_ N: Int) {
+  let strings = makeNumberStrings()
+  var parsed = 0
+  for _ in 0..<N {
+    parsed = parseAll(strings)
+  }
+  CheckResults(parsed == strings.count, "Incorrect results in DoubleFromString")
+}
@@ -0,0 +1,125 @@
+//===--- FloatingPointPrinting.swift --------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// This test checks the performance of converting floating-point values to
+// strings, over random bit patterns and the edge cases around them.
+//
+// debugDescription prints the shortest digits that round-trip. description
+// rounds to 15 digits (6 for Float), so a random Double, which almost never
+// has a shorter representation, still goes through printf: comparing
+// DoubleDescription with DoubleDebugDescription compares the two paths.
+import TestsUtils
+
+let edgeCaseDoubles: [Double] = [
+  0.0, -0.0, 1.0, -1.0, 0.1, 0.1 + 0.2, 1.0 / 3.0, 1e-5, 1.25e-5, 0.0001,
+  1e15, 1e16, 1e17, 123456789012345678.0, 9007199254740993.0,
+  Double.greatestFiniteMagnitude, Double.leastNormalMagnitude,
+  Double.leastNonzeroMagnitude, 2.2250738585072009e-308,
+]
+
+func randomDouble() -> Double {
+  while true {
+    // Random() produces 32 random bits.
+    let bits = UInt64(Random()) << 32 | UInt64(Random())
+    let value = Double(bitPattern: bits)
+    if value.isFinite {
+      return value
+    }
+  }
+}
+
+func makeDoubles() -> [Double] {
+  SRand()
+  var values = edgeCaseDoubles
+  for _ in 0..<500 {
+    values.append(randomDouble())
+  }
+  return values
+}
+
+/// Values that look like measurements: few significant digits.
+func makeShortDoubles() -> [Double] {
+  SRand()
+  var values = edgeCaseDoubles
+  for _ in 0..<500 {
+    values.append(Double(Random() % 100000) / 100)
+  }
+  return values
+}
+
+@inline(never)
+func totalLength(_ values: [Double], debug: Bool) -> Int {
+  var length = 0
+  for value in values {
+    length += (debug ? value.debugDescription : value.description)
+      .utf8.count
+  }
+  return length
+}
+
+@inline(never)
+func totalLength(_ values: [Float], debug: Bool) -> Int {
+  var length = 0
+  for value in values {
+    length += (debug ? value.debugDescription : value.description)
+      .utf8.count
+  }
+  return length
+}
+
+@inline(never)
+public func run_DoubleDescription(_ N: Int) {
+  let values = makeDoubles()
+  var length = 0
+  for _ in 0..<N {
+    length = totalLength(values, debug: false)
+  }
+  CheckResults(length > 0, "Incorrect results in DoubleDescription")
+}
+
+@inline(never)
+public func run_DoubleDescriptionShort(_ N: Int) {
+  let values = makeShortDoubles()
+  var length = 0
+  for _ in 0..<N {
+    length = totalLength(values, debug: false)
+  }
+  CheckResults(length > 0, "Incorrect results in DoubleDescriptionShort")
+}
+
+@inline(never)
+public func run_DoubleDebugDescription(_ N: Int) {
+  let values = makeDoubles()
+  for value in values {
+    CheckResults(Double(value.debugDescription) == value,
+                 "Incorrect results in DoubleDebugDescription")
+  }
+  var length = 0
+  for _ in 0..<N {
+    length = totalLength(values, debug: true)
+  }
+  CheckResults(length > 0, "Incorrect results in DoubleDebugDescription")
+}
+
+@inline(never)
+public func run_FloatDebugDescription(_ N: Int) {
+  let values = makeDoubles().map { Float($0) }.filter { $0.isFinite }
+  for value in values {
+    CheckResults(Float(value.debugDescription) == value,
+                 "Incorrect results in FloatDebugDescription")
+  }
+  var length = 0
+  for _ in 0..<N {
+    length = totalLength(values, debug: true)
+  }
+  CheckResults(length > 0, "Incorrect results in FloatDebugDescription")
+}
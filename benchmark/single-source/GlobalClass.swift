@@ -31,3 +31,21 @@ public func run_GlobalClass(_ N: Int) {
     x = a.f(x)
   }
 }
+
+// Measure the cost of a lazily initialized global's accessor once the
+// global has been initialized. The read is kept out of line so that the
+// accessor call isn't hoisted out of the loop.
+let b = A()
+var y = 0
+@inline(never)
+func readGlobal() -> A {
+  return b
+}
+
+@inline(never)
+public func run_GlobalClassAccessor(_ N: Int) {
+  for _ in 0..<N*1000 {
+    y = readGlobal().f(y)
+  }
+  CheckResults(y > 0, "Incorrect results in GlobalClassAccessor")
+}
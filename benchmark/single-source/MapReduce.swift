@@ -25,3 +25,15 @@ public func run_MapReduce(_ N: Int) {
   CheckResults(c != 0, "IncorrectResults in MapReduce")
 }
 
+
+@inline(never)
+public func run_MapReduceChained(_ N: Int) {
+  let numbers = [Int](0..<1000)
+
+  var c = 0
+  for _ in 1...N*100 {
+    c += numbers.map({$0 &+ 5}).map({$0 &* 3})
+                .filter({$0 % 2 == 0}).filter({$0 % 3 == 0}).count
+  }
+  CheckResults(c == 500 * N * 100, "IncorrectResults in MapReduceChained")
+}
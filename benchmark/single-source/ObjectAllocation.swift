@@ -133,3 +133,65 @@ public func run_ObjectAllocation(_ N: Int) {
                "Incorrect results in testArray")
 }
 
+
+let ConcurrentAllocationThreads = 4
+
+@inline(never)
+public func run_ObjectAllocationConcurrent(_ N: Int) {
+  var Results = [Int](repeating: 0, count: ConcurrentAllocationThreads)
+  Results.withUnsafeMutableBufferPointer { results in
+    runConcurrently(ConcurrentAllocationThreads) { t in
+      var s = 0
+      for _ in 0..<N {
+        s = testSingleObject() + testTree() + testList() + testArray()
+      }
+      results[t] = s
+    }
+  }
+
+  for s in Results {
+    CheckResults(s == 499500 + 90000 + 48375 + 3000,
+                 "Incorrect results in ObjectAllocationConcurrent")
+  }
+}
+
+@inline(never)
+func makeList(_ n: Int) -> LinkedNode? {
+  var l: LinkedNode? = nil
+  for i in 0..<n {
+    l = LinkedNode(i, l)
+  }
+  return l
+}
+
+// Each thread frees the lists allocated by its neighbour, so objects are
+// routinely released on a different thread than the one that created them.
+@inline(never)
+public func run_ObjectAllocationCrossThread(_ N: Int) {
+  let Threads = ConcurrentAllocationThreads
+  let ListLength = 250
+  var Lists = [LinkedNode?](repeating: nil, count: Threads)
+  var Results = [Int](repeating: 0, count: Threads)
+
+  for _ in 0..<N {
+    Lists.withUnsafeMutableBufferPointer { lists in
+      runConcurrently(Threads) { t in
+        lists[t] = makeList(ListLength)
+      }
+    }
+    Lists.withUnsafeMutableBufferPointer { lists in
+      Results.withUnsafeMutableBufferPointer { results in
+        runConcurrently(Threads) { t in
+          let other = (t + 1) % Threads
+          results[t] = addAllInts(lists[other]!)
+          lists[other] = nil
+        }
+      }
+    }
+  }
+
+  for s in Results {
+    CheckResults(s == ListLength * (ListLength - 1) / 2,
+                 "Incorrect results in ObjectAllocationCrossThread")
+  }
+}
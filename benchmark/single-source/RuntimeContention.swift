@@ -0,0 +1,147 @@
+//===--- RuntimeContention.swift ------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// These tests run the same runtime operation on several threads at once to
+// measure how the runtime scales under contention. Each thread performs N
+// iterations, so with perfect scaling the time per iteration does not change
+// with the number of threads.
+import TestsUtils
+
+final class SharedObject {
+  var value = 1
+}
+
+@inline(never)
+func retainAndRead(_ o: SharedObject) -> Int {
+  let copy = o
+  return copy.value
+}
+
+// Every thread retains and releases the same object.
+@inline(never)
+public func runConcurrent_RetainReleaseShared(_ N: Int, _ threads: Int) {
+  let shared = SharedObject()
+  var Results = [Int](repeating: 0, count: threads)
+  Results.withUnsafeMutableBufferPointer { results in
+    runConcurrently(threads) { t in
+      var s = 0
+      for _ in 0..<N * 10000 {
+        s += retainAndRead(shared)
+      }
+      results[t] = s
+    }
+  }
+
+  for s in Results {
+    CheckResults(s == N * 10000,
+                 "Incorrect results in RetainReleaseShared")
+  }
+}
+
+protocol NotConformedTo {}
+class CastSource {}
+class CastTarget {}
+
+@inline(never)
+func castsToProtocol(_ x: Any) -> Bool {
+  return x is NotConformedTo
+}
+
+@inline(never)
+func castsToClass(_ x: Any) -> Bool {
+  return x is CastTarget
+}
+
+// Every thread looks up the same missing protocol conformance.
+@inline(never)
+public func runConcurrent_ConformsToProtocolMiss(_ N: Int, _ threads: Int) {
+  let values: [Any] = [CastSource(), 1, "", 1.0]
+  var Results = [Int](repeating: 0, count: threads)
+  Results.withUnsafeMutableBufferPointer { results in
+    runConcurrently(threads) { t in
+      var s = 0
+      for _ in 0..<N * 1000 {
+        for v in values where !castsToProtocol(v) {
+          s += 1
+        }
+      }
+      results[t] = s
+    }
+  }
+
+  for s in Results {
+    CheckResults(s == N * 1000 * 4,
+                 "Incorrect results in ConformsToProtocolMiss")
+  }
+}
+
+// Every thread performs the same failing class cast.
+@inline(never)
+public func runConcurrent_DynamicCastMiss(_ N: Int, _ threads: Int) {
+  let values: [Any] = [CastSource(), 1, "", 1.0]
+  var Results = [Int](repeating: 0, count: threads)
+  Results.withUnsafeMutableBufferPointer { results in
+    runConcurrently(threads) { t in
+      var s = 0
+      for _ in 0..<N * 1000 {
+        for v in values where !castsToClass(v) {
+          s += 1
+        }
+      }
+      results[t] = s
+    }
+  }
+
+  for s in Results {
+    CheckResults(s == N * 1000 * 4,
+                 "Incorrect results in DynamicCastMiss")
+  }
+}
+
+protocol Nestable {
+  static func nested() -> Nestable.Type
+}
+
+struct Leaf : Nestable {
+  static func nested() -> Nestable.Type { return Nest<Leaf>.self }
+}
+
+struct Nest<T : Nestable> : Nestable {
+  static func nested() -> Nestable.Type { return Nest<Nest<T>>.self }
+}
+
+/// The most deeply nested type instantiated so far. Every run starts from
+/// here so that its metadata has not been instantiated yet.
+var NestFrontier: Nestable.Type = Leaf.self
+
+// Every thread instantiates the same, not yet instantiated, generic metadata.
+@inline(never)
+public func runConcurrent_GenericMetadataInstantiation(_ N: Int,
+                                                       _ threads: Int) {
+  let start = NestFrontier
+  var Results = [Nestable.Type](repeating: start, count: threads)
+  Results.withUnsafeMutableBufferPointer { results in
+    runConcurrently(threads) { t in
+      var type = start
+      for _ in 0..<N * 10 {
+        type = type.nested()
+      }
+      results[t] = type
+    }
+  }
+
+  for type in Results {
+    CheckResults(type == Results[0],
+                 "Incorrect results in GenericMetadataInstantiation")
+  }
+  NestFrontier = Results[0]
+}
@@ -214,3 +214,32 @@ public func run_SetIntersect_OfObjects(_ N: Int) {
   }
   sink(&and)
 }
+
+@inline(never)
+public func run_SetOfStrings(_ N: Int) {
+  let words = [
+    "/api/v1/users", "/api/v1/orders", "/api/v2/search", "/static/app.js",
+    "/healthz", "/metrics", "café", "crème brûlée", "naïve", "Zürich",
+    "façade", "señor",
+  ]
+  var keys: [String] = []
+  for i in 0 ..< 32 {
+    for word in words {
+      keys.append(word + String(i))
+    }
+  }
+
+  for _ in 0 ..< N {
+    for _ in 0 ..< 10 {
+      let set = Set(keys)
+      var count = 0
+      for key in keys {
+        if set.contains(key) {
+          count += 1
+        }
+      }
+      CheckResults(set.count == keys.count && count == keys.count,
+        "IncorrectResults in SetOfStrings")
+    }
+  }
+}
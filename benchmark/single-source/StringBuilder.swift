@@ -28,3 +28,21 @@ public func run_StringBuilder(_ N: Int) {
   }
 }
 
+
+@inline(never)
+func buildStringWithIntegers() -> String {
+  var sb = ""
+  for i in 0..<64 {
+    sb += String(i)
+    sb += String(i * i)
+  }
+  return sb
+}
+
+@inline(never)
+public func run_StringBuilderWithIntegers(_ N: Int) {
+  for _ in 1...500*N {
+    let s = buildStringWithIntegers()
+    CheckResults(s.utf8.count == 328, "IncorrectResults in StringBuilderWithIntegers")
+  }
+}
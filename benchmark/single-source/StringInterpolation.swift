@@ -40,3 +40,18 @@ public func run_StringInterpolation(_ N: Int) {
   }
 }
 
+
+@inline(never)
+public func run_StringInterpolationSmall(_ N: Int) {
+  let reps = 100
+  let refResult = 1777
+
+  for _ in 1...100*N {
+    var result = 0
+    for i in 1...reps {
+      let s = "\(i) + \(i & 7) = \(i + (i & 7)) (0x\(String(i, radix: 16)))"
+      result = result &+ s.utf16.count
+    }
+    CheckResults(result == refResult, "IncorrectResults in StringInterpolationSmall: \(result) != \(refResult)")
+  }
+}
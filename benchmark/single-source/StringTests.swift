@@ -82,3 +82,85 @@ public func run_StringEqualPointerComparison(_ N: Int) {
     }
   }
 }
+
+let routeStrings = [
+  "/api/v1/users", "/api/v1/users/profile", "/api/v1/Users", "/api/v1/orders",
+  "/api/v1/orders/history", "/api/v2/users", "/api/v2/search", "/static/app.js",
+  "/static/app.css", "/healthz", "/metrics", "/api/v1/users/settings",
+]
+
+let latin1Strings = [
+  "café", "Café", "cafe", "crème brûlée", "crème", "naïve", "naive",
+  "Ångström", "façade", "fiancé", "fiancée", "señor", "über", "Zürich",
+]
+
+@inline(never)
+func countOrderedPairs(_ strings: [String]) -> Int {
+  var count = 0
+  for lhs in strings {
+    for rhs in strings {
+      if lhs < rhs {
+        count += 1
+      }
+    }
+  }
+  return count
+}
+
+public func run_StringCompareASCII(_ N: Int) {
+  let pairs = routeStrings.count * (routeStrings.count - 1) / 2
+  for _ in 0 ..< N {
+    for _ in 0 ..< 1_000 {
+      CheckResults(countOrderedPairs(routeStrings) == pairs,
+        "IncorrectResults in StringCompareASCII")
+    }
+  }
+}
+
+public func run_StringCompareLatin1(_ N: Int) {
+  let pairs = latin1Strings.count * (latin1Strings.count - 1) / 2
+  for _ in 0 ..< N {
+    for _ in 0 ..< 1_000 {
+      CheckResults(countOrderedPairs(latin1Strings) == pairs,
+        "IncorrectResults in StringCompareLatin1")
+    }
+  }
+}
+
+let shortKeyText = "GET /api/v1/users 200 OK id=42 status=active region=eu-west"
+
+public func run_StringFromCharacters(_ N: Int) {
+  let characters = Array(shortKeyText.characters)
+  let spaces = characters.filter { $0 == " " }.count
+  for _ in 0 ..< N {
+    for _ in 0 ..< 1_000 {
+      var count = 0
+      for c in characters {
+        if String(c) == " " {
+          count += 1
+        }
+      }
+      CheckResults(count == spaces, "IncorrectResults in StringFromCharacters")
+    }
+  }
+}
+
+public func run_StringShortKeyLookup(_ N: Int) {
+  // Build the keys at run time, the way keys split out of input are, rather
+  // than from literals.
+  let keys = shortKeyText.characters.split(separator: " ").map { String($0) }
+  var indices = [String: Int]()
+  for (i, key) in keys.enumerated() {
+    indices[key] = i
+  }
+  for _ in 0 ..< N {
+    for _ in 0 ..< 1_000 {
+      var total = 0
+      for key in keys {
+        total += indices[key]!
+      }
+      CheckResults(total == keys.count * (keys.count - 1) / 2,
+        "IncorrectResults in StringShortKeyLookup")
+    }
+  }
+}
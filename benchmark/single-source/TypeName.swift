@@ -0,0 +1,41 @@
+//===--- TypeName.swift ---------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Ask for the names of the same few types over and over, which is what
+// logging the type of a value on a hot path ends up doing.
+import TestsUtils
+
+struct Point<T> {
+  var x: T
+  var y: T
+}
+
+class Node {}
+
+@inline(never)
+func getTypes() -> [Any.Type] {
+  return [Int.self, Point<Double>.self, Node.self, [String: Node].self,
+          ((Int) -> Point<Int>).self]
+}
+
+@inline(never)
+public func run_TypeName(_ N: Int) {
+  let types = getTypes()
+  var length = 0
+  for _ in 1...1000*N {
+    for type in types {
+      length += _typeName(type, qualified: false).utf8.count
+    }
+  }
+  CheckResults(length == 1000*N*63,
+               "Incorrect results in TypeName: \(length)")
+}
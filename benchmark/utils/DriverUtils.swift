@@ -20,6 +20,12 @@ struct BenchResults {
   var mean: UInt64 = 0
   var sd: UInt64 = 0
   var median: UInt64 = 0
+  /// The 95% confidence interval of the median, if sampling was adaptive.
+  var medianCI: (UInt64, UInt64)? = nil
+  /// The number of samples discarded as outliers.
+  var outliers: UInt64 = 0
+  /// The memory used by the benchmark, if requested.
+  var memory: MemoryMetrics? = nil
   init() {}
   init(delim: String, sampleCount: UInt64, min: UInt64, max: UInt64, mean: UInt64, sd: UInt64, median: UInt64) {
     self.delim = delim
@@ -41,7 +47,55 @@ struct BenchResults {
 
 extension BenchResults : CustomStringConvertible {
   var description: String {
-     return "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     var result = "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     if let (lo, hi) = medianCI {
+       result += "\(delim)\(lo)\(delim)\(hi)\(delim)\(outliers)"
+     }
+     if let m = memory {
+       result += "\(delim)\(m.maxRSSDelta)\(delim)\(m.peakHeapDelta)\(delim)\(m.heapBlocksDelta)"
+     }
+     return result
+  }
+}
+
+/// The memory use of the process at one point in time.
+struct MemorySnapshot {
+  var maxRSS: UInt64
+  var heapBlocks: UInt64
+  var heapBytes: UInt64
+  var peakHeapBytes: UInt64
+
+  init() {
+    var usage = rusage()
+    getrusage(RUSAGE_SELF, &usage)
+    // Darwin reports the resident set size in bytes.
+    maxRSS = UInt64(usage.ru_maxrss)
+
+    var stats = malloc_statistics_t()
+    malloc_zone_statistics(nil, &stats)
+    heapBlocks = UInt64(stats.blocks_in_use)
+    heapBytes = UInt64(stats.size_in_use)
+    peakHeapBytes = UInt64(stats.max_size_in_use)
+  }
+}
+
+/// The memory used while a benchmark ran. The peaks are process-wide high
+/// water marks, so they only grow if the benchmark exceeds the peaks of
+/// everything that ran before it in the same process.
+struct MemoryMetrics {
+  /// The growth of the peak resident set size, in bytes.
+  var maxRSSDelta: UInt64
+  /// The growth of the peak heap size over the heap size at the start, in
+  /// bytes.
+  var peakHeapDelta: UInt64
+  /// The number of heap blocks allocated and not freed.
+  var heapBlocksDelta: Int64
+
+  init(from before: MemorySnapshot, to after: MemorySnapshot) {
+    maxRSSDelta = after.maxRSS - before.maxRSS
+    peakHeapDelta = after.peakHeapBytes > before.heapBytes ?
+      after.peakHeapBytes - before.heapBytes : 0
+    heapBlocksDelta = Int64(after.heapBlocks) - Int64(before.heapBlocks)
   }
 }
 
@@ -50,6 +104,9 @@ struct Test {
   let index: Int
   let f: (Int) -> ()
   var run: Bool
+  /// For concurrent tests, the name of the benchmark and the number of
+  /// threads it runs on.
+  var concurrent: (name: String, threads: Int)? = nil
   init(name: String, n: Int, f: (Int) -> ()) {
     self.name = name
     self.index = n
@@ -60,6 +117,9 @@ struct Test {
 
 public var precommitTests: [String : (Int) -> ()] = [:]
 public var otherTests: [String : (Int) -> ()] = [:]
+/// Benchmarks that take the number of threads to run on as their second
+/// argument. Each thread performs the given number of iterations.
+public var concurrentTests: [String : (Int, Int) -> ()] = [:]
 
 enum TestAction {
   case Run
@@ -85,9 +145,29 @@ struct TestConfig {
   /// iterations.
   var fixedNumIters: UInt = 0
 
-  /// The number of samples we should take of each test.
+  /// The number of samples we should take of each test. With adaptive
+  /// sampling, this is the minimum number of samples.
   var numSamples: Int = 1
 
+  /// If set, samples are taken until the 95% confidence interval of the
+  /// median is within this many percent of the median.
+  var ciThreshold: Double? = nil
+
+  /// The maximum number of samples adaptive sampling takes of each test.
+  var maxSamples: Int = 200
+
+  /// The number of seconds adaptive sampling may spend on each test.
+  var timeBudget: Double = 30
+
+  /// The number of initial samples adaptive sampling discards as warm-up.
+  var numWarmups: Int = 1
+
+  /// Should we report the memory used by each test?
+  var collectMetrics: Bool = false
+
+  /// The thread counts each concurrent test runs with.
+  var threadCounts: [Int] = [1, 2, 4, 8]
+
   /// Is verbose output enabled?
   var verbose: Bool = false
 
@@ -103,7 +183,9 @@ struct TestConfig {
 
   mutating func processArguments() -> TestAction {
     let validOptions=["--iter-scale", "--num-samples", "--num-iters",
-      "--verbose", "--delim", "--run-all", "--list", "--sleep"]
+      "--verbose", "--delim", "--run-all", "--list", "--sleep",
+      "--ci-threshold", "--max-samples", "--time-budget", "--num-warmups",
+      "--metrics", "--num-threads"]
     let maybeBenchArgs: Arguments? = parseArgs(validOptions)
     if maybeBenchArgs == nil {
       return .Fail("Failed to parse arguments")
@@ -129,6 +211,26 @@ struct TestConfig {
       numSamples = Int(x)!
     }
 
+    if let x = benchArgs.optionalArgsMap["--ci-threshold"] {
+      if x.isEmpty { return .Fail("--ci-threshold requires a value") }
+      ciThreshold = Double(x)!
+    }
+
+    if let x = benchArgs.optionalArgsMap["--max-samples"] {
+      if x.isEmpty { return .Fail("--max-samples requires a value") }
+      maxSamples = Int(x)!
+    }
+
+    if let x = benchArgs.optionalArgsMap["--time-budget"] {
+      if x.isEmpty { return .Fail("--time-budget requires a value") }
+      timeBudget = Double(x)!
+    }
+
+    if let x = benchArgs.optionalArgsMap["--num-warmups"] {
+      if x.isEmpty { return .Fail("--num-warmups requires a value") }
+      numWarmups = Int(x)!
+    }
+
     if let _ = benchArgs.optionalArgsMap["--verbose"] {
       verbose = true
       print("Verbose")
@@ -139,6 +241,18 @@ struct TestConfig {
       delim = x
     }
 
+    if let x = benchArgs.optionalArgsMap["--num-threads"] {
+      let counts = x.characters.split(separator: ",").map { Int(String($0)) }
+      if counts.isEmpty || counts.contains({ $0 == nil || $0! < 1 }) {
+        return .Fail("--num-threads requires a list of positive integers")
+      }
+      threadCounts = counts.map { $0! }
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--metrics"] {
+      collectMetrics = true
+    }
+
     if let _ = benchArgs.optionalArgsMap["--run-all"] {
       onlyPrecommit = false
     }
@@ -169,13 +283,25 @@ struct TestConfig {
       tests.append(Test(name: benchName, n: i, f: otherTests[benchName]!))
       i += 1
     }
+    for benchName in concurrentTests.keys.sorted() {
+      let f = concurrentTests[benchName]!
+      for threads in threadCounts {
+        var test = Test(name: "\(benchName)_T\(threads)", n: i,
+                        f: { f($0, threads) })
+        test.concurrent = (benchName, threads)
+        tests.append(test)
+        i += 1
+      }
+    }
     for i in 0..<tests.count {
       if onlyPrecommit && precommitTests[tests[i].name] == nil {
         tests[i].run = false
       }
+      // A concurrent test is selected by its name for all thread counts.
       if !filters.isEmpty &&
          !filters.contains(String(tests[i].index)) &&
-         !filters.contains(tests[i].name) {
+         !filters.contains(tests[i].name) &&
+         !filters.contains(tests[i].concurrent?.name ?? "") {
         tests[i].run = false
       }
     }
@@ -215,6 +341,35 @@ func internalMedian(_ inputs: [UInt64]) -> UInt64 {
   return inputs.sorted()[inputs.count / 2]
 }
 
+/// Returns the distribution-free 95% confidence interval of the median of
+/// the sorted, non-empty samples.
+func internalMedianCI(_ sorted: [UInt64]) -> (UInt64, UInt64) {
+  let n = Double(sorted.count)
+  let spread = 1.96 * sqrt(n) / 2
+  // The bounds are order statistics; their 1-based ranks are clamped to the
+  // samples we have, which only widens the interval.
+  let lo = max(Int(floor(n / 2 - spread)), 1)
+  let hi = min(Int(ceil(n / 2 + spread)) + 1, sorted.count)
+  return (sorted[lo - 1], sorted[hi - 1])
+}
+
+/// Removes the samples outside Tukey's fences, i.e. more than 1.5
+/// interquartile ranges beyond the quartiles, from the sorted samples.
+/// Returns the number of removed samples.
+func internalRemoveOutliers(_ sorted: inout [UInt64]) -> Int {
+  if sorted.count < 4 {
+    return 0
+  }
+  let q1 = Double(sorted[sorted.count / 4])
+  let q3 = Double(sorted[sorted.count * 3 / 4])
+  let lowFence = q1 - 1.5 * (q3 - q1)
+  let highFence = q3 + 1.5 * (q3 - q1)
+  let kept = sorted.filter { Double($0) >= lowFence && Double($0) <= highFence }
+  let removed = sorted.count - kept.count
+  sorted = kept
+  return removed
+}
+
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
 
 @_silgen_name("swift_leaks_startTrackingObjects")
@@ -229,6 +384,13 @@ class SampleRunner {
   init() {
     mach_timebase_info(&info)
   }
+  func now() -> UInt64 {
+    return mach_absolute_time()
+  }
+  func nanoseconds(since start_ticks: UInt64) -> UInt64 {
+    let elapsed_ticks = mach_absolute_time() - start_ticks
+    return elapsed_ticks * UInt64(info.numer) / UInt64(info.denom)
+  }
   func run(_ name: String, fn: (Int) -> Void, num_iters: UInt) -> UInt64 {
     // Start the timer.
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
@@ -249,40 +411,108 @@ class SampleRunner {
   }
 }
 
-/// Invoke the benchmark entry point and return the run time in milliseconds.
-func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResults {
+/// Run the benchmark once, scaled to take about a second, and return the run
+/// time of one iteration in microseconds.
+func runSample(_ sampler: SampleRunner, _ name: String, _ fn: (Int) -> Void,
+               _ c: TestConfig) -> UInt64 {
+  let time_per_sample: UInt64 = 1_000_000_000 * UInt64(c.iterationScale)
+
+  var scale : UInt
+  var elapsed_time : UInt64 = 0
+  if c.fixedNumIters == 0 {
+    elapsed_time = sampler.run(name, fn: fn, num_iters: 1)
+    scale = UInt(time_per_sample / elapsed_time)
+  } else {
+    // Compute the scaling factor if a fixed c.fixedNumIters is not specified.
+    scale = c.fixedNumIters
+  }
 
-  var samples = [UInt64](repeating: 0, count: c.numSamples)
+  // Rerun the test with the computed scale factor.
+  if scale > 1 {
+    if c.verbose {
+      print("    Measuring with scale \(scale).")
+    }
+    elapsed_time = sampler.run(name, fn: fn, num_iters: scale)
+  } else {
+    scale = 1
+  }
+  // save result in microseconds or k-ticks
+  return elapsed_time / UInt64(scale) / 1000
+}
+
+/// Sample the benchmark until the confidence interval of the median is
+/// narrower than c.ciThreshold percent, the time budget is exhausted, or
+/// c.maxSamples samples were taken. Outliers are excluded from the results.
+func runBenchAdaptive(_ name: String, _ fn: (Int) -> Void,
+                      _ c: TestConfig) -> BenchResults {
+  let threshold = c.ciThreshold!
+  let minSamples = max(c.numSamples, 5)
+  let budget = UInt64(c.timeBudget * 1_000_000_000)
 
   if c.verbose {
-    print("Running \(name) for \(c.numSamples) samples.")
+    print("Running \(name) until the median is within \(threshold)%.")
   }
 
   let sampler = SampleRunner()
-  for s in 0..<c.numSamples {
-    let time_per_sample: UInt64 = 1_000_000_000 * UInt64(c.iterationScale)
+  let start_ticks = sampler.now()
+  for w in 0..<c.numWarmups {
+    let warmup = runSample(sampler, name, fn, c)
+    if c.verbose {
+      print("    Warm-up \(w),\(warmup)")
+    }
+  }
 
-    var scale : UInt
-    var elapsed_time : UInt64 = 0
-    if c.fixedNumIters == 0 {
-      elapsed_time = sampler.run(name, fn: fn, num_iters: 1)
-      scale = UInt(time_per_sample / elapsed_time)
-    } else {
-      // Compute the scaling factor if a fixed c.fixedNumIters is not specified.
-      scale = c.fixedNumIters
+  var samples = [UInt64]()
+  var kept = [UInt64]()
+  var outliers = 0
+  while samples.count < max(c.maxSamples, 1) {
+    let sample = runSample(sampler, name, fn, c)
+    if c.verbose {
+      print("    Sample \(samples.count),\(sample)")
     }
+    samples.append(sample)
 
-    // Rerun the test with the computed scale factor.
-    if scale > 1 {
+    kept = samples.sorted()
+    outliers = internalRemoveOutliers(&kept)
+    if samples.count < minSamples {
+      continue
+    }
+    let (lo, hi) = internalMedianCI(kept)
+    if Double(hi - lo) / 2 <= Double(internalMedian(kept)) * threshold / 100 {
+      break
+    }
+    if sampler.nanoseconds(since: start_ticks) >= budget {
       if c.verbose {
-        print("    Measuring with scale \(scale).")
+        print("    Time budget exhausted.")
       }
-      elapsed_time = sampler.run(name, fn: fn, num_iters: scale)
-    } else {
-      scale = 1
+      break
     }
-    // save result in microseconds or k-ticks
-    samples[s] = elapsed_time / UInt64(scale) / 1000
+  }
+
+  let (mean, sd) = internalMeanSD(kept)
+  var results = BenchResults(delim: c.delim, sampleCount: UInt64(kept.count),
+                             min: kept.min()!, max: kept.max()!,
+                             mean: mean, sd: sd, median: internalMedian(kept))
+  results.medianCI = internalMedianCI(kept)
+  results.outliers = UInt64(outliers)
+  return results
+}
+
+/// Invoke the benchmark entry point and return the run time in milliseconds.
+func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResults {
+  if c.ciThreshold != nil {
+    return runBenchAdaptive(name, fn, c)
+  }
+
+  var samples = [UInt64](repeating: 0, count: c.numSamples)
+
+  if c.verbose {
+    print("Running \(name) for \(c.numSamples) samples.")
+  }
+
+  let sampler = SampleRunner()
+  for s in 0..<c.numSamples {
+    samples[s] = runSample(sampler, name, fn, c)
     if c.verbose {
       print("    Sample \(s),\(samples[s])")
     }
@@ -300,7 +530,15 @@ func printRunInfo(_ c: TestConfig) {
   if c.verbose {
     print("--- CONFIG ---")
     print("NumSamples: \(c.numSamples)")
+    if let threshold = c.ciThreshold {
+      print("CIThreshold: \(threshold)%")
+      print("MaxSamples: \(c.maxSamples)")
+      print("TimeBudget: \(c.timeBudget)s")
+      print("NumWarmups: \(c.numWarmups)")
+    }
     print("Verbose: \(c.verbose)")
+    print("Metrics: \(c.collectMetrics)")
+    print("ThreadCounts: \(c.threadCounts)")
     print("IterScale: \(c.iterationScale)")
     if c.fixedNumIters != 0 {
       print("FixedIters: \(c.fixedNumIters)")
@@ -320,9 +558,18 @@ func printRunInfo(_ c: TestConfig) {
 
 func runBenchmarks(_ c: TestConfig) {
   let units = "us"
-  print("#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))")
+  var header = "#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))"
+  if c.ciThreshold != nil {
+    header += "\(c.delim)MEDIAN_LO(\(units))\(c.delim)MEDIAN_HI(\(units))\(c.delim)OUTLIERS"
+  }
+  if c.collectMetrics {
+    header += "\(c.delim)MAX_RSS_DELTA(B)\(c.delim)PEAK_HEAP_DELTA(B)\(c.delim)HEAP_BLOCKS_DELTA"
+  }
+  print(header)
   var SumBenchResults = BenchResults()
   SumBenchResults.sampleCount = 0
+  // The median time per iteration of the concurrent tests, by thread count.
+  var scaling = [(name: String, medians: [(threads: Int, median: UInt64)])]()
 
   for t in c.tests {
     if !t.run {
@@ -331,10 +578,21 @@ func runBenchmarks(_ c: TestConfig) {
     let BenchIndex = t.index
     let BenchName = t.name
     let BenchFunc = t.f
-    let results = runBench(BenchName, BenchFunc, c)
+    let before: MemorySnapshot? = c.collectMetrics ? MemorySnapshot() : nil
+    var results = runBench(BenchName, BenchFunc, c)
+    if let before = before {
+      results.memory = MemoryMetrics(from: before, to: MemorySnapshot())
+    }
     print("\(BenchIndex)\(c.delim)\(BenchName)\(c.delim)\(results.description)")
     fflush(stdout)
 
+    if let (name, threads) = t.concurrent {
+      if scaling.last?.name != name {
+        scaling.append((name, []))
+      }
+      scaling[scaling.count - 1].medians.append((threads, results.median))
+    }
+
     SumBenchResults.min += results.min
     SumBenchResults.max += results.max
     SumBenchResults.mean += results.mean
@@ -347,6 +605,22 @@ func runBenchmarks(_ c: TestConfig) {
 
   print("")
   print("Totals\(c.delim)\(SumBenchResults.description)")
+
+  // Every thread runs the given iterations, so the throughput with T threads
+  // relative to the first thread count is T * median(first) / median(T).
+  if !scaling.isEmpty {
+    print("")
+  }
+  for (name, medians) in scaling {
+    let base = medians[0]
+    var line = "Scaling\(c.delim)\(name)"
+    for (threads, median) in medians {
+      let speedup = Double(threads) * Double(max(base.median, 1)) /
+        (Double(base.threads) * Double(max(median, 1)))
+      line += "\(c.delim)\(threads):\(Double(Int(speedup * 100)) / 100)"
+    }
+    print(line)
+  }
 }
 
 public func main() {
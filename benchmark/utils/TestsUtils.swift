@@ -63,3 +63,35 @@ struct MyStruct : SomeProtocol {
 }
 public func someProtocolFactory() -> SomeProtocol { return MyStruct() }
 
+
+internal final class ConcurrentBlockContext {
+  let body: (Int) -> Void
+  let index: Int
+
+  init(_ body: (Int) -> Void, _ index: Int) {
+    self.body = body
+    self.index = index
+  }
+}
+
+/// Run `body` on `threadCount` threads at once, passing each thread its index
+/// in `0..<threadCount`, and return once all of them have finished.
+public func runConcurrently(_ threadCount: Int, _ body: (Int) -> Void) {
+  var threads: [pthread_t?] = []
+  for i in 0..<threadCount {
+    // The context is handed to the thread at +1; the thread releases it.
+    let context = Unmanaged.passRetained(ConcurrentBlockContext(body, i))
+    var thread: pthread_t? = nil
+    let result = pthread_create(&thread, nil, {
+      let context = Unmanaged<ConcurrentBlockContext>
+        .fromOpaque($0!).takeRetainedValue()
+      context.body(context.index)
+      return nil
+    }, context.toOpaque())
+    CheckResults(result == 0, "pthread_create failed")
+    threads.append(thread)
+  }
+  for thread in threads {
+    pthread_join(thread!, nil)
+  }
+}
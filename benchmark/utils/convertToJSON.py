@@ -56,6 +56,10 @@
 #         }
 #     ]
 # }
+#
+# Columns after MEDIAN, such as the ones printed with --metrics or
+# --ci-threshold, are added to "Info" under their name from the header, e.g.
+#   "Info": {"MAX_RSS_DELTA": 4096, "PEAK_HEAP_DELTA": 1024, ...}
 
 import json
 import re
@@ -69,13 +73,20 @@ SCORERE = re.compile(r"(\d+),[ \t]*(\w+),[ \t]*([\d.]+),[ \t]*([\d.]+)")
 TOTALRE = re.compile(r"()(Totals),[ \t]*([\d.]+),[ \t]*([\d.]+)")
 KEYGROUP = 2
 VALGROUP = 4
+# The index of the first optional column.
+EXTRACOLUMN = 8
 
 if __name__ == "__main__":
     data = {}
     data['Tests'] = []
     data['Machine'] = {}
     data['Run'] = {}
+    columns = []
     for line in sys.stdin:
+        if line.startswith('#'):
+            columns = [name.strip().split('(')[0]
+                       for name in line.split(',')]
+            continue
         m = SCORERE.match(line)
         if not m:
             m = TOTALRE.match(line)
@@ -84,6 +95,9 @@ if __name__ == "__main__":
         test = {}
         test['Data'] = [int(m.group(VALGROUP))]
         test['Info'] = {}
+        values = line.strip().split(',')
+        for i in range(EXTRACOLUMN, min(len(values), len(columns))):
+            test['Info'][columns[i]] = int(values[i])
         test['Name'] = [m.group(KEYGROUP)]
         data['Tests'].append(test)
     print(json.dumps(data, sort_keys=True, indent=4))
@@ -37,16 +37,23 @@ import Calculator
 import CaptureProp
 import Chars
 import ClassArrayGetter
+import CrossModuleAccessors
+import CrossModuleGenerics
 import DeadArray
 import DictTest
 import DictTest2
 import DictTest3
 import DictionaryBridge
 import DictionaryLiteral
+import DictionaryLookup
 import DictionaryRemove
 import DictionarySwap
+import DynamicCast
+import EmptyCollectionContention
 import ErrorHandling
 import Fibonacci
+import FloatingPointParsing
+import FloatingPointPrinting
 import GlobalClass
 import Hanoi
 import Hash
@@ -58,6 +65,7 @@ import MapReduce
 import Memset
 import MonteCarloE
 import MonteCarloPi
+import MultiFileDispatch
 import NSDictionaryCastToSwift
 import NSError
 import NSStringConversion
@@ -78,6 +86,7 @@ import RC4
 import RGBHistogram
 import RangeAssignment
 import RecursiveOwnedParameter
+import RuntimeContention
 import SetTests
 import SevenBoom
 import Sim2DArray
@@ -94,6 +103,7 @@ import StringWalk
 import SuperChars
 import TwoSum
 import TypeFlood
+import TypeName
 import UTF8Decode
 import Walsh
 import XorLoop
@@ -120,6 +130,8 @@ precommitTests = [
   "CaptureProp": run_CaptureProp,
   "Chars": run_Chars,
   "ClassArrayGetter": run_ClassArrayGetter,
+  "CrossModuleAccessors": run_CrossModuleAccessors,
+  "CrossModuleGenerics": run_CrossModuleGenerics,
   "DeadArray": run_DeadArray,
   "Dictionary": run_Dictionary,
   "DictionaryOfObjects": run_DictionaryOfObjects,
@@ -129,12 +141,22 @@ precommitTests = [
   "Dictionary3OfObjects": run_Dictionary3OfObjects,
   "DictionaryBridge": run_DictionaryBridge,
   "DictionaryLiteral": run_DictionaryLiteral,
+  "DictionaryLookupAlignedInt": run_DictionaryLookupAlignedInt,
+  "DictionaryLookupInt": run_DictionaryLookupInt,
   "DictionaryRemove": run_DictionaryRemove,
   "DictionaryRemoveOfObjects": run_DictionaryRemoveOfObjects,
   "DictionarySwap": run_DictionarySwap,
   "DictionarySwapOfObjects": run_DictionarySwapOfObjects,
+  "DoubleDebugDescription": run_DoubleDebugDescription,
+  "DoubleDescription": run_DoubleDescription,
+  "DoubleDescriptionShort": run_DoubleDescriptionShort,
+  "DoubleFromString": run_DoubleFromString,
+  "DynamicCastToProtocol": run_DynamicCastToProtocol,
+  "EmptyArrayCopyConcurrent": run_EmptyArrayCopyConcurrent,
   "ErrorHandling": run_ErrorHandling,
+  "FloatDebugDescription": run_FloatDebugDescription,
   "GlobalClass": run_GlobalClass,
+  "GlobalClassAccessor": run_GlobalClassAccessor,
   "Hanoi": run_Hanoi,
   "HashTest": run_HashTest,
   "Histogram": run_Histogram,
@@ -142,14 +164,18 @@ precommitTests = [
   "Join": run_Join,
   "LinkedList": run_LinkedList,
   "MapReduce": run_MapReduce,
+  "MapReduceChained": run_MapReduceChained,
   "Memset": run_Memset,
   "MonteCarloE": run_MonteCarloE,
   "MonteCarloPi": run_MonteCarloPi,
+  "MultiFileDispatch": run_MultiFileDispatch,
   "NSDictionaryCastToSwift": run_NSDictionaryCastToSwift,
   "NSError": run_NSError,
   "NSStringConversion": run_NSStringConversion,
   "NopDeinit": run_NopDeinit,
   "ObjectAllocation": run_ObjectAllocation,
+  "ObjectAllocationConcurrent": run_ObjectAllocationConcurrent,
+  "ObjectAllocationCrossThread": run_ObjectAllocationCrossThread,
   "ObjectiveCBridgeFromNSString": run_ObjectiveCBridgeFromNSString,
   "ObjectiveCBridgeFromNSStringForced": run_ObjectiveCBridgeFromNSStringForced,
   "ObjectiveCBridgeToNSString": run_ObjectiveCBridgeToNSString,
@@ -190,6 +216,7 @@ precommitTests = [
   "SetExclusiveOr": run_SetExclusiveOr,
   "SetIntersect": run_SetIntersect,
   "SetIsSubsetOf": run_SetIsSubsetOf,
+  "SetOfStrings": run_SetOfStrings,
   "SetUnion": run_SetUnion,
   "SetExclusiveOr_OfObjects": run_SetExclusiveOr_OfObjects,
   "SetIntersect_OfObjects": run_SetIntersect_OfObjects,
@@ -205,17 +232,24 @@ precommitTests = [
   "StrComplexWalk": run_StrComplexWalk,
   "StrToInt": run_StrToInt,
   "StringBuilder": run_StringBuilder,
+  "StringBuilderWithIntegers": run_StringBuilderWithIntegers,
+  "StringCompareASCII": run_StringCompareASCII,
+  "StringCompareLatin1": run_StringCompareLatin1,
   "StringEqualPointerComparison": run_StringEqualPointerComparison,
+  "StringFromCharacters": run_StringFromCharacters,
   "StringInterpolation": run_StringInterpolation,
+  "StringInterpolationSmall": run_StringInterpolationSmall,
   "StringHasPrefix": run_StringHasPrefix,
   "StringHasPrefixUnicode": run_StringHasPrefixUnicode,
   "StringHasSuffix": run_StringHasSuffix,
   "StringHasSuffixUnicode": run_StringHasSuffixUnicode,
+  "StringShortKeyLookup": run_StringShortKeyLookup,
   "StringWalk": run_StringWalk,
   "StringWithCString": run_StringWithCString,
   "SuperChars": run_SuperChars,
   "TwoSum": run_TwoSum,
   "TypeFlood": run_TypeFlood,
+  "TypeName": run_TypeName,
   "UTF8Decode": run_UTF8Decode,
   "Walsh": run_Walsh,
   "XorLoop": run_XorLoop,
@@ -226,5 +260,12 @@ otherTests = [
   "Fibonacci": run_Fibonacci,
 ]
 
+concurrentTests = [
+  "ConformsToProtocolMiss": runConcurrent_ConformsToProtocolMiss,
+  "DynamicCastMiss": runConcurrent_DynamicCastMiss,
+  "GenericMetadataInstantiation": runConcurrent_GenericMetadataInstantiation,
+  "RetainReleaseShared": runConcurrent_RetainReleaseShared,
+]
+
 
 main()
@@ -82,6 +82,7 @@ namespace swift {
   class DiagnosticEngine;
   class Substitution;
   class TypeCheckerDebugConsumer;
+  class UnifiedStatsReporter;
   class DocComment;
 
   enum class KnownProtocolKind : uint8_t;
@@ -226,6 +227,14 @@ public:
   /// A consumer of type checker debug output.
   std::unique_ptr<TypeCheckerDebugConsumer> TypeCheckerDebug;
 
+  /// If set, the always-on statistics of this compilation are counted here.
+  UnifiedStatsReporter *Stats = nullptr;
+
+  /// If set, queried before each function body is type-checked; returning
+  /// true skips the remaining bodies because the result is no longer needed.
+  /// Once it has returned true it must keep doing so.
+  std::function<bool()> ShouldCancelTypeChecking;
+
   /// Cache for names of canonical GenericTypeParamTypes.
   mutable llvm::DenseMap<unsigned, Identifier>
     CanonicalGenericTypeParamTypeNames;
@@ -771,6 +780,31 @@ public:
   /// \brief Returns memory used exclusively by constraint solver.
   size_t getSolverMemory() const;
 
+  /// \brief Returns the memory allocated so far by the permanent arena.
+  size_t getPermanentArenaMemory() const;
+
+  /// \brief Returns the most memory used by any one constraint solver arena.
+  size_t getPeakSolverArenaMemory() const;
+
+  /// \brief Records that the permanent arena grew by \p bytes while the phase
+  /// of compilation called \p phase ran, adding to any growth already
+  /// recorded for it.
+  ///
+  /// \sa SharedPhaseTimer
+  void recordArenaUsage(StringRef phase, size_t bytes);
+
+  /// \brief Prints the arena growth recorded for each phase of compilation,
+  /// and the most memory used by any one constraint solver arena.
+  void printArenaUsage(raw_ostream &out) const;
+
+  /// \brief Counts a lookup into an imported module that a source file's
+  /// lookup cache could answer (\p hit) or had to make and remember.
+  void recordImportedLookup(bool hit);
+
+  /// \brief Prints how many lookups into imported modules were answered by
+  /// source files' lookup caches.
+  void printImportedLookupStats(raw_ostream &out) const;
+
   /// Complain if @objc or dynamic is used without importing Foundation.
   void diagnoseAttrsRequiringFoundation(SourceFile &SF);
 
@@ -833,11 +867,32 @@ public:
   ArchetypeBuilder *getOrCreateArchetypeBuilder(CanGenericSignature sig,
                                                 ModuleDecl *mod);
 
-  /// Set the stored archetype builder for the given canonical generic
-  /// signature and module.
+  /// Share a stored archetype builder with the given canonical generic
+  /// signature and module, unless one is already stored for them.
+  ///
+  /// \param builder A builder returned by getOrCreateArchetypeBuilder for a
+  /// signature whose requirements are equivalent to those of \p sig.
   void setArchetypeBuilder(CanGenericSignature sig,
                            ModuleDecl *mod,
-                           std::unique_ptr<ArchetypeBuilder> builder);
+                           ArchetypeBuilder *builder);
+
+  /// The mangling of a nominal type, as produced by a mangler with no
+  /// substitutions in effect.
+  struct CachedTypeMangling {
+    StringRef Mangling;
+
+    /// The entities the mangling made available for substitution, in order.
+    ArrayRef<const void *> Substitutions;
+  };
+
+  /// Retrieve the cached mangling of the given nominal type, if any.
+  Optional<CachedTypeMangling>
+  getCachedTypeMangling(const NominalTypeDecl *decl, bool usePunycode) const;
+
+  /// Cache the mangling of the given nominal type.
+  void setCachedTypeMangling(const NominalTypeDecl *decl, bool usePunycode,
+                             StringRef mangling,
+                             ArrayRef<const void *> substitutions);
 
   /// Retrieve the inherited name set for the given class.
   const InheritedNameSet *getAllPropertyNames(ClassDecl *classDecl,
@@ -848,6 +903,15 @@ public:
                             clang::ObjCInterfaceDecl *classDecl,
                             bool forInstance);
 
+  /// Returns the XML form of the documentation comment of \p D, as recorded
+  /// by setDocCommentXML, or None if none has been recorded. An empty string
+  /// means that the declaration has no documentation comment.
+  Optional<StringRef> getDocCommentXML(const Decl *D);
+
+  /// Records the XML form of the documentation comment of \p D, so that it
+  /// is converted only once.
+  void setDocCommentXML(const Decl *D, StringRef XML);
+
 private:
   friend class Decl;
   Optional<RawComment> getRawComment(const Decl *D);
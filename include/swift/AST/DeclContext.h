@@ -628,6 +628,18 @@ public:
   /// Load all of the members of this context.
   void loadAllMembers() const;
 
+  /// Check whether the members that haven't been loaded yet can be loaded a
+  /// name at a time.
+  bool canLoadMembersByName() const;
+
+  /// Add the members whose base name is \p name to \p members, loading only
+  /// those. This requires canLoadMembersByName().
+  ///
+  /// The members are not added to this context; they will be added when all
+  /// members are loaded.
+  void loadNamedMembers(Identifier name,
+                        SmallVectorImpl<ValueDecl *> &members) const;
+
   /// Retrieve global declarations that were synthesized on this
   /// declaration's behalf.
   ArrayRef<Decl *> getDerivedGlobalDecls() const {
@@ -705,6 +705,10 @@ namespace swift {
     /// \brief Send all tentative diagnostics to all diagnostic consumers and
     /// delete them.
     void emitTentativeDiagnostics();
+
+    /// \brief Delete the tentative diagnostics from index \p first on without
+    /// emitting them.
+    void discardTentativeDiagnostics(unsigned first);
   };
 
   /// \brief Represents a diagnostic transaction. While a transaction is
@@ -748,9 +752,7 @@ namespace swift {
     /// record while it was open.
     void abort() {
       close();
-      Engine.TentativeDiagnostics.erase(
-        Engine.TentativeDiagnostics.begin() + PrevDiagnostics,
-        Engine.TentativeDiagnostics.end());
+      Engine.discardTentativeDiagnostics(PrevDiagnostics);
     }
 
     /// \brief Commit and close this transaction. If this is the top-level
@@ -159,6 +159,10 @@ public:
   /// Enable use of the swiftcall calling convention.
   unsigned UseSwiftCall : 1;
 
+  /// Write object files as LLVM bitcode with a ThinLTO module summary, which
+  /// the linker compiles, optimizing across module boundaries.
+  unsigned PrepareForThinLTO : 1;
+
   /// List of backend command-line options for -embed-bitcode.
   std::vector<uint8_t> CmdArgs;
 
@@ -175,7 +179,8 @@ public:
         PrintInlineTree(false), EmbedMode(IRGenEmbedMode::None),
         HasValueNamesSetting(false), ValueNames(false),
         EnableReflectionMetadata(true), EnableReflectionNames(true),
-        UseIncrementalLLVMCodeGen(true), UseSwiftCall(false), CmdArgs(),
+        UseIncrementalLLVMCodeGen(true), UseSwiftCall(false),
+        PrepareForThinLTO(false), CmdArgs(),
         SanitizeCoverage(llvm::SanitizerCoverageOptions()) {}
 
   /// Gets the name of the specified output filename.
@@ -193,6 +198,7 @@ public:
     Hash = (Hash << 1) | Optimize;
     Hash = (Hash << 1) | DisableLLVMOptzns;
     Hash = (Hash << 1) | DisableLLVMARCOpts;
+    Hash = (Hash << 1) | PrepareForThinLTO;
     return Hash;
   }
 };
@@ -189,6 +189,23 @@ public:
     llvm_unreachable("unimplemented");
   }
 
+  /// Returns true if the members of \p D can be loaded a name at a time,
+  /// with loadNamedMembers().
+  virtual bool canLoadNamedMembers(const Decl *D, uint64_t contextData) {
+    return false;
+  }
+
+  /// Populates the given vector with the member decls of \p D whose base
+  /// name is \p N, without loading the others.
+  ///
+  /// The implementation should \em not add the members to D, since they will
+  /// be added, with all the others, when all members are loaded.
+  virtual void
+  loadNamedMembers(const Decl *D, Identifier N, uint64_t contextData,
+                   SmallVectorImpl<ValueDecl *> &members) {
+    llvm_unreachable("unimplemented");
+  }
+
   /// Populates the given vector with all conformances for \p D.
   ///
   /// The implementation should \em not call setConformances on \p D.
@@ -87,6 +87,7 @@ public:
   void mangleGlobalGetterEntity(ValueDecl *decl);
   void mangleDefaultArgumentEntity(const DeclContext *ctx, unsigned index);
   void mangleInitializerEntity(const VarDecl *var);
+  void mangleLetPropertyValueEntity(const VarDecl *var);
   void mangleClosureEntity(const SerializedAbstractClosureExpr *closure,
                            unsigned uncurryingLevel);
   void mangleClosureEntity(const AbstractClosureExpr *closure,
@@ -927,6 +927,27 @@ public:
   void cacheVisibleDecls(SmallVectorImpl<ValueDecl *> &&globals) const;
   const SmallVectorImpl<ValueDecl *> &getCachedVisibleDecls() const;
 
+  /// Identifies a lookup made from this file into an imported module.
+  ///
+  /// \sa namelookup::lookupInModule
+  struct ImportedLookupKey {
+    ModuleDecl *Module;
+    Identifier AccessPath;
+    DeclName Name;
+    /// Encodes the kind of lookup and the other options it was made with.
+    unsigned Options;
+  };
+
+  /// Returns the results remembered by cacheImportedLookup() for \p key, or
+  /// null if there are none or if modules have been loaded since.
+  const TinyPtrVector<ValueDecl *> *
+  getCachedImportedLookup(const ImportedLookupKey &key) const;
+
+  /// Remembers the results of a lookup into an imported module, until the
+  /// lookup cache is cleared or another module is loaded.
+  void cacheImportedLookup(const ImportedLookupKey &key,
+                           ArrayRef<ValueDecl *> results) const;
+
   virtual void lookupValue(ModuleDecl::AccessPathTy accessPath, DeclName name,
                            NLKind lookupKind,
                            SmallVectorImpl<ValueDecl*> &result) const override;
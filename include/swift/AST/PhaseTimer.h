@@ -0,0 +1,49 @@
+//===--- PhaseTimer.h - Timers that also track arena growth -----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_AST_PHASETIMER_H
+#define SWIFT_AST_PHASETIMER_H
+
+#include "swift/AST/ASTContext.h"
+#include "swift/Basic/Statistic.h"
+#include "swift/Basic/Timer.h"
+
+namespace swift {
+  /// A SharedTimer for a phase of compilation that, when compilation timers
+  /// or statistics are enabled, also records how much the permanent arena of
+  /// an ASTContext grew while the phase ran.
+  class SharedPhaseTimer {
+    SharedTimer Timer;
+    ASTContext &Ctx;
+    StringRef Name;
+    Optional<size_t> StartMemory;
+
+  public:
+    SharedPhaseTimer(ASTContext &ctx, StringRef name)
+        : Timer(name), Ctx(ctx), Name(name) {
+      if (SharedTimer::compilationTimersEnabled() || Ctx.Stats)
+        StartMemory = Ctx.getPermanentArenaMemory();
+    }
+
+    ~SharedPhaseTimer() {
+      if (!StartMemory)
+        return;
+      size_t growth = Ctx.getPermanentArenaMemory() - *StartMemory;
+      if (SharedTimer::compilationTimersEnabled())
+        Ctx.recordArenaUsage(Name, growth);
+      if (Ctx.Stats)
+        Ctx.Stats->recordPhaseArenaBytes(Name, growth);
+    }
+  };
+} // end namespace swift
+
+#endif // SWIFT_AST_PHASETIMER_H
@@ -101,6 +101,18 @@ public:
   /// Emit a mapping of profile counters for use in coverage.
   bool EmitProfileCoverageMapping = false;
 
+  /// The path of the profile data to optimize with, or empty if none.
+  std::string UseProfile;
+
+  /// Keep the generic specializations created in this module public and
+  /// serialize their declarations, so that importing modules can call them.
+  bool ExportSpecializations = false;
+
+  /// Call public specializations from imported modules instead of creating
+  /// local ones. The exported specializations have no serialized body, so
+  /// calls to them cannot be inlined.
+  bool UseExportedSpecializations = false;
+
   /// Should we use a pass pipeline passed in via a json file? Null by default.
   llvm::StringRef ExternalPassPipelineFilename;
   
@@ -108,6 +120,14 @@ public:
   /// conventions.
   bool EnableGuaranteedClosureContexts = false;
 
+  /// Assume that the code will only ever run on a single thread, and use
+  /// non-atomic reference counting everywhere.
+  bool AssumeSingleThreaded = false;
+
+  /// Assume that an executable module is the whole program, so that nothing
+  /// outside of it refers to its public symbols, except for the entry point.
+  bool WholeProgram = false;
+
   /// The name of the SIL outputfile if compiled with SIL debugging (-gsil).
   std::string SILOutputFileNameForDebugging;
 };
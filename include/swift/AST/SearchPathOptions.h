@@ -52,6 +52,12 @@ public:
 
   /// Don't look in for compiler-provided modules.
   bool SkipRuntimeLibraryImportPath = false;
+
+  /// A file written by the driver which lists the contents of the search
+  /// paths, so that they don't have to be probed.
+  ///
+  /// \sa ModuleLocationMap
+  std::string ModuleLocationMapPath;
 };
 
 }
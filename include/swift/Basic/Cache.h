@@ -55,6 +55,19 @@ struct CacheValueInfo : public CacheValueCostInfo<T>,
                         public CacheTypeMgmtInfo<T> {
 };
 
+/// Counters describing the behavior of a cache.
+struct CacheStatistics {
+  /// The number of lookups which found a value.
+  size_t Hits = 0;
+  /// The number of lookups which did not find a value.
+  size_t Misses = 0;
+  /// The number of values which were removed to stay within the cost limit
+  /// or because of memory pressure.
+  size_t Evictions = 0;
+  /// The sum of the costs of the values currently in the cache.
+  size_t TotalCost = 0;
+};
+
 /// The underlying implementation of the caching mechanism.
 /// It should be inherently thread-safe.
 class CacheImpl {
@@ -129,6 +142,21 @@ protected:
   /// Invokes \c remove on all keys.
   void removeAll();
 
+  /// Sets the total cost the cache should not exceed.
+  ///
+  /// When the limit is exceeded the least recently used values, which are not
+  /// currently retained, are evicted. Zero, the default, means no limit.
+  void setCostLimit(size_t Limit);
+
+  /// Evicts all values which are not currently retained, e.g. in response to
+  /// a memory pressure notification.
+  void purge();
+
+  /// Returns the hit, miss and eviction counts of the cache.
+  ///
+  /// libcache does not expose these, so they are all zero on Darwin.
+  CacheStatistics getStatistics();
+
   /// Destroys cache.
   void destroy();
 };
@@ -192,6 +220,10 @@ public:
     removeAll();
   }
 
+  using CacheImpl::setCostLimit;
+  using CacheImpl::purge;
+  using CacheImpl::getStatistics;
+
 private:
   static uintptr_t keyHash(void *Key, void *UserData) {
     return KeyInfoT::getHashValue(*static_cast<KeyT*>(Key));
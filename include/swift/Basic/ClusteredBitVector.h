@@ -467,6 +467,38 @@ public:
     return *this;
   }
 
+  /// Clear every bit in this vector which is set in a bit-vector of the
+  /// same size, i.e. compute (*this & ~other).
+  ClusteredBitVector &clearBitsSetIn(const ClusteredBitVector &other) {
+    assert(size() == other.size());
+
+    // If either vector is all-clear, this is a no-op.
+    if (isInlineAndAllClear() || other.isInlineAndAllClear())
+      return *this;
+
+    // Otherwise, mask the chunks pairwise.
+    auto chunks = getChunks();
+    auto oi = other.getChunksPtr();
+    for (auto i = chunks.begin(), e = chunks.end(); i != e; ++i, ++oi) {
+      *i &= ~*oi;
+    }
+    return *this;
+  }
+
+  /// Determine if this vector and a bit-vector of the same size have any
+  /// set bits in common, without computing their intersection.
+  bool anyCommon(const ClusteredBitVector &other) const {
+    assert(size() == other.size());
+    if (isInlineAndAllClear() || other.isInlineAndAllClear())
+      return false;
+    auto chunks = getChunks();
+    auto oi = other.getChunksPtr();
+    for (auto i = chunks.begin(), e = chunks.end(); i != e; ++i, ++oi) {
+      if (*i & *oi) return true;
+    }
+    return false;
+  }
+
   /// Set bit i.
   void setBit(size_t i) {
     assert(i < size());
@@ -506,6 +538,14 @@ public:
     }
   }
 
+  /// Clear all the bits in this vector without changing its length.
+  void clearAll() {
+    if (isInlineAndAllClear()) return;
+    for (auto &chunk : getChunks()) {
+      chunk = 0;
+    }
+  }
+
   /// Set the length of this vector to zero, but do not release any capacity.
   void clear() {
     LengthInBits = 0;
@@ -539,6 +579,44 @@ public:
     return !any();
   }
 
+  /// Return the index of the lowest set bit at or after index \p from, or
+  /// None if there is no such bit.
+  Optional<size_t> findFirstSet(size_t from = 0) const {
+    if (from >= size() || isInlineAndAllClear()) return None;
+    auto chunks = getChunksPtr();
+    size_t chunkIndex = from / ChunkSizeInBits;
+    size_t numChunks = getLengthInChunks();
+
+    // Mask off the bits below 'from' in the first chunk.
+    ChunkType cur = chunks[chunkIndex] &
+                    (~ChunkType(0) << (from % ChunkSizeInBits));
+    while (!cur) {
+      if (++chunkIndex == numChunks) return None;
+      cur = chunks[chunkIndex];
+    }
+    return chunkIndex * ChunkSizeInBits +
+           llvm::countTrailingZeros(cur, llvm::ZB_Undefined);
+  }
+
+  /// Return the index of the lowest set bit after index \p prev, or None if
+  /// there is no such bit.
+  Optional<size_t> findNextSet(size_t prev) const {
+    return findFirstSet(prev + 1);
+  }
+
+  /// Return the index of the highest set bit, or None if no bit is set.
+  Optional<size_t> findLastSet() const {
+    if (isInlineAndAllClear()) return None;
+    auto chunks = getChunksPtr();
+    for (size_t chunkIndex = getLengthInChunks(); chunkIndex != 0;) {
+      --chunkIndex;
+      if (ChunkType cur = chunks[chunkIndex])
+        return chunkIndex * ChunkSizeInBits + (ChunkSizeInBits - 1) -
+               llvm::countLeadingZeros(cur, llvm::ZB_Undefined);
+    }
+    return None;
+  }
+
   /// A class for scanning for set bits, from low indices to high ones.
   class SetBitEnumerator {
     ChunkType CurChunk;
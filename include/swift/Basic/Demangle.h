@@ -71,6 +71,95 @@ struct DemangleOptions {
 class Node;
 typedef std::shared_ptr<Node> NodePointer;
 
+/// A bump allocator for demangler parse trees.
+///
+/// While a NodeArena is alive, the nodes NodeFactory creates on the same
+/// thread, and the storage for their children, are carved out of the arena
+/// instead of being allocated from the heap one by one. Releasing such a node
+/// only runs its destructor; the memory is reclaimed all at once when the
+/// arena is destroyed. Arenas nest, and the innermost live one is used.
+///
+/// Every node created while an arena is active must be released before the
+/// arena is destroyed, so an arena should only be used around code that
+/// doesn't let the parse tree escape, like demangling straight to a string.
+class NodeArena {
+  struct Slab {
+    Slab *Next;
+  };
+
+  Slab *Slabs = nullptr;
+  char *CurPtr = nullptr;
+  char *End = nullptr;
+  size_t NextSlabSize;
+  NodeArena *Enclosing;
+#ifndef NDEBUG
+  size_t NumLiveNodes = 0;
+#endif
+
+  void *allocateSlow(size_t size, size_t alignment);
+
+  template <class T> friend class NodeAllocator;
+  friend struct NodeFactory;
+
+public:
+  NodeArena();
+  ~NodeArena();
+  NodeArena(const NodeArena &) = delete;
+  NodeArena &operator=(const NodeArena &) = delete;
+
+  void *allocate(size_t size, size_t alignment) {
+    char *ptr = reinterpret_cast<char *>(
+        (reinterpret_cast<uintptr_t>(CurPtr) + alignment - 1) &
+        ~uintptr_t(alignment - 1));
+    if (ptr + size > End || ptr < CurPtr)
+      return allocateSlow(size, alignment);
+    CurPtr = ptr + size;
+    return ptr;
+  }
+
+  /// The innermost arena that is active on this thread, if any.
+  static NodeArena *getCurrent();
+};
+
+/// A standard allocator that allocates from the NodeArena that was active
+/// when it was created, or from the heap if there was none.
+template <class T>
+class NodeAllocator {
+  NodeArena *Arena;
+
+  template <class U> friend class NodeAllocator;
+
+public:
+  typedef T value_type;
+
+  NodeAllocator() : Arena(NodeArena::getCurrent()) {}
+  explicit NodeAllocator(NodeArena *arena) : Arena(arena) {}
+  template <class U>
+  NodeAllocator(const NodeAllocator<U> &other) : Arena(other.Arena) {}
+
+  NodeArena *getArena() const { return Arena; }
+
+  T *allocate(size_t n) {
+    if (Arena)
+      return static_cast<T *>(Arena->allocate(n * sizeof(T), alignof(T)));
+    return static_cast<T *>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(T *p, size_t n) {
+    if (!Arena)
+      ::operator delete(p);
+  }
+
+  template <class U>
+  bool operator==(const NodeAllocator<U> &other) const {
+    return Arena == other.Arena;
+  }
+  template <class U>
+  bool operator!=(const NodeAllocator<U> &other) const {
+    return Arena != other.Arena;
+  }
+};
+
 enum class FunctionSigSpecializationParamKind : unsigned {
   // Option Flags use bits 0-5. This give us 6 bits implying 64 entries to
   // work with.
@@ -157,8 +246,7 @@ private:
     IndexType IndexPayload;
   };
 
-  // FIXME: use allocator.
-  typedef std::vector<NodePointer> NodeVector;
+  typedef std::vector<NodePointer, NodeAllocator<NodePointer>> NodeVector;
   NodeVector Children;
 
   Node(Kind k)
@@ -350,22 +438,55 @@ std::string mangleNode(const NodePointer &root);
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options = DemangleOptions());
 
+/// Creates demangler nodes, in the current NodeArena if there is one.
 struct NodeFactory {
   static NodePointer create(Node::Kind K) {
-    return NodePointer(new Node(K));
+    return create(new (allocateNode()) Node(K));
   }
   static NodePointer create(Node::Kind K, Node::IndexType Index) {
-    return NodePointer(new Node(K, Index));
+    return create(new (allocateNode()) Node(K, Index));
   }
   static NodePointer create(Node::Kind K, llvm::StringRef Text) {
-    return NodePointer(new Node(K, Text));
+    return create(new (allocateNode()) Node(K, Text));
   }
   static NodePointer create(Node::Kind K, std::string &&Text) {
-    return NodePointer(new Node(K, std::move(Text)));
+    return create(new (allocateNode()) Node(K, std::move(Text)));
   }
   template <size_t N>
   static NodePointer create(Node::Kind K, const char (&Text)[N]) {
-    return NodePointer(new Node(K, llvm::StringRef(Text)));
+    return create(new (allocateNode()) Node(K, llvm::StringRef(Text)));
+  }
+
+private:
+  /// Destroys a node, and frees it unless it lives in an arena.
+  struct Deleter {
+    NodeArena *Arena;
+
+    void operator()(Node *node) const {
+      node->~Node();
+      if (Arena) {
+#ifndef NDEBUG
+        --Arena->NumLiveNodes;
+#endif
+      } else {
+        ::operator delete(node);
+      }
+    }
+  };
+
+  static void *allocateNode() {
+    return NodeAllocator<Node>().allocate(1);
+  }
+
+  static NodePointer create(Node *node) {
+    // The node's children were set up to allocate from the same arena the
+    // node itself came from, if any.
+    NodeArena *arena = node->Children.get_allocator().getArena();
+#ifndef NDEBUG
+    if (arena)
+      ++arena->NumLiveNodes;
+#endif
+    return NodePointer(node, Deleter{arena}, NodeAllocator<Node>(arena));
   }
 };
 
@@ -91,6 +91,7 @@ public:
     }
   }
   void pushNewStorageSlow(std::size_t needed);
+  void reserveStorageSlow(std::size_t capacity);
 
   /// A stable iterator is the equivalent of an index into the stack.
   /// It's an iterator that stays stable across modification of the
@@ -179,6 +180,25 @@ public:
     checkValid();
     assert(it.Depth <= size_t(End - Begin));
   }
+
+  /// Return the number of bytes used by the objects on the stack.
+  std::size_t size_in_bytes() const {
+    checkValid();
+    return End - Begin;
+  }
+
+  /// Return the number of bytes the stack can hold without reallocating.
+  std::size_t capacity_in_bytes() const {
+    checkValid();
+    return End - Allocated;
+  }
+
+  /// Make sure that the stack can hold \p capacity bytes of objects without
+  /// reallocating.
+  void reserve(std::size_t capacity) {
+    if (capacity > capacity_in_bytes())
+      reserveStorageSlow(capacity);
+  }
 };
 
 template <class T> class DiverseStackImpl : private DiverseStackBase {
@@ -238,6 +258,15 @@ public:
   using DiverseStackBase::stable_iterator;
   using DiverseStackBase::stable_begin;
   using DiverseStackBase::stable_end;
+  using DiverseStackBase::size_in_bytes;
+  using DiverseStackBase::capacity_in_bytes;
+  using DiverseStackBase::reserve;
+
+  /// Pop all objects off the stack, keeping its storage.
+  void clear() {
+    checkValid();
+    Begin = End;
+  }
 
   class const_iterator;
   class iterator {
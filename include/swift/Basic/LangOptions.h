@@ -109,6 +109,11 @@ namespace swift {
     /// solver should be debugged.
     unsigned DebugConstraintSolverAttempt = 0;
 
+    /// \brief If non-zero, the time and solver work taken to type-check each
+    /// expression is recorded, and this many of the slowest expressions are
+    /// printed to llvm::errs() after type-checking.
+    unsigned DebugSlowestExpressions = 0;
+
     /// \brief Enable the iterative type checker.
     bool IterativeTypeChecker = false;
 
@@ -130,6 +135,10 @@ namespace swift {
     /// allocated by the constraint solver.
     unsigned SolverMemoryThreshold = 15000000;
 
+    /// \brief The upper bound on the number of states the constraint solver
+    /// may explore for a single expression, or 0 for no bound.
+    unsigned SolverStateLimit = 0;
+
     /// \brief Perform all dynamic allocations using malloc/free instead of
     /// optimized custom allocator, so that memory debugging tools can be used.
     bool UseMalloc = false;
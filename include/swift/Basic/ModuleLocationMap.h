@@ -0,0 +1,75 @@
+//===--- ModuleLocationMap.h - Listings of module search paths --*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Looking for a module probes each search path in turn, so every import costs
+// a failing file system call per search path that doesn't contain it. A
+// ModuleLocationMap lists each search path once instead, and answers whether
+// an entry can be in a directory without touching the file system. The driver
+// writes the listings of its search paths to a file that every frontend it
+// starts reads, so that the directories are only listed once per build.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_MODULELOCATIONMAP_H
+#define SWIFT_BASIC_MODULELOCATIONMAP_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+
+namespace llvm {
+  class raw_ostream;
+}
+
+namespace swift {
+
+/// The entries of a set of directories.
+///
+/// Entries are compared case-insensitively, so that a case-insensitive file
+/// system never finds less than it would by probing. A false positive only
+/// costs the probe the map would have saved.
+class ModuleLocationMap {
+  /// The lowercased entries of each directory which has been listed.
+  llvm::StringMap<llvm::StringSet<>> Directories;
+
+  /// Directories which couldn't be listed, and have to be probed.
+  llvm::StringSet<> UnlistableDirectories;
+
+public:
+  /// Lists the entries of \p directory, unless that has been done already.
+  ///
+  /// A directory which doesn't exist is recorded as empty.
+  void addDirectory(StringRef directory);
+
+  /// Returns false if \p directory has been listed and has no entry named
+  /// \p name, and true otherwise.
+  bool mayContain(StringRef directory, StringRef name) const;
+
+  /// Returns true if \p directory has been listed, or has failed to be.
+  bool hasDirectory(StringRef directory) const {
+    return Directories.count(directory) ||
+           UnlistableDirectories.count(directory);
+  }
+
+  /// Writes the listings in the format read by \c read.
+  void write(llvm::raw_ostream &os) const;
+
+  /// Adds the listings written by \c write to this map.
+  ///
+  /// \returns true if \p contents is malformed, in which case nothing
+  /// is added.
+  bool read(StringRef contents);
+};
+
+} // end namespace swift
+
+#endif // SWIFT_BASIC_MODULELOCATIONMAP_H
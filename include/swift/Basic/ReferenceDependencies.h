@@ -0,0 +1,129 @@
+//===--- ReferenceDependencies.h - Binary swiftdeps format ------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the binary form of the Swift reference dependencies
+/// ("swiftdeps") files written by the frontend and read by the driver.
+///
+/// A file is a fixed header, followed by an array of fixed-width records,
+/// followed by a string table. All integers are little-endian. Every record
+/// names a string by its offset and length in the string table, so a reader
+/// can walk a memory-mapped file and hand out StringRefs into it without
+/// copying anything. Member entries are stored as the mangled base name and
+/// the member name separated by a NUL byte, which is how the driver keys
+/// them anyway. A fingerprint record holds the fingerprint of the "provides"
+/// record just before it.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_REFERENCEDEPENDENCIES_H
+#define SWIFT_BASIC_REFERENCEDEPENDENCIES_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstring>
+#include <vector>
+
+namespace swift {
+namespace reference_dependencies {
+
+/// The sections of a dependencies file, one per key of the YAML form.
+enum class Section : uint8_t {
+  ProvidesTopLevel,
+  ProvidesNominal,
+  ProvidesMember,
+  ProvidesDynamicLookup,
+  DependsTopLevel,
+  DependsMember,
+  DependsNominal,
+  DependsDynamicLookup,
+  DependsExternal,
+  InterfaceHash,
+  /// The fingerprints of the declarations behind "provides" entries. An
+  /// entry whose fingerprint hasn't changed since the last build doesn't
+  /// cause the files which depend on it to be rebuilt.
+  ProvidesFingerprint,
+  LastSection = ProvidesFingerprint
+};
+
+/// Returns the key used for \p section in the YAML form.
+StringRef getYAMLKey(Section section);
+
+/// The four bytes that every binary dependencies file starts with.
+const char Signature[4] = { 'S', 'W', 'D', 'P' };
+
+/// Bumped whenever the layout below changes incompatibly.
+const uint16_t FormatVersion = 1;
+
+/// The size of the header: the signature, the version, two reserved bytes,
+/// the number of records and the size of the string table.
+const size_t HeaderSize = 16;
+
+/// The size of each record: the section, the flags, two reserved bytes, and
+/// the offset and length of the record's string.
+const size_t RecordSize = 12;
+
+/// Set in a record's flags if a change to the entry should be propagated to
+/// the files which depend on this one; the YAML form marks the entries
+/// without it as "!private".
+const uint8_t IsCascadingFlag = 1 << 0;
+
+/// Returns true if \p data starts with the signature of the binary format.
+static inline bool isBinaryFormat(StringRef data) {
+  return data.size() >= sizeof(Signature) &&
+         memcmp(data.data(), Signature, sizeof(Signature)) == 0;
+}
+
+/// Calls \p callback with each record of the binary dependencies file in
+/// \p data, in order. The names passed to \p callback point into \p data.
+///
+/// \returns false if \p data is not a well-formed dependencies file of the
+/// current version, or as soon as \p callback returns false. Records before
+/// the point of failure may already have been passed to \p callback.
+bool readEntries(StringRef data,
+                 llvm::function_ref<bool(Section section, StringRef name,
+                                         bool isCascading)> callback);
+
+/// Builds a binary dependencies file in memory.
+///
+/// Strings are uniqued, so names that appear in several sections take up
+/// space in the string table only once.
+class Writer {
+  struct Record {
+    Section section;
+    bool isCascading;
+    uint32_t offset;
+    uint32_t length;
+  };
+  std::vector<Record> Records;
+  std::string StringTable;
+  llvm::StringMap<uint32_t> StringOffsets;
+
+  uint32_t addString(StringRef string);
+
+public:
+  void addEntry(Section section, StringRef name, bool isCascading = true);
+  void addMemberEntry(Section section, StringRef baseName,
+                      StringRef memberName, bool isCascading = true);
+
+  /// Records the fingerprint of the "provides" entry added last.
+  void addFingerprint(StringRef fingerprint);
+
+  void write(raw_ostream &out) const;
+};
+
+} // end namespace reference_dependencies
+} // end namespace swift
+
+#endif // SWIFT_BASIC_REFERENCEDEPENDENCIES_H
@@ -18,6 +18,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/SourceMgr.h"
 #include <map>
+#include <vector>
 
 namespace swift {
 
@@ -42,6 +43,14 @@ class SourceManager {
   std::map<const char *, VirtualFile> VirtualFiles;
   mutable std::pair<const char *, const VirtualFile*> CachedVFile = {};
 
+  /// The byte offset of the start of each line, indexed by buffer ID and
+  /// built the first time a line is looked up in that buffer.
+  mutable std::vector<std::vector<unsigned>> LineStartOffsets;
+
+  /// The buffer ID and zero-based line of the most recent line lookup, so
+  /// that runs of queries in source order don't need to search.
+  mutable std::pair<unsigned, unsigned> CachedLine = {0U, 0U};
+
 public:
   llvm::SourceMgr &getLLVMSourceMgr() {
     return LLVMSourceMgr;
@@ -184,7 +193,7 @@ public:
     assert(Loc.isValid());
     int LineOffset = getLineOffset(Loc);
     int l, c;
-    std::tie(l, c) = LLVMSourceMgr.getLineAndColumn(Loc.Value, BufferID);
+    std::tie(l, c) = getPhysicalLineAndColumn(Loc, BufferID);
     assert(LineOffset+l > 0 && "bogus line offset");
     return { LineOffset + l, c };
   }
@@ -196,7 +205,7 @@ public:
   /// This does not respect #line directives.
   unsigned getLineNumber(SourceLoc Loc, unsigned BufferID = 0) const {
     assert(Loc.isValid());
-    return LLVMSourceMgr.FindLineNumber(Loc.Value, BufferID);
+    return getPhysicalLineAndColumn(Loc, BufferID).first;
   }
 
   StringRef extractText(CharSourceRange Range,
@@ -223,6 +232,14 @@ public:
 private:
   const VirtualFile *getVirtualFile(SourceLoc Loc) const;
 
+  /// Returns the line and column of a location, ignoring #line directives.
+  std::pair<unsigned, unsigned>
+  getPhysicalLineAndColumn(SourceLoc Loc, unsigned BufferID) const;
+
+  /// Returns the line start offsets of the given buffer, computing them on
+  /// first use.
+  ArrayRef<unsigned> getLineStartOffsets(unsigned BufferID) const;
+
   int getLineOffset(SourceLoc Loc) const {
     if (auto VFile = getVirtualFile(Loc))
       return VFile->LineOffset;
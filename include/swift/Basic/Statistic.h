@@ -0,0 +1,79 @@
+//===--- Statistic.h - Always-on statistics of a frontend job ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// With -stats-output-dir, every frontend job writes its counters, the time
+// spent in each phase of compilation and the memory allocated in them to a
+// JSON file of its own, so that the cost of a build can be aggregated over
+// all of its jobs. This works in release builds, where llvm::Statistics and
+// the constraint solver statistics are not collected.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_STATISTIC_H
+#define SWIFT_BASIC_STATISTIC_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/SmallString.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace swift {
+
+/// Collects the statistics of one frontend job, and writes them as a JSON
+/// object to a new file in the output directory when it is destroyed.
+class UnifiedStatsReporter {
+public:
+  struct AlwaysOnFrontendCounters {
+#define FRONTEND_STATISTIC(Group, Name) size_t Name = 0;
+#include "swift/Basic/Statistics.def"
+  };
+
+private:
+  SmallString<128> Filename;
+  AlwaysOnFrontendCounters FrontendCounters;
+
+  /// Phases can be timed on several threads, e.g. in multi-threaded LLVM
+  /// code generation.
+  std::mutex PhasesMutex;
+
+  /// The wall time in seconds spent in each phase, in the order the phases
+  /// were first recorded.
+  std::vector<std::pair<std::string, double>> PhaseTimes;
+
+  /// The growth of the permanent AST arena in each phase, in bytes.
+  std::vector<std::pair<std::string, size_t>> PhaseArenaBytes;
+
+public:
+  /// Creates a reporter which writes to a file in \p directory whose name
+  /// is made of \p programName, \p auxName and a unique suffix.
+  UnifiedStatsReporter(StringRef programName, StringRef auxName,
+                       StringRef directory);
+  ~UnifiedStatsReporter();
+
+  UnifiedStatsReporter(const UnifiedStatsReporter &) = delete;
+  UnifiedStatsReporter &operator=(const UnifiedStatsReporter &) = delete;
+
+  AlwaysOnFrontendCounters &getFrontendCounters() {
+    return FrontendCounters;
+  }
+
+  /// Adds \p seconds to the time recorded for \p phase.
+  void recordPhaseTime(StringRef phase, double seconds);
+
+  /// Adds \p bytes to the arena growth recorded for \p phase.
+  void recordPhaseArenaBytes(StringRef phase, size_t bytes);
+};
+
+} // end namespace swift
+
+#endif // SWIFT_BASIC_STATISTIC_H
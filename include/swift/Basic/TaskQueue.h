@@ -38,7 +38,31 @@ enum class TaskFinishedResponse {
   StopExecution,
 };
 
+/// \brief The resources which a task used, as far as the current system can
+/// tell.
+struct TaskResourceUsage {
+  /// Whether WallTime was measured.
+  bool HasWallTime = false;
+
+  /// Whether UserTime, SystemTime and MaxRSS were reported by the system.
+  bool HasProcessUsage = false;
+
+  /// The time from the task being started until it exited, in microseconds.
+  uint64_t WallTime = 0;
+
+  /// The CPU time the task spent in user and system code, in microseconds.
+  uint64_t UserTime = 0;
+  uint64_t SystemTime = 0;
+
+  /// The peak resident set size of the task, in bytes.
+  uint64_t MaxRSS = 0;
+};
+
 /// \brief A class encapsulating the execution of multiple tasks in parallel.
+///
+/// If this process was handed a GNU make jobserver through MAKEFLAGS, every
+/// task after the first also needs a token from the jobserver to start, so
+/// that nested builds share a single limit on parallelism.
 class TaskQueue {
   /// Tasks which have not begun execution.
   std::queue<std::unique_ptr<Task>> QueuedTasks;
@@ -46,6 +70,10 @@ class TaskQueue {
   /// The number of tasks to execute in parallel.
   unsigned NumberOfParallelTasks;
 
+  /// Whether to provide a jobserver to the tasks when there isn't one
+  /// already.
+  bool ServesJobs = false;
+
 public:
   /// \brief Create a new TaskQueue instance.
   ///
@@ -72,12 +100,15 @@ public:
   /// \param ReturnCode the return code of the task which finished execution.
   /// \param Output the output from the task which finished execution,
   /// if available. (This may not be available on all platforms.)
+  /// \param Usage the resources used by the task which finished execution
   /// \param Context the context which was passed when the task was added
   ///
   /// \returns true if further execution of tasks should stop,
   /// false if execution should continue
   typedef std::function<TaskFinishedResponse(ProcessId Pid, int ReturnCode,
-                                             StringRef Output, void *Context)>
+                                             StringRef Output,
+                                             const TaskResourceUsage &Usage,
+                                             void *Context)>
     TaskFinishedCallback;
 
   /// \brief A callback which will be executed if a task exited abnormally due
@@ -88,12 +119,15 @@ public:
   /// no reason could be deduced, this may be empty.
   /// \param Output the output from the task which exited abnormally, if
   /// available. (This may not be available on all platforms.)
+  /// \param Usage the resources used by the task which exited abnormally
   /// \param Context the context which was passed when the task was added
   ///
   /// \returns a TaskFinishedResponse indicating whether or not execution
   /// should proceed
   typedef std::function<TaskFinishedResponse(ProcessId Pid, StringRef ErrorMsg,
-                                             StringRef Output, void *Context)>
+                                             StringRef Output,
+                                             const TaskResourceUsage &Usage,
+                                             void *Context)>
     TaskSignalledCallback;
 #pragma clang diagnostic pop
 
@@ -113,6 +147,15 @@ public:
   /// parallel
   unsigned getNumberOfParallelTasks() const;
 
+  /// \brief Makes \ref execute act as a GNU make jobserver for the tasks it
+  /// runs, with a token for each parallel task after the first, unless this
+  /// process is already the client of one.
+  ///
+  /// Tasks which take part in the protocol then share this TaskQueue's
+  /// limit on parallelism. This has no effect on platforms which don't
+  /// support parallel execution.
+  void setServesJobs(bool Value = true) { ServesJobs = Value; }
+
   /// \brief Adds a task to the TaskQueue.
   ///
   /// \param ExecPath the path to the executable which the task should execute
@@ -14,10 +14,13 @@
 #define SWIFT_BASIC_TIMER_H
 
 #include "swift/Basic/LLVM.h"
+#include "swift/Basic/TraceEvents.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/Support/Timer.h"
 
 namespace swift {
+  class UnifiedStatsReporter;
+
   /// A convenience class for declaring a timer that's part of the Swift
   /// compilation timers group.
   class SharedTimer {
@@ -28,22 +31,45 @@ namespace swift {
     };
     static State CompilationTimersEnabled;
 
+    /// If set, receives the wall time of every SharedTimer.
+    static UnifiedStatsReporter *StatsReporter;
+
     Optional<llvm::NamedRegionTimer> Timer;
+    StringRef Name;
+    Optional<llvm::TimeRecord> StartTime;
+
+    /// Records the phase in the Chrome trace of the job, if there is one.
+    TraceSpan Span;
 
   public:
-    explicit SharedTimer(StringRef name) {
+    explicit SharedTimer(StringRef name) : Name(name), Span(name) {
       if (CompilationTimersEnabled == State::Enabled)
         Timer.emplace(name, StringRef("Swift compilation"));
       else
         CompilationTimersEnabled = State::Skipped;
+      if (StatsReporter)
+        StartTime = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
     }
 
+    ~SharedTimer();
+
     /// Must be called before any SharedTimers have been created.
     static void enableCompilationTimers() {
       assert(CompilationTimersEnabled != State::Skipped &&
              "a timer has already been created");
       CompilationTimersEnabled = State::Enabled;
     }
+
+    /// Returns true if SharedTimers are being recorded.
+    static bool compilationTimersEnabled() {
+      return CompilationTimersEnabled == State::Enabled;
+    }
+
+    /// Records the time of every SharedTimer created from now on in
+    /// \p reporter, or stops recording if it is null.
+    static void setStatsReporter(UnifiedStatsReporter *reporter) {
+      StatsReporter = reporter;
+    }
   };
 } // end namespace swift
 
@@ -0,0 +1,118 @@
+//===--- TraceEvents.h - Chrome trace events of a frontend job --*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// With -trace-output-dir, every frontend job writes the spans of time it
+// spent in each phase of compilation, and in each file and function within
+// them, as a file of Chrome trace events. Timestamps are taken from the
+// system clock, so the files of all the jobs of a build can be loaded
+// together into chrome://tracing to see where the build spent its time.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_TRACEEVENTS_H
+#define SWIFT_BASIC_TRACEEVENTS_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/SmallString.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace swift {
+
+/// Collects the trace events of one frontend job, and writes them as a
+/// Chrome trace to a new file in the output directory when it is destroyed.
+class TraceEventRecorder {
+  struct Event {
+    std::string Name;
+    std::string Detail;
+    uint64_t StartMicros;
+    uint64_t DurationMicros;
+    unsigned ThreadIndex;
+  };
+
+  /// The recorder that TraceSpans are currently recorded in, if any.
+  static TraceEventRecorder *Current;
+
+  SmallString<128> Filename;
+  std::string ProcessName;
+
+  /// Spans can be recorded on several threads, e.g. in multi-threaded LLVM
+  /// code generation.
+  std::mutex EventsMutex;
+  std::vector<Event> Events;
+
+  /// Small numbers for the threads that recorded events, which are easier to
+  /// read in a trace viewer than the system's thread IDs.
+  std::map<std::thread::id, unsigned> ThreadIndices;
+
+public:
+  /// Creates a recorder which writes to a file in \p directory whose name
+  /// is made of \p programName, \p auxName and a unique suffix.
+  TraceEventRecorder(StringRef programName, StringRef auxName,
+                     StringRef directory);
+  ~TraceEventRecorder();
+
+  TraceEventRecorder(const TraceEventRecorder &) = delete;
+  TraceEventRecorder &operator=(const TraceEventRecorder &) = delete;
+
+  /// Returns the current time in microseconds since the epoch.
+  static uint64_t now();
+
+  /// Records a span of time named \p name from \p startMicros until now.
+  ///
+  /// \p detail is shown with the span, e.g. the name of the function a pass
+  /// ran on, while spans of the same \p name can be aggregated.
+  void recordSpan(StringRef name, StringRef detail, uint64_t startMicros);
+
+  static TraceEventRecorder *getCurrent() { return Current; }
+
+  /// Records every TraceSpan created from now on in \p recorder, or stops
+  /// recording if it is null.
+  static void setCurrent(TraceEventRecorder *recorder) { Current = recorder; }
+};
+
+/// Records the time from its construction to its destruction as a span in
+/// the current TraceEventRecorder. Does nothing when no trace is recorded.
+class TraceSpan {
+  TraceEventRecorder *Recorder;
+  StringRef Name;
+  std::string Detail;
+  uint64_t StartMicros = 0;
+
+public:
+  explicit TraceSpan(StringRef name, StringRef detail = StringRef())
+      : Recorder(TraceEventRecorder::getCurrent()), Name(name) {
+    if (!Recorder)
+      return;
+    Detail = detail;
+    StartMicros = TraceEventRecorder::now();
+  }
+
+  ~TraceSpan() {
+    if (Recorder)
+      Recorder->recordSpan(Name, Detail, StartMicros);
+  }
+
+  TraceSpan(const TraceSpan &) = delete;
+  TraceSpan &operator=(const TraceSpan &) = delete;
+
+  /// Returns true if spans are being recorded, so that callers can avoid
+  /// computing details which would not be used.
+  static bool isEnabled() { return TraceEventRecorder::getCurrent(); }
+};
+
+} // end namespace swift
+
+#endif // SWIFT_BASIC_TRACEEVENTS_H
@@ -30,15 +30,12 @@ class ValueEnumerator {
 public:
   /// Return the index of value \p v.
   IndexTy getIndex(const ValueTy &v) {
-    // Return the index of this Key, if we've assigned one already.
-    auto It = ValueToIndex.find(v);
-    if (It != ValueToIndex.end()) {
-      return It->second;
-    }
-
-    // Generate a new counter for the key.
-    ValueToIndex[v] = ++counter;
-    return counter;
+    // Return the index of this Key if we've assigned one already, or
+    // generate a new counter for the key. This needs only one hash lookup.
+    auto Res = ValueToIndex.insert({v, counter + 1});
+    if (Res.second)
+      ++counter;
+    return Res.first->second;
   }
 
   ValueEnumerator() = default;
@@ -188,6 +188,10 @@ public:
 
   /// Imports an Objective-C header file into the shared imported header module.
   ///
+  /// If \p header is the precompiled bridging header given in the
+  /// ClangImporterOptions, its contents were already loaded when Clang was set
+  /// up, and this just makes them visible to \p adapter.
+  ///
   /// \param header A header name or full path, to be used in a \#import
   ///        directive.
   /// \param adapter The module that depends on the contents of this header.
@@ -211,6 +215,13 @@ public:
   std::string getBridgingHeaderContents(StringRef headerPath, off_t &fileSize,
                                         time_t &fileModTime);
 
+  /// Precompiles the bridging header \p headerPath to \p outputPCHPath,
+  /// along with its Swift lookup table, so that other frontend invocations
+  /// can load it instead of parsing the header themselves.
+  ///
+  /// \returns true if there was an error.
+  bool emitBridgingPCH(StringRef headerPath, StringRef outputPCHPath);
+
   const clang::Module *getClangOwningModule(ClangNode Node) const;
   bool hasTypedef(const clang::Decl *typeDecl) const;
 
@@ -30,6 +30,13 @@ public:
   /// A directory for overriding Clang's resource directory.
   std::string OverrideResourceDir;
 
+  /// The bridging header or precompiled bridging header of the module being
+  /// compiled, if any.
+  ///
+  /// A precompiled header is loaded when Clang is set up, rather than parsed
+  /// when the header is imported.
+  std::string BridgingHeader;
+
   /// The target CPU to compile for.
   ///
   /// Equivalent to Clang's -mcpu=.
@@ -46,9 +46,10 @@ public:
     REPLJob,
     LinkJob,
     GenerateDSYMJob,
+    GeneratePCHJob,
 
     JobFirst=CompileJob,
-    JobLast=GenerateDSYMJob
+    JobLast=GeneratePCHJob
   };
 
   static const char *getClassName(ActionClass AC);
@@ -266,6 +267,21 @@ public:
   }
 };
 
+/// Precompiles the bridging header given by -import-objc-header.
+///
+/// The action is an input of every compile action that uses the header, and
+/// is owned by the top-level action list rather than any of them.
+class GeneratePCHJobAction : public JobAction {
+  virtual void anchor();
+public:
+  explicit GeneratePCHJobAction(Action *Input)
+    : JobAction(Action::GeneratePCHJob, Input, types::TY_PCH) {}
+
+  static bool classof(const Action *A) {
+    return A->getKind() == Action::GeneratePCHJob;
+  }
+};
+
 class LinkJobAction : public JobAction {
   virtual void anchor();
   LinkKind Kind;
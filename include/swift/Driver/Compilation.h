@@ -22,6 +22,7 @@
 #include "swift/Basic/ArrayRefView.h"
 #include "swift/Basic/LLVM.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/TimeValue.h"
 
@@ -40,6 +41,7 @@ namespace swift {
 
 namespace driver {
   class Driver;
+  class OutputCache;
   class ToolChain;
 
 /// An enum providing different levels of output which should be produced
@@ -82,6 +84,10 @@ private:
   /// Used for large compilations to avoid overflowing argv.
   const char *AllSourceFilesPath = nullptr;
 
+  /// When non-null, a temporary file listing the contents of the module
+  /// search paths for the frontends.
+  const char *ModuleLocationMapPath = nullptr;
+
   /// Temporary files that should be cleaned up after the compilation finishes.
   ///
   /// These apply whether the compilation succeeds or fails.
@@ -106,6 +112,25 @@ private:
   /// If unknown, this will be some time in the past.
   llvm::sys::TimeValue LastBuildTime = llvm::sys::TimeValue::MinTime();
 
+  /// How long each input took to compile in the last build, keyed by input
+  /// path.
+  ///
+  /// Used to start the slowest compile jobs first, and written back to the
+  /// build record with the times from this build.
+  llvm::StringMap<llvm::sys::TimeValue> PreviousCompileTimes;
+
+  /// The hashes of the contents of the inputs in the last build, keyed by
+  /// input path.
+  ///
+  /// Used to tell inputs which were touched without being changed, such as by
+  /// a version control checkout, from those which really changed.
+  llvm::StringMap<std::string> PreviousContentHashes;
+
+  /// When true, the contents of inputs are hashed and written to the build
+  /// record, and inputs whose contents haven't changed aren't rebuilt just
+  /// because their modification times have.
+  bool EnableFileHashing = false;
+
   /// The number of commands which this compilation should attempt to run in
   /// parallel.
   unsigned NumberOfParallelCommands;
@@ -132,6 +157,23 @@ private:
   /// rebuilt.
   bool ShowIncrementalBuildDecisions = false;
 
+  /// When true, compile jobs which are ready to run at the same time are
+  /// combined into at most NumberOfParallelCommands frontend invocations,
+  /// each with several primary files.
+  bool EnableBatchMode = false;
+
+  /// When true, prints how long the jobs took and how much of the time
+  /// available to them the parallel job slots spent idle.
+  bool ShowDriverTimeCompilation = false;
+
+  /// When true, subtasks are given a GNU make jobserver through MAKEFLAGS,
+  /// unless the driver itself was given one.
+  bool ServeJobs = false;
+
+  /// When non-null, compile jobs are skipped if their outputs can be
+  /// restored from this cache.
+  std::unique_ptr<OutputCache> Cache;
+
   static const Job *unwrap(const std::unique_ptr<const Job> &p) {
     return p.get();
   }
@@ -185,10 +227,20 @@ public:
     ContinueBuildingAfterErrors = Value;
   }
 
+  bool getShowsIncrementalBuildDecisions() const {
+    return ShowIncrementalBuildDecisions;
+  }
   void setShowsIncrementalBuildDecisions(bool value = true) {
     ShowIncrementalBuildDecisions = value;
   }
 
+  bool getBatchModeEnabled() const {
+    return EnableBatchMode;
+  }
+  void setBatchModeEnabled(bool value = true) {
+    EnableBatchMode = value;
+  }
+
   void setCompilationRecordPath(StringRef path) {
     assert(CompilationRecordPath.empty() && "already set");
     CompilationRecordPath = path;
@@ -198,6 +250,40 @@ public:
     LastBuildTime = time;
   }
 
+  void setPreviousCompileTimes(llvm::StringMap<llvm::sys::TimeValue> times) {
+    PreviousCompileTimes = std::move(times);
+  }
+
+  bool getFileHashingEnabled() const {
+    return EnableFileHashing;
+  }
+  void setFileHashingEnabled(bool value = true) {
+    EnableFileHashing = value;
+  }
+
+  void setPreviousContentHashes(llvm::StringMap<std::string> hashes) {
+    PreviousContentHashes = std::move(hashes);
+  }
+
+  /// Returns the hash of the contents of \p input in the last build, or an
+  /// empty string if it isn't known.
+  StringRef getPreviousContentHash(StringRef input) const {
+    auto found = PreviousContentHashes.find(input);
+    if (found == PreviousContentHashes.end())
+      return StringRef();
+    return found->getValue();
+  }
+
+  void setShowDriverTimeCompilation(bool value = true) {
+    ShowDriverTimeCompilation = value;
+  }
+
+  void setServeJobs(bool value = true) {
+    ServeJobs = value;
+  }
+
+  void setOutputCache(std::unique_ptr<OutputCache> cache);
+
   /// Requests the path to a file containing all input source files. This can
   /// be shared across jobs.
   ///
@@ -207,6 +293,18 @@ public:
   /// \sa types::isPartOfSwiftCompilation
   const char *getAllSourcesPath() const;
 
+  /// Returns the path to a temporary file listing the contents of the -I and
+  /// -F search paths, which is written just before the Jobs are performed.
+  ///
+  /// \sa ModuleLocationMap
+  const char *getModuleLocationMapPath() const;
+
+  /// Returns the path returned by getModuleLocationMapPath, or null if it
+  /// hasn't been asked for.
+  const char *getModuleLocationMapPathIfCreated() const {
+    return ModuleLocationMapPath;
+  }
+
   /// Asks the Compilation to perform the Jobs which it knows about.
   /// \returns result code for the Compilation's Jobs; 0 indicates success and
   /// -2 indicates that one of the Compilation's Jobs crashed during execution
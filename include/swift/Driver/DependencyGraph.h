@@ -66,6 +66,13 @@ public:
     class Entry;
     llvm::DenseMap<const void *, SmallVector<Entry, 4>> Table;
 
+    /// The entries that were not followed out of each starting node, because
+    /// their fingerprints were unchanged.
+    llvm::DenseMap<const void *, SmallVector<Entry, 4>> Unchanged;
+
+    /// Describes what \p entry provides, without a trailing newline.
+    static void printEntry(raw_ostream &out, const Entry &entry);
+
     friend class DependencyGraphImpl;
   protected:
     MarkTracerImpl();
@@ -73,6 +80,8 @@ public:
 
     void printPath(raw_ostream &out, const void *item,
                    llvm::function_ref<void(const void *)> printItem) const;
+    void printUnchanged(raw_ostream &out, const void *item,
+                        llvm::function_ref<void(const void *)> printItem) const;
   };
 
 private:
@@ -90,6 +99,16 @@ private:
   struct ProvidesEntryTy {
     std::string name;
     DependencyMaskTy kindMask;
+
+    /// The fingerprints of the declarations behind this entry, as of the
+    /// last load, and the kinds of the entry that they cover.
+    std::string fingerprint;
+    DependencyMaskTy fingerprintedKinds;
+
+    /// Whether the last load found the same fingerprint, covering every
+    /// kind of the entry, as the load before it. Such an entry is not
+    /// followed when marking from its node.
+    bool isUnchanged;
   };
   static_assert(std::is_move_constructible<ProvidesEntryTy>::value, "");
 
@@ -233,6 +252,17 @@ public:
         printItem(out, Traits::getFromVoidPointer(n));
       });
     }
+
+    /// Dump the entries of \p node that were not followed the last time it
+    /// was marked from, because their fingerprints hadn't changed.
+    void printUnchanged(raw_ostream &out, T node,
+                        llvm::function_ref<void(raw_ostream &, T)> printItem)
+        const {
+      MarkTracerImpl::printUnchanged(out, Traits::getAsVoidPointer(node),
+                                     [printItem, &out](const void *n) {
+        printItem(out, Traits::getFromVoidPointer(n));
+      });
+    }
   };
 
   /// Load "depends" and "provides" data for \p node from the file at the given
@@ -277,6 +307,10 @@ public:
   /// Nodes that are only reachable through "non-cascading" edges are added to
   /// the \p visited set, but are \em not added to the graph's marked set.
   ///
+  /// The "provides" entries of \p node itself whose fingerprints were the
+  /// same in its last two loads are not followed, since the declarations
+  /// behind them haven't changed.
+  ///
   /// If you want to see how each node gets added to \p visited, pass a local
   /// MarkTracer instance to \p tracer.
   template <unsigned N>
@@ -120,6 +120,9 @@ private:
   /// The modification time of the main input file, if any.
   llvm::sys::TimeValue InputModTime = llvm::sys::TimeValue::MaxTime();
 
+  /// The hash of the contents of the main input file, if it is known.
+  std::string InputContentHash;
+
 public:
   Job(const JobAction &Source,
       SmallVectorImpl<const Job *> &&Inputs,
@@ -160,6 +163,14 @@ public:
     return InputModTime;
   }
 
+  void setInputContentHash(StringRef hash) {
+    InputContentHash = hash;
+  }
+
+  StringRef getInputContentHash() const {
+    return InputContentHash;
+  }
+
   ArrayRef<std::pair<const char *, const char *>> getExtraEnvironment() const {
     return ExtraEnvironment;
   }
@@ -0,0 +1,112 @@
+//===--- OutputCache.h - Reuse frontend job outputs -------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief A content-addressed cache of the outputs of compile jobs, so that a
+/// job which has already been run somewhere with the same inputs doesn't
+/// have to be run again.
+///
+/// A job is looked up in two steps. Its command line, with the output paths
+/// taken out, and the contents of the source files give a base key, under
+/// which is kept the list of files outside the module that the job read the
+/// last time it ran, taken from its reference dependencies ("swiftdeps")
+/// file. The contents of those files, which are mostly the imported modules,
+/// are then added to the base key to give the key of the outputs themselves.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_DRIVER_OUTPUTCACHE_H
+#define SWIFT_DRIVER_OUTPUTCACHE_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <memory>
+#include <string>
+
+namespace swift {
+namespace driver {
+
+class Compilation;
+class Job;
+
+/// Where an OutputCache keeps its entries.
+class OutputCacheBackend {
+public:
+  virtual ~OutputCacheBackend() = default;
+
+  /// Looks up the entry stored under \p key.
+  ///
+  /// \returns false if there is no such entry
+  virtual bool get(StringRef key, std::string &contents) = 0;
+
+  /// Stores \p contents under \p key, replacing any existing entry.
+  /// Failures are ignored, since they only mean a later lookup will miss.
+  virtual void put(StringRef key, StringRef contents) = 0;
+
+  /// Creates a backend which keeps each entry in a file under \p path,
+  /// creating the directory if necessary.
+  ///
+  /// \returns null if the directory can't be created
+  static std::unique_ptr<OutputCacheBackend>
+  createLocal(StringRef path, std::string &error);
+
+  /// Creates a backend which runs \p program to access a remote store,
+  /// passing it "get" or "put", the key and the path of a file to write the
+  /// entry to or read it from. For "get", a non-zero exit status means there
+  /// is no entry.
+  static std::unique_ptr<OutputCacheBackend> createCommand(StringRef program);
+};
+
+/// Restores the outputs of compile jobs from a local backend, falling back to
+/// an optional remote one, and stores them after jobs have been run.
+class OutputCache {
+  std::unique_ptr<OutputCacheBackend> Local;
+  std::unique_ptr<OutputCacheBackend> Remote;
+
+  /// The base keys of the jobs which missed, so that their outputs can be
+  /// stored when they finish.
+  llvm::DenseMap<const Job *, std::string> MissedKeys;
+
+  bool get(StringRef key, std::string &contents);
+  void put(StringRef key, StringRef contents);
+
+public:
+  unsigned Hits = 0;
+  unsigned Misses = 0;
+
+  OutputCache(std::unique_ptr<OutputCacheBackend> local,
+              std::unique_ptr<OutputCacheBackend> remote)
+    : Local(std::move(local)), Remote(std::move(remote)) {}
+
+  /// Returns true if the outputs of \p cmd can be cached: it is a compile
+  /// job which writes a swiftdeps file and no outputs that depend on where
+  /// files are.
+  static bool isCacheable(const Job &cmd);
+
+  /// Writes out the cached outputs of \p cmd, which is cacheable.
+  ///
+  /// \param[out] output what the job printed when it was run
+  /// \returns false on a miss, in which case the job has to be run and then
+  /// passed to store().
+  bool restore(const Compilation &C, const Job &cmd, std::string &output);
+
+  /// Stores the outputs of \p cmd, which has just succeeded after a miss,
+  /// printing \p output.
+  void store(const Compilation &C, const Job &cmd, StringRef output);
+};
+
+} // end namespace driver
+} // end namespace swift
+
+#endif
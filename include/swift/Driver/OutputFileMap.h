@@ -64,6 +64,14 @@ private:
   ///
   /// \returns true on error, false on success
   bool parse(std::unique_ptr<llvm::MemoryBuffer> Buffer);
+
+  /// \brief Parses \p Data into the OutputFileMap directly, without building
+  /// a YAML node tree, if it is in the plain subset of JSON which build
+  /// systems write.
+  ///
+  /// \returns true if \p Data could not be read this way, in which case the
+  /// OutputFileMap may have been partially filled in; false on success
+  bool parseJSON(StringRef Data);
 };
 
 } // end namespace driver
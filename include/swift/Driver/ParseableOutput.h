@@ -33,17 +33,29 @@ using swift::sys::ProcessId;
 /// \brief Emits a "began" message to the given stream.
 void emitBeganMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid);
 
-/// \brief Emits a "finished" message to the given stream.
+/// \brief Emits a "finished" message to the given stream, including whatever
+/// parts of \p Usage were measured.
 void emitFinishedMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid,
-                         int ExitStatus, StringRef Output);
+                         int ExitStatus, StringRef Output,
+                         const sys::TaskResourceUsage &Usage);
 
-/// \brief Emits a "signalled" message to the given stream.
+/// \brief Emits a "signalled" message to the given stream, including whatever
+/// parts of \p Usage were measured.
 void emitSignalledMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid,
-                          StringRef ErrorMsg, StringRef Output);
+                          StringRef ErrorMsg, StringRef Output,
+                          const sys::TaskResourceUsage &Usage);
 
 /// \brief Emits a "skipped" message to the given stream.
 void emitSkippedMessage(raw_ostream &os, const Job &Cmd);
 
+/// \brief Emits a "cached" message to the given stream, for a job whose
+/// outputs were restored from the output cache instead of running it.
+void emitCachedMessage(raw_ostream &os, const Job &Cmd, StringRef Output);
+
+/// \brief Emits an "output-cache" message to the given stream, with the
+/// numbers of cache hits and misses.
+void emitOutputCacheMessage(raw_ostream &os, unsigned Hits, unsigned Misses);
+
 } // end namespace parseable_output
 } // end namespace driver
 } // end namespace swift
@@ -77,6 +77,9 @@ protected:
     /// Forwards to Compilation::getAllSourcesPath.
     const char *getAllSourcesPath() const;
 
+    /// Forwards to Compilation::getModuleLocationMapPath.
+    const char *getModuleLocationMapPath() const;
+
     /// Creates a new temporary file for use by a job.
     ///
     /// The returned string already has its lifetime extended to match other
@@ -122,6 +125,9 @@ protected:
   constructInvocation(const GenerateDSYMJobAction &job,
                       const JobContext &context) const;
   virtual InvocationInfo
+  constructInvocation(const GeneratePCHJobAction &job,
+                      const JobContext &context) const;
+  virtual InvocationInfo
   constructInvocation(const AutolinkExtractJobAction &job,
                       const JobContext &context) const;
   virtual InvocationInfo
@@ -160,6 +166,19 @@ public:
                                     std::unique_ptr<CommandOutput> output,
                                     const OutputInfo &OI) const;
 
+  /// Returns true if \p job compiles a single primary file with the Swift
+  /// frontend, and so can be combined with other such jobs by
+  /// constructBatchJob.
+  static bool jobIsBatchable(const Job &job);
+
+  /// Construct a Job which does the work of all of \p jobs in a single
+  /// frontend invocation with several primary files.
+  ///
+  /// The jobs must all be batchable, and must come from the same
+  /// compilation. The new job's outputs are those of the first of them;
+  /// callers are expected to track the jobs that it stands for.
+  static std::unique_ptr<Job> constructBatchJob(ArrayRef<const Job *> jobs);
+
   /// Return the default language type to use for the given extension.
   virtual types::ID lookupTypeForExtension(StringRef Ext) const;
 };
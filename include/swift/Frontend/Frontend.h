@@ -299,6 +299,9 @@ public:
 /// calling \a setup.  If successful, this will create an ASTContext
 /// and set up the basic compiler invariants.  Calling \a setup multiple
 /// times on a single CompilerInstance is not permitted.
+///
+/// The ASTContext can also be created ahead of time with
+/// \a prepareASTContext, before the invocation's inputs are known.
 class CompilerInstance {
   CompilerInvocation Invocation;
   SourceManager SourceMgr;
@@ -333,6 +336,11 @@ class CompilerInstance {
   void createSILModule(bool WholeModule = false);
   void setPrimarySourceFile(SourceFile *SF);
 
+  /// Creates the ASTContext and its module loaders for the current
+  /// invocation.
+  /// \returns true if there was an error
+  bool setUpASTContext();
+
 public:
   SourceManager &getSourceMgr() { return SourceMgr; }
 
@@ -406,6 +414,16 @@ public:
   /// \brief Returns true if there was an error during setup.
   bool setup(const CompilerInvocation &Invocation);
 
+  /// \brief Creates the ASTContext for \p Invocation and loads the standard
+  /// library into it, which is the first thing that type-checking does.
+  ///
+  /// A later call to \a setup then keeps the ASTContext, so it must be
+  /// passed an invocation which differs from \p Invocation only in its
+  /// inputs and outputs. The dependency tracker has to be set before this.
+  ///
+  /// \returns true if there was an error
+  bool prepareASTContext(const CompilerInvocation &Invocation);
+
   /// Parses and type-checks all input files.
   void performSema();
 
@@ -112,12 +112,20 @@ public:
   /// The path to which we should output a Swift reference dependencies file.
   std::string ReferenceDependenciesFilePath;
 
+  /// Whether the reference dependencies file should be written as YAML,
+  /// which is easier to read than the binary form the driver expects.
+  bool EmitYAMLReferenceDependencies = false;
+
   /// The path to which we should output fixits as source edits.
   std::string FixitsOutputPath;
 
   /// Arguments which should be passed in immediate mode.
   std::vector<std::string> ImmediateArgv;
 
+  /// The directory in which immediate mode caches compiled scripts, or empty
+  /// if scripts should be compiled on every run.
+  std::string ScriptCachePath;
+
   /// \brief A list of arguments to forward to LLVM's option processing; this
   /// should only be used for debugging and experimental features.
   std::vector<std::string> LLVMArgs;
@@ -160,6 +168,8 @@ public:
     EmitIR, ///< Emit LLVM IR
     EmitBC, ///< Emit LLVM BC
     EmitObject, ///< Emit object file
+
+    EmitPCH, ///< Emit PCH of imported bridging header
   };
 
   /// Indicates the action the user requested that the frontend perform.
@@ -181,10 +191,26 @@ public:
   /// \sa swift::SharedTimer
   bool DebugTimeCompilation = false;
 
+  /// The directory in which a JSON file of the statistics of this job is
+  /// written, or empty if no statistics are written.
+  ///
+  /// \sa swift::UnifiedStatsReporter
+  std::string StatsOutputDir;
+
+  /// The directory in which a Chrome trace of this job is written, or empty
+  /// if no trace is written.
+  ///
+  /// \sa swift::TraceEventRecorder
+  std::string TraceOutputDir;
+
   /// Indicates whether function body parsing should be delayed
   /// until the end of all files.
   bool DelayedFunctionBodyParsing = false;
 
+  /// Indicates whether the bodies of functions in files other than the
+  /// primary file should only be lexed, unless they may be inlined.
+  bool SkipNonPrimaryFunctionBodies = false;
+
   /// Indicates whether or not an import statement can pick up a Swift source
   /// file (as opposed to a module file).
   bool EnableSourceImport = false;
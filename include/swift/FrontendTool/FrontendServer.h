@@ -0,0 +1,62 @@
+//===--- FrontendServer.h - Long-lived frontend process ---------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A frontend server runs frontend jobs handed to it over a Unix domain
+// socket, so that the work every frontend process does before it gets to the
+// job's own files is only done once.
+//
+// For each set of compatible options, as given by getPreparedContextKey(),
+// the server keeps a process whose ASTContext has been set up and has loaded
+// the standard library. Each job runs in a process forked from that one, so
+// it starts with exactly the state a fresh frontend would have had after
+// loading the standard library, and can't leave anything behind for the
+// next job. Jobs that can't use a prepared ASTContext run in a process
+// forked from the server itself.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_FRONTENDTOOL_FRONTENDSERVER_H
+#define SWIFT_FRONTENDTOOL_FRONTENDSERVER_H
+
+#include "swift/Basic/LLVM.h"
+
+namespace swift {
+
+/// Runs a frontend server listening on the Unix domain socket at
+/// \p socketPath, until it has had no jobs for \p idleTimeout seconds.
+///
+/// \param argv0 the name used as the frontend executable
+/// \param mainAddr an address from the main executable
+///
+/// \returns the exit value of the server
+int runFrontendServer(StringRef socketPath, unsigned idleTimeout,
+                      const char *argv0, void *mainAddr);
+
+/// Hands a frontend job to the server listening at \p socketPath, with this
+/// process's working directory, environment and standard streams, and waits
+/// for it to finish.
+///
+/// If the job's process was killed by a signal, this process is killed by
+/// the same signal.
+///
+/// \param args the arguments to the frontend
+/// \param[out] result the exit value of the job
+///
+/// \returns false if the job wasn't run, because there is no server or it is
+/// running a different executable, in which case the caller should run the
+/// job itself
+bool forwardToFrontendServer(StringRef socketPath, ArrayRef<const char *> args,
+                             const char *argv0, void *mainAddr, int &result);
+
+} // namespace swift
+
+#endif
@@ -20,6 +20,8 @@
 
 #include "swift/Basic/LLVM.h"
 
+#include <string>
+
 namespace llvm {
 class Module;
 }
@@ -78,6 +80,23 @@ int performFrontend(ArrayRef<const char *> args,
                     void *mainAddr,
                     FrontendObserver *observer = nullptr);
 
+/// Like performFrontend, but compiles with \p instance, whose ASTContext
+/// may already have been created by CompilerInstance::prepareASTContext for
+/// a command line with the same getPreparedContextKey().
+int performFrontend(CompilerInstance &instance,
+                    ArrayRef<const char *> args,
+                    const char *argv0,
+                    void *mainAddr,
+                    FrontendObserver *observer = nullptr);
+
+/// Returns a key which is the same for two frontend command lines if an
+/// ASTContext prepared for one of them can be used to compile the other:
+/// the arguments, leaving out the inputs and where the outputs go.
+///
+/// \returns an empty string for command lines that don't compile exactly
+/// one primary file, which are never run with a prepared ASTContext
+std::string getPreparedContextKey(ArrayRef<const char *> args);
+
 
 } // namespace swift
 
@@ -18,6 +18,9 @@
 #ifndef SWIFT_IMMEDIATE_IMMEDIATE_H
 #define SWIFT_IMMEDIATE_IMMEDIATE_H
 
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 #include <string>
 #include <vector>
 
@@ -35,9 +38,30 @@ namespace swift {
 
   /// Attempt to run the script identified by the given compiler instance.
   ///
+  /// If \p ScriptCacheEntry is not empty, the script is compiled ahead of
+  /// time and stored there, so that runCachedScript can run it again.
+  ///
   /// \return the result returned from main(), if execution succeeded
   int RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
-                     IRGenOptions &IRGenOpts, const SILOptions &SILOpts);
+                     IRGenOptions &IRGenOpts, const SILOptions &SILOpts,
+                     StringRef ScriptCacheEntry = StringRef());
+
+  /// Returns the path, without extension, at which the script identified by
+  /// the given compiler instance and frontend arguments is stored in the
+  /// script cache directory \p CachePath.
+  ///
+  /// The path depends on the contents of the input files, the compiler
+  /// version and the arguments, so changing any of them causes a miss.
+  std::string getScriptCacheEntry(CompilerInstance &CI, StringRef CachePath,
+                                  ArrayRef<const char *> Args);
+
+  /// Attempt to run the script stored at \p ScriptCacheEntry without
+  /// compiling it.
+  ///
+  /// \return true if the script was found and run, in which case
+  /// \p ReturnValue is the result returned from main()
+  bool runCachedScript(CompilerInstance &CI, StringRef ScriptCacheEntry,
+                       const ProcessCmdLine &CmdLine, int &ReturnValue);
 
   void runREPL(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
                bool ParseStdlib);
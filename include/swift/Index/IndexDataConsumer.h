@@ -28,6 +28,10 @@ public:
   virtual void warning(StringRef warning) {}
   virtual bool enableWarnings() { return false; }
 
+  /// Returns true if the consumer's store already holds the index unit of
+  /// the file or module with \p hash, so that it need not be walked again.
+  virtual bool isUnitUpToDate(StringRef hash) { return false; }
+
   virtual bool recordHash(StringRef hash, bool isKnown) = 0;
   virtual bool startDependency(SymbolKind kind, StringRef name, StringRef path,
                                bool isSystem, StringRef hash) = 0;
@@ -32,6 +32,9 @@ namespace swift {
     using AAResultBase::getModRefInfo;
     llvm::ModRefInfo getModRefInfo(llvm::ImmutableCallSite CS,
                                    const llvm::MemoryLocation &Loc);
+
+    llvm::AliasResult alias(const llvm::MemoryLocation &LocA,
+                            const llvm::MemoryLocation &LocB);
   };
 
   class SwiftAAWrapperPass : public llvm::ImmutablePass {
@@ -88,11 +91,17 @@ namespace swift {
   };
 
   class SwiftStackPromotion : public llvm::FunctionPass {
+    /// The maximum number of bytes which may be allocated on the stack in a
+    /// function, including existing allocas. If negative, the value of the
+    /// -stack-promotion-limit LLVM option is used.
+    int SizeLimit;
+
     virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
     virtual bool runOnFunction(llvm::Function &F) override;
   public:
     static char ID;
-    SwiftStackPromotion() : llvm::FunctionPass(ID) {}
+    SwiftStackPromotion(int SizeLimit = -1)
+      : llvm::FunctionPass(ID), SizeLimit(SizeLimit) {}
   };
 
   class InlineTreePrinter : public llvm::ModulePass {
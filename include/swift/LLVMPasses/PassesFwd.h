@@ -31,7 +31,7 @@ namespace llvm {
 namespace swift {
   llvm::FunctionPass *createSwiftARCOptPass();
   llvm::FunctionPass *createSwiftARCContractPass();
-  llvm::FunctionPass *createSwiftStackPromotionPass();
+  llvm::FunctionPass *createSwiftStackPromotionPass(int SizeLimit = -1);
   llvm::ModulePass *createInlineTreePrinterPass();
   llvm::ModulePass *createSwiftMergeFunctionsPass();
   llvm::ImmutablePass *createSwiftAAWrapperPass();
@@ -19,10 +19,12 @@
 #define SWIFT_REFLECTION_TYPEREF_H
 
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Casting.h"
 #include "swift/ABI/MetadataValues.h"
 
 #include <iostream>
+#include <vector>
 
 namespace swift {
 namespace reflection {
@@ -36,14 +38,22 @@ enum class TypeRefKind {
 #undef TYPEREF
 };
 
+#define TYPEREF(Id, Parent) class Id##TypeRef;
+#include "swift/Reflection/TypeRefs.def"
+#undef TYPEREF
+
+/// Maps each TypeRef class to its kind.
+template <typename TypeRefTy> struct TypeRefKindOf;
+#define TYPEREF(Id, Parent) \
+  template <> struct TypeRefKindOf<Id##TypeRef> { \
+    static constexpr TypeRefKind value = TypeRefKind::Id; \
+  };
+#include "swift/Reflection/TypeRefs.def"
+#undef TYPEREF
+
 #define FIND_OR_CREATE_TYPEREF(Allocator, TypeRefTy, ...) \
-  auto ID = Profile(__VA_ARGS__); \
-  const auto Entry = Allocator.template TypeRefTy##s.find(ID); \
-  if (Entry != Allocator.template TypeRefTy##s.end()) \
-    return Entry->second; \
-  const auto TR = Allocator.template makeTypeRef<TypeRefTy>(__VA_ARGS__); \
-  Allocator.template TypeRefTy##s.insert({ID, TR}); \
-  return TR;
+  return Allocator.template findOrCreateTypeRef<TypeRefTy>( \
+    Profile(__VA_ARGS__), __VA_ARGS__);
 
 /// An identifier containing the unique bit pattern made up of all of the
 /// instance data needed to uniquely identify a TypeRef.
@@ -56,9 +66,23 @@ enum class TypeRefKind {
 /// it should return the one already created with those arguments, not a fresh
 /// copy. This allows for fast identity comparisons and substitutions, for
 /// example. We use a similar strategy for Types in the full AST.
+///
+/// The hash is accumulated as bits are added, so that it never has to be
+/// recomputed when the uniquing table grows.
 class TypeRefID {
+  friend struct llvm::DenseMapInfo<TypeRefID>;
+
+  /// The kind of the TypeRef, or one of the DenseMapInfo marker values.
+  unsigned Kind = 0;
+
+  llvm::SmallVector<uint32_t, 8> Bits;
+
+  std::size_t Hash = 0;
 
-  std::vector<uint32_t> Bits;
+  void addBits(uint32_t Value) {
+    Bits.push_back(Value);
+    Hash ^= Value + 0x9e3779b9 + (Hash << 6) + (Hash >> 2);
+  }
 
 public:
   TypeRefID() = default;
@@ -66,24 +90,24 @@ public:
   template <typename T>
   void addPointer(const T *Pointer) {
     auto Raw = reinterpret_cast<uint32_t *>(&Pointer);
-    Bits.push_back(Raw[0]);
+    addBits(Raw[0]);
     if (sizeof(const T *) > 4) {
-      Bits.push_back(Raw[1]);
+      addBits(Raw[1]);
     }
   }
 
   void addInteger(uint32_t Integer) {
-    Bits.push_back(Integer);
+    addBits(Integer);
   }
 
   void addInteger(uint64_t Integer) {
-    Bits.push_back((uint32_t)Integer);
-    Bits.push_back(Integer >> 32);
+    addBits((uint32_t)Integer);
+    addBits(Integer >> 32);
   }
 
   void addString(const std::string &String) {
     if (String.empty()) {
-      Bits.push_back(0);
+      addBits(0);
     } else {
       size_t i = 0;
       size_t chunks = String.size() / 4;
@@ -92,34 +116,26 @@ public:
                          (((uint32_t) String[i+1]) << 8) +
                          (((uint32_t) String[i+2]) << 16) +
                          (((uint32_t) String[i+3]) << 24);
-        Bits.push_back(entry);
+        addBits(entry);
       }
       for (; i < String.size(); ++i) {
-        Bits.push_back(String[i]);
+        addBits(String[i]);
       }
     }
   }
 
-  struct Hash {
-    std::size_t operator()(TypeRefID const &ID) const {
-      size_t Hash = 0;
-      std::hash<uint32_t> h;
-      for (auto x : ID.Bits) {
-        Hash ^= h(x) + 0x9e3779b9 + (Hash << 6) + (Hash >> 2);
-      }
-      return Hash;
-    }
-  };
-
-  struct Equal {
-    bool operator()(const TypeRefID &lhs, const TypeRefID &rhs) const {
-      return lhs.Bits == rhs.Bits;
-    }
-  };
+  /// Distinguish TypeRefs of different kinds that happen to be made of the
+  /// same bits.
+  void setKind(TypeRefKind K) {
+    Kind = unsigned(K);
+  }
 
+  std::size_t getHash() const {
+    return Hash ^ Kind;
+  }
 
-  bool operator==(const TypeRefID &Other) {
-    return Bits == Other.Bits;
+  bool operator==(const TypeRefID &Other) const {
+    return Kind == Other.Kind && Hash == Other.Hash && Bits == Other.Bits;
   }
 };
 
@@ -778,4 +794,27 @@ public:
 } // end namespace reflection
 } // end namespace swift
 
+namespace llvm {
+template <> struct DenseMapInfo<swift::reflection::TypeRefID> {
+  using TypeRefID = swift::reflection::TypeRefID;
+
+  static TypeRefID getEmptyKey() {
+    TypeRefID ID;
+    ID.Kind = ~0U;
+    return ID;
+  }
+  static TypeRefID getTombstoneKey() {
+    TypeRefID ID;
+    ID.Kind = ~0U - 1;
+    return ID;
+  }
+  static unsigned getHashValue(const TypeRefID &ID) {
+    return ID.getHash();
+  }
+  static bool isEqual(const TypeRefID &LHS, const TypeRefID &RHS) {
+    return LHS == RHS;
+  }
+};
+} // end namespace llvm
+
 #endif // SWIFT_REFLECTION_TYPEREF_H
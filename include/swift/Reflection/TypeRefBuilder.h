@@ -23,11 +23,13 @@
 #include "swift/Reflection/Records.h"
 #include "swift/Reflection/TypeLowering.h"
 #include "swift/Reflection/TypeRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/Support/Allocator.h"
 
+#include <cstdint>
 #include <iostream>
 #include <vector>
-#include <unordered_map>
 
 class NodePointer;
 
@@ -111,24 +113,42 @@ public:
   TypeRefBuilder(const TypeRefBuilder &other) = delete;
   TypeRefBuilder &operator=(const TypeRefBuilder &other) = delete;
 
+  ~TypeRefBuilder();
+
 private:
-  /// Makes sure dynamically allocated TypeRefs stick around for the life of
-  /// this TypeRefBuilder and are automatically released.
-  std::vector<std::unique_ptr<const TypeRef>> TypeRefPool;
+  /// The memory for every TypeRef vended by this builder.
+  llvm::BumpPtrAllocator TypeRefAllocator;
+
+  /// The TypeRefs allocated so far, so that they can be destroyed along
+  /// with this TypeRefBuilder.
+  std::vector<const TypeRef *> TypeRefPool;
 
   TypeConverter TC;
   MetadataSourceBuilder MSB;
 
-#define TYPEREF(Id, Parent) \
-  std::unordered_map<TypeRefID, const Id##TypeRef *, \
-                     TypeRefID::Hash, TypeRefID::Equal> Id##TypeRefs;
-#include "swift/Reflection/TypeRefs.def"
+  /// TypeRefs of every kind, uniqued by their kind and structure.
+  llvm::DenseMap<TypeRefID, const TypeRef *> TypeRefs;
 
 public:
   template <typename TypeRefTy, typename... Args>
   const TypeRefTy *makeTypeRef(Args... args) {
-    const auto TR = new TypeRefTy(::std::forward<Args>(args)...);
-    TypeRefPool.push_back(std::unique_ptr<const TypeRef>(TR));
+    void *Mem = TypeRefAllocator.Allocate(sizeof(TypeRefTy),
+                                          alignof(TypeRefTy));
+    const auto TR = new (Mem) TypeRefTy(::std::forward<Args>(args)...);
+    TypeRefPool.push_back(TR);
+    return TR;
+  }
+
+  /// Return the TypeRef identified by \p ID, creating it from \p args if
+  /// this is the first time it's been asked for.
+  template <typename TypeRefTy, typename... Args>
+  const TypeRefTy *findOrCreateTypeRef(TypeRefID ID, Args... args) {
+    ID.setKind(TypeRefKindOf<TypeRefTy>::value);
+    auto Inserted = TypeRefs.insert({std::move(ID), nullptr});
+    if (!Inserted.second)
+      return static_cast<const TypeRefTy *>(Inserted.first->second);
+    const auto TR = makeTypeRef<TypeRefTy>(::std::forward<Args>(args)...);
+    Inserted.first->second = TR;
     return TR;
   }
 
@@ -305,10 +325,19 @@ public:
 
   void dumpTypeRef(const std::string &MangledName,
                    std::ostream &OS, bool printTypeName = false);
-  void dumpFieldSection(std::ostream &OS);
-  void dumpAssociatedTypeSection(std::ostream &OS);
-  void dumpBuiltinTypeSection(std::ostream &OS);
-  void dumpCaptureSection(std::ostream &OS);
+
+  /// The records of each section are numbered in order across all of the
+  /// images. These dump the records numbered in [Begin, End), so that the
+  /// dump of a section can be split up between several builders.
+  void dumpFieldSection(std::ostream &OS, size_t Begin = 0,
+                        size_t End = SIZE_MAX);
+  void dumpAssociatedTypeSection(std::ostream &OS, size_t Begin = 0,
+                                 size_t End = SIZE_MAX);
+  void dumpBuiltinTypeSection(std::ostream &OS, size_t Begin = 0,
+                              size_t End = SIZE_MAX);
+  void dumpCaptureSection(std::ostream &OS, size_t Begin = 0,
+                          size_t End = SIZE_MAX);
+
   void dumpAllSections(std::ostream &OS);
 };
 
@@ -0,0 +1,285 @@
+//===--- CachingMemoryReader.h - Page cache for remote memory ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares a MemoryReader which reads the memory of another
+//  reader a page at a time and keeps the pages around, so that the many
+//  small reads done by MetadataReader turn into a few large ones.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_REMOTE_CACHINGMEMORYREADER_H
+#define SWIFT_REMOTE_CACHINGMEMORYREADER_H
+
+#include "swift/Remote/MemoryReader.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace swift {
+namespace remote {
+
+/// A MemoryReader which caches whole pages of the memory of another
+/// reader.
+///
+/// The cache assumes that the remote memory doesn't change while it is
+/// being read, as is the case for a suspended or crashed process. Call
+/// flush() after letting the process run.
+///
+/// The underlying reader has to tolerate reads of any part of a page that
+/// holds something else that was read. Reads of pages that fail are
+/// remembered and go straight to the underlying reader from then on.
+class CachingMemoryReader final : public MemoryReader {
+public:
+  /// How well the cache is doing.
+  struct Statistics {
+    /// The number of bytes asked for by clients.
+    uint64_t BytesRequested = 0;
+    /// The number of bytes read from the underlying reader.
+    uint64_t BytesRead = 0;
+    /// The number of reads, single or batched, made on the underlying
+    /// reader.
+    uint64_t RemoteReads = 0;
+    /// The number of pages found in the cache.
+    uint64_t PageHits = 0;
+    /// The number of pages that had to be read.
+    uint64_t PageMisses = 0;
+  };
+
+private:
+  std::shared_ptr<MemoryReader> Underlying;
+  uint64_t PageSize;
+  unsigned MaxPages;
+
+  /// The cached pages, by address.
+  llvm::DenseMap<uint64_t, std::unique_ptr<uint8_t[]>> Pages;
+
+  /// The pages in the order they were read, for eviction.
+  std::vector<uint64_t> PageOrder;
+  unsigned NextEviction = 0;
+
+  /// The pages that the underlying reader couldn't read.
+  llvm::DenseSet<uint64_t> UnreadablePages;
+
+  Statistics Stats;
+
+  uint64_t getPageAddress(uint64_t address) const {
+    return address & ~(PageSize - 1);
+  }
+
+  /// Make room for one more page, evicting the oldest one if the cache is
+  /// full.
+  std::unique_ptr<uint8_t[]> &insertPage(uint64_t pageAddress) {
+    if (PageOrder.size() < MaxPages) {
+      PageOrder.push_back(pageAddress);
+    } else {
+      Pages.erase(PageOrder[NextEviction]);
+      PageOrder[NextEviction] = pageAddress;
+      NextEviction = (NextEviction + 1) % MaxPages;
+    }
+    return Pages[pageAddress];
+  }
+
+  /// Read a page directly from the underlying reader.
+  const uint8_t *readPage(uint64_t pageAddress) {
+    std::unique_ptr<uint8_t[]> bytes(new uint8_t[PageSize]);
+    ++Stats.RemoteReads;
+    ++Stats.PageMisses;
+    if (!Underlying->readBytes(RemoteAddress(pageAddress), bytes.get(),
+                               PageSize)) {
+      UnreadablePages.insert(pageAddress);
+      return nullptr;
+    }
+    Stats.BytesRead += PageSize;
+    auto &slot = insertPage(pageAddress);
+    slot = std::move(bytes);
+    return slot.get();
+  }
+
+  /// Return the contents of the page at \p pageAddress, or null if it
+  /// can't be read as a whole.
+  const uint8_t *getPage(uint64_t pageAddress) {
+    auto found = Pages.find(pageAddress);
+    if (found != Pages.end()) {
+      ++Stats.PageHits;
+      return found->second.get();
+    }
+    if (UnreadablePages.count(pageAddress))
+      return nullptr;
+    return readPage(pageAddress);
+  }
+
+  /// Read bytes that lie within a single page.
+  bool readFromPage(uint64_t address, uint8_t *dest, uint64_t size) {
+    uint64_t pageAddress = getPageAddress(address);
+    assert(address + size <= pageAddress + PageSize &&
+           "read crosses a page boundary");
+    if (auto page = getPage(pageAddress)) {
+      memcpy(dest, page + (address - pageAddress), size);
+      return true;
+    }
+
+    // Part of the page may still be readable.
+    ++Stats.RemoteReads;
+    if (!Underlying->readBytes(RemoteAddress(address), dest, size))
+      return false;
+    Stats.BytesRead += size;
+    return true;
+  }
+
+public:
+  /// \param pageSize The size of the reads made on \p underlying. Must be a
+  ///   power of two.
+  /// \param maxPages The number of pages to keep before evicting the
+  ///   oldest.
+  explicit CachingMemoryReader(std::shared_ptr<MemoryReader> underlying,
+                               uint64_t pageSize = 4096,
+                               unsigned maxPages = 4096)
+    : Underlying(std::move(underlying)), PageSize(pageSize),
+      MaxPages(maxPages) {
+    assert(PageSize && (PageSize & (PageSize - 1)) == 0 &&
+           "page size must be a power of two");
+    assert(MaxPages && "cache must hold at least one page");
+  }
+
+  uint8_t getPointerSize() override {
+    return Underlying->getPointerSize();
+  }
+
+  uint8_t getSizeSize() override {
+    return Underlying->getSizeSize();
+  }
+
+  RemoteAddress getSymbolAddress(const std::string &name) override {
+    return Underlying->getSymbolAddress(name);
+  }
+
+  bool readBytes(RemoteAddress address, uint8_t *dest,
+                 uint64_t size) override {
+    Stats.BytesRequested += size;
+    uint64_t current = address.getAddressData();
+    while (size) {
+      uint64_t pageEnd = getPageAddress(current) + PageSize;
+      uint64_t chunk = std::min(size, pageEnd - current);
+      if (!readFromPage(current, dest, chunk))
+        return false;
+      current += chunk;
+      dest += chunk;
+      size -= chunk;
+    }
+    return true;
+  }
+
+  /// Reads all of the pages that the batch touches and doesn't have yet
+  /// with a single batch on the underlying reader, then copies out of the
+  /// cache.
+  bool readBatch(llvm::ArrayRef<ReadRequest> requests) override {
+    llvm::SmallVector<uint64_t, 16> missing;
+    llvm::DenseSet<uint64_t> seen;
+    for (auto &request : requests) {
+      uint64_t start = request.Address.getAddressData();
+      if (!request.Size)
+        continue;
+      for (uint64_t page = getPageAddress(start),
+                    end = start + request.Size;
+           page < end; page += PageSize) {
+        if (Pages.count(page) || UnreadablePages.count(page))
+          continue;
+        if (seen.insert(page).second)
+          missing.push_back(page);
+      }
+    }
+
+    // Evictions while fetching the batch would throw away pages that it
+    // needs, so don't prefetch more than the cache holds.
+    if (!missing.empty() && missing.size() <= MaxPages) {
+      std::vector<std::unique_ptr<uint8_t[]>> buffers;
+      llvm::SmallVector<ReadRequest, 16> pageRequests;
+      for (auto page : missing) {
+        buffers.emplace_back(new uint8_t[PageSize]);
+        pageRequests.push_back({RemoteAddress(page), buffers.back().get(),
+                                PageSize});
+      }
+
+      // If the batch fails, we don't know which page was at fault, so
+      // leave the missing pages to be read one at a time.
+      ++Stats.RemoteReads;
+      if (Underlying->readBatch(pageRequests)) {
+        Stats.BytesRead += PageSize * missing.size();
+        Stats.PageMisses += missing.size();
+        for (unsigned i = 0, e = missing.size(); i != e; ++i)
+          insertPage(missing[i]) = std::move(buffers[i]);
+      }
+    }
+
+    for (auto &request : requests)
+      if (!readBytes(request.Address, request.Dest, request.Size))
+        return false;
+    return true;
+  }
+
+  bool readString(RemoteAddress address, std::string &dest) override {
+    dest.clear();
+    uint64_t current = address.getAddressData();
+    while (true) {
+      uint64_t pageAddress = getPageAddress(current);
+      auto page = getPage(pageAddress);
+      if (!page) {
+        // Let the underlying reader find the end of the rest of the string.
+        std::string rest;
+        ++Stats.RemoteReads;
+        if (!Underlying->readString(RemoteAddress(current), rest))
+          return false;
+        Stats.BytesRequested += rest.size() + 1;
+        Stats.BytesRead += rest.size() + 1;
+        dest += rest;
+        return true;
+      }
+
+      auto start = reinterpret_cast<const char *>(page) +
+                   (current - pageAddress);
+      uint64_t available = pageAddress + PageSize - current;
+      auto end = static_cast<const char *>(memchr(start, 0, available));
+      if (end) {
+        dest.append(start, end);
+        Stats.BytesRequested += (end - start) + 1;
+        return true;
+      }
+      dest.append(start, available);
+      Stats.BytesRequested += available;
+      current += available;
+    }
+  }
+
+  /// Forget everything that has been read, including which pages couldn't
+  /// be read.
+  void flush() {
+    Pages.clear();
+    PageOrder.clear();
+    NextEviction = 0;
+    UnreadablePages.clear();
+  }
+
+  const Statistics &getStatistics() const {
+    return Stats;
+  }
+};
+
+} // end namespace remote
+} // end namespace swift
+
+#endif // SWIFT_REMOTE_CACHINGMEMORYREADER_H
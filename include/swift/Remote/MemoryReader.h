@@ -19,6 +19,7 @@
 #define SWIFT_REMOTE_MEMORYREADER_H
 
 #include "swift/Remote/RemoteAddress.h"
+#include "llvm/ADT/ArrayRef.h"
 
 #include <string>
 
@@ -47,6 +48,25 @@ public:
   virtual bool readBytes(RemoteAddress address, uint8_t *dest,
                          uint64_t size) = 0;
 
+  /// One read of a batch passed to readBatch.
+  struct ReadRequest {
+    RemoteAddress Address;
+    uint8_t *Dest;
+    uint64_t Size;
+  };
+
+  /// Attempts to perform every read in \p requests. Readers that can
+  /// issue several reads with a single call into the remote process, such
+  /// as process_vm_readv or mach_vm_read_list, should override this.
+  ///
+  /// Returns false if any of the reads failed.
+  virtual bool readBatch(llvm::ArrayRef<ReadRequest> requests) {
+    for (auto &request : requests)
+      if (!readBytes(request.Address, request.Dest, request.Size))
+        return false;
+    return true;
+  }
+
   /// Attempts to read a C string from the given address in the remote
   /// process.
   ///
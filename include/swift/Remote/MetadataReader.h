@@ -489,6 +489,15 @@ private:
   std::unordered_map<StoredPointer, OwnedNominalTypeDescriptorRef>
     NominalTypeDescriptorCache;
 
+  /// A cache of built nominal type declarations, keyed by the address of
+  /// the nominal type descriptor.
+  std::unordered_map<StoredPointer, BuiltNominalTypeDecl>
+    NominalTypeDeclCache;
+
+  /// A cache of strings read from the remote process, such as mangled names
+  /// and tuple labels, keyed by their address.
+  std::unordered_map<uint64_t, std::string> StringCache;
+
   using OwnedProtocolDescriptorRef =
     std::unique_ptr<const TargetProtocolDescriptor<Runtime>, delete_with_free>;
 
@@ -520,6 +529,8 @@ public:
     TypeCache.clear();
     MetadataCache.clear();
     NominalTypeDescriptorCache.clear();
+    NominalTypeDeclCache.clear();
+    StringCache.clear();
   }
 
   /// Given a demangle tree, attempt to turn it into a type.
@@ -643,7 +654,7 @@ public:
       // Read the labels string.
       std::string labels;
       if (tupleMeta->Labels &&
-          !Reader->readString(RemoteAddress(tupleMeta->Labels), labels))
+          !readString(RemoteAddress(tupleMeta->Labels), labels))
         return BuiltType();
 
       auto BuiltTuple = Builder.createTupleType(elementTypes, std::move(labels),
@@ -698,8 +709,7 @@ public:
           return BuiltType();
 
         std::string MangledName;
-        if (!Reader->readString(RemoteAddress(ProtocolDescriptor->Name),
-                                MangledName))
+        if (!readString(RemoteAddress(ProtocolDescriptor->Name), MangledName))
           return BuiltType();
         auto Demangled = Demangle::demangleSymbolAsNode(MangledName);
         auto Protocol = decodeMangledType(Demangled);
@@ -748,7 +758,7 @@ public:
           namePtr == 0)
         return BuiltType();
       std::string name;
-      if (!Reader->readString(RemoteAddress(namePtr), name))
+      if (!readString(RemoteAddress(namePtr), name))
         return BuiltType();
       auto BuiltForeign = Builder.createForeignClassType(std::move(name));
       TypeCache[MetadataAddress] = BuiltForeign;
@@ -942,7 +952,22 @@ protected:
     if (!namePtr)
       return false;
 
-    return Reader->readString(RemoteAddress(namePtr), className);
+    return readString(RemoteAddress(namePtr), className);
+  }
+
+  /// Read a C string from the remote process, or reuse the string already
+  /// read from \p address.
+  bool readString(RemoteAddress address, std::string &dest) {
+    auto cached = StringCache.find(address.getAddressData());
+    if (cached != StringCache.end()) {
+      dest = cached->second;
+      return true;
+    }
+
+    if (!Reader->readString(address, dest))
+      return false;
+    StringCache.insert({address.getAddressData(), dest});
+    return true;
   }
 
   MetadataRef readMetadata(StoredPointer address) {
@@ -1079,15 +1104,24 @@ private:
   /// nominal type decl from it.
   BuiltNominalTypeDecl
   buildNominalTypeDecl(NominalTypeDescriptorRef descriptor) {
+    auto cached = NominalTypeDeclCache.find(descriptor.getAddress());
+    if (cached != NominalTypeDeclCache.end())
+      return cached->second;
+
     auto nameAddress
       = resolveRelativeOffset<int32_t>(descriptor.getAddress() +
                                        descriptor->offsetToNameOffset());
     std::string mangledName;
-    if (!Reader->readString(RemoteAddress(nameAddress), mangledName))
+    if (!readString(RemoteAddress(nameAddress), mangledName))
       return BuiltNominalTypeDecl();
 
     BuiltNominalTypeDecl decl =
       Builder.createNominalTypeDecl(std::move(mangledName));
+
+    // Failures are not cached, since the builder may not be able to resolve
+    // the name yet, e.g. before a module has been loaded.
+    if (decl)
+      NominalTypeDeclCache.insert({descriptor.getAddress(), decl});
     return decl;
   }
 
@@ -1140,13 +1174,15 @@ private:
     auto addressOfGenericArgAddress =
       metadata.getAddress() + offsetToGenericArgs;
 
-    using ArgIndex = decltype(descriptor->GenericParams.NumPrimaryParams);
-    for (ArgIndex i = 0; i < numGenericParams;
-         ++i, addressOfGenericArgAddress += sizeof(StoredPointer)) {
-      StoredPointer genericArgAddress;
-      if (!Reader->readInteger(RemoteAddress(addressOfGenericArgAddress),
-                               &genericArgAddress))
-        return {};
+    // The arguments are contiguous, so read them all at once.
+    std::vector<StoredPointer> genericArgAddresses(numGenericParams);
+    if (numGenericParams &&
+        !Reader->readBytes(RemoteAddress(addressOfGenericArgAddress),
+                           (uint8_t*)genericArgAddresses.data(),
+                           numGenericParams * sizeof(StoredPointer)))
+      return {};
+
+    for (auto genericArgAddress : genericArgAddresses) {
       if (auto genericArg = readTypeFromMetadata(genericArgAddress))
         substitutions.push_back(genericArg);
       else
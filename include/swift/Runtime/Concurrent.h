@@ -14,6 +14,7 @@
 #include <iterator>
 #include <atomic>
 #include <stdint.h>
+#include <thread>
 
 #if defined(__FreeBSD__)
 #include <stdio.h>
@@ -123,9 +124,16 @@ template <class ElemTy> struct ConcurrentList {
   std::atomic<ConcurrentListNode<ElemTy> *> First;
 };
 
-/// A concurrent map that is implemented using a binary tree. It supports
-/// concurrent insertions but does not support removals or rebalancing of
-/// the tree.
+/// A concurrent map that is implemented using an insert-only, open-addressed
+/// hash table. It supports concurrent insertions and lookups, but does not
+/// support removals.
+///
+/// Lookups never take a lock and never write to shared memory. Entries are
+/// allocated individually and are never moved once inserted, so a pointer
+/// returned by find or getOrInsert remains valid for the lifetime of the map.
+/// When the table grows, the old table is frozen, its entries are re-indexed
+/// into a table twice the size, and the new table is published; readers that
+/// are still walking the old table see a consistent (if stale) snapshot.
 ///
 /// The entry type must provide the following operations:
 ///
@@ -136,109 +144,272 @@ template <class ElemTy> struct ConcurrentList {
 ///   /// to find or getOrInsert.
 ///   int compareWithKey(KeyTy key) const;
 ///
+///   /// Hash a key. Keys that compare equal must hash to the same value.
+///   static size_t getKeyHash(KeyTy key);
+///
 ///   /// Return the amount of extra trailing space required by an entry,
 ///   /// where KeyTy is the type of the first argument to getOrInsert and
 ///   /// ArgTys is the type of the remaining arguments.
 ///   static size_t getExtraAllocationSize(KeyTy key, ArgTys...)
 template <class EntryTy> class ConcurrentMap {
   struct Node {
-    std::atomic<Node*> Left;
-    std::atomic<Node*> Right;
+    /// The hash of the key this node was created with. It is kept here so
+    /// that growing the table doesn't need to go back to the entry.
+    size_t Hash;
     EntryTy Payload;
 
     template <class... Args>
-    Node(Args &&... args)
-      : Left(nullptr), Right(nullptr), Payload(std::forward<Args>(args)...) {}
+    Node(size_t hash, Args &&... args)
+      : Hash(hash), Payload(std::forward<Args>(args)...) {}
 
     Node(const Node &) = delete;
     Node &operator=(const Node &) = delete;
+  };
+
+  /// A table of node pointers, followed by its slots in trailing storage.
+  struct Table {
+    /// The number of slots.  Always a power of two.
+    size_t Capacity;
 
-    ~Node() {
-      // These can be relaxed accesses because there is no safe way for
-      // another thread to race an access to this node with our destruction
-      // of it.
-      ::delete Left.load(std::memory_order_relaxed);
-      ::delete Right.load(std::memory_order_relaxed);
+    /// The table this one replaced.  Readers may still be walking it, so
+    /// old tables are only freed when the map is destroyed.
+    Table *Previous;
+
+    /// Set by the thread that has claimed the job of growing this table.
+    std::atomic<bool> Growing;
+
+    Table(size_t capacity, Table *previous)
+      : Capacity(capacity), Previous(previous), Growing(false) {
+      for (size_t i = 0; i != capacity; ++i)
+        ::new (&getSlots()[i]) std::atomic<Node*>(nullptr);
     }
 
-#ifndef NDEBUG
-    void dump() const {
-      auto L = Left.load(std::memory_order_acquire);
-      auto R = Right.load(std::memory_order_acquire);
-      printf("\"%p\" [ label = \" {<f0> %08lx | {<f1> | <f2>}}\" "
-             "style=\"rounded\" shape=\"record\"];\n",
-             this, (long) Payload.getKeyValueForDump());
-
-      if (L) {
-        L->dump();
-        printf("\"%p\":f1 -> \"%p\":f0;\n", this, L);
-      }
-      if (R) {
-        R->dump();
-        printf("\"%p\":f2 -> \"%p\":f0;\n", this, R);
-      }
+    std::atomic<Node*> *getSlots() {
+      return reinterpret_cast<std::atomic<Node*> *>(this + 1);
+    }
+
+    static Table *allocate(size_t capacity, Table *previous) {
+      void *memory = ::operator new(sizeof(Table) +
+                                    capacity * sizeof(std::atomic<Node*>));
+      return ::new (memory) Table(capacity, previous);
+    }
+
+    static void deallocate(Table *table) {
+      table->~Table();
+      ::operator delete(table);
     }
-#endif
   };
 
-  /// The root of the tree.
-  std::atomic<Node*> Root;
+  /// The capacity of the first table allocated by the map.
+  static constexpr size_t InitialCapacity = 16;
+
+  /// A value stored into the empty slots of a table that is being replaced,
+  /// so that no thread can insert into it once its contents have been
+  /// copied.  Readers treat it like an empty slot.
+  static Node *getMovedMarker() {
+    return reinterpret_cast<Node*>(uintptr_t(1));
+  }
+
+  static bool isEmptyOrMoved(Node *node) {
+    return uintptr_t(node) <= uintptr_t(1);
+  }
+
+  /// The current table, or null if nothing has been inserted yet.
+  std::atomic<Table*> Current;
+
+  /// The number of nodes in the map.  Since nodes are never removed, this
+  /// is also the number of occupied slots in the current table.
+  std::atomic<size_t> Count;
+
+  /// Walk the probe sequence for \p hash in \p table, looking for a node
+  /// matching \p key.
+  ///
+  /// \p slotIndex and \p probes are advanced in place, so that a caller
+  /// that loses a race for an empty slot can resume the walk from there.
+  /// \p slotValue receives the contents of the slot that ended the walk,
+  /// or the moved marker if every slot of the table was visited.
+  ///
+  /// \returns the matching node, or null if there isn't one in this table.
+  template <class KeyTy>
+  static Node *search(Table *table, const KeyTy &key, size_t hash,
+                      size_t &slotIndex, size_t &probes, Node *&slotValue) {
+    size_t mask = table->Capacity - 1;
+    auto slots = table->getSlots();
+    for (; probes != table->Capacity;
+         ++probes, slotIndex = (slotIndex + 1) & mask) {
+      Node *node = slots[slotIndex].load(std::memory_order_acquire);
+      slotValue = node;
+      if (isEmptyOrMoved(node))
+        return nullptr;
+      if (node->Hash == hash && node->Payload.compareWithKey(key) == 0)
+        return node;
+    }
+    slotValue = getMovedMarker();
+    return nullptr;
+  }
+
+  /// Make sure there's a table to insert into.
+  Table *getOrCreateTable() {
+    Table *table = Current.load(std::memory_order_acquire);
+    if (table)
+      return table;
+
+    Table *newTable = Table::allocate(InitialCapacity, nullptr);
+    if (Current.compare_exchange_strong(table, newTable,
+                                        std::memory_order_acq_rel,
+                                        std::memory_order_acquire))
+      return newTable;
+
+    // Somebody else got there first.
+    Table::deallocate(newTable);
+    return table;
+  }
 
-  /// This member stores the address of the last node that was found by the
-  /// search procedure. We cache the last search to accelerate code that
-  /// searches the same value in a loop.
-  std::atomic<Node*> LastSearch;
+  /// Replace \p table with a table twice its size, or wait for the thread
+  /// that is already doing so.
+  ///
+  /// \returns the table that replaced \p table.
+  Table *grow(Table *table) {
+    bool expected = false;
+    if (!table->Growing.compare_exchange_strong(expected, true,
+                                                std::memory_order_acq_rel)) {
+      // Another thread is growing the table; wait for it to publish the
+      // replacement.  Only writers ever wait here.
+      Table *current;
+      while ((current = Current.load(std::memory_order_acquire)) == table)
+        std::this_thread::yield();
+      return current;
+    }
+
+    size_t newCapacity = table->Capacity * 2;
+    Table *newTable = Table::allocate(newCapacity, table);
+    size_t newMask = newCapacity - 1;
+    auto oldSlots = table->getSlots();
+    auto newSlots = newTable->getSlots();
+
+    for (size_t i = 0; i != table->Capacity; ++i) {
+      // Freeze empty slots so that racing inserters are forced to retry
+      // against the new table.
+      Node *node = nullptr;
+      if (oldSlots[i].compare_exchange_strong(node, getMovedMarker(),
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_acquire))
+        continue;
+
+      // Nobody else can see the new table yet, so there's no need for
+      // anything fancier than relaxed stores here.
+      size_t index = node->Hash & newMask;
+      while (newSlots[index].load(std::memory_order_relaxed))
+        index = (index + 1) & newMask;
+      newSlots[index].store(node, std::memory_order_relaxed);
+    }
+
+    Current.store(newTable, std::memory_order_release);
+    return newTable;
+  }
 
 public:
-  constexpr ConcurrentMap() : Root(nullptr), LastSearch(nullptr) {}
+  constexpr ConcurrentMap() : Current(nullptr), Count(0) {}
 
   ConcurrentMap(const ConcurrentMap &) = delete;
   ConcurrentMap &operator=(const ConcurrentMap &) = delete;
 
   ~ConcurrentMap() {
-    ::delete Root.load(std::memory_order_relaxed);
+    // These can be relaxed accesses because there is no safe way for
+    // another thread to race an access to the map with our destruction
+    // of it.
+    Table *table = Current.load(std::memory_order_relaxed);
+    if (!table)
+      return;
+
+    // Every node is reachable from the current table.
+    auto slots = table->getSlots();
+    for (size_t i = 0; i != table->Capacity; ++i) {
+      Node *node = slots[i].load(std::memory_order_relaxed);
+      if (!isEmptyOrMoved(node)) {
+        node->~Node();
+        ::operator delete(node);
+      }
+    }
+
+    while (table) {
+      Table *previous = table->Previous;
+      Table::deallocate(table);
+      table = previous;
+    }
   }
 
 #ifndef NDEBUG
   void dump() const {
-    auto R = Root.load(std::memory_order_acquire);
-    printf("digraph g {\n"
-           "graph [ rankdir = \"TB\"];\n"
-           "node  [ fontsize = \"16\" ];\n"
-           "edge  [ ];\n");
-    if (R) {
-      R->dump();
+    Table *table = Current.load(std::memory_order_acquire);
+    if (!table) {
+      printf("<empty map>\n");
+      return;
+    }
+
+    printf("%zu entries in %zu slots:\n",
+           Count.load(std::memory_order_relaxed), table->Capacity);
+    auto slots = table->getSlots();
+    for (size_t i = 0; i != table->Capacity; ++i) {
+      Node *node = slots[i].load(std::memory_order_acquire);
+      if (isEmptyOrMoved(node))
+        continue;
+      printf("  [%zu] hash %016zx (ideal slot %zu) key %08lx\n",
+             i, node->Hash, node->Hash & (table->Capacity - 1),
+             (long) node->Payload.getKeyIntValueForDump());
     }
-    printf("\n}\n");
   }
 #endif
 
+  /// The table a lookup starts from.  It may be replaced while the lookup
+  /// walks it.
+  class Snapshot {
+    Table *SnapshotTable;
+    explicit Snapshot(Table *table) : SnapshotTable(table) {}
+    friend class ConcurrentMap;
+  };
+
+  /// Returns the table a lookup would start from now.
+  Snapshot getSnapshot() const {
+    return Snapshot(Current.load(std::memory_order_acquire));
+  }
+
   /// Search for a value by key \p Key.
   /// \returns a pointer to the value or null if the value is not in the map.
+  ///
+  /// Lookups never write to the map, so concurrent lookups of existing
+  /// entries don't contend with each other.
   template <class KeyTy>
   EntryTy *find(const KeyTy &key) {
-    // Check if we are looking for the same key that we looked for in the last
-    // time we called this function.
-    if (Node *last = LastSearch.load(std::memory_order_acquire)) {
-      if (last->Payload.compareWithKey(key) == 0)
-        return &last->Payload;
-    }
+    return find(key, getSnapshot());
+  }
+
+  /// Search for a value by key \p Key, starting from a table taken earlier,
+  /// as a lookup that races with the map's growth would.
+  template <class KeyTy>
+  EntryTy *find(const KeyTy &key, Snapshot snapshot) {
+    Table *table = snapshot.SnapshotTable;
+    if (!table)
+      return nullptr;
 
-    // Search the tree, starting from the root.
-    Node *node = Root.load(std::memory_order_acquire);
-    while (node) {
-      int comparisonResult = node->Payload.compareWithKey(key);
-      if (comparisonResult == 0) {
-        LastSearch.store(node, std::memory_order_release);
+    size_t hash = EntryTy::getKeyHash(key);
+    while (true) {
+      size_t slotIndex = hash & (table->Capacity - 1);
+      size_t probes = 0;
+      Node *slotValue;
+      if (Node *node = search(table, key, hash, slotIndex, probes, slotValue))
         return &node->Payload;
-      } else if (comparisonResult < 0) {
-        node = node->Left.load(std::memory_order_acquire);
-      } else {
-        node = node->Right.load(std::memory_order_acquire);
-      }
+      if (slotValue != getMovedMarker())
+        return nullptr;
+
+      // The table has been frozen by a thread growing it. If the
+      // replacement has been published, the key may be there; otherwise
+      // report a miss rather than waiting for the writer.
+      Table *current = Current.load(std::memory_order_acquire);
+      if (current == table)
+        return nullptr;
+      table = current;
     }
-
-    return nullptr;
   }
 
   /// Get or create an entry in the map.
@@ -247,43 +418,32 @@ public:
   ///   or already existed (false)
   template <class KeyTy, class... ArgTys>
   std::pair<EntryTy*, bool> getOrInsert(KeyTy key, ArgTys &&... args) {
-    // Check if we are looking for the same key that we looked for the
-    // last time we called this function.
-    if (Node *last = LastSearch.load(std::memory_order_acquire)) {
-      if (last && last->Payload.compareWithKey(key) == 0)
-        return { &last->Payload, false };
-    }
+    size_t hash = EntryTy::getKeyHash(key);
 
     // The node we allocated.
     Node *newNode = nullptr;
 
-    // Start from the root.
-    auto edge = &Root;
+    Table *table = getOrCreateTable();
+    size_t slotIndex = hash & (table->Capacity - 1);
+    size_t probes = 0;
 
     while (true) {
-      // Load the edge.
-      Node *node = edge->load(std::memory_order_acquire);
-
-      // If there's a node there, it's either a match or we're going to
-      // one of its children.
-      if (node) {
-      searchFromNode:
-
-        // Compare our key against the node's key.
-        int comparisonResult = node->Payload.compareWithKey(key);
-
-        // If it's equal, we can use this node.
-        if (comparisonResult == 0) {
-          // Destroy the node we allocated before if we're carrying one around.
-          ::delete newNode;
-
-          // Cache and report that we found an existing node.
-          LastSearch.store(node, std::memory_order_release);
-          return { &node->Payload, false };
+      Node *slotValue;
+      if (Node *node = search(table, key, hash, slotIndex, probes, slotValue)) {
+        // Destroy the node we allocated before if we're carrying one around.
+        if (newNode) {
+          newNode->~Node();
+          ::operator delete(newNode);
         }
+        return { &node->Payload, false };
+      }
 
-        // Otherwise, select the appropriate child edge and descend.
-        edge = (comparisonResult < 0 ? &node->Left : &node->Right);
+      // If the table is frozen (or full), move on to its replacement and
+      // start the search over.
+      if (slotValue == getMovedMarker()) {
+        table = grow(table);
+        slotIndex = hash & (table->Capacity - 1);
+        probes = 0;
         continue;
       }
 
@@ -292,23 +452,24 @@ public:
         size_t allocSize =
           sizeof(Node) + EntryTy::getExtraAllocationSize(key, args...);
         void *memory = ::operator new(allocSize);
-        newNode = ::new (memory) Node(key, std::forward<ArgTys>(args)...);
+        newNode = ::new (memory) Node(hash, key, std::forward<ArgTys>(args)...);
       }
 
-      // Try to set the edge to the new node.
-      if (std::atomic_compare_exchange_strong_explicit(edge, &node, newNode,
+      // Try to claim the empty slot.
+      Node *expected = nullptr;
+      if (table->getSlots()[slotIndex].compare_exchange_strong(
+                                                  expected, newNode,
                                                   std::memory_order_acq_rel,
                                                   std::memory_order_acquire)) {
-        // If that succeeded, cache and report that we created a new node.
-        LastSearch.store(newNode, std::memory_order_release);
+        // Keep the load factor under 3/4.
+        size_t count = Count.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (count * 4 > table->Capacity * 3)
+          grow(table);
         return { &newNode->Payload, true };
       }
 
-      // Otherwise, we lost the race because some other thread initialized
-      // the edge before us.  node will be set to the current value;
-      // repeat the search from there.
-      assert(node && "spurious failure from compare_exchange_strong?");
-      goto searchFromNode;
+      // Otherwise, we lost the race because some other thread filled or
+      // froze the slot before us; keep searching from the same slot.
     }
   }
 };
@@ -18,5 +18,20 @@
 #define SWIFT_RUNTIME_HEAP_H
 
 #include <llvm/Support/Compiler.h>
+#include <stddef.h>
+
+namespace swift {
+
+/// Return the number of usable bytes in an allocation made by
+/// swift_slowAlloc, which may be more than were requested.
+size_t _swift_slowAllocUsableSize(const void *ptr);
+
+/// Grow an allocation made by swift_slowAlloc to at least \p bytes,
+/// extending it in place if the allocator can, and moving its contents
+/// otherwise. Returns null, leaving the allocation alone, if it can't be
+/// grown with that alignment.
+void *_swift_slowRealloc(void *ptr, size_t bytes, size_t alignMask);
+
+} // end namespace swift
 
 #endif /* SWIFT_RUNTIME_HEAP_H */
@@ -73,6 +73,23 @@ HeapObject *(*SWIFT_CC(RegisterPreservingCC) _swift_allocObject)(
                                               size_t requiredSize,
                                               size_t requiredAlignmentMask);
 
+/// Grows an object allocated by swift_allocObject to at least requiredSize
+/// bytes, with realloc, which can often extend the allocation in place.
+///
+/// The object may move, so this only happens if nothing but the caller can
+/// know its address: the caller must hold the only strong reference, and
+/// the object must not be pinned and have no unowned or weak references.
+/// Its contents are moved bitwise, so they must be bitwise takable.
+///
+/// \param object - the object, at +1
+/// \returns the object at +1, possibly at a new address, or the original
+///   object at +1 if it couldn't be grown; the caller checks the object's
+///   usable size to tell.
+SWIFT_RUNTIME_EXPORT
+extern "C" HeapObject *swift_reallocUniqueObject(HeapObject *object,
+                                                 size_t requiredSize,
+                                                 size_t requiredAlignmentMask);
+
 /// Initializes the object header of a stack allocated object.
 ///
 /// \param metadata - the object's metadata which is stored in the header
@@ -2467,8 +2467,13 @@ template <typename Runtime>
 struct TargetGenericMetadata {
   /// The fill function. Receives a pointer to the instantiated metadata and
   /// the argument pointer passed to swift_getGenericMetadata.
-  TargetMetadata<Runtime> *(*CreateFunction)
-  (TargetGenericMetadata<Runtime> *pattern, const void *arguments);
+  ///
+  /// This is a relative pointer so that the pattern does not need a dynamic
+  /// relocation when the image is loaded.
+  typename Runtime::template FarRelativeDirectPointer<
+    TargetMetadata<Runtime> *(TargetGenericMetadata<Runtime> *pattern,
+                              const void *arguments)>
+  CreateFunction;
   
   /// The size of the template in bytes.
   uint32_t MetadataSize;
@@ -2876,6 +2881,18 @@ swift_getGenericMetadata(GenericMetadata *pattern,
                          const void *arguments)
     SWIFT_CC(RegisterPreservingCC);
 
+/// Register statically initialized metadata for an instantiation of a
+/// generic type. Later calls to swift_getGenericMetadata with the same
+/// arguments return \p metadata instead of instantiating the pattern.
+///
+/// Returns the metadata which is cached for the arguments afterwards. This
+/// is an earlier instantiation if there already is one.
+SWIFT_RUNTIME_EXPORT
+extern "C" const Metadata *
+swift_registerGenericMetadata(GenericMetadata *pattern,
+                              const void *arguments,
+                              const Metadata *metadata);
+
 // Callback to allocate a generic class metadata object.
 SWIFT_RUNTIME_EXPORT
 extern "C" ClassMetadata *
@@ -3430,6 +3447,16 @@ extern "C"
 void swift_registerTypeMetadataRecords(const TypeMetadataRecord *begin,
                                        const TypeMetadataRecord *end);
 
+/// Debugging aid: invoke \p callback once for every runtime metadata cache
+/// that has allocated memory, passing the cache's name, the number of bytes it
+/// has consumed so far, and \p context.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+void swift_enumerateMetadataAllocations(void (*callback)(const char *name,
+                                                         size_t bytes,
+                                                         void *context),
+                                        void *context);
+
 /// Return the type name for a given type metadata.
 std::string nameForMetadata(const Metadata *type,
                             bool qualified = true);
@@ -0,0 +1,123 @@
+//===--- MutexFutex.h - Supports Mutex.h using futexes ----------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Mutex and ConditionVariable implementations built directly on Linux
+// futexes. Both are a single 32-bit word, and neither makes a system call
+// unless a thread actually has to sleep or be woken.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_MUTEX_FUTEX_H
+#define SWIFT_RUNTIME_MUTEX_FUTEX_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace swift {
+
+/// A 32-bit word that threads can sleep on. All zeros is a valid initial
+/// state for every use of it.
+struct FutexWord {
+  uint32_t Value;
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(FutexWord),
+              "a FutexWord must be usable as an atomic word");
+
+inline std::atomic<uint32_t> &asAtomic(FutexWord &word) {
+  return *reinterpret_cast<std::atomic<uint32_t> *>(&word.Value);
+}
+
+/// Sleeps until woken by futexWake if \p word still holds \p expected.
+/// May return spuriously.
+void futexWait(std::atomic<uint32_t> &word, uint32_t expected);
+
+/// Wakes up to \p count threads sleeping on \p word.
+void futexWake(std::atomic<uint32_t> &word, int count);
+
+typedef FutexWord ConditionHandle;
+typedef FutexWord MutexHandle;
+
+#define CONDITION_SUPPORTS_CONSTEXPR 1
+#define MUTEX_SUPPORTS_CONSTEXPR 1
+
+/// Futex low-level implementation that supports ConditionVariable
+/// found in Mutex.h
+///
+/// The word is a sequence number that every notification bumps, so a waiter
+/// only sleeps if no notification happened since it released the mutex.
+///
+/// See ConditionVariable
+struct ConditionPlatformHelper {
+  static constexpr ConditionHandle staticInit() { return ConditionHandle{0}; };
+  static void init(ConditionHandle &condition) { condition.Value = 0; }
+  static void destroy(ConditionHandle &condition) {}
+  static void notifyOne(ConditionHandle &condition);
+  static void notifyAll(ConditionHandle &condition);
+  static void wait(ConditionHandle &condition, MutexHandle &mutex);
+};
+
+/// Futex low-level implementation that supports Mutex found in Mutex.h
+///
+/// Uncontended locking and unlocking is a single atomic operation. A thread
+/// that finds the mutex locked spins briefly, as long as no other thread is
+/// already asleep on it, before it goes to sleep itself.
+///
+/// See Mutex
+struct MutexPlatformHelper {
+  enum : uint32_t {
+    Unlocked = 0,
+    Locked = 1,
+    /// Locked, and other threads may be asleep waiting for it.
+    Contended = 2,
+  };
+
+  static constexpr MutexHandle staticInit() { return MutexHandle{Unlocked}; };
+  static void init(MutexHandle &mutex, bool checked = false) {
+    mutex.Value = Unlocked;
+  }
+  static void destroy(MutexHandle &mutex) {}
+
+  static void lock(MutexHandle &mutex) {
+    uint32_t expected = Unlocked;
+    if (!asAtomic(mutex).compare_exchange_strong(expected, Locked,
+                                                 std::memory_order_acquire,
+                                                 std::memory_order_relaxed))
+      lockSlow(mutex);
+  }
+  static void unlock(MutexHandle &mutex) {
+    uint32_t previous =
+        asAtomic(mutex).exchange(Unlocked, std::memory_order_release);
+    if (previous != Locked)
+      unlockSlow(mutex, previous);
+  }
+  static bool try_lock(MutexHandle &mutex) {
+    uint32_t expected = Unlocked;
+    return asAtomic(mutex).compare_exchange_strong(expected, Locked,
+                                                   std::memory_order_acquire,
+                                                   std::memory_order_relaxed);
+  }
+
+  // There is no error checking to skip.
+  static void unsafeLock(MutexHandle &mutex) { lock(mutex); }
+  static void unsafeUnlock(MutexHandle &mutex) { unlock(mutex); }
+
+  /// Locks a mutex that other threads may be asleep on.
+  static void lockContended(MutexHandle &mutex);
+
+private:
+  static void lockSlow(MutexHandle &mutex);
+  static void unlockSlow(MutexHandle &mutex, uint32_t previous);
+};
+}
+
+#endif
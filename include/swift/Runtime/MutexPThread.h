@@ -11,7 +11,8 @@
 //===----------------------------------------------------------------------===//
 //
 // Mutex, ConditionVariable, Read/Write lock, and Scoped lock implementations
-// using PThreads.
+// using PThreads. On Linux, Mutex and ConditionVariable use the word-sized
+// futex-based implementations in MutexFutex.h instead.
 //
 //===----------------------------------------------------------------------===//
 
@@ -20,10 +21,19 @@
 
 #include <pthread.h>
 
+#if defined(__linux__)
+#define SWIFT_MUTEX_USE_FUTEX 1
+#include "swift/Runtime/MutexFutex.h"
+#else
+#define SWIFT_MUTEX_USE_FUTEX 0
+#endif
+
 namespace swift {
 
+#if !SWIFT_MUTEX_USE_FUTEX
 typedef pthread_cond_t ConditionHandle;
 typedef pthread_mutex_t MutexHandle;
+#endif
 typedef pthread_rwlock_t ReadWriteLockHandle;
 
 #if defined(__CYGWIN__) || defined(__ANDROID__)
@@ -32,15 +42,21 @@ typedef pthread_rwlock_t ReadWriteLockHandle;
 // results in a reinterpret_cast which violates constexpr. Similarly, Android's
 // pthread implementation makes use of volatile attributes that prevent it from
 // being marked as constexpr.
+#if !SWIFT_MUTEX_USE_FUTEX
 #define CONDITION_SUPPORTS_CONSTEXPR 0
 #define MUTEX_SUPPORTS_CONSTEXPR 0
+#endif
 #define READWRITELOCK_SUPPORTS_CONSTEXPR 0
 #else
+#if !SWIFT_MUTEX_USE_FUTEX
 #define CONDITION_SUPPORTS_CONSTEXPR 1
 #define MUTEX_SUPPORTS_CONSTEXPR 1
+#endif
 #define READWRITELOCK_SUPPORTS_CONSTEXPR 1
 #endif
 
+#if !SWIFT_MUTEX_USE_FUTEX
+
 /// PThread low-level implementation that supports ConditionVariable
 /// found in Mutex.h
 ///
@@ -90,6 +106,7 @@ struct MutexPlatformHelper {
     (void)pthread_mutex_unlock(&mutex);
   }
 };
+#endif // !SWIFT_MUTEX_USE_FUTEX
 
 /// PThread low-level implementation that supports ReadWriteLock
 /// found in Mutex.h
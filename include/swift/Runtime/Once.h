@@ -18,7 +18,7 @@
 #define SWIFT_RUNTIME_ONCE_H
 
 #include "swift/Runtime/HeapObject.h"
-#include <mutex>
+#include <cstdint>
 
 namespace swift {
 
@@ -27,15 +27,13 @@ namespace swift {
 // On OS X and iOS, swift_once_t matches dispatch_once_t.
 typedef long swift_once_t;
 
-#elif defined(__CYGWIN__)
-
-// On Cygwin, std::once_flag can not be used because it is larger than the
-// platform word.
-typedef uintptr_t swift_once_t;
 #else
 
-// On other platforms swift_once_t is std::once_flag
-typedef std::once_flag swift_once_t;
+// On other platforms swift_once is implemented by the runtime. The predicate
+// is a word that goes from 0 to 1 while the function runs and is set to ~0
+// with release ordering once it has returned, so that compiled code can skip
+// the call after an acquire load of ~0.
+typedef uintptr_t swift_once_t;
 
 #endif
 
@@ -0,0 +1,69 @@
+//===--- Statistics.h - Swift Runtime Statistics ----------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Opt-in counters of how often the runtime's entry points are called.
+//
+// Setting the SWIFT_RUNTIME_STATISTICS environment variable to a non-empty
+// value other than "0" turns counting on and prints the totals to stderr at
+// exit. Each thread counts into its own block, so counting needs no atomic
+// read-modify-write operations; when counting is off, the cost at each
+// counting site is one load and one branch.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_STATISTICS_H
+#define SWIFT_RUNTIME_STATISTICS_H
+
+#include "swift/Runtime/Config.h"
+#include <atomic>
+#include <cstdint>
+
+/// The totals of the runtime's counters over all threads.
+struct SwiftRuntimeStatistics {
+#define RUNTIME_STATISTIC(Id, Description) uint64_t Id;
+#include "swift/Runtime/Statistics.def"
+};
+
+/// Fill in \p stats with the counts so far. Returns false, and fills in
+/// zeros, if counting isn't enabled.
+SWIFT_RUNTIME_EXPORT
+extern "C" bool swift_runtimeStatistics(SwiftRuntimeStatistics *stats);
+
+/// Print the counts so far to stderr.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_dumpRuntimeStatistics();
+
+namespace swift {
+
+enum class RuntimeStatistic : unsigned {
+#define RUNTIME_STATISTIC(Id, Description) Id,
+#include "swift/Runtime/Statistics.def"
+};
+
+/// Whether counting is enabled: 0 if not, 1 until the environment has been
+/// read, and 2 if it is.
+LLVM_LIBRARY_VISIBILITY
+extern std::atomic<int> _swift_runtimeStatisticsState;
+
+LLVM_LIBRARY_VISIBILITY LLVM_ATTRIBUTE_NOINLINE
+void _swift_countRuntimeStatistic(RuntimeStatistic stat);
+
+/// Count one occurrence of \p stat on the current thread.
+static inline void countRuntimeStatistic(RuntimeStatistic stat) {
+  if (LLVM_UNLIKELY(
+          _swift_runtimeStatisticsState.load(std::memory_order_relaxed) != 0))
+    _swift_countRuntimeStatistic(stat);
+}
+
+} // end namespace swift
+
+#endif // SWIFT_RUNTIME_STATISTICS_H
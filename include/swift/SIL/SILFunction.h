@@ -153,6 +153,17 @@ private:
   /// It does not include references from debug scopes.
   unsigned RefCount = 0;
 
+  /// The number of instructions in the body serialized for this function,
+  /// or 0 if it wasn't deserialized or has no serialized body.
+  ///
+  /// This is known as soon as the declaration is deserialized, so it can be
+  /// used to estimate the size of the body without loading it.
+  unsigned SerializedBodySize = 0;
+
+  /// How many times the function was entered in the profile given with
+  /// -profile-use, or None if there is no profile for it.
+  Optional<uint64_t> EntryCount;
+
   /// The function's set of semantics attributes.
   ///
   /// TODO: Why is this using a std::string? Why don't we use uniqued
@@ -515,6 +526,15 @@ public:
   bool isKeepAsPublic() const { return KeepAsPublic; }
   void setKeepAsPublic(bool keep) { KeepAsPublic = keep; }
 
+  /// Get the number of instructions in the serialized body of this function,
+  /// or 0 if that is unknown.
+  unsigned getSerializedBodySize() const { return SerializedBodySize; }
+  void setSerializedBodySize(unsigned size) { SerializedBodySize = size; }
+
+  /// Get the profiled entry count of this function, if any.
+  Optional<uint64_t> getEntryCount() const { return EntryCount; }
+  void setEntryCount(uint64_t count) { EntryCount = count; }
+
   /// Return whether this function has a foreign implementation which can
   /// be emitted on demand.
   bool hasForeignBody() const;
@@ -102,6 +102,11 @@ private:
   /// Allocator that manages the memory of all the pieces of the SILModule.
   mutable llvm::BumpPtrAllocator BPA;
 
+  /// The memory of erased basic blocks, which is reused for new blocks. This
+  /// needs to be declared before \p functions so that it is still alive when
+  /// the blocks of the functions are destroyed.
+  mutable std::vector<void *> FreeBlocks;
+
   /// The swift Module associated with this SILModule.
   ModuleDecl *TheSwiftModule;
 
@@ -593,6 +598,13 @@ public:
   /// Deallocate memory of an instruction.
   void deallocateInst(SILInstruction *I);
 
+  /// Allocate memory for a basic block, reusing the memory of an erased
+  /// block if possible.
+  void *allocateBlock(unsigned Size, unsigned Align) const;
+
+  /// Make the memory of a destroyed basic block available for new blocks.
+  void deallocateBlock(SILBasicBlock *BB);
+
   /// \brief Looks up the llvm intrinsic ID and type for the builtin function.
   ///
   /// \returns Returns llvm::Intrinsic::not_intrinsic if the function is not an
@@ -417,8 +417,9 @@ class TypeConverter {
   friend class TypeLowering;
 
   llvm::BumpPtrAllocator IndependentBPA;
-  /// BumpPtrAllocator for types dependent on contextual generic parameters,
-  /// which is reset when the generic context is popped.
+  /// BumpPtrAllocator for types dependent on contextual generic parameters.
+  /// It is never reset, so that lowerings survive the generic context they
+  /// were created in.
   llvm::BumpPtrAllocator DependentBPA;
 
   enum : unsigned {
@@ -509,12 +510,27 @@ class TypeConverter {
   /// Insert a mapping into the cache.
   void insert(TypeKey k, const TypeLowering *tl);
   
-  /// Mapping for types independent on contextual generic parameters, which is
-  /// cleared when the generic context is popped.
-  llvm::DenseMap<CachingTypeKey, const TypeLowering *> IndependentTypes;
-  /// Mapping for types dependent on contextual generic parameters, which is
-  /// cleared when the generic context is popped.
-  llvm::DenseMap<CachingTypeKey, const TypeLowering *> DependentTypes;
+  using TypeLoweringMap = llvm::DenseMap<CachingTypeKey, const TypeLowering *>;
+
+  /// Mapping for types independent on contextual generic parameters.
+  TypeLoweringMap IndependentTypes;
+  /// Mappings for types dependent on contextual generic parameters, one for
+  /// each generic signature they were lowered in. Every function with the
+  /// same generic signature reuses the same mapping.
+  llvm::DenseMap<GenericSignature *, TypeLoweringMap> DependentTypesBySignature;
+  /// The mapping in DependentTypesBySignature for the current generic
+  /// context, or null outside of a generic context. New signatures are only
+  /// added by pushGenericContext, so the pointer stays valid until the
+  /// context is popped.
+  TypeLoweringMap *DependentTypes = nullptr;
+
+  /// How often the lowering of a dependent type was found in the cache.
+  unsigned NumDependentLoweringHits = 0;
+  /// How many lowerings of dependent types were created.
+  unsigned NumDependentLoweringsCreated = 0;
+  /// How often a generic context was pushed for a signature whose lowerings
+  /// were already cached.
+  unsigned NumGenericContextsReused = 0;
   
   llvm::DenseMap<SILDeclRef, SILConstantInfo> ConstantTypes;
   
@@ -775,7 +791,13 @@ public:
   
   /// Pop a generic function context. See GenericContextScope for an RAII
   /// interface to this function. There must be an active generic context.
+  ///
+  /// The lowerings of dependent types are kept, and are reused the next time
+  /// the same signature is pushed.
   void popGenericContext(CanGenericSignature sig);
+
+  /// Print statistics about the reuse of dependent type lowerings.
+  void printStatistics(raw_ostream &out) const;
   
   /// Known types for bridging.
 #define BRIDGING_KNOWN_TYPE(BridgedModule,BridgedType) \
@@ -18,34 +18,39 @@
 #include "swift/SILOptimizer/Analysis/Analysis.h"
 #include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 
 using swift::RetainObserveKind;
 
 namespace {
 
+  /// The index type which the cache keys use for SILValues. 32 bits keep the
+  /// keys small, so that more of them fit into a cache line.
+  using ValueIndexTy = unsigned;
+
   /// A key used for the AliasAnalysis cache.
   ///
   /// This struct represents the argument list to the method 'alias'.  The two
-  /// SILValue pointers are mapped to size_t indices because we need an
+  /// SILValue pointers are mapped to ValueIndexTy indices because we need an
   /// efficient way to invalidate them (the mechanism is described below). The
   /// Type arguments are translated to void* because their underlying storage is
   /// opaque pointers that never goes away.
   struct AliasKeyTy {
     // The SILValue pair:
-    size_t V1, V2;
+    ValueIndexTy V1, V2;
     // The TBAAType pair:
     void *T1, *T2;
   };
 
   /// A key used for the MemoryBehavior Analysis cache.
   ///
-  /// The two SILValue pointers are mapped to size_t indices because we need an
-  /// efficient way to invalidate them (the mechanism is described below).  The
-  /// RetainObserveKind represents the inspection mode for the memory behavior
-  /// analysis.
+  /// The two SILValue pointers are mapped to ValueIndexTy indices because we
+  /// need an efficient way to invalidate them (the mechanism is described
+  /// below).  The RetainObserveKind represents the inspection mode for the
+  /// memory behavior analysis.
   struct MemBehaviorKeyTy {
     // The SILValue pair:
-    size_t V1, V2;
+    ValueIndexTy V1, V2;
     RetainObserveKind InspectionMode; 
   };
 }
@@ -88,6 +93,12 @@ public:
     MustAlias,      ///< The two values are equal.
   };
 
+  /// The number of queries and cache hits of one of the query caches.
+  struct CacheStatistics {
+    unsigned NumQueries = 0;
+    unsigned NumHits = 0;
+  };
+
 private:
   SILModule *Mod;
   SideEffectAnalysis *SEA;
@@ -117,7 +128,7 @@ private:
   /// to alias results because we'd like to be able to remove deleted pointers
   /// without having to scan the whole map. So, instead of storing pointers we
   /// map pointers to indices and store the indices.
-  ValueEnumerator<ValueBase*> AliasValueBaseToIndex;
+  ValueEnumerator<ValueBase*, ValueIndexTy> AliasValueBaseToIndex;
   
   /// Same as AliasValueBaseToIndex, map a pointer to the indices for
   /// MemoryBehaviorCache.
@@ -125,7 +136,12 @@ private:
   /// NOTE: we do not use the same ValueEnumerator for the alias cache, 
   /// as when either cache is cleared, we can not clear the ValueEnumerator
   /// because doing so could give rise to collisions in the other cache.
-  ValueEnumerator<ValueBase*> MemoryBehaviorValueBaseToIndex;
+  ValueEnumerator<ValueBase*, ValueIndexTy> MemoryBehaviorValueBaseToIndex;
+
+  /// Hit counters of AliasCache and MemoryBehaviorCache, accumulated over the
+  /// lifetime of the analysis.
+  CacheStatistics AliasCacheStats;
+  CacheStatistics MemoryBehaviorCacheStats;
 
   AliasResult aliasAddressProjection(SILValue V1, SILValue V2,
                                      SILValue O1, SILValue O2);
@@ -158,6 +174,16 @@ public:
   }
   
   virtual void initialize(SILPassManager *PM) override;
+
+  /// Returns the hit counters of the alias() query cache.
+  const CacheStatistics &getAliasCacheStatistics() const {
+    return AliasCacheStats;
+  }
+
+  /// Returns the hit counters of the computeMemoryBehavior() query cache.
+  const CacheStatistics &getMemoryBehaviorCacheStatistics() const {
+    return MemoryBehaviorCacheStats;
+  }
   
   /// Perform an alias query to see if V1, V2 refer to the same values.
   AliasResult alias(SILValue V1, SILValue V2, SILType TBAAType1 = SILType(),
@@ -252,6 +278,11 @@ public:
   /// Returns true if \p Ptr may be released in the function call \p FAS.
   bool canApplyDecrementRefCount(FullApplySite FAS, SILValue Ptr);
 
+  /// Returns true if releasing \p Ptr before the function call \p FAS
+  /// instead of after it may change the behavior of the call, i.e. if the
+  /// callee may use \p Ptr or observe side effects of its deinit.
+  bool canApplyInterfereWithRelease(FullApplySite FAS, SILValue Ptr);
+
   /// Returns true if \p Ptr may be released by the builtin \p BI.
   bool canBuiltinDecrementRefCount(BuiltinInst *BI, SILValue Ptr);
 
@@ -266,6 +297,11 @@ public:
   virtual void invalidate(SILAnalysis::InvalidationKind K) override {
     AliasCache.clear();
     MemoryBehaviorCache.clear();
+
+    // Both caches are empty, so we can restart the enumeration. This keeps
+    // the indices small.
+    AliasValueBaseToIndex.clear();
+    MemoryBehaviorValueBaseToIndex.clear();
   }
 
   virtual void invalidate(SILFunction *,
@@ -291,20 +327,17 @@ bool isLetPointer(SILValue V);
 namespace llvm {
   template <> struct llvm::DenseMapInfo<AliasKeyTy> {
     static inline AliasKeyTy getEmptyKey() {
-      auto Allone = std::numeric_limits<size_t>::max();
+      auto Allone = std::numeric_limits<ValueIndexTy>::max();
       return {0, Allone, nullptr, nullptr};
     }
     static inline AliasKeyTy getTombstoneKey() {
-      auto Allone = std::numeric_limits<size_t>::max();
+      auto Allone = std::numeric_limits<ValueIndexTy>::max();
       return {Allone, 0, nullptr, nullptr};
     }
     static unsigned getHashValue(const AliasKeyTy Val) {
-      unsigned H = 0;
-      H ^= DenseMapInfo<size_t>::getHashValue(Val.V1);
-      H ^= DenseMapInfo<size_t>::getHashValue(Val.V2);
-      H ^= DenseMapInfo<void *>::getHashValue(Val.T1);
-      H ^= DenseMapInfo<void *>::getHashValue(Val.T2);
-      return H;
+      // Don't just xor the members: that would map (V1, V2) and (V2, V1), and
+      // all pairs of equal values, to the same bucket.
+      return hash_combine(Val.V1, Val.V2, Val.T1, Val.T2);
     }
     static bool isEqual(const AliasKeyTy LHS, const AliasKeyTy RHS) {
       return LHS.V1 == RHS.V1 &&
@@ -316,19 +349,15 @@ namespace llvm {
 
   template <> struct llvm::DenseMapInfo<MemBehaviorKeyTy> {
     static inline MemBehaviorKeyTy getEmptyKey() {
-      auto Allone = std::numeric_limits<size_t>::max();
+      auto Allone = std::numeric_limits<ValueIndexTy>::max();
       return {0, Allone, RetainObserveKind::RetainObserveKindEnd};
     }
     static inline MemBehaviorKeyTy getTombstoneKey() {
-      auto Allone = std::numeric_limits<size_t>::max();
+      auto Allone = std::numeric_limits<ValueIndexTy>::max();
       return {Allone, 0, RetainObserveKind::RetainObserveKindEnd};
     }
     static unsigned getHashValue(const MemBehaviorKeyTy V) {
-      unsigned H = 0;
-      H ^= DenseMapInfo<size_t>::getHashValue(V.V1);
-      H ^= DenseMapInfo<size_t>::getHashValue(V.V2);
-      H ^= DenseMapInfo<int>::getHashValue(static_cast<int>(V.InspectionMode));
-      return H;
+      return hash_combine(V.V1, V.V2, static_cast<int>(V.InspectionMode));
     }
     static bool isEqual(const MemBehaviorKeyTy LHS,
                         const MemBehaviorKeyTy RHS) {
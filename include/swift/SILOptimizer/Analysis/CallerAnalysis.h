@@ -63,6 +63,9 @@ class CallerAnalysis : public SILAnalysis {
   /// callsite information related to it.
   void invalidateExistingCalleeRelation(SILFunction *F); 
 
+  /// This function is about to be deleted. Remove it from the call graph.
+  void removeFunction(SILFunction *F);
+
   void processRecomputeFunctionList() {
     for (auto &F : RecomputeFunctionList) {
       processFunctionCallSites(F);
@@ -101,7 +104,7 @@ public:
   }
 
   virtual void invalidateForDeadFunction(SILFunction *F, InvalidationKind K) {
-    invalidateExistingCalleeRelation(F);
+    removeFunction(F);
     RecomputeFunctionList.remove(F);
   }
 
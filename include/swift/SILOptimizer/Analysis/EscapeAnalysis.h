@@ -697,6 +697,10 @@ private:
   /// Sets all operands and results of \p I as global escaping.
   void setAllEscaping(SILInstruction *I, ConnectionGraph *ConGraph);
 
+  /// Returns true if \p ConGraph has more nodes than the limit, after which
+  /// the graph is not refined anymore.
+  bool isGraphTooLarge(ConnectionGraph *ConGraph);
+
   /// Recomputes the connection graph for the function \p Initial and
   /// all called functions, up to a recursion depth of MaxRecursionDepth.
   void recompute(FunctionInfo *Initial);
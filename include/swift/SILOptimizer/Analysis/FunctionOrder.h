@@ -34,6 +34,7 @@ private:
   SILModule &M;
   llvm::SmallVector<SCC, 32> TheSCCs;
   llvm::SmallVector<SILFunction *, 32> TheFunctions;
+  llvm::SmallVector<unsigned, 32> TheSCCLevels;
 
   // The callee analysis we use to determine the callees at each call site.
   BasicCalleeAnalysis *BCA;
@@ -69,8 +70,20 @@ public:
     return TheFunctions;
   }
 
+  /// Get the level of each SCC, in the same order as getSCCs().
+  ///
+  /// An SCC's level is one more than the highest level of the SCCs it
+  /// calls, and zero if it calls none. SCCs at the same level don't call
+  /// each other, directly or indirectly.
+  ArrayRef<unsigned> getSCCLevels() {
+    if (TheSCCLevels.empty())
+      computeSCCLevels();
+    return TheSCCLevels;
+  }
+
 private:
   void DFS(SILFunction *F);
+  void computeSCCLevels();
   void FindSCCs(SILModule &M);
 };
 
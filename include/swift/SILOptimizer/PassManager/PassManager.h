@@ -17,6 +17,8 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
+#include <map>
+#include <string>
 #include <vector>
 
 #ifndef SWIFT_SILOPTIMIZER_PASSMANAGER_PASSMANAGER_H
@@ -24,6 +26,7 @@
 
 namespace swift {
 
+class BottomUpFunctionOrder;
 class SILFunction;
 class SILFunctionTransform;
 class SILModule;
@@ -69,6 +72,25 @@ class SILPassManager {
   /// same function.
   bool RestartPipeline = false;
 
+  /// What -sil-opt-pass-profile records for one pass on one function.
+  struct PassProfile {
+    /// The total time spent in the pass.
+    uint64_t Nanoseconds = 0;
+
+    /// How many times the pass ran.
+    unsigned Runs = 0;
+
+    /// The number of instructions before the first run.
+    unsigned InstructionsBefore = 0;
+
+    /// The number of instructions after the last run.
+    unsigned InstructionsAfter = 0;
+  };
+
+  /// Profiles by pass name and function name. Module passes use an empty
+  /// function name.
+  std::map<std::pair<llvm::StringRef, std::string>, PassProfile> PassProfiles;
+
 public:
   /// C'tor. It creates and registers all analysis passes, which are defined
   /// in Analysis.def.
@@ -220,6 +242,18 @@ private:
   /// of the optimization cycle (this is a debug feature).
   void runFunctionPasses(PassList FuncTransforms);
 
+  /// Record a run of \p T on \p F (or the whole module, if \p F is null)
+  /// for -sil-opt-pass-profile.
+  void recordPassProfile(SILTransform *T, SILFunction *F,
+                         uint64_t Nanoseconds, unsigned InstructionsBefore,
+                         unsigned InstructionsAfter);
+
+  /// Print the -sil-opt-pass-profile summary and reset it.
+  void printPassProfiles();
+
+  /// Report how much of a function pass run could proceed concurrently.
+  void reportFunctionPassParallelism(BottomUpFunctionOrder &BottomUpOrder);
+
   /// A helper function that returns (based on SIL stage and debug
   /// options) whether we should continue running passes.
   bool continueTransforming();
@@ -0,0 +1,90 @@
+//===--- BitDataflow.h - Gen/kill data flow over bit vectors ----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements an iterative solver for "must" data flow problems in
+// gen/kill form, where every bit stands for one tracked entity, e.g. one
+// LSLocation. All set operations work on whole words of the bit vectors.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SILOPTIMIZER_UTILS_BITDATAFLOW_H
+#define SWIFT_SILOPTIMIZER_UTILS_BITDATAFLOW_H
+
+#include "llvm/ADT/BitVector.h"
+#include <functional>
+
+namespace swift {
+
+class PostOrderFunctionInfo;
+class SILBasicBlock;
+
+/// A data flow problem in which the set at the start of a block (in the
+/// direction of the flow) is the intersection of the sets of its neighbors,
+/// and the set at the end of the block is Gen | (Start & ~Kill).
+///
+/// The bit vectors are owned by the clients, which describe them for each
+/// block with a BlockSets.
+class BitDataflow {
+public:
+  enum class Direction { Forward, Backward };
+
+  /// The bit vectors of one basic block.
+  struct BlockSets {
+    /// The set where the flow enters the block, i.e. at the beginning of the
+    /// block for a forward problem and at its end for a backward problem.
+    llvm::BitVector &Entry;
+
+    /// The set where the flow leaves the block.
+    llvm::BitVector &Exit;
+
+    /// The bits which are set by the block.
+    const llvm::BitVector &Gen;
+
+    /// The bits which are cleared by the block.
+    const llvm::BitVector &Kill;
+
+    /// Bits which are added to Entry after the meet, if not null. This is
+    /// also the value of Entry for a block without neighbors.
+    const llvm::BitVector *Boundary;
+  };
+
+  using BlockSetsFn = std::function<BlockSets(SILBasicBlock *)>;
+
+private:
+  PostOrderFunctionInfo *PO;
+  Direction Dir;
+  BlockSetsFn GetSets;
+
+  /// Scratch space for computing new Exit sets without allocating.
+  llvm::BitVector Scratch;
+
+public:
+  BitDataflow(PostOrderFunctionInfo *PO, Direction Dir, BlockSetsFn GetSets)
+    : PO(PO), Dir(Dir), GetSets(GetSets) {}
+
+  /// Computes the Entry set of \p BB from the Exit sets of its neighbors.
+  void meet(SILBasicBlock *BB);
+
+  /// Computes the Entry and Exit sets of \p BB. Returns true if the Exit set
+  /// changed.
+  bool transfer(SILBasicBlock *BB);
+
+  /// Iterates over the reachable blocks until no Exit set changes anymore.
+  ///
+  /// The Exit sets must be initialized by the client. Starting with all bits
+  /// set gives the largest fixed point.
+  void solve();
+};
+
+} // end namespace swift
+
+#endif
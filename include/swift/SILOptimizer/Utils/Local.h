@@ -182,9 +182,11 @@ SILInstruction *tryToConcatenateStrings(ApplyInst *AI, SILBuilder &B);
 
 
 /// Tries to perform jump-threading on all checked_cast_br instruction in
-/// function \p Fn.
+/// function \p Fn. Blocks are only cloned as long as their instructions fit
+/// into \p Budget, which is reduced accordingly.
 bool tryCheckedCastBrJumpThreading(SILFunction *Fn, DominanceInfo *DT,
-                          SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist);
+                          SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist,
+                          unsigned &Budget);
 
 void recalcDomTreeForCCBOpt(DominanceInfo *DT, SILFunction &F);
 
@@ -69,6 +69,11 @@ public:
 private:
   void visitDebugValueInst(DebugValueInst *Inst);
   void visitDebugValueAddrInst(DebugValueAddrInst *Inst);
+  void visitStructExtractInst(StructExtractInst *Inst);
+  void visitTupleExtractInst(TupleExtractInst *Inst);
+  void visitBuiltinInst(BuiltinInst *Inst);
+
+  SILInstruction *foldIntegerBuiltin(BuiltinInst *Inst);
 
   const SILDebugScope *getOrCreateInlineScope(const SILDebugScope *DS);
 
@@ -27,6 +27,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Bitcode/BitstreamReader.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 namespace llvm {
@@ -233,20 +234,77 @@ public:
   };
 
 private:
+  /// A table of entities indexed by ID, whose offsets are read directly out
+  /// of the module file's index block.
+  ///
+  /// Opening a module doesn't decode the offsets; instead, entries are
+  /// created a chunk at a time when one of them is first accessed. Chunks
+  /// never move once created, so references into the table stay valid while
+  /// the entity they refer to is deserialized.
+  template <typename T>
+  class LazyOffsetTable {
+    static const unsigned ChunkSize = 256;
+
+    /// The offsets, as little-endian 32-bit integers in the module buffer.
+    StringRef RawOffsets;
+
+    /// The entries created so far, by chunk.
+    std::vector<std::vector<T>> Chunks;
+
+  public:
+    /// Point the table at the blob of offsets in an OffsetsLayout record.
+    void assign(StringRef rawOffsets) {
+      RawOffsets = rawOffsets;
+      Chunks.clear();
+      Chunks.resize((size() + ChunkSize - 1) / ChunkSize);
+    }
+
+    size_t size() const {
+      return RawOffsets.size() / sizeof(uint32_t);
+    }
+
+    T &operator[](size_t index) {
+      assert(index < size() && "index out of range");
+      auto &chunk = Chunks[index / ChunkSize];
+      if (chunk.empty()) {
+        size_t first = index - index % ChunkSize;
+        size_t count = std::min<size_t>(ChunkSize, size() - first);
+        chunk.reserve(count);
+        auto data = reinterpret_cast<const uint8_t *>(RawOffsets.data());
+        for (size_t i = first, e = first + count; i != e; ++i) {
+          uint32_t offset =
+            llvm::support::endian::read<uint32_t, llvm::support::little,
+                                        llvm::support::unaligned>(
+              data + i * sizeof(uint32_t));
+          chunk.emplace_back(offset);
+        }
+      }
+      return chunk[index % ChunkSize];
+    }
+
+    /// Call \p fn on each entry that has been accessed so far, in order.
+    template <typename Fn>
+    void forEachCreated(Fn fn) const {
+      for (const auto &chunk : Chunks)
+        for (const T &entry : chunk)
+          fn(entry);
+    }
+  };
+
   /// Decls referenced by this module.
-  std::vector<Serialized<Decl*>> Decls;
+  LazyOffsetTable<Serialized<Decl*>> Decls;
 
   /// DeclContexts referenced by this module.
-  std::vector<Serialized<DeclContext*>> DeclContexts;
+  LazyOffsetTable<Serialized<DeclContext*>> DeclContexts;
 
   /// Local DeclContexts referenced by this module.
-  std::vector<Serialized<DeclContext*>> LocalDeclContexts;
+  LazyOffsetTable<Serialized<DeclContext*>> LocalDeclContexts;
 
   /// Normal protocol conformances referenced by this module.
-  std::vector<Serialized<NormalProtocolConformance *>> NormalConformances;
+  LazyOffsetTable<Serialized<NormalProtocolConformance *>> NormalConformances;
 
   /// Types referenced by this module.
-  std::vector<Serialized<Type>> Types;
+  LazyOffsetTable<Serialized<Type>> Types;
 
   /// Represents an identifier that may or may not have been deserialized yet.
   ///
@@ -264,7 +322,7 @@ private:
   };
 
   /// Identifiers referenced by this module.
-  std::vector<SerializedIdentifier> Identifiers;
+  LazyOffsetTable<SerializedIdentifier> Identifiers;
 
   class DeclTableInfo;
   using SerializedDeclTable =
@@ -281,6 +339,12 @@ private:
   std::unique_ptr<SerializedDeclTable> OperatorMethodDecls;
   std::unique_ptr<SerializedLocalDeclTable> LocalTypeDecls;
 
+  class DeclMemberTableInfo;
+  using SerializedDeclMemberTable =
+      llvm::OnDiskIterableChainedHashTable<DeclMemberTableInfo>;
+
+  std::unique_ptr<SerializedDeclMemberTable> MembersByName;
+
   class ObjCMethodTableInfo;
   using SerializedObjCMethodTable =
     llvm::OnDiskIterableChainedHashTable<ObjCMethodTableInfo>;
@@ -385,6 +449,11 @@ private:
   std::unique_ptr<SerializedDeclTable>
   readDeclTable(ArrayRef<uint64_t> fields, StringRef blobData);
 
+  /// Read an on-disk table of members by name stored in
+  /// index_block::DeclListLayout format.
+  std::unique_ptr<SerializedDeclMemberTable>
+  readDeclMemberTable(ArrayRef<uint64_t> fields, StringRef blobData);
+
   /// Read an on-disk local decl hash table stored in
   /// index_block::DeclListLayout format.
   std::unique_ptr<SerializedLocalDeclTable>
@@ -607,6 +676,13 @@ public:
   virtual void loadAllMembers(Decl *D,
                               uint64_t contextData) override;
 
+  virtual bool canLoadNamedMembers(const Decl *D,
+                                   uint64_t contextData) override;
+
+  virtual void
+  loadNamedMembers(const Decl *D, Identifier N, uint64_t contextData,
+                   SmallVectorImpl<ValueDecl *> &members) override;
+
   virtual void
   loadAllConformances(const Decl *D, uint64_t contextData,
                     SmallVectorImpl<ProtocolConformance*> &Conforms) override;
@@ -53,7 +53,7 @@ const uint16_t VERSION_MAJOR = 0;
 /// in source control, you should also update the comment to briefly
 /// describe what change you made. The content of this comment isn't important;
 /// it just ensures a conflict if two people change the module format.
-const uint16_t VERSION_MINOR = 251; // Last change: SILFunctionType::isPseudogeneric
+const uint16_t VERSION_MINOR = 254; // Last change: SIL body sizes
 
 using DeclID = PointerEmbeddedInt<unsigned, 31>;
 using DeclIDField = BCFixed<31>;
@@ -1465,11 +1465,15 @@ namespace index_block {
     DECL_CONTEXT_OFFSETS,
     LOCAL_TYPE_DECLS,
     NORMAL_CONFORMANCE_OFFSETS,
+
+    /// The members of nominal types and extensions, keyed by name, so that
+    /// the members with a particular name can be loaded on their own.
+    DECL_MEMBER_NAMES,
   };
 
   using OffsetsLayout = BCGenericRecordLayout<
     BCFixed<4>,  // record ID
-    BCArray<BitOffsetField>
+    BCBlob       // array of little-endian 32-bit offsets
   >;
 
   using DeclListLayout = BCGenericRecordLayout<
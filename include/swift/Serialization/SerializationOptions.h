@@ -35,6 +35,10 @@ namespace swift {
     StringRef ModuleLinkName;
     ArrayRef<std::string> ExtraClangOptions;
 
+    /// The number of threads that may be used to encode independent parts of
+    /// the module, or 0 to do all of the work on the calling thread.
+    unsigned NumThreads = 0;
+
     bool AutolinkForceLoad = false;
     bool SerializeAllSIL = false;
     bool SerializeOptionsForDebugging = false;
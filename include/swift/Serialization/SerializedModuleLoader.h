@@ -15,6 +15,7 @@
 
 #include "swift/AST/Module.h"
 #include "swift/AST/ModuleLoader.h"
+#include "swift/Basic/ModuleLocationMap.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 namespace swift {
@@ -29,8 +30,23 @@ private:
   using LoadedModulePair = std::pair<std::unique_ptr<ModuleFile>, unsigned>;
   std::vector<LoadedModulePair> LoadedModuleFiles;
 
+  /// The contents of the search paths, listed the first time each of them is
+  /// searched, or read from SearchPathOptions::ModuleLocationMapPath.
+  ModuleLocationMap SearchPathContents;
+  bool ReadModuleLocationMap = false;
+
   explicit SerializedModuleLoader(ASTContext &ctx, DependencyTracker *tracker);
 
+  /// Returns false if the search path \p directory has no entry named
+  /// \p name, without going to the file system more than once per directory.
+  bool searchPathMayContain(StringRef directory, StringRef name);
+
+  std::error_code
+  findModule(std::pair<Identifier, SourceLoc> moduleID,
+             std::unique_ptr<llvm::MemoryBuffer> &moduleBuffer,
+             std::unique_ptr<llvm::MemoryBuffer> &moduleDocBuffer,
+             bool &isFramework);
+
 public:
   /// \brief Create a new importer that can load serialized Swift modules
   /// into the given ASTContext.
@@ -42,6 +42,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/Format.h"
 #include <algorithm>
 #include <memory>
 
@@ -203,6 +204,10 @@ struct ASTContext::Implementation {
   /// \brief Map from Swift declarations to brief comments.
   llvm::DenseMap<const Decl *, StringRef> BriefComments;
 
+  /// \brief Map from declarations to their documentation comments converted
+  /// to XML, or to an empty string if they have none.
+  llvm::DenseMap<const Decl *, StringRef> DocCommentXMLs;
+
   /// \brief Map from local declarations to their discriminators.
   /// Missing entries implicitly have value 0.
   llvm::DenseMap<const ValueDecl *, unsigned> LocalDiscriminators;
@@ -236,9 +241,19 @@ struct ASTContext::Implementation {
                            ArchetypeBuilder::PotentialArchetype *>>
     LazyArchetypes;
 
-  /// \brief Stored archetype builders.
+  /// \brief Stored archetype builders, by canonical signature and module.
+  ///
+  /// Signatures with equivalent requirements may share a builder.
   llvm::DenseMap<std::pair<GenericSignature *, ModuleDecl *>,
-                 std::unique_ptr<ArchetypeBuilder>> ArchetypeBuilders;
+                 ArchetypeBuilder *> ArchetypeBuilders;
+
+  /// \brief The archetype builders owned by this context.
+  std::vector<std::unique_ptr<ArchetypeBuilder>> OwnedArchetypeBuilders;
+
+  /// \brief Cached context manglings of nominal types, by declaration and
+  /// whether Punycode was used.
+  llvm::DenseMap<std::pair<const NominalTypeDecl *, unsigned>,
+                 CachedTypeMangling> TypeManglings;
 
   /// The set of property names that show up in the defining module of a
   /// class.
@@ -362,6 +377,18 @@ struct ASTContext::Implementation {
   /// \brief The current constraint solver arena, if any.
   std::unique_ptr<ConstraintSolverArena> CurrentConstraintSolverArena;
 
+  /// \brief The most memory used by any one constraint solver arena.
+  size_t PeakSolverArenaMemory = 0;
+
+  /// \brief The growth of the permanent arena in each phase of compilation,
+  /// in the order the phases were first recorded.
+  std::vector<std::pair<StringRef, size_t>> ArenaUsageByPhase;
+
+  /// \brief The number of lookups into imported modules answered by, or
+  /// added to, source files' lookup caches.
+  unsigned NumImportedLookupHits = 0;
+  unsigned NumImportedLookupMisses = 0;
+
   Arena &getArena(AllocationArena arena) {
     switch (arena) {
     case AllocationArena::Permanent:
@@ -394,6 +421,9 @@ ConstraintCheckerArenaRAII(ASTContext &self, llvm::BumpPtrAllocator &allocator,
 }
 
 ConstraintCheckerArenaRAII::~ConstraintCheckerArenaRAII() {
+  Self.Impl.PeakSolverArenaMemory =
+    std::max(Self.Impl.PeakSolverArenaMemory,
+             Self.Impl.CurrentConstraintSolverArena->Allocator.getTotalMemory());
   Self.Impl.CurrentConstraintSolverArena.reset(
     (ASTContext::Implementation::ConstraintSolverArena *)Data);
 }
@@ -1278,7 +1308,7 @@ ArchetypeBuilder *ASTContext::getOrCreateArchetypeBuilder(
   // signature and module.
   auto known = Impl.ArchetypeBuilders.find({sig, mod});
   if (known != Impl.ArchetypeBuilders.end())
-    return known->second.get();
+    return known->second;
 
   // Create a new archetype builder with the given signature.
   auto builder = new ArchetypeBuilder(*mod, Diags);
@@ -1286,18 +1316,34 @@ ArchetypeBuilder *ASTContext::getOrCreateArchetypeBuilder(
                                /*treatRequirementsAsExplicit=*/true);
   
   // Store this archetype builder.
-  Impl.ArchetypeBuilders[{sig, mod}]
-    = std::unique_ptr<ArchetypeBuilder>(builder);
+  Impl.OwnedArchetypeBuilders.push_back(
+    std::unique_ptr<ArchetypeBuilder>(builder));
+  Impl.ArchetypeBuilders[{sig, mod}] = builder;
   return builder;
 }
 
 void ASTContext::setArchetypeBuilder(CanGenericSignature sig,
                                      ModuleDecl *mod,
-                                     std::unique_ptr<ArchetypeBuilder> builder) {
-  if (Impl.ArchetypeBuilders.find({sig, mod})
-        == Impl.ArchetypeBuilders.end()) {
-    Impl.ArchetypeBuilders[{sig, mod}] = move(builder);
-  }
+                                     ArchetypeBuilder *builder) {
+  Impl.ArchetypeBuilders.insert({{sig, mod}, builder});
+}
+
+Optional<ASTContext::CachedTypeMangling>
+ASTContext::getCachedTypeMangling(const NominalTypeDecl *decl,
+                                  bool usePunycode) const {
+  auto known = Impl.TypeManglings.find({decl, usePunycode});
+  if (known == Impl.TypeManglings.end())
+    return None;
+  return known->second;
+}
+
+void ASTContext::setCachedTypeMangling(const NominalTypeDecl *decl,
+                                       bool usePunycode,
+                                       StringRef mangling,
+                                       ArrayRef<const void *> substitutions) {
+  CachedTypeMangling entry{AllocateCopy(mangling),
+                           AllocateCopy(substitutions)};
+  Impl.TypeManglings.insert({{decl, usePunycode}, entry});
 }
 
 Module *
@@ -1370,6 +1416,18 @@ void ASTContext::setBriefComment(const Decl *D, StringRef Comment) {
   Impl.BriefComments[D] = Comment;
 }
 
+Optional<StringRef> ASTContext::getDocCommentXML(const Decl *D) {
+  auto Known = Impl.DocCommentXMLs.find(D);
+  if (Known == Impl.DocCommentXMLs.end())
+    return None;
+
+  return Known->second;
+}
+
+void ASTContext::setDocCommentXML(const Decl *D, StringRef XML) {
+  Impl.DocCommentXMLs[D] = AllocateCopy(XML);
+}
+
 unsigned ValueDecl::getLocalDiscriminator() const {
   assert(getDeclContext()->isLocalContext());
   auto &discriminators = getASTContext().Impl.LocalDiscriminators;
@@ -1548,6 +1606,7 @@ size_t ASTContext::getTotalMemory() const {
     llvm::capacity_in_bytes(Impl.ModuleLoaders) +
     llvm::capacity_in_bytes(Impl.RawComments) +
     llvm::capacity_in_bytes(Impl.BriefComments) +
+    llvm::capacity_in_bytes(Impl.DocCommentXMLs) +
     llvm::capacity_in_bytes(Impl.LocalDiscriminators) +
     llvm::capacity_in_bytes(Impl.ModuleTypes) +
     llvm::capacity_in_bytes(Impl.GenericParamTypes) +
@@ -1568,6 +1627,63 @@ size_t ASTContext::getTotalMemory() const {
     return Size;
 }
 
+size_t ASTContext::getPermanentArenaMemory() const {
+  return Impl.Allocator.getTotalMemory();
+}
+
+size_t ASTContext::getPeakSolverArenaMemory() const {
+  return Impl.PeakSolverArenaMemory;
+}
+
+void ASTContext::recordArenaUsage(StringRef phase, size_t bytes) {
+  for (auto &entry : Impl.ArenaUsageByPhase) {
+    if (entry.first == phase) {
+      entry.second += bytes;
+      return;
+    }
+  }
+  Impl.ArenaUsageByPhase.push_back({phase, bytes});
+}
+
+void ASTContext::printArenaUsage(raw_ostream &out) const {
+  if (Impl.ArenaUsageByPhase.empty())
+    return;
+
+  std::string rule = "===" + std::string(73, '-') + "===\n";
+  out << rule
+      << "            Swift compilation permanent arena growth (bytes)\n"
+      << rule;
+  for (auto &entry : Impl.ArenaUsageByPhase)
+    out << llvm::format("%12zu", entry.second) << "  " << entry.first << "\n";
+  out << llvm::format("%12zu", getPermanentArenaMemory()) << "  Total\n";
+  out << llvm::format("%12zu", Impl.PeakSolverArenaMemory)
+      << "  Largest constraint solver arena\n\n";
+}
+
+void ASTContext::recordImportedLookup(bool hit) {
+  if (hit)
+    ++Impl.NumImportedLookupHits;
+  else
+    ++Impl.NumImportedLookupMisses;
+}
+
+void ASTContext::printImportedLookupStats(raw_ostream &out) const {
+  unsigned total = Impl.NumImportedLookupHits + Impl.NumImportedLookupMisses;
+  if (total == 0)
+    return;
+
+  std::string rule = "===" + std::string(73, '-') + "===\n";
+  out << rule
+      << "                Swift compilation imported module lookups\n"
+      << rule;
+  out << llvm::format("%12u", Impl.NumImportedLookupHits)
+      << "  Answered by a source file's lookup cache\n";
+  out << llvm::format("%12u", Impl.NumImportedLookupMisses)
+      << "  Looked up and remembered\n";
+  out << llvm::format("%11.1f%%", 100.0 * Impl.NumImportedLookupHits / total)
+      << "  Hit rate\n\n";
+}
+
 size_t ASTContext::getSolverMemory() const {
   size_t Size = 0;
   
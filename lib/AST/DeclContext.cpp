@@ -27,6 +27,8 @@ STATISTIC(NumLazyIterableDeclContexts,
           "# of serialized iterable declaration contexts");
 STATISTIC(NumUnloadedLazyIterableDeclContexts,
           "# of serialized iterable declaration contexts never loaded");
+STATISTIC(NumNamedLazyMemberLoads,
+          "# of lookups that loaded serialized members by name");
 
 // Only allow allocation of DeclContext using the allocator in ASTContext.
 void *DeclContext::operator new(size_t Bytes, ASTContext &C,
@@ -829,6 +831,18 @@ void IterableDeclContext::setLoader(LazyMemberLoader *loader,
   ++NumUnloadedLazyIterableDeclContexts;
 }
 
+/// Returns the declaration that is \p IDC.
+static const Decl *getAsDecl(const IterableDeclContext *IDC) {
+  switch (IDC->getIterableContextKind()) {
+  case IterableDeclContextKind::NominalTypeDecl:
+    return cast<NominalTypeDecl>(IDC);
+
+  case IterableDeclContextKind::ExtensionDecl:
+    return cast<ExtensionDecl>(IDC);
+  }
+  llvm_unreachable("bad IterableDeclContextKind");
+}
+
 void IterableDeclContext::loadAllMembers() const {
   if (!isLazy())
     return;
@@ -838,22 +852,27 @@ void IterableDeclContext::loadAllMembers() const {
   auto contextData = getLoaderContextData();
   LazyLoader = nullptr;
 
-  const Decl *container = nullptr;
-  switch (getIterableContextKind()) {
-  case IterableDeclContextKind::NominalTypeDecl:
-    container = cast<NominalTypeDecl>(this);
-    break;
-
-  case IterableDeclContextKind::ExtensionDecl:
-    container = cast<ExtensionDecl>(this);
-    break;
-  }
-
+  const Decl *container = getAsDecl(this);
   resolver->loadAllMembers(const_cast< Decl *>(container), contextData);
 
   --NumUnloadedLazyIterableDeclContexts;
 }
 
+bool IterableDeclContext::canLoadMembersByName() const {
+  if (!isLazy())
+    return false;
+  return getLoader()->canLoadNamedMembers(getAsDecl(this),
+                                          getLoaderContextData());
+}
+
+void IterableDeclContext::loadNamedMembers(
+       Identifier name, SmallVectorImpl<ValueDecl *> &members) const {
+  assert(canLoadMembersByName());
+  getLoader()->loadNamedMembers(getAsDecl(this), name, getLoaderContextData(),
+                                members);
+  ++NumNamedLazyMemberLoads;
+}
+
 bool IterableDeclContext::classof(const Decl *D) {
   switch (D->getKind()) {
 #define DECL(ID, PARENT)              case DeclKind::ID: return false;
@@ -26,11 +26,19 @@
 #include "swift/Parse/Lexer.h" // bad dependency
 #include "swift/Config.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace swift;
 
+#define DEBUG_TYPE "Diagnostics"
+
+STATISTIC(NumDiagnosticsFormatted,
+          "# of diagnostics formatted for a consumer");
+STATISTIC(NumDiagnosticsNotFormatted,
+          "# of diagnostics dropped without being formatted");
+
 namespace {
 enum class DiagnosticOptions {
   /// No options.
@@ -562,10 +570,21 @@ void DiagnosticEngine::emitTentativeDiagnostics() {
   TentativeDiagnostics.clear();
 }
 
+void DiagnosticEngine::discardTentativeDiagnostics(unsigned first) {
+  NumDiagnosticsNotFormatted += TentativeDiagnostics.size() - first;
+  TentativeDiagnostics.erase(TentativeDiagnostics.begin() + first,
+                             TentativeDiagnostics.end());
+}
+
 void DiagnosticEngine::emitDiagnostic(const Diagnostic &diagnostic) {
   auto behavior = state.determineBehavior(diagnostic.getID());
-  if (behavior == DiagnosticState::Behavior::Ignore)
+
+  // The arguments are only formatted, and declarations without a location
+  // only pretty-printed, once something is going to see the result.
+  if (behavior == DiagnosticState::Behavior::Ignore || Consumers.empty()) {
+    ++NumDiagnosticsNotFormatted;
     return;
+  }
 
   // Figure out the source location.
   SourceLoc loc = diagnostic.getLoc();
@@ -682,6 +701,7 @@ void DiagnosticEngine::emitDiagnostic(const Diagnostic &diagnostic) {
   }
 
   // Actually substitute the diagnostic arguments into the diagnostic text.
+  ++NumDiagnosticsFormatted;
   llvm::SmallString<256> Text;
   {
     llvm::raw_svector_ostream Out(Text);
@@ -202,13 +202,10 @@ GenericSignature::getCanonicalManglingSignature(ModuleDecl &M) const {
   }
   
   // Otherwise, we need to compute it.
-  // Dump the generic signature into an ArchetypeBuilder that will figure out
-  // the minimal set of requirements.
-  std::unique_ptr<ArchetypeBuilder> builder(new ArchetypeBuilder(M, 
-                                                                 Context.Diags));
-  
-  builder->addGenericSignature(canonical, /*adoptArchetypes*/ false,
-                               /*treatRequirementsAsExplicit*/ true);
+  // The archetype builder for the canonical signature figures out the
+  // minimal set of requirements. It's shared with everyone else who needs
+  // archetypes for this signature, so the requirements are only solved once.
+  auto builder = canonical->getArchetypeBuilder(M);
   
   // Sort out the requirements.
   struct DependentConstraints {
@@ -373,7 +370,7 @@ GenericSignature::getCanonicalManglingSignature(ModuleDecl &M) const {
   
   // Cache the result.
   Context.ManglingSignatures.insert({{canonical, &M}, canSig});
-  Context.setArchetypeBuilder(canSig, &M, std::move(builder));
+  Context.setArchetypeBuilder(canSig, &M, builder);
 
   return canSig;
 }
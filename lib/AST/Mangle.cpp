@@ -1310,6 +1310,24 @@ static char getSpecifierForNominalType(const NominalTypeDecl *decl) {
   llvm_unreachable("bad decl kind");
 }
 
+/// Whether the mangling of the given nominal type can be shared between
+/// manglers: it must be nested only in other nominal types, and its access
+/// (which decides the private discriminator) must already be known.
+static bool isCacheableTypeContext(const NominalTypeDecl *decl) {
+  while (true) {
+    if (!decl->hasAccessibility())
+      return false;
+
+    auto dc = decl->getDeclContext();
+    if (dc->isModuleScopeContext())
+      return true;
+
+    decl = dyn_cast<NominalTypeDecl>(dc);
+    if (!decl)
+      return false;
+  }
+}
+
 void Mangler::mangleNominalType(const NominalTypeDecl *decl) {
   // Check for certain standard types.
   if (tryMangleStandardSubstitution(decl))
@@ -1323,11 +1341,34 @@ void Mangler::mangleNominalType(const NominalTypeDecl *decl) {
   if (tryMangleSubstitution(key))
     return;
 
+  // With no substitutions in effect, the mangling of a type nested only in
+  // other types depends on nothing but the declarations, so reuse it.
+  ASTContext &ctx = decl->getASTContext();
+  bool cacheable = Substitutions.empty() && isCacheableTypeContext(decl);
+  if (cacheable) {
+    if (auto cached = ctx.getCachedTypeMangling(decl, UsePunycode)) {
+      Buffer << cached->Mangling;
+      for (auto subst : cached->Substitutions)
+        addSubstitution(subst);
+      return;
+    }
+  }
+
+  size_t start = Storage.size();
   Buffer << getSpecifierForNominalType(decl);
   mangleContextOf(decl);
   mangleDeclName(decl);
 
   addSubstitution(key);
+
+  if (cacheable) {
+    SmallVector<const void *, 4> substs(Substitutions.size());
+    for (auto S : Substitutions) substs[S.second] = S.first;
+    ctx.setCachedTypeMangling(decl, UsePunycode,
+                              StringRef(Storage.data() + start,
+                                        Storage.size() - start),
+                              substs);
+  }
 }
 
 void Mangler::mangleProtocolDecl(const ProtocolDecl *protocol) {
@@ -1575,6 +1616,14 @@ void Mangler::mangleInitializerEntity(const VarDecl *var) {
   Buffer << 'i';
 }
 
+void Mangler::mangleLetPropertyValueEntity(const VarDecl *var) {
+  // Like the initializer, the value is its own entity whose context is the
+  // variable.
+  Buffer << 'I';
+  mangleEntity(var, /*uncurry*/ 0);
+  Buffer << 'k';
+}
+
 void Mangler::mangleEntity(const ValueDecl *decl,
                            unsigned uncurryLevel) {
   assert(!isa<ConstructorDecl>(decl));
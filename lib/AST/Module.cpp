@@ -30,6 +30,7 @@
 #include "clang/Basic/Module.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringExtras.h"
@@ -103,6 +104,30 @@ BuiltinUnit::BuiltinUnit(ModuleDecl &M)
 // Normal Module Name Lookup
 //===----------------------------------------------------------------------===//
 
+namespace llvm {
+  template<> struct DenseMapInfo<SourceFile::ImportedLookupKey> {
+    using Key = SourceFile::ImportedLookupKey;
+    static Key getEmptyKey() {
+      return { DenseMapInfo<ModuleDecl *>::getEmptyKey(), Identifier(),
+               DeclName(), 0 };
+    }
+    static Key getTombstoneKey() {
+      return { DenseMapInfo<ModuleDecl *>::getTombstoneKey(), Identifier(),
+               DeclName(), 0 };
+    }
+    static unsigned getHashValue(const Key &key) {
+      return hash_combine(key.Module, key.AccessPath.get(),
+                          DenseMapInfo<DeclName>::getHashValue(key.Name),
+                          key.Options);
+    }
+    static bool isEqual(const Key &lhs, const Key &rhs) {
+      return lhs.Module == rhs.Module && lhs.AccessPath == rhs.AccessPath &&
+             DenseMapInfo<DeclName>::isEqual(lhs.Name, rhs.Name) &&
+             lhs.Options == rhs.Options;
+    }
+  };
+}
+
 class SourceFile::LookupCache {
   /// A lookup map for value decls. When declarations are added they are added
   /// under all variants of the name they can be found under.
@@ -159,6 +184,12 @@ public:
                          const SourceFile &SF);
 
   SmallVector<ValueDecl *, 0> AllVisibleValues;
+
+  /// The results of lookups from this file into imported modules, which are
+  /// valid as long as the context's generation is ImportedLookupsGeneration.
+  llvm::DenseMap<ImportedLookupKey, TinyPtrVector<ValueDecl *>>
+    ImportedLookups;
+  unsigned ImportedLookupsGeneration = 0;
 };
 using SourceLookupCache = SourceFile::LookupCache;
 
@@ -330,6 +361,8 @@ void SourceLookupCache::invalidate() {
   // std::move AllVisibleValues into a temporary to destroy its contents.
   using SameSizeSmallVector = decltype(AllVisibleValues);
   (void)SameSizeSmallVector{std::move(AllVisibleValues)};
+
+  ImportedLookups.shrink_and_clear();
 }
 
 //===----------------------------------------------------------------------===//
@@ -1491,6 +1524,28 @@ SourceFile::getCachedVisibleDecls() const {
   return getCache().AllVisibleValues;
 }
 
+const TinyPtrVector<ValueDecl *> *
+SourceFile::getCachedImportedLookup(const ImportedLookupKey &key) const {
+  auto &cache = getCache();
+  if (cache.ImportedLookupsGeneration != getASTContext().getCurrentGeneration())
+    return nullptr;
+  auto known = cache.ImportedLookups.find(key);
+  if (known == cache.ImportedLookups.end())
+    return nullptr;
+  return &known->second;
+}
+
+void SourceFile::cacheImportedLookup(const ImportedLookupKey &key,
+                                     ArrayRef<ValueDecl *> results) const {
+  auto &cache = getCache();
+  unsigned generation = getASTContext().getCurrentGeneration();
+  if (cache.ImportedLookupsGeneration != generation) {
+    cache.ImportedLookups.clear();
+    cache.ImportedLookupsGeneration = generation;
+  }
+  cache.ImportedLookups[key] = TinyPtrVector<ValueDecl *>(results);
+}
+
 static void performAutoImport(SourceFile &SF,
                               SourceFile::ImplicitModuleImportKind modImpKind) {
   if (SF.Kind == SourceFileKind::SIL)
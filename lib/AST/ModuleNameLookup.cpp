@@ -31,6 +31,54 @@ namespace {
     }
   };
 
+  /// Lets a lookup of one name from a source file reuse, and remember, the
+  /// results of looking into the modules the file imports.
+  ///
+  /// A module's results are only remembered when they were found without
+  /// help from the per-lookup ModuleLookupCache, since such results depend on
+  /// which modules the lookup happened to visit first. The file's own module
+  /// is never remembered, since declarations are added to it as the file is
+  /// parsed and type-checked.
+  class ImportedLookupMemo {
+    const SourceFile &File;
+    DeclName Name;
+    unsigned Options;
+
+    /// For each module being looked into, whether its results can be
+    /// remembered.
+    SmallVector<bool, 8> Rememberable;
+
+  public:
+    ImportedLookupMemo(const SourceFile &file, DeclName name,
+                       NLKind lookupKind, bool hasTypeResolver)
+      : File(file), Name(name),
+        Options(static_cast<unsigned>(lookupKind) << 1 | hasTypeResolver) {}
+
+    const SourceFile &getFile() const { return File; }
+
+    SourceFile::ImportedLookupKey getKey(Module *module,
+                                         Module::AccessPathTy accessPath,
+                                         ResolutionKind resolutionKind,
+                                         bool checksFileAccess) const {
+      assert(accessPath.size() <= 1 && "can only refer to top-level decls");
+      unsigned options = Options << 3 |
+                         static_cast<unsigned>(resolutionKind) << 1 |
+                         checksFileAccess;
+      return { module,
+               accessPath.empty() ? Identifier() : accessPath.front().first,
+               Name, options };
+    }
+
+    void push(bool rememberable) { Rememberable.push_back(rememberable); }
+    bool pop() { return Rememberable.pop_back_val(); }
+
+    /// Notes that the modules currently being looked into have seen results
+    /// that can't be remembered.
+    void forgetActive() {
+      std::fill(Rememberable.begin(), Rememberable.end(), false);
+    }
+  };
+
   using CanTypeSet = llvm::SmallSet<CanType, 4, SortCanType>;
   using NamedCanTypeSet =
     llvm::DenseMap<Identifier, std::pair<ResolutionKind, CanTypeSet>>;
@@ -145,6 +193,7 @@ static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
                            ResolutionKind resolutionKind, bool canReturnEarly,
                            LazyResolver *typeResolver,
                            ModuleLookupCache &cache,
+                           ImportedLookupMemo *memo,
                            const DeclContext *moduleScopeContext,
                            bool respectAccessControl,
                            ArrayRef<Module::ImportedModule> extraImports,
@@ -159,10 +208,29 @@ static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
   bool isNew;
   std::tie(iter, isNew) = cache.insert({{accessPath, module}, {}});
   if (!isNew) {
+    if (memo)
+      memo->forgetActive();
     decls.append(iter->second.begin(), iter->second.end());
     return;
   }
 
+  Optional<SourceFile::ImportedLookupKey> memoKey;
+  if (memo) {
+    if (module == memo->getFile().getParentModule() || !extraImports.empty()) {
+      memo->forgetActive();
+    } else {
+      memoKey = memo->getKey(module, accessPath, resolutionKind,
+                             moduleScopeContext != nullptr);
+      if (auto cached = memo->getFile().getCachedImportedLookup(*memoKey)) {
+        module->getASTContext().recordImportedLookup(/*hit=*/true);
+        decls.append(cached->begin(), cached->end());
+        iter->second = *cached;
+        return;
+      }
+    }
+    memo->push(memoKey.hasValue());
+  }
+
   size_t initialCount = decls.size();
 
   SmallVector<ValueDecl *, 4> localDecls;
@@ -221,8 +289,9 @@ static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
       auto &resultSet = next.first.empty() ? unscopedValues : scopedValues;
       lookupInModule<OverloadSetTy>(next.second, combinedAccessPath,
                                     resultSet, resolutionKind, canReturnEarly,
-                                    typeResolver, cache, moduleScopeContext,
-                                    respectAccessControl, {}, callback);
+                                    typeResolver, cache, memo,
+                                    moduleScopeContext, respectAccessControl,
+                                    {}, callback);
     }
 
     // Add the results from scoped imports.
@@ -250,6 +319,12 @@ static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
   cachedValues.insert(cachedValues.end(),
                       decls.begin() + initialCount,
                       decls.end());
+
+  if (memo && memo->pop() && memoKey) {
+    module->getASTContext().recordImportedLookup(/*hit=*/false);
+    memo->getFile().cacheImportedLookup(
+        *memoKey, llvm::makeArrayRef(decls).slice(initialCount));
+  }
 }
 
 void namelookup::lookupInModule(Module *startModule,
@@ -263,12 +338,19 @@ void namelookup::lookupInModule(Module *startModule,
                                 ArrayRef<Module::ImportedModule> extraImports) {
   assert(moduleScopeContext && moduleScopeContext->isModuleScopeContext());
   ModuleLookupCache cache;
+  Optional<ImportedLookupMemo> memo;
+  ImportedLookupMemo *memoPtr = nullptr;
+  if (auto SF = dyn_cast<SourceFile>(moduleScopeContext)) {
+    memo.emplace(*SF, name, lookupKind, typeResolver != nullptr);
+    memoPtr = memo.getPointer();
+  }
   bool respectAccessControl = startModule->getASTContext().LangOpts
                                 .EnableAccessControl;
   ::lookupInModule<CanTypeSet>(startModule, topAccessPath, decls,
                                resolutionKind, /*canReturnEarly=*/true,
-                               typeResolver, cache, moduleScopeContext,
-                               respectAccessControl, extraImports,
+                               typeResolver, cache, memoPtr,
+                               moduleScopeContext, respectAccessControl,
+                               extraImports,
     [=](Module *module, Module::AccessPathTy path,
         SmallVectorImpl<ValueDecl *> &localDecls) {
       module->lookupValue(path, name, lookupKind, localDecls);
@@ -290,8 +372,9 @@ void namelookup::lookupVisibleDeclsInModule(
   bool respectAccessControl = M->getASTContext().LangOpts.EnableAccessControl;
   ::lookupInModule<NamedCanTypeSet>(M, accessPath, decls,
                                     resolutionKind, /*canReturnEarly=*/false,
-                                    typeResolver, cache, moduleScopeContext,
-                                    respectAccessControl, extraImports,
+                                    typeResolver, cache, /*memo=*/nullptr,
+                                    moduleScopeContext, respectAccessControl,
+                                    extraImports,
     [=](Module *module, Module::AccessPathTy path,
         SmallVectorImpl<ValueDecl *> &localDecls) {
       VectorDeclConsumer consumer(localDecls);
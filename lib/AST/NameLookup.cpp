@@ -736,6 +736,11 @@ public:
                            ExtensionDecl *ext,
                            DeclRange members);
 
+  /// \brief Add the members named \p name of \p nominal, and of the
+  /// extensions already included, that are loaded by name rather than all
+  /// at once.
+  void addNamedLazyMembers(NominalTypeDecl *nominal, DeclName name);
+
   /// Iterator into the lookup table.
   typedef LookupTable::iterator iterator;
 
@@ -856,13 +861,36 @@ void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal) {
     return;
 
   // Add members from each of the extensions that we have not yet visited.
+  // Those whose members can be loaded by name are left to
+  // addNamedLazyMembers().
   for (auto next = LastExtensionIncluded
                      ? LastExtensionIncluded->NextExtension.getPointer()
                      : nominal->FirstExtension;
        next;
        (LastExtensionIncluded = next,next = next->NextExtension.getPointer())) {
-    addMembers(next->getMembers());
+    if (!next->canLoadMembersByName())
+      addMembers(next->getMembers());
+  }
+}
+
+void MemberLookupTable::addNamedLazyMembers(NominalTypeDecl *nominal,
+                                            DeclName name) {
+  SmallVector<ValueDecl *, 4> members;
+  if (nominal->canLoadMembersByName())
+    nominal->loadNamedMembers(name.getBaseName(), members);
+
+  if (LastExtensionIncluded) {
+    for (auto ext = nominal->FirstExtension; ext;
+         ext = ext->NextExtension.getPointer()) {
+      if (ext->canLoadMembersByName())
+        ext->loadNamedMembers(name.getBaseName(), members);
+      if (ext == LastExtensionIncluded)
+        break;
+    }
   }
+
+  for (auto member : members)
+    addMember(member);
 }
 
 void MemberLookupTable::destroy() {
@@ -898,8 +926,8 @@ void NominalTypeDecl::prepareLookupTable(bool ignoreNewExtensions) {
   }
 
   // If we haven't walked the member list yet to update the lookup
-  // table, do so now.
-  if (!LookupTable.getInt()) {
+  // table, do so now, unless the members are going to be loaded by name.
+  if (!LookupTable.getInt() && !canLoadMembersByName()) {
     // Note that we'll have walked the members now.
     LookupTable.setInt(true);
 
@@ -925,15 +953,18 @@ void NominalTypeDecl::makeMemberVisible(ValueDecl *member) {
 ArrayRef<ValueDecl *> NominalTypeDecl::lookupDirect(DeclName name,
                                                     bool ignoreNewExtensions) {
   // Make sure we have the complete list of members (in this nominal and in all
-  // extensions).
+  // extensions), except for serialized members that can be loaded by name.
   if (!ignoreNewExtensions) {
     for (auto E : getExtensions())
-      (void)E->getMembers();
+      if (!E->canLoadMembersByName())
+        (void)E->getMembers();
   }
 
-  (void)getMembers();
+  if (!canLoadMembersByName())
+    (void)getMembers();
 
   prepareLookupTable(ignoreNewExtensions);
+  LookupTable.getPointer()->addNamedLazyMembers(this, name);
 
   // Look for the declarations with this name.
   auto known = LookupTable.getPointer()->find(name);
@@ -14,12 +14,14 @@
 #include "Darwin/Cache-Mac.cpp"
 #else
 
-//  This file implements a default caching implementation that never evicts
-//  its entries.
+//  This file implements a default caching implementation that evicts the
+//  least recently used entries once the total cost of the cached values
+//  exceeds a limit.
 
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Mutex.h"
+#include <list>
 
 using namespace swift::sys;
 using llvm::StringRef;
@@ -33,12 +35,67 @@ struct DefaultCacheKey {
   DefaultCacheKey(void *Key, CacheImpl::CallBacks *CBs) : Key(Key), CBs(CBs) {}
 };
 
+struct DefaultCacheEntry {
+  void *Key;
+  void *Value;
+  size_t Cost;
+};
+
+/// The state of a value which is retained by a client.
+struct RetainedValue {
+  unsigned RetainCount = 0;
+
+  /// The number of times the value was removed from the cache while it was
+  /// retained. The value destroy callback is invoked that many times when the
+  /// value is released for the last time.
+  unsigned PendingDestroys = 0;
+};
+
 struct DefaultCache {
   llvm::sys::Mutex Mux;
   CacheImpl::CallBacks CBs;
-  llvm::DenseMap<DefaultCacheKey, void *> Entries;
+
+  /// The entries, the most recently used first.
+  std::list<DefaultCacheEntry> LRU;
+  llvm::DenseMap<DefaultCacheKey, std::list<DefaultCacheEntry>::iterator>
+    Entries;
+  llvm::DenseMap<void *, RetainedValue> Retained;
+
+  size_t CostLimit = 0;
+  CacheStatistics Stats;
 
   explicit DefaultCache(CacheImpl::CallBacks CBs) : CBs(std::move(CBs)) { }
+
+  bool isRetained(void *Value) const { return Retained.count(Value); }
+
+  /// Destroys the key of \p Entry and destroys its value, or defers that
+  /// until the value is released.
+  void removeEntry(std::list<DefaultCacheEntry>::iterator Entry) {
+    Entries.erase(DefaultCacheKey(Entry->Key, &CBs));
+    CBs.keyDestroyCB(Entry->Key, CBs.UserData);
+    auto RV = Retained.find(Entry->Value);
+    if (RV != Retained.end())
+      ++RV->second.PendingDestroys;
+    else
+      CBs.valueDestroyCB(Entry->Value, CBs.UserData);
+    Stats.TotalCost -= Entry->Cost;
+    LRU.erase(Entry);
+  }
+
+  /// Evicts the least recently used values which are not retained until the
+  /// total cost is at most \p Limit.
+  void evictDownTo(size_t Limit) {
+    auto I = LRU.end();
+    while (Stats.TotalCost > Limit && I != LRU.begin()) {
+      auto Entry = std::prev(I);
+      if (isRetained(Entry->Value)) {
+        I = Entry;
+        continue;
+      }
+      removeEntry(Entry);
+      ++Stats.Evictions;
+    }
+  }
 };
 } // end anonymous namespace
 
@@ -77,16 +134,16 @@ void CacheImpl::setAndRetain(void *Key, void *Value, size_t Cost) {
 
   DefaultCacheKey CKey(Key, &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
-  }
+  if (Entry != DCache.Entries.end())
+    DCache.removeEntry(Entry->second);
 
-  DCache.Entries[CKey] = Value;
+  DCache.LRU.push_front({ Key, Value, Cost });
+  DCache.Entries[CKey] = DCache.LRU.begin();
+  ++DCache.Retained[Value].RetainCount;
+  DCache.Stats.TotalCost += Cost;
 
-  // FIXME: Not thread-safe! It should avoid deleting the value until
-  // 'releaseValue is called on it.
+  if (DCache.CostLimit != 0)
+    DCache.evictDownTo(DCache.CostLimit);
 }
 
 bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
@@ -95,17 +152,35 @@ bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
 
   DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    // FIXME: Not thread-safe! It should avoid deleting the value until
-    // 'releaseValue is called on it.
-    *Value_out = Entry->second;
-    return true;
+  if (Entry == DCache.Entries.end()) {
+    ++DCache.Stats.Misses;
+    return false;
   }
-  return false;
+
+  ++DCache.Stats.Hits;
+  DCache.LRU.splice(DCache.LRU.begin(), DCache.LRU, Entry->second);
+  *Value_out = Entry->second->Value;
+  ++DCache.Retained[*Value_out].RetainCount;
+  return true;
 }
 
 void CacheImpl::releaseValue(void *Value) {
-  // FIXME: Implementation.
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+
+  auto RV = DCache.Retained.find(Value);
+  assert(RV != DCache.Retained.end() && "value is not retained");
+  if (--RV->second.RetainCount != 0)
+    return;
+
+  unsigned PendingDestroys = RV->second.PendingDestroys;
+  DCache.Retained.erase(RV);
+  for (unsigned i = 0; i != PendingDestroys; ++i)
+    DCache.CBs.valueDestroyCB(Value, DCache.CBs.UserData);
+
+  // The value may have kept the cache above its limit.
+  if (DCache.CostLimit != 0)
+    DCache.evictDownTo(DCache.CostLimit);
 }
 
 bool CacheImpl::remove(const void *Key) {
@@ -115,9 +190,7 @@ bool CacheImpl::remove(const void *Key) {
   DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
   auto Entry = DCache.Entries.find(CKey);
   if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
+    DCache.removeEntry(Entry->second);
     return true;
   }
   return false;
@@ -127,11 +200,31 @@ void CacheImpl::removeAll() {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
   llvm::sys::ScopedLock L(DCache.Mux);
 
-  for (auto Entry : DCache.Entries) {
-    DCache.CBs.keyDestroyCB(Entry.first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry.second, nullptr);
-  }
-  DCache.Entries.clear();
+  while (!DCache.LRU.empty())
+    DCache.removeEntry(DCache.LRU.begin());
+}
+
+void CacheImpl::setCostLimit(size_t Limit) {
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+
+  DCache.CostLimit = Limit;
+  if (Limit != 0)
+    DCache.evictDownTo(Limit);
+}
+
+void CacheImpl::purge() {
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+
+  DCache.evictDownTo(0);
+}
+
+CacheStatistics CacheImpl::getStatistics() {
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  llvm::sys::ScopedLock L(DCache.Mux);
+
+  return DCache.Stats;
 }
 
 void CacheImpl::destroy() {
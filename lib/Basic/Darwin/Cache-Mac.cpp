@@ -65,6 +65,18 @@ void CacheImpl::removeAll() {
   cache_remove_all(static_cast<cache_t*>(Impl));
 }
 
+void CacheImpl::setCostLimit(size_t Limit) {
+  cache_set_cost_hint(static_cast<cache_t*>(Impl), Limit);
+}
+
+void CacheImpl::purge() {
+  // libcache already evicts values when the system reports memory pressure.
+}
+
+CacheStatistics CacheImpl::getStatistics() {
+  return CacheStatistics();
+}
+
 void CacheImpl::destroy() {
   cache_destroy(static_cast<cache_t*>(Impl));
 }
@@ -21,6 +21,7 @@
 #include "swift/Basic/Punycode.h"
 #include "swift/Basic/UUID.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Compiler.h"
 #include <functional>
 #include <vector>
 #include <cstdio>
@@ -96,6 +97,52 @@ Node::~Node() {
   unreachable("bad payload kind");
 }
 
+/// The innermost NodeArena alive on the current thread.
+static LLVM_THREAD_LOCAL NodeArena *CurrentNodeArena = nullptr;
+
+/// The size of an arena's first slab. Each new slab is twice as big as the
+/// previous one, up to MaxNodeArenaSlabSize.
+static const size_t InitialNodeArenaSlabSize = 4096;
+static const size_t MaxNodeArenaSlabSize = 64 * 1024;
+
+NodeArena::NodeArena()
+    : NextSlabSize(InitialNodeArenaSlabSize), Enclosing(CurrentNodeArena) {
+  CurrentNodeArena = this;
+}
+
+NodeArena::~NodeArena() {
+  assert(NumLiveNodes == 0 && "demangler node outlived its arena");
+  assert(CurrentNodeArena == this && "arenas destroyed out of order");
+  CurrentNodeArena = Enclosing;
+  while (Slabs) {
+    Slab *next = Slabs->Next;
+    std::free(Slabs);
+    Slabs = next;
+  }
+}
+
+NodeArena *NodeArena::getCurrent() {
+  return CurrentNodeArena;
+}
+
+void *NodeArena::allocateSlow(size_t size, size_t alignment) {
+  size_t slabSize = NextSlabSize;
+  size_t needed = sizeof(Slab) + size + alignment;
+  if (needed > slabSize)
+    slabSize = needed;
+  else if (NextSlabSize < MaxNodeArenaSlabSize)
+    NextSlabSize *= 2;
+
+  auto slab = static_cast<Slab *>(std::malloc(slabSize));
+  if (!slab)
+    unreachable("out of memory allocating demangler nodes");
+  slab->Next = Slabs;
+  Slabs = slab;
+  CurPtr = reinterpret_cast<char *>(slab + 1);
+  End = reinterpret_cast<char *>(slab) + slabSize;
+  return allocate(size, alignment);
+}
+
 namespace {
   struct FindPtr {
     FindPtr(Node *v) : Target(v) {}
@@ -1339,6 +1386,9 @@ private:
       // entity-name ::= 'i'
       } else if (Mangled.nextIf('i')) {
         entityKind = Node::Kind::Initializer;
+      // entity-name ::= 'k'
+      } else if (Mangled.nextIf('k')) {
+        entityKind = Node::Kind::LetPropertyValue;
       } else {
         return nullptr;
       }
@@ -2428,6 +2478,7 @@ private:
     case Node::Kind::Initializer:
     case Node::Kind::LazyProtocolWitnessTableAccessor:
     case Node::Kind::LazyProtocolWitnessTableCacheVariable:
+    case Node::Kind::LetPropertyValue:
     case Node::Kind::LocalDeclName:
     case Node::Kind::PrivateDeclName:
     case Node::Kind::MaterializeForSet:
@@ -2755,6 +2806,7 @@ static bool useColonForEntityType(NodePointer entity, NodePointer type) {
   case Node::Kind::Initializer:
   case Node::Kind::DefaultArgumentInitializer:
   case Node::Kind::IVarInitializer:
+  case Node::Kind::LetPropertyValue:
   case Node::Kind::Class:
   case Node::Kind::Structure:
   case Node::Kind::Enum:
@@ -2913,6 +2965,9 @@ void NodePrinter::print(NodePointer pointer, bool asContext, bool suppressType)
   case Node::Kind::Initializer:
     printEntity(false, false, "(variable initialization expression)");
     return;
+  case Node::Kind::LetPropertyValue:
+    printEntity(false, false, "(known let property value)");
+    return;
   case Node::Kind::DefaultArgumentInitializer: {
     auto index = pointer->getChild(1);
     DemanglerPrinter strPrinter;
@@ -3663,6 +3718,8 @@ std::string Demangle::nodeToString(NodePointer root,
 std::string Demangle::demangleSymbolAsString(const char *MangledName,
                                              size_t MangledNameLength,
                                              const DemangleOptions &Options) {
+  // The parse tree doesn't outlive this function.
+  NodeArena arena;
   auto mangled = StringRef(MangledName, MangledNameLength);
   auto root = demangleSymbolAsNode(MangledName, MangledNameLength, Options);
   if (!root) return mangled.str();
@@ -3676,6 +3733,8 @@ std::string Demangle::demangleSymbolAsString(const char *MangledName,
 std::string Demangle::demangleTypeAsString(const char *MangledName,
                                            size_t MangledNameLength,
                                            const DemangleOptions &Options) {
+  // The parse tree doesn't outlive this function.
+  NodeArena arena;
   auto mangled = StringRef(MangledName, MangledNameLength);
   auto root = demangleTypeAsNode(MangledName, MangledNameLength, Options);
   if (!root) return mangled.str();
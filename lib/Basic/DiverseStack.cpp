@@ -44,6 +44,25 @@ void DiverseStackBase::pushNewStorageSlow(std::size_t needed) {
   if (!wasInline) delete[] oldAllocation;
 }  
 
+void DiverseStackBase::reserveStorageSlow(std::size_t capacity) {
+  bool wasInline = isAllocatedInline();
+
+  // Keep the allocation a multiple of the alignment.
+  capacity = (capacity + 15) & ~std::size_t(15);
+  assert(capacity > std::size_t(End - Allocated) && "not growing the stack");
+
+  char *oldAllocation = Allocated;
+  char *oldBegin = Begin;
+  std::size_t oldSize = (std::size_t) (End - oldBegin);
+
+  Allocated = new char[capacity];
+  End = Allocated + capacity;
+  Begin = End - oldSize;
+  std::memcpy(Begin, oldBegin, oldSize);
+
+  if (!wasInline) delete[] oldAllocation;
+}
+
 char *DiverseListBase::addNewStorageSlow(std::size_t needed) {
   bool wasInline = isAllocatedInline();
 
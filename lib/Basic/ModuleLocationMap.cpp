@@ -0,0 +1,97 @@
+//===--- ModuleLocationMap.cpp - Listings of module search paths ----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/ModuleLocationMap.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace swift;
+
+/// The first line of a written map. Bump the version whenever the format
+/// changes.
+static const char MapHeader[] = "swift-module-location-map 1";
+
+void ModuleLocationMap::addDirectory(StringRef directory) {
+  if (hasDirectory(directory))
+    return;
+
+  llvm::StringSet<> entries;
+  std::error_code err;
+  for (llvm::sys::fs::directory_iterator iter(directory, err), end;
+       !err && iter != end; iter.increment(err)) {
+    entries.insert(llvm::sys::path::filename(iter->path()).lower());
+  }
+
+  if (err && err != std::errc::no_such_file_or_directory &&
+      err != std::errc::not_a_directory) {
+    UnlistableDirectories.insert(directory);
+    return;
+  }
+  Directories[directory] = std::move(entries);
+}
+
+bool ModuleLocationMap::mayContain(StringRef directory, StringRef name) const {
+  auto known = Directories.find(directory);
+  if (known == Directories.end())
+    return true;
+  return known->second.count(name.lower());
+}
+
+void ModuleLocationMap::write(llvm::raw_ostream &os) const {
+  os << MapHeader << '\n';
+  for (auto &directory : Directories) {
+    os << "d " << directory.getKey() << '\n';
+    for (auto &entry : directory.getValue())
+      os << "e " << entry.getKey() << '\n';
+  }
+  for (auto &directory : UnlistableDirectories)
+    os << "u " << directory.getKey() << '\n';
+}
+
+bool ModuleLocationMap::read(StringRef contents) {
+  SmallVector<StringRef, 64> lines;
+  contents.split(lines, '\n', -1, /*KeepEmpty=*/false);
+  if (lines.empty() || lines.front() != MapHeader)
+    return true;
+
+  // Check the whole map before adding any of it.
+  for (StringRef line : llvm::makeArrayRef(lines).slice(1)) {
+    if (line.size() < 3 || line[1] != ' ' ||
+        (line[0] != 'd' && line[0] != 'e' && line[0] != 'u'))
+      return true;
+  }
+  if (lines.size() > 1 && lines[1][0] == 'e')
+    return true;
+
+  llvm::StringSet<> *entries = nullptr;
+  for (StringRef line : llvm::makeArrayRef(lines).slice(1)) {
+    StringRef value = line.substr(2);
+    switch (line[0]) {
+    case 'd':
+      entries = hasDirectory(value) ? nullptr : &Directories[value];
+      break;
+    case 'e':
+      if (entries)
+        entries->insert(value);
+      break;
+    case 'u':
+      entries = nullptr;
+      if (!Directories.count(value))
+        UnlistableDirectories.insert(value);
+      break;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,120 @@
+//===--- ReferenceDependencies.cpp - Binary swiftdeps format --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/ReferenceDependencies.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace swift;
+using namespace swift::reference_dependencies;
+using namespace llvm::support;
+
+StringRef reference_dependencies::getYAMLKey(Section section) {
+  switch (section) {
+  case Section::ProvidesTopLevel: return "provides-top-level";
+  case Section::ProvidesNominal: return "provides-nominal";
+  case Section::ProvidesMember: return "provides-member";
+  case Section::ProvidesDynamicLookup: return "provides-dynamic-lookup";
+  case Section::DependsTopLevel: return "depends-top-level";
+  case Section::DependsMember: return "depends-member";
+  case Section::DependsNominal: return "depends-nominal";
+  case Section::DependsDynamicLookup: return "depends-dynamic-lookup";
+  case Section::DependsExternal: return "depends-external";
+  case Section::InterfaceHash: return "interface-hash";
+  case Section::ProvidesFingerprint: return "provides-fingerprints";
+  }
+  llvm_unreachable("unhandled section");
+}
+
+bool reference_dependencies::readEntries(
+    StringRef data,
+    llvm::function_ref<bool(Section, StringRef, bool)> callback) {
+  if (data.size() < HeaderSize || !isBinaryFormat(data))
+    return false;
+
+  auto bytes = reinterpret_cast<const uint8_t *>(data.data());
+  if (endian::read16le(bytes + 4) != FormatVersion)
+    return false;
+  uint64_t numRecords = endian::read32le(bytes + 8);
+  uint64_t stringTableSize = endian::read32le(bytes + 12);
+
+  uint64_t stringTableStart = HeaderSize + numRecords * RecordSize;
+  if (stringTableStart + stringTableSize != data.size())
+    return false;
+  StringRef stringTable = data.substr(stringTableStart);
+
+  for (const uint8_t *record = bytes + HeaderSize,
+                     *end = bytes + stringTableStart;
+       record != end; record += RecordSize) {
+    if (record[0] > uint8_t(Section::LastSection))
+      return false;
+    uint64_t offset = endian::read32le(record + 4);
+    uint64_t length = endian::read32le(record + 8);
+    if (offset + length > stringTableSize)
+      return false;
+
+    if (!callback(Section(record[0]), stringTable.substr(offset, length),
+                  record[1] & IsCascadingFlag))
+      return false;
+  }
+  return true;
+}
+
+uint32_t Writer::addString(StringRef string) {
+  auto insertResult = StringOffsets.insert({string, StringTable.size()});
+  if (insertResult.second)
+    StringTable += string;
+  return insertResult.first->second;
+}
+
+void Writer::addEntry(Section section, StringRef name, bool isCascading) {
+  Records.push_back({section, isCascading, addString(name),
+                     uint32_t(name.size())});
+}
+
+void Writer::addMemberEntry(Section section, StringRef baseName,
+                            StringRef memberName, bool isCascading) {
+  llvm::SmallString<64> name;
+  name += baseName;
+  name.push_back('\0');
+  name += memberName;
+  addEntry(section, name, isCascading);
+}
+
+void Writer::addFingerprint(StringRef fingerprint) {
+  assert(!Records.empty() &&
+         Records.back().section <= Section::ProvidesDynamicLookup &&
+         "fingerprints only follow provides entries");
+  addEntry(Section::ProvidesFingerprint, fingerprint);
+}
+
+void Writer::write(raw_ostream &out) const {
+  endian::Writer<little> writer(out);
+  out.write(Signature, sizeof(Signature));
+  writer.write<uint16_t>(FormatVersion);
+  writer.write<uint16_t>(0);
+  writer.write<uint32_t>(Records.size());
+  writer.write<uint32_t>(StringTable.size());
+
+  for (auto &record : Records) {
+    writer.write<uint8_t>(uint8_t(record.section));
+    writer.write<uint8_t>(record.isCascading ? IsCascadingFlag : 0);
+    writer.write<uint16_t>(0);
+    writer.write<uint32_t>(record.offset);
+    writer.write<uint32_t>(record.length);
+  }
+
+  out << StringTable;
+}
@@ -787,6 +787,10 @@ void Remangler::mangleInitializer(Node *node, EntityContext &ctx) {
   mangleSimpleEntity(node, 'I', "i", ctx);
 }
 
+void Remangler::mangleLetPropertyValue(Node *node, EntityContext &ctx) {
+  mangleSimpleEntity(node, 'I', "k", ctx);
+}
+
 void Remangler::mangleDefaultArgumentInitializer(Node *node,
                                                  EntityContext &ctx) {
   mangleNamedEntity(node, 'I', "A", ctx);
@@ -15,6 +15,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 using namespace swift;
 
@@ -201,6 +202,57 @@ unsigned SourceManager::findBufferContainingLoc(SourceLoc Loc) const {
   llvm_unreachable("no buffer containing location found");
 }
 
+ArrayRef<unsigned>
+SourceManager::getLineStartOffsets(unsigned BufferID) const {
+  if (LineStartOffsets.size() <= BufferID)
+    LineStartOffsets.resize(BufferID + 1);
+
+  auto &Offsets = LineStartOffsets[BufferID];
+  if (Offsets.empty()) {
+    StringRef Buffer = LLVMSourceMgr.getMemoryBuffer(BufferID)->getBuffer();
+    Offsets.push_back(0);
+    for (size_t i = 0, e = Buffer.size(); i != e; ++i)
+      if (Buffer[i] == '\n')
+        Offsets.push_back(i + 1);
+  }
+  return Offsets;
+}
+
+std::pair<unsigned, unsigned>
+SourceManager::getPhysicalLineAndColumn(SourceLoc Loc,
+                                        unsigned BufferID) const {
+  if (BufferID == 0)
+    BufferID = findBufferContainingLoc(Loc);
+  ArrayRef<unsigned> Offsets = getLineStartOffsets(BufferID);
+  unsigned Offset = getLocOffsetInBuffer(Loc, BufferID);
+
+  // Queries mostly arrive in source order, so try the line of the previous
+  // query and the one after it before searching.
+  auto containsOffset = [&](unsigned Line) {
+    return Line < Offsets.size() && Offsets[Line] <= Offset &&
+           (Line + 1 == Offsets.size() || Offset < Offsets[Line + 1]);
+  };
+  unsigned Line;
+  if (CachedLine.first == BufferID && containsOffset(CachedLine.second)) {
+    Line = CachedLine.second;
+  } else if (CachedLine.first == BufferID &&
+             containsOffset(CachedLine.second + 1)) {
+    Line = CachedLine.second + 1;
+  } else {
+    Line = std::upper_bound(Offsets.begin(), Offsets.end(), Offset) -
+           Offsets.begin() - 1;
+  }
+  CachedLine = {BufferID, Line};
+
+  // Like llvm::SourceMgr, count columns from the last carriage return too.
+  StringRef Buffer = LLVMSourceMgr.getMemoryBuffer(BufferID)->getBuffer();
+  unsigned LineStart = Offsets[Line];
+  size_t CR = Buffer.slice(LineStart, Offset).find_last_of('\r');
+  if (CR != StringRef::npos)
+    LineStart += CR + 1;
+  return { Line + 1, Offset - LineStart + 1 };
+}
+
 void SourceLoc::printLineAndColumn(raw_ostream &OS,
                                    const SourceManager &SM) const {
   if (isInvalid()) {
@@ -0,0 +1,97 @@
+//===--- Statistic.cpp - Always-on statistics of a frontend job -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Statistic.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace swift;
+
+UnifiedStatsReporter::UnifiedStatsReporter(StringRef programName,
+                                           StringRef auxName,
+                                           StringRef directory)
+    : Filename(directory) {
+  llvm::sys::path::append(Filename, "stats-" + programName + "-" + auxName +
+                                        "-%%%%%%%%.json");
+}
+
+/// Writes \p str as a JSON string.
+static void writeJSONString(raw_ostream &os, StringRef str) {
+  os << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      os << '\\';
+    os << c;
+  }
+  os << '"';
+}
+
+UnifiedStatsReporter::~UnifiedStatsReporter() {
+  // Statistics are a by-product of the job, so failing to write them is not
+  // an error of the job.
+  if (llvm::sys::fs::create_directories(
+          llvm::sys::path::parent_path(Filename)))
+    return;
+  int fd;
+  SmallString<128> path;
+  if (llvm::sys::fs::createUniqueFile(Filename, fd, path))
+    return;
+
+  llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+  const char *separator = "{\n";
+  auto writeKey = [&](StringRef group, StringRef name) {
+    os << separator << "  ";
+    writeJSONString(os, (group + "." + name).str());
+    os << ": ";
+    separator = ",\n";
+  };
+
+#define FRONTEND_STATISTIC(Group, Name) \
+  writeKey(#Group, #Name); \
+  os << FrontendCounters.Name;
+#include "swift/Basic/Statistics.def"
+
+  for (auto &entry : PhaseTimes) {
+    writeKey("time", entry.first);
+    os << llvm::format("%.6f", entry.second);
+  }
+  for (auto &entry : PhaseArenaBytes) {
+    writeKey("arena", entry.first);
+    os << entry.second;
+  }
+  os << "\n}\n";
+}
+
+void UnifiedStatsReporter::recordPhaseTime(StringRef phase, double seconds) {
+  std::lock_guard<std::mutex> guard(PhasesMutex);
+  for (auto &entry : PhaseTimes) {
+    if (entry.first == phase) {
+      entry.second += seconds;
+      return;
+    }
+  }
+  PhaseTimes.push_back({phase, seconds});
+}
+
+void UnifiedStatsReporter::recordPhaseArenaBytes(StringRef phase,
+                                                 size_t bytes) {
+  std::lock_guard<std::mutex> guard(PhasesMutex);
+  for (auto &entry : PhaseArenaBytes) {
+    if (entry.first == phase) {
+      entry.second += bytes;
+      return;
+    }
+  }
+  PhaseArenaBytes.push_back({phase, bytes});
+}
@@ -11,7 +11,17 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/Timer.h"
+#include "swift/Basic/Statistic.h"
 
 using namespace swift;
 
 SharedTimer::State SharedTimer::CompilationTimersEnabled = State::Initial;
+UnifiedStatsReporter *SharedTimer::StatsReporter = nullptr;
+
+SharedTimer::~SharedTimer() {
+  if (!StartTime || !StatsReporter)
+    return;
+  llvm::TimeRecord elapsed = llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+  elapsed -= *StartTime;
+  StatsReporter->recordPhaseTime(Name, elapsed.getWallTime());
+}
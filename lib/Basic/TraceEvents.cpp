@@ -0,0 +1,105 @@
+//===--- TraceEvents.cpp - Chrome trace events of a frontend job ----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/TraceEvents.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+
+#if defined(LLVM_ON_UNIX)
+#include <unistd.h>
+#endif
+
+using namespace swift;
+
+TraceEventRecorder *TraceEventRecorder::Current = nullptr;
+
+TraceEventRecorder::TraceEventRecorder(StringRef programName,
+                                       StringRef auxName,
+                                       StringRef directory)
+    : Filename(directory), ProcessName((programName + " " + auxName).str()) {
+  llvm::sys::path::append(Filename, "trace-" + programName + "-" + auxName +
+                                        "-%%%%%%%%.json");
+}
+
+uint64_t TraceEventRecorder::now() {
+  llvm::sys::TimeValue time = llvm::sys::TimeValue::now();
+  return uint64_t(time.toEpochTime()) * 1000000 + time.microseconds();
+}
+
+void TraceEventRecorder::recordSpan(StringRef name, StringRef detail,
+                                    uint64_t startMicros) {
+  uint64_t endMicros = now();
+  std::lock_guard<std::mutex> guard(EventsMutex);
+  auto inserted = ThreadIndices.insert(
+      {std::this_thread::get_id(), unsigned(ThreadIndices.size())});
+  Events.push_back({name, detail, startMicros, endMicros - startMicros,
+                    inserted.first->second});
+}
+
+/// Writes \p str as a JSON string.
+static void writeJSONString(raw_ostream &os, StringRef str) {
+  os << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      os << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      os << llvm::format("\\u%04x", c);
+    else
+      os << c;
+  }
+  os << '"';
+}
+
+TraceEventRecorder::~TraceEventRecorder() {
+  // A trace is a by-product of the job, so failing to write it is not an
+  // error of the job.
+  if (llvm::sys::fs::create_directories(
+          llvm::sys::path::parent_path(Filename)))
+    return;
+  int fd;
+  SmallString<128> path;
+  if (llvm::sys::fs::createUniqueFile(Filename, fd, path))
+    return;
+
+#if defined(LLVM_ON_UNIX)
+  unsigned pid = getpid();
+#else
+  unsigned pid = 0;
+#endif
+
+  llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+  os << "{\"traceEvents\":[\n";
+  os << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << pid
+     << ",\"tid\":0,\"args\":{\"name\":";
+  writeJSONString(os, ProcessName);
+  os << "}}";
+
+  // Spans end in the order they are recorded, so nested spans come before the
+  // spans enclosing them, which trace viewers handle fine.
+  for (auto &event : Events) {
+    os << ",\n{\"ph\":\"X\",\"name\":";
+    writeJSONString(os, event.Name);
+    os << ",\"pid\":" << pid << ",\"tid\":" << event.ThreadIndex
+       << ",\"ts\":" << event.StartMicros << ",\"dur\":"
+       << event.DurationMicros;
+    if (!event.Detail.empty()) {
+      os << ",\"args\":{\"detail\":";
+      writeJSONString(os, event.Detail);
+      os << "}";
+    }
+    os << "}";
+  }
+  os << "\n]}\n";
+}
@@ -35,6 +35,7 @@
 #include "swift/Parse/Lexer.h"
 #include "swift/Parse/Parser.h"
 #include "swift/Config.h"
+#include "swift/Strings.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Mangle.h"
 #include "clang/Basic/CharInfo.h"
@@ -47,6 +48,7 @@
 #include "clang/Frontend/Utils.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/ASTWriter.h"
+#include "clang/Serialization/Module.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Parse/Parser.h"
 #include "clang/Rewrite/Frontend/FrontendActions.h"
@@ -547,6 +549,11 @@ addCommonInvocationArguments(std::vector<std::string> &invocationArgStrs,
   invocationArgStrs.push_back(searchPathOpts.RuntimeLibraryImportPath);
 }
 
+/// Returns true if \p path names a precompiled header rather than a header.
+static bool isPCHFilenameExtension(StringRef path) {
+  return llvm::sys::path::extension(path).endswith(PCH_EXTENSION);
+}
+
 std::unique_ptr<ClangImporter>
 ClangImporter::create(ASTContext &ctx,
                       const ClangImporterOptions &importerOpts,
@@ -572,6 +579,13 @@ ClangImporter::create(ASTContext &ctx,
   }
   addCommonInvocationArguments(invocationArgStrs, ctx, importerOpts);
 
+  // A precompiled bridging header is loaded along with the rest of the
+  // translation unit, rather than parsed when it is imported.
+  if (isPCHFilenameExtension(importerOpts.BridgingHeader)) {
+    invocationArgStrs.push_back("-include-pch");
+    invocationArgStrs.push_back(importerOpts.BridgingHeader);
+  }
+
   if (importerOpts.DumpClangDiagnostics) {
     llvm::errs() << "clang '";
     interleave(invocationArgStrs,
@@ -820,6 +834,17 @@ void ClangImporter::Implementation::addEntryToLookupTable(
     table.addCategory(category);
   }
 
+  // Record how named enums are imported, so that clients of the module don't
+  // have to classify them again.
+  if (auto enumDecl = dyn_cast<clang::EnumDecl>(named)) {
+    if (enumDecl->hasNameForLinkage()) {
+      auto enumInfo = getEnumInfo(enumDecl, &clangSema.getPreprocessor());
+      table.addEnumInfo(getEnumInfoName(enumDecl),
+                        { static_cast<uint8_t>(enumInfo.getKind()),
+                          enumInfo.getConstantNamePrefix() });
+    }
+  }
+
   // Walk the members of any context that can have nested members.
   if (isa<clang::TagDecl>(named) ||
       isa<clang::ObjCInterfaceDecl>(named) ||
@@ -1003,6 +1028,33 @@ bool ClangImporter::importHeader(StringRef header, Module *adapter,
 bool ClangImporter::importBridgingHeader(StringRef header, Module *adapter,
                                          SourceLoc diagLoc,
                                          bool trackParsedSymbols) {
+  if (isPCHFilenameExtension(header)) {
+    // The precompiled header was loaded when Clang was set up, and is only
+    // useful if it carries the lookup table for its declarations.
+    if (!Impl.BridgingHeaderPCH) {
+      Impl.SwiftContext.Diags.diagnose(diagLoc, diag::bridging_header_error,
+                                       header);
+      return true;
+    }
+
+    addDependency(header);
+    Impl.ImportedHeaderOwners.push_back(adapter);
+
+    // Re-export the modules the header imported, as if it had just been
+    // parsed.
+    HeaderImportCallbacks callbacks(*this, Impl);
+    auto &headerSearch = Impl.getClangPreprocessor().getHeaderSearchInfo();
+    for (auto *importedFile : Impl.BridgingHeaderPCH->Imports) {
+      if (importedFile->ModuleName.empty())
+        continue;
+      callbacks.handleImport(headerSearch.lookupModule(
+                               importedFile->ModuleName));
+    }
+
+    Impl.bumpGeneration();
+    return false;
+  }
+
   clang::FileManager &fileManager = Impl.Instance->getFileManager();
   const clang::FileEntry *headerFile = fileManager.getFile(header,
                                                            /*open=*/true);
@@ -1072,6 +1124,44 @@ std::string ClangImporter::getBridgingHeaderContents(StringRef headerPath,
   return result;
 }
 
+bool ClangImporter::emitBridgingPCH(StringRef headerPath,
+                                    StringRef outputPCHPath) {
+  llvm::IntrusiveRefCntPtr<clang::CompilerInvocation> invocation{
+    new clang::CompilerInvocation(*Impl.Invocation)
+  };
+  invocation->getFrontendOpts().DisableFree = false;
+  invocation->getFrontendOpts().Inputs.clear();
+  invocation->getFrontendOpts().Inputs.push_back(
+      clang::FrontendInputFile(headerPath, clang::IK_ObjC));
+  invocation->getFrontendOpts().OutputFile = outputPCHPath;
+  invocation->getFrontendOpts().ProgramAction = clang::frontend::GeneratePCH;
+
+  invocation->getPreprocessorOpts().resetNonModularOptions();
+
+  // The Swift name lookup extension is carried over from the importer's own
+  // invocation, so the PCH gets a lookup table for the header's declarations.
+  clang::CompilerInstance emitInstance(
+    Impl.Instance->getPCHContainerOperations());
+  emitInstance.setInvocation(&*invocation);
+  emitInstance.createDiagnostics(&Impl.Instance->getDiagnosticClient(),
+                                 /*ShouldOwnClient=*/false);
+
+  clang::FileManager &fileManager = Impl.Instance->getFileManager();
+  emitInstance.setFileManager(&fileManager);
+  emitInstance.createSourceManager(fileManager);
+  emitInstance.setTarget(&Impl.Instance->getTarget());
+
+  clang::GeneratePCHAction action;
+  emitInstance.ExecuteAction(action);
+
+  if (emitInstance.getDiagnostics().hasErrorOccurred()) {
+    Impl.SwiftContext.Diags.diagnose({}, diag::bridging_header_pch_error,
+                                     outputPCHPath, headerPath);
+    return true;
+  }
+  return false;
+}
+
 void ClangImporter::collectSubModuleNames(
     ArrayRef<std::pair<Identifier, SourceLoc>> path,
     std::vector<std::string> &names) {
@@ -4459,6 +4549,24 @@ ClangImporter::Implementation::SwiftNameLookupExtension::createExtensionReader(
   assert(metadata.MajorVersion == SWIFT_LOOKUP_TABLE_VERSION_MAJOR);
   assert(metadata.MinorVersion == SWIFT_LOOKUP_TABLE_VERSION_MINOR);
 
+  // A precompiled bridging header has no module name. Its declarations are
+  // looked up through the bridging header's table, so back that instead.
+  if (mod.Kind == clang::serialization::MK_PCH) {
+    if (Impl.BridgingHeaderPCH) return nullptr;
+
+    auto onRemove = [this]() {
+      Impl.BridgingHeaderLookupTable.setPrecompiledReader(nullptr);
+      Impl.BridgingHeaderPCH = nullptr;
+    };
+    auto tableReader = SwiftLookupTableReader::create(this, reader, mod,
+                                                      onRemove, stream);
+    if (!tableReader) return nullptr;
+
+    Impl.BridgingHeaderLookupTable.setPrecompiledReader(tableReader.get());
+    Impl.BridgingHeaderPCH = &mod;
+    return std::move(tableReader);
+  }
+
   // Check whether we already have an entry in the set of lookup tables.
   auto &entry = Impl.LookupTables[mod.ModuleName];
   if (entry) return nullptr;
@@ -4719,5 +4827,6 @@ void ClangImporter::Implementation::dumpSwiftLookupTables() {
   }
 
   llvm::errs() << "<<Bridging header lookup table>>\n";
+  BridgingHeaderLookupTable.deserializeAll();
   BridgingHeaderLookupTable.dump();
 }
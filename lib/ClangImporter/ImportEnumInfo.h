@@ -78,6 +78,13 @@ public:
     determineConstantNamePrefix(ctx, decl);
   }
 
+  /// Reconstitute the classification of \p decl recorded in the Swift lookup
+  /// table of its module.
+  EnumInfo(const clang::EnumDecl *decl, EnumKind kind,
+           StringRef constantNamePrefix)
+      : kind(kind), constantNamePrefix(constantNamePrefix),
+        attribute(decl->getAttr<clang::NSErrorDomainAttr>()) {}
+
   EnumKind getKind() const { return kind; }
 
   StringRef getConstantNamePrefix() const { return constantNamePrefix; }
@@ -61,6 +61,10 @@ class ParmVarDecl;
 class Parser;
 class QualType;
 class TypedefNameDecl;
+
+namespace serialization {
+  class ModuleFile;
+}
 }
 
 namespace swift {
@@ -482,6 +486,13 @@ public:
   /// properties.
   llvm::DenseMap<const clang::FunctionDecl *, VarDecl *> FunctionsAsProperties;
 
+  /// Retrieve the name under which the given enum's information is recorded
+  /// within its module.
+  static StringRef getEnumInfoName(const clang::EnumDecl *decl) {
+    return decl->getDeclName() ? decl->getName()
+                               : decl->getTypedefNameForAnonDecl()->getName();
+  }
+
   /// Retrieve the key to use when looking for enum information.
   StringRef getEnumInfoKey(const clang::EnumDecl *decl,
                            SmallVectorImpl<char> &scratch) {
@@ -493,9 +504,7 @@ public:
     if (moduleName.empty())
       moduleName = decl->getASTContext().getLangOpts().CurrentModule;
 
-    StringRef enumName =
-      decl->getDeclName() ? decl->getName()
-                          : decl->getTypedefNameForAnonDecl()->getName();
+    StringRef enumName = getEnumInfoName(decl);
 
     if (moduleName.empty()) return enumName;
 
@@ -522,6 +531,20 @@ public:
     if (known != enumInfos.end())
       return known->second;
 
+    // If the enum's module was built with its classification recorded in the
+    // Swift lookup table, use that rather than recomputing it.
+    if (auto moduleOpt = getClangSubmoduleForDecl(decl)) {
+      if (auto table = findLookupTable(*moduleOpt)) {
+        if (auto stored = table->lookupEnumInfo(getEnumInfoName(decl))) {
+          importer::EnumInfo enumInfo(
+            decl, static_cast<importer::EnumKind>(stored->Kind),
+            stored->ConstantNamePrefix);
+          enumInfos[key] = enumInfo;
+          return enumInfo;
+        }
+      }
+    }
+
     importer::EnumInfo enumInfo(SwiftContext, decl, preprocessor);
     enumInfos[key] = enumInfo;
     return enumInfo;
@@ -604,6 +627,10 @@ public:
   /// The modules re-exported by imported headers.
   llvm::SmallVector<Module::ImportedModule, 8> ImportedHeaderExports;
 
+  /// The precompiled bridging header loaded when Clang was set up, if it
+  /// carries a Swift lookup table.
+  clang::serialization::ModuleFile *BridgingHeaderPCH = nullptr;
+
   /// The modules that requested imported headers.
   ///
   /// These are used to look up Swift classes forward-declared with \@class.
@@ -24,6 +24,7 @@
 #include "clang/Serialization/ASTWriter.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
@@ -33,6 +34,24 @@
 using namespace swift;
 using namespace llvm::support;
 
+#define DEBUG_TYPE "Swift lookup table"
+
+STATISTIC(NumBaseNamesAvailable,
+          "# of base names available in serialized lookup tables");
+STATISTIC(NumBaseNamesLoaded,
+          "# of base names loaded from serialized lookup tables");
+STATISTIC(NumGlobalsAsMembersContextsAvailable,
+          "# of globals-as-members contexts available in serialized lookup "
+          "tables");
+STATISTIC(NumGlobalsAsMembersContextsLoaded,
+          "# of globals-as-members contexts loaded from serialized lookup "
+          "tables");
+STATISTIC(NumEntitiesLoaded,
+          "# of declarations and macros resolved from serialized lookup "
+          "tables");
+STATISTIC(NumEnumInfosLoaded,
+          "# of enum classifications loaded from serialized lookup tables");
+
 /// Determine whether the new declarations matches an existing declaration.
 static bool matchesExistingDecl(clang::Decl *decl, clang::Decl *existingDecl) {
   // If the canonical declarations are equivalent, we have a match.
@@ -157,12 +176,36 @@ clang::NamedDecl *SwiftLookupTable::resolveContext(StringRef unresolvedName) {
 }
 
 void SwiftLookupTable::addCategory(clang::ObjCCategoryDecl *category) {
-  assert(!Reader && "Cannot modify a lookup table stored on disk");
+  // Load the categories of a precompiled header first, since they are only
+  // loaded when there are no others.
+  if (Reader)
+    (void)categories();
 
   // Add the category.
   Categories.push_back(category);
 }
 
+void SwiftLookupTable::addEnumInfo(StringRef enumName, StoredEnumInfo info) {
+  EnumInfos.insert({enumName, info});
+}
+
+llvm::Optional<SwiftLookupTable::StoredEnumInfo>
+SwiftLookupTable::lookupEnumInfo(StringRef enumName) {
+  auto known = EnumInfos.find(enumName);
+  if (known != EnumInfos.end())
+    return known->second;
+
+  // Check the serialized table. Only hits are remembered, since a table
+  // without a reader is still being populated.
+  StoredEnumInfo info;
+  if (!Reader || !Reader->lookupEnumInfo(enumName, info))
+    return None;
+
+  ++NumEnumInfosLoaded;
+  EnumInfos.insert({enumName, info});
+  return info;
+}
+
 bool SwiftLookupTable::resolveUnresolvedEntries(
     SmallVectorImpl<SingleEntry> &unresolved) {
   // Common case: nothing left to resolve.
@@ -289,8 +332,6 @@ bool SwiftLookupTable::addLocalEntry(SingleEntry newEntry,
 
 void SwiftLookupTable::addEntry(DeclName name, SingleEntry newEntry,
                                 EffectiveClangContext effectiveContext) {
-  assert(!Reader && "Cannot modify a lookup table stored on disk");
-
   // Translate the context.
   auto contextOpt = translateContext(effectiveContext);
   if (!contextOpt) {
@@ -310,12 +351,20 @@ void SwiftLookupTable::addEntry(DeclName name, SingleEntry newEntry,
 
   // If this is a global imported as a member, record is as such.
   if (isGlobalAsMember(newEntry, context)) {
+    // Load any entries from a precompiled header first, so that they aren't
+    // hidden by the new one.
+    if (Reader)
+      (void)lookupGlobalsAsMembers(context);
     auto &entries = GlobalsAsMembers[context];
     (void)addLocalEntry(newEntry, entries);
   }
 
-  // Find the list of entries for this base name.
-  auto &entries = LookupTable[name.getBaseName().str()];
+  // Find the list of entries for this base name, again loading any from a
+  // precompiled header first.
+  StringRef baseName = name.getBaseName().str();
+  if (Reader)
+    (void)findOrCreate(baseName);
+  auto &entries = LookupTable[baseName];
   auto decl = newEntry.dyn_cast<clang::NamedDecl *>();
   auto macro = newEntry.dyn_cast<clang::MacroInfo *>();
   for (auto &entry : entries) {
@@ -352,7 +401,8 @@ auto SwiftLookupTable::findOrCreate(StringRef baseName)
 
   // Lookup this base name in the module file.
   SmallVector<FullTableEntry, 2> results;
-  (void)Reader->lookup(baseName, results);
+  if (Reader->lookup(baseName, results))
+    ++NumBaseNamesLoaded;
 
   // Add an entry to the table so we don't look again.
   known = LookupTable.insert({ std::move(baseName), std::move(results) }).first;
@@ -398,7 +448,8 @@ SwiftLookupTable::lookupGlobalsAsMembers(StoredContext context) {
 
     // Lookup this base name in the module extension file.
     SmallVector<uintptr_t, 2> results;
-    (void)Reader->lookupGlobalsAsMembers(context, results);
+    if (Reader->lookupGlobalsAsMembers(context, results))
+      ++NumGlobalsAsMembersContextsLoaded;
 
     // Add an entry to the table so we don't look again.
     known = GlobalsAsMembers.insert({ std::move(context),
@@ -464,13 +515,24 @@ SwiftLookupTable::lookup(StringRef baseName,
 
 SmallVector<StringRef, 4> SwiftLookupTable::allBaseNames() {
   // If we have a reader, enumerate its base names.
-  if (Reader) return Reader->getBaseNames();
-
-  // Otherwise, walk the lookup table.
   SmallVector<StringRef, 4> result;
+  if (Reader) {
+    result = Reader->getBaseNames();
+
+    // A module's table is complete on disk. A precompiled header's may have
+    // had entries added since.
+    if (LookupTable.empty()) return result;
+  }
+
+  // Walk the lookup table.
   for (const auto &entry : LookupTable) {
     result.push_back(entry.first);
   }
+
+  if (Reader) {
+    llvm::array_pod_sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+  }
   return result;
 }
 
@@ -716,7 +778,11 @@ namespace {
 
     /// Record that contains the mapping from contexts to the list of
     /// globals that will be injected as members into those contexts.
-    GLOBALS_AS_MEMBERS_RECORD_ID
+    GLOBALS_AS_MEMBERS_RECORD_ID,
+
+    /// Record that contains the mapping from enumeration names to how
+    /// those enumerations are imported.
+    ENUM_INFOS_RECORD_ID
   };
 
   using BaseNameToEntitiesTableRecordLayout
@@ -728,6 +794,9 @@ namespace {
   using GlobalsAsMembersTableRecordLayout
     = BCRecordLayout<GLOBALS_AS_MEMBERS_RECORD_ID, BCVBR<16>, BCBlob>;
 
+  using EnumInfosTableRecordLayout
+    = BCRecordLayout<ENUM_INFOS_RECORD_ID, BCVBR<16>, BCBlob>;
+
   /// Trait used to write the on-disk hash table for the base name -> entities
   /// mapping.
   class BaseNameToEntitiesTableWriterInfo {
@@ -891,6 +960,50 @@ namespace {
       }
     }
   };
+
+  /// Trait used to write the on-disk hash table for the enumeration name ->
+  /// enum info mapping.
+  class EnumInfosTableWriterInfo {
+  public:
+    using key_type = StringRef;
+    using key_type_ref = key_type;
+    using data_type = SwiftLookupTable::StoredEnumInfo;
+    using data_type_ref = const data_type &;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      return llvm::HashString(key);
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      // The length of the key.
+      uint32_t keyLength = key.size();
+
+      // Kind, then the length and text of the constant name prefix.
+      uint32_t dataLength = 1 + sizeof(uint16_t) +
+                            data.ConstantNamePrefix.size();
+
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint16_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      out << key;
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      endian::Writer<little> writer(out);
+      writer.write<uint8_t>(data.Kind);
+      writer.write<uint16_t>(data.ConstantNamePrefix.size());
+      out << data.ConstantNamePrefix;
+    }
+  };
 }
 
 void SwiftLookupTableWriter::writeExtensionContents(
@@ -970,6 +1083,34 @@ void SwiftLookupTableWriter::writeExtensionContents(
     GlobalsAsMembersTableRecordLayout layout(stream);
     layout.emit(ScratchRecord, tableOffset, hashTableBlob);
   }
+
+  // Write the enum infos table, if non-empty.
+  if (!table.EnumInfos.empty()) {
+    // Sort the keys.
+    SmallVector<StringRef, 4> enumNames;
+    for (const auto &entry : table.EnumInfos)
+      enumNames.push_back(entry.first);
+    llvm::array_pod_sort(enumNames.begin(), enumNames.end());
+
+    // Create the on-disk hash table.
+    llvm::SmallString<4096> hashTableBlob;
+    uint32_t tableOffset;
+    {
+      llvm::OnDiskChainedHashTableGenerator<EnumInfosTableWriterInfo>
+        generator;
+      EnumInfosTableWriterInfo info;
+      for (auto enumName : enumNames)
+        generator.insert(enumName, table.EnumInfos[enumName], info);
+
+      llvm::raw_svector_ostream blobStream(hashTableBlob);
+      // Make sure that no bucket is at offset 0
+      endian::Writer<little>(blobStream).write<uint32_t>(0);
+      tableOffset = generator.Emit(blobStream, info);
+    }
+
+    EnumInfosTableRecordLayout layout(stream);
+    layout.emit(ScratchRecord, tableOffset, hashTableBlob);
+  }
 }
 
 namespace {
@@ -1101,6 +1242,53 @@ namespace {
       return result;
     }
   };
+
+  /// Used to deserialize the on-disk enumeration name -> enum info table.
+  class EnumInfosTableReaderInfo {
+  public:
+    using internal_key_type = StringRef;
+    using external_key_type = internal_key_type;
+    using data_type = SwiftLookupTable::StoredEnumInfo;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    internal_key_type GetInternalKey(external_key_type key) {
+      return key;
+    }
+
+    external_key_type GetExternalKey(internal_key_type key) {
+      return key;
+    }
+
+    hash_value_type ComputeHash(internal_key_type key) {
+      return llvm::HashString(key);
+    }
+
+    static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+      return lhs == rhs;
+    }
+
+    static std::pair<unsigned, unsigned>
+    ReadKeyDataLength(const uint8_t *&data) {
+      unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+      unsigned dataLength = endian::readNext<uint16_t, little, unaligned>(data);
+      return { keyLength, dataLength };
+    }
+
+    static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+      return StringRef((const char *)data, length);
+    }
+
+    static data_type ReadData(internal_key_type key, const uint8_t *data,
+                              unsigned length) {
+      data_type result;
+      result.Kind = endian::readNext<uint8_t, little, unaligned>(data);
+      unsigned prefixLength =
+        endian::readNext<uint16_t, little, unaligned>(data);
+      result.ConstantNamePrefix = StringRef((const char *)data, prefixLength);
+      return result;
+    }
+  };
 }
 
 namespace swift {
@@ -1109,6 +1297,9 @@ namespace swift {
 
   using SerializedGlobalsAsMembersTable =
     llvm::OnDiskIterableChainedHashTable<GlobalsAsMembersTableReaderInfo>;
+
+  using SerializedEnumInfosTable =
+    llvm::OnDiskIterableChainedHashTable<EnumInfosTableReaderInfo>;
 }
 
 clang::NamedDecl *SwiftLookupTable::mapStoredDecl(uintptr_t &entry) {
@@ -1126,6 +1317,8 @@ clang::NamedDecl *SwiftLookupTable::mapStoredDecl(uintptr_t &entry) {
                 Reader->getASTReader().GetLocalDecl(Reader->getModuleFile(),
                                                     declID));
 
+  ++NumEntitiesLoaded;
+
   // Update the entry now that we've resolved the declaration.
   entry = encodeEntry(decl);
   return decl;
@@ -1148,6 +1341,8 @@ clang::MacroInfo *SwiftLookupTable::mapStoredMacro(uintptr_t &entry) {
                     Reader->getModuleFile(),
                     macroID)));
 
+  ++NumEntitiesLoaded;
+
   // Update the entry now that we've resolved the macro.
   entry = encodeEntry(macro);
   return macro;
@@ -1164,6 +1359,7 @@ SwiftLookupTableReader::~SwiftLookupTableReader() {
   OnRemove();
   delete static_cast<SerializedBaseNameToEntitiesTable *>(SerializedTable);
   delete static_cast<SerializedGlobalsAsMembersTable *>(GlobalsAsMembersTable);
+  delete static_cast<SerializedEnumInfosTable *>(EnumInfoTable);
 }
 
 std::unique_ptr<SwiftLookupTableReader>
@@ -1179,6 +1375,7 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
   auto next = cursor.advance();
   std::unique_ptr<SerializedBaseNameToEntitiesTable> serializedTable;
   std::unique_ptr<SerializedGlobalsAsMembersTable> globalsAsMembersTable;
+  std::unique_ptr<SerializedEnumInfosTable> enumInfosTable;
   ArrayRef<clang::serialization::DeclID> categories;
   while (next.Kind != llvm::BitstreamEntry::EndBlock) {
     if (next.Kind == llvm::BitstreamEntry::Error)
@@ -1242,6 +1439,22 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
       break;
     }
 
+    case ENUM_INFOS_RECORD_ID: {
+      // Already saw enum infos table.
+      if (enumInfosTable)
+        return nullptr;
+
+      uint32_t tableOffset;
+      EnumInfosTableRecordLayout::readRecord(scratch, tableOffset);
+      auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+      enumInfosTable.reset(
+        SerializedEnumInfosTable::Create(base + tableOffset,
+                                         base + sizeof(uint32_t),
+                                         base));
+      break;
+    }
+
     default:
       // Unknown record, possibly for use by a future version of the
       // module format.
@@ -1253,11 +1466,17 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
 
   if (!serializedTable) return nullptr;
 
+  NumBaseNamesAvailable += serializedTable->getNumEntries();
+  if (globalsAsMembersTable)
+    NumGlobalsAsMembersContextsAvailable +=
+      globalsAsMembersTable->getNumEntries();
+
   // Create the reader.
   return std::unique_ptr<SwiftLookupTableReader>(
            new SwiftLookupTableReader(extension, reader, moduleFile, onRemove,
                                       serializedTable.release(), categories,
-                                      globalsAsMembersTable.release()));
+                                      globalsAsMembersTable.release(),
+                                      enumInfosTable.release()));
 
 }
 
@@ -1313,3 +1532,17 @@ bool SwiftLookupTableReader::lookupGlobalsAsMembers(
   entries = std::move(*known);
   return true;
 }
+
+bool SwiftLookupTableReader::lookupEnumInfo(
+       StringRef enumName,
+       SwiftLookupTable::StoredEnumInfo &info) {
+  auto table = static_cast<SerializedEnumInfosTable*>(EnumInfoTable);
+  if (!table) return false;
+
+  // Look for an entry with this enumeration name.
+  auto known = table->find(enumName);
+  if (known == table->end()) return false;
+
+  info = *known;
+  return true;
+}
@@ -146,7 +146,7 @@ const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MAJOR = 1;
 /// Lookup table minor version number.
 ///
 /// When the format changes IN ANY WAY, this number should be incremented.
-const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MINOR = 14; // Swift 2 names
+const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MINOR = 15; // enum infos
 
 /// A lookup table that maps Swift names to the set of Clang
 /// declarations with that particular name.
@@ -278,6 +278,21 @@ private:
   /// FullTableEntry::DeclsOrMacros.
   llvm::DenseMap<StoredContext, SmallVector<uintptr_t, 2>> GlobalsAsMembers;
 
+public:
+  /// How a named C enumeration is imported, as computed when the table
+  /// was built.
+  struct StoredEnumInfo {
+    /// The importer::EnumKind of the enumeration.
+    uint8_t Kind;
+
+    /// The prefix stripped from the names of the enumeration's constants.
+    StringRef ConstantNamePrefix;
+  };
+
+private:
+  /// A mapping from the names of C enumerations to how they are imported.
+  llvm::DenseMap<StringRef, StoredEnumInfo> EnumInfos;
+
   /// The reader responsible for lazily loading the contents of this table.
   SwiftLookupTableReader *Reader;
 
@@ -302,6 +317,18 @@ private:
 public:
   explicit SwiftLookupTable(SwiftLookupTableReader *reader) : Reader(reader) { }
 
+  /// Back this table with the serialized table of a precompiled header, so
+  /// that its entries are loaded lazily alongside any added afterwards.
+  ///
+  /// Unlike the tables of modules, a table with a precompiled reader can
+  /// still be modified, since headers parsed later add to it. Pass null
+  /// to detach the reader when it goes away.
+  void setPrecompiledReader(SwiftLookupTableReader *reader) {
+    assert((!reader || LookupTable.empty()) &&
+           "Reader must be attached before adding entries");
+    Reader = reader;
+  }
+
   /// Maps a stored declaration entry to an actual Clang declaration.
   clang::NamedDecl *mapStoredDecl(uintptr_t &entry);
 
@@ -329,6 +356,13 @@ public:
   /// Add an Objective-C category or extension to the table.
   void addCategory(clang::ObjCCategoryDecl *category);
 
+  /// Record how the C enumeration with the given name is imported.
+  void addEnumInfo(StringRef enumName, StoredEnumInfo info);
+
+  /// Retrieve how the C enumeration with the given name is imported, if
+  /// that was recorded in this table.
+  llvm::Optional<StoredEnumInfo> lookupEnumInfo(StringRef enumName);
+
   /// Resolve any unresolved entries.
   ///
   /// \param unresolved Will be populated with the list of entries
@@ -422,6 +456,7 @@ class SwiftLookupTableReader : public clang::ModuleFileExtensionReader {
   void *SerializedTable;
   ArrayRef<clang::serialization::DeclID> Categories;
   void *GlobalsAsMembersTable;
+  void *EnumInfoTable;
 
   SwiftLookupTableReader(clang::ModuleFileExtension *extension,
                          clang::ASTReader &reader,
@@ -429,11 +464,13 @@ class SwiftLookupTableReader : public clang::ModuleFileExtensionReader {
                          std::function<void()> onRemove,
                          void *serializedTable,
                          ArrayRef<clang::serialization::DeclID> categories,
-                         void *globalsAsMembersTable)
+                         void *globalsAsMembersTable,
+                         void *enumInfoTable)
     : ModuleFileExtensionReader(extension), Reader(reader),
       ModuleFile(moduleFile), OnRemove(onRemove),
       SerializedTable(serializedTable), Categories(categories),
-      GlobalsAsMembersTable(globalsAsMembersTable) { }
+      GlobalsAsMembersTable(globalsAsMembersTable),
+      EnumInfoTable(enumInfoTable) { }
 
 public:
   /// Create a new lookup table reader for the given AST reader and stream
@@ -476,6 +513,12 @@ public:
   /// \returns true if we found anything, false otherwise.
   bool lookupGlobalsAsMembers(SwiftLookupTable::StoredContext context,
                               SmallVectorImpl<uintptr_t> &entries);
+
+  /// Retrieve how the C enumeration with the given name is imported.
+  ///
+  /// \returns true if we found it, false otherwise.
+  bool lookupEnumInfo(StringRef enumName,
+                      SwiftLookupTable::StoredEnumInfo &info);
 };
 
 }
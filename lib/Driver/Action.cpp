@@ -20,7 +20,11 @@ using namespace llvm::opt;
 
 JobAction::~JobAction() {
   if (getOwnsInputs()) {
-    llvm::DeleteContainerPointers(Inputs);
+    // A precompiled bridging header is shared by many compile actions, none
+    // of which owns it.
+    for (Action *Input : Inputs)
+      if (!isa<GeneratePCHJobAction>(Input))
+        delete Input;
   }
 }
 
@@ -36,6 +40,7 @@ const char *Action::getClassName(ActionClass AC) {
     case REPLJob: return "repl";
     case LinkJob: return "link";
     case GenerateDSYMJob: return "generate-dSYM";
+    case GeneratePCHJob: return "generate-pch";
   }
 
   llvm_unreachable("invalid class");
@@ -62,3 +67,5 @@ void REPLJobAction::anchor() {}
 void LinkJobAction::anchor() {}
 
 void GenerateDSYMJobAction::anchor() {}
+
+void GeneratePCHJobAction::anchor() {}
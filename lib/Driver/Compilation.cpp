@@ -15,6 +15,7 @@
 #include "swift/AST/DiagnosticEngine.h"
 #include "swift/AST/DiagnosticsDriver.h"
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/ModuleLocationMap.h"
 #include "swift/Basic/Program.h"
 #include "swift/Basic/TaskQueue.h"
 #include "swift/Basic/Version.h"
@@ -23,7 +24,10 @@
 #include "swift/Driver/DependencyGraph.h"
 #include "swift/Driver/Driver.h"
 #include "swift/Driver/Job.h"
+#include "swift/Driver/OutputCache.h"
 #include "swift/Driver/ParseableOutput.h"
+#include "swift/Driver/ToolChain.h"
+#include "swift/Option/Options.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/StringExtras.h"
@@ -31,6 +35,7 @@
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/YAMLParser.h"
@@ -83,11 +88,43 @@ namespace {
     ///
     /// Only intended for source files.
     llvm::SmallDenseMap<const Job *, bool, 16> UnfinishedCommands;
+
+    /// In batch mode, the compile jobs which are ready to run but haven't
+    /// been combined into batches yet.
+    SmallVector<const Job *, 16> PendingBatchableCommands;
+
+    /// The batch jobs that have been created, with the jobs they stand for.
+    llvm::SmallDenseMap<const Job *, SmallVector<const Job *, 4>, 4>
+        BatchedCommands;
+    SmallVector<std::unique_ptr<Job>, 4> BatchJobs;
+
+    /// The jobs which are ready to run but haven't been handed to the
+    /// TaskQueue yet, so that the slowest can be started first.
+    SmallVector<const Job *, 16> PendingCommands;
+
+    /// When each running task was started.
+    llvm::SmallDenseMap<const Job *, llvm::sys::TimeValue, 16> TaskStartTimes;
+
+    /// The total time spent running tasks, added up across all parallel
+    /// commands.
+    llvm::sys::TimeValue BusyTime = llvm::sys::TimeValue::ZeroTime();
+
+    /// How long each input took to compile in this build, keyed by input
+    /// path.
+    llvm::StringMap<llvm::sys::TimeValue> CompileTimes;
+
+    /// The jobs whose outputs have been restored from the output cache but
+    /// which haven't been marked finished yet, with what they printed.
+    SmallVector<std::pair<const Job *, std::string>, 4> CachedCommands;
   };
 }
 
 Compilation::~Compilation() = default;
 
+void Compilation::setOutputCache(std::unique_ptr<OutputCache> cache) {
+  Cache = std::move(cache);
+}
+
 Job *Compilation::addJob(std::unique_ptr<Job> J) {
   Job *result = J.get();
   Jobs.emplace_back(std::move(J));
@@ -110,7 +147,9 @@ static void populateInputInfoMap(InputInfoMap &inputs,
                                  const PerformJobsState &endState) {
   for (auto &entry : endState.UnfinishedCommands) {
     for (auto *action : entry.first->getSource().getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry.first->getInputModTime();
@@ -127,7 +166,9 @@ static void populateInputInfoMap(InputInfoMap &inputs,
       continue;
 
     for (auto *action : compileAction->getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry->getInputModTime();
@@ -172,9 +213,15 @@ static void checkForOutOfDateInputs(DiagnosticEngine &diags,
   }
 }
 
-static void writeCompilationRecord(StringRef path, StringRef argsHash,
-                                   llvm::sys::TimeValue buildTime,
-                                   const InputInfoMap &inputs) {
+static double toSeconds(llvm::sys::TimeValue time) {
+  return time.seconds() + time.nanoseconds() / 1e9;
+}
+
+static void writeCompilationRecord(
+    StringRef path, StringRef argsHash, llvm::sys::TimeValue buildTime,
+    const InputInfoMap &inputs,
+    const llvm::StringMap<llvm::sys::TimeValue> &compileTimes,
+    const llvm::StringMap<std::string> &contentHashes) {
   std::error_code error;
   llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
   if (out.has_error()) {
@@ -213,6 +260,29 @@ static void writeCompilationRecord(StringRef path, StringRef argsHash,
     writeTimeValue(out, entry.second.previousModTime);
     out << "\n";
   }
+
+  // Compile times are written in microseconds.
+  out << "compile_times:\n";
+  for (auto &entry : inputs) {
+    auto time = compileTimes.find(entry.first->getValue());
+    if (time == compileTimes.end())
+      continue;
+    out << "  \"" << llvm::yaml::escape(entry.first->getValue()) << "\": "
+        << uint64_t(time->getValue().seconds()) * 1000000 +
+               time->getValue().nanoseconds() / 1000
+        << "\n";
+  }
+
+  // Each hash goes with the modification time written above, so that the next
+  // build only needs to read the files whose times have changed.
+  out << "content_hashes:\n";
+  for (auto &entry : inputs) {
+    auto hash = contentHashes.find(entry.first->getValue());
+    if (hash == contentHashes.end())
+      continue;
+    out << "  \"" << llvm::yaml::escape(entry.first->getValue()) << "\": \""
+        << hash->getValue() << "\"\n";
+  }
 }
 
 static bool writeFilelistIfNecessary(const Job *job, DiagnosticEngine &diags) {
@@ -259,6 +329,7 @@ int Compilation::performJobsImpl() {
     TQ.reset(new DummyTaskQueue(NumberOfParallelCommands));
   else
     TQ.reset(new TaskQueue(NumberOfParallelCommands));
+  TQ->setServesJobs(ServeJobs);
 
   PerformJobsState State;
 
@@ -272,6 +343,10 @@ int Compilation::performJobsImpl() {
   if (ShowIncrementalBuildDecisions)
     IncrementalTracer = &ActualIncrementalTracer;
 
+  auto printJobName = [](raw_ostream &out, const Job *base) {
+    out << llvm::sys::path::filename(base->getOutput().getBaseInput(0));
+  };
+
   auto noteBuilding = [&] (const Job *cmd, StringRef reason) {
     if (!ShowIncrementalBuildDecisions)
       return;
@@ -280,10 +355,7 @@ int Compilation::performJobsImpl() {
     llvm::outs() << "Queuing "
                  << llvm::sys::path::filename(cmd->getOutput().getBaseInput(0))
                  << " " << reason << "\n";
-    IncrementalTracer->printPath(llvm::outs(), cmd,
-                                 [](raw_ostream &out, const Job *base) {
-      out << llvm::sys::path::filename(base->getOutput().getBaseInput(0));
-    });
+    IncrementalTracer->printPath(llvm::outs(), cmd, printJobName);
   };
 
   // Set up scheduleCommandIfNecessaryAndPossible.
@@ -307,8 +379,110 @@ int Compilation::performJobsImpl() {
     assert(Cmd->getExtraEnvironment().empty() &&
            "not implemented for compilations with multiple jobs");
     State.ScheduledCommands.insert(Cmd);
-    TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
-                (void *)Cmd);
+    if (getBatchModeEnabled() && ToolChain::jobIsBatchable(*Cmd)) {
+      State.PendingBatchableCommands.push_back(Cmd);
+      return;
+    }
+    State.PendingCommands.push_back(Cmd);
+  };
+
+  // Compile jobs are expected to take as long as they did in the last build.
+  // Jobs we know nothing about are assumed to take the average time.
+  double AverageCompileTime = 0;
+  if (!PreviousCompileTimes.empty()) {
+    for (auto &entry : PreviousCompileTimes)
+      AverageCompileTime += toSeconds(entry.getValue());
+    AverageCompileTime /= PreviousCompileTimes.size();
+  }
+  auto getExpectedDuration = [&] (const Job *Cmd) -> double {
+    if (isa<CompileJobAction>(Cmd->getSource())) {
+      auto Found =
+          PreviousCompileTimes.find(Cmd->getOutput().getBaseInput(0));
+      if (Found != PreviousCompileTimes.end())
+        return toSeconds(Found->getValue());
+    }
+    return AverageCompileTime;
+  };
+
+  // Hand the jobs which are ready to run to the TaskQueue, slowest first.
+  // The TaskQueue starts tasks in the order it gets them, and a slow file
+  // started last holds up everything that waits for all of them, such as
+  // merge-module and linking.
+  //
+  // In batch mode, the compile jobs are first split into as many batches as
+  // there are commands allowed to run in parallel, keeping neighbouring
+  // files together.
+  //
+  // Jobs whose outputs can be restored from the output cache aren't run at
+  // all.
+  auto startPendingCommands = [&] {
+    if (Cache) {
+      auto restoreFromCache = [&](SmallVectorImpl<const Job *> &Cmds) {
+        Cmds.erase(std::remove_if(Cmds.begin(), Cmds.end(),
+                                  [&](const Job *Cmd) -> bool {
+          if (!OutputCache::isCacheable(*Cmd))
+            return false;
+          std::string Output;
+          if (!Cache->restore(*this, *Cmd, Output))
+            return false;
+          State.CachedCommands.push_back({Cmd, std::move(Output)});
+          return true;
+        }), Cmds.end());
+      };
+      restoreFromCache(State.PendingCommands);
+      restoreFromCache(State.PendingBatchableCommands);
+    }
+
+    SmallVector<std::pair<double, const Job *>, 16> Tasks;
+    for (const Job *Cmd : State.PendingCommands)
+      Tasks.push_back({getExpectedDuration(Cmd), Cmd});
+    State.PendingCommands.clear();
+
+    auto &Pending = State.PendingBatchableCommands;
+    size_t NumBatches = std::min<size_t>(
+        std::max(NumberOfParallelCommands, 1U), Pending.size());
+    size_t Begin = 0;
+    for (size_t i = 0; i != NumBatches; ++i) {
+      size_t End = Begin + (Pending.size() - Begin) / (NumBatches - i);
+      ArrayRef<const Job *> Batch =
+          llvm::makeArrayRef(Pending).slice(Begin, End - Begin);
+      Begin = End;
+
+      double Duration = 0;
+      for (const Job *Cmd : Batch)
+        Duration += getExpectedDuration(Cmd);
+
+      if (Batch.size() == 1) {
+        Tasks.push_back({Duration, Batch[0]});
+        continue;
+      }
+
+      std::unique_ptr<Job> BatchJob = ToolChain::constructBatchJob(Batch);
+      const Job *BatchCmd = BatchJob.get();
+      State.BatchedCommands[BatchCmd].append(Batch.begin(), Batch.end());
+      State.BatchJobs.push_back(std::move(BatchJob));
+      Tasks.push_back({Duration, BatchCmd});
+    }
+    Pending.clear();
+
+    std::stable_sort(Tasks.begin(), Tasks.end(),
+                     [](const std::pair<double, const Job *> &lhs,
+                        const std::pair<double, const Job *> &rhs) {
+      return lhs.first > rhs.first;
+    });
+    for (auto &Task : Tasks) {
+      TQ->addTask(Task.second->getExecutable(), Task.second->getArguments(),
+                  llvm::None, (void *)Task.second);
+    }
+  };
+
+  // Returns the jobs that a task stands for: the jobs of a batch, or just
+  // the task's own job.
+  auto getCombinedJobs = [&] (const Job *const &Cmd) -> ArrayRef<const Job *> {
+    auto Found = State.BatchedCommands.find(Cmd);
+    if (Found != State.BatchedCommands.end())
+      return Found->second;
+    return Cmd;
   };
 
   // When a task finishes, we need to reevaluate the other commands that
@@ -425,60 +599,22 @@ int Compilation::performJobsImpl() {
   // Set up a callback which will be called immediately after a task has
   // started. This callback may be used to provide output indicating that the
   // task began.
-  auto taskBegan = [this] (ProcessId Pid, void *Context) {
+  auto taskBegan = [&] (ProcessId Pid, void *Context) {
     // TODO: properly handle task began.
     const Job *BeganCmd = (const Job *)Context;
+    State.TaskStartTimes[BeganCmd] = llvm::sys::TimeValue::now();
 
     // For verbose output, print out each command as it begins execution.
     if (Level == OutputLevel::Verbose)
       BeganCmd->printCommandLine(llvm::errs());
     else if (Level == OutputLevel::Parseable)
-      parseable_output::emitBeganMessage(llvm::errs(), *BeganCmd, Pid);
+      for (const Job *Cmd : getCombinedJobs(BeganCmd))
+        parseable_output::emitBeganMessage(llvm::errs(), *Cmd, Pid);
   };
 
-  // Set up a callback which will be called immediately after a task has
-  // finished execution. This callback should determine if execution should
-  // continue (if execution should stop, this callback should return true), and
-  // it should also schedule any additional commands which we now know need
-  // to run.
-  auto taskFinished = [&] (ProcessId Pid, int ReturnCode, StringRef Output,
-                           void *Context) -> TaskFinishedResponse {
-    const Job *FinishedCmd = (const Job *)Context;
-
-    if (Level == OutputLevel::Parseable) {
-      // Parseable output was requested.
-      parseable_output::emitFinishedMessage(llvm::errs(), *FinishedCmd, Pid,
-                                            ReturnCode, Output);
-    } else {
-      // Otherwise, send the buffered output to stderr, though only if we
-      // support getting buffered output.
-      if (TaskQueue::supportsBufferingOutput())
-        llvm::errs() << Output;
-    }
-
-    if (ReturnCode != EXIT_SUCCESS) {
-      // The task failed, so return true without performing any further
-      // dependency analysis.
-
-      // Store this task's ReturnCode as our Result if we haven't stored
-      // anything yet.
-      if (Result == EXIT_SUCCESS)
-        Result = ReturnCode;
-
-      if (!isa<CompileJobAction>(FinishedCmd->getSource()) ||
-          ReturnCode != EXIT_FAILURE) {
-        Diags.diagnose(SourceLoc(), diag::error_command_failed,
-                       FinishedCmd->getSource().getClassName(),
-                       ReturnCode);
-      }
-
-      return ContinueBuildingAfterErrors ?
-          TaskFinishedResponse::ContinueExecution :
-          TaskFinishedResponse::StopExecution;
-    }
-
-    // When a task finishes, we need to reevaluate the other commands that
-    // might have been blocked.
+  // When a job succeeds, we need to reevaluate the other commands that
+  // might have been blocked.
+  auto jobSucceeded = [&] (const Job *FinishedCmd) {
     markFinished(FinishedCmd);
 
     // In order to handle both old dependencies that have disappeared and new
@@ -504,7 +640,11 @@ int Compilation::performJobsImpl() {
             break;
           SWIFT_FALLTHROUGH;
         case DependencyGraphImpl::LoadResult::AffectsDownstream:
-          DepGraph.markTransitive(Dependents, FinishedCmd);
+          DepGraph.markTransitive(Dependents, FinishedCmd, IncrementalTracer);
+          if (ShowIncrementalBuildDecisions) {
+            IncrementalTracer->printUnchanged(llvm::outs(), FinishedCmd,
+                                              printJobName);
+          }
           break;
         }
 
@@ -515,18 +655,142 @@ int Compilation::performJobsImpl() {
         }
       }
     }
+  };
 
+  // Handles the end of one job, which may be one of several that a batch
+  // task did. Returns whether execution should continue.
+  auto jobFinished = [&] (const Job *FinishedCmd, ProcessId Pid,
+                          int ReturnCode, StringRef Output,
+                          const TaskResourceUsage &Usage)
+      -> TaskFinishedResponse {
+    if (Level == OutputLevel::Parseable) {
+      // Parseable output was requested.
+      parseable_output::emitFinishedMessage(llvm::errs(), *FinishedCmd, Pid,
+                                            ReturnCode, Output, Usage);
+    } else {
+      // Otherwise, send the buffered output to stderr, though only if we
+      // support getting buffered output.
+      if (TaskQueue::supportsBufferingOutput())
+        llvm::errs() << Output;
+    }
+
+    if (ReturnCode != EXIT_SUCCESS) {
+      // The task failed, so return true without performing any further
+      // dependency analysis.
+
+      // Store this task's ReturnCode as our Result if we haven't stored
+      // anything yet.
+      if (Result == EXIT_SUCCESS)
+        Result = ReturnCode;
+
+      if (!isa<CompileJobAction>(FinishedCmd->getSource()) ||
+          ReturnCode != EXIT_FAILURE) {
+        Diags.diagnose(SourceLoc(), diag::error_command_failed,
+                       FinishedCmd->getSource().getClassName(),
+                       ReturnCode);
+      }
+
+      return ContinueBuildingAfterErrors ?
+          TaskFinishedResponse::ContinueExecution :
+          TaskFinishedResponse::StopExecution;
+    }
+
+    jobSucceeded(FinishedCmd);
     return TaskFinishedResponse::ContinueExecution;
   };
 
+  // Restores the jobs whose outputs came from the output cache as if they
+  // had just been run, then starts whatever that makes ready, which may
+  // itself be cached.
+  auto startOrRestorePendingCommands = [&] {
+    while (true) {
+      startPendingCommands();
+      if (State.CachedCommands.empty())
+        break;
+
+      auto Cached = std::move(State.CachedCommands);
+      State.CachedCommands.clear();
+      for (auto &Entry : Cached) {
+        if (Level == OutputLevel::Parseable)
+          parseable_output::emitCachedMessage(llvm::errs(), *Entry.first,
+                                              Entry.second);
+        else
+          llvm::errs() << Entry.second;
+        jobSucceeded(Entry.first);
+      }
+    }
+  };
+
+  // Set up a callback which will be called immediately after a task has
+  // finished execution. This callback should determine if execution should
+  // continue (if execution should stop, this callback should return true), and
+  // it should also schedule any additional commands which we now know need
+  // to run.
+  auto taskFinished = [&] (ProcessId Pid, int ReturnCode, StringRef Output,
+                           const TaskResourceUsage &Usage,
+                           void *Context) -> TaskFinishedResponse {
+    const Job *FinishedCmd = (const Job *)Context;
+    ArrayRef<const Job *> Combined = getCombinedJobs(FinishedCmd);
+
+    // Remember how long the task took. The jobs of a batch are taken to
+    // have shared the time equally.
+    auto StartTime = State.TaskStartTimes.find(FinishedCmd);
+    if (StartTime != State.TaskStartTimes.end()) {
+      llvm::sys::TimeValue Duration =
+          llvm::sys::TimeValue::now() - StartTime->second;
+      State.TaskStartTimes.erase(StartTime);
+      State.BusyTime += Duration;
+
+      llvm::sys::TimeValue JobDuration(toSeconds(Duration) / Combined.size());
+      for (const Job *Cmd : Combined) {
+        if (ReturnCode == EXIT_SUCCESS &&
+            isa<CompileJobAction>(Cmd->getSource()))
+          State.CompileTimes[Cmd->getOutput().getBaseInput(0)] = JobDuration;
+      }
+    }
+
+    // Batches aren't cached, since their outputs are only known to match
+    // those of separate jobs as far as the tests go.
+    if (Cache && ReturnCode == EXIT_SUCCESS && Combined.size() == 1 &&
+        OutputCache::isCacheable(*FinishedCmd))
+      Cache->store(*this, *FinishedCmd, Output);
+
+    // The output and resource usage of a batch can't be told apart, so they
+    // all go with the first job.
+    TaskFinishedResponse Response = TaskFinishedResponse::ContinueExecution;
+    TaskResourceUsage JobUsage = Usage;
+    for (const Job *Cmd : Combined) {
+      if (jobFinished(Cmd, Pid, ReturnCode, Output, JobUsage) ==
+          TaskFinishedResponse::StopExecution)
+        Response = TaskFinishedResponse::StopExecution;
+      Output = StringRef();
+      JobUsage = TaskResourceUsage();
+    }
+
+    startOrRestorePendingCommands();
+    return Response;
+  };
+
   auto taskSignalled = [&] (ProcessId Pid, StringRef ErrorMsg, StringRef Output,
+                            const TaskResourceUsage &Usage,
                             void *Context) -> TaskFinishedResponse {
     const Job *SignalledCmd = (const Job *)Context;
 
+    auto StartTime = State.TaskStartTimes.find(SignalledCmd);
+    if (StartTime != State.TaskStartTimes.end()) {
+      State.BusyTime += llvm::sys::TimeValue::now() - StartTime->second;
+      State.TaskStartTimes.erase(StartTime);
+    }
+
     if (Level == OutputLevel::Parseable) {
       // Parseable output was requested.
-      parseable_output::emitSignalledMessage(llvm::errs(), *SignalledCmd, Pid,
-                                             ErrorMsg, Output);
+      TaskResourceUsage JobUsage = Usage;
+      for (const Job *Cmd : getCombinedJobs(SignalledCmd)) {
+        parseable_output::emitSignalledMessage(llvm::errs(), *Cmd, Pid,
+                                               ErrorMsg, Output, JobUsage);
+        Output = StringRef();
+        JobUsage = TaskResourceUsage();
+      }
     } else {
       // Otherwise, send the buffered output to stderr, though only if we
       // support getting buffered output.
@@ -547,6 +811,8 @@ int Compilation::performJobsImpl() {
     return TaskFinishedResponse::StopExecution;
   };
 
+  llvm::sys::TimeValue ExecutionStartTime = llvm::sys::TimeValue::now();
+  startOrRestorePendingCommands();
   do {
     // Ask the TaskQueue to execute.
     TQ->execute(taskBegan, taskFinished, taskSignalled);
@@ -562,6 +828,7 @@ int Compilation::performJobsImpl() {
       State.ScheduledCommands.insert(Cmd);
       markFinished(Cmd);
     }
+    startOrRestorePendingCommands();
 
     // ...which may allow us to go on and do later tasks.
   } while (Result == 0 && TQ->hasRemainingTasks());
@@ -591,12 +858,44 @@ int Compilation::performJobsImpl() {
     }
   }
 
+  if (Cache && Level == OutputLevel::Parseable)
+    parseable_output::emitOutputCacheMessage(llvm::errs(), Cache->Hits,
+                                             Cache->Misses);
+
+  if (ShowDriverTimeCompilation) {
+    double WallTime =
+        toSeconds(llvm::sys::TimeValue::now() - ExecutionStartTime);
+    double BusyTime = toSeconds(State.BusyTime);
+    unsigned Slots = std::max(NumberOfParallelCommands, 1U);
+    double IdleTime = std::max(Slots * WallTime - BusyTime, 0.0);
+    llvm::errs() << llvm::format("Ran jobs for %.3f seconds of wall time "
+                                 "with %u parallel commands\n",
+                                 WallTime, Slots)
+                 << llvm::format("  %.3f core-seconds busy, "
+                                 "%.3f core-seconds idle\n",
+                                 BusyTime, IdleTime);
+  }
+
   if (!CompilationRecordPath.empty() && !SkipTaskExecution) {
     InputInfoMap InputInfo;
     populateInputInfoMap(InputInfo, State);
     checkForOutOfDateInputs(Diags, InputInfo);
+
+    // Files that weren't rebuilt keep their times from the last build.
+    llvm::StringMap<llvm::sys::TimeValue> CompileTimes = PreviousCompileTimes;
+    for (auto &entry : State.CompileTimes)
+      CompileTimes[entry.getKey()] = entry.getValue();
+
+    llvm::StringMap<std::string> ContentHashes;
+    for (const Job *Cmd : getJobs()) {
+      if (isa<CompileJobAction>(Cmd->getSource()) &&
+          !Cmd->getInputContentHash().empty())
+        ContentHashes[Cmd->getOutput().getBaseInput(0)] =
+            Cmd->getInputContentHash();
+    }
+
     writeCompilationRecord(CompilationRecordPath, ArgsHash, BuildStartTime,
-                           InputInfo);
+                           InputInfo, CompileTimes, ContentHashes);
   }
 
   if (Result == 0)
@@ -657,15 +956,39 @@ static bool writeAllSourcesFile(DiagnosticEngine &diags, StringRef path,
   return true;
 }
 
+static bool writeModuleLocationMap(DiagnosticEngine &diags, StringRef path,
+                                   const llvm::opt::ArgList &args) {
+  ModuleLocationMap map;
+  for (const Arg *A : args.filtered(options::OPT_I, options::OPT_F))
+    map.addDirectory(A->getValue());
+
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+  if (out.has_error()) {
+    out.clear_error();
+    diags.diagnose(SourceLoc(), diag::error_unable_to_make_temporary_file,
+                   error.message());
+    return false;
+  }
+
+  map.write(out);
+  return true;
+}
+
 int Compilation::performJobs() {
   if (AllSourceFilesPath)
     if (!writeAllSourcesFile(Diags, AllSourceFilesPath, getInputFiles()))
       return EXIT_FAILURE;
 
+  // The frontends would otherwise each list every search path again.
+  if (ModuleLocationMapPath)
+    if (!writeModuleLocationMap(Diags, ModuleLocationMapPath, getArgs()))
+      return EXIT_FAILURE;
+
   // If we don't have to do any cleanup work, just exec the subprocess.
   if (Level < OutputLevel::Parseable &&
       (SaveTemps || TempFilePaths.empty()) &&
-      CompilationRecordPath.empty() &&
+      CompilationRecordPath.empty() && !Cache &&
       Jobs.size() == 1) {
     return performSingleCommand(Jobs.front().get());
   }
@@ -706,3 +1029,22 @@ const char *Compilation::getAllSourcesPath() const {
   }
   return AllSourceFilesPath;
 }
+
+const char *Compilation::getModuleLocationMapPath() const {
+  if (!ModuleLocationMapPath) {
+    SmallString<128> Buffer;
+    std::error_code EC =
+        llvm::sys::fs::createTemporaryFile("module-locations", "", Buffer);
+    if (EC) {
+      Diags.diagnose(SourceLoc(),
+                     diag::error_unable_to_make_temporary_file,
+                     EC.message());
+      // FIXME: This should not take down the entire process.
+      llvm::report_fatal_error("unable to create module location map");
+    }
+    auto *mutableThis = const_cast<Compilation *>(this);
+    mutableThis->addTemporaryFile(Buffer.str());
+    mutableThis->ModuleLocationMapPath = getArgs().MakeArgString(Buffer);
+  }
+  return ModuleLocationMapPath;
+}
@@ -12,6 +12,8 @@
 
 #include "swift/Driver/DependencyGraph.h"
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/ReferenceDependencies.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringSwitch.h"
@@ -48,15 +50,110 @@ using LoadResult = DependencyGraphImpl::LoadResult;
 using DependencyKind = DependencyGraphImpl::DependencyKind;
 using DependencyCallbackTy = LoadResult(StringRef, DependencyKind, bool);
 using InterfaceHashCallbackTy = LoadResult(StringRef);
+using FingerprintCallbackTy = LoadResult(StringRef, DependencyKind, StringRef);
 
+/// Reads the binary form of a dependencies file, which is what the frontend
+/// writes. The names are handed to the callbacks straight out of the buffer.
+static LoadResult
+parseBinaryDependencyFile(llvm::MemoryBuffer &buffer,
+                          llvm::function_ref<DependencyCallbackTy> providesCallback,
+                          llvm::function_ref<DependencyCallbackTy> dependsCallback,
+                          llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback,
+                          llvm::function_ref<FingerprintCallbackTy> fingerprintCallback) {
+  using reference_dependencies::Section;
+
+  LoadResult result = LoadResult::UpToDate;
+  // The "provides" entry that a fingerprint record would belong to.
+  StringRef lastProvidedName;
+  DependencyKind lastProvidedKind = DependencyKind();
+
+  bool wellFormed = reference_dependencies::readEntries(buffer.getBuffer(),
+      [&](Section section, StringRef name, bool isCascading) -> bool {
+    LoadResult update;
+    auto provides = [&](DependencyKind kind) -> LoadResult {
+      lastProvidedName = name;
+      lastProvidedKind = kind;
+      return providesCallback(name, kind, true);
+    };
+
+    switch (section) {
+    case Section::ProvidesTopLevel:
+      update = provides(DependencyKind::TopLevelName);
+      break;
+    case Section::ProvidesNominal:
+      update = provides(DependencyKind::NominalType);
+      break;
+    case Section::ProvidesMember:
+      update = provides(DependencyKind::NominalTypeMember);
+      break;
+    case Section::ProvidesDynamicLookup:
+      update = provides(DependencyKind::DynamicLookupName);
+      break;
+    case Section::DependsTopLevel:
+      update = dependsCallback(name, DependencyKind::TopLevelName,
+                               isCascading);
+      break;
+    case Section::DependsMember:
+      update = dependsCallback(name, DependencyKind::NominalTypeMember,
+                               isCascading);
+      break;
+    case Section::DependsNominal:
+      update = dependsCallback(name, DependencyKind::NominalType,
+                               isCascading);
+      break;
+    case Section::DependsDynamicLookup:
+      update = dependsCallback(name, DependencyKind::DynamicLookupName,
+                               isCascading);
+      break;
+    case Section::DependsExternal:
+      update = dependsCallback(name, DependencyKind::ExternalFile,
+                               isCascading);
+      break;
+    case Section::InterfaceHash:
+      update = interfaceHashCallback(name);
+      break;
+    case Section::ProvidesFingerprint:
+      if (lastProvidedKind == DependencyKind())
+        return false;
+      update = fingerprintCallback(lastProvidedName, lastProvidedKind, name);
+      lastProvidedKind = DependencyKind();
+      break;
+    }
+
+    switch (update) {
+    case LoadResult::HadError:
+      return false;
+    case LoadResult::UpToDate:
+      break;
+    case LoadResult::AffectsDownstream:
+      result = LoadResult::AffectsDownstream;
+      break;
+    }
+    return true;
+  });
+
+  if (!wellFormed)
+    return LoadResult::HadError;
+  return result;
+}
+
+/// Reads a dependencies file in either form. The YAML form is only written
+/// by the frontend for debugging, with -emit-yaml-reference-dependencies,
+/// but is also convenient for tests.
 static LoadResult
 parseDependencyFile(llvm::MemoryBuffer &buffer,
                     llvm::function_ref<DependencyCallbackTy> providesCallback,
                     llvm::function_ref<DependencyCallbackTy> dependsCallback,
-                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback) {
+                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback,
+                    llvm::function_ref<FingerprintCallbackTy> fingerprintCallback) {
   namespace yaml = llvm::yaml;
 
-  // FIXME: Switch to a format other than YAML.
+  if (reference_dependencies::isBinaryFormat(buffer.getBuffer())) {
+    return parseBinaryDependencyFile(buffer, providesCallback, dependsCallback,
+                                     interfaceHashCallback,
+                                     fingerprintCallback);
+  }
+
   llvm::SourceMgr SM;
   yaml::Stream stream(buffer.getMemBufferRef(), SM);
   auto I = stream.begin();
@@ -105,6 +202,47 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
       StringRef valueString = value->getValue(scratch);
       UPDATE_RESULT(interfaceHashCallback(valueString));
 
+    } else if (keyString == "provides-fingerprints") {
+      // Each entry is the fingerprint, the key of the "provides" entry it
+      // belongs to, and that entry's name (or type and member names).
+      auto *entries = dyn_cast<yaml::SequenceNode>(i->getValue());
+      if (!entries)
+        return LoadResult::HadError;
+
+      for (yaml::Node &rawEntry : *entries) {
+        auto *entry = dyn_cast<yaml::SequenceNode>(&rawEntry);
+        if (!entry)
+          return LoadResult::HadError;
+
+        SmallVector<std::string, 4> fields;
+        for (yaml::Node &rawField : *entry) {
+          auto *field = dyn_cast<yaml::ScalarNode>(&rawField);
+          if (!field)
+            return LoadResult::HadError;
+          fields.push_back(field->getValue(scratch).str());
+        }
+        if (fields.size() < 3)
+          return LoadResult::HadError;
+
+        DependencyKind kind = llvm::StringSwitch<DependencyKind>(fields[1])
+          .Case("provides-top-level", DependencyKind::TopLevelName)
+          .Case("provides-nominal", DependencyKind::NominalType)
+          .Case("provides-member", DependencyKind::NominalTypeMember)
+          .Case("provides-dynamic-lookup", DependencyKind::DynamicLookupName)
+          .Default(DependencyKind());
+        bool isMember = kind == DependencyKind::NominalTypeMember;
+        if (kind == DependencyKind() || fields.size() != (isMember ? 4 : 3))
+          return LoadResult::HadError;
+
+        // Smash the type and member names together, as for "provides-member".
+        std::string name = fields[2];
+        if (isMember) {
+          name.push_back('\0');
+          name += fields[3];
+        }
+        UPDATE_RESULT(fingerprintCallback(name, kind, fields[0]));
+      }
+
     } else {
       enum class DependencyDirection : bool {
         Depends,
@@ -207,7 +345,10 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
 }
 
 LoadResult DependencyGraphImpl::loadFromPath(const void *node, StringRef path) {
-  auto buffer = llvm::MemoryBuffer::getFile(path);
+  // Neither format needs a null terminator, which lets large files be
+  // mapped rather than read.
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
   if (!buffer)
     return LoadResult::HadError;
   return loadFromBuffer(node, *buffer.get());
@@ -223,6 +364,22 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
                                                llvm::MemoryBuffer &buffer) {
   auto &provides = Provides[node];
 
+  // Set aside the fingerprints from the last load, to see which entries
+  // still have the same ones afterwards. Entries are never removed, so
+  // they can be matched up by index.
+  SmallVector<Optional<std::string>, 16> previousFingerprints;
+  for (auto &entry : provides) {
+    if (entry.fingerprintedKinds.contains(entry.kindMask) &&
+        !entry.fingerprint.empty()) {
+      previousFingerprints.push_back(std::move(entry.fingerprint));
+    } else {
+      previousFingerprints.push_back(None);
+    }
+    entry.fingerprint.clear();
+    entry.fingerprintedKinds = DependencyMaskTy();
+    entry.isUnchanged = false;
+  }
+
   auto dependsCallback = [this, node](StringRef name, DependencyKind kind,
                                       bool isCascading) -> LoadResult {
     if (kind == DependencyKind::ExternalFile)
@@ -285,8 +442,35 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
     return LoadResult::UpToDate;
   };
 
-  return parseDependencyFile(buffer, providesCallback, dependsCallback,
-                             interfaceHashCallback);
+  auto fingerprintCallback =
+      [&provides](StringRef name, DependencyKind kind,
+                  StringRef fingerprint) -> LoadResult {
+    auto iter = std::find_if(provides.begin(), provides.end(),
+                             [name](const ProvidesEntryTy &entry) -> bool {
+      return name == entry.name;
+    });
+    if (iter == provides.end() || !iter->kindMask.contains(kind))
+      return LoadResult::HadError;
+
+    // Overloads share an entry, so their fingerprints are combined.
+    iter->fingerprint += fingerprint;
+    iter->fingerprintedKinds |= kind;
+    return LoadResult::UpToDate;
+  };
+
+  LoadResult result = parseDependencyFile(buffer, providesCallback,
+                                          dependsCallback,
+                                          interfaceHashCallback,
+                                          fingerprintCallback);
+
+  for (size_t i = 0, e = previousFingerprints.size(); i != e; ++i) {
+    auto &entry = provides[i];
+    entry.isUnchanged = previousFingerprints[i].hasValue() &&
+                        entry.fingerprintedKinds.contains(entry.kindMask) &&
+                        entry.fingerprint == *previousFingerprints[i];
+  }
+
+  return result;
 }
 
 void DependencyGraphImpl::markExternal(SmallVectorImpl<const void *> &visited,
@@ -322,12 +506,21 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
   SmallPtrSet<const void *, 16> visitedSet;
 
   auto addDependentsToWorklist = [&](const void *next,
-                                     ArrayRef<MarkTracerImpl::Entry> reason) {
+                                     ArrayRef<MarkTracerImpl::Entry> reason,
+                                     bool skipUnchanged) {
     auto allProvided = Provides.find(next);
     if (allProvided == Provides.end())
       return;
 
     for (const auto &provided : allProvided->second) {
+      if (skipUnchanged && provided.isUnchanged) {
+        if (tracer) {
+          tracer->Unchanged[next].push_back({next, provided.name,
+                                             provided.kindMask});
+        }
+        continue;
+      }
+
       auto allDependents = Dependencies.find(provided.name);
       if (allDependents == Dependencies.end())
         continue;
@@ -373,8 +566,13 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
   };
 
   // Always mark through the starting node, even if it's already marked.
+  // Only its entries whose fingerprints changed need to be followed: that
+  // node's file has just been rebuilt, while the files it leads to have
+  // not, so they are followed in full.
   markIntransitive(node);
-  addDependentsToWorklist(node, {});
+  if (tracer)
+    tracer->Unchanged.erase(node);
+  addDependentsToWorklist(node, {}, /*skipUnchanged=*/true);
 
   while (!worklist.empty()) {
     auto next = worklist.pop_back_val();
@@ -386,13 +584,52 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
       continue;
     }
 
-    addDependentsToWorklist(next.Node, next.Reason);
+    addDependentsToWorklist(next.Node, next.Reason, /*skipUnchanged=*/false);
     if (!markIntransitive(next.Node))
       continue;
     record(next);
   }
 }
 
+void DependencyGraphImpl::MarkTracerImpl::printEntry(raw_ostream &out,
+                                                     const Entry &entry) {
+  if (entry.KindMask.contains(DependencyKind::TopLevelName)) {
+    out << " provides top-level name '" << entry.Name << "'";
+
+  } else if (entry.KindMask.contains(DependencyKind::NominalType)) {
+    SmallString<64> name{entry.Name};
+    if (name.front() == 'P')
+      name.push_back('_');
+    out << " provides type '"
+        << swift::demangle_wrappers::demangleTypeAsString(name.str())
+        << "'";
+
+  } else if (entry.KindMask.contains(DependencyKind::NominalTypeMember)) {
+    SmallString<64> name{entry.Name};
+    size_t splitPoint = name.find('\0');
+    assert(splitPoint != StringRef::npos);
+
+    StringRef typePart;
+    if (name.front() == 'P') {
+      name[splitPoint] = '_';
+      typePart = name.str().slice(0, splitPoint+1);
+    } else {
+      typePart = name.str().slice(0, splitPoint);
+    }
+    StringRef memberPart = name.str().substr(splitPoint+1);
+
+    out << " provides member '" << memberPart << "' of type '"
+        << swift::demangle_wrappers::demangleTypeAsString(typePart)
+        << "'";
+
+  } else if (entry.KindMask.contains(DependencyKind::DynamicLookupName)) {
+    out << " provides AnyObject member '" << entry.Name << "'";
+
+  } else {
+    llvm_unreachable("not a dependency kind between nodes");
+  }
+}
+
 void DependencyGraphImpl::MarkTracerImpl::printPath(
     raw_ostream &out,
     const void *item,
@@ -400,40 +637,19 @@ void DependencyGraphImpl::MarkTracerImpl::printPath(
   for (const Entry &entry : Table.lookup(item)) {
     out << "\t";
     printItem(entry.Node);
-    if (entry.KindMask.contains(DependencyKind::TopLevelName)) {
-      out << " provides top-level name '" << entry.Name << "'\n";
-
-    } else if (entry.KindMask.contains(DependencyKind::NominalType)) {
-      SmallString<64> name{entry.Name};
-      if (name.front() == 'P')
-        name.push_back('_');
-      out << " provides type '"
-          << swift::demangle_wrappers::demangleTypeAsString(name.str())
-          << "'\n";
-
-    } else if (entry.KindMask.contains(DependencyKind::NominalTypeMember)) {
-      SmallString<64> name{entry.Name};
-      size_t splitPoint = name.find('\0');
-      assert(splitPoint != StringRef::npos);
-
-      StringRef typePart;
-      if (name.front() == 'P') {
-        name[splitPoint] = '_';
-        typePart = name.str().slice(0, splitPoint+1);
-      } else {
-        typePart = name.str().slice(0, splitPoint);
-      }
-      StringRef memberPart = name.str().substr(splitPoint+1);
-
-      out << " provides member '" << memberPart << "' of type '"
-          << swift::demangle_wrappers::demangleTypeAsString(typePart)
-          << "'\n";
-
-    } else if (entry.KindMask.contains(DependencyKind::DynamicLookupName)) {
-      out << " provides AnyObject member '" << entry.Name << "'\n";
+    printEntry(out, entry);
+    out << "\n";
+  }
+}
 
-    } else {
-      llvm_unreachable("not a dependency kind between nodes");
-    }
+void DependencyGraphImpl::MarkTracerImpl::printUnchanged(
+    raw_ostream &out,
+    const void *item,
+    llvm::function_ref<void (const void *)> printItem) const {
+  for (const Entry &entry : Unchanged.lookup(item)) {
+    out << "\t";
+    printItem(entry.Node);
+    printEntry(out, entry);
+    out << ", but its fingerprint is unchanged\n";
   }
 }
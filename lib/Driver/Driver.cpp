@@ -29,6 +29,7 @@
 #include "swift/Driver/Action.h"
 #include "swift/Driver/Compilation.h"
 #include "swift/Driver/Job.h"
+#include "swift/Driver/OutputCache.h"
 #include "swift/Driver/OutputFileMap.h"
 #include "swift/Driver/ToolChain.h"
 #include "swift/Option/Options.h"
@@ -191,7 +192,10 @@ class Driver::InputInfoMap
 };
 using InputInfoMap = Driver::InputInfoMap;
 
-static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
+static bool populateOutOfDateMap(InputInfoMap &map,
+                                 llvm::StringMap<llvm::sys::TimeValue> &times,
+                                 llvm::StringMap<std::string> &hashes,
+                                 StringRef argsHashStr,
                                  const InputFileList &inputs,
                                  StringRef buildRecordPath) {
   // Treat a missing file as "no previous build".
@@ -316,6 +320,54 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
         auto inputName = key->getValue(scratch);
         previousInputs[inputName] = { *previousBuildState, timeValue };
       }
+
+    } else if (keyStr == "compile_times") {
+      // The compile times are only a scheduling hint, so they're read even
+      // if the rest of the record turns out to be stale.
+      auto *timeMap = dyn_cast<yaml::MappingNode>(i->getValue());
+      if (!timeMap)
+        return true;
+
+      // FIXME: LLVM's YAML support does incremental parsing in such a way that
+      // for-range loops break.
+      for (auto i = timeMap->begin(), e = timeMap->end(); i != e; ++i) {
+        auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+        if (!key)
+          return true;
+
+        // The times are in microseconds.
+        auto *value = dyn_cast<yaml::ScalarNode>(i->getValue());
+        if (!value)
+          return true;
+        uint64_t microseconds;
+        if (value->getValue(scratch).getAsInteger(10, microseconds))
+          return true;
+
+        auto inputName = key->getValue(scratch);
+        times[inputName] = llvm::sys::TimeValue(
+            microseconds / 1000000, (microseconds % 1000000) * 1000);
+      }
+
+    } else if (keyStr == "content_hashes") {
+      auto *hashMap = dyn_cast<yaml::MappingNode>(i->getValue());
+      if (!hashMap)
+        return true;
+
+      // FIXME: LLVM's YAML support does incremental parsing in such a way that
+      // for-range loops break.
+      for (auto i = hashMap->begin(), e = hashMap->end(); i != e; ++i) {
+        auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+        if (!key)
+          return true;
+
+        auto *value = dyn_cast<yaml::ScalarNode>(i->getValue());
+        if (!value)
+          return true;
+
+        // The key and value share the scratch buffer.
+        std::string inputName = key->getValue(scratch);
+        hashes[inputName] = value->getValue(scratch);
+      }
     }
   }
 
@@ -427,6 +479,8 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   computeArgsHash(ArgsHash, *TranslatedArgList);
 
   InputInfoMap outOfDateMap;
+  llvm::StringMap<llvm::sys::TimeValue> previousCompileTimes;
+  llvm::StringMap<std::string> previousContentHashes;
   bool rebuildEverything = true;
   if (Incremental) {
     if (!OFM) {
@@ -449,7 +503,8 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
         rebuildEverything = true;
 
       } else {
-        if (populateOutOfDateMap(outOfDateMap, ArgsHash, Inputs,
+        if (populateOutOfDateMap(outOfDateMap, previousCompileTimes,
+                                 previousContentHashes, ArgsHash, Inputs,
                                  buildRecordPath)) {
           // FIXME: Distinguish errors from "file removed", which is benign.
         } else {
@@ -502,6 +557,14 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
                                                  DriverSkipExecution,
                                                  SaveTemps));
 
+  // Building the jobs decides which inputs have changed, which uses these.
+  if (ShowIncrementalBuildDecisions)
+    C->setShowsIncrementalBuildDecisions();
+  if (ArgList->hasArg(options::OPT_enable_incremental_file_hashing)) {
+    C->setFileHashingEnabled();
+    C->setPreviousContentHashes(std::move(previousContentHashes));
+  }
+
   buildJobs(Actions, OI, OFM.get(), *TC, *C);
 
   // For updating code we need to go through all the files and pick up changes,
@@ -511,8 +574,30 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
       OI.ShouldGenerateFixitEdits)
     C->setContinueBuildingAfterErrors();
 
-  if (ShowIncrementalBuildDecisions)
-    C->setShowsIncrementalBuildDecisions();
+  if (ArgList->hasArg(options::OPT_driver_time_compilation))
+    C->setShowDriverTimeCompilation();
+
+  if (ArgList->hasArg(options::OPT_driver_serve_jobs))
+    C->setServeJobs();
+
+  if (OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+      C->getArgs().hasFlag(options::OPT_enable_batch_mode,
+                           options::OPT_disable_batch_mode, false))
+    C->setBatchModeEnabled();
+
+  if (const Arg *A = ArgList->getLastArg(options::OPT_output_cache_path)) {
+    std::string error;
+    if (auto local = OutputCacheBackend::createLocal(A->getValue(), error)) {
+      std::unique_ptr<OutputCacheBackend> remote;
+      if (const Arg *R = ArgList->getLastArg(options::OPT_output_cache_remote))
+        remote = OutputCacheBackend::createCommand(R->getValue());
+      C->setOutputCache(llvm::make_unique<OutputCache>(std::move(local),
+                                                       std::move(remote)));
+    } else {
+      Diags.diagnose(SourceLoc(), diag::warning_output_cache_unusable,
+                     A->getValue(), error);
+    }
+  }
 
   // This has to happen after building jobs, because otherwise we won't even
   // emit .swiftdeps files for the next build.
@@ -526,6 +611,7 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
       auto buildEntry = outOfDateMap.find(nullptr);
       if (buildEntry != outOfDateMap.end())
         C->setLastBuildTime(buildEntry->second.previousModTime);
+      C->setPreviousCompileTimes(std::move(previousCompileTimes));
     }
   }
 
@@ -1068,6 +1154,7 @@ void Driver::buildOutputInfo(const ToolChain &TC, const DerivedArgList &Args,
                         [&OI](sys::ProcessId PID,
                               int returnCode,
                               StringRef output,
+                              const sys::TaskResourceUsage &,
                               void *unused) -> sys::TaskFinishedResponse {
             if (returnCode == 0) {
               output = output.rtrim();
@@ -1129,6 +1216,23 @@ void Driver::buildActions(const ToolChain &TC,
   switch (OI.CompilerMode) {
   case OutputInfo::Mode::StandardCompile:
   case OutputInfo::Mode::UpdateCode: {
+    // Precompile the bridging header once, rather than have every compile job
+    // parse it again.
+    std::unique_ptr<JobAction> PCH;
+    if (OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+        Args.hasArg(options::OPT_enable_bridging_pch)) {
+      if (const Arg *A = Args.getLastArg(options::OPT_import_objc_header)) {
+        bool HasSwiftInputs =
+            std::any_of(Inputs.begin(), Inputs.end(),
+                        [](const InputPair &Input) {
+          return types::isPartOfSwiftCompilation(Input.first);
+        });
+        if (HasSwiftInputs)
+          PCH.reset(new GeneratePCHJobAction(
+                        new InputAction(*A, types::TY_ObjCHeader)));
+      }
+    }
+
     for (const InputPair &Input : Inputs) {
       types::ID InputType = Input.first;
       const Arg *InputArg = Input.second;
@@ -1151,6 +1255,8 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              types::TY_LLVM_BC,
                                              previousBuildState));
+          if (PCH)
+            cast<JobAction>(Current.get())->addInput(PCH.get());
           AllModuleInputs.push_back(Current.get());
           Current.reset(new BackendJobAction(Current.release(),
                                              OI.CompilerOutputType, 0));
@@ -1158,6 +1264,8 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              OI.CompilerOutputType,
                                              previousBuildState));
+          if (PCH)
+            cast<JobAction>(Current.get())->addInput(PCH.get());
           AllModuleInputs.push_back(Current.get());
         }
         AllLinkerInputs.push_back(Current.release());
@@ -1190,6 +1298,7 @@ void Driver::buildActions(const ToolChain &TC,
       case types::TY_SerializedDiagnostics:
       case types::TY_ObjCHeader:
       case types::TY_ClangModuleFile:
+      case types::TY_PCH:
       case types::TY_SwiftDeps:
       case types::TY_Remapping:
         // We could in theory handle assembly or LLVM input, but let's not.
@@ -1204,6 +1313,11 @@ void Driver::buildActions(const ToolChain &TC,
         llvm_unreachable("these types should never be inferred");
       }
     }
+
+    // The compile actions share the PCH action, so it is owned at the top
+    // level instead.
+    if (PCH)
+      Actions.push_back(PCH.release());
     break;
   }
   case OutputInfo::Mode::SingleCompile: {
@@ -1417,7 +1531,7 @@ void Driver::buildJobs(const ActionList &Actions, const OutputInfo &OI,
       // be inferred if there are other top-level outputs. dSYM outputs are
       // based on the image.)
       if (Type != types::TY_Nothing && Type != types::TY_SwiftModuleFile &&
-          Type != types::TY_dSYM) {
+          Type != types::TY_dSYM && Type != types::TY_PCH) {
         // Multi-threading compilation has multiple outputs, except those
         // outputs which are produced before the llvm passes (e.g. emit-sil).
         if (OI.isMultiThreading() && isa<CompileJobAction>(A) &&
@@ -1489,6 +1603,11 @@ static StringRef getOutputFilename(Compilation &C,
     }
   }
 
+  // PCH actions are never treated as top-level; the PCH is only an
+  // intermediate of the compile jobs.
+  if (isa<GeneratePCHJobAction>(JA))
+    AtTopLevel = false;
+
   // dSYM actions are never treated as top-level.
   if (isa<GenerateDSYMJobAction>(JA)) {
     Buffer = InputJobs.front()->getOutput().getPrimaryOutputFilename();
@@ -1592,11 +1711,63 @@ static void addAuxiliaryOutput(Compilation &C, CommandOutput &output,
   }
 }
 
+/// Computes the hash of the contents of the file at \p path.
+///
+/// \returns true on error
+static bool computeContentHash(StringRef path, SmallString<32> &out) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return true;
+
+  llvm::MD5 hash;
+  hash.update(buffer.get()->getBuffer());
+  llvm::MD5::MD5Result hashBuf;
+  hash.final(hashBuf);
+  llvm::MD5::stringifyResult(hashBuf, out);
+  return false;
+}
+
+/// Records the hash of the contents of \p input in \p J, and checks whether
+/// they are the same as in the last build.
+///
+/// The contents are only read when the modification time has changed since
+/// the last build, or the last build didn't record a hash.
+///
+/// \returns true if the contents changed or can't be read
+static bool checkInputContents(Job *J, CompileJobAction::InputInfo inputInfo,
+                               StringRef input, const Compilation &C) {
+  StringRef previousHash = C.getPreviousContentHash(input);
+  bool sameModTime = J->getInputModTime() == inputInfo.previousModTime;
+  if (sameModTime && !previousHash.empty()) {
+    J->setInputContentHash(previousHash);
+    return false;
+  }
+
+  SmallString<32> hash;
+  if (computeContentHash(input, hash))
+    return true;
+  J->setInputContentHash(hash);
+  if (sameModTime)
+    return false;
+
+  // A version control checkout, for example, may touch a file without
+  // changing it.
+  if (previousHash.empty() || previousHash != hash)
+    return true;
+
+  if (C.getShowsIncrementalBuildDecisions())
+    llvm::outs() << "Contents of " << llvm::sys::path::filename(input)
+                 << " unchanged despite new modification time\n";
+  return false;
+}
+
 /// If the file at \p input has not been modified since the last build (i.e. its
-/// mtime has not changed), adjust the Job's condition accordingly.
+/// mtime has not changed, or with file hashing its contents have not), adjust
+/// the Job's condition accordingly.
 static void
 handleCompileJobCondition(Job *J, CompileJobAction::InputInfo inputInfo,
-                          StringRef input, bool alwaysRebuildDependents) {
+                          StringRef input, bool alwaysRebuildDependents,
+                          const Compilation &C) {
   if (inputInfo.status == CompileJobAction::InputInfo::NewlyAdded) {
     J->setCondition(Job::Condition::NewlyAdded);
     return;
@@ -1612,8 +1783,12 @@ handleCompileJobCondition(Job *J, CompileJobAction::InputInfo inputInfo,
     return;
 
   J->setInputModTime(inputStatus.getLastModificationTime());
-  if (J->getInputModTime() != inputInfo.previousModTime)
+  if (C.getFileHashingEnabled()) {
+    if (checkInputContents(J, inputInfo, input, C))
+      return;
+  } else if (J->getInputModTime() != inputInfo.previousModTime) {
     return;
+  }
 
   Job::Condition condition;
   switch (inputInfo.status) {
@@ -1709,8 +1884,11 @@ Job *Driver::buildJobsForAction(Compilation &C, const JobAction *JA,
       OutputFunc(IA->getInputArg().getValue());
 
     }
-    // Add an output file for each input job.
+    // Add an output file for each input job, other than the precompiled
+    // bridging header.
     for (const Job *job : InputJobs) {
+      if (isa<GeneratePCHJobAction>(job->getSource()))
+        continue;
       OutputFunc(job->getOutput().getBaseInput(0));
     }
   } else {
@@ -1882,7 +2060,7 @@ Job *Driver::buildJobsForAction(Compilation &C, const JobAction *JA,
       bool alwaysRebuildDependents =
           C.getArgs().hasArg(options::OPT_driver_always_rebuild_dependents);
       handleCompileJobCondition(J, compileJob->getInputInfo(), BaseInput,
-                                alwaysRebuildDependents);
+                                alwaysRebuildDependents, C);
     }
   }
 
@@ -0,0 +1,424 @@
+//===--- OutputCache.cpp - Reuse frontend job outputs ---------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Driver/OutputCache.h"
+#include "swift/Basic/Version.h"
+#include "swift/Driver/Action.h"
+#include "swift/Driver/Compilation.h"
+#include "swift/Driver/DependencyGraph.h"
+#include "swift/Driver/Job.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Option/Arg.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace swift;
+using namespace swift::driver;
+
+/// Bumped whenever the keys or the layout of the entries change.
+static const char EntrySignature[] = "SWOC1\n";
+
+/// Writes \p contents to \p path through a temporary file, so that nobody
+/// ever sees it half-written.
+static bool writeFileAtomically(StringRef path, StringRef contents) {
+  SmallString<128> tmpName(path);
+  tmpName += "-%%%%%%";
+  int tmpFD;
+  if (llvm::sys::fs::createUniqueFile(tmpName.str(), tmpFD, tmpName))
+    return false;
+
+  {
+    llvm::raw_fd_ostream out(tmpFD, /*shouldClose=*/true);
+    out << contents;
+    out.flush();
+    if (out.has_error()) {
+      out.clear_error();
+      llvm::sys::fs::remove(tmpName.str());
+      return false;
+    }
+  }
+
+  if (llvm::sys::fs::rename(tmpName.str(), path)) {
+    llvm::sys::fs::remove(tmpName.str());
+    return false;
+  }
+  return true;
+}
+
+static bool readFile(StringRef path, std::string &contents) {
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!buffer)
+    return false;
+  contents = buffer.get()->getBuffer();
+  return true;
+}
+
+namespace {
+
+class LocalBackend : public OutputCacheBackend {
+  std::string Root;
+
+  /// Entries are spread over subdirectories named after the start of their
+  /// hash, to keep the directories small.
+  std::string getPath(StringRef key) const {
+    SmallString<128> path(Root);
+    llvm::sys::path::append(path, key.substr(1, 2), key);
+    return path.str();
+  }
+
+public:
+  explicit LocalBackend(StringRef root) : Root(root) {}
+
+  bool get(StringRef key, std::string &contents) override {
+    return readFile(getPath(key), contents);
+  }
+
+  void put(StringRef key, StringRef contents) override {
+    std::string path = getPath(key);
+    if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path)))
+      return;
+    (void)writeFileAtomically(path, contents);
+  }
+};
+
+class CommandBackend : public OutputCacheBackend {
+  std::string Program;
+
+  bool run(StringRef action, StringRef key, StringRef path) {
+    std::string keyString = key;
+    std::string pathString = path;
+    const char *args[] = {
+      Program.c_str(), action.data(), keyString.c_str(), pathString.c_str(),
+      nullptr
+    };
+    return llvm::sys::ExecuteAndWait(Program, args) == 0;
+  }
+
+public:
+  explicit CommandBackend(StringRef program) : Program(program) {}
+
+  bool get(StringRef key, std::string &contents) override {
+    SmallString<128> path;
+    if (llvm::sys::fs::createTemporaryFile("output-cache", "entry", path))
+      return false;
+    bool found = run("get", key, path) && readFile(path, contents);
+    llvm::sys::fs::remove(path.str());
+    return found;
+  }
+
+  void put(StringRef key, StringRef contents) override {
+    SmallString<128> path;
+    int fd;
+    if (llvm::sys::fs::createTemporaryFile("output-cache", "entry", fd, path))
+      return;
+    {
+      llvm::raw_fd_ostream out(fd, /*shouldClose=*/true);
+      out << contents;
+    }
+    (void)run("put", key, path);
+    llvm::sys::fs::remove(path.str());
+  }
+};
+
+} // end anonymous namespace
+
+std::unique_ptr<OutputCacheBackend>
+OutputCacheBackend::createLocal(StringRef path, std::string &error) {
+  if (auto EC = llvm::sys::fs::create_directories(path)) {
+    error = EC.message();
+    return nullptr;
+  }
+  return std::unique_ptr<OutputCacheBackend>(new LocalBackend(path));
+}
+
+std::unique_ptr<OutputCacheBackend>
+OutputCacheBackend::createCommand(StringRef program) {
+  return std::unique_ptr<OutputCacheBackend>(new CommandBackend(program));
+}
+
+bool OutputCache::get(StringRef key, std::string &contents) {
+  if (Local->get(key, contents))
+    return true;
+  if (!Remote || !Remote->get(key, contents))
+    return false;
+  Local->put(key, contents);
+  return true;
+}
+
+void OutputCache::put(StringRef key, StringRef contents) {
+  Local->put(key, contents);
+  if (Remote)
+    Remote->put(key, contents);
+}
+
+/// The additional outputs that don't mention where any files are, and so
+/// can be reused by a job writing them somewhere else.
+static bool isCacheableOutputType(types::ID type) {
+  switch (type) {
+  case types::TY_SwiftModuleFile:
+  case types::TY_SwiftModuleDocFile:
+  case types::TY_SwiftDeps:
+  case types::TY_SerializedDiagnostics:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool OutputCache::isCacheable(const Job &cmd) {
+  if (!isa<CompileJobAction>(cmd.getSource()))
+    return false;
+
+  const CommandOutput &output = cmd.getOutput();
+  if (output.getPrimaryOutputFilenames().size() != 1 ||
+      output.getAdditionalOutputForType(types::TY_SwiftDeps).empty())
+    return false;
+
+  bool result = true;
+  types::forAllTypes([&](types::ID type) {
+    if (!output.getAdditionalOutputForType(type).empty() &&
+        !isCacheableOutputType(type))
+      result = false;
+  });
+  return result;
+}
+
+/// Calls \p callback with the type and path of each output of \p cmd, the
+/// primary output first.
+static void forEachOutput(const Job &cmd,
+                          llvm::function_ref<void(StringRef, StringRef)>
+                              callback) {
+  const CommandOutput &output = cmd.getOutput();
+  callback(types::getTypeName(output.getPrimaryOutputType()),
+           output.getPrimaryOutputFilename());
+  types::forAllTypes([&](types::ID type) {
+    const std::string &path = output.getAdditionalOutputForType(type);
+    if (!path.empty())
+      callback(types::getTypeName(type), path);
+  });
+}
+
+static void addToHash(llvm::MD5 &hash, StringRef data) {
+  // Prefixing each piece with its size keeps different splits of the same
+  // bytes apart.
+  hash.update(std::to_string(data.size()));
+  hash.update(":");
+  hash.update(data);
+}
+
+static std::string getHashString(llvm::MD5 &hash) {
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+  SmallString<32> string;
+  llvm::MD5::stringifyResult(result, string);
+  return string.str();
+}
+
+/// Computes the base key of \p cmd, or returns an empty string if a source
+/// file can't be read.
+static std::string computeBaseKey(const Compilation &C, const Job &cmd) {
+  llvm::MD5 hash;
+  addToHash(hash, EntrySignature);
+  addToHash(hash, version::getSwiftFullVersion());
+
+  // Development compilers all have the same version, so the executable
+  // itself has to be told apart as well.
+  addToHash(hash, cmd.getExecutable());
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(cmd.getExecutable(), status))
+    return std::string();
+  addToHash(hash, std::to_string(status.getSize()));
+  addToHash(hash, std::to_string(
+      status.getLastModificationTime().toEpochTime()));
+
+  // Relative paths on the command line, and the debug info, depend on the
+  // working directory.
+  SmallString<128> workingDirectory;
+  if (llvm::sys::fs::current_path(workingDirectory))
+    return std::string();
+  addToHash(hash, workingDirectory);
+
+  // Outputs are named by their types rather than by where they go.
+  llvm::StringMap<std::string> outputNames;
+  forEachOutput(cmd, [&](StringRef type, StringRef path) {
+    outputNames[path] = ("<output:" + type + ">").str();
+  });
+  StringRef filelist = cmd.getFilelistInfo().path;
+  if (!filelist.empty())
+    outputNames[filelist] = "<filelist>";
+  if (const char *map = C.getModuleLocationMapPathIfCreated())
+    outputNames[map] = "<module-location-map>";
+  for (const char *arg : cmd.getArguments()) {
+    auto found = outputNames.find(arg);
+    addToHash(hash, found == outputNames.end() ? StringRef(arg)
+                                               : StringRef(found->second));
+  }
+
+  std::string contents;
+  for (const InputPair &input : C.getInputFiles()) {
+    if (!types::isPartOfSwiftCompilation(input.first))
+      continue;
+    if (!readFile(input.second->getValue(), contents))
+      return std::string();
+    addToHash(hash, input.second->getValue());
+    addToHash(hash, contents);
+  }
+
+  return getHashString(hash);
+}
+
+/// Computes the key of the outputs of a job with the base key \p baseKey,
+/// whose files from outside the module are listed in \p manifest.
+static std::string computeKey(StringRef baseKey, StringRef manifest) {
+  llvm::MD5 hash;
+  addToHash(hash, baseKey);
+
+  SmallVector<StringRef, 16> dependencies;
+  manifest.split(dependencies, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  std::string contents;
+  for (StringRef dependency : dependencies) {
+    addToHash(hash, dependency);
+    if (readFile(dependency, contents))
+      addToHash(hash, contents);
+    else
+      addToHash(hash, "<missing>");
+  }
+
+  return getHashString(hash);
+}
+
+/// Splits an entry into what the job printed and the contents of each of
+/// its outputs, keyed by type name.
+static bool parseEntry(StringRef entry, std::string &output,
+                       llvm::StringMap<StringRef> &files) {
+  if (!entry.startswith(EntrySignature))
+    return false;
+  entry = entry.drop_front(strlen(EntrySignature));
+
+  auto takeString = [&](StringRef &result) -> bool {
+    size_t colon = entry.find(':');
+    uint64_t size;
+    if (colon == StringRef::npos ||
+        entry.substr(0, colon).getAsInteger(10, size) ||
+        size > entry.size() - colon - 1)
+      return false;
+    result = entry.substr(colon + 1, size);
+    entry = entry.drop_front(colon + 1 + size);
+    return true;
+  };
+
+  StringRef printed;
+  if (!takeString(printed))
+    return false;
+  output = printed;
+  while (!entry.empty()) {
+    StringRef type, contents;
+    if (!takeString(type) || !takeString(contents))
+      return false;
+    files[type] = contents;
+  }
+  return true;
+}
+
+bool OutputCache::restore(const Compilation &C, const Job &cmd,
+                          std::string &output) {
+  assert(isCacheable(cmd));
+  std::string baseKey = computeBaseKey(C, cmd);
+  if (baseKey.empty())
+    return false;
+
+  std::string manifest, entry;
+  llvm::StringMap<StringRef> files;
+  bool found = get("m" + baseKey, manifest) &&
+               get("o" + computeKey(baseKey, manifest), entry) &&
+               parseEntry(entry, output, files);
+
+  // Every output has to be there before any of them is written.
+  forEachOutput(cmd, [&](StringRef type, StringRef path) {
+    if (!files.count(type))
+      found = false;
+  });
+  forEachOutput(cmd, [&](StringRef type, StringRef path) {
+    if (found && !writeFileAtomically(path, files[type]))
+      found = false;
+  });
+
+  if (!found) {
+    ++Misses;
+    MissedKeys[&cmd] = std::move(baseKey);
+    return false;
+  }
+  ++Hits;
+  return true;
+}
+
+void OutputCache::store(const Compilation &C, const Job &cmd,
+                        StringRef output) {
+  auto missed = MissedKeys.find(&cmd);
+  if (missed == MissedKeys.end())
+    return;
+  std::string baseKey = std::move(missed->second);
+  MissedKeys.erase(missed);
+
+  // A source file that changed while the job ran may not match its outputs.
+  if (computeBaseKey(C, cmd) != baseKey)
+    return;
+
+  DependencyGraph<const Job *> graph;
+  StringRef dependenciesFile =
+      cmd.getOutput().getAdditionalOutputForType(types::TY_SwiftDeps);
+  if (graph.loadFromPath(&cmd, dependenciesFile) ==
+        DependencyGraphImpl::LoadResult::HadError)
+    return;
+  std::vector<std::string> dependencies;
+  for (StringRef dependency : graph.getExternalDependencies())
+    dependencies.push_back(dependency);
+  std::sort(dependencies.begin(), dependencies.end());
+  std::string manifest;
+  for (auto &dependency : dependencies) {
+    manifest += dependency;
+    manifest += '\n';
+  }
+
+  std::string entry = EntrySignature;
+  auto appendString = [&](StringRef string) {
+    entry += std::to_string(string.size());
+    entry += ':';
+    entry += string;
+  };
+  appendString(output);
+  bool complete = true;
+  std::string contents;
+  forEachOutput(cmd, [&](StringRef type, StringRef path) {
+    if (!complete || !readFile(path, contents)) {
+      complete = false;
+      return;
+    }
+    appendString(type);
+    appendString(contents);
+  });
+  if (!complete)
+    return;
+
+  // The outputs go in before the manifest that leads to them.
+  put("o" + computeKey(baseKey, manifest), entry);
+  put("m" + baseKey, manifest);
+}
@@ -19,6 +19,88 @@
 using namespace swift;
 using namespace swift::driver;
 
+namespace {
+/// Reads the tokens of a JSON document straight out of its buffer.
+class JSONScanner {
+  const char *Cur;
+  const char *End;
+
+  void skipWhitespace() {
+    while (Cur != End &&
+           (*Cur == ' ' || *Cur == '\t' || *Cur == '\n' || *Cur == '\r'))
+      ++Cur;
+  }
+
+public:
+  explicit JSONScanner(StringRef Data) : Cur(Data.begin()), End(Data.end()) {}
+
+  bool atEnd() {
+    skipWhitespace();
+    return Cur == End;
+  }
+
+  /// Consumes \p C if it is the next token.
+  bool consume(char C) {
+    skipWhitespace();
+    if (Cur == End || *Cur != C)
+      return false;
+    ++Cur;
+    return true;
+  }
+
+  /// Reads a string. If it has no escapes, \p Value refers into the
+  /// document; otherwise it refers to \p Storage.
+  ///
+  /// \returns false if the next token isn't a string, or uses an escape that
+  /// isn't handled here.
+  bool scanString(StringRef &Value, SmallVectorImpl<char> &Storage) {
+    if (!consume('"'))
+      return false;
+
+    const char *Start = Cur;
+    while (Cur != End && *Cur != '"' && *Cur != '\\')
+      ++Cur;
+    if (Cur == End)
+      return false;
+    if (*Cur == '"') {
+      Value = StringRef(Start, Cur - Start);
+      ++Cur;
+      return true;
+    }
+
+    Storage.assign(Start, Cur);
+    while (true) {
+      if (Cur == End)
+        return false;
+      char C = *Cur++;
+      if (C == '"')
+        break;
+      if (C != '\\') {
+        Storage.push_back(C);
+        continue;
+      }
+      if (Cur == End)
+        return false;
+      switch (*Cur++) {
+      case '"': Storage.push_back('"'); break;
+      case '\\': Storage.push_back('\\'); break;
+      case '/': Storage.push_back('/'); break;
+      case 'b': Storage.push_back('\b'); break;
+      case 'f': Storage.push_back('\f'); break;
+      case 'n': Storage.push_back('\n'); break;
+      case 'r': Storage.push_back('\r'); break;
+      case 't': Storage.push_back('\t'); break;
+      default:
+        // Leave \u escapes to the YAML parser.
+        return false;
+      }
+    }
+    Value = StringRef(Storage.data(), Storage.size());
+    return true;
+  }
+};
+} // end anonymous namespace
+
 std::unique_ptr<OutputFileMap> OutputFileMap::loadFromPath(StringRef Path) {
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileBufOrErr =
     llvm::MemoryBuffer::getFile(Path);
@@ -94,7 +176,61 @@ void OutputFileMap::dump(llvm::raw_ostream &os, bool Sort) const {
   }
 }
 
+bool OutputFileMap::parseJSON(StringRef Data) {
+  JSONScanner Scanner(Data);
+  if (!Scanner.consume('{'))
+    return true;
+
+  llvm::SmallString<128> InputStorage;
+  llvm::SmallString<16> KindStorage;
+  llvm::SmallString<128> PathStorage;
+  if (!Scanner.consume('}')) {
+    do {
+      StringRef Input;
+      if (!Scanner.scanString(Input, InputStorage) ||
+          !Scanner.consume(':') || !Scanner.consume('{'))
+        return true;
+
+      // As with the YAML parser, a repeated input replaces the earlier one.
+      TypeToPathMap &OutputMap = InputToOutputsMap[Input];
+      OutputMap.clear();
+      if (Scanner.consume('}'))
+        continue;
+
+      do {
+        StringRef KindName, Path;
+        if (!Scanner.scanString(KindName, KindStorage) ||
+            !Scanner.consume(':') || !Scanner.scanString(Path, PathStorage))
+          return true;
+
+        // Ignore unknown types, so that an older swiftc can be used with a
+        // newer build system.
+        types::ID Kind = types::lookupTypeForName(KindName);
+        if (Kind == types::TY_INVALID)
+          continue;
+
+        OutputMap.insert(std::pair<types::ID, std::string>(Kind, Path));
+      } while (Scanner.consume(','));
+
+      if (!Scanner.consume('}'))
+        return true;
+    } while (Scanner.consume(','));
+
+    if (!Scanner.consume('}'))
+      return true;
+  }
+
+  return !Scanner.atEnd();
+}
+
 bool OutputFileMap::parse(std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+  // Output file maps for large modules have thousands of entries, and are
+  // almost always plain JSON, which can be read much more quickly than YAML
+  // in general.
+  if (!parseJSON(Buffer->getBuffer()))
+    return false;
+  InputToOutputsMap.clear();
+
   llvm::SourceMgr SM;
   llvm::yaml::Stream YAMLStream(Buffer->getMemBufferRef(), SM);
   auto I = YAMLStream.begin();
@@ -61,6 +61,19 @@ namespace json {
     }
   };
 
+  template<>
+  struct ObjectTraits<sys::TaskResourceUsage> {
+    static void mapping(Output &out, sys::TaskResourceUsage &value) {
+      if (value.HasWallTime)
+        out.mapRequired("wall-usec", value.WallTime);
+      if (value.HasProcessUsage) {
+        out.mapRequired("user-usec", value.UserTime);
+        out.mapRequired("system-usec", value.SystemTime);
+        out.mapRequired("max-rss", value.MaxRSS);
+      }
+    }
+  };
+
   template<typename T, unsigned N>
   struct ArrayTraits<SmallVector<T, N>> {
     static size_t size(Output &out, SmallVector<T, N> &seq) {
@@ -185,30 +198,45 @@ public:
   }
 };
 
-class FinishedMessage : public TaskOutputMessage {
+class TaskUsageMessage : public TaskOutputMessage {
+  sys::TaskResourceUsage Usage;
+public:
+  TaskUsageMessage(StringRef Kind, const Job &Cmd, ProcessId Pid,
+                   StringRef Output, const sys::TaskResourceUsage &Usage)
+    : TaskOutputMessage(Kind, Cmd, Pid, Output), Usage(Usage) {}
+
+  virtual void provideMapping(swift::json::Output &out) {
+    TaskOutputMessage::provideMapping(out);
+    // Only include what was actually measured.
+    if (Usage.HasWallTime || Usage.HasProcessUsage)
+      out.mapRequired("usage", Usage);
+  }
+};
+
+class FinishedMessage : public TaskUsageMessage {
   int ExitStatus;
 public:
   FinishedMessage(const Job &Cmd, ProcessId Pid, StringRef Output,
-                  int ExitStatus) : TaskOutputMessage("finished", Cmd, Pid,
-                                                      Output),
-                                    ExitStatus(ExitStatus) {}
+                  int ExitStatus, const sys::TaskResourceUsage &Usage)
+    : TaskUsageMessage("finished", Cmd, Pid, Output, Usage),
+      ExitStatus(ExitStatus) {}
 
   virtual void provideMapping(swift::json::Output &out) {
-    TaskOutputMessage::provideMapping(out);
+    TaskUsageMessage::provideMapping(out);
     out.mapRequired("exit-status", ExitStatus);
   }
 };
 
-class SignalledMessage : public TaskOutputMessage {
+class SignalledMessage : public TaskUsageMessage {
   std::string ErrorMsg;
 public:
   SignalledMessage(const Job &Cmd, ProcessId Pid, StringRef Output,
-                   StringRef ErrorMsg) : TaskOutputMessage("signalled", Cmd,
-                                                           Pid, Output),
-                                         ErrorMsg(ErrorMsg) {}
+                   StringRef ErrorMsg, const sys::TaskResourceUsage &Usage)
+    : TaskUsageMessage("signalled", Cmd, Pid, Output, Usage),
+      ErrorMsg(ErrorMsg) {}
 
   virtual void provideMapping(swift::json::Output &out) {
-    TaskOutputMessage::provideMapping(out);
+    TaskUsageMessage::provideMapping(out);
     out.mapOptional("error-message", ErrorMsg, std::string());
   }
 };
@@ -219,6 +247,32 @@ public:
       DetailedCommandBasedMessage("skipped", Cmd) {}
 };
 
+class CachedMessage : public DetailedCommandBasedMessage {
+  std::string Output;
+public:
+  CachedMessage(const Job &Cmd, StringRef Output) :
+      DetailedCommandBasedMessage("cached", Cmd), Output(Output) {}
+
+  virtual void provideMapping(swift::json::Output &out) {
+    DetailedCommandBasedMessage::provideMapping(out);
+    out.mapOptional("output", Output, std::string());
+  }
+};
+
+class OutputCacheMessage : public Message {
+  unsigned Hits;
+  unsigned Misses;
+public:
+  OutputCacheMessage(unsigned Hits, unsigned Misses) :
+      Message("output-cache", "compile"), Hits(Hits), Misses(Misses) {}
+
+  virtual void provideMapping(swift::json::Output &out) {
+    Message::provideMapping(out);
+    out.mapRequired("hits", Hits);
+    out.mapRequired("misses", Misses);
+  }
+};
+
 }
 
 namespace swift {
@@ -252,16 +306,18 @@ void parseable_output::emitBeganMessage(raw_ostream &os,
 
 void parseable_output::emitFinishedMessage(raw_ostream &os,
                                            const Job &Cmd, ProcessId Pid,
-                                           int ExitStatus, StringRef Output) {
-  FinishedMessage msg(Cmd, Pid, Output, ExitStatus);
+                                           int ExitStatus, StringRef Output,
+                                       const sys::TaskResourceUsage &Usage) {
+  FinishedMessage msg(Cmd, Pid, Output, ExitStatus, Usage);
   emitMessage(os, msg);
 }
 
 void parseable_output::emitSignalledMessage(raw_ostream &os,
                                             const Job &Cmd, ProcessId Pid,
                                             StringRef ErrorMsg,
-                                            StringRef Output) {
-  SignalledMessage msg(Cmd, Pid, Output, ErrorMsg);
+                                            StringRef Output,
+                                        const sys::TaskResourceUsage &Usage) {
+  SignalledMessage msg(Cmd, Pid, Output, ErrorMsg, Usage);
   emitMessage(os, msg);
 }
 
@@ -269,3 +325,15 @@ void parseable_output::emitSkippedMessage(raw_ostream &os, const Job &Cmd) {
   SkippedMessage msg(Cmd);
   emitMessage(os, msg);
 }
+
+void parseable_output::emitCachedMessage(raw_ostream &os, const Job &Cmd,
+                                         StringRef Output) {
+  CachedMessage msg(Cmd, Output);
+  emitMessage(os, msg);
+}
+
+void parseable_output::emitOutputCacheMessage(raw_ostream &os, unsigned Hits,
+                                              unsigned Misses) {
+  OutputCacheMessage msg(Hits, Misses);
+  emitMessage(os, msg);
+}
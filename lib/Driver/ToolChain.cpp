@@ -47,6 +47,9 @@ ArrayRef<InputPair> ToolChain::JobContext::getTopLevelInputFiles() const {
 const char *ToolChain::JobContext::getAllSourcesPath() const {
   return C.getAllSourcesPath();
 }
+const char *ToolChain::JobContext::getModuleLocationMapPath() const {
+  return C.getModuleLocationMapPath();
+}
 
 const char *
 ToolChain::JobContext::getTemporaryFilePath(const llvm::Twine &name,
@@ -85,6 +88,7 @@ ToolChain::constructJob(const JobAction &JA,
     CASE(ModuleWrapJob)
     CASE(LinkJob)
     CASE(GenerateDSYMJob)
+    CASE(GeneratePCHJob)
     CASE(AutolinkExtractJob)
     CASE(REPLJob)
 #undef CASE
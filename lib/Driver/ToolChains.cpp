@@ -25,6 +25,7 @@
 #include "swift/Config.h"
 #include "clang/Basic/Version.h"
 #include "clang/Driver/Util.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
@@ -118,7 +119,6 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddLastArg(arguments, options::OPT_enable_app_extension);
   inputArgs.AddLastArg(arguments, options::OPT_enable_testing);
   inputArgs.AddLastArg(arguments, options::OPT_g_Group);
-  inputArgs.AddLastArg(arguments, options::OPT_import_objc_header);
   inputArgs.AddLastArg(arguments, options::OPT_import_underlying_module);
   inputArgs.AddLastArg(arguments, options::OPT_module_cache_path);
   inputArgs.AddLastArg(arguments, options::OPT_module_link_name);
@@ -126,12 +126,17 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddLastArg(arguments, options::OPT_parse_stdlib);
   inputArgs.AddLastArg(arguments, options::OPT_resource_dir);
   inputArgs.AddLastArg(arguments, options::OPT_solver_memory_threshold);
+  inputArgs.AddLastArg(arguments, options::OPT_solver_state_limit);
+  inputArgs.AddLastArg(arguments, options::OPT_stats_output_dir);
+  inputArgs.AddLastArg(arguments, options::OPT_trace_output_dir);
   inputArgs.AddLastArg(arguments, options::OPT_suppress_warnings);
   inputArgs.AddLastArg(arguments, options::OPT_profile_generate);
+  inputArgs.AddLastArg(arguments, options::OPT_profile_use);
   inputArgs.AddLastArg(arguments, options::OPT_profile_coverage_mapping);
   inputArgs.AddLastArg(arguments, options::OPT_warnings_as_errors);
   inputArgs.AddLastArg(arguments, options::OPT_sanitize_EQ);
   inputArgs.AddLastArg(arguments, options::OPT_sanitize_coverage_EQ);
+  inputArgs.AddLastArg(arguments, options::OPT_thin_lto);
 
   // Pass on any build config options
   inputArgs.AddAllArgs(arguments, options::OPT_D);
@@ -154,6 +159,22 @@ static void addCommonFrontendArgs(const ToolChain &TC,
     arguments.push_back("-color-diagnostics");
 }
 
+/// Pass on the bridging header, or the precompiled header generated from it
+/// if that is one of the job's inputs.
+static void addBridgingHeaderArgs(ArrayRef<const Job *> inputs,
+                                  const ArgList &inputArgs,
+                                  ArgStringList &arguments) {
+  for (const Job *input : inputs) {
+    if (isa<GeneratePCHJobAction>(input->getSource())) {
+      arguments.push_back("-import-objc-header");
+      arguments.push_back(
+        input->getOutput().getPrimaryOutputFilename().c_str());
+      return;
+    }
+  }
+  inputArgs.AddLastArg(arguments, options::OPT_import_objc_header);
+}
+
 
 ToolChain::InvocationInfo
 ToolChain::constructInvocation(const CompileJobAction &job,
@@ -214,6 +235,7 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
@@ -239,8 +261,11 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   
   Arguments.push_back(FrontendModeOption);
 
-  assert(context.Inputs.empty() &&
-         "The Swift frontend does not expect to be fed any input Jobs!");
+  assert(std::all_of(context.Inputs.begin(), context.Inputs.end(),
+                     [](const Job *input) {
+           return isa<GeneratePCHJobAction>(input->getSource());
+         }) &&
+         "The Swift frontend only expects a precompiled header as input Job!");
 
   // Add input arguments.
   switch (context.OI.CompilerMode) {
@@ -298,6 +323,13 @@ ToolChain::constructInvocation(const CompileJobAction &job,
 
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         Arguments);
+  addBridgingHeaderArgs(context.Inputs, context.Args, Arguments);
+
+  if (context.Args.hasArg(options::OPT_driver_use_module_location_map) &&
+      context.Args.hasArg(options::OPT_I, options::OPT_F)) {
+    Arguments.push_back("-module-location-map");
+    Arguments.push_back(context.getModuleLocationMapPath());
+  }
 
   // Pass the optimization level down to the frontend.
   context.Args.AddLastArg(Arguments, options::OPT_O_Group);
@@ -386,6 +418,134 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   return II;
 }
 
+/// The frontend options which name an output of a compile job's primary
+/// file. A batch job passes each of them once per primary file, in the same
+/// order as the primary files.
+static const char * const PerPrimaryOutputOptions[] = {
+  "-o",
+  "-output-filelist",
+  "-emit-module-path",
+  "-emit-module-doc-path",
+  "-serialize-diagnostics-path",
+  "-emit-dependencies-path",
+  "-emit-reference-dependencies-path",
+  "-emit-fixits-path",
+};
+
+static bool isPerPrimaryOutputOption(StringRef arg) {
+  for (StringRef option : PerPrimaryOutputOptions)
+    if (arg == option)
+      return true;
+  return false;
+}
+
+static const Arg &getPrimaryInputArg(const Job &job) {
+  return cast<InputAction>(job.getSource().getInputs()[0])->getInputArg();
+}
+
+bool ToolChain::jobIsBatchable(const Job &job) {
+  if (!isa<CompileJobAction>(job.getSource()))
+    return false;
+  // Besides its primary file, a compile job may only depend on the
+  // precompiled bridging header, which every job in a batch shares.
+  auto inputs = job.getSource().getInputs();
+  if (inputs.empty() || !isa<InputAction>(inputs.front()))
+    return false;
+  if (!std::all_of(inputs.begin() + 1, inputs.end(), [](const Action *input) {
+        return isa<GeneratePCHJobAction>(input);
+      }))
+    return false;
+  if (!job.getExtraEnvironment().empty())
+    return false;
+  // A list of the job's own outputs can be passed along with its other
+  // outputs, but a list of inputs can't.
+  FilelistInfo filelistInfo = job.getFilelistInfo();
+  if (!filelistInfo.path.empty() &&
+      filelistInfo.whichFiles != FilelistInfo::Output)
+    return false;
+
+  const ArgStringList &arguments = job.getArguments();
+  return std::find_if(arguments.begin(), arguments.end(),
+                      [](const char *arg) {
+    return StringRef(arg) == "-primary-file";
+  }) != arguments.end();
+}
+
+std::unique_ptr<Job>
+ToolChain::constructBatchJob(ArrayRef<const Job *> jobs) {
+  assert(!jobs.empty() && "no jobs to batch");
+
+  // The frontend expects the primary files in the order that they appear
+  // among the inputs.
+  SmallVector<const Job *, 16> sortedJobs(jobs.begin(), jobs.end());
+  std::sort(sortedJobs.begin(), sortedJobs.end(),
+            [](const Job *lhs, const Job *rhs) {
+    return getPrimaryInputArg(*lhs).getIndex() <
+           getPrimaryInputArg(*rhs).getIndex();
+  });
+
+  // The input arguments are shared by all of the jobs, so the primary files
+  // can be recognized by address.
+  llvm::SmallPtrSet<const char *, 16> primaryInputs;
+  for (const Job *job : sortedJobs) {
+    assert(jobIsBatchable(*job) && "job can't be batched");
+    primaryInputs.insert(getPrimaryInputArg(*job).getValue());
+  }
+
+  // Start from the first job's arguments, dropping its primary file marker
+  // and per-primary outputs. With -filelist, only that job's primary file
+  // appears on the command line, so the others are added next to it.
+  const Job *firstJob = sortedJobs.front();
+  const ArgStringList &firstArguments = firstJob->getArguments();
+  bool usesFilelist =
+      std::find_if(firstArguments.begin(), firstArguments.end(),
+                   [](const char *arg) {
+    return StringRef(arg) == "-filelist";
+  }) != firstArguments.end();
+
+  ArgStringList arguments;
+  for (size_t i = 0, e = firstArguments.size(); i != e; ++i) {
+    const char *arg = firstArguments[i];
+    if (StringRef(arg) == "-primary-file")
+      continue;
+    if (isPerPrimaryOutputOption(arg)) {
+      ++i;
+      continue;
+    }
+    if (!primaryInputs.count(arg)) {
+      arguments.push_back(arg);
+      continue;
+    }
+    if (!usesFilelist) {
+      arguments.push_back("-primary-file");
+      arguments.push_back(arg);
+      continue;
+    }
+    for (const Job *job : sortedJobs) {
+      arguments.push_back("-primary-file");
+      arguments.push_back(getPrimaryInputArg(*job).getValue());
+    }
+  }
+
+  for (StringRef option : PerPrimaryOutputOptions) {
+    for (const Job *job : sortedJobs) {
+      const ArgStringList &jobArguments = job->getArguments();
+      for (size_t i = 0, e = jobArguments.size(); i + 1 < e; ++i) {
+        if (option == jobArguments[i]) {
+          arguments.push_back(jobArguments[i]);
+          arguments.push_back(jobArguments[i + 1]);
+          break;
+        }
+      }
+    }
+  }
+
+  SmallVector<const Job *, 4> inputs;
+  return llvm::make_unique<Job>(firstJob->getSource(), std::move(inputs),
+      llvm::make_unique<CommandOutput>(firstJob->getOutput()),
+      firstJob->getExecutable(), std::move(arguments));
+}
+
 ToolChain::InvocationInfo
 ToolChain::constructInvocation(const InterpretJobAction &job,
                                const JobContext &context) const {
@@ -407,6 +567,7 @@ ToolChain::constructInvocation(const InterpretJobAction &job,
 
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         Arguments);
+  context.Args.AddLastArg(Arguments, options::OPT_import_objc_header);
 
   // Pass the optimization level down to the frontend.
   context.Args.AddLastArg(Arguments, options::OPT_O_Group);
@@ -417,6 +578,7 @@ ToolChain::constructInvocation(const InterpretJobAction &job,
   Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
 
   context.Args.AddAllArgs(Arguments, options::OPT_l, options::OPT_framework);
+  context.Args.AddLastArg(Arguments, options::OPT_script_cache_path);
 
   // The immediate arguments must be last.
   context.Args.AddLastArg(Arguments, options::OPT__DASH_DASH);
@@ -471,6 +633,7 @@ ToolChain::constructInvocation(const BackendJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
@@ -598,6 +761,7 @@ ToolChain::constructInvocation(const MergeModuleJobAction &job,
 
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         Arguments);
+  context.Args.AddLastArg(Arguments, options::OPT_import_objc_header);
 
   Arguments.push_back("-module-name");
   Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
@@ -664,6 +828,7 @@ ToolChain::constructInvocation(const REPLJobAction &job,
   ArgStringList FrontendArgs;
   addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
                         FrontendArgs);
+  context.Args.AddLastArg(FrontendArgs, options::OPT_import_objc_header);
   context.Args.AddAllArgs(FrontendArgs, options::OPT_l, options::OPT_framework,
                           options::OPT_L);
 
@@ -708,6 +873,31 @@ ToolChain::constructInvocation(const GenerateDSYMJobAction &job,
   return {"dsymutil", Arguments};
 }
 
+ToolChain::InvocationInfo
+ToolChain::constructInvocation(const GeneratePCHJobAction &job,
+                               const JobContext &context) const {
+  assert(context.Inputs.empty());
+  assert(context.InputActions.size() == 1);
+  assert(context.Output.getPrimaryOutputType() == types::TY_PCH);
+
+  ArgStringList Arguments;
+
+  Arguments.push_back("-frontend");
+
+  addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
+                        Arguments);
+
+  Arguments.push_back("-emit-pch");
+  Arguments.push_back("-import-objc-header");
+  addInputsOfType(Arguments, context.InputActions, types::TY_ObjCHeader);
+
+  Arguments.push_back("-o");
+  Arguments.push_back(
+      context.Args.MakeArgString(context.Output.getPrimaryOutputFilename()));
+
+  return {SWIFT_EXECUTABLE_NAME, Arguments};
+}
+
 ToolChain::InvocationInfo
 ToolChain::constructInvocation(const AutolinkExtractJobAction &job,
                                const JobContext &context) const {
@@ -773,6 +963,7 @@ static bool findXcodeClangPath(llvm::SmallVectorImpl<char> &path) {
                   [&path](sys::ProcessId PID,
                           int returnCode,
                           StringRef output,
+                          const sys::TaskResourceUsage &,
                           void *unused) -> sys::TaskFinishedResponse {
       if (returnCode == 0) {
         output = output.rtrim();
@@ -1288,6 +1479,11 @@ toolchains::GenericUnix::constructInvocation(const LinkJobAction &job,
     Arguments.push_back(context.Args.MakeArgString("-fuse-ld=" + Linker));
   }
 
+  // The objects are bitcode, which the linker has to compile.
+  if (context.Args.hasArg(options::OPT_thin_lto)) {
+    Arguments.push_back("-flto=thin");
+  }
+
   std::string Target = getTargetForLinker();
   if (!Target.empty()) {
     Arguments.push_back("-target");
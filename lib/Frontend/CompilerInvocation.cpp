@@ -167,6 +167,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.EmitSortedSIL |= Args.hasArg(OPT_emit_sorted_sil);
 
   Opts.DelayedFunctionBodyParsing |= Args.hasArg(OPT_delayed_function_body_parsing);
+  Opts.SkipNonPrimaryFunctionBodies =
+      !Args.hasArg(OPT_parse_all_function_bodies);
   Opts.EnableTesting |= Args.hasArg(OPT_enable_testing);
   Opts.EnableResilience |= Args.hasArg(OPT_enable_resilience);
 
@@ -174,6 +176,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.PrintClangStats |= Args.hasArg(OPT_print_clang_stats);
   Opts.DebugTimeFunctionBodies |= Args.hasArg(OPT_debug_time_function_bodies);
   Opts.DebugTimeCompilation |= Args.hasArg(OPT_debug_time_compilation);
+  if (const Arg *A = Args.getLastArg(OPT_stats_output_dir))
+    Opts.StatsOutputDir = A->getValue();
+  if (const Arg *A = Args.getLastArg(OPT_trace_output_dir))
+    Opts.TraceOutputDir = A->getValue();
 
   if (const Arg *A = Args.getLastArg(OPT_warn_long_function_bodies)) {
     unsigned attempt;
@@ -247,6 +253,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Action = FrontendOptions::EmitSIB;
     } else if (Opt.matches(OPT_emit_sibgen)) {
       Action = FrontendOptions::EmitSIBGen;
+    } else if (Opt.matches(OPT_emit_pch)) {
+      Action = FrontendOptions::EmitPCH;
     } else if (Opt.matches(OPT_parse)) {
       Action = FrontendOptions::Parse;
     } else if (Opt.matches(OPT_dump_parse)) {
@@ -332,6 +340,12 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Diags.diagnose(SourceLoc(), diag::error_mode_requires_one_input_file);
       return true;
     }
+  } else if (Opts.RequestedAction == FrontendOptions::EmitPCH) {
+    // The only input is the header given by -import-objc-header.
+    if (!Opts.InputFilenames.empty()) {
+      Diags.diagnose(SourceLoc(), diag::error_mode_requires_no_input_files);
+      return true;
+    }
   } else if (Opts.RequestedAction != FrontendOptions::NoneAction) {
     if (Opts.InputFilenames.empty()) {
       Diags.diagnose(SourceLoc(), diag::error_mode_requires_an_input_file);
@@ -347,6 +361,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
         Opts.ImmediateArgv.push_back(A->getValue(i));
       }
     }
+    if (const Arg *A = Args.getLastArg(OPT_script_cache_path))
+      Opts.ScriptCachePath = A->getValue();
   }
 
   if (TreatAsSIL)
@@ -400,6 +416,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     if (!Lexer::isIdentifier(ModuleName) ||
         (ModuleName == STDLIB_NAME && !Opts.ParseStdlib)) {
       if (!Opts.actionHasOutput() ||
+          Opts.RequestedAction == FrontendOptions::EmitPCH ||
           (Opts.InputKind == InputFileKind::IFK_Swift &&
            Opts.InputFilenames.size() == 1)) {
         ModuleName = "main";
@@ -486,6 +503,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::EmitObject:
       Suffix = "o";
       break;
+
+    case FrontendOptions::EmitPCH:
+      Suffix = PCH_EXTENSION;
+      break;
     }
 
     if (!Suffix.empty()) {
@@ -582,6 +603,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
                           OPT_emit_reference_dependencies,
                           OPT_emit_reference_dependencies_path,
                           "swiftdeps", false);
+  Opts.EmitYAMLReferenceDependencies |=
+    Args.hasArg(OPT_emit_yaml_reference_dependencies);
   determineOutputFilename(Opts.SerializedDiagnosticsPath,
                           OPT_serialize_diagnostics,
                           OPT_serialize_diagnostics_path,
@@ -625,6 +648,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpTypeRefinementContexts:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
+    case FrontendOptions::EmitPCH:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_dependencies);
       return true;
     case FrontendOptions::Parse:
@@ -651,6 +675,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpTypeRefinementContexts:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
+    case FrontendOptions::EmitPCH:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_header);
       return true;
     case FrontendOptions::Parse:
@@ -680,6 +705,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::EmitSILGen:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
+    case FrontendOptions::EmitPCH:
       if (!Opts.ModuleOutputPath.empty())
         Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_module);
       else
@@ -713,6 +739,12 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       !Opts.PrimaryInput && !Opts.ModuleOutputPath.empty();
   }
 
+  if (Opts.RequestedAction == FrontendOptions::EmitPCH &&
+      Opts.ImplicitObjCHeaderPath.empty()) {
+    Diags.diagnose(SourceLoc(), diag::error_mode_requires_objc_header);
+    return true;
+  }
+
   for (const Arg *A : make_range(Args.filtered_begin(OPT_import_module),
                                  Args.filtered_end())) {
     Opts.ImplicitImportModuleNames.push_back(A->getValue());
@@ -796,6 +828,17 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
 
     Opts.DebugConstraintSolverAttempt = attempt;
   }
+
+  if (const Arg *A = Args.getLastArg(OPT_debug_slowest_expressions)) {
+    unsigned limit;
+    if (StringRef(A->getValue()).getAsInteger(10, limit)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+
+    Opts.DebugSlowestExpressions = limit;
+  }
   
   if (const Arg *A = Args.getLastArg(OPT_debug_forbid_typecheck_prefix)) {
     Opts.DebugForbidTypecheckPrefix = A->getValue();
@@ -811,6 +854,17 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
     
     Opts.SolverMemoryThreshold = threshold;
   }
+
+  if (const Arg *A = Args.getLastArg(OPT_solver_state_limit)) {
+    unsigned limit;
+    if (StringRef(A->getValue()).getAsInteger(10, limit)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+
+    Opts.SolverStateLimit = limit;
+  }
   
   for (const Arg *A : make_range(Args.filtered_begin(OPT_D),
                                  Args.filtered_end())) {
@@ -890,6 +944,9 @@ static bool ParseClangImporterArgs(ClangImporterOptions &Opts,
 
   Opts.DisableSwiftBridgeAttr |= Args.hasArg(OPT_disable_swift_bridge_attr);
 
+  if (const Arg *A = Args.getLastArg(OPT_import_objc_header))
+    Opts.BridgingHeader = A->getValue();
+
   return false;
 }
 
@@ -932,6 +989,9 @@ static bool ParseSearchPathArgs(SearchPathOptions &Opts,
 
   Opts.SkipRuntimeLibraryImportPath |= Args.hasArg(OPT_nostdimport);
 
+  if (const Arg *A = Args.getLastArg(OPT_module_location_map))
+    Opts.ModuleLocationMapPath = A->getValue();
+
   // Opts.RuntimeIncludePath is set by calls to
   // setRuntimeIncludePath() or setMainExecutablePath().
   // Opts.RuntimeImportPath is set by calls to
@@ -1069,6 +1129,9 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
   Opts.EnableARCOptimizations |= !Args.hasArg(OPT_disable_arc_opts);
   Opts.DisableSILPerfOptimizations |= Args.hasArg(OPT_disable_sil_perf_optzns);
   Opts.VerifyAll |= Args.hasArg(OPT_sil_verify_all);
+  Opts.ExportSpecializations |= Args.hasArg(OPT_sil_export_specializations);
+  Opts.UseExportedSpecializations |=
+    Args.hasArg(OPT_sil_use_exported_specializations);
   Opts.DebugSerialization |= Args.hasArg(OPT_sil_debug_serialization);
   Opts.EmitVerboseSIL |= Args.hasArg(OPT_emit_verbose_sil);
   Opts.PrintInstCounts |= Args.hasArg(OPT_print_inst_counts);
@@ -1077,8 +1140,12 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
 
   Opts.GenerateProfile |= Args.hasArg(OPT_profile_generate);
   Opts.EmitProfileCoverageMapping |= Args.hasArg(OPT_profile_coverage_mapping);
+  if (const Arg *A = Args.getLastArg(OPT_profile_use))
+    Opts.UseProfile = A->getValue();
   Opts.EnableGuaranteedClosureContexts |=
     Args.hasArg(OPT_enable_guaranteed_closure_contexts);
+  Opts.AssumeSingleThreaded |= Args.hasArg(OPT_assume_single_threaded);
+  Opts.WholeProgram |= Args.hasArg(OPT_whole_program);
 
   if (Args.hasArg(OPT_debug_on_sil)) {
     // Derive the name of the SIL file for debugging from
@@ -1229,6 +1296,7 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
   Opts.PrintInlineTree |= Args.hasArg(OPT_print_llvm_inline_tree);
 
   Opts.UseSwiftCall = Args.hasArg(OPT_enable_swiftcall);
+  Opts.PrepareForThinLTO |= Args.hasArg(OPT_thin_lto);
 
   // This is set to true by default.
   Opts.UseIncrementalLLVMCodeGen &=
@@ -35,6 +35,25 @@
 
 using namespace swift;
 
+namespace {
+
+/// Skips function bodies which can't affect the output for other files, by
+/// only delaying those which may be inlined.
+class SkipNonInlinableFunctionBodies : public DelayedParsingCallbacks {
+  bool shouldDelayFunctionBodyParsing(Parser &TheParser,
+                                      AbstractFunctionDecl *AFD,
+                                      const DeclAttributes &Attrs,
+                                      SourceRange BodyRange) override {
+    if (Attrs.hasAttribute<TransparentAttr>())
+      return true;
+    if (auto *Inline = Attrs.getAttribute<InlineAttr>())
+      return Inline->getKind() == InlineKind::Always;
+    return false;
+  }
+};
+
+} // end anonymous namespace
+
 void CompilerInstance::createSILModule(bool WholeModule) {
   assert(MainModule && "main module not created yet");
   TheSILModule = SILModule::createEmptyModule(getMainModule(),
@@ -52,16 +71,13 @@ void CompilerInstance::setPrimarySourceFile(SourceFile *SF) {
   PrimarySourceFile->setReferencedNameTracker(NameTracker);
 }
 
-bool CompilerInstance::setup(const CompilerInvocation &Invok) {
-  Invocation = Invok;
-
+bool CompilerInstance::setUpASTContext() {
   // Honor -Xllvm.
-  if (!Invok.getFrontendOptions().LLVMArgs.empty()) {
+  if (!Invocation.getFrontendOptions().LLVMArgs.empty()) {
     llvm::SmallVector<const char *, 4> Args;
     Args.push_back("swift (LLVM option parsing)");
-    for (unsigned i = 0, e = Invok.getFrontendOptions().LLVMArgs.size(); i != e;
-         ++i)
-      Args.push_back(Invok.getFrontendOptions().LLVMArgs[i].c_str());
+    for (auto &Arg : Invocation.getFrontendOptions().LLVMArgs)
+      Args.push_back(Arg.c_str());
     Args.push_back(nullptr);
     llvm::cl::ParseCommandLineOptions(Args.size()-1, Args.data());
   }
@@ -110,6 +126,39 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   }
 
   Context->addModuleLoader(std::move(clangImporter), /*isClang*/true);
+  return false;
+}
+
+bool CompilerInstance::prepareASTContext(const CompilerInvocation &Invok) {
+  assert(!Context && "already set up");
+  Invocation = Invok;
+  if (setUpASTContext())
+    return true;
+
+  // Mirror performSema(), which loads the standard library before anything
+  // else that touches the ASTContext.
+  if (Invocation.getInputKind() == InputFileKind::IFK_Swift &&
+      !Invocation.getParseStdlib()) {
+    ModuleDecl *M = Context->getStdlibModule(true);
+    if (!M || M->failedToLoad())
+      return true;
+  }
+  return Diagnostics.hadAnyError();
+}
+
+bool CompilerInstance::setup(const CompilerInvocation &Invok) {
+  Invocation = Invok;
+
+  if (!Context) {
+    if (setUpASTContext())
+      return true;
+  } else {
+    // The ASTContext was created by prepareASTContext(), which has already
+    // applied the options that setUpASTContext() looks at; only the ones
+    // tied to the outputs need to be set again.
+    if (!Invocation.getFrontendOptions().ModuleDocOutputPath.empty())
+      Invocation.getLangOptions().AttachCommentsToDecls = true;
+  }
 
   assert(Lexer::isIdentifier(Invocation.getModuleName()));
 
@@ -383,6 +432,19 @@ void CompilerInstance::performSema() {
     DelayedCB.reset(new AlwaysDelayedCallbacks);
   }
 
+  // Only the primary file's function bodies are type-checked, so the others
+  // are just lexed to find where they end.
+  std::unique_ptr<DelayedParsingCallbacks> NonPrimaryDelayedCB;
+  if (!DelayedCB && PrimaryBufferID != NO_SUCH_BUFFER &&
+      options.SkipNonPrimaryFunctionBodies) {
+    NonPrimaryDelayedCB.reset(new SkipNonInlinableFunctionBodies);
+  }
+  auto getDelayedCB = [&](unsigned BufferID) -> DelayedParsingCallbacks * {
+    if (NonPrimaryDelayedCB && BufferID != PrimaryBufferID)
+      return NonPrimaryDelayedCB.get();
+    return DelayedCB.get();
+  };
+
   PersistentParserState PersistentState;
 
   // Make sure the main file is the first file in the module. This may only be
@@ -441,7 +503,7 @@ void CompilerInstance::performSema() {
       // Parser may stop at some erroneous constructions like #else, #endif
       // or '}' in some cases, continue parsing until we are done
       parseIntoSourceFile(*NextInput, BufferID, &Done, nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState, getDelayedCB(BufferID));
     } while (!Done);
 
     Diags.setSuppressWarnings(DidSuppressWarnings);
@@ -494,7 +556,7 @@ void CompilerInstance::performSema() {
       // with 'sil' definitions.
       parseIntoSourceFile(MainFile, MainFile.getBufferID().getValue(), &Done,
                           TheSILModule ? &SILContext : nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState, getDelayedCB(MainBufferID));
       if (mainIsPrimary) {
         performTypeChecking(MainFile, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, CurTUElem,
@@ -525,7 +587,7 @@ void CompilerInstance::performSema() {
   if (auto *stdlib = Context->getStdlibModule())
     Context->recordKnownProtocols(stdlib);
 
-  if (DelayedCB) {
+  if (DelayedCB || NonPrimaryDelayedCB) {
     performDelayedParsing(MainModule, PersistentState,
                           Invocation.getCodeCompletionFactory());
   }
@@ -39,6 +39,7 @@ bool FrontendOptions::actionHasOutput() const {
   case EmitIR:
   case EmitBC:
   case EmitObject:
+  case EmitPCH:
     return true;
   }
   llvm_unreachable("Unknown ActionType");
@@ -66,6 +67,7 @@ bool FrontendOptions::actionIsImmediate() const {
   case EmitIR:
   case EmitBC:
   case EmitObject:
+  case EmitPCH:
     return false;
   }
   llvm_unreachable("Unknown ActionType");
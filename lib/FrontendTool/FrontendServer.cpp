@@ -0,0 +1,719 @@
+//===--- FrontendServer.cpp - Long-lived frontend process -----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A job is sent as a length-prefixed message holding the client's executable
+// path, working directory, arguments and environment, with the client's
+// standard input, output and error passed alongside it as file descriptors.
+// The reply says whether the job was run and, if so, how its process ended.
+//
+// The server hands each job to the prepared process for its key, if there is
+// one, by sending the same message over a socket pair with the connection to
+// the client as a fourth descriptor. The prepared process forks a handler,
+// which forks the process that runs the job, waits for it and replies.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/FrontendTool/FrontendServer.h"
+#include "swift/AST/ASTContext.h"
+#include "swift/AST/ModuleLoader.h"
+#include "swift/Basic/DiagnosticConsumer.h"
+#include "swift/Frontend/Frontend.h"
+#include "swift/FrontendTool/FrontendTool.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Config/config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+#include <vector>
+
+#if LLVM_ON_UNIX
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <crt_externs.h>
+#else
+extern char **environ;
+#endif
+#endif
+
+using namespace swift;
+
+#if LLVM_ON_UNIX
+
+namespace {
+
+/// A frontend job, as sent by forwardToFrontendServer().
+struct FrontendJob {
+  std::string ExecutablePath;
+  std::string WorkingDirectory;
+  std::vector<std::string> Args;
+  std::vector<std::string> Environment;
+
+  /// The job's standard input, output and error, followed by the connection
+  /// to the client when the job is handed to a prepared process.
+  SmallVector<int, 4> Fds;
+
+  void closeFds() {
+    for (int Fd : Fds)
+      close(Fd);
+    Fds.clear();
+  }
+
+  std::vector<const char *> getArgs() const {
+    std::vector<const char *> Result;
+    for (auto &Arg : Args)
+      Result.push_back(Arg.c_str());
+    return Result;
+  }
+};
+
+/// How a job ended, as sent back to the client.
+enum class JobStatus : uint32_t {
+  /// The job wasn't run; the client should run it itself.
+  Declined,
+  /// The job's process exited; the value is its exit status.
+  Exited,
+  /// The job's process was killed; the value is the signal.
+  Signalled
+};
+
+} // end anonymous namespace
+
+/// Guards against talking to something other than a server of the same
+/// version.
+static const uint32_t ProtocolSignature = 0x53574653; // "SWFS"
+static const uint32_t ProtocolVersion = 1;
+
+/// The most descriptors ever sent with a job.
+static const unsigned MaxJobFds = 4;
+
+/// An upper bound on the size of a job, to catch garbage.
+static const uint32_t MaxJobSize = 64 * 1024 * 1024;
+
+/// How many keys get a prepared process; jobs for any others are run the
+/// same way as jobs that can't use one.
+static const unsigned MaxPreparedProcesses = 16;
+
+static bool writeAll(int Fd, const char *Data, size_t Size) {
+  while (Size) {
+    ssize_t Written = write(Fd, Data, Size);
+    if (Written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    Data += Written;
+    Size -= Written;
+  }
+  return true;
+}
+
+static bool readAll(int Fd, char *Data, size_t Size) {
+  while (Size) {
+    ssize_t Read = read(Fd, Data, Size);
+    if (Read < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    if (Read == 0)
+      return false;
+    Data += Read;
+    Size -= Read;
+  }
+  return true;
+}
+
+static void appendInt(std::string &Buffer, uint32_t Value) {
+  Buffer.append(reinterpret_cast<const char *>(&Value), sizeof(Value));
+}
+
+static void appendString(std::string &Buffer, StringRef String) {
+  appendInt(Buffer, String.size());
+  Buffer.append(String.data(), String.size());
+}
+
+static void appendStrings(std::string &Buffer,
+                          const std::vector<std::string> &Strings) {
+  appendInt(Buffer, Strings.size());
+  for (auto &String : Strings)
+    appendString(Buffer, String);
+}
+
+static bool takeInt(StringRef &Buffer, uint32_t &Value) {
+  if (Buffer.size() < sizeof(Value))
+    return false;
+  memcpy(&Value, Buffer.data(), sizeof(Value));
+  Buffer = Buffer.drop_front(sizeof(Value));
+  return true;
+}
+
+static bool takeString(StringRef &Buffer, std::string &String) {
+  uint32_t Size;
+  if (!takeInt(Buffer, Size) || Buffer.size() < Size)
+    return false;
+  String = Buffer.substr(0, Size).str();
+  Buffer = Buffer.drop_front(Size);
+  return true;
+}
+
+static bool takeStrings(StringRef &Buffer, std::vector<std::string> &Strings) {
+  uint32_t Count;
+  if (!takeInt(Buffer, Count) || Count > Buffer.size())
+    return false;
+  Strings.resize(Count);
+  for (auto &String : Strings)
+    if (!takeString(Buffer, String))
+      return false;
+  return true;
+}
+
+/// Sends \p Job over \p Socket, along with its descriptors.
+static bool sendJob(int Socket, const FrontendJob &Job) {
+  assert(Job.Fds.size() <= MaxJobFds);
+
+  std::string Body;
+  appendInt(Body, ProtocolSignature);
+  appendInt(Body, ProtocolVersion);
+  appendString(Body, Job.ExecutablePath);
+  appendString(Body, Job.WorkingDirectory);
+  appendStrings(Body, Job.Args);
+  appendStrings(Body, Job.Environment);
+
+  std::string Message;
+  appendInt(Message, Body.size());
+  Message += Body;
+
+  // The descriptors go with the first byte, and the rest follows.
+  struct iovec IOV;
+  IOV.iov_base = &Message[0];
+  IOV.iov_len = 1;
+  char Control[CMSG_SPACE(sizeof(int) * MaxJobFds)];
+  memset(Control, 0, sizeof(Control));
+  struct msghdr Header;
+  memset(&Header, 0, sizeof(Header));
+  Header.msg_iov = &IOV;
+  Header.msg_iovlen = 1;
+  Header.msg_control = Control;
+  Header.msg_controllen = CMSG_SPACE(sizeof(int) * Job.Fds.size());
+  struct cmsghdr *ControlHeader = CMSG_FIRSTHDR(&Header);
+  ControlHeader->cmsg_level = SOL_SOCKET;
+  ControlHeader->cmsg_type = SCM_RIGHTS;
+  ControlHeader->cmsg_len = CMSG_LEN(sizeof(int) * Job.Fds.size());
+  memcpy(CMSG_DATA(ControlHeader), Job.Fds.data(),
+         sizeof(int) * Job.Fds.size());
+
+  ssize_t Sent;
+  do {
+    Sent = sendmsg(Socket, &Header, 0);
+  } while (Sent < 0 && errno == EINTR);
+  if (Sent != 1)
+    return false;
+  return writeAll(Socket, Message.data() + 1, Message.size() - 1);
+}
+
+/// Receives a job sent by sendJob() over \p Socket.
+///
+/// Any descriptors that came with it are left in \p Job even if the job
+/// turns out to be malformed, so that the caller can close them.
+static bool receiveJob(int Socket, FrontendJob &Job) {
+  char Size[sizeof(uint32_t)];
+  struct iovec IOV;
+  IOV.iov_base = Size;
+  IOV.iov_len = 1;
+  char Control[CMSG_SPACE(sizeof(int) * MaxJobFds)];
+  struct msghdr Header;
+  memset(&Header, 0, sizeof(Header));
+  Header.msg_iov = &IOV;
+  Header.msg_iovlen = 1;
+  Header.msg_control = Control;
+  Header.msg_controllen = sizeof(Control);
+
+  ssize_t Received;
+  do {
+    Received = recvmsg(Socket, &Header, 0);
+  } while (Received < 0 && errno == EINTR);
+  if (Received != 1)
+    return false;
+
+  for (struct cmsghdr *ControlHeader = CMSG_FIRSTHDR(&Header); ControlHeader;
+       ControlHeader = CMSG_NXTHDR(&Header, ControlHeader)) {
+    if (ControlHeader->cmsg_level != SOL_SOCKET ||
+        ControlHeader->cmsg_type != SCM_RIGHTS)
+      continue;
+    size_t Count = (ControlHeader->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    const char *Data = reinterpret_cast<const char *>(CMSG_DATA(ControlHeader));
+    for (size_t i = 0; i != Count; ++i) {
+      int Fd;
+      memcpy(&Fd, Data + i * sizeof(int), sizeof(int));
+      Job.Fds.push_back(Fd);
+    }
+  }
+  if (Header.msg_flags & MSG_CTRUNC)
+    return false;
+
+  uint32_t BodySize;
+  if (!readAll(Socket, Size + 1, sizeof(Size) - 1))
+    return false;
+  memcpy(&BodySize, Size, sizeof(BodySize));
+  if (BodySize > MaxJobSize)
+    return false;
+  std::string Body(BodySize, '\0');
+  if (!readAll(Socket, &Body[0], BodySize))
+    return false;
+
+  StringRef Buffer = Body;
+  uint32_t Signature, Version;
+  return takeInt(Buffer, Signature) && Signature == ProtocolSignature &&
+         takeInt(Buffer, Version) && Version == ProtocolVersion &&
+         takeString(Buffer, Job.ExecutablePath) &&
+         takeString(Buffer, Job.WorkingDirectory) &&
+         takeStrings(Buffer, Job.Args) &&
+         takeStrings(Buffer, Job.Environment) && Buffer.empty();
+}
+
+static bool sendStatus(int Socket, JobStatus Status, int32_t Value) {
+  std::string Message;
+  appendInt(Message, uint32_t(Status));
+  appendInt(Message, uint32_t(Value));
+  return writeAll(Socket, Message.data(), Message.size());
+}
+
+static bool receiveStatus(int Socket, JobStatus &Status, int32_t &Value) {
+  char Message[2 * sizeof(uint32_t)];
+  if (!readAll(Socket, Message, sizeof(Message)))
+    return false;
+  uint32_t RawStatus;
+  memcpy(&RawStatus, Message, sizeof(RawStatus));
+  memcpy(&Value, Message + sizeof(RawStatus), sizeof(Value));
+  if (RawStatus > uint32_t(JobStatus::Signalled))
+    return false;
+  Status = JobStatus(RawStatus);
+  return true;
+}
+
+static char **&getEnviron() {
+#if defined(__APPLE__)
+  return *_NSGetEnviron();
+#else
+  return environ;
+#endif
+}
+
+/// Gives this process the working directory and environment of \p Job, and,
+/// if \p RedirectStreams is set, its standard streams.
+///
+/// The environment points into \p Job, which must outlive any use of it.
+static bool enterJob(const FrontendJob &Job, bool RedirectStreams) {
+  static std::vector<char *> Environment;
+  Environment.clear();
+  for (auto &Entry : Job.Environment)
+    Environment.push_back(const_cast<char *>(Entry.c_str()));
+  Environment.push_back(nullptr);
+  getEnviron() = Environment.data();
+
+  if (chdir(Job.WorkingDirectory.c_str()) != 0)
+    return false;
+
+  if (RedirectStreams) {
+    for (int Fd = 0; Fd != 3; ++Fd)
+      if (dup2(Job.Fds[Fd], Fd) < 0)
+        return false;
+  }
+  return true;
+}
+
+/// Runs \p Job in a process forked from this one, using \p Prepared if it is
+/// given, and tells the client on \p Client how the process ended.
+LLVM_ATTRIBUTE_NORETURN
+static void handleJob(const FrontendJob &Job, int Client,
+                      CompilerInstance *Prepared,
+                      const char *Argv0, void *MainAddr) {
+  signal(SIGCHLD, SIG_DFL);
+
+  pid_t Worker = fork();
+  if (Worker == 0) {
+    close(Client);
+    if (!enterJob(Job, /*RedirectStreams=*/true))
+      _exit(127);
+
+    std::vector<const char *> Args = Job.getArgs();
+    int Result = Prepared ? performFrontend(*Prepared, Args, Argv0, MainAddr)
+                          : performFrontend(Args, Argv0, MainAddr);
+    llvm::outs().flush();
+    llvm::errs().flush();
+    llvm::llvm_shutdown();
+    exit(Result);
+  }
+
+  // If the process couldn't be started, the client can still run the job.
+  JobStatus Status = JobStatus::Declined;
+  int Value = 0;
+  int WaitStatus;
+  if (Worker > 0) {
+    pid_t Waited;
+    do {
+      Waited = waitpid(Worker, &WaitStatus, 0);
+    } while (Waited < 0 && errno == EINTR);
+    if (Waited == Worker && WIFEXITED(WaitStatus)) {
+      Status = JobStatus::Exited;
+      Value = WEXITSTATUS(WaitStatus);
+    } else if (Waited == Worker && WIFSIGNALED(WaitStatus)) {
+      Status = JobStatus::Signalled;
+      Value = WTERMSIG(WaitStatus);
+    }
+  }
+  sendStatus(Client, Status, Value);
+  _exit(0);
+}
+
+namespace {
+/// Notes whether any diagnostic was emitted while preparing.
+class RecordingDiagnosticConsumer : public DiagnosticConsumer {
+public:
+  bool HadDiagnostics = false;
+
+  void handleDiagnostic(SourceManager &SM, SourceLoc Loc,
+                        DiagnosticKind Kind, StringRef Text,
+                        const DiagnosticInfo &Info) override {
+    HadDiagnostics = true;
+  }
+};
+} // end anonymous namespace
+
+/// Returns true if a module named \p Name is already loaded into \p Context,
+/// in which case the module built by a job of that name would clash with it.
+static bool isModuleLoaded(ASTContext &Context, StringRef Name) {
+  for (auto &Entry : Context.LoadedModules)
+    if (Entry.first.str() == Name)
+      return true;
+  return false;
+}
+
+/// The body of a prepared process: sets up a CompilerInstance for the
+/// options of \p First, says whether that worked on \p Control, and then
+/// runs each job that arrives on \p Control.
+///
+/// Anything that would be printed while preparing would be missing from the
+/// output of later jobs, so any diagnostic counts as a failure.
+LLVM_ATTRIBUTE_NORETURN
+static void runPreparedProcess(const FrontendJob &First, int Control,
+                               const char *Argv0, void *MainAddr) {
+  CompilerInstance Instance;
+  RecordingDiagnosticConsumer Recorder;
+  Instance.addDiagnosticConsumer(&Recorder);
+
+  CompilerInvocation Invocation;
+  Invocation.setMainExecutablePath(
+      llvm::sys::fs::getMainExecutable(Argv0, MainAddr));
+
+  DependencyTracker Tracker;
+  bool Failed = !enterJob(First, /*RedirectStreams=*/false);
+  if (!Failed) {
+    SmallString<128> WorkingDirectory;
+    llvm::sys::fs::current_path(WorkingDirectory);
+    Failed = Invocation.parseArgs(First.getArgs(), Instance.getDiags(),
+                                  WorkingDirectory);
+  }
+  if (!Failed) {
+    const FrontendOptions &Opts = Invocation.getFrontendOptions();
+    if (!Opts.DependenciesFilePath.empty() ||
+        !Opts.ReferenceDependenciesFilePath.empty())
+      Instance.setDependencyTracker(&Tracker);
+    Failed = Instance.prepareASTContext(Invocation) ||
+             Recorder.HadDiagnostics ||
+             isModuleLoaded(Instance.getASTContext(),
+                            Invocation.getModuleName());
+  }
+
+  char Ready = !Failed;
+  if (!writeAll(Control, &Ready, 1) || Failed)
+    _exit(1);
+
+  // Handlers are never waited for.
+  signal(SIGCHLD, SIG_IGN);
+
+  while (true) {
+    FrontendJob Job;
+    if (!receiveJob(Control, Job)) {
+      if (Job.Fds.empty())
+        break;
+      Job.closeFds();
+      continue;
+    }
+    if (Job.Fds.size() == 4) {
+      if (fork() == 0) {
+        close(Control);
+        handleJob(Job, Job.Fds[3], &Instance, Argv0, MainAddr);
+      }
+    }
+    Job.closeFds();
+  }
+  _exit(0);
+}
+
+/// Starts a prepared process for the options of \p Job.
+///
+/// \returns the socket to send its jobs over, or -1 if the options couldn't
+/// be prepared
+static int startPreparedProcess(const FrontendJob &Job, int Listener,
+                                const llvm::StringMap<int> &Others,
+                                const char *Argv0, void *MainAddr) {
+  int Sockets[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, Sockets) != 0)
+    return -1;
+
+  pid_t Child = fork();
+  if (Child == 0) {
+    // Keep only what the prepared process needs, so that the others see the
+    // end of their sockets when the server closes them.
+    close(Sockets[0]);
+    close(Listener);
+    for (auto &Entry : Others)
+      if (Entry.second >= 0)
+        close(Entry.second);
+    for (int Fd : Job.Fds)
+      close(Fd);
+    runPreparedProcess(Job, Sockets[1], Argv0, MainAddr);
+  }
+  close(Sockets[1]);
+
+  char Ready = 0;
+  if (Child < 0 || !readAll(Sockets[0], &Ready, 1) || !Ready) {
+    close(Sockets[0]);
+    return -1;
+  }
+  return Sockets[0];
+}
+
+static bool getExecutableStatus(StringRef Path,
+                                llvm::sys::fs::file_status &Status) {
+  return !llvm::sys::fs::status(Path, Status);
+}
+
+static bool fillSocketAddress(StringRef Path, struct sockaddr_un &Address) {
+  memset(&Address, 0, sizeof(Address));
+  Address.sun_family = AF_UNIX;
+  if (Path.size() >= sizeof(Address.sun_path))
+    return false;
+  memcpy(Address.sun_path, Path.data(), Path.size());
+  return true;
+}
+
+int swift::runFrontendServer(StringRef SocketPath, unsigned IdleTimeout,
+                             const char *Argv0, void *MainAddr) {
+  std::string ExecutablePath =
+      llvm::sys::fs::getMainExecutable(Argv0, MainAddr);
+  // A server whose executable was replaced would give different output from
+  // the new one, so it stops as soon as it notices.
+  llvm::sys::fs::file_status ExecutableStatus;
+  if (!getExecutableStatus(ExecutablePath, ExecutableStatus)) {
+    llvm::errs() << "error: couldn't find the frontend executable\n";
+    return 1;
+  }
+
+  std::string Path = SocketPath.str();
+  struct sockaddr_un Address;
+  if (!fillSocketAddress(Path, Address)) {
+    llvm::errs() << "error: socket path is too long: " << Path << '\n';
+    return 1;
+  }
+
+  int Listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(Path.c_str());
+  if (Listener < 0 ||
+      bind(Listener, reinterpret_cast<struct sockaddr *>(&Address),
+           sizeof(Address)) != 0 ||
+      listen(Listener, SOMAXCONN) != 0) {
+    llvm::errs() << "error: couldn't listen on " << Path << ": "
+                 << strerror(errno) << '\n';
+    if (Listener >= 0)
+      close(Listener);
+    return 1;
+  }
+
+  // Clients and prepared processes can go away at any point; handlers are
+  // never waited for.
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGCHLD, SIG_IGN);
+
+  // The socket of the prepared process for each key, or -1 if the options
+  // for that key couldn't be prepared.
+  llvm::StringMap<int> PreparedProcesses;
+
+  while (true) {
+    struct pollfd Poll = { Listener, POLLIN, 0 };
+    int Ready = poll(&Poll, 1, IdleTimeout * 1000);
+    if (Ready < 0 && errno == EINTR)
+      continue;
+    if (Ready <= 0)
+      break;
+
+    int Client = accept(Listener, nullptr, nullptr);
+    if (Client < 0)
+      continue;
+
+    FrontendJob Job;
+    if (!receiveJob(Client, Job) || Job.Fds.size() != 3) {
+      Job.closeFds();
+      close(Client);
+      continue;
+    }
+
+    llvm::sys::fs::file_status CurrentStatus;
+    bool ExecutableChanged =
+        !getExecutableStatus(ExecutablePath, CurrentStatus) ||
+        CurrentStatus.getLastModificationTime() !=
+            ExecutableStatus.getLastModificationTime() ||
+        CurrentStatus.getSize() != ExecutableStatus.getSize();
+    if (ExecutableChanged || Job.ExecutablePath != ExecutablePath) {
+      sendStatus(Client, JobStatus::Declined, 0);
+      Job.closeFds();
+      close(Client);
+      if (ExecutableChanged)
+        break;
+      continue;
+    }
+
+    // A prepared process has taken on the job's working directory and
+    // environment, since both can affect how the ASTContext is set up.
+    std::string Key = getPreparedContextKey(Job.getArgs());
+    if (!Key.empty()) {
+      Key += '\0';
+      Key += Job.WorkingDirectory;
+      for (auto &Entry : Job.Environment) {
+        Key += '\0';
+        Key += Entry;
+      }
+
+      auto Found = PreparedProcesses.find(Key);
+      if (Found == PreparedProcesses.end() &&
+          PreparedProcesses.size() < MaxPreparedProcesses) {
+        int Control = startPreparedProcess(Job, Listener, PreparedProcesses,
+                                           Argv0, MainAddr);
+        Found = PreparedProcesses.insert({Key, Control}).first;
+      }
+
+      if (Found != PreparedProcesses.end() && Found->second >= 0) {
+        Job.Fds.push_back(Client);
+        bool Sent = sendJob(Found->second, Job);
+        Job.closeFds();
+        if (Sent)
+          continue;
+
+        // The prepared process has gone away. The client sees its
+        // connection closed and runs the job itself.
+        close(Found->second);
+        PreparedProcesses.erase(Found);
+        continue;
+      }
+    }
+
+    if (fork() == 0) {
+      close(Listener);
+      for (auto &Entry : PreparedProcesses)
+        if (Entry.second >= 0)
+          close(Entry.second);
+      handleJob(Job, Client, nullptr, Argv0, MainAddr);
+    }
+    Job.closeFds();
+    close(Client);
+  }
+
+  close(Listener);
+  unlink(Path.c_str());
+  for (auto &Entry : PreparedProcesses)
+    if (Entry.second >= 0)
+      close(Entry.second);
+  return 0;
+}
+
+bool swift::forwardToFrontendServer(StringRef SocketPath,
+                                    ArrayRef<const char *> Args,
+                                    const char *Argv0, void *MainAddr,
+                                    int &Result) {
+  struct sockaddr_un Address;
+  if (!fillSocketAddress(SocketPath, Address))
+    return false;
+
+  int Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Socket < 0)
+    return false;
+  if (connect(Socket, reinterpret_cast<struct sockaddr *>(&Address),
+              sizeof(Address)) != 0) {
+    close(Socket);
+    return false;
+  }
+
+  FrontendJob Job;
+  Job.ExecutablePath = llvm::sys::fs::getMainExecutable(Argv0, MainAddr);
+  SmallString<128> WorkingDirectory;
+  llvm::sys::fs::current_path(WorkingDirectory);
+  Job.WorkingDirectory = WorkingDirectory.str();
+  for (const char *Arg : Args)
+    Job.Args.push_back(Arg);
+  for (char **Entry = getEnviron(); *Entry; ++Entry)
+    Job.Environment.push_back(*Entry);
+  for (int Fd : { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO })
+    Job.Fds.push_back(Fd);
+
+  // A server that goes away mustn't take this process with it.
+  auto OldHandler = signal(SIGPIPE, SIG_IGN);
+  JobStatus Status;
+  int32_t Value;
+  bool Finished = sendJob(Socket, Job) && receiveStatus(Socket, Status, Value);
+  signal(SIGPIPE, OldHandler);
+  close(Socket);
+
+  // If the server went away before the job finished, whatever the job did
+  // is redone from scratch.
+  if (!Finished || Status == JobStatus::Declined)
+    return false;
+
+  if (Status == JobStatus::Signalled) {
+    signal(Value, SIG_DFL);
+    raise(Value);
+    Result = 128 + Value;
+    return true;
+  }
+  Result = Value;
+  return true;
+}
+
+#else
+
+int swift::runFrontendServer(StringRef SocketPath, unsigned IdleTimeout,
+                             const char *Argv0, void *MainAddr) {
+  llvm::errs() << "error: the frontend server is not supported on this "
+                  "platform\n";
+  return 1;
+}
+
+bool swift::forwardToFrontendServer(StringRef SocketPath,
+                                    ArrayRef<const char *> Args,
+                                    const char *Argv0, void *MainAddr,
+                                    int &Result) {
+  return false;
+}
+
+#endif
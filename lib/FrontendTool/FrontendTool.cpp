@@ -23,6 +23,7 @@
 #include "swift/FrontendTool/FrontendTool.h"
 
 #include "swift/Subsystems.h"
+#include "swift/AST/ASTWalker.h"
 #include "swift/AST/DiagnosticsFrontend.h"
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/AST/IRGenOptions.h"
@@ -33,14 +34,19 @@
 #include "swift/Basic/Dwarf.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/FileSystem.h"
+#include "swift/Basic/ReferenceDependencies.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/Basic/Timer.h"
+#include "swift/Basic/TraceEvents.h"
+#include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Frontend/DiagnosticVerifier.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/Frontend/SerializedDiagnosticConsumer.h"
 #include "swift/Immediate/Immediate.h"
 #include "swift/Option/Options.h"
+#include "swift/Parse/Lexer.h"
 #include "swift/PrintAsObjC/PrintAsObjC.h"
 #include "swift/Serialization/SerializationOptions.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
@@ -53,9 +59,11 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IRReader/IRReader.h"
+#include "llvm/Option/ArgList.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/TargetSelect.h"
@@ -180,6 +188,209 @@ static std::string mangleTypeAsContext(const NominalTypeDecl *type) {
   return mangler.finalize();
 }
 
+namespace {
+/// Writes the entries of a Swift-style dependencies file, either in the
+/// binary form that the driver reads or as YAML.
+class ReferenceDependenciesEmitter {
+  raw_ostream &out;
+  bool emitYAML;
+  reference_dependencies::Writer writer;
+  reference_dependencies::Section currentSection;
+
+  /// In YAML, the last entry as it was written, and the fingerprints of
+  /// the "provides" entries, which are written in a section of their own
+  /// after the last of those.
+  std::string lastYAMLEntry;
+  std::string yamlFingerprints;
+
+  void beginYAMLEntry(bool isCascading) {
+    out << "- ";
+    if (!isCascading)
+      out << "!private ";
+  }
+
+  void flushYAMLFingerprints() {
+    using reference_dependencies::Section;
+    if (yamlFingerprints.empty())
+      return;
+    out << reference_dependencies::getYAMLKey(Section::ProvidesFingerprint)
+        << ":\n" << yamlFingerprints;
+    yamlFingerprints.clear();
+  }
+
+public:
+  ReferenceDependenciesEmitter(raw_ostream &out, bool emitYAML)
+      : out(out), emitYAML(emitYAML) {
+    if (emitYAML)
+      out << "### Swift dependencies file v0 ###\n";
+  }
+
+  /// Starts the section that the following entries belong to.
+  void beginSection(reference_dependencies::Section section) {
+    using reference_dependencies::Section;
+    currentSection = section;
+    if (!emitYAML)
+      return;
+    // The "provides" sections come first.
+    if (section > Section::ProvidesDynamicLookup)
+      flushYAMLFingerprints();
+    out << reference_dependencies::getYAMLKey(section) << ":\n";
+  }
+
+  void addName(StringRef name, bool isCascading = true) {
+    if (!emitYAML) {
+      writer.addEntry(currentSection, name, isCascading);
+      return;
+    }
+    beginYAMLEntry(isCascading);
+    lastYAMLEntry = "\"" + llvm::yaml::escape(name) + "\"";
+    out << lastYAMLEntry << "\n";
+  }
+
+  void addMember(StringRef baseName, StringRef memberName,
+                 bool isCascading = true) {
+    if (!emitYAML) {
+      writer.addMemberEntry(currentSection, baseName, memberName,
+                            isCascading);
+      return;
+    }
+    beginYAMLEntry(isCascading);
+    lastYAMLEntry = "\"" + llvm::yaml::escape(baseName) + "\", \"" +
+                    llvm::yaml::escape(memberName) + "\"";
+    out << "[" << lastYAMLEntry << "]\n";
+  }
+
+  /// Records the fingerprint of the "provides" entry added last. An empty
+  /// fingerprint means the entry has none, and is always considered to
+  /// have changed.
+  void addFingerprint(StringRef fingerprint) {
+    if (fingerprint.empty())
+      return;
+    if (!emitYAML) {
+      writer.addFingerprint(fingerprint);
+      return;
+    }
+    yamlFingerprints += "- [";
+    yamlFingerprints += fingerprint;
+    yamlFingerprints += ", ";
+    yamlFingerprints += reference_dependencies::getYAMLKey(currentSection);
+    yamlFingerprints += ", ";
+    yamlFingerprints += lastYAMLEntry;
+    yamlFingerprints += "]\n";
+  }
+
+  void addInterfaceHash(StringRef hash) {
+    using reference_dependencies::Section;
+    if (!emitYAML) {
+      writer.addEntry(Section::InterfaceHash, hash);
+      return;
+    }
+    out << reference_dependencies::getYAMLKey(Section::InterfaceHash)
+        << ": \"" << hash << "\"\n";
+  }
+
+  /// Writes out the binary form, once all of the entries have been added.
+  void finish() {
+    if (emitYAML)
+      flushYAMLFingerprints();
+    else
+      writer.write(out);
+  }
+};
+
+/// Finds the bodies of the functions and accessors within a declaration.
+class FunctionBodyFinder : public ASTWalker {
+public:
+  SmallVector<SourceRange, 8> Bodies;
+
+  bool walkToDeclPre(Decl *D) override {
+    if (auto *AFD = dyn_cast<AbstractFunctionDecl>(D)) {
+      SourceRange body = AFD->getBodySourceRange();
+      if (body.isValid())
+        Bodies.push_back(body);
+      return false;
+    }
+    if (auto *ASD = dyn_cast<AbstractStorageDecl>(D)) {
+      for (FuncDecl *accessor : { ASD->getGetter(), ASD->getSetter(),
+                                  ASD->getWillSetFunc(),
+                                  ASD->getDidSetFunc() }) {
+        if (accessor)
+          walkToDeclPre(accessor);
+      }
+    }
+    return true;
+  }
+};
+} // end anonymous namespace
+
+/// Computes a fingerprint of the parts of \p D that other files can depend
+/// on: the tokens of the declaration and its attributes, other than those in
+/// the bodies of functions.
+///
+/// \returns an empty string if \p D has no source to fingerprint.
+static std::string getDeclFingerprint(const Decl *D) {
+  // The type of a variable is spelled out in its pattern binding.
+  const Decl *spelling = D;
+  if (auto *VD = dyn_cast<VarDecl>(D))
+    spelling = VD->getParentPatternBinding();
+  if (!spelling || spelling->isImplicit())
+    return std::string();
+  SourceRange range = spelling->getSourceRange();
+  if (range.isInvalid())
+    return std::string();
+
+  ASTContext &ctx = D->getASTContext();
+  SourceManager &SM = ctx.SourceMgr;
+  for (auto *attr : D->getAttrs()) {
+    SourceRange attrRange = attr->getRangeWithAt();
+    if (attrRange.isValid() && SM.isBeforeInBuffer(attrRange.Start,
+                                                   range.Start)) {
+      range.Start = attrRange.Start;
+    }
+  }
+
+  unsigned bufferID = SM.findBufferContainingLoc(range.Start);
+  auto getOffset = [&](SourceLoc loc) -> unsigned {
+    return SM.getLocOffsetInBuffer(loc, bufferID);
+  };
+
+  FunctionBodyFinder finder;
+  const_cast<Decl *>(D)->walk(finder);
+  SmallVector<std::pair<unsigned, unsigned>, 8> bodies;
+  for (SourceRange body : finder.Bodies) {
+    CharSourceRange bodyChars =
+        Lexer::getCharSourceRangeFromSourceRange(SM, body);
+    bodies.push_back({getOffset(bodyChars.getStart()),
+                      getOffset(bodyChars.getEnd())});
+  }
+
+  CharSourceRange chars = Lexer::getCharSourceRangeFromSourceRange(SM, range);
+  std::vector<Token> tokens =
+      tokenize(ctx.LangOpts, SM, bufferID, getOffset(chars.getStart()),
+               getOffset(chars.getEnd()), /*KeepComments=*/false,
+               /*TokenizeInterpolatedString=*/false);
+
+  llvm::MD5 hash;
+  for (const Token &tok : tokens) {
+    unsigned offset = getOffset(tok.getLoc());
+    bool inBody = std::any_of(bodies.begin(), bodies.end(),
+                              [offset](std::pair<unsigned, unsigned> body) {
+      return offset >= body.first && offset < body.second;
+    });
+    if (inBody)
+      continue;
+    // Keep "a b" and "ab" apart.
+    hash.update(tok.getText());
+    hash.update(StringRef("", 1));
+  }
+
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+  SmallString<32> fingerprint;
+  llvm::MD5::stringifyResult(result, fingerprint);
+  return fingerprint.str().str();
+}
+
 /// Emits a Swift-style dependencies file.
 static bool emitReferenceDependencies(DiagnosticEngine &diags,
                                       SourceFile *SF,
@@ -202,16 +413,19 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     return true;
   }
 
-  auto escape = [](Identifier name) -> std::string {
-    return llvm::yaml::escape(name.str());
-  };
-
-  out << "### Swift dependencies file v0 ###\n";
+  using reference_dependencies::Section;
+  ReferenceDependenciesEmitter emitter(out,
+                                       opts.EmitYAMLReferenceDependencies);
 
   llvm::MapVector<const NominalTypeDecl *, bool> extendedNominals;
   llvm::SmallVector<const ExtensionDecl *, 8> extensionsWithJustMembers;
 
-  out << "provides-top-level:\n";
+  // The extensions in this file of each type, which are part of the type's
+  // fingerprint.
+  llvm::DenseMap<const NominalTypeDecl *,
+                 SmallVector<const ExtensionDecl *, 2>> extensionsOfNominal;
+
+  emitter.beginSection(Section::ProvidesTopLevel);
   for (const Decl *D : SF->Decls) {
     switch (D->getKind()) {
     case DeclKind::Module:
@@ -243,6 +457,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         }
       }
       extendedNominals[NTD] |= !justMembers;
+      extensionsOfNominal[NTD].push_back(ED);
       findNominals(extendedNominals, ED->getMembers());
       break;
     }
@@ -250,7 +465,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     case DeclKind::InfixOperator:
     case DeclKind::PrefixOperator:
     case DeclKind::PostfixOperator:
-      out << "- \"" << escape(cast<OperatorDecl>(D)->getName()) << "\"\n";
+      emitter.addName(cast<OperatorDecl>(D)->getName().str());
+      emitter.addFingerprint(getDeclFingerprint(D));
       break;
 
     case DeclKind::Enum:
@@ -264,7 +480,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           NTD->getFormalAccess() == Accessibility::Private) {
         break;
       }
-      out << "- \"" << escape(NTD->getName()) << "\"\n";
+      emitter.addName(NTD->getName().str());
+      emitter.addFingerprint(getDeclFingerprint(NTD));
       extendedNominals[NTD] |= true;
       findNominals(extendedNominals, NTD->getMembers());
       break;
@@ -280,7 +497,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           VD->getFormalAccess() == Accessibility::Private) {
         break;
       }
-      out << "- \"" << escape(VD->getName()) << "\"\n";
+      emitter.addName(VD->getName().str());
+      emitter.addFingerprint(getDeclFingerprint(VD));
       break;
     }
 
@@ -302,20 +520,41 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     }
   }
 
-  out << "provides-nominal:\n";
+  // A type's fingerprint covers its declaration, if it's in this file, and
+  // its extensions here.
+  auto getNominalFingerprint = [&](const NominalTypeDecl *NTD) -> std::string {
+    std::vector<const Decl *> parts;
+    if (NTD->getParentSourceFile() == SF)
+      parts.push_back(NTD);
+    for (auto *ED : extensionsOfNominal.lookup(NTD))
+      parts.push_back(ED);
+
+    std::string fingerprint;
+    for (auto *part : parts) {
+      std::string partFingerprint = getDeclFingerprint(part);
+      if (partFingerprint.empty())
+        return std::string();
+      fingerprint += partFingerprint;
+    }
+    return fingerprint;
+  };
+
+  llvm::DenseMap<const NominalTypeDecl *, std::string> nominalFingerprints;
+  for (auto entry : extendedNominals)
+    nominalFingerprints[entry.first] = getNominalFingerprint(entry.first);
+
+  emitter.beginSection(Section::ProvidesNominal);
   for (auto entry : extendedNominals) {
     if (!entry.second)
       continue;
-    out << "- \"";
-    out << mangleTypeAsContext(entry.first);
-    out << "\"\n";
+    emitter.addName(mangleTypeAsContext(entry.first));
+    emitter.addFingerprint(nominalFingerprints[entry.first]);
   }
 
-  out << "provides-member:\n";
+  emitter.beginSection(Section::ProvidesMember);
   for (auto entry : extendedNominals) {
-    out << "- [\"";
-    out << mangleTypeAsContext(entry.first);
-    out << "\", \"\"]\n";
+    emitter.addMember(mangleTypeAsContext(entry.first), "");
+    emitter.addFingerprint(nominalFingerprints[entry.first]);
   }
 
   // This is also part of "provides-member".
@@ -329,8 +568,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
           VD->getFormalAccess() == Accessibility::Private) {
         continue;
       }
-      out << "- [\"" << mangledName << "\", \""
-          << escape(VD->getName()) << "\"]\n";
+      emitter.addMember(mangledName, VD->getName().str());
+      emitter.addFingerprint(getDeclFingerprint(VD));
     }
   }
 
@@ -338,36 +577,32 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     // FIXME: This requires a traversal of the whole file to compute.
     // We should (a) see if there's a cheaper way to keep it up to date,
     // and/or (b) see if we can fast-path cases where there's no ObjC involved.
-    out << "provides-dynamic-lookup:\n";
+    emitter.beginSection(Section::ProvidesDynamicLookup);
     class ValueDeclPrinter : public VisibleDeclConsumer {
     private:
-      raw_ostream &out;
-      std::string (*escape)(Identifier);
+      ReferenceDependenciesEmitter &emitter;
     public:
-      ValueDeclPrinter(raw_ostream &out, decltype(escape) escape)
-        : out(out), escape(escape) {}
+      ValueDeclPrinter(ReferenceDependenciesEmitter &emitter)
+        : emitter(emitter) {}
 
       void foundDecl(ValueDecl *VD, DeclVisibilityKind Reason) override {
-        out << "- \"" << escape(VD->getName()) << "\"\n";
+        emitter.addName(VD->getName().str());
       }
     };
-    ValueDeclPrinter printer(out, escape);
+    ValueDeclPrinter printer(emitter);
     SF->lookupClassMembers({}, printer);
   }
 
   ReferencedNameTracker *tracker = SF->getReferencedNameTracker();
 
   // FIXME: Sort these?
-  out << "depends-top-level:\n";
+  emitter.beginSection(Section::DependsTopLevel);
   for (auto &entry : tracker->getTopLevelNames()) {
     assert(!entry.first.empty());
-    out << "- ";
-    if (!entry.second)
-      out << "!private ";
-    out << "\"" << escape(entry.first) << "\"\n";
+    emitter.addName(entry.first.str(), entry.second);
   }
 
-  out << "depends-member:\n";
+  emitter.beginSection(Section::DependsMember);
   auto &memberLookupTable = tracker->getUsedMembers();
   using TableEntryTy = std::pair<ReferencedNameTracker::MemberPair, bool>;
   std::vector<TableEntryTy> sortedMembers{
@@ -394,18 +629,14 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         entry.first.first->getFormalAccess() == Accessibility::Private)
       continue;
 
-    out << "- ";
-    if (!entry.second)
-      out << "!private ";
-    out << "[\"";
-    out << mangleTypeAsContext(entry.first.first);
-    out << "\", \"";
+    StringRef memberName;
     if (!entry.first.second.empty())
-      out << escape(entry.first.second);
-    out << "\"]\n";
+      memberName = entry.first.second.str();
+    emitter.addMember(mangleTypeAsContext(entry.first.first), memberName,
+                      entry.second);
   }
 
-  out << "depends-nominal:\n";
+  emitter.beginSection(Section::DependsNominal);
   for (auto i = sortedMembers.begin(), e = sortedMembers.end(); i != e; ++i) {
     bool isCascading = i->second;
     while (i+1 != e && i[0].first.first == i[1].first.first) {
@@ -417,32 +648,24 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         i->first.first->getFormalAccess() == Accessibility::Private)
       continue;
 
-    out << "- ";
-    if (!isCascading)
-      out << "!private ";
-    out << "\"";
-    out <<  mangleTypeAsContext(i->first.first);
-    out << "\"\n";
+    emitter.addName(mangleTypeAsContext(i->first.first), isCascading);
   }
 
   // FIXME: Sort these?
-  out << "depends-dynamic-lookup:\n";
+  emitter.beginSection(Section::DependsDynamicLookup);
   for (auto &entry : tracker->getDynamicLookupNames()) {
     assert(!entry.first.empty());
-    out << "- ";
-    if (!entry.second)
-      out << "!private ";
-    out << "\"" << escape(entry.first) << "\"\n";
+    emitter.addName(entry.first.str(), entry.second);
   }
 
-  out << "depends-external:\n";
-  for (auto &entry : depTracker.getDependencies()) {
-    out << "- \"" << llvm::yaml::escape(entry) << "\"\n";
-  }
+  emitter.beginSection(Section::DependsExternal);
+  for (auto &entry : depTracker.getDependencies())
+    emitter.addName(entry);
 
   llvm::SmallString<32> interfaceHash;
   SF->getInterfaceHash(interfaceHash);
-  out << "interface-hash: \"" << interfaceHash << "\"\n";
+  emitter.addInterfaceHash(interfaceHash);
+  emitter.finish();
 
   return false;
 }
@@ -621,6 +844,48 @@ static void debugFailWithCrash() {
   LLVM_BUILTIN_TRAP;
 }
 
+/// Counts the functions of \p SM and the instructions in them.
+static void countSILModule(SILModule &SM, size_t &NumFunctions,
+                           size_t &NumInstructions) {
+  NumFunctions = 0;
+  NumInstructions = 0;
+  for (SILFunction &F : SM) {
+    ++NumFunctions;
+    for (SILBasicBlock &BB : F)
+      NumInstructions += std::distance(BB.begin(), BB.end());
+  }
+}
+
+/// Counts the contents of the LLVM module \p M into \p Stats.
+static void countIRModule(const llvm::Module &M, UnifiedStatsReporter &Stats) {
+  auto &C = Stats.getFrontendCounters();
+  C.NumIRGlobals = M.getGlobalList().size();
+  for (const llvm::Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+    ++C.NumIRFunctions;
+    for (const llvm::BasicBlock &BB : F) {
+      ++C.NumIRBasicBlocks;
+      C.NumIRInsts += BB.size();
+    }
+  }
+}
+
+/// Counts the AST and the memory used for it into \p Stats.
+static void countAST(CompilerInstance &Instance, UnifiedStatsReporter &Stats) {
+  auto &C = Stats.getFrontendCounters();
+  ASTContext &Ctx = Instance.getASTContext();
+  C.NumSourceBuffers = Instance.getSourceMgr().getLLVMSourceMgr()
+                                              .getNumBuffers();
+  C.NumLoadedModules = Ctx.LoadedModules.size();
+  for (FileUnit *File : Instance.getMainModule()->getFiles())
+    if (auto *SF = dyn_cast<SourceFile>(File))
+      C.NumTopLevelDecls += SF->Decls.size();
+  C.NumASTBytesAllocated = Ctx.getTotalMemory();
+  C.NumPermanentArenaBytes = Ctx.getPermanentArenaMemory();
+  C.NumPeakSolverArenaBytes = Ctx.getPeakSolverArenaMemory();
+}
+
 /// Performs the compile requested by the user.
 /// \returns true on error
 static bool performCompile(CompilerInstance &Instance,
@@ -671,6 +936,25 @@ static bool performCompile(CompilerInstance &Instance,
     return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
   }
 
+  if (Action == FrontendOptions::EmitPCH) {
+    auto clangImporter = static_cast<ClangImporter *>(
+      Instance.getASTContext().getClangModuleLoader());
+    return clangImporter->emitBridgingPCH(opts.ImplicitObjCHeaderPath,
+                                          opts.getSingleOutputFilename());
+  }
+
+  // A script that has been run before does not need to be compiled again.
+  std::string ScriptCacheEntry;
+  if (Action == FrontendOptions::Immediate && !opts.ScriptCachePath.empty()) {
+    ScriptCacheEntry = getScriptCacheEntry(Instance, opts.ScriptCachePath,
+                                           Args);
+    if (runCachedScript(Instance, ScriptCacheEntry,
+                        ProcessCmdLine(opts.ImmediateArgv.begin(),
+                                       opts.ImmediateArgv.end()),
+                        ReturnValue))
+      return false;
+  }
+
   ReferencedNameTracker nameTracker;
   bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
   if (shouldTrackReferences)
@@ -780,6 +1064,11 @@ static bool performCompile(CompilerInstance &Instance,
     observer->performedSILGeneration(*SM);
   }
 
+  if (auto *Stats = Instance.getASTContext().Stats) {
+    auto &C = Stats->getFrontendCounters();
+    countSILModule(*SM, C.NumSILGenFunctions, C.NumSILGenInstructions);
+  }
+
   // We've been told to emit SIL after SILGen, so write it now.
   if (Action == FrontendOptions::EmitSILGen) {
     // If we are asked to link all, link all.
@@ -853,11 +1142,19 @@ static bool performCompile(CompilerInstance &Instance,
     SM->verify();
   }
 
+  if (Invocation.getFrontendOptions().DebugTimeCompilation)
+    SM->Types.printStatistics(llvm::errs());
+
   // Gather instruction counts if we are asked to do so.
   if (SM->getOptions().PrintInstCounts) {
     performSILInstCount(&*SM);
   }
 
+  if (auto *Stats = Instance.getASTContext().Stats) {
+    auto &C = Stats->getFrontendCounters();
+    countSILModule(*SM, C.NumSILOptFunctions, C.NumSILOptInstructions);
+  }
+
   // Get the main source file's private discriminator and attach it to
   // the compile unit's flags.
   if (PrimarySourceFile) {
@@ -899,6 +1196,8 @@ static bool performCompile(CompilerInstance &Instance,
       serializationOpts.ModuleLinkName = opts.ModuleLinkName;
       serializationOpts.ExtraClangOptions =
           Invocation.getClangImporterOptions().ExtraArgs;
+      serializationOpts.NumThreads =
+          std::max(Invocation.getSILOptions().NumThreads, 0);
       if (!IRGenOpts.ForceLoadSymbolName.empty())
         serializationOpts.AutolinkForceLoad = true;
 
@@ -951,21 +1250,30 @@ static bool performCompile(CompilerInstance &Instance,
     }
 
     ReturnValue =
-      RunImmediately(Instance, CmdLine, IRGenOpts, Invocation.getSILOptions());
+      RunImmediately(Instance, CmdLine, IRGenOpts, Invocation.getSILOptions(),
+                     ScriptCacheEntry);
     return false;
   }
 
   // FIXME: We shouldn't need to use the global context here, but
   // something is persisting across calls to performIRGeneration.
   auto &LLVMContext = llvm::getGlobalContext();
+  std::unique_ptr<llvm::Module> IRModule;
   if (PrimarySourceFile) {
-    performIRGeneration(IRGenOpts, *PrimarySourceFile, SM.get(),
-                        opts.getSingleOutputFilename(), LLVMContext);
+    IRModule = performIRGeneration(IRGenOpts, *PrimarySourceFile, SM.get(),
+                                   opts.getSingleOutputFilename(),
+                                   LLVMContext);
   } else {
-    performIRGeneration(IRGenOpts, Instance.getMainModule(), SM.get(),
-                        opts.getSingleOutputFilename(), LLVMContext);
+    IRModule = performIRGeneration(IRGenOpts, Instance.getMainModule(),
+                                   SM.get(), opts.getSingleOutputFilename(),
+                                   LLVMContext);
   }
 
+  // Multi-threaded IRGen doesn't return a module to count.
+  if (auto *Stats = Instance.getASTContext().Stats)
+    if (IRModule)
+      countIRModule(*IRModule, *Stats);
+
   return false;
 }
 
@@ -1031,15 +1339,144 @@ static bool dumpAPI(Module *Mod, StringRef OutDir) {
   return false;
 }
 
+/// Options which name an output of the primary file. In batch mode they are
+/// given once for each primary file, in the same order as the primary files.
+static const options::ID PerPrimaryOutputOptions[] = {
+  options::OPT_o,
+  options::OPT_output_filelist,
+  options::OPT_emit_module_path,
+  options::OPT_emit_module_doc_path,
+  options::OPT_serialize_diagnostics_path,
+  options::OPT_emit_dependencies_path,
+  options::OPT_emit_reference_dependencies_path,
+  options::OPT_emit_fixits_path,
+};
+
+static bool isPerPrimaryOutputOption(const llvm::opt::Option &Opt) {
+  for (auto ID : PerPrimaryOutputOptions)
+    if (Opt.matches(ID))
+      return true;
+  return false;
+}
+
+/// Compiles a batch of primary files, if \p Args name more than one, one
+/// primary file at a time with the arguments that a frontend job for just
+/// that file would have had.
+///
+/// \returns false if \p Args name at most one primary file and nothing was
+/// done; otherwise \p ReturnValue holds the result of the batch.
+static bool performBatchFrontend(ArrayRef<const char *> Args,
+                                 const char *Argv0, void *MainAddr,
+                                 FrontendObserver *observer,
+                                 DiagnosticEngine &Diags, int &ReturnValue) {
+  using namespace options;
+
+  unsigned MissingIndex;
+  unsigned MissingCount;
+  std::unique_ptr<llvm::opt::OptTable> Table = createSwiftOptTable();
+  llvm::opt::InputArgList ParsedArgs =
+      Table->ParseArgs(Args, MissingIndex, MissingCount, FrontendOption);
+  // Leave malformed command lines to be diagnosed by parseArgs.
+  if (MissingCount)
+    return false;
+
+  unsigned NumPrimaries = ParsedArgs.getAllArgValues(OPT_primary_file).size();
+  if (NumPrimaries <= 1)
+    return false;
+
+  for (auto ID : PerPrimaryOutputOptions) {
+    unsigned Count = ParsedArgs.getAllArgValues(ID).size();
+    if (Count != 0 && Count != NumPrimaries) {
+      std::string Spelling = Table->getOption(ID).getPrefixedName();
+      Diags.diagnose(SourceLoc(), diag::error_batch_mode_output_count,
+                     Spelling, NumPrimaries, Count);
+      ReturnValue = 1;
+      return true;
+    }
+  }
+
+  // With -filelist, all of the inputs come from the list, so the other
+  // primary files are simply dropped.
+  bool UsesFilelist = ParsedArgs.hasArg(OPT_filelist);
+
+  ReturnValue = 0;
+  for (unsigned Primary = 0; Primary != NumPrimaries; ++Primary) {
+    llvm::opt::ArgStringList PrimaryArgs;
+    llvm::SmallDenseMap<unsigned, unsigned, 8> Occurrences;
+    for (const llvm::opt::Arg *A : ParsedArgs) {
+      const llvm::opt::Option &Opt = A->getOption();
+      if (Opt.matches(OPT_primary_file)) {
+        if (Occurrences[OPT_primary_file]++ == Primary)
+          A->render(ParsedArgs, PrimaryArgs);
+        else if (!UsesFilelist)
+          PrimaryArgs.push_back(A->getValue());
+        continue;
+      }
+      if (isPerPrimaryOutputOption(Opt)) {
+        if (Occurrences[Opt.getID()]++ == Primary)
+          A->render(ParsedArgs, PrimaryArgs);
+        continue;
+      }
+      A->render(ParsedArgs, PrimaryArgs);
+    }
+
+    int PrimaryResult = performFrontend(PrimaryArgs, Argv0, MainAddr,
+                                        observer);
+    if (ReturnValue == 0)
+      ReturnValue = PrimaryResult;
+  }
+  return true;
+}
+
+std::string swift::getPreparedContextKey(ArrayRef<const char *> Args) {
+  using namespace options;
+
+  unsigned MissingIndex;
+  unsigned MissingCount;
+  std::unique_ptr<llvm::opt::OptTable> Table = createSwiftOptTable();
+  llvm::opt::InputArgList ParsedArgs =
+      Table->ParseArgs(Args, MissingIndex, MissingCount, FrontendOption);
+  if (MissingCount || ParsedArgs.getAllArgValues(OPT_primary_file).size() != 1)
+    return std::string();
+
+  // Whether an output is requested can matter, as it does for the dependency
+  // tracker, but where it goes can't.
+  std::string Key;
+  for (const llvm::opt::Arg *A : ParsedArgs) {
+    const llvm::opt::Option &Opt = A->getOption();
+    if (Opt.matches(OPT_INPUT) || Opt.matches(OPT_primary_file))
+      continue;
+    if (isPerPrimaryOutputOption(Opt)) {
+      Key += Opt.getPrefixedName();
+    } else {
+      llvm::opt::ArgStringList Rendered;
+      A->render(ParsedArgs, Rendered);
+      for (const char *Part : Rendered) {
+        Key += Part;
+        Key += '\0';
+      }
+    }
+    Key += '\0';
+  }
+  return Key;
+}
+
 int swift::performFrontend(ArrayRef<const char *> Args,
                            const char *Argv0, void *MainAddr,
                            FrontendObserver *observer) {
+  CompilerInstance Instance;
+  return performFrontend(Instance, Args, Argv0, MainAddr, observer);
+}
+
+int swift::performFrontend(CompilerInstance &Instance,
+                           ArrayRef<const char *> Args,
+                           const char *Argv0, void *MainAddr,
+                           FrontendObserver *observer) {
   llvm::InitializeAllTargets();
   llvm::InitializeAllTargetMCs();
   llvm::InitializeAllAsmPrinters();
   llvm::InitializeAllAsmParsers();
 
-  CompilerInstance Instance;
   PrintingDiagnosticConsumer PDC;
   Instance.addDiagnosticConsumer(&PDC);
 
@@ -1048,6 +1485,13 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     return 1;
   }
 
+  if (!Instance.hasASTContext()) {
+    int BatchResult;
+    if (performBatchFrontend(Args, Argv0, MainAddr, observer,
+                             Instance.getDiags(), BatchResult))
+      return BatchResult;
+  }
+
   CompilerInvocation Invocation;
   std::string MainExecutablePath = llvm::sys::fs::getMainExecutable(Argv0,
                                                                     MainAddr);
@@ -1156,9 +1600,12 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     enableDiagnosticVerifier(Instance.getSourceMgr());
   }
 
+  // A prepared instance already has the dependency tracker it was prepared
+  // with.
   DependencyTracker depTracker;
-  if (!Invocation.getFrontendOptions().DependenciesFilePath.empty() ||
-      !Invocation.getFrontendOptions().ReferenceDependenciesFilePath.empty()) {
+  if ((!Invocation.getFrontendOptions().DependenciesFilePath.empty() ||
+       !Invocation.getFrontendOptions().ReferenceDependenciesFilePath.empty()) &&
+      !Instance.getDependencyTracker()) {
     Instance.setDependencyTracker(&depTracker);
   }
 
@@ -1171,11 +1618,59 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     observer->configuredCompiler(Instance);
   }
 
+  // Statistics and traces are written to files named after the module and
+  // the primary file, so that they can be told apart.
+  std::string AuxName = Invocation.getModuleName();
+  auto &PrimaryInput = Invocation.getFrontendOptions().PrimaryInput;
+  if (PrimaryInput && PrimaryInput->isFilename()) {
+    AuxName += '-';
+    AuxName += llvm::sys::path::filename(
+        Invocation.getFrontendOptions().InputFilenames[PrimaryInput->Index]);
+  }
+
+  std::unique_ptr<UnifiedStatsReporter> StatsReporter;
+  const std::string &StatsOutputDir =
+    Invocation.getFrontendOptions().StatsOutputDir;
+  if (!StatsOutputDir.empty()) {
+    StatsReporter.reset(new UnifiedStatsReporter("swift-frontend", AuxName,
+                                                 StatsOutputDir));
+    Instance.getASTContext().Stats = StatsReporter.get();
+    SharedTimer::setStatsReporter(StatsReporter.get());
+  }
+
+  std::unique_ptr<TraceEventRecorder> TraceRecorder;
+  const std::string &TraceOutputDir =
+    Invocation.getFrontendOptions().TraceOutputDir;
+  if (!TraceOutputDir.empty()) {
+    TraceRecorder.reset(new TraceEventRecorder("swift-frontend", AuxName,
+                                               TraceOutputDir));
+    TraceEventRecorder::setCurrent(TraceRecorder.get());
+  }
+
   int ReturnValue = 0;
   bool HadError =
     performCompile(Instance, Invocation, Args, ReturnValue, observer) ||
     Instance.getASTContext().hadError();
 
+  // Writes the statistics file.
+  if (StatsReporter) {
+    countAST(Instance, *StatsReporter);
+    SharedTimer::setStatsReporter(nullptr);
+    Instance.getASTContext().Stats = nullptr;
+    StatsReporter.reset();
+  }
+
+  // Writes the trace file.
+  if (TraceRecorder) {
+    TraceEventRecorder::setCurrent(nullptr);
+    TraceRecorder.reset();
+  }
+
+  if (Invocation.getFrontendOptions().DebugTimeCompilation) {
+    Instance.getASTContext().printArenaUsage(llvm::errs());
+    Instance.getASTContext().printImportedLookupStats(llvm::errs());
+  }
+
   if (!HadError && !Invocation.getFrontendOptions().DumpAPIPath.empty()) {
     HadError = dumpAPI(Instance.getMainModule(),
                        Invocation.getFrontendOptions().DumpAPIPath);
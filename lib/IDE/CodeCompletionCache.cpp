@@ -90,12 +90,6 @@ CodeCompletionCache::~CodeCompletionCache() {}
 /// cached results. This isn't expected to change very often.
 static constexpr uint32_t onDiskCompletionCacheVersion = 0;
 
-static StringRef copyString(llvm::BumpPtrAllocator &Allocator, StringRef Str) {
-  char *Mem = Allocator.Allocate<char>(Str.size());
-  std::copy(Str.begin(), Str.end(), Mem);
-  return StringRef(Mem, Str.size());
-}
-
 static ArrayRef<StringRef> copyStringArray(llvm::BumpPtrAllocator &Allocator,
                                            ArrayRef<StringRef> Arr) {
   StringRef *Buff = Allocator.Allocate<StringRef>(Arr.size());
@@ -113,13 +107,18 @@ static ArrayRef<std::pair<StringRef, StringRef>> copyStringPairArray(
 }
 
 /// Deserializes CodeCompletionResults from \p in and stores them in \p V.
+///
+/// The strings of the results are not copied but refer to \p in, which is
+/// kept alive by the allocator of the sink of \p V. Sinks which import the
+/// results already keep that allocator alive.
 /// \see writeCacheModule.
-static bool readCachedModule(llvm::MemoryBuffer *in,
+static bool readCachedModule(std::unique_ptr<llvm::MemoryBuffer> in,
                              const CodeCompletionCache::Key &K,
                              CodeCompletionCache::Value &V,
                              bool allowOutOfDate = false) {
-  const char *cursor = in->getBufferStart();
-  const char *end = in->getBufferEnd();
+  std::shared_ptr<llvm::MemoryBuffer> buffer(std::move(in));
+  const char *cursor = buffer->getBufferStart();
+  const char *end = buffer->getBufferEnd();
 
   auto read32le = [end](const char *&cursor) {
     auto result = llvm::support::endian::read32le(cursor);
@@ -160,6 +159,13 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
   assert(strings + stringCount == end && "incorrect file size");
   (void)stringCount; // so it is not seen as "unused" in release builds.
   
+  // Nothing has been allocated in the sink yet. Replace its allocator by
+  // one that owns the buffer.
+  assert(V.Sink.Results.empty());
+  V.Sink.Allocator = CodeCompletionResultSink::AllocatorPtr(
+      new llvm::BumpPtrAllocator(),
+      [buffer](llvm::BumpPtrAllocator *allocator) { delete allocator; });
+
   // STRINGS
   auto getString = [&](uint32_t index) -> StringRef {
     if (index == ~0u)
@@ -167,7 +173,7 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 
     const char *p = strings + index;
     auto size = read32le(p);
-    return copyString(*V.Sink.Allocator, StringRef(p, size));
+    return StringRef(p, size);
   };
 
   // CHUNKS
@@ -423,14 +429,17 @@ static std::string getName(StringRef cacheDirectory,
 
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::get(const Key &K) {
-  // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(getName(cacheDirectory, K));
+  // Try to find the cached file. The file is replaced atomically when it is
+  // updated, so it can be mapped and shared with other processes.
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(
+      getName(cacheDirectory, K), /*FileSize*/ -1,
+      /*RequiresNullTerminator*/ false);
   if (!bufferOrErr)
     return None;
 
   // Read the cached results, failing if they are out of date.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V))
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V))
     return None;
 
   return V;
@@ -466,7 +475,8 @@ std::error_code OnDiskCodeCompletionCache::set(const Key &K, ValueRefCntPtr V) {
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
   // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(filename);
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(
+      filename, /*FileSize*/ -1, /*RequiresNullTerminator*/ false);
   if (!bufferOrErr)
     return None;
 
@@ -475,7 +485,7 @@ OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
 
   // Read the cached results.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V,
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V,
                         /*allowOutOfDate*/ true))
     return None;
 
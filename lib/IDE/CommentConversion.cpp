@@ -417,7 +417,8 @@ std::string ide::extractPlainTextFromComment(const StringRef Text) {
   return MC.getLineList(Comment).str();
 }
 
-bool ide::getDocumentationCommentAsXML(const Decl *D, raw_ostream &OS) {
+static bool convertDocumentationCommentToXML(const Decl *D,
+                                             raw_ostream &OS) {
   auto MaybeClangNode = D->getClangNode();
   if (MaybeClangNode) {
     if (auto *CD = MaybeClangNode.getAsDecl()) {
@@ -438,9 +439,27 @@ bool ide::getDocumentationCommentAsXML(const Decl *D, raw_ostream &OS) {
 
   CommentToXMLConverter Converter(OS);
   Converter.visitDocComment(DC.getValue());
+  return true;
+}
 
+bool ide::getDocumentationCommentAsXML(const Decl *D, raw_ostream &OS) {
+  // Cursor info and code completion ask for the same declarations over and
+  // over, so the markup of each is only parsed and converted once.
+  ASTContext &Ctx = D->getASTContext();
+  if (Optional<StringRef> Cached = Ctx.getDocCommentXML(D)) {
+    OS << *Cached;
+    return !Cached->empty();
+  }
+
+  SmallString<1024> XML;
+  llvm::raw_svector_ostream XMLOS(XML);
+  bool HasComment = convertDocumentationCommentToXML(D, XMLOS);
+  if (!HasComment)
+    XML.clear();
+  Ctx.setDocCommentXML(D, XML);
+  OS << XML;
   OS.flush();
-  return true;
+  return HasComment;
 }
 
 //===----------------------------------------------------------------------===//
@@ -74,14 +74,23 @@ protected:
 
   llvm::Constant *getRelativeAddressFromNextField(ConstantReference referent,
                                             llvm::IntegerType *addressTy) {
+    return getRelativeAddressFromOffset(referent, getNextOffset(), addressTy);
+  }
+
+  /// Compute a relative address from the field at \p offset in the
+  /// initializer to another global variable. This is used to fill in
+  /// reserved fields after the rest of the initializer has been laid out.
+  llvm::Constant *getRelativeAddressFromOffset(ConstantReference referent,
+                                               Size offset,
+                                               llvm::IntegerType *addressTy) {
     assert(relativeAddressBase && "no relative address base set");
     
-    // Determine the address of the next field in the initializer.
+    // Determine the address of the field in the initializer.
     llvm::Constant *fieldAddr =
       llvm::ConstantExpr::getPtrToInt(relativeAddressBase, IGM.IntPtrTy);
     fieldAddr = llvm::ConstantExpr::getAdd(fieldAddr,
                           llvm::ConstantInt::get(IGM.SizeTy,
-                                                 getNextOffset().getValue()));
+                                                 offset.getValue()));
     llvm::Constant *referentValue =
       llvm::ConstantExpr::getPtrToInt(referent.getValue(), IGM.IntPtrTy);
 
@@ -18,6 +18,7 @@
 #include "GenBuiltin.h"
 
 #include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "swift/AST/Types.h"
@@ -731,6 +732,8 @@ if (Builtin.ID == BuiltinValueKind::id) { \
     if (auto ExpectedPred = IGF.IGM.TargetInfo.OnceDonePredicateValue) {
       auto PredValue = IGF.Builder.CreateLoad(PredPtr,
                                               IGF.IGM.getPointerAlignment());
+      if (IGF.IGM.TargetInfo.OnceDonePredicateNeedsAcquire)
+        PredValue->setOrdering(llvm::AtomicOrdering::Acquire);
       auto ExpectedPredValue = llvm::ConstantInt::getSigned(IGF.IGM.OnceTy,
                                                             *ExpectedPred);
       auto PredIsDone = IGF.Builder.CreateICmpEQ(PredValue, ExpectedPredValue);
@@ -738,7 +741,10 @@ if (Builtin.ID == BuiltinValueKind::id) { \
       notDoneBB = IGF.createBasicBlock("once_not_done");
       doneBB = IGF.createBasicBlock("once_done");
       
-      IGF.Builder.CreateCondBr(PredIsDone, doneBB, notDoneBB);
+      // The predicate is done on every call but the first few.
+      llvm::MDBuilder MDB(IGF.IGM.getLLVMContext());
+      IGF.Builder.CreateCondBr(PredIsDone, doneBB, notDoneBB,
+                               MDB.createBranchWeights(2000, 1));
       IGF.Builder.emitBlock(notDoneBB);
     }
     
@@ -3016,8 +3016,13 @@ namespace {
       auto headerFields =
         this->claimReservation(header, TemplateHeaderFieldCount);
 
-      //   Metadata *(*CreateFunction)(GenericMetadata *, const void*);
-      headerFields[Field++] = emitCreateFunction();
+      //   FarRelativeDirectPointer<Metadata *(GenericMetadata *,
+      //                                       const void*)> CreateFunction;
+      // The header is at the start of the pattern, so the field is at
+      // offset zero. Being relative, it needs no load-time relocation.
+      headerFields[Field++] = this->getRelativeAddressFromOffset(
+          {emitCreateFunction(), ConstantReference::Direct}, Size(0),
+          IGM.FarRelativeAddressTy);
       
       //   uint32_t MetadataSize;
       // We compute this assuming that every entry in the metadata table
@@ -895,21 +895,33 @@ public:
 
   llvm::Value *getTable(IRGenFunction &IGF, CanType type,
                         llvm::Value **typeMetadataCache) const override {
-    // If we're looking up a dependent type, we can't cache the result.
+    // If we already have the table in this function, reuse it.
+    auto localDataKind = LocalTypeDataKind::forConcreteProtocolWitnessTable(
+                      const_cast<NormalProtocolConformance *>(Conformance));
+    if (auto wtable = IGF.tryGetLocalTypeData(type, localDataKind))
+      return wtable;
+
+    llvm::Value *wtable;
+
+    // If we're looking up a dependent type, we can't cache the result
+    // globally, but we can still reuse it within the function.
     if (type->hasArchetype()) {
-      return emitWitnessTableAccessorCall(IGF, Conformance, type,
-                                          typeMetadataCache);
-    }
+      wtable = emitWitnessTableAccessorCall(IGF, Conformance, type,
+                                            typeMetadataCache);
 
     // Otherwise, call a lazy-cache function.
-    auto accessor =
-      getWitnessTableLazyAccessFunction(IGF.IGM, Conformance, type);
-    llvm::CallInst *call = IGF.Builder.CreateCall(accessor, {});
-    call->setCallingConv(IGF.IGM.DefaultCC);
-    call->setDoesNotAccessMemory();
-    call->setDoesNotThrow();
-
-    return call;
+    } else {
+      auto accessor =
+        getWitnessTableLazyAccessFunction(IGF.IGM, Conformance, type);
+      llvm::CallInst *call = IGF.Builder.CreateCall(accessor, {});
+      call->setCallingConv(IGF.IGM.DefaultCC);
+      call->setDoesNotAccessMemory();
+      call->setDoesNotThrow();
+      wtable = call;
+    }
+
+    IGF.setScopedLocalTypeData(type, localDataKind, wtable);
+    return wtable;
   }
 
   llvm::Constant *tryGetConstantTable(IRGenModule &IGM,
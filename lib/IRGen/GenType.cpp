@@ -14,6 +14,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "irgen"
 #include "swift/AST/CanTypeVisitor.h"
 #include "swift/AST/Decl.h"
 #include "swift/AST/IRGenOptions.h"
@@ -22,6 +23,7 @@
 #include "swift/SIL/SILModule.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "clang/CodeGen/SwiftCallingConv.h"
 
@@ -46,6 +48,9 @@
 using namespace swift;
 using namespace irgen;
 
+STATISTIC(NumSchemaCacheHits, "Number of explosion schemas found in the cache");
+STATISTIC(NumSchemaCacheMisses, "Number of explosion schemas computed");
+
 llvm::DenseMap<TypeBase*, TypeCacheEntry> &
 TypeConverter::Types_t::getCacheFor(TypeBase *t) {
   return t->hasTypeParameter() ? DependentCache : IndependentCache;
@@ -74,10 +79,20 @@ bool TypeInfo::isSingleRetainablePointer(ResilienceExpansion expansion,
   return false;
 }
 
-ExplosionSchema TypeInfo::getSchema() const {
-  ExplosionSchema schema;
-  getSchema(schema);
-  return schema;
+TypeInfo::~TypeInfo() {
+  delete CachedSchema;
+}
+
+const ExplosionSchema &TypeInfo::getSchema() const {
+  if (CachedSchema) {
+    ++NumSchemaCacheHits;
+    return *CachedSchema;
+  }
+
+  ++NumSchemaCacheMisses;
+  CachedSchema = new ExplosionSchema();
+  getSchema(*CachedSchema);
+  return *CachedSchema;
 }
 
 Address TypeInfo::getAddressForPointer(llvm::Value *ptr) const {
@@ -1689,7 +1704,8 @@ void IRGenModule::getSchema(SILType type, ExplosionSchema &schema) {
   }
 
   // Okay, that didn't work;  just do the general thing.
-  getTypeInfo(type).getSchema(schema);
+  for (auto &elt : getTypeInfo(type).getSchema())
+    schema.add(elt);
 }
 
 /// Compute the explosion schema for the given type.
@@ -24,6 +24,7 @@
 #include "swift/Basic/Dwarf.h"
 #include "swift/Basic/Platform.h"
 #include "swift/Basic/Timer.h"
+#include "swift/Basic/TraceEvents.h"
 #include "swift/Basic/Version.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/LLVMPasses/PassesFwd.h"
@@ -90,8 +91,17 @@ static void addSwiftContractPass(const PassManagerBuilder &Builder,
 
 static void addSwiftStackPromotionPass(const PassManagerBuilder &Builder,
                                        PassManagerBase &PM) {
+  const PassManagerBuilderWrapper &BuilderWrapper =
+      static_cast<const PassManagerBuilderWrapper &>(Builder);
+  if (Builder.OptLevel > 0)
+    PM.add(createSwiftStackPromotionPass(
+        BuilderWrapper.IRGOpts.StackPromotionSizeLimit));
+}
+
+static void addInstrProfilingPass(const PassManagerBuilder &Builder,
+                                  PassManagerBase &PM) {
   if (Builder.OptLevel > 0)
-    PM.add(createSwiftStackPromotionPass());
+    PM.add(createInstrProfilingPass());
 }
 
 static void addSwiftMergeFunctionsPass(const PassManagerBuilder &Builder,
@@ -155,6 +165,7 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
     PMBuilder.SLPVectorize = true;
     PMBuilder.LoopVectorize = true;
     PMBuilder.MergeFunctions = true;
+    PMBuilder.PrepareForThinLTO = Opts.PrepareForThinLTO;
   } else {
     PMBuilder.OptLevel = 0;
     if (!Opts.DisableLLVMOptzns)
@@ -165,6 +176,13 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
   PMBuilder.addExtension(PassManagerBuilder::EP_ModuleOptimizerEarly,
                          addSwiftStackPromotionPass);
 
+  // When optimizing, lower the profile counter increments before the
+  // optimizer runs. They become plain loads and stores of the counters, which
+  // LICM can promote to registers and flush at loop exits.
+  if (Opts.GenerateProfile)
+    PMBuilder.addExtension(PassManagerBuilder::EP_ModuleOptimizerEarly,
+                           addInstrProfilingPass);
+
   // If the optimizer is enabled, we run the ARCOpt pass in the scalar optimizer
   // and the Contract pass as late as possible.
   if (!Opts.DisableLLVMARCOpts) {
@@ -242,8 +260,9 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
     }));
   }
 
-  // If we're generating a profile, add the lowering pass now.
-  if (Opts.GenerateProfile)
+  // If we're generating a profile without optimizing, add the lowering pass
+  // now.
+  if (Opts.GenerateProfile && PMBuilder.OptLevel == 0)
     ModulePasses.add(createInstrProfilingPass());
 
   if (Opts.Verify)
@@ -353,6 +372,8 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
                         llvm::Module *Module,
                         llvm::TargetMachine *TargetMachine,
                         StringRef OutputFilename) {
+  TraceSpan span("LLVM module", Module->getModuleIdentifier());
+
   if (Opts.UseIncrementalLLVMCodeGen && HashGlobal) {
     // Check if we can skip the llvm part of the compilation if we have an
     // existing object file which was generated from the same llvm IR.
@@ -425,6 +446,16 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
     break;
   case IRGenOutputKind::NativeAssembly:
   case IRGenOutputKind::ObjectFile: {
+    // With ThinLTO the object file is bitcode with a module summary, which
+    // the linker's LTO backend compiles to native code.
+    if (Opts.OutputKind == IRGenOutputKind::ObjectFile &&
+        Opts.PrepareForThinLTO) {
+      EmitPasses.add(createBitcodeWriterPass(
+          *RawOS, /*ShouldPreserveUseListOrder*/ false,
+          /*EmitSummaryIndex*/ true));
+      break;
+    }
+
     llvm::TargetMachine::CodeGenFileType FileType;
     FileType = (Opts.OutputKind == IRGenOutputKind::NativeAssembly
                   ? llvm::TargetMachine::CGFT_AssemblyFile
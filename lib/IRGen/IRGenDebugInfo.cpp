@@ -40,6 +40,7 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Config/config.h"
 #include "llvm/IR/DebugInfo.h"
 #include "llvm/IR/Module.h"
@@ -54,6 +55,12 @@
 using namespace swift;
 using namespace irgen;
 
+STATISTIC(NumTypeCacheHits, "Number of debug types found by type pointer");
+STATISTIC(NumUIDCacheHits, "Number of debug types found by mangled name");
+STATISTIC(NumTypesMangled, "Number of types mangled for debug info");
+STATISTIC(NumSugarLookedThrough,
+          "Number of parenthesized or substituted types not mangled");
+
 /// Strdup a raw char array using the bump pointer.
 StringRef IRGenDebugInfo::BumpAllocatedString(const char *Data, size_t Length) {
   char *Ptr = DebugInfoNames.Allocate<char>(Length+1);
@@ -1721,8 +1728,20 @@ llvm::DIType *IRGenDebugInfo::getOrCreateType(DebugTypeInfo DbgTy) {
     return createType(DbgTy, "", TheCU, MainFile);
 
   // Look in the cache first.
-  if (auto *DITy = getTypeOrNull(DbgTy.getType()))
+  if (auto *DITy = getTypeOrNull(DbgTy.getType())) {
+    ++NumTypeCacheHits;
     return DITy;
+  }
+
+  // Parentheses and substitutions don't show up in the debug info; the
+  // type is the one of the underlying type. Don't pay for mangling them.
+  if (isa<ParenType>(DbgTy.getType()) ||
+      isa<SubstitutedType>(DbgTy.getType())) {
+    ++NumSugarLookedThrough;
+    llvm::DIType *DITy = createType(DbgTy, StringRef(), TheCU, MainFile);
+    DITypeCache.insert({DbgTy.getType(), llvm::TrackingMDNodeRef(DITy)});
+    return DITy;
+  }
 
   // Second line of defense: Look up the mangled name. TypeBase*'s are
   // not necessarily unique, but name mangling is too expensive to do
@@ -1730,9 +1749,11 @@ llvm::DIType *IRGenDebugInfo::getOrCreateType(DebugTypeInfo DbgTy) {
   StringRef MangledName;
   llvm::MDString *UID = nullptr;
   if (canMangle(DbgTy.getType())) {
+    ++NumTypesMangled;
     MangledName = getMangledName(DbgTy);
     UID = llvm::MDString::get(IGM.getLLVMContext(), MangledName);
     if (llvm::Metadata *CachedTy = DIRefMap.lookup(UID)) {
+      ++NumUIDCacheHits;
       auto DITy = cast<llvm::DIType>(CachedTy);
       return DITy;
     }
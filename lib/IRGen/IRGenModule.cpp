@@ -1066,8 +1066,34 @@ IRGenModule *IRGenerator::getGenModule(SILFunction *f) {
   }
   // We have no source file for the function.
   // Let's use the IGM from which the function is referenced the first time.
-  if (IRGenModule *IGM = DefaultIGMForFunction[f])
-    return IGM;
+  IRGenModule *IGM = DefaultIGMForFunction[f];
+  if (!IGM)
+    IGM = getPrimaryIGM();
+
+  // Shared functions may be emitted into any IGM: if they are referenced from
+  // another LLVM module, performParallelIRGeneration gives them weak linkage.
+  // Don't let them pile up in the IGM of a big source file, which would then
+  // dominate the time of the parallel LLVM compilation.
+  if (hasSharedVisibility(f->getLinkage())) {
+    IRGenModule *LeastLoaded = Queue.front();
+    for (IRGenModule *Candidate : Queue) {
+      if (EstimatedCost[Candidate] < EstimatedCost[LeastLoaded])
+        LeastLoaded = Candidate;
+    }
+    // Keep the function near its first user unless the imbalance is large.
+    const unsigned MinImbalance = 1000;
+    if (EstimatedCost[IGM] > 2 * EstimatedCost[LeastLoaded] + MinImbalance)
+      IGM = LeastLoaded;
+  }
+  return IGM;
+}
+
+void IRGenerator::noteFunctionEmitted(IRGenModule *IGM, SILFunction *f) {
+  if (!hasMultipleIGMs())
+    return;
 
-  return getPrimaryIGM();
+  unsigned Cost = 0;
+  for (SILBasicBlock &BB : *f)
+    Cost += std::distance(BB.begin(), BB.end());
+  EstimatedCost[IGM] += Cost;
 }
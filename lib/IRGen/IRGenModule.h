@@ -175,6 +175,11 @@ private:
   // Stores the IGM from which a function is referenced the first time.
   // It is used if a function has no source-file association.
   llvm::DenseMap<SILFunction *, IRGenModule *> DefaultIGMForFunction;
+
+  // The estimated cost of LLVM code generation for each IGM, measured in SIL
+  // instructions. It is used to balance functions without a source file
+  // across the IGMs.
+  llvm::DenseMap<IRGenModule *, unsigned> EstimatedCost;
   
   // The IGM of the first source file.
   IRGenModule *PrimaryIGM = nullptr;
@@ -238,9 +243,13 @@ public:
   /// Get an IRGenModule for a function.
   /// Returns the IRGenModule of the containing source file, or if this cannot
   /// be determined, returns the IGM from which the function is referenced the
-  /// first time.
+  /// first time. Shared functions go to the least loaded IGM instead if the
+  /// referencing IGM already has much more code than the others.
   IRGenModule *getGenModule(SILFunction *f);
 
+  /// Record that function \p f is emitted into \p IGM.
+  void noteFunctionEmitted(IRGenModule *IGM, SILFunction *f);
+
   /// Returns the primary IRGenModule. This is the first added IRGenModule.
   /// It is used for everything which cannot be correlated to a specific source
   /// file. And of course, in single-threaded compilation there is only the
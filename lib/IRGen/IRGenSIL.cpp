@@ -29,6 +29,7 @@
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Range.h"
 #include "swift/Basic/STLExtras.h"
+#include "swift/Basic/TraceEvents.h"
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/IRGenOptions.h"
 #include "swift/AST/Pattern.h"
@@ -1243,6 +1244,8 @@ void IRGenModule::emitSILFunction(SILFunction *f) {
     return;
 
   PrettyStackTraceSILFunction stackTrace("emitting IR", f);
+  TraceSpan span("IRGen function", f->getName());
+  IRGen.noteFunctionEmitted(this, f);
   IRGenSILFunction(*this, f).emitSILFunction();
 }
 
@@ -4641,58 +4644,47 @@ void IRGenSILFunction::visitClassMethodInst(swift::ClassMethodInst *i) {
   setLoweredExplosion(i, e);
 }
 
-static llvm::Constant *getConstantValue(IRGenModule &IGM, llvm::StructType *STy,
-                                        TupleInst *TI);
+static llvm::Constant *getConstantValue(IRGenModule &IGM, llvm::Type *Ty,
+                                        SILValue V);
 
-/// Generate ConstantStruct for StructInst.
-static llvm::Constant *getConstantValue(IRGenModule &IGM, llvm::StructType *STy,
-                                        StructInst *SI) {
+/// Generate ConstantStruct for the elements of a StructInst or TupleInst.
+static llvm::Constant *getConstantAggregate(IRGenModule &IGM,
+                                            llvm::StructType *STy,
+                                            OperandValueArrayRef Elements) {
   SmallVector<llvm::Constant*, 32> Elts;
-  assert(SI->getNumOperands() == STy->getNumElements() &&
-         "mismatch StructInst with its lowered StructType!");
-  for (unsigned i = 0, e = STy->getNumElements(); i != e; ++i) {
-    if (auto *Elem = dyn_cast<StructInst>(SI->getOperand(i)))
-      Elts.push_back(getConstantValue(IGM,
-                     cast<llvm::StructType>(STy->getElementType(i)), Elem));
-    else if (auto *Elem = dyn_cast<TupleInst>(SI->getOperand(i)))
-      Elts.push_back(getConstantValue(IGM,
-                     cast<llvm::StructType>(STy->getElementType(i)), Elem));
-    else if (auto *ILI = dyn_cast<IntegerLiteralInst>(SI->getOperand(i)))
-      Elts.push_back(getConstantInt(IGM, ILI));
-    else if (auto *FLI = dyn_cast<FloatLiteralInst>(SI->getOperand(i)))
-      Elts.push_back(getConstantFP(IGM, FLI));
-    else if (auto *SLI = dyn_cast<StringLiteralInst>(SI->getOperand(i)))
-      Elts.push_back(getAddrOfString(IGM, SLI->getValue(), SLI->getEncoding()));
-    else
-      llvm_unreachable("Unexpected SILInstruction in static initializer!");
-  }
+  assert(Elements.size() == STy->getNumElements() &&
+         "mismatch aggregate with its lowered StructType!");
+  for (unsigned i = 0, e = STy->getNumElements(); i != e; ++i)
+    Elts.push_back(getConstantValue(IGM, STy->getElementType(i), Elements[i]));
   return llvm::ConstantStruct::get(STy, Elts);
 }
 
-
-/// Generate ConstantStruct for StructInst.
-static llvm::Constant *getConstantValue(IRGenModule &IGM, llvm::StructType *STy,
-                                        TupleInst *TI) {
-  SmallVector<llvm::Constant*, 32> Elts;
-  assert(TI->getNumOperands() == STy->getNumElements() &&
-         "mismatch StructInst with its lowered StructType!");
-  for (unsigned i = 0, e = STy->getNumElements(); i != e; ++i) {
-    if (auto *Elem = dyn_cast<StructInst>(TI->getOperand(i)))
-      Elts.push_back(getConstantValue(IGM,
-                     cast<llvm::StructType>(STy->getElementType(i)), Elem));
-    else if (auto *Elem = dyn_cast<TupleInst>(TI->getOperand(i)))
-      Elts.push_back(getConstantValue(IGM,
-                     cast<llvm::StructType>(STy->getElementType(i)), Elem));
-    else if (auto *ILI = dyn_cast<IntegerLiteralInst>(TI->getOperand(i)))
-      Elts.push_back(getConstantInt(IGM, ILI));
-    else if (auto *FLI = dyn_cast<FloatLiteralInst>(TI->getOperand(i)))
-      Elts.push_back(getConstantFP(IGM, FLI));
-    else if (auto *SLI = dyn_cast<StringLiteralInst>(TI->getOperand(i)))
-      Elts.push_back(getAddrOfString(IGM, SLI->getValue(), SLI->getEncoding()));
-    else
-      llvm_unreachable("Unexpected SILInstruction in static initializer!");
-  }
-  return llvm::ConstantStruct::get(STy, Elts);
+/// Generate the constant for a value accepted by the static initializer
+/// analysis.
+static llvm::Constant *getConstantValue(IRGenModule &IGM, llvm::Type *Ty,
+                                        SILValue V) {
+  if (auto *SI = dyn_cast<StructInst>(V))
+    return getConstantAggregate(IGM, cast<llvm::StructType>(Ty),
+                                SI->getElements());
+  if (auto *TI = dyn_cast<TupleInst>(V))
+    return getConstantAggregate(IGM, cast<llvm::StructType>(Ty),
+                                TI->getElements());
+  if (auto *ILI = dyn_cast<IntegerLiteralInst>(V))
+    return getConstantInt(IGM, ILI);
+  if (auto *FLI = dyn_cast<FloatLiteralInst>(V))
+    return getConstantFP(IGM, FLI);
+  if (auto *SLI = dyn_cast<StringLiteralInst>(V))
+    return getAddrOfString(IGM, SLI->getValue(), SLI->getEncoding());
+
+  // The analysis also accepts float literals which are truncated to a
+  // smaller floating-point type.
+  if (auto *BI = dyn_cast<BuiltinInst>(V)) {
+    assert(BI->getBuiltinInfo().ID == BuiltinValueKind::FPTrunc &&
+           "unexpected builtin in static initializer!");
+    auto *FLI = cast<FloatLiteralInst>(BI->getArguments()[0]);
+    return llvm::ConstantExpr::getFPTrunc(getConstantFP(IGM, FLI), Ty);
+  }
+  llvm_unreachable("Unexpected SILInstruction in static initializer!");
 }
 
 void IRGenModule::emitSILStaticInitializers() {
@@ -4713,15 +4705,7 @@ void IRGenModule::emitSILStaticInitializers() {
     auto *InitValue = Global.getValueOfStaticInitializer();
 
     // Set the IR global's initializer to the constant for this SIL
-    // struct.
-    if (auto *SI = dyn_cast<StructInst>(InitValue)) {
-      IRGlobal->setInitializer(getConstantValue(*this, STy, SI));
-      continue;
-    }
-
-    // Set the IR global's initializer to the constant for this SIL
-    // tuple.
-    auto *TI = cast<TupleInst>(InitValue);
-    IRGlobal->setInitializer(getConstantValue(*this, STy, TI));
+    // struct or tuple.
+    IRGlobal->setInitializer(getConstantValue(*this, STy, InitValue));
   }
 }
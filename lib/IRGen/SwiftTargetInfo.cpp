@@ -134,10 +134,11 @@ SwiftTargetInfo SwiftTargetInfo::get(IRGenModule &IGM) {
   SwiftTargetInfo target(triple.getObjectFormat(), pointerSize);
   
   // On Apple platforms, we implement "once" using dispatch_once, which exposes
-  // -1 as ABI for the "done" value.
-  if (triple.isOSDarwin())
-    target.OnceDonePredicateValue = -1L;
-  // TODO: Do we know this for Linux?
+  // -1 as ABI for the "done" value. The runtime's own implementation on other
+  // platforms uses the same value, but publishes it with a release store.
+  target.OnceDonePredicateValue = -1L;
+  if (!triple.isOSDarwin())
+    target.OnceDonePredicateNeedsAcquire = true;
   
   switch (triple.getArch()) {
   case llvm::Triple::x86_64:
@@ -95,6 +95,11 @@ public:
   /// The value stored in a Builtin.once predicate to indicate that an
   /// initialization has already happened, if known.
   Optional<int64_t> OnceDonePredicateValue = None;
+
+  /// Whether the inline check of a Builtin.once predicate needs an acquire
+  /// load to see the effects of the initialization. dispatch_once makes
+  /// them visible to plain loads before it marks the predicate done.
+  bool OnceDonePredicateNeedsAcquire = false;
 };
 
 }
@@ -102,7 +102,7 @@ protected:
   }
 
 public:
-  virtual ~TypeInfo() = default;
+  virtual ~TypeInfo();
 
   /// Unsafely cast this to the given subtype.
   template <class T> const T &as() const {
@@ -138,6 +138,10 @@ private:
   unsigned SubclassKind : 3;
   enum { InvalidSubclassKind = 0x7 };
 
+  /// The explosion schema of this type, computed on the first call to
+  /// getSchema(). Owned by this TypeInfo.
+  mutable ExplosionSchema *CachedSchema = nullptr;
+
 protected:
   void setSubclassKind(unsigned kind) {
     assert(kind != InvalidSubclassKind);
@@ -251,8 +255,9 @@ public:
   /// given schema.
   virtual void getSchema(ExplosionSchema &schema) const = 0;
 
-  /// A convenience for getting the schema of a single type.
-  ExplosionSchema getSchema() const;
+  /// A convenience for getting the schema of a single type. The schema is
+  /// computed once and cached.
+  const ExplosionSchema &getSchema() const;
 
   /// Allocate a variable of this type on the stack.
   virtual ContainedAddress allocateStack(IRGenFunction &IGF,
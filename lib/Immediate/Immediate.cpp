@@ -30,12 +30,23 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LambdaResolver.h"
+#include "llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Mangler.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/DynamicLibrary.h"
 #include "llvm/Support/Path.h"
 
 #include <dlfcn.h>
@@ -43,6 +54,12 @@
 using namespace swift;
 using namespace swift::immediate;
 
+static llvm::cl::opt<bool> ImmediateEagerJIT(
+    "immediate-eager-jit", llvm::cl::init(false),
+    llvm::cl::desc("Compile the whole program before running it in immediate "
+                   "mode, instead of compiling each function on its first "
+                   "call"));
+
 static bool loadRuntimeLib(StringRef sharedLibName, StringRef runtimeLibPath) {
   // FIXME: Need error-checking.
   llvm::SmallString<128> Path = runtimeLibPath;
@@ -189,17 +206,14 @@ bool swift::immediate::linkLLVMModules(llvm::Module *Module,
   return !Failed;
 }
 
-bool swift::immediate::IRGenImportedModules(
+void swift::immediate::collectLinkLibraries(
     CompilerInstance &CI,
-    llvm::Module &Module,
-    llvm::SmallPtrSet<swift::Module *, 8> &ImportedModules,
-    SmallVectorImpl<llvm::Function*> &InitFns,
-    IRGenOptions &IRGenOpts,
-    const SILOptions &SILOpts) {
+    const IRGenOptions &IRGenOpts,
+    SmallVectorImpl<LinkLibrary> &AllLinkLibraries) {
   swift::Module *M = CI.getMainModule();
 
-  // Perform autolinking.
-  SmallVector<LinkLibrary, 4> AllLinkLibraries(IRGenOpts.LinkLibraries);
+  AllLinkLibraries.append(IRGenOpts.LinkLibraries.begin(),
+                          IRGenOpts.LinkLibraries.end());
   auto addLinkLibrary = [&](LinkLibrary linkLib) {
     AllLinkLibraries.push_back(linkLib);
   };
@@ -218,7 +232,20 @@ bool swift::immediate::IRGenImportedModules(
     next->collectLinkLibraries(addLinkLibrary);
     prev = next;
   }
+}
 
+bool swift::immediate::IRGenImportedModules(
+    CompilerInstance &CI,
+    llvm::Module &Module,
+    llvm::SmallPtrSet<swift::Module *, 8> &ImportedModules,
+    SmallVectorImpl<llvm::Function*> &InitFns,
+    IRGenOptions &IRGenOpts,
+    const SILOptions &SILOpts) {
+  swift::Module *M = CI.getMainModule();
+
+  // Perform autolinking.
+  SmallVector<LinkLibrary, 4> AllLinkLibraries;
+  collectLinkLibraries(CI, IRGenOpts, AllLinkLibraries);
   tryLoadLibraries(AllLinkLibraries, CI.getASTContext().SearchPathOpts,
                    CI.getDiags());
 
@@ -277,8 +304,286 @@ bool swift::immediate::IRGenImportedModules(
   return hadError;
 }
 
+static std::string mangle(StringRef Name, const llvm::DataLayout &DL) {
+  std::string MangledName;
+  llvm::raw_string_ostream MangledNameStream(MangledName);
+  llvm::Mangler::getNameWithPrefix(MangledNameStream, Name, DL);
+  return MangledNameStream.str();
+}
+
+/// Static constructors are run explicitly after the initialization
+/// functions, so give them names that can be looked up.
+///
+/// \returns the new names of the constructors, in the order they should run
+static std::vector<std::string> nameStaticConstructors(llvm::Module &M) {
+  std::vector<std::string> CtorNames;
+  for (auto Ctor : llvm::orc::getConstructors(M)) {
+    std::string NewCtorName =
+        ("$static_ctor." + Twine(CtorNames.size())).str();
+    Ctor.Func->setName(NewCtorName);
+    Ctor.Func->setLinkage(llvm::GlobalValue::ExternalLinkage);
+    Ctor.Func->setVisibility(llvm::GlobalValue::HiddenVisibility);
+    CtorNames.push_back(NewCtorName);
+  }
+  return CtorNames;
+}
+
+/// Returns the name and the number of parameters of \p F, which the
+/// interpreter calls directly, and makes sure it can be looked up.
+static std::pair<std::string, unsigned> makeEntryPoint(llvm::Function *F) {
+  if (F->hasLocalLinkage()) {
+    F->setLinkage(llvm::GlobalValue::ExternalLinkage);
+    F->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  }
+  return {F->getName().str(), F->getFunctionType()->getNumParams()};
+}
+
+namespace {
+/// A JIT that compiles each function of the program the first time it is
+/// called.  Calls to functions that have not been compiled yet go through
+/// stubs that trigger their compilation, so only the code that actually runs
+/// is ever compiled.
+class LazyJIT {
+  using ObjectLayerT = llvm::orc::ObjectLinkingLayer<>;
+  using CompileLayerT = llvm::orc::IRCompileLayer<ObjectLayerT>;
+  using CODLayerT = llvm::orc::CompileOnDemandLayer<CompileLayerT>;
+
+  std::unique_ptr<llvm::TargetMachine> TM;
+  const llvm::DataLayout DL;
+  std::unique_ptr<llvm::orc::JITCompileCallbackManager> CallbackManager;
+  ObjectLayerT ObjectLayer;
+  CompileLayerT CompileLayer;
+  CODLayerT CODLayer;
+
+  /// The static constructors of the added module, renamed so that they can
+  /// be looked up in the JIT.
+  std::vector<std::string> CtorNames;
+  Optional<CODLayerT::ModuleSetHandleT> Handle;
+
+  /// Put every function in its own partition, so that it is compiled on its
+  /// first call.
+  static std::set<llvm::Function *> extractSingleFunction(llvm::Function &F) {
+    return {&F};
+  }
+
+public:
+  LazyJIT(std::unique_ptr<llvm::TargetMachine> TM,
+          std::unique_ptr<llvm::orc::JITCompileCallbackManager> CallbackManager,
+          CODLayerT::IndirectStubsManagerBuilderT StubsManagerBuilder)
+    : TM(std::move(TM)), DL(this->TM->createDataLayout()),
+      CallbackManager(std::move(CallbackManager)),
+      CompileLayer(ObjectLayer, llvm::orc::SimpleCompiler(*this->TM)),
+      CODLayer(CompileLayer, extractSingleFunction, *this->CallbackManager,
+               std::move(StubsManagerBuilder)) {}
+
+  std::string mangle(StringRef Name) const {
+    return ::mangle(Name, DL);
+  }
+
+  void addModule(std::unique_ptr<llvm::Module> M) {
+    assert(!Handle && "the interpreter only runs a single module");
+    if (M->getDataLayout().isDefault())
+      M->setDataLayout(DL);
+
+    for (auto &CtorName : nameStaticConstructors(*M))
+      CtorNames.push_back(mangle(CtorName));
+
+    // Look for symbols in the JIT first, then in the process, which has the
+    // runtime and all autolinked libraries loaded.
+    auto Resolver = llvm::orc::createLambdaResolver(
+      [this](const std::string &Name) {
+        if (auto Sym = CODLayer.findSymbol(Name, true))
+          return Sym.toRuntimeDyldSymbol();
+        if (auto Addr =
+              llvm::RTDyldMemoryManager::getSymbolAddressInProcess(Name))
+          return llvm::RuntimeDyld::SymbolInfo(Addr,
+                                               llvm::JITSymbolFlags::Exported);
+        return llvm::RuntimeDyld::SymbolInfo(nullptr);
+      },
+      [](const std::string &Name) {
+        return llvm::RuntimeDyld::SymbolInfo(nullptr);
+      });
+
+    std::vector<std::unique_ptr<llvm::Module>> Modules;
+    Modules.push_back(std::move(M));
+    Handle = CODLayer.addModuleSet(
+        std::move(Modules), llvm::make_unique<llvm::SectionMemoryManager>(),
+        std::move(Resolver));
+  }
+
+  void runStaticConstructors() {
+    llvm::orc::CtorDtorRunner<CODLayerT> CtorRunner(std::move(CtorNames),
+                                                    *Handle);
+    CtorRunner.runViaLayer(CODLayer);
+  }
+
+  /// Returns the address of the stub for the function \p Name.
+  llvm::orc::TargetAddress getFunctionAddress(StringRef Name) {
+    auto Sym = CODLayer.findSymbol(mangle(Name), true);
+    assert(Sym && "function was not added to the JIT");
+    return Sym.getAddress();
+  }
+};
+} // end anonymous namespace
+
+/// Call the function at \p Addr the way ExecutionEngine::runFunctionAsMain
+/// calls a function with \p NumParams parameters.
+int swift::immediate::runAsMain(uint64_t Addr, unsigned NumParams,
+                                const ProcessCmdLine &CmdLine) {
+  if (NumParams == 0) {
+    using InitFnTy = void ();
+    reinterpret_cast<InitFnTy *>(static_cast<uintptr_t>(Addr))();
+    return 0;
+  }
+
+  SmallVector<char *, 8> Argv;
+  for (auto &Arg : CmdLine)
+    Argv.push_back(const_cast<char *>(Arg.c_str()));
+  Argv.push_back(nullptr);
+
+  using MainFnTy = int (int, char **);
+  auto *Main = reinterpret_cast<MainFnTy *>(static_cast<uintptr_t>(Addr));
+  return Main(CmdLine.size(), Argv.data());
+}
+
+/// Run the program, compiling each function on its first call.
+static int runLazily(llvm::EngineBuilder &builder,
+                     std::unique_ptr<llvm::Module> Module,
+                     ArrayRef<llvm::Function *> InitFns,
+                     const ProcessCmdLine &CmdLine) {
+  std::string ErrorMsg;
+  builder.setErrorStr(&ErrorMsg);
+  std::unique_ptr<llvm::TargetMachine> TM(builder.selectTarget());
+  if (!TM) {
+    llvm::errs() << "Error loading JIT: " << ErrorMsg;
+    return -1;
+  }
+
+  // Both are null if lazy compilation does not support the target.
+  auto CallbackManager = llvm::orc::createLocalCompileCallbackManager(
+      TM->getTargetTriple(), 0);
+  auto StubsManagerBuilder =
+      llvm::orc::createLocalIndirectStubsManagerBuilder(TM->getTargetTriple());
+  if (!CallbackManager || !StubsManagerBuilder) {
+    llvm::errs() << "Error loading JIT: lazy compilation is not supported "
+                    "for this target; use -Xllvm -immediate-eager-jit\n";
+    return -1;
+  }
+
+  LazyJIT JIT(std::move(TM), std::move(CallbackManager),
+              std::move(StubsManagerBuilder));
+
+  // Remember the functions to run before the module is handed to the JIT,
+  // which splits it up.  They have to be visible to be looked up.
+  SmallVector<std::pair<std::string, unsigned>, 8> Entries;
+  for (auto InitFn : InitFns)
+    Entries.push_back(makeEntryPoint(InitFn));
+  Entries.push_back(makeEntryPoint(Module->getFunction("main")));
+
+  DEBUG(llvm::dbgs() << "Module to be executed:\n";
+        Module->dump());
+
+  // MCJIT does the same in EngineBuilder::create.
+  llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+  JIT.addModule(std::move(Module));
+
+  // Run the generated program.
+  for (auto &InitFn : llvm::makeArrayRef(Entries).drop_back()) {
+    DEBUG(llvm::dbgs() << "Running initialization function "
+            << InitFn.first << '\n');
+    runAsMain(JIT.getFunctionAddress(InitFn.first), InitFn.second, CmdLine);
+  }
+
+  DEBUG(llvm::dbgs() << "Running static constructors\n");
+  JIT.runStaticConstructors();
+  DEBUG(llvm::dbgs() << "Running main\n");
+  auto &Main = Entries.back();
+  return runAsMain(JIT.getFunctionAddress(Main.first), Main.second, CmdLine);
+}
+
+/// Compile the whole program to an object file that can be run without the
+/// compiler, e.g. after it has been loaded from the script cache.
+static bool compileScript(llvm::EngineBuilder &builder,
+                          llvm::Module &Module,
+                          ArrayRef<llvm::Function *> InitFns,
+                          CompiledScript &Script) {
+  std::string ErrorMsg;
+  builder.setErrorStr(&ErrorMsg);
+  std::unique_ptr<llvm::TargetMachine> TM(builder.selectTarget());
+  if (!TM) {
+    llvm::errs() << "Error loading JIT: " << ErrorMsg;
+    return true;
+  }
+
+  auto DL = TM->createDataLayout();
+  if (Module.getDataLayout().isDefault())
+    Module.setDataLayout(DL);
+
+  // The object file has no constructor list that is run when it is loaded,
+  // so record every function to run in order.
+  for (auto InitFn : InitFns) {
+    auto Entry = makeEntryPoint(InitFn);
+    Script.EntryPoints.push_back({mangle(Entry.first, DL), Entry.second});
+  }
+  for (auto &CtorName : nameStaticConstructors(Module))
+    Script.EntryPoints.push_back({mangle(CtorName, DL), 0});
+  auto Main = makeEntryPoint(Module.getFunction("main"));
+  Script.EntryPoints.push_back({mangle(Main.first, DL), Main.second});
+
+  DEBUG(llvm::dbgs() << "Module to be compiled:\n";
+        Module.dump());
+
+  Script.Object = llvm::orc::SimpleCompiler(*TM)(Module);
+  if (!Script.Object.getBinary()) {
+    llvm::errs() << "Error loading JIT: could not compile the script\n";
+    return true;
+  }
+  return false;
+}
+
+int swift::immediate::runCompiledScript(CompiledScript &Script,
+                                        const ProcessCmdLine &CmdLine) {
+  llvm::orc::ObjectLinkingLayer<> ObjectLayer;
+
+  // The object defines the whole program; everything else comes from the
+  // process, which has the runtime and all autolinked libraries loaded.
+  auto Resolver = llvm::orc::createLambdaResolver(
+    [](const std::string &Name) {
+      if (auto Addr =
+            llvm::RTDyldMemoryManager::getSymbolAddressInProcess(Name))
+        return llvm::RuntimeDyld::SymbolInfo(Addr,
+                                             llvm::JITSymbolFlags::Exported);
+      return llvm::RuntimeDyld::SymbolInfo(nullptr);
+    },
+    [](const std::string &Name) {
+      return llvm::RuntimeDyld::SymbolInfo(nullptr);
+    });
+
+  llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+  std::vector<llvm::object::ObjectFile *> Objects;
+  Objects.push_back(Script.Object.getBinary());
+  ObjectLayer.addObjectSet(std::move(Objects),
+                           llvm::make_unique<llvm::SectionMemoryManager>(),
+                           std::move(Resolver));
+
+  // Run the initialization functions and static constructors, then main.
+  int Result = 0;
+  for (auto &Entry : Script.EntryPoints) {
+    DEBUG(llvm::dbgs() << "Running " << Entry.first << '\n');
+    auto Sym = ObjectLayer.findSymbol(Entry.first, false);
+    if (!Sym) {
+      llvm::errs() << "Error loading JIT: missing entry point "
+                   << Entry.first << '\n';
+      return -1;
+    }
+    Result = runAsMain(Sym.getAddress(), Entry.second, CmdLine);
+  }
+  return Result;
+}
+
 int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
-                          IRGenOptions &IRGenOpts, const SILOptions &SILOpts) {
+                          IRGenOptions &IRGenOpts, const SILOptions &SILOpts,
+                          StringRef ScriptCacheEntry) {
   ASTContext &Context = CI.getASTContext();
   
   // IRGen the main module.
@@ -309,18 +614,39 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
     return -1;
   }
 
-  // Build the ExecutionEngine.
-  llvm::EngineBuilder builder(std::move(ModuleOwner));
-  std::string ErrorMsg;
   llvm::TargetOptions TargetOpt;
   std::string CPU;
   std::vector<std::string> Features;
   std::tie(TargetOpt, CPU, Features)
     = getIRTargetOptions(IRGenOpts, swiftModule->getASTContext());
-  builder.setRelocationModel(llvm::Reloc::PIC_);
-  builder.setTargetOptions(TargetOpt);
-  builder.setMCPU(CPU);
-  builder.setMAttrs(Features);
+  auto configureBuilder = [&](llvm::EngineBuilder &builder) {
+    builder.setRelocationModel(llvm::Reloc::PIC_);
+    builder.setTargetOptions(TargetOpt);
+    builder.setMCPU(CPU);
+    builder.setMAttrs(Features);
+  };
+
+  if (!ScriptCacheEntry.empty()) {
+    CompiledScript Script;
+    collectLinkLibraries(CI, IRGenOpts, Script.LinkLibraries);
+    llvm::EngineBuilder builder;
+    configureBuilder(builder);
+    if (compileScript(builder, *Module, InitFns, Script))
+      return -1;
+    storeCompiledScript(ScriptCacheEntry, Script);
+    return runCompiledScript(Script, CmdLine);
+  }
+
+  if (!ImmediateEagerJIT) {
+    llvm::EngineBuilder builder;
+    configureBuilder(builder);
+    return runLazily(builder, std::move(ModuleOwner), InitFns, CmdLine);
+  }
+
+  // Build the ExecutionEngine.
+  llvm::EngineBuilder builder(std::move(ModuleOwner));
+  std::string ErrorMsg;
+  configureBuilder(builder);
   builder.setErrorStr(&ErrorMsg);
   builder.setEngineKind(llvm::EngineKind::JIT);
   llvm::ExecutionEngine *EE = builder.create();
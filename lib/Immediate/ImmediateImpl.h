@@ -16,9 +16,11 @@
 #include "swift/AST/LinkLibrary.h"
 #include "swift/AST/SearchPathOptions.h"
 #include "swift/Basic/LLVM.h"
+#include "swift/Immediate/Immediate.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Object/ObjectFile.h"
 
 namespace llvm {
   class Function;
@@ -34,10 +36,26 @@ namespace swift {
 
 namespace immediate {
 
+/// A script compiled to an object file, along with everything needed to run
+/// it without the compiler.
+struct CompiledScript {
+  /// The libraries to load before the script is run.
+  SmallVector<LinkLibrary, 4> LinkLibraries;
+
+  /// The mangled names of the functions to run, in order, along with their
+  /// number of parameters. The last one is main().
+  SmallVector<std::pair<std::string, unsigned>, 8> EntryPoints;
+
+  llvm::object::OwningBinary<llvm::object::ObjectFile> Object;
+};
+
 bool loadSwiftRuntime(StringRef runtimeLibPath);
 bool tryLoadLibraries(ArrayRef<LinkLibrary> LinkLibraries,
                       SearchPathOptions SearchPathOpts,
                       DiagnosticEngine &Diags);
+void collectLinkLibraries(CompilerInstance &CI,
+                          const IRGenOptions &IRGenOpts,
+                          SmallVectorImpl<LinkLibrary> &AllLinkLibraries);
 bool linkLLVMModules(llvm::Module *Module,
                      std::unique_ptr<llvm::Module> SubModule);
 bool IRGenImportedModules(
@@ -48,6 +66,18 @@ bool IRGenImportedModules(
     IRGenOptions &IRGenOpts,
     const SILOptions &SILOpts);
 
+int runAsMain(uint64_t Addr, unsigned NumParams, const ProcessCmdLine &CmdLine);
+int runCompiledScript(CompiledScript &Script, const ProcessCmdLine &CmdLine);
+
+/// Loads the script stored at \p CacheEntry by storeCompiledScript.
+///
+/// \returns true if there is no usable script stored there
+bool loadCompiledScript(StringRef CacheEntry, CompiledScript &Script);
+
+/// Stores \p Script at \p CacheEntry. Failures are ignored, since they only
+/// mean that the script has to be compiled again on its next run.
+void storeCompiledScript(StringRef CacheEntry, const CompiledScript &Script);
+
 } // end namespace immediate
 } // end namespace swift
 
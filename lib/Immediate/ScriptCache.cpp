@@ -0,0 +1,194 @@
+//===--- ScriptCache.cpp - Cache of compiled scripts ----------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Scripts that are run over and over again, e.g. from cron, do not need to be
+// type-checked and compiled on every run. With -script-cache-path, immediate
+// mode stores the object file of a script along with a manifest of the
+// libraries and entry points it needs, and runs that directly the next time
+// the same script is run by the same compiler with the same arguments.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "swift-immediate"
+#include "swift/Immediate/Immediate.h"
+#include "ImmediateImpl.h"
+
+#include "swift/AST/ASTContext.h"
+#include "swift/Basic/SourceManager.h"
+#include "swift/Basic/Version.h"
+#include "swift/Frontend/Frontend.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace swift;
+using namespace swift::immediate;
+
+/// The first line of every manifest. Bump the version whenever the format of
+/// the manifest changes.
+static const char ManifestHeader[] = "swift-script-cache 1";
+
+std::string swift::getScriptCacheEntry(CompilerInstance &CI,
+                                       StringRef CachePath,
+                                       ArrayRef<const char *> Args) {
+  llvm::MD5 Hash;
+  auto addString = [&Hash](StringRef S) {
+    Hash.update(S);
+    Hash.update(StringRef("", 1));
+  };
+
+  addString(version::getSwiftFullVersion());
+
+  // Everything after "--" is passed to the script, not the compiler.
+  for (StringRef Arg : Args) {
+    if (Arg == "--")
+      break;
+    addString(Arg);
+  }
+
+  SourceManager &SM = CI.getSourceMgr();
+  for (unsigned BufferID : CI.getInputBufferIDs()) {
+    addString(SM.getIdentifierForBuffer(BufferID));
+    addString(SM.getLLVMSourceMgr().getMemoryBuffer(BufferID)->getBuffer());
+  }
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  llvm::MD5::stringifyResult(Result, Key);
+
+  SmallString<128> Entry(CachePath);
+  llvm::sys::path::append(Entry, Key);
+  return Entry.str();
+}
+
+bool swift::immediate::loadCompiledScript(StringRef CacheEntry,
+                                          CompiledScript &Script) {
+  auto ManifestOrErr = llvm::MemoryBuffer::getFile(CacheEntry + ".manifest");
+  if (!ManifestOrErr)
+    return true;
+
+  SmallVector<StringRef, 16> Lines;
+  ManifestOrErr.get()->getBuffer().split(Lines, '\n', -1,
+                                         /*KeepEmpty=*/false);
+  if (Lines.empty() || Lines.front() != ManifestHeader)
+    return true;
+
+  for (StringRef Line : llvm::makeArrayRef(Lines).slice(1)) {
+    StringRef Kind, Rest;
+    std::tie(Kind, Rest) = Line.split(' ');
+    if (Kind == "library") {
+      StringRef LibKind, ForceLoad, Name;
+      std::tie(LibKind, Rest) = Rest.split(' ');
+      std::tie(ForceLoad, Name) = Rest.split(' ');
+      unsigned LibKindValue;
+      if (LibKind.getAsInteger(10, LibKindValue) ||
+          LibKindValue > unsigned(LibraryKind::Framework) || Name.empty())
+        return true;
+      Script.LinkLibraries.push_back(
+          LinkLibrary(Name, LibraryKind(LibKindValue), ForceLoad == "1"));
+    } else if (Kind == "entry") {
+      StringRef NumParams, Name;
+      std::tie(NumParams, Name) = Rest.split(' ');
+      unsigned NumParamsValue;
+      if (NumParams.getAsInteger(10, NumParamsValue) || Name.empty())
+        return true;
+      Script.EntryPoints.push_back({Name.str(), NumParamsValue});
+    } else {
+      return true;
+    }
+  }
+  if (Script.EntryPoints.empty())
+    return true;
+
+  auto ObjectBufOrErr = llvm::MemoryBuffer::getFile(CacheEntry + ".o");
+  if (!ObjectBufOrErr)
+    return true;
+  auto ObjectOrErr = llvm::object::ObjectFile::createObjectFile(
+      ObjectBufOrErr.get()->getMemBufferRef());
+  if (!ObjectOrErr) {
+    llvm::consumeError(ObjectOrErr.takeError());
+    return true;
+  }
+
+  Script.Object = llvm::object::OwningBinary<llvm::object::ObjectFile>(
+      std::move(ObjectOrErr.get()), std::move(ObjectBufOrErr.get()));
+  return false;
+}
+
+/// Writes the file \p Path through a temporary file, so that concurrent runs
+/// of the same script never see it half-written.
+template <typename Fn>
+static void writeAtomically(const Twine &Path, Fn writeContents) {
+  SmallString<128> TmpPath;
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%.tmp", FD, TmpPath))
+    return;
+
+  bool HadError;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    writeContents(OS);
+    OS.close();
+    HadError = OS.has_error();
+    OS.clear_error();
+  }
+
+  if (HadError || llvm::sys::fs::rename(TmpPath, Path))
+    llvm::sys::fs::remove(TmpPath);
+}
+
+void swift::immediate::storeCompiledScript(StringRef CacheEntry,
+                                           const CompiledScript &Script) {
+  if (llvm::sys::fs::create_directories(
+          llvm::sys::path::parent_path(CacheEntry)))
+    return;
+
+  // The manifest is written last, so an entry with a manifest is complete.
+  writeAtomically(CacheEntry + ".o", [&](llvm::raw_ostream &OS) {
+    OS << Script.Object.getBinary()->getData();
+  });
+  writeAtomically(CacheEntry + ".manifest", [&](llvm::raw_ostream &OS) {
+    OS << ManifestHeader << '\n';
+    for (auto &Lib : Script.LinkLibraries) {
+      OS << "library " << unsigned(Lib.getKind()) << ' '
+         << unsigned(Lib.shouldForceLoad()) << ' ' << Lib.getName() << '\n';
+    }
+    for (auto &Entry : Script.EntryPoints)
+      OS << "entry " << Entry.second << ' ' << Entry.first << '\n';
+  });
+  DEBUG(llvm::dbgs() << "Stored script in cache entry " << CacheEntry
+                     << '\n');
+}
+
+bool swift::runCachedScript(CompilerInstance &CI, StringRef ScriptCacheEntry,
+                            const ProcessCmdLine &CmdLine, int &ReturnValue) {
+  CompiledScript Script;
+  if (loadCompiledScript(ScriptCacheEntry, Script))
+    return false;
+  DEBUG(llvm::dbgs() << "Running script from cache entry "
+                     << ScriptCacheEntry << '\n');
+
+  // Compiling the script diagnoses a missing runtime.
+  ASTContext &Context = CI.getASTContext();
+  if (!loadSwiftRuntime(Context.SearchPathOpts.RuntimeLibraryPath))
+    return false;
+  tryLoadLibraries(Script.LinkLibraries, Context.SearchPathOpts,
+                   CI.getDiags());
+
+  ReturnValue = runCompiledScript(Script, CmdLine);
+  return true;
+}
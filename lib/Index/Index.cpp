@@ -368,7 +368,7 @@ bool IndexSwiftASTWalker::handleSourceOrModuleFile(SourceFileOrModule SFOrMod,
     llvm::raw_svector_ostream HashOS(HashBuf);
     getModuleHash(SFOrMod, HashOS);
     StringRef Hash = HashOS.str();
-    HashIsKnown = Hash == KnownHash;
+    HashIsKnown = Hash == KnownHash || IdxConsumer.isUnitUpToDate(Hash);
     if (!IdxConsumer.recordHash(Hash, HashIsKnown))
       return false;
   }
@@ -439,7 +439,10 @@ bool IndexSwiftASTWalker::visitImports(
     if (!IdxConsumer.startDependency(ImportKind, Mod->getName().str(), Path,
                                      Mod->isSystemModule(), Hash))
       return false;
-    if (ImportKind != SymbolKind::ClangModule)
+    // The dependencies of a module whose unit is up to date were reported
+    // when the unit was recorded.
+    if (ImportKind != SymbolKind::ClangModule &&
+        !IdxConsumer.isUnitUpToDate(Hash))
       if (!visitImports(*Mod, Visited))
         return false;
     if (!IdxConsumer.finishDependency(ImportKind))
@@ -927,6 +930,16 @@ IndexSwiftASTWalker::hashFileReference(llvm::hash_code code,
   if (Filename.empty())
     return code;
 
+  // A source file is hashed by its contents, so that touching it or checking
+  // it out again doesn't make its unit out of date.
+  if (SourceFile *SF = SFOrMod.getAsSourceFile()) {
+    if (auto BufID = SF->getBufferID()) {
+      StringRef Text =
+          SrcMgr.getLLVMSourceMgr().getMemoryBuffer(*BufID)->getBuffer();
+      return hash_combine(code, Filename, llvm::hash_value(Text));
+    }
+  }
+
   // FIXME: FileManager for swift ?
 
   llvm::sys::fs::file_status Status;
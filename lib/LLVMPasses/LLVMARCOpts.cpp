@@ -64,6 +64,12 @@ STATISTIC(NumUnknownRetainReleaseSRed,
 llvm::cl::opt<bool>
 DisableARCOpts("disable-llvm-arc-opts", llvm::cl::init(false));
 
+static llvm::cl::opt<bool>
+PrintARCOpCounts("swift-llvm-arc-opts-print-counts", llvm::cl::init(false),
+                 llvm::cl::desc("Print the number of retains and releases in "
+                                "each function before and after LLVM ARC "
+                                "optimization"));
+
 //===----------------------------------------------------------------------===//
 //                          Input Function Canonicalizer
 //===----------------------------------------------------------------------===//
@@ -243,6 +249,103 @@ static bool canonicalizeInputFunction(Function &F, ARCEntryPointBuilder &B,
   return Changed;
 }
 
+//===----------------------------------------------------------------------===//
+//                       Local Retain/Release Pairing
+//===----------------------------------------------------------------------===//
+
+/// pairLocalRetainsAndReleases - Do a single forward scan over the block,
+/// zapping each release together with the closest retain before it of the
+/// same RC identity root, as long as nothing in between could need the
+/// retain.  Only instructions that don't touch memory and releases of other
+/// objects may be in between; this is what release motion would move the
+/// release over before reaching the retain.
+///
+/// Release motion and retain motion find the same pairs, but each of them
+/// rescans the block from its retain or release, which is quadratic for
+/// long runs of retains and releases.  Zapping the common pairs up front
+/// leaves them much less to do.
+static bool pairLocalRetainsAndReleases(BasicBlock &BB, SwiftRCIdentity *RC) {
+  bool Changed = false;
+
+  // The only retain a release can be paired with: any other instruction
+  // between it and the release would stop release motion.
+  CallInst *LastRetain = nullptr;
+  Value *LastRetainedObject = nullptr;
+
+  for (BasicBlock::iterator BBI = BB.begin(), E = BB.end(); BBI != E; ) {
+    Instruction &I = *BBI++;
+
+    switch (classifyInstruction(I)) {
+    case RT_NoMemoryAccessed:
+      continue;
+
+    case RT_UnknownRetain:
+    case RT_BridgeRetain:
+    case RT_ObjCRetain:
+    case RT_Retain:
+      LastRetain = cast<CallInst>(&I);
+      LastRetainedObject =
+          RC->getSwiftRCIdentityRoot(LastRetain->getArgOperand(0));
+      continue;
+
+    case RT_UnknownRelease:
+    case RT_BridgeRelease:
+    case RT_ObjCRelease:
+    case RT_Release: {
+      if (!LastRetain)
+        continue;
+      CallInst &Release = cast<CallInst>(I);
+      Value *ReleasedObject =
+          RC->getSwiftRCIdentityRoot(Release.getArgOperand(0));
+      if (ReleasedObject != LastRetainedObject)
+        continue;
+
+      assert(LastRetain->use_empty() && "Retain should have been "
+             "canonicalized to have no uses.");
+      if (LastRetain->getCalledFunction()->getName() == "objc_retain")
+        ++NumObjCRetainReleasePairs;
+      else
+        ++NumRetainReleasePairs;
+      LastRetain->eraseFromParent();
+      Release.eraseFromParent();
+      LastRetain = nullptr;
+      Changed = true;
+      continue;
+    }
+
+    default:
+      // Release motion stops at anything else, so it can't be paired with a
+      // retain before it.
+      LastRetain = nullptr;
+      continue;
+    }
+  }
+  return Changed;
+}
+
+/// countARCOps - Count the retains and releases in \p F.
+static unsigned countARCOps(Function &F) {
+  unsigned Count = 0;
+  for (Instruction &I : instructions(F)) {
+    switch (classifyInstruction(I)) {
+    case RT_UnknownRetain:
+    case RT_BridgeRetain:
+    case RT_ObjCRetain:
+    case RT_Retain:
+    case RT_RetainUnowned:
+    case RT_UnknownRelease:
+    case RT_BridgeRelease:
+    case RT_ObjCRelease:
+    case RT_Release:
+      ++Count;
+      break;
+    default:
+      break;
+    }
+  }
+  return Count;
+}
+
 //===----------------------------------------------------------------------===//
 //                         Release() Motion
 //===----------------------------------------------------------------------===//
@@ -909,7 +1012,9 @@ static bool performGeneralOptimizations(Function &F, ARCEntryPointBuilder &B,
   // TODO: This is a really trivial local algorithm.  It could be much better.
   for (BasicBlock &BB : F) {
     SmallVector<CallInst *, 8> RetainUnownedInsts;
-    
+
+    Changed |= pairLocalRetainsAndReleases(BB, RC);
+
     for (BasicBlock::iterator BBI = BB.begin(), E = BB.end(); BBI != E; ) {
       // Preincrement the iterator to avoid invalidation and out trouble.
       Instruction &I = *BBI++;
@@ -1003,6 +1108,8 @@ bool SwiftARCOpt::runOnFunction(Function &F) {
   ARCEntryPointBuilder B(F);
   RC = &getAnalysis<SwiftRCIdentity>();
 
+  unsigned NumARCOpsBefore = PrintARCOpCounts ? countARCOps(F) : 0;
+
   // First thing: canonicalize swift_retain and similar calls so that nothing
   // uses their result.  This exposes the copy that the function does to the
   // optimizer.
@@ -1017,5 +1124,10 @@ bool SwiftARCOpt::runOnFunction(Function &F) {
   //    escape.
   Changed |= performGeneralOptimizations(F, B, RC);
 
+  if (PrintARCOpCounts) {
+    llvm::errs() << "ARC ops in " << F.getName() << ": " << NumARCOpsBefore
+                 << " before, " << countARCOps(F) << " after\n";
+  }
+
   return Changed;
 }
@@ -61,6 +61,8 @@ using namespace swift;
 
 STATISTIC(NumSwiftFunctionsMerged, "Number of functions merged");
 STATISTIC(NumSwiftThunksWritten, "Number of thunks generated");
+STATISTIC(NumSwiftInstructionsRemoved,
+          "Number of instructions removed by merging functions");
 
 static cl::opt<unsigned> NumFunctionsForSanityCheck(
     "swiftmergefunc-sanity",
@@ -75,6 +77,12 @@ static cl::opt<unsigned> FunctionMergeThreshold(
              "'0' disables function merging at all."),
     cl::init(30), cl::Hidden);
 
+static cl::opt<unsigned> FunctionMergeSizeThreshold(
+    "swiftmergefunc-size-threshold",
+    cl::desc("Like -swiftmergefunc-threshold, but for functions which are "
+             "optimized for size."),
+    cl::init(10), cl::Hidden);
+
 namespace {
 
 // TODO: the following code (GlobalNumberState, FunctionComparator) is copied
@@ -1647,7 +1655,12 @@ static bool isEligibleFunction(Function *F) {
       Benefit += 1;
     }
   }
-  if (Benefit < FunctionMergeThreshold)
+  // Code size matters more than the cost of the thunks in functions which
+  // are optimized for size.
+  unsigned Threshold = FunctionMergeThreshold;
+  if (F->optForSize())
+    Threshold = std::min(Threshold, unsigned(FunctionMergeSizeThreshold));
+  if (Benefit < Threshold)
     return false;
   
   return true;
@@ -2001,6 +2014,12 @@ void SwiftMergeFunctions::mergeWithParams(const FunctionInfos &FInfos,
 
   for (unsigned FIdx = 0, NumFuncs = FInfos.size(); FIdx < NumFuncs; ++FIdx) {
     Function *OrigFunc = FInfos[FIdx].F;
+    // The body of the first function lives on in the merged function. The
+    // bodies of all others are removed.
+    if (FIdx != 0) {
+      for (BasicBlock &BB : *OrigFunc)
+        NumSwiftInstructionsRemoved += BB.size();
+    }
     if (replaceDirectCallers(OrigFunc, NewFunction, Params, FIdx)) {
       // We could replace all uses (and the function is not externally visible),
       // so we can delete the original function.
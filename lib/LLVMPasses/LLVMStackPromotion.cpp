@@ -52,9 +52,9 @@ INITIALIZE_PASS_END(SwiftStackPromotion,
                     "swift-stack-promotion", "Swift stack promotion pass",
                     false, false)
 
-llvm::FunctionPass *swift::createSwiftStackPromotionPass() {
+llvm::FunctionPass *swift::createSwiftStackPromotionPass(int SizeLimit) {
   initializeSwiftStackPromotionPass(*llvm::PassRegistry::getPassRegistry());
-  return new SwiftStackPromotion();
+  return new SwiftStackPromotion(SizeLimit);
 }
 
 void SwiftStackPromotion::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
@@ -157,7 +157,11 @@ bool SwiftStackPromotion::runOnFunction(Function &F) {
   bool Changed = false;
   Constant *allocFunc = nullptr;
   Constant *initFunc = nullptr;
+  // An explicit -stack-promotion-limit LLVM option overrides the limit which
+  // is passed by the frontend.
   int maxSize = LimitOpt;
+  if (SizeLimit >= 0 && LimitOpt.getNumOccurrences() == 0)
+    maxSize = SizeLimit;
   Module *M = F.getParent();
   const DataLayout &DL = M->getDataLayout();
   IntegerType *AllocType = nullptr;
@@ -13,6 +13,8 @@
 #include "swift/LLVMPasses/Passes.h"
 #include "LLVMARCOpts.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/LegacyPassManager.h" 
 #include "llvm/IR/Module.h"
 
@@ -56,6 +58,75 @@ llvm::ModRefInfo SwiftAAResult::getModRefInfo(llvm::ImmutableCallSite CS,
   return AAResultBase::getModRefInfo(CS, Loc);
 }
 
+namespace {
+/// The part of a Swift heap object which a memory location is known to be
+/// in.
+enum class HeapObjectPart {
+  Unknown,
+  /// The object header, i.e. the metadata pointer and the reference counts.
+  Header,
+  /// The stored properties, which are laid out after the header.
+  StoredProperties,
+};
+} // end anonymous namespace
+
+static bool isRefCountedHeaderType(llvm::Type *Ty) {
+  auto *STy = dyn_cast<StructType>(Ty);
+  if (!STy || !STy->hasName())
+    return false;
+  StringRef Name = STy->getName();
+  return Name == "swift.refcounted" || Name.startswith("swift.refcounted.");
+}
+
+/// Classify \p Loc by looking at the GEP which IRGen uses to project the
+/// header or a stored property out of a native Swift class instance:
+///   getelementptr %C, %C* %object, i32 0, i32 <field>, ...
+/// where the first field of %C is %swift.refcounted.
+static HeapObjectPart classifyHeapObjectAccess(const MemoryLocation &Loc) {
+  auto *GEP = dyn_cast<GEPOperator>(Loc.Ptr->stripPointerCasts());
+  if (!GEP || GEP->getNumIndices() < 2)
+    return HeapObjectPart::Unknown;
+
+  auto *ObjectTy = dyn_cast<StructType>(GEP->getSourceElementType());
+  if (!ObjectTy || ObjectTy->getNumElements() == 0 ||
+      !isRefCountedHeaderType(ObjectTy->getElementType(0)))
+    return HeapObjectPart::Unknown;
+
+  auto *FirstIdx = dyn_cast<ConstantInt>(GEP->getOperand(1));
+  auto *FieldIdx = dyn_cast<ConstantInt>(GEP->getOperand(2));
+  if (!FirstIdx || !FirstIdx->isZero() || !FieldIdx)
+    return HeapObjectPart::Unknown;
+
+  if (!FieldIdx->isZero())
+    return HeapObjectPart::StoredProperties;
+
+  // An access which starts in the header must also end in it.
+  auto *Header = ObjectTy->getElementType(0);
+  const DataLayout *DL = nullptr;
+  if (auto *I = dyn_cast<Instruction>(GEP))
+    DL = &I->getModule()->getDataLayout();
+  if (!DL || Loc.Size == MemoryLocation::UnknownSize ||
+      Loc.Size > DL->getTypeStoreSize(Header))
+    return HeapObjectPart::Unknown;
+  return HeapObjectPart::Header;
+}
+
+AliasResult SwiftAAResult::alias(const MemoryLocation &LocA,
+                                 const MemoryLocation &LocB) {
+  // Stored properties of one object never overlap the header of another
+  // object, or of the same object, since every object starts with a header.
+  // This lets loads of the metadata pointer move across stores to
+  // properties of unrelated objects.
+  auto PartA = classifyHeapObjectAccess(LocA);
+  if (PartA != HeapObjectPart::Unknown) {
+    auto PartB = classifyHeapObjectAccess(LocB);
+    if (PartB != HeapObjectPart::Unknown && PartA != PartB)
+      return NoAlias;
+  }
+
+  return AAResultBase::alias(LocA, LocB);
+}
+
 //===----------------------------------------------------------------------===//
 //                        Alias Analysis Wrapper Pass
 //===----------------------------------------------------------------------===//
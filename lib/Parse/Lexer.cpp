@@ -28,6 +28,8 @@
 // FIXME: Figure out if this can be migrated to LLVM.
 #include "clang/Basic/CharInfo.h"
 
+#include <cstring>
+
 using namespace swift;
 
 // clang::isIdentifierHead and clang::isIdentifierBody are deliberately not in
@@ -293,6 +295,60 @@ Lexer::State Lexer::getStateForBeginningOfTokenLoc(SourceLoc Loc) const {
 // Lexer Subroutines
 //===----------------------------------------------------------------------===//
 
+// The scanners below look at a word of the buffer at a time to skip runs of
+// bytes that don't need any attention, such as the text of a comment. Each
+// word is checked for any byte that might; if there is one, the byte-by-byte
+// code takes over from the start of the word.
+
+static const uint64_t AllOnes = ~uint64_t(0) / 0xFF;
+static const uint64_t AllHighBits = AllOnes * 0x80;
+
+/// Loads the word at \p Ptr, which need not be aligned.
+static inline uint64_t loadWord(const char *Ptr) {
+  uint64_t Word;
+  memcpy(&Word, Ptr, sizeof(Word));
+  return Word;
+}
+
+/// Returns true if any byte of \p Word is \p C.
+static inline bool wordHasByte(uint64_t Word, unsigned char C) {
+  uint64_t X = Word ^ (AllOnes * C);
+  return ((X - AllOnes) & ~X & AllHighBits) != 0;
+}
+
+/// Returns true if any byte of \p Word is a control character or not ASCII.
+static inline bool wordHasNonPrintable(uint64_t Word) {
+  return (((Word - AllOnes * 0x20) | Word) & AllHighBits) != 0 ||
+         wordHasByte(Word, 0x7F);
+}
+
+/// Advances \p Ptr over printable ASCII bytes other than \p Stop1 and
+/// \p Stop2, a word at a time, never reading past \p End. Any byte that
+/// stops the scan is left for the caller to handle; a few of the bytes before
+/// it may be too.
+static const char *skipPlainASCII(const char *Ptr, const char *End,
+                                  char Stop1, char Stop2) {
+  while (End - Ptr >= (ptrdiff_t)sizeof(uint64_t)) {
+    uint64_t Word = loadWord(Ptr);
+    if (wordHasNonPrintable(Word) || wordHasByte(Word, Stop1) ||
+        wordHasByte(Word, Stop2))
+      break;
+    Ptr += sizeof(uint64_t);
+  }
+  return Ptr;
+}
+
+/// Advances \p Ptr over a run of spaces and tabs, never reading past \p End.
+static const char *skipHorizontalWhitespace(const char *Ptr, const char *End) {
+  static const uint64_t AllSpaces = AllOnes * ' ';
+  while (End - Ptr >= (ptrdiff_t)sizeof(uint64_t) &&
+         loadWord(Ptr) == AllSpaces)
+    Ptr += sizeof(uint64_t);
+  while (*Ptr == ' ' || *Ptr == '\t')
+    ++Ptr;
+  return Ptr;
+}
+
 static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
   assert(Ptr && "invalid source location");
   assert(*Ptr == '\0' && "not an embedded null");
@@ -308,6 +364,7 @@ static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
 
 void Lexer::skipToEndOfLine() {
   while (1) {
+    CurPtr = skipPlainASCII(CurPtr, BufferEnd, '\n', '\n');
     switch (*CurPtr++) {
     case '\n':
     case '\r':
@@ -361,6 +418,7 @@ void Lexer::skipSlashStarComment() {
   unsigned Depth = 1;
   
   while (1) {
+    CurPtr = skipPlainASCII(CurPtr, BufferEnd, '*', '/');
     switch (*CurPtr++) {
     case '*':
       // Check for a '*/'
@@ -1232,6 +1290,9 @@ void Lexer::lexStringLiteral() {
   bool wasErroneous = false;
   
   while (true) {
+    // Skip over the plain characters, which lexCharacter would just return.
+    CurPtr = skipPlainASCII(CurPtr, BufferEnd, *TokStart, '\\');
+
     if (*CurPtr == '\\' && *(CurPtr + 1) == '(') {
       // Consume tokens until we hit the corresponding ')'.
       CurPtr += 2;
@@ -1647,6 +1708,9 @@ Restart:
 
   case ' ':
   case '\t':
+    CurPtr = skipHorizontalWhitespace(CurPtr, BufferEnd);
+    goto Restart;  // Skip whitespace.
+
   case '\f':
   case '\v':
     goto Restart;  // Skip whitespace.
@@ -112,6 +112,11 @@ namespace {
     llvm::StringMap<ValueBase*> LocalValues;
     llvm::StringMap<SourceLoc> ForwardRefLocalValues;
 
+    /// The SIL types which have been resolved so far, keyed by their source
+    /// text including attributes. Resolving a type goes through the type
+    /// checker, and a function spells the same few types over and over again.
+    llvm::StringMap<CanType> ResolvedSILTypes;
+
     bool performTypeLocChecking(TypeLoc &T, bool IsSIL = true);
     bool parseSpecConformanceSubstitutions(
                    SmallVectorImpl<ParsedSubstitution> &parsed);
@@ -225,7 +230,8 @@ namespace {
                                        SILValueCategory category,
                                        const TypeAttributes &attrs,
                                        GenericParamList *&genericParams,
-                                       bool IsFuncDecl = false);
+                                       bool IsFuncDecl = false,
+                                       SourceLoc AttrsLoc = SourceLoc());
     bool parseSILTypeWithoutQualifiers(SILType &Result,
                                        SILValueCategory category,
                                        const TypeAttributes &attrs) {
@@ -796,7 +802,8 @@ bool SILParser::parseSILTypeWithoutQualifiers(SILType &Result,
                                               SILValueCategory category,
                                               const TypeAttributes &attrs,
                                               GenericParamList *&GenericParams,
-                                              bool IsFuncDecl){
+                                              bool IsFuncDecl,
+                                              SourceLoc AttrsLoc){
   GenericParams = nullptr;
 
   // If this is part of a function decl, generic parameters are visible in the
@@ -822,6 +829,21 @@ bool SILParser::parseSILTypeWithoutQualifiers(SILType &Result,
       fnType->setGenericSignature(genericSig);
     }
   }
+
+  // If the caller told us where the attributes start, the source text of the
+  // attributes and the type determines the resolved type, unless the type
+  // declares generic parameters of its own.
+  StringRef TypeText;
+  if (AttrsLoc.isValid() && !GenericParams && !TyR.isParseError()) {
+    SourceLoc EndLoc = Lexer::getLocForEndOfToken(P.SourceMgr, P.PreviousLoc);
+    TypeText = P.SourceMgr.extractText(
+        CharSourceRange(P.SourceMgr, AttrsLoc, EndLoc));
+    auto Known = ResolvedSILTypes.find(TypeText);
+    if (Known != ResolvedSILTypes.end()) {
+      Result = SILType::getPrimitiveType(Known->second, category);
+      return false;
+    }
+  }
   
   // Apply attributes to the type.
   TypeLoc Ty = P.applyAttributeToType(TyR.get(), attrs);
@@ -829,8 +851,10 @@ bool SILParser::parseSILTypeWithoutQualifiers(SILType &Result,
   if (performTypeLocChecking(Ty))
     return true;
 
-  Result = SILType::getPrimitiveType(Ty.getType()->getCanonicalType(),
-                                     category);
+  CanType ResolvedTy = Ty.getType()->getCanonicalType();
+  if (!TypeText.empty())
+    ResolvedSILTypes[TypeText] = ResolvedTy;
+  Result = SILType::getPrimitiveType(ResolvedTy, category);
   return false;
 
 }
@@ -851,6 +875,7 @@ bool SILParser::parseSILType(SILType &Result, GenericParamList *&GenericParams,
   }
 
   // Parse attributes.
+  SourceLoc AttrsLoc = P.Tok.getLoc();
   TypeAttributes attrs;
   P.parseTypeAttributeList(attrs);
 
@@ -860,8 +885,11 @@ bool SILParser::parseSILType(SILType &Result, GenericParamList *&GenericParams,
     attrs.setAttr(TAK_convention, P.PreviousLoc);
     attrs.convention = "thin";
   }
+  // The implicit convention of a function declaration doesn't show up in its
+  // text, so only the types in its body are cached.
   return parseSILTypeWithoutQualifiers(Result, category, attrs, GenericParams,
-                                       IsFuncDecl);
+                                       IsFuncDecl,
+                                       IsFuncDecl ? SourceLoc() : AttrsLoc);
 }
 
 bool SILParser::parseSILDottedPath(ValueDecl *&Decl,
@@ -18,9 +18,10 @@
 #include "swift/Subsystems.h"
 #include "swift/AST/ASTWalker.h"
 #include "swift/AST/DiagnosticsParse.h"
+#include "swift/AST/PhaseTimer.h"
 #include "swift/AST/PrettyStackTrace.h"
 #include "swift/Basic/SourceManager.h"
-#include "swift/Basic/Timer.h"
+#include "swift/Basic/TraceEvents.h"
 #include "swift/Parse/Lexer.h"
 #include "swift/Parse/CodeCompletionCallbacks.h"
 #include "swift/Parse/DelayedParsingCallbacks.h"
@@ -137,7 +138,8 @@ bool swift::parseIntoSourceFile(SourceFile &SF,
                                 SILParserState *SIL,
                                 PersistentParserState *PersistentState,
                                 DelayedParsingCallbacks *DelayedParseCB) {
-  SharedTimer timer("Parsing");
+  SharedPhaseTimer timer(SF.getASTContext(), "Parsing");
+  TraceSpan span("Parse file", SF.getFilename());
   Parser P(BufferID, SF, SIL, PersistentState);
   PrettyStackTraceParser StackTrace(P);
 
@@ -155,7 +157,7 @@ bool swift::parseIntoSourceFile(SourceFile &SF,
 void swift::performDelayedParsing(
     DeclContext *DC, PersistentParserState &PersistentState,
     CodeCompletionCallbacksFactory *CodeCompletionFactory) {
-  SharedTimer timer("Parsing");
+  SharedPhaseTimer timer(DC->getASTContext(), "Parsing");
   ParseDelayedFunctionBodies Walker(PersistentState,
                                     CodeCompletionFactory);
   DC->walkContext(Walker);
@@ -34,6 +34,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
+#include <set>
 
 using namespace swift;
 
@@ -1897,33 +1898,37 @@ public:
   void writeImports(raw_ostream &out) {
     out << "#if defined(__has_feature) && __has_feature(modules)\n";
 
-    // Track printed names to handle overlay modules.
-    llvm::SmallPtrSet<Identifier, 8> seenImports;
+    // The modules are collected in the order the decls first use them. Print
+    // them sorted by name instead, so that the header only changes when the
+    // set of imports does. This also handles overlay modules, which share
+    // their name with the Clang module they import.
+    std::set<std::string> importNames;
     bool includeUnderlying = false;
     for (auto import : imports) {
       if (auto *swiftModule = import.dyn_cast<Module *>()) {
-        auto Name = swiftModule->getName();
         if (isUnderlyingModule(swiftModule)) {
           includeUnderlying = true;
           continue;
         }
-        if (seenImports.insert(Name).second)
-          out << "@import " << Name.str() << ";\n";
+        importNames.insert(swiftModule->getName().str());
       } else {
         const auto *clangModule = import.get<const clang::Module *>();
-        out << "@import ";
         // FIXME: This should be an API on clang::Module.
         SmallVector<StringRef, 4> submoduleNames;
         do {
           submoduleNames.push_back(clangModule->Name);
           clangModule = clangModule->Parent;
         } while (clangModule);
+        std::string fullName;
+        llvm::raw_string_ostream nameOS(fullName);
         interleave(submoduleNames.rbegin(), submoduleNames.rend(),
-                   [&out](StringRef next) { out << next; },
-                   [&out] { out << "."; });
-        out << ";\n";
+                   [&nameOS](StringRef next) { nameOS << next; },
+                   [&nameOS] { nameOS << "."; });
+        importNames.insert(nameOS.str());
       }
     }
+    for (auto &name : importNames)
+      out << "@import " << name << ";\n";
 
     out << "#endif\n\n";
 
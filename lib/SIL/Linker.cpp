@@ -16,6 +16,7 @@
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "swift/SIL/FormalLinkage.h"
 #include <functional>
@@ -24,6 +25,30 @@ using namespace swift;
 using namespace Lowering;
 
 STATISTIC(NumFuncLinked, "Number of SIL functions linked");
+STATISTIC(NumBodiesDeferred,
+          "Number of SIL function bodies left in their module");
+
+static llvm::cl::opt<unsigned> EagerLinkBodySizeLimit(
+    "sil-link-eager-body-size-limit", llvm::cl::init(1000),
+    llvm::cl::desc("Don't transitively link in the serialized bodies of "
+                   "non-generic functions larger than this many "
+                   "instructions"));
+
+/// Whether the body of \p Callee should stay in its module when it is
+/// reached while linking everything, until a client links it explicitly.
+///
+/// The body's serialized size is known without loading it. A large
+/// non-generic body is far beyond any inlining threshold and has nothing to
+/// specialize, so loading it eagerly only costs time and memory. Transparent
+/// and shared functions are always linked, since they must be emitted.
+static bool shouldDeferBody(SILFunction *Callee) {
+  return Callee->isExternalDeclaration() &&
+         Callee->getSerializedBodySize() > EagerLinkBodySizeLimit &&
+         !Callee->isTransparent() &&
+         !hasSharedVisibility(Callee->getLinkage()) &&
+         Callee->getInlineStrategy() != AlwaysInline &&
+         !Callee->getLoweredFunctionType()->isPolymorphic();
+}
 
 //===----------------------------------------------------------------------===//
 //                                  Utility
@@ -210,6 +235,11 @@ bool SILLinkerVisitor::visitApplyInst(ApplyInst *AI) {
       !hasSharedVisibility(Callee->getLinkage()))
     return false;
 
+  if (shouldDeferBody(Callee)) {
+    ++NumBodiesDeferred;
+    return false;
+  }
+
   // Otherwise we want to try and link in the callee... Add it to the callee
   // list and return true.
   addFunctionToWorklist(Callee);
@@ -224,6 +254,11 @@ bool SILLinkerVisitor::visitPartialApplyInst(PartialApplyInst *PAI) {
       !hasSharedVisibility(Callee->getLinkage()))
     return false;
 
+  if (shouldDeferBody(Callee)) {
+    ++NumBodiesDeferred;
+    return false;
+  }
+
   addFunctionToWorklist(Callee);
   return true;
 }
@@ -237,6 +272,11 @@ bool SILLinkerVisitor::visitFunctionRefInst(FunctionRefInst *FRI) {
       !hasSharedVisibility(Callee->getLinkage()))
     return false;
 
+  if (shouldDeferBody(Callee)) {
+    ++NumBodiesDeferred;
+    return false;
+  }
+
   addFunctionToWorklist(FRI->getReferencedFunction());
   return true;
 }
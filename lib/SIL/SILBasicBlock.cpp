@@ -168,6 +168,12 @@ void SILBasicBlock::moveAfter(SILBasicBlock *After) {
   BlkList.splice(InsertPt, BlkList, this);
 }
 
+void llvm::ilist_traits<swift::SILBasicBlock>::deleteNode(SILBasicBlock *BB) {
+  SILModule &M = BB->getModule();
+  BB->~SILBasicBlock();
+  M.deallocateBlock(BB);
+}
+
 void
 llvm::ilist_traits<swift::SILBasicBlock>::
 transferNodesFromList(llvm::ilist_traits<SILBasicBlock> &SrcTraits,
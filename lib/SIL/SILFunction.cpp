@@ -166,6 +166,12 @@ bool SILFunction::hasForeignBody() const {
 
 void SILFunction::numberValues(llvm::DenseMap<const ValueBase*,
                                unsigned> &ValueToNumberMap) const {
+  // Size the map up front; growing it rehashes every value numbered so far.
+  unsigned numValues = 0;
+  for (auto &BB : *this)
+    numValues += BB.getNumBBArg() + std::distance(BB.begin(), BB.end());
+  ValueToNumberMap.reserve(numValues);
+
   unsigned idx = 0;
   for (auto &BB : *this) {
     for (auto I = BB.bbarg_begin(), E = BB.bbarg_end(); I != E; ++I)
@@ -112,6 +112,21 @@ void SILModule::deallocateInst(SILInstruction *I) {
   AlignedFree(I);
 }
 
+void *SILModule::allocateBlock(unsigned Size, unsigned Align) const {
+  assert(Size == sizeof(SILBasicBlock) && Align <= alignof(SILBasicBlock) &&
+         "all blocks must fit into a recycled block");
+  if (!FreeBlocks.empty()) {
+    void *Mem = FreeBlocks.back();
+    FreeBlocks.pop_back();
+    return Mem;
+  }
+  return allocate(sizeof(SILBasicBlock), alignof(SILBasicBlock));
+}
+
+void SILModule::deallocateBlock(SILBasicBlock *BB) {
+  FreeBlocks.push_back(BB);
+}
+
 SILWitnessTable *
 SILModule::createWitnessTableDeclaration(ProtocolConformance *C,
                                          SILLinkage linkage) {
@@ -1677,11 +1677,14 @@ static void printLinkage(llvm::raw_ostream &OS, SILLinkage linkage,
 void SILFunction::print(SILPrintContext &PrintCtx) const {
   auto &SM = getModule().getASTContext().SourceMgr;
   llvm::raw_ostream &OS = PrintCtx.OS();
-  for (auto &BB : *this)
-    for (auto &I : BB) {
-      SILPrinter P(PrintCtx);
-      P.printDebugScope(I.getDebugScope(), SM);
-    }
+  {
+    // Every SILPrinter flushes and re-buffers the stream it wraps, so use a
+    // single one for all the scopes rather than one per instruction.
+    SILPrinter P(PrintCtx);
+    for (auto &BB : *this)
+      for (auto &I : BB)
+        P.printDebugScope(I.getDebugScope(), SM);
+  }
   OS << "\n";
 
   OS << "// " << demangleSymbol(getName()) << '\n';
@@ -31,6 +31,8 @@
 #include "swift/SIL/TypeLowering.h"
 #include "clang/AST/Type.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace swift;
 using namespace Lowering;
@@ -1279,6 +1281,17 @@ TypeConverter::~TypeConverter() {
     if (srcType == mappedType || isa<InOutType>(srcType))
       ti.second->~TypeLowering();
   }
+
+  // Likewise for the dependent TypeLowerings of every generic signature.
+  for (auto &types : DependentTypesBySignature) {
+    for (auto &ti : types.second) {
+      CanType srcType = ti.first.OrigType;
+      if (!srcType) continue;
+      CanType mappedType = ti.second->getLoweredType().getSwiftRValueType();
+      if (srcType == mappedType || isa<LValueType>(srcType))
+        ti.second->~TypeLowering();
+    }
+  }
 }
 
 void *TypeLowering::operator new(size_t size, TypeConverter &tc,
@@ -1291,22 +1304,34 @@ void *TypeLowering::operator new(size_t size, TypeConverter &tc,
 const TypeLowering *TypeConverter::find(TypeKey k) {
   if (!k.isCacheable()) return nullptr;
 
-  auto &Types = k.isDependent() ? DependentTypes : IndependentTypes;
+  // Outside of a generic context, dependent types aren't cached.
+  bool dependent = k.isDependent();
+  if (dependent && !DependentTypes) return nullptr;
+
+  auto &Types = dependent ? *DependentTypes : IndependentTypes;
   auto ck = k.getCachingKey();
   auto found = Types.find(ck);
   if (found == Types.end())
     return nullptr;
 
   assert(found->second && "type recursion not caught in Sema");
+  if (dependent)
+    ++NumDependentLoweringHits;
   return found->second;
 }
 
 void TypeConverter::insert(TypeKey k, const TypeLowering *tl) {
   if (!k.isCacheable()) return;
 
-  auto &Types = k.isDependent() ? DependentTypes : IndependentTypes;
+  bool dependent = k.isDependent();
+  if (dependent && !DependentTypes) return;
+
+  auto &Types = dependent ? *DependentTypes : IndependentTypes;
 
-  Types[k.getCachingKey()] = tl;
+  auto &entry = Types[k.getCachingKey()];
+  if (dependent && tl && !entry)
+    ++NumDependentLoweringsCreated;
+  entry = tl;
 }
 
 #ifndef NDEBUG
@@ -2003,10 +2028,16 @@ void TypeConverter::pushGenericContext(CanGenericSignature sig) {
     return;
   
   // GenericFunctionTypes shouldn't nest.
-  assert(DependentTypes.empty() && "already in generic context?!");
+  assert(!DependentTypes && "already in generic context?!");
   assert(!CurGenericContext && "already in generic context!");
 
   CurGenericContext = sig;
+
+  // Pick up the lowerings created the last time this signature was pushed.
+  auto inserted = DependentTypesBySignature.insert({sig, TypeLoweringMap()});
+  if (!inserted.second)
+    ++NumGenericContextsReused;
+  DependentTypes = &inserted.first->second;
 }
 
 void TypeConverter::popGenericContext(CanGenericSignature sig) {
@@ -2015,24 +2046,31 @@ void TypeConverter::popGenericContext(CanGenericSignature sig) {
     return;
 
   assert(CurGenericContext == sig && "unpaired push/pop");
-  
-  // Erase our cached TypeLowering objects and associated mappings for dependent
-  // types.
-  // Resetting the DependentBPA will deallocate but not run the destructor of
-  // the dependent TypeLowerings.
-  for (auto &ti : DependentTypes) {
-    // Destroy only the unique entries.
-    CanType srcType = ti.first.OrigType;
-    if (!srcType) continue;
-    CanType mappedType = ti.second->getLoweredType().getSwiftRValueType();
-    if (srcType == mappedType || isa<LValueType>(srcType))
-      ti.second->~TypeLowering();
-  }
-  DependentTypes.clear();
-  DependentBPA.Reset();
+
+  // The cached TypeLowering objects for dependent types stay in
+  // DependentTypesBySignature for the next function with this signature.
+  DependentTypes = nullptr;
   CurGenericContext = nullptr;
 }
 
+void TypeConverter::printStatistics(raw_ostream &out) const {
+  if (DependentTypesBySignature.empty())
+    return;
+
+  std::string rule = "===" + std::string(73, '-') + "===\n";
+  out << rule
+      << "                 Swift compilation dependent type lowerings\n"
+      << rule;
+  out << llvm::format("%12u", DependentTypesBySignature.size())
+      << "  Generic signatures\n";
+  out << llvm::format("%12u", NumGenericContextsReused)
+      << "  Generic contexts that reused cached lowerings\n";
+  out << llvm::format("%12u", NumDependentLoweringsCreated)
+      << "  Lowerings created\n";
+  out << llvm::format("%12u", NumDependentLoweringHits)
+      << "  Lowerings found in the cache\n\n";
+}
+
 ProtocolDispatchStrategy
 TypeConverter::getProtocolDispatchStrategy(ProtocolDecl *P) {
   // AnyObject has no requirements (other than the object being a class), so
@@ -41,6 +41,16 @@ namespace {
   };
 }
 
+CleanupManager::CleanupManager(SILGenFunction &Gen)
+  : Gen(Gen), Stack(Gen.SGM.takeCleanupStack()),
+    InnermostScope(Stack.stable_end()) {
+}
+
+CleanupManager::~CleanupManager() {
+  Gen.SGM.NumCleanupStackGrowths += NumStackGrowths;
+  Gen.SGM.returnCleanupStack(Stack);
+}
+
 void CleanupManager::popTopDeadCleanups(CleanupsDepth end) {
   Stack.checkIterator(end);
 
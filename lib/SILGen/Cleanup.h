@@ -83,13 +83,19 @@ typedef DiverseStackImpl<Cleanup>::stable_iterator CleanupsDepth;
 /// generally cannot be the stack's stable_end().
 typedef DiverseStackImpl<Cleanup>::stable_iterator CleanupHandle;
 
+/// The storage of a function's cleanups.
+typedef DiverseStack<Cleanup, 128> CleanupStack;
+
 class LLVM_LIBRARY_VISIBILITY CleanupManager {
   friend class Scope;
 
   SILGenFunction &Gen;
   
   /// Stack - Currently active cleanups in this scope tree.
-  DiverseStack<Cleanup, 128> Stack;
+  CleanupStack Stack;
+
+  /// The number of times Stack had to grow its storage.
+  unsigned NumStackGrowths = 0;
 
   /// The shallowest depth held by an active Scope object.
   ///
@@ -114,9 +120,8 @@ class LLVM_LIBRARY_VISIBILITY CleanupManager {
   friend class CleanupStateRestorationScope;
   
 public:
-  CleanupManager(SILGenFunction &Gen)
-    : Gen(Gen), InnermostScope(Stack.stable_end()) {
-  }
+  CleanupManager(SILGenFunction &Gen);
+  ~CleanupManager();
   
   /// Return a stable reference to the last cleanup pushed.
   CleanupsDepth getCleanupsDepth() const {
@@ -161,7 +166,10 @@ public:
     CleanupsDepth oldTop = Stack.stable_begin();
 #endif
     
+    size_t oldCapacity = Stack.capacity_in_bytes();
     T &cleanup = Stack.push<T, A...>(::std::forward<A>(args)...);
+    if (Stack.capacity_in_bytes() != oldCapacity)
+      ++NumStackGrowths;
     T &result = static_cast<T&>(initCleanup(cleanup, sizeof(T), state));
     
 #ifndef NDEBUG
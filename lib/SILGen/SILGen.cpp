@@ -15,11 +15,14 @@
 #include "Scope.h"
 #include "swift/Strings.h"
 #include "swift/AST/AST.h"
+#include "swift/AST/DiagnosticsFrontend.h"
 #include "swift/AST/DiagnosticsSIL.h"
 #include "swift/AST/NameLookup.h"
+#include "swift/AST/PhaseTimer.h"
 #include "swift/AST/PrettyStackTrace.h"
 #include "swift/AST/ResilienceExpansion.h"
 #include "swift/Basic/Timer.h"
+#include "swift/Basic/TraceEvents.h"
 #include "swift/ClangImporter/ClangModule.h"
 #include "swift/Serialization/SerializedModuleLoader.h"
 #include "swift/Serialization/SerializedSILLoader.h"
@@ -27,7 +30,9 @@
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILDebugScope.h"
 #include "swift/Subsystems.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
 #include "RValue.h"
 using namespace swift;
 using namespace Lowering;
@@ -39,11 +44,74 @@ using namespace Lowering;
 SILGenModule::SILGenModule(SILModule &M, Module *SM, bool makeModuleFragile)
   : M(M), Types(M.Types), SwiftModule(SM), TopLevelSGF(nullptr),
     Profiler(nullptr), makeModuleFragile(makeModuleFragile) {
+  const std::string &ProfilePath = M.getOptions().UseProfile;
+  if (!ProfilePath.empty()) {
+    auto ReaderOrErr = llvm::IndexedInstrProfReader::create(ProfilePath);
+    if (auto E = ReaderOrErr.takeError()) {
+      M.getASTContext().Diags.diagnose(SourceLoc(), diag::error_profile_read,
+                                       ProfilePath,
+                                       llvm::toString(std::move(E)));
+    } else {
+      PGOReader = std::move(ReaderOrErr.get());
+    }
+  }
 }
 
 SILGenModule::~SILGenModule() {
   assert(!TopLevelSGF && "active source file lowering!?");
   M.verify();
+  if (SharedTimer::compilationTimersEnabled())
+    printStatistics(llvm::errs());
+}
+
+CleanupStack SILGenModule::takeCleanupStack() {
+  ++NumCleanupStacks;
+
+  // Functions can be emitted while another one is being emitted, in which
+  // case the spare stack is already taken.
+  if (!SpareCleanupStack) {
+    CleanupStack Stack;
+    Stack.reserve(MaxCleanupStackCapacity);
+    return Stack;
+  }
+
+  ++NumCleanupStacksReused;
+  CleanupStack Stack(std::move(*SpareCleanupStack));
+  SpareCleanupStack.reset();
+  return Stack;
+}
+
+void SILGenModule::returnCleanupStack(CleanupStack &Stack) {
+  // Whatever is left on the stack at the end of the function has either been
+  // emitted or is dead, so it can simply be dropped.
+  Stack.clear();
+  MaxCleanupStackCapacity = std::max(MaxCleanupStackCapacity,
+                                     Stack.capacity_in_bytes());
+
+  // Keep the larger of the two stacks.
+  if (SpareCleanupStack &&
+      SpareCleanupStack->capacity_in_bytes() >= Stack.capacity_in_bytes())
+    return;
+  SpareCleanupStack.reset();
+  SpareCleanupStack.emplace(std::move(Stack));
+}
+
+void SILGenModule::printStatistics(raw_ostream &out) const {
+  if (NumCleanupStacks == 0)
+    return;
+
+  std::string rule = "===" + std::string(73, '-') + "===\n";
+  out << rule
+      << "                    Swift compilation SILGen cleanup stacks\n"
+      << rule;
+  out << llvm::format("%12u", NumCleanupStacks)
+      << "  Functions emitted\n";
+  out << llvm::format("%12u", NumCleanupStacksReused)
+      << "  Functions that reused a cleanup stack\n";
+  out << llvm::format("%12u", NumCleanupStackGrowths)
+      << "  Cleanup stack reallocations\n";
+  out << llvm::format("%12u", unsigned(MaxCleanupStackCapacity))
+      << "  Largest cleanup stack (bytes)\n\n";
 }
 
 static SILDeclRef
@@ -494,6 +562,9 @@ void SILGenModule::preEmitFunction(SILDeclRef constant,
 
   F->setDeclContext(astNode);
 
+  if (TraceSpan::isEnabled())
+    FunctionTraceStarts.push_back(TraceEventRecorder::now());
+
   DEBUG(llvm::dbgs() << "lowering ";
         F->printName(llvm::dbgs());
         llvm::dbgs() << " : $";
@@ -508,9 +579,16 @@ void SILGenModule::preEmitFunction(SILDeclRef constant,
 void SILGenModule::postEmitFunction(SILDeclRef constant,
                                     SILFunction *F) {
   assert(!F->isExternalDeclaration() && "did not emit any function body?!");
+  if (PGOReader)
+    applyProfileCounts(constant, F);
   DEBUG(llvm::dbgs() << "lowered sil:\n";
         F->print(llvm::dbgs()));
   F->verify();
+
+  if (auto *Recorder = TraceEventRecorder::getCurrent())
+    if (!FunctionTraceStarts.empty())
+      Recorder->recordSpan("SILGen function", F->getName(),
+                           FunctionTraceStarts.pop_back_val());
 }
 
 void SILGenModule::
@@ -1321,7 +1399,7 @@ std::unique_ptr<SILModule>
 SILModule::constructSIL(Module *mod, SILOptions &options, FileUnit *SF,
                         Optional<unsigned> startElem, bool makeModuleFragile,
                         bool isWholeModule) {
-  SharedTimer timer("SILGen");
+  SharedPhaseTimer timer(mod->getASTContext(), "SILGen");
   const DeclContext *DC;
   if (startElem) {
     assert(SF && "cannot have a start element without a source file");
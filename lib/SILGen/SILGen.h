@@ -25,6 +25,10 @@
 #include "llvm/ADT/DenseMap.h"
 #include <deque>
 
+namespace llvm {
+  class IndexedInstrProfReader;
+}
+
 namespace swift {
   class SILBasicBlock;
 
@@ -59,6 +63,9 @@ public:
   /// disabled.
   std::unique_ptr<SILGenProfiling> Profiler;
 
+  /// The profile data given with -profile-use, or null if there is none.
+  std::unique_ptr<llvm::IndexedInstrProfReader> PGOReader;
+
   /// Mapping from SILDeclRefs to emitted SILFunctions.
   llvm::DenseMap<SILDeclRef, SILFunction*> emittedFunctions;
   /// Mapping from ProtocolConformances to emitted SILWitnessTables.
@@ -99,6 +106,32 @@ public:
   /// The most recent conformance...
   NormalProtocolConformance *lastEmittedConformance = nullptr;
 
+  /// The cleanup stack storage of the last finished SILGenFunction, handed to
+  /// the next one so that every function does not grow its own stack again.
+  Optional<CleanupStack> SpareCleanupStack;
+
+  /// The largest cleanup stack capacity any function has needed so far.
+  /// Functions that cannot reuse the spare stack reserve this much up front.
+  size_t MaxCleanupStackCapacity = 0;
+
+  /// When a trace is recorded, the start times of the functions whose
+  /// emission is in progress, innermost last.
+  SmallVector<uint64_t, 4> FunctionTraceStarts;
+
+  /// Statistics printed with -debug-time-compilation.
+  unsigned NumCleanupStacks = 0;
+  unsigned NumCleanupStacksReused = 0;
+  unsigned NumCleanupStackGrowths = 0;
+
+  /// Return the storage for a new SILGenFunction's cleanup stack.
+  CleanupStack takeCleanupStack();
+
+  /// Keep the storage of a finished SILGenFunction's cleanup stack for reuse.
+  void returnCleanupStack(CleanupStack &Stack);
+
+  /// Print the cleanup stack statistics.
+  void printStatistics(raw_ostream &out) const;
+
   SILFunction *emitTopLevelFunction(SILLocation Loc);
   
   size_t anonymousSymbolCounter = 0;
@@ -272,6 +305,9 @@ public:
                        SILFunction *F,
                        SILLocation L);
   void postEmitFunction(SILDeclRef constant, SILFunction *F);
+
+  /// Attach the execution counts in the -profile-use data to \p F.
+  void applyProfileCounts(SILDeclRef constant, SILFunction *F);
   
   /// Add a global variable to the SILModule.
   void addGlobalVariable(VarDecl *global);
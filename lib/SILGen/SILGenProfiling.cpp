@@ -23,6 +23,7 @@
 #include "llvm/ProfileData/CoverageMapping.h"
 #include "llvm/ProfileData/CoverageMappingWriter.h"
 #include "llvm/ProfileData/InstrProf.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 
 #include <forward_list>
 
@@ -726,3 +727,35 @@ void SILGenProfiling::emitCounterIncrement(SILGenBuilder &Builder,ASTNode Node){
   Builder.createBuiltin(Loc, C.getIdentifier("int_instrprof_increment"),
                         SGM.Types.getEmptyTupleType(), {}, Args);
 }
+
+void SILGenModule::applyProfileCounts(SILDeclRef constant, SILFunction *F) {
+  // Counters are only assigned to the primary entry point of a declaration,
+  // under the same name and hash that -profile-generate uses.
+  if (!constant.hasDecl())
+    return;
+  auto *D = dyn_cast<AbstractFunctionDecl>(constant.getDecl());
+  if (!D || isUnmappedDecl(D) || constant != SILDeclRef(D))
+    return;
+
+  StringRef FileName;
+  if (auto *ParentFile = D->getParentSourceFile())
+    FileName = ParentFile->getFilename();
+  std::string PGOFuncName = llvm::getPGOFuncName(
+      constant.mangle(), getEquivalentPGOLinkage(getDeclLinkage(D)),
+      FileName);
+
+  // TODO: Keep in sync with the hash computed by assignRegionCounters.
+  uint64_t FunctionHash = 0x0;
+  auto RecordOrErr = PGOReader->getInstrProfRecord(PGOFuncName, FunctionHash);
+  if (auto E = RecordOrErr.takeError()) {
+    // Functions that never ran, or that changed since profiling, simply
+    // have no counts.
+    llvm::consumeError(std::move(E));
+    return;
+  }
+
+  // The first counter is the function body's.
+  const auto &Counts = RecordOrErr->Counts;
+  if (!Counts.empty())
+    F->setEntryCount(Counts[0]);
+}
@@ -37,6 +37,8 @@
 using namespace swift;
 
 STATISTIC(NumRefCountOpsRemoved, "Total number of increments removed");
+STATISTIC(NumLoopSummariesReused,
+          "Number of unchanged loops not analyzed again");
 
 llvm::cl::opt<bool> EnableLoopARC("enable-loop-arc", llvm::cl::init(true));
 
@@ -112,7 +114,21 @@ bool ARCPairingContext::performMatching(
 //                                  Loop ARC
 //===----------------------------------------------------------------------===//
 
+void LoopARCPairingContext::markBlockChanged(SILBasicBlock *BB) {
+  for (SILLoop *L = SLI->getLoopFor(BB); L; L = L->getParentLoop())
+    if (!ChangedLoops.insert(L).second)
+      break;
+}
+
 void LoopARCPairingContext::runOnLoop(SILLoop *L) {
+  // Processing a loop only looks at the instructions inside of it. If none of
+  // them changed, processing it again would not find anything new and its
+  // summary is still up to date.
+  if (!IsFirstRun && !ChangedLoops.count(L)) {
+    ++NumLoopSummariesReused;
+    return;
+  }
+
   auto *Region = LRFI->getRegion(L);
   if (processRegion(Region, false, false)) {
     // We do not recompute for now since we only look at the top function level
@@ -157,6 +173,7 @@ bool LoopARCPairingContext::processRegion(const LoopRegion *Region,
         auto *I = NewInsts.pop_back_val();
         DEBUG(llvm::dbgs() << "    " << *I);
         Evaluator.addInterestingInst(I);
+        markBlockChanged(I->getParent());
       } while (!NewInsts.empty());
     }
 
@@ -166,6 +183,7 @@ bool LoopARCPairingContext::processRegion(const LoopRegion *Region,
         SILInstruction *I = DeadInsts.pop_back_val();
         DEBUG(llvm::dbgs() << "    " << *I);
         Evaluator.removeInterestingInst(I);
+        markBlockChanged(I->getParent());
         I->eraseFromParent();
       } while (!DeadInsts.empty());
     }
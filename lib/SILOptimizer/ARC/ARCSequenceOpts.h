@@ -19,6 +19,7 @@
 #include "swift/SIL/SILValue.h"
 #include "swift/SILOptimizer/Utils/LoopUtils.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 
 namespace swift {
 
@@ -83,12 +84,22 @@ struct BlockARCPairingContext {
 /// ARCPairingContext. The loop nest is processed bottom up. For each loop, we
 /// run the evaluator on the loop and then use the ARCPairingContext to pair
 /// retains/releases and eliminate them.
+///
+/// If anything changed, the loop nest is processed a second time. Loops whose
+/// instructions were not changed by the first pass keep their summary and are
+/// not analyzed again.
 struct LoopARCPairingContext : SILLoopVisitor {
   ARCPairingContext Context;
   LoopARCSequenceDataflowEvaluator Evaluator;
   LoopRegionFunctionInfo *LRFI;
   SILLoopInfo *SLI;
 
+  /// Loops containing a block in which instructions were added or removed.
+  llvm::SmallPtrSet<SILLoop *, 8> ChangedLoops;
+
+  /// True while the loop nest is processed for the first time.
+  bool IsFirstRun = true;
+
   LoopARCPairingContext(SILFunction &F, AliasAnalysis *AA,
                         LoopRegionFunctionInfo *LRFI, SILLoopInfo *SLI,
                         RCIdentityFunctionInfo *RCFI,
@@ -102,10 +113,14 @@ struct LoopARCPairingContext : SILLoopVisitor {
     run();
     if (!madeChange())
       return false;
+    IsFirstRun = false;
     run();
     return true;
   }
 
+  /// Record that instructions were added to or removed from \p BB.
+  void markBlockChanged(SILBasicBlock *BB);
+
   bool madeChange() const { return Context.MadeChange; }
 
   void runOnLoop(SILLoop *L) override;
@@ -266,8 +266,11 @@ bool swift::mayHaveSymmetricInterference(SILInstruction *User, SILValue Ptr, Ali
   if (auto *TI = dyn_cast<TermInst>(User))
     return canTerminatorUseValue(TI, Ptr, AA);
 
-  // TODO: If we add in alias analysis support here for apply inst, we will need
-  // to check that the pointer does not escape.
+  // The release check above skips applies which don't read or write memory,
+  // e.g. of readnone callees, so check whether the pointer escapes to the
+  // callee.
+  if (auto FAS = FullApplySite::isa(User))
+    return AA->canApplyInterfereWithRelease(FAS, Ptr);
 
   // Otherwise, assume that Inst can use Target.
   return true;
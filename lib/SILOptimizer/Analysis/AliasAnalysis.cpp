@@ -24,12 +24,15 @@
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/SIL/InstructionUtils.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace swift;
 
+STATISTIC(NumAliasQueries, "Number of alias queries");
+STATISTIC(NumAliasCacheHits, "Number of alias queries answered by the cache");
 
 // The AliasAnalysis Cache must not grow beyond this size.
 // We limit the size of the AA cache to 2**14 because we want to limit the
@@ -538,10 +541,14 @@ bool AliasAnalysis::typesMayAlias(SILType T1, SILType T2) {
 AliasResult AliasAnalysis::alias(SILValue V1, SILValue V2,
                                  SILType TBAAType1, SILType TBAAType2) {
   AliasKeyTy Key = toAliasKey(V1, V2, TBAAType1, TBAAType2);
+  ++NumAliasQueries;
+  ++AliasCacheStats.NumQueries;
 
   // Check if we've already computed this result.
   auto It = AliasCache.find(Key);
   if (It != AliasCache.end()) {
+    ++NumAliasCacheHits;
+    ++AliasCacheStats.NumHits;
     return It->second;
   }
 
@@ -674,6 +681,26 @@ bool AliasAnalysis::canApplyDecrementRefCount(FullApplySite FAS, SILValue Ptr) {
   return false;
 }
 
+bool AliasAnalysis::canApplyInterfereWithRelease(FullApplySite FAS,
+                                                 SILValue Ptr) {
+  // Treat applications of @noreturn functions as barriers, like in
+  // canApplyDecrementRefCount.
+  if (FAS.getCallee()->getType().getAs<SILFunctionType>()->isNoReturn())
+    return true;
+
+  // If the pointer can escape to the function, the callee may use it.
+  if (EA->canEscapeTo(Ptr, FAS))
+    return true;
+
+  // The deinit of the released object can do anything, so the callee must not
+  // touch memory or reference counts at all. Retains in the callee cannot be
+  // retains of Ptr, because Ptr does not escape to the callee.
+  SideEffectAnalysis::FunctionEffects ApplyEffects;
+  SEA->getEffects(ApplyEffects, FAS);
+  return ApplyEffects.getMemBehavior(RetainObserveKind::IgnoreRetains) !=
+         MemoryBehavior::None;
+}
+
 bool AliasAnalysis::canBuiltinDecrementRefCount(BuiltinInst *BI, SILValue Ptr) {
   for (SILValue Arg : BI->getArguments()) {
     // A builtin can only release an object if it can escape to one of the
@@ -699,6 +726,10 @@ bool AliasAnalysis::mayValueReleaseInterfereWithInstruction(SILInstruction *User
   if (!User->mayReadOrWriteMemory())
     return false;
 
+  // For function calls, look at the side effects of the callee.
+  if (auto FAS = FullApplySite::isa(User))
+    return canApplyInterfereWithRelease(FAS, Ptr);
+
   // These instructions do read or write memory, get memory accessed.
   SILValue V = getAccessedMemory(User);
   if (!V)
@@ -760,11 +791,11 @@ SILAnalysis *swift::createAliasAnalysis(SILModule *M) {
 
 AliasKeyTy AliasAnalysis::toAliasKey(SILValue V1, SILValue V2,
                                      SILType Type1, SILType Type2) {
-  size_t idx1 = AliasValueBaseToIndex.getIndex(V1);
-  assert(idx1 != std::numeric_limits<size_t>::max() &&
+  ValueIndexTy idx1 = AliasValueBaseToIndex.getIndex(V1);
+  assert(idx1 != std::numeric_limits<ValueIndexTy>::max() &&
          "~0 index reserved for empty/tombstone keys");
-  size_t idx2 = AliasValueBaseToIndex.getIndex(V2);
-  assert(idx2 != std::numeric_limits<size_t>::max() &&
+  ValueIndexTy idx2 = AliasValueBaseToIndex.getIndex(V2);
+  assert(idx2 != std::numeric_limits<ValueIndexTy>::max() &&
          "~0 index reserved for empty/tombstone keys");
   void *t1 = Type1.getOpaqueValue();
   void *t2 = Type2.getOpaqueValue();
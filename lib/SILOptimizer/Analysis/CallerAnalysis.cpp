@@ -19,7 +19,7 @@
 using namespace swift;
 
 void CallerAnalysis::processFunctionCallSites(SILFunction *F) {
-  // Scan the whole module and search Apply sites.
+  // Scan the function and search Apply sites.
   for (auto &BB : *F) {
     for (auto &II : BB) {
       if (auto Apply = FullApplySite::isa(&II)) {
@@ -27,10 +27,12 @@ void CallerAnalysis::processFunctionCallSites(SILFunction *F) {
         if (!CalleeFn)
           continue;
 
-        // Update the callee information for this function.
+        // Update the callee information for this function. Look it up for
+        // every callee, because inserting the callee's entry may move it.
         CallerAnalysisFunctionInfo &CallerInfo
                                = CallInfo.FindAndConstruct(F).second;
-        CallerInfo.Callees.insert(CalleeFn);
+        if (!CallerInfo.Callees.insert(CalleeFn))
+          continue;
         
         // Update the callsite information for the callee.
         CallerAnalysisFunctionInfo &CalleeInfo
@@ -48,6 +50,20 @@ void CallerAnalysis::invalidateExistingCalleeRelation(SILFunction *F) {
                                     = CallInfo.FindAndConstruct(Callee).second;
     CalleeInfo.Callers.remove(F);
   }
+  // The callees are recomputed together with the callers.
+  CallerInfo.Callees.clear();
+}
+
+void CallerAnalysis::removeFunction(SILFunction *F) {
+  invalidateExistingCalleeRelation(F);
+
+  auto Iter = CallInfo.find(F);
+  for (auto Caller : Iter->second.Callers) {
+    auto CallerIter = CallInfo.find(Caller);
+    if (CallerIter != CallInfo.end())
+      CallerIter->second.Callees.remove(F);
+  }
+  CallInfo.erase(Iter);
 }
 
 //===----------------------------------------------------------------------===//
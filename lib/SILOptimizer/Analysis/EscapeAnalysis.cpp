@@ -17,11 +17,27 @@
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILArgument.h"
+#include "swift/Basic/Timer.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace swift;
 
+STATISTIC(NumRecomputations, "Number of escape analysis recomputations");
+STATISTIC(NumFunctionsRecomputed,
+          "Number of connection graphs built by escape analysis");
+STATISTIC(NumFullInvalidations,
+          "Number of times all connection graphs were discarded");
+STATISTIC(NumGraphsTooLarge,
+          "Number of connection graphs which exceeded the node limit");
+
+static llvm::cl::opt<unsigned> MaxNodesPerGraph(
+    "escape-analysis-max-nodes", llvm::cl::init(10000),
+    llvm::cl::desc("The number of nodes in a connection graph above which "
+                   "values are conservatively treated as escaping"));
+
 static bool isProjection(ValueBase *V) {
   switch (V->getKind()) {
     case ValueKind::IndexAddrInst:
@@ -1046,12 +1062,25 @@ void EscapeAnalysis::buildConnectionGraph(FunctionInfo *FInfo,
   llvm::SmallVector<SILBasicBlock *, 16> WorkList;
   VisitedBlocks.insert(&*ConGraph->F->begin());
   WorkList.push_back(&*ConGraph->F->begin());
+  bool TooLarge = false;
 
   while (!WorkList.empty()) {
     SILBasicBlock *BB = WorkList.pop_back_val();
 
     // Create edges for the instructions.
     for (auto &I : *BB) {
+      // Once the graph is too large, treat the remaining instructions like
+      // unknown instructions, which only adds nodes for their values. Returned
+      // values must still be linked to the return node, though.
+      if (!isa<ReturnInst>(&I) && isGraphTooLarge(ConGraph)) {
+        if (!TooLarge) {
+          DEBUG(llvm::dbgs() << "  graph is too large, give up at " << I);
+          ++NumGraphsTooLarge;
+          TooLarge = true;
+        }
+        setAllEscaping(&I, ConGraph);
+        continue;
+      }
       analyzeInstruction(&I, FInfo, BottomUpOrder, RecursionDepth);
     }
     for (auto &Succ : BB->getSuccessors()) {
@@ -1477,6 +1506,10 @@ bool EscapeAnalysis::deinitIsKnownToNotCapture(SILValue V) {
   }
 }
 
+bool EscapeAnalysis::isGraphTooLarge(ConnectionGraph *ConGraph) {
+  return ConGraph->Nodes.size() > MaxNodesPerGraph;
+}
+
 void EscapeAnalysis::setAllEscaping(SILInstruction *I,
                                     ConnectionGraph *ConGraph) {
   if (auto *TAI = dyn_cast<TryApplyInst>(I)) {
@@ -1498,7 +1531,9 @@ void EscapeAnalysis::setAllEscaping(SILInstruction *I,
 }
 
 void EscapeAnalysis::recompute(FunctionInfo *Initial) {
+  SharedTimer timer("Escape analysis recomputation");
   allocNewUpdateID();
+  ++NumRecomputations;
 
   DEBUG(llvm::dbgs() << "recompute escape analysis with UpdateID " <<
         getCurrentUpdateID() << '\n');
@@ -1510,6 +1545,8 @@ void EscapeAnalysis::recompute(FunctionInfo *Initial) {
   // Build the bottom-up order.
   BottomUpOrder.tryToSchedule(Initial);
   BottomUpOrder.finishScheduling();
+  NumFunctionsRecomputed += std::distance(BottomUpOrder.begin(),
+                                          BottomUpOrder.end());
 
   // Second step: propagate the connection graphs up the call-graph until it
   // stabilizes.
@@ -1590,6 +1627,13 @@ void EscapeAnalysis::recompute(FunctionInfo *Initial) {
 bool EscapeAnalysis::mergeCalleeGraph(FullApplySite FAS,
                                       ConnectionGraph *CallerGraph,
                                       ConnectionGraph *CalleeGraph) {
+  // Don't let callee graphs grow a graph which is already too large. Treat the
+  // call like a call to an unknown function instead.
+  if (isGraphTooLarge(CallerGraph)) {
+    setAllEscaping(FAS.getInstruction(), CallerGraph);
+    return true;
+  }
+
   CGNodeMap Callee2CallerMapping;
 
   // First map the callee parameters to the caller arguments.
@@ -1838,6 +1882,13 @@ bool EscapeAnalysis::canParameterEscape(FullApplySite FAS, int ParamIdx,
 }
 
 void EscapeAnalysis::invalidate(InvalidationKind K) {
+  // Adding functions doesn't change existing connection graphs, and deleted
+  // functions are reported one by one through invalidateForDeadFunction.
+  if (!(K & InvalidationKind::FunctionBody))
+    return;
+
+  if (!Function2Info.empty())
+    ++NumFullInvalidations;
   Function2Info.clear();
   Allocator.DestroyAll();
   DEBUG(llvm::dbgs() << "invalidate all\n");
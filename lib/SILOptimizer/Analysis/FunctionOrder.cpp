@@ -78,3 +78,37 @@ void BottomUpFunctionOrder::FindSCCs(SILModule &M) {
   for (auto &F : M)
     DFS(&F);
 }
+
+void BottomUpFunctionOrder::computeSCCLevels() {
+  auto SCCs = getSCCs();
+
+  llvm::DenseMap<SILFunction *, unsigned> SCCIndex;
+  for (unsigned i = 0, e = SCCs.size(); i != e; ++i)
+    for (auto *F : SCCs[i])
+      SCCIndex[F] = i;
+
+  // Callees are always in earlier SCCs, so their levels are known by the
+  // time we reach their callers.
+  TheSCCLevels.reserve(SCCs.size());
+  for (unsigned i = 0, e = SCCs.size(); i != e; ++i) {
+    unsigned Level = 0;
+    for (auto *F : SCCs[i]) {
+      for (auto &B : *F) {
+        for (auto &I : B) {
+          auto FAS = FullApplySite::isa(&I);
+          if (!FAS)
+            continue;
+
+          for (auto *CalleeFn : BCA->getCalleeList(FAS)) {
+            auto Callee = SCCIndex.find(CalleeFn);
+            if (Callee == SCCIndex.end() || Callee->second == i)
+              continue;
+            assert(Callee->second < i && "callee SCC not bottom-up ordered");
+            Level = std::max(Level, TheSCCLevels[Callee->second] + 1);
+          }
+        }
+      }
+    }
+    TheSCCLevels.push_back(Level);
+  }
+}
@@ -17,10 +17,15 @@
 #include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SIL/SILVisitor.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
 
+STATISTIC(NumMemBehaviorQueries, "Number of memory behavior queries");
+STATISTIC(NumMemBehaviorCacheHits,
+          "Number of memory behavior queries answered by the cache");
+
 // The MemoryBehavior Cache must not grow beyond this size.
 // We limit the size of the MB cache to 2**14 because we want to limit the
 // memory usage of this cache.
@@ -305,9 +310,14 @@ AliasAnalysis::computeMemoryBehavior(SILInstruction *Inst, SILValue V,
                                      RetainObserveKind InspectionMode) {
   MemBehaviorKeyTy Key = toMemoryBehaviorKey(SILValue(Inst), V,
                                              InspectionMode);
+  ++NumMemBehaviorQueries;
+  ++MemoryBehaviorCacheStats.NumQueries;
+
   // Check if we've already computed this result.
   auto It = MemoryBehaviorCache.find(Key);
   if (It != MemoryBehaviorCache.end()) {
+    ++NumMemBehaviorCacheHits;
+    ++MemoryBehaviorCacheStats.NumHits;
     return It->second;
   }
 
@@ -337,11 +347,11 @@ AliasAnalysis::computeMemoryBehaviorInner(SILInstruction *Inst, SILValue V,
 
 MemBehaviorKeyTy AliasAnalysis::toMemoryBehaviorKey(SILValue V1, SILValue V2,
                                                     RetainObserveKind M) {
-  size_t idx1 = MemoryBehaviorValueBaseToIndex.getIndex(V1);
-  assert(idx1 != std::numeric_limits<size_t>::max() &&
+  ValueIndexTy idx1 = MemoryBehaviorValueBaseToIndex.getIndex(V1);
+  assert(idx1 != std::numeric_limits<ValueIndexTy>::max() &&
          "~0 index reserved for empty/tombstone keys");
-  size_t idx2 = MemoryBehaviorValueBaseToIndex.getIndex(V2);
-  assert(idx2 != std::numeric_limits<size_t>::max() &&
+  ValueIndexTy idx2 = MemoryBehaviorValueBaseToIndex.getIndex(V2);
+  assert(idx2 != std::numeric_limits<ValueIndexTy>::max() &&
          "~0 index reserved for empty/tombstone keys");
   return {idx1, idx2, M};
 }
@@ -16,9 +16,17 @@
 #include "swift/SILOptimizer/Analysis/FunctionOrder.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILArgument.h"
+#include "swift/Basic/Timer.h"
+#include "llvm/ADT/Statistic.h"
 
 using namespace swift;
 
+STATISTIC(NumRecomputations, "Number of side-effect analysis recomputations");
+STATISTIC(NumFunctionsRecomputed,
+          "Number of functions analyzed by side-effect analysis");
+STATISTIC(NumFullInvalidations,
+          "Number of times all side-effect information was discarded");
+
 using FunctionEffects = SideEffectAnalysis::FunctionEffects;
 using Effects = SideEffectAnalysis::Effects;
 using MemoryBehavior = SILInstruction::MemoryBehavior;
@@ -415,7 +423,9 @@ void SideEffectAnalysis::initialize(SILPassManager *PM) {
 }
 
 void SideEffectAnalysis::recompute(FunctionInfo *Initial) {
+  SharedTimer timer("Side-effect analysis recomputation");
   allocNewUpdateID();
+  ++NumRecomputations;
 
   DEBUG(llvm::dbgs() << "recompute side-effect analysis with UpdateID " <<
         getCurrentUpdateID() << '\n');
@@ -427,6 +437,8 @@ void SideEffectAnalysis::recompute(FunctionInfo *Initial) {
   // Build the bottom-up order.
   BottomUpOrder.tryToSchedule(Initial);
   BottomUpOrder.finishScheduling();
+  NumFunctionsRecomputed += std::distance(BottomUpOrder.begin(),
+                                          BottomUpOrder.end());
 
   // Second step: propagate the side-effect information up the call-graph until
   // it stabilizes.
@@ -501,6 +513,14 @@ void SideEffectAnalysis::getEffects(FunctionEffects &ApplyEffects, FullApplySite
 }
 
 void SideEffectAnalysis::invalidate(InvalidationKind K) {
+  // Adding functions doesn't change the effects of existing ones, and
+  // deleted functions are reported one by one through
+  // invalidateForDeadFunction.
+  if (!(K & InvalidationKind::FunctionBody))
+    return;
+
+  if (!Function2Info.empty())
+    ++NumFullInvalidations;
   Function2Info.clear();
   Allocator.DestroyAll();
   DEBUG(llvm::dbgs() << "invalidate all\n");
@@ -319,6 +319,7 @@ void CapturePropagation::run() {
   DominanceAnalysis *DA = PM->getAnalysis<DominanceAnalysis>();
   bool HasChanged = false;
   for (auto &F : *getModule()) {
+    bool FunctionChanged = false;
 
     // Don't optimize functions that are marked with the opt.never attribute.
     if (!F.shouldOptimize())
@@ -335,13 +336,20 @@ void CapturePropagation::run() {
         SILInstruction *Inst = &*I;
         ++I;
         if (PartialApplyInst *PAI = dyn_cast<PartialApplyInst>(Inst))
-          HasChanged |= optimizePartialApply(PAI);
+          FunctionChanged |= optimizePartialApply(PAI);
       }
     }
+
+    // Only the functions whose partial applies we rewrote have changed.
+    if (FunctionChanged) {
+      invalidateAnalysis(&F, SILAnalysis::InvalidationKind::FunctionBody);
+      HasChanged = true;
+    }
   }
 
+  // We also added the specialized closures.
   if (HasChanged) {
-    invalidateAnalysis(SILAnalysis::InvalidationKind::Everything);
+    invalidateAnalysis(SILAnalysis::InvalidationKind::Functions);
   }
 }
 
@@ -52,10 +52,21 @@
 /// 3. Handling addresses. We currently do not handle address types. We can in
 ///    the future by introducing alloc_stacks.
 ///
+/// A closure is often passed through wrapper functions before it is invoked.
+/// We specialize a wrapper if it forwards the closure to a function which
+/// invokes it, and then specialize the new function as well, so that the
+/// closure is propagated down the whole chain.
+///
+/// Every specialization clones the callee, so large callees are only
+/// specialized if the call site is in a loop. The body of the closure itself
+/// is not cloned and does not add to the cost.
+///
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "closure-specialization"
 #include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SIL/Dominance.h"
+#include "swift/SIL/LoopInfo.h"
 #include "swift/SIL/Mangle.h"
 #include "swift/SIL/SILCloner.h"
 #include "swift/SIL/SILFunction.h"
@@ -80,12 +91,28 @@ STATISTIC(NumPropagatedClosuresEliminated,
           "Number of closures propagated and then eliminated");
 STATISTIC(NumPropagatedClosuresNotEliminated,
           "Number of closures propagated but not eliminated");
+STATISTIC(NumCallSitesTooLarge,
+          "Number of call sites not specialized because the callee is large");
 
 llvm::cl::opt<bool> EliminateDeadClosures(
     "closure-specialize-eliminate-dead-closures", llvm::cl::init(true),
     llvm::cl::desc("Do not eliminate dead closures after closure "
                    "specialization. This is meant ot be used when testing."));
 
+llvm::cl::opt<unsigned> CalleeSizeLimit(
+    "closure-specialize-callee-size-limit", llvm::cl::init(400),
+    llvm::cl::desc("The number of instructions of a callee above which it is "
+                   "only specialized for call sites in loops."));
+
+llvm::cl::opt<unsigned> MaxPropagationDepth(
+    "closure-specialize-max-propagation-depth", llvm::cl::init(4),
+    llvm::cl::desc("The number of wrapper functions a closure is propagated "
+                   "through."));
+
+/// Call sites in loops may clone callees this many times larger than the
+/// size limit.
+static const unsigned LoopCalleeSizeFactor = 4;
+
 //===----------------------------------------------------------------------===//
 //                                  Utility
 //===----------------------------------------------------------------------===//
@@ -94,6 +121,38 @@ static bool isSupportedClosureKind(const SILInstruction *I) {
   return isa<ThinToThickFunctionInst>(I) || isa<PartialApplyInst>(I);
 }
 
+static unsigned getFunctionSize(SILFunction *F) {
+  unsigned Size = 0;
+  for (auto &BB : *F)
+    Size += std::distance(BB.begin(), BB.end());
+  return Size;
+}
+
+/// Returns true if the closure passed as argument \p ArgIndex of \p Callee is
+/// invoked in \p Callee, or forwarded to a function which invokes it through
+/// at most \p Depth wrapper functions.
+static bool isClosureInvoked(SILFunction *Callee, unsigned ArgIndex,
+                             unsigned Depth) {
+  SILValue Arg = Callee->getArgument(ArgIndex);
+  for (Operand *Op : Arg->getUses()) {
+    auto UserAI = FullApplySite::isa(Op->getUser());
+    if (!UserAI)
+      continue;
+    if (UserAI.getCallee() == Arg)
+      return true;
+
+    if (Depth == 0 || UserAI.hasSubstitutions())
+      continue;
+    SILFunction *Wrapped = UserAI.getReferencedFunction();
+    if (!Wrapped || Wrapped->isExternalDeclaration())
+      continue;
+    unsigned WrappedIndex = Op - UserAI.getArgumentOperands().begin();
+    if (isClosureInvoked(Wrapped, WrappedIndex, Depth - 1))
+      return true;
+  }
+  return false;
+}
+
 //===----------------------------------------------------------------------===//
 //                       Closure Spec Cloner Interface
 //===----------------------------------------------------------------------===//
@@ -426,8 +485,10 @@ void CallSiteDescriptor::extendArgumentLifetime(SILValue Arg) const {
   }
 }
 
-static void specializeClosure(ClosureInfo &CInfo,
-                              CallSiteDescriptor &CallDesc) {
+/// Rewrites the call site to call a specialization of its callee, and returns
+/// the specialization if it was newly created.
+static SILFunction *specializeClosure(ClosureInfo &CInfo,
+                                      CallSiteDescriptor &CallDesc) {
   auto NewFName = CallDesc.createName();
   DEBUG(llvm::dbgs() << "    Perform optimizations with new name " << NewFName
                      << '\n');
@@ -438,11 +499,13 @@ static void specializeClosure(ClosureInfo &CInfo,
 
   // If not, create a specialized version of ApplyCallee calling the closure
   // directly.
+  SILFunction *CreatedF = nullptr;
   if (!NewF)
-    NewF = ClosureSpecCloner::cloneFunction(CallDesc, NewFName);
+    NewF = CreatedF = ClosureSpecCloner::cloneFunction(CallDesc, NewFName);
 
   // Rewrite the call
   rewriteApplyInst(CallDesc, NewF);
+  return CreatedF;
 }
 
 static bool isSupportedClosure(const SILInstruction *Closure) {
@@ -695,6 +758,27 @@ class ClosureSpecializer {
   std::vector<SILInstruction *> PropagatedClosures;
   bool IsPropagatedClosuresUniqued = false;
 
+  /// Specializations which may have to be specialized themselves, because
+  /// they forward the propagated closure to another function.
+  llvm::SmallVector<SILFunction *, 8> NewSpecializations;
+
+  /// All functions created by this specializer.
+  llvm::SmallVector<SILFunction *, 8> CreatedFunctions;
+
+  /// The number of wrapper functions closures were propagated through to
+  /// create a specialization. Functions which are not in the map have a
+  /// depth of zero.
+  llvm::DenseMap<SILFunction *, unsigned> PropagationDepth;
+
+  unsigned getPropagationDepth(SILFunction *F) const {
+    auto Iter = PropagationDepth.find(F);
+    return Iter == PropagationDepth.end() ? 0 : Iter->second;
+  }
+
+  bool isProfitable(FullApplySite AI, SILFunction *ApplyCallee,
+                    std::unique_ptr<SILLoopInfo> &LI,
+                    std::unique_ptr<DominanceInfo> &DT);
+
 public:
   ClosureSpecializer() = default;
 
@@ -703,6 +787,14 @@ public:
                        llvm::DenseSet<FullApplySite> &MultipleClosureAI);
   bool specialize(SILFunction *Caller);
 
+  /// Returns the next specialization that has to be visited, if any.
+  SILFunction *popNewSpecialization() {
+    return NewSpecializations.empty() ? nullptr
+                                      : NewSpecializations.pop_back_val();
+  }
+
+  ArrayRef<SILFunction *> getCreatedFunctions() { return CreatedFunctions; }
+
   ArrayRef<SILInstruction *> getPropagatedClosures() {
     if (IsPropagatedClosuresUniqued)
       return PropagatedClosures;
@@ -716,6 +808,28 @@ public:
 
 } // end anonymous namespace
 
+/// Returns true if the clone of \p ApplyCallee is worth its size: the callee
+/// is small, or the call site is in a loop and the callee is not too large.
+///
+/// The loop info of the caller is only computed if it is needed.
+bool ClosureSpecializer::isProfitable(FullApplySite AI,
+                                      SILFunction *ApplyCallee,
+                                      std::unique_ptr<SILLoopInfo> &LI,
+                                      std::unique_ptr<DominanceInfo> &DT) {
+  unsigned CalleeSize = getFunctionSize(ApplyCallee);
+  if (CalleeSize <= CalleeSizeLimit)
+    return true;
+  if (CalleeSize > CalleeSizeLimit * LoopCalleeSizeFactor)
+    return false;
+
+  if (!LI) {
+    SILFunction *Caller = AI.getFunction();
+    DT.reset(new DominanceInfo(Caller));
+    LI.reset(new SILLoopInfo(Caller, DT.get()));
+  }
+  return LI->getLoopFor(AI.getParent()) != nullptr;
+}
+
 void ClosureSpecializer::gatherCallSites(
     SILFunction *Caller,
     llvm::SmallVectorImpl<ClosureInfo*> &ClosureCandidates,
@@ -725,6 +839,16 @@ void ClosureSpecializer::gatherCallSites(
   // make sure that we do not handle call sites with multiple closure arguments.
   llvm::DenseSet<FullApplySite> VisitedAI;
 
+  // Closures can be propagated through as many more wrapper functions as were
+  // not needed to get to the caller.
+  unsigned Depth = getPropagationDepth(Caller);
+  unsigned RemainingDepth =
+      Depth < MaxPropagationDepth ? MaxPropagationDepth - Depth : 0;
+
+  // Computed on demand, for call sites of large callees.
+  std::unique_ptr<DominanceInfo> DT;
+  std::unique_ptr<SILLoopInfo> LI;
+
   // For each basic block BB in Caller...
   for (auto &BB : *Caller) {
 
@@ -777,18 +901,21 @@ void ClosureSpecializer::gatherCallSites(
         if (!ClosureIndex.hasValue())
           continue;
 
-        // Make sure that the Closure is invoked in the Apply's callee. We only
-        // want to perform closure specialization if we know that we will be
-        // able to change a partial_apply into an apply.
+        // Make sure that the Closure is invoked in the Apply's callee, or in a
+        // function it is forwarded to. We only want to perform closure
+        // specialization if we know that we will be able to change a
+        // partial_apply into an apply.
         //
         // TODO: Maybe just call the function directly instead of moving the
         // partial apply?
-        SILValue Arg = ApplyCallee->getArgument(ClosureIndex.getValue());
-        if (std::none_of(Arg->use_begin(), Arg->use_end(),
-                         [&Arg](Operand *Op) -> bool {
-                           auto UserAI = FullApplySite::isa(Op->getUser());
-                           return UserAI && UserAI.getCallee() == Arg;
-                         })) {
+        if (!isClosureInvoked(ApplyCallee, ClosureIndex.getValue(),
+                              RemainingDepth))
+          continue;
+
+        if (!isProfitable(AI, ApplyCallee, LI, DT)) {
+          DEBUG(llvm::dbgs() << "    Callee is too large to specialize: "
+                             << ApplyCallee->getName() << '\n');
+          ++NumCallSitesTooLarge;
           continue;
         }
 
@@ -842,7 +969,8 @@ bool ClosureSpecializer::specialize(SILFunction *Caller) {
   llvm::DenseSet<FullApplySite> MultipleClosureAI;
   gatherCallSites(Caller, ClosureCandidates, MultipleClosureAI);
 
-  bool Changed = false;
+  // Computing the lifetimes of the closures may have split critical edges.
+  bool Changed = !ClosureCandidates.empty();
   for (auto *CInfo : ClosureCandidates) {
     for (auto &CSDesc : CInfo->CallSites) {
       // Do not specialize apply insts that take in multiple closures. This pass
@@ -850,8 +978,18 @@ bool ClosureSpecializer::specialize(SILFunction *Caller) {
       if (MultipleClosureAI.count(CSDesc.getApplyInst()))
         continue;
 
-      specializeClosure(*CInfo, CSDesc);
+      SILFunction *NewF = specializeClosure(*CInfo, CSDesc);
       PropagatedClosures.push_back(CSDesc.getClosure());
+      if (NewF)
+        CreatedFunctions.push_back(NewF);
+
+      // The new function creates the closure itself now. If it forwards the
+      // closure to another function, it has to be specialized as well.
+      unsigned Depth = getPropagationDepth(Caller) + 1;
+      if (NewF && Depth <= MaxPropagationDepth) {
+        PropagationDepth[NewF] = Depth;
+        NewSpecializations.push_back(NewF);
+      }
       Changed = true;
     }
     delete CInfo;
@@ -872,9 +1010,11 @@ public:
   void run() override {
     auto *BCA = getAnalysis<BasicCalleeAnalysis>();
 
-    bool Changed = false;
     ClosureSpecializer C;
 
+    // The callers which were rewritten. No other existing function changes.
+    llvm::SmallVector<SILFunction *, 16> ChangedFunctions;
+
     BottomUpFunctionOrder Ordering(*getModule(), BCA);
 
     // Specialize going bottom-up.
@@ -888,14 +1028,26 @@ public:
       if (F->isExternalDeclaration())
         continue;
 
-      Changed |= C.specialize(F);
+      if (C.specialize(F))
+        ChangedFunctions.push_back(F);
     }
 
-    // Invalidate everything since we delete calls as well as add new
-    // calls and branches.
-    if (Changed) {
-      invalidateAnalysis(SILAnalysis::InvalidationKind::Everything);
-    }
+    // Then propagate closures through the wrapper functions which were
+    // specialized.
+    while (SILFunction *F = C.popNewSpecialization())
+      if (C.specialize(F))
+        ChangedFunctions.push_back(F);
+
+    for (SILFunction *F : C.getCreatedFunctions())
+      PM->notifyAnalysisOfFunction(F);
+
+    // Invalidate everything in the changed functions since we delete calls as
+    // well as add new calls and branches. Only invalidating these functions
+    // lets analyses like the caller analysis update themselves instead of
+    // recomputing the whole module. Dead closures are only deleted from these
+    // functions as well.
+    for (SILFunction *F : ChangedFunctions)
+      invalidateAnalysis(F, SILAnalysis::InvalidationKind::Everything);
 
     // If for testing purposes we were asked to not eliminate dead closures,
     // return.
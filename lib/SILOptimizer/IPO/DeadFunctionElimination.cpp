@@ -24,6 +24,8 @@
 using namespace swift;
 
 STATISTIC(NumDeadFunc, "Number of dead functions eliminated");
+STATISTIC(NumDeadFuncInsts,
+          "Number of instructions in eliminated dead functions");
 STATISTIC(NumEliminatedExternalDefs, "Number of external function definitions eliminated");
 
 namespace {
@@ -50,6 +52,10 @@ protected:
 
   SILModule *Module;
 
+  /// True if the module is an executable which is the whole program, so that
+  /// only its entry point is used externally.
+  bool IsWholeProgram;
+
   llvm::DenseMap<AbstractFunctionDecl *, MethodInfo *> MethodInfos;
   llvm::SpecificBumpPtrAllocator<MethodInfo> MethodInfoAllocator;
 
@@ -57,11 +63,24 @@ protected:
 
   llvm::SmallPtrSet<SILFunction *, 32> AliveFunctions;
 
+  /// Returns true if a symbol with \p linkage may be referenced from outside
+  /// of the module.
+  bool mayBeUsedExternally(SILLinkage linkage) {
+    if (IsWholeProgram)
+      return false;
+    return isPossiblyUsedExternally(linkage, Module->isWholeModule());
+  }
+
   /// Checks is a function is alive, e.g. because it is visible externally.
   bool isAnchorFunction(SILFunction *F) {
 
     // Remove internal functions that are not referenced by anything.
-    if (isPossiblyUsedExternally(F->getLinkage(), Module->isWholeModule()))
+    if (mayBeUsedExternally(F->getLinkage()))
+      return true;
+
+    // The entry point of a whole program is the only function which is called
+    // from outside.
+    if (IsWholeProgram && F->getName() == SWIFT_ENTRY_POINT_FUNCTION)
       return true;
 
     // ObjC functions are called through the runtime and are therefore alive
@@ -69,6 +88,14 @@ protected:
     if (F->getRepresentation() == SILFunctionTypeRepresentation::ObjCMethod)
       return true;
 
+    // Value summaries of let properties are never referenced, but read by
+    // other modules from the serialized module. Summaries deserialized from
+    // other modules are not serialized again.
+    if (F->hasSemanticsAttr("letprop.value") &&
+        F->getSerializedBodySize() == 0 &&
+        mayBeUsedExternally(SILLinkage::Public))
+      return true;
+
     // If function is marked as "keep-as-public", don't remove it.
     // Change its linkage to public, so that other applications can refer to it.
     // It is important that this transformation is done at the end of
@@ -211,7 +238,7 @@ protected:
       linkage = SILLinkage::Public;
       break;
     }
-    if (isPossiblyUsedExternally(linkage, Module->isWholeModule()))
+    if (mayBeUsedExternally(linkage))
       return true;
 
     // If a vtable or witness table (method) is only visible in another module
@@ -253,7 +280,10 @@ protected:
 
 public:
   FunctionLivenessComputation(SILModule *module) :
-    Module(module) {}
+    Module(module),
+    IsWholeProgram(module->getOptions().WholeProgram &&
+                   module->isWholeModule() &&
+                   module->lookUpFunction(SWIFT_ENTRY_POINT_FUNCTION)) {}
 
   /// The main entry point of the optimization.
   bool findAliveFunctions() {
@@ -310,7 +340,7 @@ class DeadFunctionElimination : FunctionLivenessComputation {
 
         if (// A conservative approach: if any of the overridden functions is
             // visible externally, we mark the whole method as alive.
-            isPossiblyUsedExternally(F->getLinkage(), Module->isWholeModule())
+            mayBeUsedExternally(F->getLinkage())
             // We also have to check the method declaration's accessibility.
             // Needed if it's a public base method declared in another
             // compilation unit (for this we have no SILFunction).
@@ -413,6 +443,8 @@ public:
       if (!isAlive(F)) {
         DEBUG(llvm::dbgs() << "  erase dead function " << F->getName() << "\n");
         NumDeadFunc++;
+        for (SILBasicBlock &BB : *F)
+          NumDeadFuncInsts += std::distance(BB.begin(), BB.end());
         DFEPass->invalidateAnalysisForDeadFunction(F,
                                      SILAnalysis::InvalidationKind::Everything);
         Module->eraseFunction(F);
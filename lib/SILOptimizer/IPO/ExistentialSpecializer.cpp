@@ -0,0 +1,308 @@
+//===--- ExistentialSpecializer.cpp - Specialize existential arguments ----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Specializes class existential parameters of functions whose callers are all
+// known and all pass an existential of the same concrete class.
+//
+// The specialized function takes the concrete class reference and creates the
+// existential in its entry block:
+//
+//   sil private @foo : $(@guaranteed P) -> () {
+//   bb0(%0 : $P):
+//     %1 = open_existential_ref %0 : $P to $@opened P
+//     %2 = witness_method $@opened P, #P.bar, %1
+//     ...
+//
+// becomes
+//
+//   sil private @foo_concrete_existential : $(@guaranteed C) -> () {
+//   bb0(%0 : $C):
+//     %e = init_existential_ref %0 : $C, $P
+//     %1 = open_existential_ref %e : $P to $@opened P
+//     ...
+//
+// SILCombine then propagates the concrete type into the opened archetype, and
+// the witness method calls can be devirtualized and inlined. The callers pass
+// the operand of their init_existential_ref directly.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "existential-specializer"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumArgsSpecialized,
+          "Number of existential arguments specialized to a concrete class");
+
+namespace {
+
+/// The concrete class which is passed for an existential argument by all
+/// callers of a function.
+struct ConcreteArg {
+  /// The index of the argument in the entry block of the function.
+  unsigned ArgIdx;
+  InitExistentialRefInst *Init;
+};
+
+class ExistentialSpecializer : public SILModuleTransform {
+  /// All function_ref instructions in the module, by referenced function.
+  llvm::DenseMap<SILFunction *, SmallVector<FunctionRefInst *, 4>> FuncRefs;
+
+  void run() override;
+
+  StringRef getName() override { return "Existential Specializer"; }
+
+  bool canSpecialize(SILFunction *F);
+
+  bool findConcreteArgs(SILFunction *F, ArrayRef<FunctionRefInst *> Refs,
+                        SmallVectorImpl<ConcreteArg> &ConcreteArgs);
+
+  SILFunction *createSpecializedFunction(SILFunction *F,
+                                         ArrayRef<ConcreteArg> ConcreteArgs);
+
+  void rewriteCallers(SILFunction *NewF, ArrayRef<FunctionRefInst *> Refs,
+                      ArrayRef<ConcreteArg> ConcreteArgs);
+};
+
+} // end anonymous namespace
+
+/// Returns true if all references to \p F are known and we may change its
+/// signature.
+bool ExistentialSpecializer::canSpecialize(SILFunction *F) {
+  if (F->isExternalDeclaration() || F->isPossiblyUsedExternally() ||
+      F->isKeepAsPublic() || F->isFragile() || F->isTransparent() ||
+      F->getContextGenericParams() || !F->shouldOptimize() ||
+      F->hasSemanticsAttrs())
+    return false;
+
+  // The reference count also includes references from vtables, witness tables
+  // and global initializers, which we cannot rewrite.
+  auto Iter = FuncRefs.find(F);
+  if (Iter == FuncRefs.end() || Iter->second.size() != F->getRefCount())
+    return false;
+
+  // All references must be callees of full applies without substitutions.
+  for (FunctionRefInst *FRI : Iter->second) {
+    for (Operand *Use : FRI->getUses()) {
+      FullApplySite AI = FullApplySite::isa(Use->getUser());
+      if (!AI || Use->getOperandNumber() != 0 || AI.hasSubstitutions())
+        return false;
+    }
+  }
+  return true;
+}
+
+/// Collect the class existential arguments of \p F for which all callers pass
+/// the same concrete class.
+bool ExistentialSpecializer::findConcreteArgs(
+    SILFunction *F, ArrayRef<FunctionRefInst *> Refs,
+    SmallVectorImpl<ConcreteArg> &ConcreteArgs) {
+  SILBasicBlock *Entry = &*F->begin();
+  unsigned NumIndirectResults =
+      F->getLoweredFunctionType()->getNumIndirectResults();
+
+  for (unsigned ArgIdx = NumIndirectResults, E = Entry->getNumBBArg();
+       ArgIdx != E; ++ArgIdx) {
+    SILType ArgTy = Entry->getBBArg(ArgIdx)->getType();
+    if (!ArgTy.isObject() || !ArgTy.isClassExistentialType())
+      continue;
+
+    InitExistentialRefInst *Found = nullptr;
+    bool IsSameForAllCallers = true;
+    for (FunctionRefInst *FRI : Refs) {
+      for (Operand *Use : FRI->getUses()) {
+        FullApplySite AI = FullApplySite::isa(Use->getUser());
+        auto *IER = dyn_cast<InitExistentialRefInst>(AI.getArgument(ArgIdx));
+        if (!IER || IER->getOperand()->getType().hasArchetype()) {
+          IsSameForAllCallers = false;
+          break;
+        }
+        if (!Found) {
+          Found = IER;
+          continue;
+        }
+        if (IER->getOperand()->getType() != Found->getOperand()->getType() ||
+            IER->getFormalConcreteType() != Found->getFormalConcreteType() ||
+            IER->getConformances() != Found->getConformances()) {
+          IsSameForAllCallers = false;
+          break;
+        }
+      }
+      if (!IsSameForAllCallers)
+        break;
+    }
+    if (IsSameForAllCallers && Found)
+      ConcreteArgs.push_back({ArgIdx, Found});
+  }
+  return !ConcreteArgs.empty();
+}
+
+/// Move the body of \p F into a new function which takes the concrete classes
+/// instead of the existentials.
+SILFunction *ExistentialSpecializer::createSpecializedFunction(
+    SILFunction *F, ArrayRef<ConcreteArg> ConcreteArgs) {
+  SILModule &M = F->getModule();
+  CanSILFunctionType FTy = F->getLoweredFunctionType();
+  unsigned NumIndirectResults = FTy->getNumIndirectResults();
+
+  SmallVector<SILParameterInfo, 8> Params(FTy->getParameters().begin(),
+                                          FTy->getParameters().end());
+  auto ExtInfo = FTy->getExtInfo();
+  for (const ConcreteArg &CA : ConcreteArgs) {
+    unsigned ParamIdx = CA.ArgIdx - NumIndirectResults;
+    CanType ConcreteTy = CA.Init->getOperand()->getType().getSwiftRValueType();
+    Params[ParamIdx] =
+        SILParameterInfo(ConcreteTy, Params[ParamIdx].getConvention());
+
+    // Don't use a method representation if we modified self.
+    if (FTy->hasSelfParam() && ParamIdx == Params.size() - 1)
+      ExtInfo = ExtInfo.withRepresentation(SILFunctionTypeRepresentation::Thin);
+  }
+  auto NewFTy = SILFunctionType::get(FTy->getGenericSignature(), ExtInfo,
+                                     FTy->getCalleeConvention(), Params,
+                                     FTy->getAllResults(),
+                                     FTy->getOptionalErrorResult(),
+                                     M.getASTContext());
+
+  std::string Name = (F->getName() + "_concrete_existential").str();
+  while (M.lookUpFunction(Name))
+    Name += "_";
+
+  SILFunction *NewF = M.createFunction(
+      F->getLinkage(), Name, NewFTy, nullptr, F->getLocation(), F->isBare(),
+      F->isTransparent(), F->isFragile(), F->isThunk(),
+      F->getClassVisibility(), F->getInlineStrategy(), F->getEffectsKind(),
+      /*InsertBefore*/ F, F->getDebugScope(), F->getDeclContext());
+  NewF->spliceBody(F);
+  NewF->setDeclCtx(F->getDeclContext());
+
+  // Replace the existential arguments by concrete arguments and re-create the
+  // existentials at the start of the entry block.
+  SILBasicBlock *Entry = &*NewF->begin();
+  SILBuilder B(&*Entry->begin());
+  B.setCurrentDebugScope(NewF->getDebugScope());
+  for (const ConcreteArg &CA : ConcreteArgs) {
+    SILArgument *OldArg = Entry->getBBArg(CA.ArgIdx);
+    SILArgument *NewArg = Entry->insertBBArg(
+        CA.ArgIdx, CA.Init->getOperand()->getType(), OldArg->getDecl());
+    auto *IER = B.createInitExistentialRef(
+        NewF->getLocation(), OldArg->getType(), CA.Init->getFormalConcreteType(),
+        NewArg, CA.Init->getConformances());
+    OldArg->replaceAllUsesWith(IER);
+    Entry->eraseBBArg(CA.ArgIdx + 1);
+    ++NumArgsSpecialized;
+  }
+  return NewF;
+}
+
+/// Let all callers call \p NewF with the concrete arguments.
+void ExistentialSpecializer::rewriteCallers(SILFunction *NewF,
+                                            ArrayRef<FunctionRefInst *> Refs,
+                                            ArrayRef<ConcreteArg> ConcreteArgs) {
+  SILType NewFTy = NewF->getLoweredType();
+  for (FunctionRefInst *FRI : Refs) {
+    while (!FRI->use_empty()) {
+      FullApplySite AI = FullApplySite::isa(FRI->use_begin()->getUser());
+      SILInstruction *OrigInst = AI.getInstruction();
+
+      SmallVector<SILValue, 8> Args(AI.getArguments().begin(),
+                                    AI.getArguments().end());
+      for (const ConcreteArg &CA : ConcreteArgs) {
+        auto *IER = cast<InitExistentialRefInst>(Args[CA.ArgIdx]);
+        Args[CA.ArgIdx] = IER->getOperand();
+      }
+
+      SILBuilderWithScope B(OrigInst);
+      auto *NewFRI = B.createFunctionRef(FRI->getLoc(), NewF);
+      if (auto *Apply = dyn_cast<ApplyInst>(OrigInst)) {
+        auto *NewAI = B.createApply(Apply->getLoc(), NewFRI, NewFTy,
+                                    Apply->getType(), {}, Args,
+                                    Apply->isNonThrowing());
+        Apply->replaceAllUsesWith(NewAI);
+      } else {
+        auto *TAI = cast<TryApplyInst>(OrigInst);
+        B.createTryApply(TAI->getLoc(), NewFRI, NewFTy, {}, Args,
+                         TAI->getNormalBB(), TAI->getErrorBB());
+      }
+
+      // Remove the call and the existentials it was passed, if they are not
+      // used anymore.
+      llvm::SmallSetVector<SILInstruction *, 4> Existentials;
+      for (const ConcreteArg &CA : ConcreteArgs)
+        Existentials.insert(cast<SILInstruction>(AI.getArgument(CA.ArgIdx)));
+      OrigInst->eraseFromParent();
+      for (SILInstruction *I : Existentials)
+        if (I->use_empty())
+          I->eraseFromParent();
+
+      invalidateAnalysis(NewFRI->getFunction(),
+                         SILAnalysis::InvalidationKind::CallsAndInstructions);
+    }
+    FRI->eraseFromParent();
+  }
+}
+
+void ExistentialSpecializer::run() {
+  SILModule *M = getModule();
+
+  FuncRefs.clear();
+  for (auto &F : *M)
+    for (auto &BB : F)
+      for (auto &I : BB)
+        if (auto *FRI = dyn_cast<FunctionRefInst>(&I))
+          FuncRefs[FRI->getReferencedFunction()].push_back(FRI);
+
+  SmallVector<SILFunction *, 16> Candidates;
+  for (auto &F : *M)
+    if (canSpecialize(&F))
+      Candidates.push_back(&F);
+
+  bool Changed = false;
+  for (SILFunction *F : Candidates) {
+    ArrayRef<FunctionRefInst *> Refs = FuncRefs[F];
+    SmallVector<ConcreteArg, 4> ConcreteArgs;
+    if (!findConcreteArgs(F, Refs, ConcreteArgs))
+      continue;
+
+    DEBUG(llvm::dbgs() << "Specializing existential arguments of "
+                       << F->getName() << "\n");
+
+    SILFunction *NewF = createSpecializedFunction(F, ConcreteArgs);
+    rewriteCallers(NewF, Refs, ConcreteArgs);
+
+    // The debug scopes of the moved instructions still refer to the original
+    // function, so keep it around as a zombie for debug info.
+    assert(F->getRefCount() == 0 && "there are unknown references left");
+    F->setInlined();
+    invalidateAnalysisForDeadFunction(F,
+                                      SILAnalysis::InvalidationKind::Everything);
+    M->eraseFunction(F);
+    Changed = true;
+  }
+  FuncRefs.clear();
+
+  if (Changed)
+    invalidateAnalysis(SILAnalysis::InvalidationKind::Functions);
+}
+
+SILTransform *swift::createExistentialSpecializer() {
+  return new ExistentialSpecializer();
+}
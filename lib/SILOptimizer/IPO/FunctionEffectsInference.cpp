@@ -0,0 +1,136 @@
+//===--- FunctionEffectsInference.cpp - Infer @effects for functions ------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Records what side-effect analysis knows about externally visible functions
+// as their effects kind. The effects kind is serialized with the function's
+// declaration, so other modules that only see the declaration can treat
+// calls to it as readnone or readonly instead of as unknown.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "infer-function-effects"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Analysis/BasicCalleeAnalysis.h"
+#include "swift/SILOptimizer/Analysis/FunctionOrder.h"
+#include "swift/SILOptimizer/Analysis/LoopAnalysis.h"
+#include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumReadNoneInferred, "Number of functions inferred as readnone");
+STATISTIC(NumReadOnlyInferred, "Number of functions inferred as readonly");
+
+namespace {
+
+class FunctionEffectsInference : public SILModuleTransform {
+  SideEffectAnalysis *SEA;
+  SILLoopAnalysis *LA;
+
+  /// Returns true if \p F is known to return, because it has no loops and
+  /// only calls functions which were already found to have limited effects.
+  /// Recursive calls never qualify, since the callee is still unknown when
+  /// its callers are visited.
+  bool isKnownToTerminate(SILFunction *F) {
+    if (!LA->get(F)->empty())
+      return false;
+
+    for (auto &BB : *F) {
+      for (auto &I : BB) {
+        FullApplySite FAS = FullApplySite::isa(&I);
+        if (!FAS)
+          continue;
+        SILFunction *Callee = FAS.getReferencedFunction();
+        if (!Callee || Callee->getEffectsKind() >= EffectsKind::ReadWrite)
+          return false;
+      }
+    }
+    return true;
+  }
+
+  /// Computes the effects kind that \p F can be given, or returns None.
+  Optional<EffectsKind> inferEffectsKind(SILFunction *F) {
+    // A consumed parameter may be released in the callee, which can run a
+    // deinit with arbitrary effects, and effects attributes are ignored for
+    // such functions anyway.
+    if (F->hasOwnedParameters() || F->hasIndirectResults())
+      return None;
+
+    // The effects kind allows removing calls with unused results, so the
+    // call must be free of anything but reads, and it must return.
+    const auto &FE = SEA->getEffects(F);
+    if (FE.mayTrap() || FE.mayAllocObjects() || FE.mayReadRC())
+      return None;
+
+    bool Reads = false;
+    auto checkEffects = [&](const SideEffectAnalysis::Effects &E) {
+      Reads |= E.mayRead();
+      return !E.mayWrite() && !E.mayRetain() && !E.mayRelease();
+    };
+    if (!checkEffects(FE.getGlobalEffects()))
+      return None;
+    for (auto &PE : FE.getParameterEffects())
+      if (!checkEffects(PE))
+        return None;
+
+    if (!isKnownToTerminate(F))
+      return None;
+
+    return Reads ? EffectsKind::ReadOnly : EffectsKind::ReadNone;
+  }
+
+  void run() override {
+    SEA = PM->getAnalysis<SideEffectAnalysis>();
+    LA = PM->getAnalysis<SILLoopAnalysis>();
+    auto *BCA = PM->getAnalysis<BasicCalleeAnalysis>();
+
+    // Visit callees before their callers, so that callers can rely on the
+    // effects inferred for their callees.
+    BottomUpFunctionOrder BottomUpOrder(*getModule(), BCA);
+    for (auto *F : BottomUpOrder.getFunctions()) {
+      if (!F->isDefinition() || !F->isPossiblyUsedExternally() ||
+          F->getEffectsKind() != EffectsKind::Unspecified)
+        continue;
+
+      auto Kind = inferEffectsKind(F);
+      if (!Kind)
+        continue;
+
+      DEBUG(llvm::dbgs() << "  inferred "
+                         << (*Kind == EffectsKind::ReadNone ? "readnone"
+                                                            : "readonly")
+                         << " for " << F->getName() << '\n');
+      if (*Kind == EffectsKind::ReadNone)
+        ++NumReadNoneInferred;
+      else
+        ++NumReadOnlyInferred;
+
+      // The body doesn't change, and the effects kind of a function only makes
+      // analyses of its callers more precise, so there is nothing to
+      // invalidate.
+      F->setEffectsKind(*Kind);
+    }
+  }
+
+  StringRef getName() override { return "Function Effects Inference"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createFunctionEffectsInference() {
+  return new FunctionEffectsInference();
+}
@@ -16,21 +16,35 @@
 // if this pass can prove that it has analyzed all assignments of an initial
 // value to this property and all those assignments assign the same value
 // to this property.
+//
+// When a whole module is compiled, the value of every public let property
+// for which this holds is also recorded as a fragile "value summary"
+// function, which is serialized into the module. Client modules use it in
+// place of the initializers they cannot see.
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "let-properties-opt"
+#include "swift/AST/Mangle.h"
 #include "swift/SIL/SILInstruction.h"
 #include "swift/SIL/SILBasicBlock.h"
 #include "swift/SIL/DebugUtils.h"
+#include "swift/SIL/SILDebugScope.h"
 #include "swift/SIL/SILLinkage.h"
+#include "swift/SIL/SILUndef.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 using namespace swift;
 
+STATISTIC(NumValueSummariesEmitted,
+          "Number of let property value summaries emitted");
+STATISTIC(NumValueSummariesUsed,
+          "Number of let property value summaries used from other modules");
+
 namespace {
 /// Promote values of non-static let properties initialized by means
 /// of constant values of simple types into their uses.
@@ -78,6 +92,9 @@ protected:
   void optimizeLetPropertyAccess(VarDecl *SILG,
                                  SmallVectorImpl<SILInstruction *> &Init);
   bool analyzeInitValue(SILInstruction *I, VarDecl *Prop);
+  void emitValueSummary(VarDecl *Property,
+                        SmallVectorImpl<SILInstruction *> &Init);
+  bool loadValueSummary(VarDecl *Property);
 };
 
 /// Helper class to copy only a set of SIL instructions providing in the
@@ -357,6 +374,106 @@ static bool mayHaveUnknownUses(VarDecl *Property, SILModule *Module) {
 }
 
 
+/// Returns the name of the function which returns the value of \p Property.
+static std::string getValueSummaryName(VarDecl *Property) {
+  Mangle::Mangler Mangler;
+  Mangler.append("_T");
+  Mangler.mangleLetPropertyValueEntity(Property);
+  return Mangler.finalize();
+}
+
+/// Record the value of a public let property in a fragile function, so that
+/// it is serialized with the module and client modules can use it.
+///
+/// The function has shared linkage: it is only read from the serialized
+/// module and never called, so it does not need to be an exported symbol.
+void LetPropertiesOpt::emitValueSummary(VarDecl *Property,
+    SmallVectorImpl<SILInstruction *> &Init) {
+  if (SkipProcessing.count(Property) || Init.empty())
+    return;
+
+  // Only a whole module compilation has seen all initializers, and only a
+  // fragile type may be assumed to keep its values in future versions of
+  // the module.
+  auto *Ty = cast<NominalTypeDecl>(Property->getDeclContext());
+  if (SkipTypeProcessing.count(Ty) || !Module->isWholeModule() ||
+      Property->getDeclContext()->getParentModule() !=
+          Module->getSwiftModule() ||
+      Module->getSwiftModule()->getResilienceStrategy() !=
+          ResilienceStrategy::Default)
+    return;
+
+  // The summary of a property of a generic type would have to be generic.
+  if (Property->getEffectiveAccess() != Accessibility::Public ||
+      Ty->getEffectiveAccess() != Accessibility::Public ||
+      Ty->isGenericContext())
+    return;
+
+  std::string Name = getValueSummaryName(Property);
+  if (Module->lookUpFunction(Name))
+    return;
+
+  DEBUG(llvm::dbgs() << "Emitting value summary " << Name << " for property '"
+                     << *Property << "'\n");
+
+  // The function takes no arguments and returns the value of the property.
+  SILType PropertyType = Module->Types.getLoweredType(Property->getType());
+  SILResultInfo Results[] = {
+    SILResultInfo(PropertyType.getSwiftRValueType(), ResultConvention::Owned)
+  };
+  SILFunctionType::ExtInfo EInfo;
+  EInfo = EInfo.withRepresentation(SILFunctionType::Representation::Thin);
+  auto LoweredType = SILFunctionType::get(nullptr, EInfo,
+      ParameterConvention::Direct_Owned, { }, Results, None,
+      Module->getASTContext());
+  SILLocation Loc = Init.front()->getLoc();
+  auto *SummaryF = Module->getOrCreateFunction(Loc, Name, SILLinkage::Shared,
+      LoweredType, IsBare_t::IsBare, IsTransparent_t::IsNotTransparent,
+      IsFragile_t::IsFragile);
+  SummaryF->addSemanticsAttr("letprop.value");
+  SummaryF->setDebugScope(new (*Module) SILDebugScope(Loc, SummaryF));
+
+  // Clone the initializer in front of the return, and return its value.
+  SILBuilder B(SummaryF->createBasicBlock());
+  auto *Return = B.createReturn(Loc, SILUndef::get(PropertyType, *Module));
+  InstructionsCloner Cloner(*SummaryF, Init, Return);
+  Cloner.clone();
+  Return->setOperand(0, &*std::prev(Return->getIterator()));
+  ++NumValueSummariesEmitted;
+}
+
+/// Use the value summary of a let property from a different module as the
+/// initializer of the property, if the module has one.
+bool LetPropertiesOpt::loadValueSummary(VarDecl *Property) {
+  std::string Name = getValueSummaryName(Property);
+  SILFunction *SummaryF = Module->lookUpFunction(Name);
+  if (!SummaryF) {
+    if (!Module->linkFunction(Name, SILModule::LinkingMode::LinkAll))
+      return false;
+    SummaryF = Module->lookUpFunction(Name);
+  }
+  if (!SummaryF || !SummaryF->hasSemanticsAttr("letprop.value"))
+    return false;
+  if (SummaryF->isExternalDeclaration() &&
+      !Module->linkFunction(SummaryF, SILModule::LinkingMode::LinkAll))
+    return false;
+  if (SummaryF->size() != 1)
+    return false;
+
+  auto &Init = InitMap[Property];
+  assert(Init.empty() && "property of a different module was initialized?");
+  for (auto &I : SummaryF->front())
+    if (!isa<ReturnInst>(&I))
+      Init.push_back(&I);
+  if (Init.empty())
+    return false;
+
+  DEBUG(llvm::dbgs() << "Using value summary " << SummaryF->getName()
+                     << " for property '" << *Property << "'\n");
+  ++NumValueSummariesUsed;
+  return true;
+}
+
 /// Check if a given property is a non-static let property
 /// with known constant value.
 bool LetPropertiesOpt::isConstantLetProperty(VarDecl *Property) {
@@ -373,10 +490,17 @@ bool LetPropertiesOpt::isConstantLetProperty(VarDecl *Property) {
   if (PotentialConstantLetProperty.count(Property))
     return true;
 
-  // Check the visibility of this property. If its visibility
-  // implies that this optimization pass cannot analyze all uses,
-  // don't process it.
-  if (mayHaveUnknownUses(Property, Module)) {
+  // The initializers of a property from a different module are not visible,
+  // but the module may have recorded the value they all assign.
+  if (Property->getDeclContext()->getParentModule() !=
+          Module->getSwiftModule() &&
+      loadValueSummary(Property)) {
+    DEBUG(llvm::dbgs() << "Property '" << *Property
+                       << "' has a value summary\n");
+  } else if (mayHaveUnknownUses(Property, Module)) {
+    // Check the visibility of this property. If its visibility
+    // implies that this optimization pass cannot analyze all uses,
+    // don't process it.
     DEBUG(llvm::dbgs() << "Property '" << *Property
                        << "' may have unknown uses\n");
     SkipProcessing.insert(Property);
@@ -588,6 +712,7 @@ bool LetPropertiesOpt::run() {
   }
 
   for (auto &Init: InitMap) {
+    emitValueSummary(Init.first, Init.second);
     optimizeLetPropertyAccess(Init.first, Init.second);
   }
 
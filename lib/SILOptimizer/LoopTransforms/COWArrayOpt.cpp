@@ -351,6 +351,10 @@ class COWArrayOpt {
   // looking at the operations (no uniquely identified objects).
   std::pair<bool, bool> CachedSafeLoop;
 
+  // The only array type whose make_mutable calls can be hoisted if the loop is
+  // safe, or null if it is any array type.
+  CanType SafeArrayType;
+
   // Set of all blocks that may reach the loop, not including loop blocks.
   llvm::SmallPtrSet<SILBasicBlock*,32> ReachingBlocks;
 
@@ -405,7 +409,7 @@ protected:
   bool hoistMakeMutable(ArraySemanticsCall MakeMutable);
   void hoistMakeMutableAndSelfProjection(ArraySemanticsCall MakeMutable,
                                          bool HoistProjection);
-  bool hasLoopOnlyDestructorSafeArrayOperations();
+  bool hasLoopOnlyDestructorSafeArrayOperations(CanType ArrayType);
   bool isArrayValueReleasedBeforeMutate(
       SILValue V, llvm::SmallSet<SILInstruction *, 16> &Releases);
   bool hoistInLoopWithOnlyNonArrayValueMutatingOperations();
@@ -1325,8 +1329,23 @@ bool COWArrayOpt::hoistInLoopWithOnlyNonArrayValueMutatingOperations() {
   return ReturnWithCleanup(true);
 }
 
+/// Returns true if the elements of arrays of type \p ArrayType are trivial.
+/// Operations on such arrays can't create references to other arrays.
+static bool hasTrivialElementType(CanType ArrayType, SILModule &M) {
+  auto *BGT = ArrayType->getAs<BoundGenericType>();
+  if (!BGT)
+    return false;
+  for (auto EltTy : BGT->getGenericArgs()) {
+    if (EltTy->hasArchetype() ||
+        !M.Types.getLoweredType(EltTy).isTrivial(M))
+      return false;
+  }
+  return true;
+}
+
 /// Check if a loop has only 'safe' array operations such that we can hoist the
-/// uniqueness check even without having an 'identified' object.
+/// uniqueness check of an array of type \p ArrayType even without having an
+/// 'identified' object.
 ///
 /// 'Safe' array operations are:
 ///   * all array semantic functions
@@ -1338,9 +1357,13 @@ bool COWArrayOpt::hoistInLoopWithOnlyNonArrayValueMutatingOperations() {
 /// object) is not safe because the destructor of what we are releasing might
 /// be unsafe (creating a reference).
 ///
-bool COWArrayOpt::hasLoopOnlyDestructorSafeArrayOperations() {
+bool COWArrayOpt::hasLoopOnlyDestructorSafeArrayOperations(
+    CanType ArrayType) {
+  auto isSafeArrayType = [&] {
+    return SafeArrayType.isNull() || SafeArrayType == ArrayType;
+  };
   if (CachedSafeLoop.first)
-    return CachedSafeLoop.second;
+    return CachedSafeLoop.second && isSafeArrayType();
 
   assert(!CachedSafeLoop.second &&
          "We only move to a true state below");
@@ -1355,7 +1378,7 @@ bool COWArrayOpt::hasLoopOnlyDestructorSafeArrayOperations() {
   };
 
   DEBUG(llvm::dbgs() << "    checking whether loop only has safe array operations ...\n");
-  CanType SameTy;
+  auto &Module = Function->getModule();
   for (auto *BB : Loop->getBlocks()) {
     for (auto &It : *BB) {
       auto *Inst = &It;
@@ -1369,22 +1392,23 @@ bool COWArrayOpt::hasLoopOnlyDestructorSafeArrayOperations() {
         if (Kind == ArrayCallKind::kArrayInit ||
             Kind == ArrayCallKind::kArrayUninitialized)
           continue;
-        // All array types must be the same. This is a stronger guaranteed than
-        // we actually need. The requirement is that we can't create another
-        // reference to the array by performing an array operation: for example,
-        // storing or appending one array into a two-dimensional array.
-        // Checking
-        // that all types are the same make guarantees that this cannot happen.
-        if (SameTy.isNull()) {
-          SameTy =
-              Sem.getSelf()->getType().getSwiftRValueType()->getCanonicalType();
+        // We can't create another reference to an array by performing an
+        // array operation: for example, storing or appending one array into a
+        // two-dimensional array. Arrays with trivial elements can't hold
+        // references, so operations on them are always safe. All other arrays
+        // must have the same type, and only make_mutable calls on arrays of
+        // that type can be hoisted. This allows hoisting the uniqueness check
+        // of the outer array in a loop nest over a two-dimensional array.
+        CanType Ty =
+            Sem.getSelf()->getType().getSwiftRValueType()->getCanonicalType();
+        if (hasTrivialElementType(Ty, Module))
+          continue;
+        if (SafeArrayType.isNull()) {
+          SafeArrayType = Ty;
           continue;
         }
-        
-        if (Sem.getSelf()
-                       ->getType()
-                       .getSwiftRValueType()
-                       ->getCanonicalType() != SameTy) {
+
+        if (Ty != SafeArrayType) {
           DEBUG(llvm::dbgs() << "    (NO) mismatching array types\n");
           return ReturnWithCleanup(false);
         }
@@ -1432,7 +1456,7 @@ bool COWArrayOpt::hasLoopOnlyDestructorSafeArrayOperations() {
 
   DEBUG(llvm::dbgs() << "     (YES)\n");
   CachedSafeLoop.second = true;
-  return ReturnWithCleanup(true);
+  return ReturnWithCleanup(isSafeArrayType());
 }
 
 /// Hoist the make_mutable call and optionally the projection chain that feeds
@@ -1472,7 +1496,9 @@ bool COWArrayOpt::hoistMakeMutable(ArraySemanticsCall MakeMutable) {
 
   // Check whether we can hoist make_mutable based on the operations that are
   // in the loop.
-  if (hasLoopOnlyDestructorSafeArrayOperations()) {
+  CanType ArrayType =
+      CurrentArrayAddr->getType().getSwiftRValueType()->getCanonicalType();
+  if (hasLoopOnlyDestructorSafeArrayOperations(ArrayType)) {
     hoistMakeMutableAndSelfProjection(MakeMutable,
                                       CurrentArrayAddr != ArrayAddrBase);
     DEBUG(llvm::dbgs()
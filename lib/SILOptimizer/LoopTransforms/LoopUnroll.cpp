@@ -30,6 +30,12 @@ using llvm::MapVector;
 
 static const uint64_t SILLoopUnrollThreshold = 250;
 
+/// The maximum size of the unrolled body of a partially unrolled loop.
+static const uint64_t SILLoopPartialUnrollThreshold = 100;
+
+/// The maximum number of copies of the body of a partially unrolled loop.
+static const unsigned SILLoopPartialUnrollMaxFactor = 4;
+
 namespace {
 
 /// Clone the basic blocks in a loop.
@@ -185,6 +191,36 @@ static bool canAndShouldUnrollLoop(SILLoop *Loop, uint64_t TripCount) {
   return true;
 }
 
+/// Determine the number of copies of the loop body if the loop is partially
+/// unrolled, or 1 if it should not be unrolled.
+///
+/// We only pick factors which divide the trip count. Then the exit check in the
+/// latch can only succeed in the last copy of the body and no remainder loop is
+/// needed.
+static unsigned getPartialUnrollFactor(SILLoop *Loop, uint64_t TripCount) {
+  assert(Loop->getSubLoops().empty() && "Expect innermost loops");
+
+  uint64_t Cost = 0;
+  for (auto *BB : Loop->getBlocks()) {
+    for (auto &Inst : *BB) {
+      if (!Loop->canDuplicate(&Inst))
+        return 1;
+      if (instructionInlineCost(Inst) != InlineCost::Free)
+        ++Cost;
+      if (Cost * 2 > SILLoopPartialUnrollThreshold)
+        return 1;
+    }
+  }
+
+  for (unsigned Factor = SILLoopPartialUnrollMaxFactor; Factor > 1;
+       Factor /= 2) {
+    if (TripCount > Factor && TripCount % Factor == 0 &&
+        Cost * Factor <= SILLoopPartialUnrollThreshold)
+      return Factor;
+  }
+  return 1;
+}
+
 /// Redirect the terminator of the current loop iteration's latch to the next
 /// iterations header or if this is the last iteration remove the backedge to
 /// the header.
@@ -263,6 +299,55 @@ static void redirectTerminator(SILBasicBlock *Latch, unsigned CurLoopIter,
   CondBr->eraseFromParent();
 }
 
+/// Redirect the terminator of the latch of a copy of a partially unrolled loop
+/// body.
+///
+/// The exit check of the latch can only succeed in the last copy of the body.
+/// All other copies branch unconditionally to the header of the next copy. The
+/// last copy branches back to the original header.
+static void redirectPartialTerminator(SILBasicBlock *Latch,
+                                      SILBasicBlock *CurrentHeader,
+                                      bool IsLastCopy,
+                                      SILBasicBlock *NextHeader) {
+  auto *CurrentTerminator = Latch->getTerminator();
+
+  // Handle the split backedge case.
+  if (auto *Br = dyn_cast<BranchInst>(CurrentTerminator)) {
+    if (!IsLastCopy) {
+      auto *CondBr =
+          cast<CondBranchInst>(Latch->getSinglePredecessor()->getTerminator());
+      if (CondBr->getTrueBB() == Latch)
+        SILBuilder(CondBr).createBranch(CondBr->getLoc(), Latch,
+                                        CondBr->getTrueArgs());
+      else
+        SILBuilder(CondBr).createBranch(CondBr->getLoc(), Latch,
+                                        CondBr->getFalseArgs());
+      CondBr->eraseFromParent();
+    }
+    SILBuilder(Br).createBranch(Br->getLoc(), NextHeader, Br->getArgs());
+    Br->eraseFromParent();
+    return;
+  }
+
+  // Otherwise, we have a conditional branch to the header.
+  auto *CondBr = cast<CondBranchInst>(CurrentTerminator);
+  bool HeaderIsTrueBB = CondBr->getTrueBB() == CurrentHeader;
+  if (!IsLastCopy) {
+    SILBuilder(CondBr).createBranch(
+        CondBr->getLoc(), NextHeader,
+        HeaderIsTrueBB ? CondBr->getTrueArgs() : CondBr->getFalseArgs());
+  } else if (HeaderIsTrueBB) {
+    SILBuilder(CondBr).createCondBranch(
+        CondBr->getLoc(), CondBr->getCondition(), NextHeader,
+        CondBr->getTrueArgs(), CondBr->getFalseBB(), CondBr->getFalseArgs());
+  } else {
+    SILBuilder(CondBr).createCondBranch(
+        CondBr->getLoc(), CondBr->getCondition(), CondBr->getTrueBB(),
+        CondBr->getTrueArgs(), NextHeader, CondBr->getFalseArgs());
+  }
+  CondBr->eraseFromParent();
+}
+
 /// Collect all the loop live out values in the map that maps original live out
 /// value to live out value in the cloned loop.
 static void collectLoopLiveOutValues(
@@ -324,8 +409,9 @@ updateSSA(SILLoop *Loop,
   }
 }
 
-/// Try to fully unroll the loop if we can determine the trip count and the trip
-/// count lis below a threshold.
+/// Try to unroll the loop if we can determine the trip count. The loop is fully
+/// unrolled if the trip count is below a threshold, and otherwise partially
+/// unrolled by a factor which divides the trip count.
 static bool tryToUnrollLoop(SILLoop *Loop) {
   assert(Loop->getSubLoops().empty() && "Expecting innermost loops");
 
@@ -344,8 +430,14 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
   if (!MaxTripCount)
     return false;
 
-  if (!canAndShouldUnrollLoop(Loop, MaxTripCount.getValue()))
-    return false;
+  // Fully unroll small loops. Otherwise, try to unroll the loop partially.
+  uint64_t NumCopies = *MaxTripCount;
+  bool IsFullUnroll = canAndShouldUnrollLoop(Loop, NumCopies);
+  if (!IsFullUnroll) {
+    NumCopies = getPartialUnrollFactor(Loop, NumCopies);
+    if (NumCopies == 1)
+      return false;
+  }
 
   // TODO: We need to split edges from non-condbr exits for the SSA updater. For
   // now just don't handle loops containing such exits.
@@ -355,8 +447,9 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
     if (!isa<CondBranchInst>(Exit->getTerminator()))
       return false;
 
-  DEBUG(llvm::dbgs() << "Unrolling loop in " << Header->getParent()->getName()
-                     << " " << *Loop << "\n");
+  DEBUG(llvm::dbgs() << (IsFullUnroll ? "Unrolling" : "Partially unrolling")
+                     << " loop in " << Header->getParent()->getName() << " "
+                     << *Loop << "\n");
 
   SmallVector<SILBasicBlock *, 16> Headers;
   Headers.push_back(Header);
@@ -366,8 +459,8 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
 
   DenseMap<SILValue, SmallVector<SILValue, 8>> LoopLiveOutValues;
 
-  // Copy the body MaxTripCount-1 times.
-  for (uint64_t Cnt = 1; Cnt < *MaxTripCount; ++Cnt) {
+  // Copy the body NumCopies-1 times.
+  for (uint64_t Cnt = 1; Cnt < NumCopies; ++Cnt) {
     // Clone the blocks in the loop.
     LoopCloner Cloner(Loop);
     Cloner.cloneLoop();
@@ -404,6 +497,17 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
     auto *CurrentLatch = Latches[Iteration];
     auto LastIteration = End - 1;
     auto *OriginalHeader = Headers[0];
+
+    // The last copy of a partially unrolled loop keeps the backedge to the
+    // original header.
+    if (!IsFullUnroll) {
+      auto *NextHeader = Iteration == LastIteration ? OriginalHeader
+                                                    : Headers[Iteration + 1];
+      redirectPartialTerminator(CurrentLatch, Headers[Iteration],
+                                Iteration == LastIteration, NextHeader);
+      continue;
+    }
+
     auto *NextIterationsHeader =
         Iteration == LastIteration ? nullptr : Headers[Iteration + 1];
 
@@ -17,6 +17,7 @@
 #include "swift/AST/DiagnosticsSIL.h"
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILBuilder.h"
+#include "swift/SILOptimizer/Analysis/PostOrderAnalysis.h"
 #include "swift/SILOptimizer/Utils/CFG.h"
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
@@ -297,9 +298,6 @@ namespace {
     /// this block.
     bool HasNonLoadUse : 1;
 
-    /// Helper flag used during building the worklist for the dataflow analysis.
-    bool isInWorkList : 1;
-    
     /// Availability of elements within the block.
     /// Not "empty" for all blocks which have non-load uses or contain the
     /// definition of the memory object.
@@ -320,7 +318,6 @@ namespace {
 
     LiveOutBlockState(unsigned NumElements)
       : HasNonLoadUse(false),
-        isInWorkList(false),
         LocalAvailability(NumElements),
         OutAvailability(NumElements) {
     }
@@ -438,6 +435,11 @@ namespace {
 
     llvm::SmallDenseMap<SILBasicBlock*, LiveOutBlockState, 32> PerBlockInfo;
 
+    /// This is true once the live-out state of every block in the function has
+    /// been computed.  None of the uses change the CFG or the per-block state,
+    /// so the dataflow only needs to be solved once per memory object.
+    bool LiveOutComputed = false;
+
     /// This is a map of uses that are not loads (i.e., they are Stores,
     /// InOutUses, and Escapes), to their entry in Uses.
     llvm::SmallDenseMap<SILInstruction*, unsigned, 16> NonLoadUses;
@@ -509,9 +511,7 @@ namespace {
     SILValue handleConditionalInitAssign();
     void handleConditionalDestroys(SILValue ControlVariableAddr);
 
-    typedef SmallVector<SILBasicBlock *, 16> WorkListType;
-    void putIntoWorkList(SILBasicBlock *BB, WorkListType &WorkList);
-    void computePredsLiveOut(SILBasicBlock *BB);
+    void computeLiveOut();
     void getOutAvailability(SILBasicBlock *BB, AvailabilitySet &Result);
     void getOutSelfConsumed(SILBasicBlock *BB, Optional<DIKind> &Result);
 
@@ -2204,71 +2204,61 @@ handleConditionalDestroys(SILValue ControlVariableAddr) {
   }
 }
 
-void LifetimeChecker::
-putIntoWorkList(SILBasicBlock *BB, WorkListType &WorkList) {
-  LiveOutBlockState &State = getBlockInfo(BB);
-  if (!State.isInWorkList && State.containsUndefinedValues()) {
-    DEBUG(llvm::dbgs() << "    add block " << BB->getDebugID()
-          << " to worklist\n");
-    WorkList.push_back(BB);
-    State.isInWorkList = true;
-  }
-}
-
-void LifetimeChecker::
-computePredsLiveOut(SILBasicBlock *BB) {
-  DEBUG(llvm::dbgs() << "  Get liveness for block " << BB->getDebugID() << "\n");
-  
-  // Collect blocks for which we have to calculate the out-availability.
-  // These are the paths from blocks with known out-availability to the BB.
-  WorkListType WorkList;
-  for (auto Pred : BB->getPreds()) {
-    putIntoWorkList(Pred, WorkList);
-  }
-  size_t idx = 0;
-  while (idx < WorkList.size()) {
-    SILBasicBlock *WorkBB = WorkList[idx++];
-    for (auto Pred : WorkBB->getPreds()) {
-      putIntoWorkList(Pred, WorkList);
-    }
-  }
+/// computeLiveOut - Solve the forward dataflow problem for the live-out
+/// availability and self-consumed state of every block in the function.  This
+/// is done the first time any liveness is queried, so that each query only has
+/// to merge the results of its block's predecessors.
+void LifetimeChecker::computeLiveOut() {
+  if (LiveOutComputed)
+    return;
+  LiveOutComputed = true;
+
+  DEBUG(llvm::dbgs() << "  Compute live-out of all blocks\n");
+
+  // Visit the blocks in reverse post order, so that the predecessors of most
+  // blocks are merged before the block itself.  Blocks that are not reachable
+  // from the entry block are visited at the end.
+  SILFunction *F = TheMemory.MemoryInst->getFunction();
+  SmallVector<SILBasicBlock *, 32> Blocks;
+  SmallPtrSet<SILBasicBlock *, 32> Visited;
+  PostOrderFunctionInfo PO(F);
+  for (auto *BB : PO.getReversePostOrder())
+    if (Visited.insert(BB).second)
+      Blocks.push_back(BB);
+  for (auto &BB : *F)
+    if (Visited.insert(&BB).second)
+      Blocks.push_back(&BB);
+  for (auto *BB : Blocks)
+    getBlockInfo(BB);
 
   // Solve the dataflow problem.
 #ifndef NDEBUG
   int iteration = 0;
-  int upperIterationLimit = WorkList.size() * 2 + 10; // More than enough.
+  int upperIterationLimit = Blocks.size() * 2 + 10; // More than enough.
 #endif
   bool changed;
   do {
     assert(iteration < upperIterationLimit &&
            "Infinite loop in dataflow analysis?");
     DEBUG(llvm::dbgs() << "    Iteration " << iteration++ << "\n");
-    
+
     changed = false;
-    // We collected the blocks in reverse order. Since it is a forward dataflow-
-    // problem, it is faster to go through the worklist in reverse order.
-    for (auto iter = WorkList.rbegin(); iter != WorkList.rend(); ++iter) {
-      SILBasicBlock *WorkBB = *iter;
-      LiveOutBlockState &BBState = getBlockInfo(WorkBB);
-
-      // Merge from the predecessor blocks.
-      for (auto Pred : WorkBB->getPreds()) {
+    for (auto *BB : Blocks) {
+      // Merge from the predecessor blocks.  Every block's state is created
+      // before the first merge, so BBState is not invalidated by the lookup
+      // of its predecessors.
+      LiveOutBlockState &BBState = getBlockInfo(BB);
+      for (auto Pred : BB->getPreds())
         changed |= BBState.mergeFromPred(getBlockInfo(Pred));
-      }
-      DEBUG(llvm::dbgs() << "      Block " << WorkBB->getDebugID() << " out: "
+      DEBUG(llvm::dbgs() << "      Block " << BB->getDebugID() << " out: "
             << BBState.OutAvailability << "\n");
-
-      // Clear the worklist-flag for the next call to computePredsLiveOut().
-      // This could be moved out of the outer loop, but doing it here avoids
-      // another loop with getBlockInfo() calls.
-      BBState.isInWorkList = false;
     }
   } while (changed);
 }
 
 void LifetimeChecker::
 getOutAvailability(SILBasicBlock *BB, AvailabilitySet &Result) {
-  computePredsLiveOut(BB);
+  computeLiveOut();
   
   for (auto Pred : BB->getPreds()) {
     // If self was consumed in a predecessor P, don't look at availability
@@ -2287,7 +2277,7 @@ getOutAvailability(SILBasicBlock *BB, AvailabilitySet &Result) {
 
 void LifetimeChecker::
 getOutSelfConsumed(SILBasicBlock *BB, Optional<DIKind> &Result) {
-  computePredsLiveOut(BB);
+  computeLiveOut();
   
   for (auto Pred : BB->getPreds())
     Result = mergeKinds(Result, getBlockInfo(Pred).OutSelfConsumed);
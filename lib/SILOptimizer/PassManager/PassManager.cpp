@@ -13,6 +13,7 @@
 #define DEBUG_TYPE "sil-passmanager"
 
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/TraceEvents.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILModule.h"
@@ -23,14 +24,21 @@
 #include "swift/SILOptimizer/Analysis/FunctionOrder.h"
 #include "swift/SILOptimizer/Analysis/BasicCalleeAnalysis.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/GraphWriter.h"
+#include <algorithm>
 
 using namespace swift;
 
 STATISTIC(NumOptzIterations, "Number of optimization iterations");
+STATISTIC(NumFunctionPassLevels,
+          "Number of independent call graph levels in function pass runs");
+STATISTIC(NumFunctionsInWidestLevel,
+          "Number of functions in the widest call graph level");
 
 llvm::cl::opt<bool> SILPrintAll(
     "sil-print-all", llvm::cl::init(false),
@@ -44,6 +52,11 @@ llvm::cl::opt<bool> SILPrintPassTime(
     "sil-print-pass-time", llvm::cl::init(false),
     llvm::cl::desc("Print the execution time of each SIL pass"));
 
+llvm::cl::opt<bool> SILOptPassProfile(
+    "sil-opt-pass-profile", llvm::cl::init(false),
+    llvm::cl::desc("Print the time and instruction count change of each SIL "
+                   "pass on each function, slowest first"));
+
 llvm::cl::opt<unsigned> SILNumOptPassesToRun(
     "sil-opt-pass-count", llvm::cl::init(UINT_MAX),
     llvm::cl::desc("Stop optimizing after <N> optimization passes"));
@@ -94,6 +107,28 @@ llvm::cl::opt<bool> SILVerifyWithoutInvalidation(
     "sil-verify-without-invalidation", llvm::cl::init(false),
     llvm::cl::desc("Verify after passes even if the pass has not invalidated"));
 
+llvm::cl::opt<unsigned> SILVerifySampleRate(
+    "sil-verify-sample-rate", llvm::cl::init(1),
+    llvm::cl::desc("With -sil-verify-all, verify each function after only "
+                   "about one in <N> passes"));
+
+llvm::cl::opt<unsigned> SILVerifySampleSeed(
+    "sil-verify-sample-seed", llvm::cl::init(0),
+    llvm::cl::desc("Seed for choosing the passes verified with "
+                   "-sil-verify-sample-rate"));
+
+/// Returns true if \p F, or the module if \p F is null, should be verified
+/// after the pass with the number \p PassNumber.  The choice only depends on
+/// the function name, the pass number and the seed, so a failure found with a
+/// given seed reproduces with the same seed.
+static bool isVerificationSampled(SILFunction *F, unsigned PassNumber) {
+  if (SILVerifySampleRate <= 1)
+    return true;
+  StringRef Name = F ? F->getName() : StringRef();
+  size_t Hash = llvm::hash_combine(Name, PassNumber, SILVerifySampleSeed);
+  return Hash % SILVerifySampleRate == 0;
+}
+
 static bool doPrintBefore(SILTransform *T, SILFunction *F) {
   if (!SILPrintOnlyFun.empty() && F && F->getName() != SILPrintOnlyFun)
     return false;
@@ -205,6 +240,25 @@ static bool breakBeforeRunning(StringRef fnName, StringRef passName) {
   return fnName == SILBreakOnFun && passName == SILBreakOnPass;
 }
 
+static unsigned countInstructions(SILFunction *F) {
+  unsigned Count = 0;
+  for (auto &BB : *F)
+    Count += std::distance(BB.begin(), BB.end());
+  return Count;
+}
+
+static unsigned countInstructions(SILModule *M) {
+  unsigned Count = 0;
+  for (auto &F : *M)
+    Count += countInstructions(&F);
+  return Count;
+}
+
+static uint64_t nanosecondsSince(llvm::sys::TimeValue StartTime) {
+  auto Delta = llvm::sys::TimeValue::now() - StartTime;
+  return uint64_t(Delta.seconds()) * 1000000000 + Delta.nanoseconds();
+}
+
 void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
                                          SILFunction *F,
                                          bool runToCompletion) {
@@ -252,11 +306,15 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
       F->dump(Options.EmitVerboseSIL);
     }
 
+    unsigned InstructionsBefore = SILOptPassProfile ? countInstructions(F) : 0;
     llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
     Mod->registerDeleteNotificationHandler(SFT);
     if (breakBeforeRunning(F->getName(), SFT->getName()))
       LLVM_BUILTIN_DEBUGTRAP;
-    SFT->run();
+    {
+      TraceSpan span(SFT->getName(), F->getName());
+      SFT->run();
+    }
     assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
     Mod->removeDeleteNotificationHandler(SFT);
 
@@ -271,6 +329,10 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
                    << ")\n";
     }
 
+    if (SILOptPassProfile)
+      recordPassProfile(SFT, F, nanosecondsSince(StartTime),
+                        InstructionsBefore, countInstructions(F));
+
     // If this pass invalidated anything, print and verify.
     if (doPrintAfter(SFT, F, CurrentPassHasInvalidated && SILPrintAll)) {
       llvm::dbgs() << "*** SIL function after " << StageName << " "
@@ -284,7 +346,8 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
       completedPasses.set((size_t)SFT->getPassKind());
 
     if (Options.VerifyAll &&
-        (CurrentPassHasInvalidated || SILVerifyWithoutInvalidation)) {
+        (CurrentPassHasInvalidated || SILVerifyWithoutInvalidation) &&
+        isVerificationSampled(F, NumPassesRun)) {
       F->verify();
       verifyAnalyses(F);
     }
@@ -305,11 +368,49 @@ void SILPassManager::runPassesOnFunction(PassList FuncTransforms,
   }
 }
 
+/// Report how many of the functions in \p BottomUpOrder could be optimized
+/// concurrently, because their call graph SCCs don't depend on each other.
+///
+/// The function pipeline itself still runs on one thread: passes create and
+/// delete functions, read callee bodies while inlining, and share the
+/// module's allocator and analyses, none of which is synchronized.
+void SILPassManager::reportFunctionPassParallelism(
+    BottomUpFunctionOrder &BottomUpOrder) {
+  auto SCCs = BottomUpOrder.getSCCs();
+  auto Levels = BottomUpOrder.getSCCLevels();
+
+  llvm::SmallVector<unsigned, 16> FunctionsPerLevel;
+  for (unsigned i = 0, e = SCCs.size(); i != e; ++i) {
+    for (auto *F : SCCs[i]) {
+      if (!F->isDefinition() || !F->shouldOptimize())
+        continue;
+      if (FunctionsPerLevel.size() <= Levels[i])
+        FunctionsPerLevel.resize(Levels[i] + 1);
+      ++FunctionsPerLevel[Levels[i]];
+    }
+  }
+  if (FunctionsPerLevel.empty())
+    return;
+
+  unsigned Widest = *std::max_element(FunctionsPerLevel.begin(),
+                                      FunctionsPerLevel.end());
+  NumFunctionPassLevels += FunctionsPerLevel.size();
+  NumFunctionsInWidestLevel = std::max(unsigned(NumFunctionsInWidestLevel),
+                                       Widest);
+  DEBUG(llvm::dbgs() << "*** Function pass run has "
+                     << FunctionsPerLevel.size()
+                     << " call graph levels; the widest has " << Widest
+                     << " functions\n");
+}
+
 void SILPassManager::runFunctionPasses(PassList FuncTransforms) {
   BasicCalleeAnalysis *BCA = getAnalysis<BasicCalleeAnalysis>();
   BottomUpFunctionOrder BottomUpOrder(*Mod, BCA);
   auto BottomUpFunctions = BottomUpOrder.getFunctions();
 
+  if (getOptions().NumThreads > 1)
+    reportFunctionPassParallelism(BottomUpOrder);
+
   assert(FunctionWorklist.empty() && "Expected empty function worklist!");
 
   FunctionWorklist.reserve(BottomUpFunctions.size());
@@ -427,10 +528,14 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
     printModule(Mod, Options.EmitVerboseSIL);
   }
 
+  unsigned InstructionsBefore = SILOptPassProfile ? countInstructions(Mod) : 0;
   llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
   Mod->registerDeleteNotificationHandler(SMT);
-  SMT->run();
+  {
+    TraceSpan span(SMT->getName());
+    SMT->run();
+  }
   Mod->removeDeleteNotificationHandler(SMT);
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
 
@@ -440,6 +545,10 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
     llvm::dbgs() << Delta << " (" << SMT->getName() << ",Module)\n";
   }
 
+  if (SILOptPassProfile)
+    recordPassProfile(SMT, nullptr, nanosecondsSince(StartTime),
+                      InstructionsBefore, countInstructions(Mod));
+
   // If this pass invalidated anything, print and verify.
   if (doPrintAfter(SMT, nullptr,
                    CurrentPassHasInvalidated && SILPrintAll)) {
@@ -450,7 +559,8 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
   }
 
   if (Options.VerifyAll &&
-      (CurrentPassHasInvalidated || !SILVerifyWithoutInvalidation)) {
+      (CurrentPassHasInvalidated || !SILVerifyWithoutInvalidation) &&
+      isVerificationSampled(nullptr, NumPassesRun)) {
     Mod->verify();
     verifyAnalyses();
   }
@@ -525,6 +635,53 @@ void SILPassManager::run() {
     }
   }
   runOneIteration();
+
+  if (SILOptPassProfile)
+    printPassProfiles();
+}
+
+void SILPassManager::recordPassProfile(SILTransform *T, SILFunction *F,
+                                       uint64_t Nanoseconds,
+                                       unsigned InstructionsBefore,
+                                       unsigned InstructionsAfter) {
+  std::string FunctionName = F ? F->getName().str() : std::string();
+  auto &Profile = PassProfiles[{T->getName(), FunctionName}];
+  if (Profile.Runs == 0)
+    Profile.InstructionsBefore = InstructionsBefore;
+  Profile.InstructionsAfter = InstructionsAfter;
+  Profile.Nanoseconds += Nanoseconds;
+  ++Profile.Runs;
+}
+
+void SILPassManager::printPassProfiles() {
+  typedef std::pair<const std::pair<llvm::StringRef, std::string>,
+                    PassProfile> Entry;
+  std::vector<const Entry *> Sorted;
+  uint64_t TotalNanoseconds = 0;
+  for (auto &E : PassProfiles) {
+    Sorted.push_back(&E);
+    TotalNanoseconds += E.second.Nanoseconds;
+  }
+  std::stable_sort(Sorted.begin(), Sorted.end(),
+                   [](const Entry *LHS, const Entry *RHS) {
+                     return LHS->second.Nanoseconds > RHS->second.Nanoseconds;
+                   });
+
+  llvm::dbgs() << "*** SIL pass profile for " << StageName << " ("
+               << TotalNanoseconds / 1000 << " us total) ***\n"
+               << "  usec    runs  insts before -> after  pass  function\n";
+  for (auto *E : Sorted) {
+    const PassProfile &P = E->second;
+    llvm::dbgs() << llvm::format("%8llu  %4u  %8u -> %-8u  ",
+                                 (unsigned long long)(P.Nanoseconds / 1000),
+                                 P.Runs, P.InstructionsBefore,
+                                 P.InstructionsAfter)
+                 << E->first.first << "  "
+                 << (E->first.second.empty() ? "<module>"
+                                             : E->first.second.c_str())
+                 << '\n';
+  }
+  PassProfiles.clear();
 }
 
 /// D'tor.
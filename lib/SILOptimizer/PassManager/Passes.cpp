@@ -287,6 +287,9 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   PM.setStageName("HighLevel+EarlyLoopOpt");
   // FIXME: update this to be a function pass.
   PM.addEagerSpecializer();
+  // Fuse map and filter chains while the calls are still generic, so that a
+  // fused map can produce a different element type.
+  PM.addSequenceFusion();
   AddSSAPasses(PM, OptimizationLevelKind::HighLevel);
   AddHighLevelLoopOptPasses(PM);
   PM.runOneIteration();
@@ -328,6 +331,11 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   // take advantage of static dispatch.
   PM.addCapturePropagation();
 
+  // Pass concrete classes instead of class existentials to functions whose
+  // callers all agree on the class. This exposes the protocol method calls in
+  // the callee to devirtualization.
+  PM.addExistentialSpecializer();
+
   // Specialize closure.
   PM.addClosureSpecializer();
 
@@ -376,6 +384,13 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   PM.addCodeSinking();
   PM.addLICM();
 
+  // Loops which only became canonical through the low-level inlining, e.g.
+  // loops over unsafe buffers, still have an overflow check on their
+  // induction variable. Hoist it into a preheader guard so that the loop has a
+  // single exit and a computable trip count for LLVM's loop vectorizer.
+  PM.addABCOpt();
+  PM.addDCE();
+
   // Optimize overflow checks.
   PM.addRedundantOverflowCheckRemoval();
   PM.addMergeCondFails();
@@ -388,6 +403,18 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   // after FSO.
   PM.addLateReleaseHoisting();
 
+  // Relax reference counting operations on thread-local objects once ARC
+  // optimization has settled where they are.
+  PM.addNonAtomicRC();
+
+  // Move trap and error paths out of line, so that they don't take up space
+  // in the hot code.
+  PM.addColdBlockOutliner();
+
+  // Record the effects of public functions, now that their bodies are final,
+  // so that they are serialized for clients.
+  PM.addFunctionEffectsInference();
+
   PM.runOneIteration();
 
   PM.resetAndRemoveTransformations();
@@ -428,6 +455,11 @@ void swift::runSILPassesForOnone(SILModule &Module) {
   // eventually remove unused declarations.
   PM.addExternalDefsToDecls();
 
+  // Without optimization, only -assume-single-threaded relaxes reference
+  // counting.
+  if (Module.getOptions().AssumeSingleThreaded)
+    PM.addNonAtomicRC();
+
   // Has only an effect if the -gsil option is specified.
   PM.addSILDebugInfoGenerator();
 
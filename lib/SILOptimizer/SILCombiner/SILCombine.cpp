@@ -31,6 +31,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
@@ -39,6 +40,20 @@ STATISTIC(NumSimplified, "Number of instructions simplified");
 STATISTIC(NumCombined, "Number of instructions combined");
 STATISTIC(NumDeadInst, "Number of dead insts eliminated");
 
+/// Above this number of instructions, SILCombine does not rescan the whole
+/// function until it reaches a fixpoint. It only processes the instructions
+/// which were put on the worklist because one of their operands or users
+/// changed.
+llvm::cl::opt<unsigned> SILCombineFixpointInstLimit(
+    "sil-combine-fixpoint-inst-limit", llvm::cl::init(20000),
+    llvm::cl::desc("Maximum number of instructions in a function for which "
+                   "SILCombine iterates until a fixpoint"));
+
+llvm::cl::opt<bool> SILCombinePrintVisitorStats(
+    "sil-combine-print-visitor-stats", llvm::cl::init(false),
+    llvm::cl::desc("Print how often each SILCombine visitor was tried and "
+                   "how often it changed something"));
+
 //===----------------------------------------------------------------------===//
 //                              Utility Methods
 //===----------------------------------------------------------------------===//
@@ -170,7 +185,17 @@ bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
     DEBUG(llvm::raw_string_ostream SS(OrigI); I->print(SS); OrigI = SS.str(););
     DEBUG(llvm::dbgs() << "SC: Visiting: " << OrigI << '\n');
 
-    if (SILInstruction *Result = visit(I)) {
+    // Visitors which erase I return null, so MadeChange tells us whether
+    // the visitor did anything.
+    ValueKind Kind = I->getKind();
+    bool ChangedBeforeVisit = MadeChange;
+    MadeChange = false;
+    SILInstruction *Result = visit(I);
+    if (VisitorStats)
+      VisitorStats->record(Kind, Result || MadeChange);
+    MadeChange |= ChangedBeforeVisit;
+
+    if (Result) {
       ++NumCombined;
       // Should we replace the old instruction with a new one?
       if (Result != I) {
@@ -239,11 +264,19 @@ void SILCombineWorklist::addInitialGroup(ArrayRef<SILInstruction *> List) {
 bool SILCombiner::runOnFunction(SILFunction &F) {
   clear();
 
+  unsigned NumInsts = 0;
+  for (auto &BB : F)
+    NumInsts += std::distance(BB.begin(), BB.end());
+
   bool Changed = false;
-  // Perform iterations until we do not make any changes.
+  // Perform iterations until we do not make any changes. In large functions
+  // the first iteration is enough: it already revisits the users and operands
+  // of all changed instructions.
   while (doOneIteration(F, Iteration)) {
     Changed = true;
     Iteration++;
+    if (NumInsts > SILCombineFixpointInstLimit)
+      break;
   }
 
   // Cleanup the builder and return whether or not we made any changes.
@@ -311,6 +344,27 @@ SILInstruction *SILCombiner::eraseInstFromFunction(SILInstruction &I,
   return nullptr;  // Don't do anything with I
 }
 
+static StringRef getInstructionKindName(ValueKind Kind) {
+  switch (Kind) {
+#define INST(Id, Parent, MemBehavior, MayRelease) \
+  case ValueKind::Id:                             \
+    return #Id;
+#include "swift/SIL/SILNodes.def"
+  default:
+    llvm_unreachable("not an instruction kind");
+  }
+}
+
+void SILCombineVisitorStats::print(llvm::raw_ostream &OS) const {
+  OS << "SILCombine visitors (tried / fired):\n";
+  for (unsigned i = 0; i != NumKinds; ++i) {
+    if (!Tried[i])
+      continue;
+    OS << "  " << getInstructionKindName(ValueKind(i)) << ": " << Tried[i]
+       << " / " << Fired[i] << "\n";
+  }
+}
+
 //===----------------------------------------------------------------------===//
 //                                Entry Points
 //===----------------------------------------------------------------------===//
@@ -320,7 +374,17 @@ namespace {
 class SILCombine : public SILFunctionTransform {
 
   llvm::SmallVector<SILInstruction *, 64> TrackingList;
-  
+
+  /// The visitor counters of all functions this pass ran on.
+  SILCombineVisitorStats VisitorStats;
+
+public:
+  ~SILCombine() override {
+    if (SILCombinePrintVisitorStats)
+      VisitorStats.print(llvm::errs());
+  }
+
+private:
   /// The entry point to the transformation.
   void run() override {
     auto *AA = PM->getAnalysis<AliasAnalysis>();
@@ -328,7 +392,8 @@ class SILCombine : public SILFunctionTransform {
     // Create a SILBuilder with a tracking list for newly added
     // instructions, which we will periodically move to our worklist.
     SILBuilder B(*getFunction(), &TrackingList);
-    SILCombiner Combiner(B, AA, getOptions().RemoveRuntimeAsserts);
+    SILCombiner Combiner(B, AA, getOptions().RemoveRuntimeAsserts,
+                         SILCombinePrintVisitorStats ? &VisitorStats : nullptr);
     bool Changed = Combiner.runOnFunction(*getFunction());
     assert(TrackingList.empty() &&
            "TrackingList should be fully processed by SILCombiner");
@@ -33,6 +33,24 @@ namespace swift {
 
 class AliasAnalysis;
 
+/// Counts how often the visitor of each instruction kind was tried and how
+/// often it changed something.
+struct SILCombineVisitorStats {
+  static const unsigned NumKinds =
+      unsigned(ValueKind::Last_SILInstruction) + 1;
+  unsigned Tried[NumKinds] = {};
+  unsigned Fired[NumKinds] = {};
+
+  void record(ValueKind Kind, bool DidFire) {
+    ++Tried[unsigned(Kind)];
+    if (DidFire)
+      ++Fired[unsigned(Kind)];
+  }
+
+  /// Print the counters of all visitors which were tried at least once.
+  void print(llvm::raw_ostream &OS) const;
+};
+
 /// This is the worklist management logic for SILCombine.
 class SILCombineWorklist {
   llvm::SmallVector<SILInstruction *, 256> Worklist;
@@ -125,8 +143,12 @@ class SILCombiner :
   /// Cast optimizer
   CastOptimizer CastOpt;
 
+  /// If not null, the visitor counters to update.
+  SILCombineVisitorStats *VisitorStats;
+
 public:
-  SILCombiner(SILBuilder &B, AliasAnalysis *AA, bool removeCondFails)
+  SILCombiner(SILBuilder &B, AliasAnalysis *AA, bool removeCondFails,
+              SILCombineVisitorStats *VisitorStats = nullptr)
       : AA(AA), Worklist(), MadeChange(false), RemoveCondFails(removeCondFails),
         Iteration(0), Builder(B),
         CastOpt(/* ReplaceInstUsesAction */
@@ -134,7 +156,8 @@ public:
                   replaceInstUsesWith(*I, V);
                 },
                 /* EraseAction */
-                [&](SILInstruction *I) { eraseInstFromFunction(*I); }) {}
+                [&](SILInstruction *I) { eraseInstFromFunction(*I); }),
+        VisitorStats(VisitorStats) {}
 
   bool runOnFunction(SILFunction &F);
 
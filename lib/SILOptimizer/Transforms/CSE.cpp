@@ -11,7 +11,8 @@
 //===----------------------------------------------------------------------===//
 //
 // This pass performs a simple dominator tree walk that eliminates trivially
-// redundant instructions.
+// redundant instructions, and loads of memory which is known not to have
+// changed since it was last loaded or stored to.
 //
 //===----------------------------------------------------------------------===//
 
@@ -41,6 +42,7 @@ STATISTIC(NumOpenExtRemoved,
 
 STATISTIC(NumSimplify, "Number of instructions simplified or DCE'd");
 STATISTIC(NumCSE,      "Number of instructions CSE'd");
+STATISTIC(NumCSELoad,  "Number of loads CSE'd");
 
 using namespace swift;
 
@@ -403,6 +405,34 @@ public:
   /// their lookup.
   ScopedHTType *AvailableValues;
 
+  /// The value which was loaded from or stored to an address, and the
+  /// generation of memory at that point.
+  struct LoadValue {
+    ValueBase *Value = nullptr;
+    unsigned Generation = 0;
+
+    LoadValue() = default;
+    LoadValue(ValueBase *Value, unsigned Generation)
+        : Value(Value), Generation(Generation) {}
+  };
+  typedef llvm::ScopedHashTableVal<SILValue, LoadValue> LoadHTValueType;
+  typedef llvm::RecyclingAllocator<llvm::BumpPtrAllocator, LoadHTValueType>
+  LoadAllocatorTy;
+  typedef llvm::ScopedHashTable<SILValue, LoadValue,
+                                llvm::DenseMapInfo<SILValue>,
+                                LoadAllocatorTy> LoadHTType;
+
+  /// AvailableLoads - The values last loaded from or stored to each address
+  /// on the current path down the domtree. A value can only replace a load if
+  /// nothing may have written to memory since, i.e. if it was recorded in the
+  /// current generation.
+  LoadHTType *AvailableLoads;
+
+  /// CurrentGeneration - The generation of memory. It is bumped by every
+  /// instruction that may write to memory, and on entering a block which
+  /// can be reached from somewhere else than its immediate dominator.
+  unsigned CurrentGeneration = 0;
+
   SideEffectAnalysis *SEA;
 
   CSE(bool RunsOnHighLevelSil, SideEffectAnalysis *SEA)
@@ -423,13 +453,15 @@ private:
   // that the scope gets popped when the NodeScope is destroyed.
   class NodeScope {
    public:
-    NodeScope(ScopedHTType *availableValues) : Scope(*availableValues) {}
+    NodeScope(ScopedHTType *availableValues, LoadHTType *availableLoads)
+        : Scope(*availableValues), LoadScope(*availableLoads) {}
 
    private:
     NodeScope(const NodeScope &) = delete;
     void operator=(const NodeScope &) = delete;
 
     ScopedHTType::ScopeTy Scope;
+    LoadHTType::ScopeTy LoadScope;
   };
 
   // StackNode - contains all the needed information to create a stack for doing
@@ -438,13 +470,18 @@ private:
   // children do not need to be store separately.
   class StackNode {
    public:
-    StackNode(ScopedHTType *availableValues, DominanceInfoNode *n,
+    StackNode(ScopedHTType *availableValues, LoadHTType *availableLoads,
+              unsigned cg, DominanceInfoNode *n,
               DominanceInfoNode::iterator child,
               DominanceInfoNode::iterator end)
-        : Node(n), ChildIter(child), EndIter(end), Scopes(availableValues),
-      Processed(false) {}
+        : CurrentGeneration(cg), ChildGeneration(cg), Node(n),
+          ChildIter(child), EndIter(end),
+          Scopes(availableValues, availableLoads), Processed(false) {}
 
     // Accessors.
+    unsigned currentGeneration() { return CurrentGeneration; }
+    unsigned childGeneration() { return ChildGeneration; }
+    void childGeneration(unsigned generation) { ChildGeneration = generation; }
     DominanceInfoNode *node() { return Node; }
     DominanceInfoNode::iterator childIter() { return ChildIter; }
     DominanceInfoNode *nextChild() {
@@ -461,6 +498,8 @@ private:
     void operator=(const StackNode &) = delete;
 
     // Members.
+    unsigned CurrentGeneration;
+    unsigned ChildGeneration;
     DominanceInfoNode *Node;
     DominanceInfoNode::iterator ChildIter;
     DominanceInfoNode::iterator EndIter;
@@ -469,6 +508,8 @@ private:
   };
 
   bool processNode(DominanceInfoNode *Node);
+  bool processLoad(LoadInst *LI);
+  bool mayWriteToMemory(SILInstruction *Inst);
 };
 }  // end anonymous namespace
 
@@ -482,11 +523,15 @@ bool CSE::processFunction(SILFunction &Fm, DominanceInfo *DT) {
   // Tables that the pass uses when walking the domtree.
   ScopedHTType AVTable;
   AvailableValues = &AVTable;
+  LoadHTType LoadTable;
+  AvailableLoads = &LoadTable;
+  CurrentGeneration = 0;
 
   bool Changed = false;
 
   // Process the root node.
-  nodesToProcess.push_back(new StackNode(AvailableValues, DT->getRootNode(),
+  nodesToProcess.push_back(new StackNode(AvailableValues, AvailableLoads,
+                  CurrentGeneration, DT->getRootNode(),
                   DT->getRootNode()->begin(),
                   DT->getRootNode()->end()));
 
@@ -495,18 +540,22 @@ bool CSE::processFunction(SILFunction &Fm, DominanceInfo *DT) {
     // Grab the first item off the stack. Set the current generation, remove
     // the node from the stack, and process it.
     StackNode *NodeToProcess = nodesToProcess.back();
+    CurrentGeneration = NodeToProcess->currentGeneration();
 
     // Check if the node needs to be processed.
     if (!NodeToProcess->isProcessed()) {
       // Process the node.
       Changed |= processNode(NodeToProcess->node());
+      NodeToProcess->childGeneration(CurrentGeneration);
       NodeToProcess->process();
 
     } else if (NodeToProcess->childIter() != NodeToProcess->end()) {
       // Push the next child onto the stack.
       DominanceInfoNode *child = NodeToProcess->nextChild();
       nodesToProcess.push_back(
-          new StackNode(AvailableValues, child, child->begin(), child->end()));
+          new StackNode(AvailableValues, AvailableLoads,
+                        NodeToProcess->childGeneration(), child,
+                        child->begin(), child->end()));
     } else {
       // It has been processed, and there are no more children to process,
       // so delete it and pop it off the stack.
@@ -522,6 +571,12 @@ bool CSE::processNode(DominanceInfoNode *Node) {
   SILBasicBlock *BB = Node->getBlock();
   bool Changed = false;
 
+  // If this block has a single predecessor, it is the parent of the domtree
+  // node, and memory is still as the parent left it. Otherwise other paths
+  // into the block may have written to memory.
+  if (!BB->getSinglePredecessor())
+    ++CurrentGeneration;
+
   // See if any instructions in the block can be eliminated.  If so, do it.  If
   // not, add them to AvailableValues.
   for (SILBasicBlock::iterator I = BB->begin(), E = BB->end(); I != E;) {
@@ -551,6 +606,22 @@ bool CSE::processNode(DominanceInfoNode *Node) {
       continue;
     }
 
+    if (auto *LI = dyn_cast<LoadInst>(Inst)) {
+      Changed |= processLoad(LI);
+      continue;
+    }
+
+    // A store makes the stored value available to loads of the same address.
+    if (auto *SI = dyn_cast<StoreInst>(Inst)) {
+      ++CurrentGeneration;
+      AvailableLoads->insert(SI->getDest(),
+                             LoadValue(SI->getSrc(), CurrentGeneration));
+      continue;
+    }
+
+    if (mayWriteToMemory(Inst))
+      ++CurrentGeneration;
+
     // If this is not a simple instruction that we can value number, skip it.
     if (!canHandle(Inst))
       continue;
@@ -581,6 +652,42 @@ bool CSE::processNode(DominanceInfoNode *Node) {
   return Changed;
 }
 
+/// Replaces \p LI by the value last loaded from or stored to its address, if
+/// memory has not changed since. Otherwise records \p LI as that value.
+bool CSE::processLoad(LoadInst *LI) {
+  SILValue Addr = LI->getOperand();
+  LoadValue Available = AvailableLoads->lookup(Addr);
+  if (Available.Value && Available.Generation == CurrentGeneration &&
+      Available.Value->getType() == LI->getType()) {
+    DEBUG(llvm::dbgs() << "SILCSE CSE load: " << *LI << "  to: "
+                       << *Available.Value << '\n');
+    LI->replaceAllUsesWith(Available.Value);
+    LI->eraseFromParent();
+    ++NumCSELoad;
+    return true;
+  }
+
+  AvailableLoads->insert(Addr, LoadValue(LI, CurrentGeneration));
+  return false;
+}
+
+/// Returns true if \p Inst may change the contents of memory.
+bool CSE::mayWriteToMemory(SILInstruction *Inst) {
+  // Retains and traps change no memory a load can see.
+  if (isa<StrongRetainInst>(Inst) || isa<RetainValueInst>(Inst) ||
+      isa<CondFailInst>(Inst))
+    return false;
+
+  if (auto *AI = dyn_cast<ApplyInst>(Inst)) {
+    SideEffectAnalysis::FunctionEffects Effects;
+    SEA->getEffects(Effects, AI);
+    auto MB = Effects.getMemBehavior(RetainObserveKind::IgnoreRetains);
+    return MB != SILInstruction::MemoryBehavior::None &&
+           MB != SILInstruction::MemoryBehavior::MayRead;
+  }
+  return Inst->mayWriteToMemory();
+}
+
 bool CSE::canHandle(SILInstruction *Inst) {
   if (auto *AI = dyn_cast<ApplyInst>(Inst)) {
     if (!AI->mayReadOrWriteMemory())
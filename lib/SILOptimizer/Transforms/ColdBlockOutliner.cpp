@@ -0,0 +1,242 @@
+//===--- ColdBlockOutliner.cpp - Outline blocks ending in unreachable -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Blocks which end in an unreachable instruction are executed at most once
+// per program run: they trap or call a noreturn function like fatalError or
+// preconditionFailure. Their code, e.g. the formatting of an error message,
+// only costs code size and instruction cache space in the hot function.
+//
+// This pass moves the bodies of such blocks into a new private noreturn
+// function. The values which are used in the block but defined outside of it
+// are passed as arguments. The original block is reduced to a call of the new
+// function followed by an unreachable.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "cold-block-outlining"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SIL/DebugUtils.h"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILCloner.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumBlocksOutlined, "Number of cold blocks outlined");
+
+llvm::cl::opt<unsigned> ColdBlockOutlineThreshold(
+    "sil-cold-block-outline-threshold", llvm::cl::init(8),
+    llvm::cl::desc("Minimum number of instructions in a block ending in "
+                   "unreachable for it to be outlined"));
+
+/// Returns true if \p Ty refers to an archetype, which would need a generic
+/// signature on the outlined function.
+static bool hasArchetype(SILType Ty) {
+  return Ty.getSwiftRValueType()->hasArchetype();
+}
+
+/// Returns true if \p I can be moved into another function.
+static bool canOutlineInstruction(SILInstruction *I) {
+  // Stack allocations must be balanced within the function.
+  if (isa<AllocStackInst>(I) || isa<DeallocStackInst>(I))
+    return false;
+
+  for (const Operand &Op : I->getAllOperands())
+    if (hasArchetype(Op.get()->getType()))
+      return false;
+
+  if (I->hasValue() && hasArchetype(I->getType()))
+    return false;
+
+  if (auto *WMI = dyn_cast<WitnessMethodInst>(I))
+    if (WMI->getLookupType()->hasArchetype())
+      return false;
+
+  if (auto AS = ApplySite::isa(I))
+    for (const Substitution &Sub : AS.getSubstitutions())
+      if (Sub.getReplacement()->hasArchetype())
+        return false;
+
+  return true;
+}
+
+/// Returns the number of instructions in \p BB if it is worth outlining and
+/// all its instructions can be outlined, or zero otherwise.
+static unsigned getOutlinedSize(SILBasicBlock *BB) {
+  if (!isa<UnreachableInst>(BB->getTerminator()))
+    return 0;
+
+  unsigned Size = 0;
+  for (auto &I : *BB) {
+    if (!canOutlineInstruction(&I))
+      return 0;
+    if (!isDebugInst(&I))
+      ++Size;
+  }
+  return Size;
+}
+
+namespace {
+
+/// Clones the instructions of a cold block into the entry block of the
+/// outlined function.
+class ColdBlockCloner : public SILClonerWithScopes<ColdBlockCloner> {
+  using SuperTy = SILClonerWithScopes<ColdBlockCloner>;
+  friend class SILVisitor<ColdBlockCloner>;
+  friend class SILCloner<ColdBlockCloner>;
+
+public:
+  ColdBlockCloner(SILFunction *NewF) : SuperTy(*NewF) {}
+
+  /// Clone \p BB, replacing the values in \p LiveIns by the arguments of the
+  /// new function.
+  void cloneBlock(SILBasicBlock *BB, ArrayRef<SILValue> LiveIns) {
+    SILFunction &CloneF = getBuilder().getFunction();
+    SILModule &M = CloneF.getModule();
+    SILBasicBlock *EntryBB = CloneF.createBasicBlock();
+
+    for (SILValue V : LiveIns) {
+      SILValue MappedValue = new (M) SILArgument(EntryBB, V->getType());
+      ValueMap.insert(std::make_pair(V, MappedValue));
+    }
+
+    getBuilder().setInsertionPoint(EntryBB);
+    for (auto &I : *BB)
+      visit(&I);
+  }
+};
+
+/// Outline blocks ending in unreachable into noreturn functions.
+class ColdBlockOutliner : public SILFunctionTransform {
+  /// The number of functions outlined from the current function so far, used
+  /// to give them unique names.
+  unsigned NumOutlinedFromFunction = 0;
+
+  StringRef getName() override { return "Cold Block Outliner"; }
+
+  void run() override {
+    SILFunction *F = getFunction();
+
+    // Fragile and transparent functions may be inlined into other modules,
+    // which cannot see a private function.
+    if (F->isFragile() || F->isTransparent() || F->getContextGenericParams() ||
+        !F->shouldOptimize())
+      return;
+
+    NumOutlinedFromFunction = 0;
+    bool Changed = false;
+    for (auto &BB : *F) {
+      if (&BB == &*F->begin())
+        continue;
+      if (getOutlinedSize(&BB) < ColdBlockOutlineThreshold)
+        continue;
+      outlineBlock(&BB);
+      Changed = true;
+    }
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
+  }
+
+  /// Collect the values which are used in \p BB but defined outside of it.
+  void collectLiveIns(SILBasicBlock *BB,
+                      llvm::SmallSetVector<SILValue, 8> &LiveIns) {
+    for (auto &I : *BB) {
+      for (const Operand &Op : I.getAllOperands()) {
+        SILValue V = Op.get();
+        if (isa<SILUndef>(V))
+          continue;
+        auto *Def = dyn_cast<SILInstruction>(V);
+        if (!Def || Def->getParent() != BB)
+          LiveIns.insert(V);
+      }
+    }
+  }
+
+  /// Create a private noreturn function with one parameter per live-in
+  /// value.
+  SILFunction *createOutlinedFunction(SILBasicBlock *BB,
+                                      ArrayRef<SILValue> LiveIns) {
+    SILFunction *F = BB->getParent();
+    SILModule &M = F->getModule();
+
+    SmallVector<SILParameterInfo, 8> Params;
+    for (SILValue V : LiveIns) {
+      SILType Ty = V->getType();
+      auto Conv = Ty.isAddress() ? ParameterConvention::Indirect_InoutAliasable
+                                 : ParameterConvention::Direct_Unowned;
+      Params.push_back(SILParameterInfo(Ty.getSwiftRValueType(), Conv));
+    }
+
+    auto ExtInfo = SILFunctionType::ExtInfo()
+                       .withRepresentation(SILFunctionType::Representation::Thin)
+                       .withIsNoReturn();
+    auto FTy = SILFunctionType::get(nullptr, ExtInfo,
+                                    ParameterConvention::Direct_Unowned, Params,
+                                    {}, None, M.getASTContext());
+
+    std::string Name;
+    do {
+      Name = (F->getName() + "_cold" + Twine(NumOutlinedFromFunction++)).str();
+    } while (M.lookUpFunction(Name));
+
+    SILFunction *NewF = M.createFunction(
+        SILLinkage::Private, Name, FTy, /*contextGenericParams*/ nullptr,
+        F->getLocation(), IsBare, IsNotTransparent, IsNotFragile, IsNotThunk,
+        SILFunction::NotRelevant, NoInline, EffectsKind::Unspecified,
+        /*InsertBefore*/ F, F->getDebugScope(), F->getDeclContext());
+    NewF->setDeclCtx(F->getDeclContext());
+    return NewF;
+  }
+
+  void outlineBlock(SILBasicBlock *BB) {
+    llvm::SmallSetVector<SILValue, 8> LiveIns;
+    collectLiveIns(BB, LiveIns);
+
+    SILFunction *NewF = createOutlinedFunction(BB, LiveIns.getArrayRef());
+    ColdBlockCloner Cloner(NewF);
+    Cloner.cloneBlock(BB, LiveIns.getArrayRef());
+
+    DEBUG(llvm::dbgs() << "  Outlined bb" << BB->getDebugID() << " of "
+                       << BB->getParent()->getName() << " into "
+                       << NewF->getName() << "\n");
+
+    // Replace the block's body with a call to the outlined function. Values
+    // defined in the block cannot have uses elsewhere, since the block has no
+    // successors.
+    UnreachableInst *Unreachable = cast<UnreachableInst>(BB->getTerminator());
+    SILLocation Loc = Unreachable->getLoc();
+    SILBuilderWithScope B(Unreachable);
+    auto *FRI = B.createFunctionRef(Loc, NewF);
+    B.createApply(Loc, FRI, LiveIns.getArrayRef(), /*isNonThrowing*/ false);
+
+    while (&*BB->begin() != FRI) {
+      SILInstruction *I = &*std::prev(FRI->getIterator());
+      I->replaceAllUsesWithUndef();
+      I->eraseFromParent();
+    }
+
+    notifyPassManagerOfFunction(NewF);
+    ++NumBlocksOutlined;
+  }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createColdBlockOutliner() {
+  return new ColdBlockOutliner();
+}
@@ -41,13 +41,14 @@
 // strong_release %arg : $A
 //
 // Eliminating the reference copies, avoids artificially bumping the refcount
-// which could save a copy of all elements in a COW container.
+// which could save a copy of all elements in a COW container. The same applies
+// to loadable structs and enums with references, which are copied with
+// retain_value and destroyed with release_value.
 //
-// The actual analysis and optimization do not depend on the copy being linked
-// to call arguments. Any obviously useless copy will be eliminated.
-//
-// TODO: Currently we only handle the address-only case, not the retain/release
-// case.
+// The actual analysis and optimization of address-only copies do not depend on
+// the copy being linked to call arguments. Any obviously useless copy will be
+// eliminated. Reference copies are only removed when they are passed to a call
+// as an @owned argument, within a single block.
 //
 // TODO: We should run this at -Onone even though it's not diagnostic.
 //
@@ -75,6 +76,8 @@ STATISTIC(NumCopyNRVO, "Number of copies removed via named return value opt.");
 STATISTIC(NumCopyForward, "Number of copies removed via forward propagation");
 STATISTIC(NumCopyBackward,
           "Number of copies removed via backward propagation");
+STATISTIC(NumRetainForward,
+          "Number of reference copies forwarded to @owned call arguments");
 
 using namespace swift;
 
@@ -1133,6 +1136,102 @@ static void performNRVO(CopyAddrInst *CopyInst) {
   CopyInst->eraseFromParent();
 }
 
+//===----------------------------------------------------------------------===//
+//                    Forwarding Reference Copies to Calls
+//===----------------------------------------------------------------------===//
+
+/// Returns the release that destroys the value copied by \p Retain after
+/// passing the copy to a call as an @owned argument, if the copy is useless:
+///
+///   retain_value %arg
+///   ... // nothing that may release
+///   apply %callee(%arg) // @owned
+///   ... // nothing with side effects, and no other uses of %arg
+///   release_value %arg
+///
+/// Instead, the call can consume the original value.
+static SILInstruction *findForwardableRelease(RefCountingInst *Retain) {
+  SILValue Value = Retain->getOperand(0);
+  SILBasicBlock *BB = Retain->getParent();
+
+  // Find the call which takes the copy.
+  ApplyInst *AI = nullptr;
+  auto II = std::next(Retain->getIterator());
+  for (auto IE = BB->end(); II != IE; ++II) {
+    AI = dyn_cast<ApplyInst>(&*II);
+    if (AI)
+      break;
+    if (II->mayRelease())
+      return nullptr;
+  }
+  if (!AI || AI->getCallee() == Value)
+    return nullptr;
+
+  // The call must take the value exactly once, as an @owned argument. Any
+  // other argument would rely on the value being kept alive by the caller.
+  auto Params = AI->getSubstCalleeType()->getParameters();
+  unsigned NumIndirectResults =
+      AI->getSubstCalleeType()->getNumIndirectResults();
+  unsigned NumOwnedUses = 0;
+  for (unsigned i = 0, e = AI->getNumArguments(); i != e; ++i) {
+    if (AI->getArgument(i) != Value)
+      continue;
+    if (i < NumIndirectResults ||
+        Params[i - NumIndirectResults].getConvention() !=
+            ParameterConvention::Direct_Owned)
+      return nullptr;
+    ++NumOwnedUses;
+  }
+  if (NumOwnedUses != 1)
+    return nullptr;
+
+  // The value must be destroyed right after the call, because the call may
+  // destroy it once it does not hold the copy anymore.
+  for (++II; II != BB->end(); ++II) {
+    bool UsesValue = std::any_of(
+        II->getAllOperands().begin(), II->getAllOperands().end(),
+        [&](const Operand &Op) { return Op.get() == Value; });
+    if (!UsesValue) {
+      if (II->mayHaveSideEffects())
+        return nullptr;
+      continue;
+    }
+    if ((isa<StrongRetainInst>(Retain) && isa<StrongReleaseInst>(&*II)) ||
+        (isa<RetainValueInst>(Retain) && isa<ReleaseValueInst>(&*II)))
+      return &*II;
+    return nullptr;
+  }
+  return nullptr;
+}
+
+/// Removes the reference copies that are only made to be consumed by a call.
+/// Returns true if any copy was removed.
+static bool forwardRetainsToCalls(SILFunction *F) {
+  bool Changed = false;
+  for (auto &BB : *F) {
+    for (auto II = BB.begin(), IE = BB.end(); II != IE;) {
+      SILInstruction *I = &*II;
+      ++II;
+      if (!isa<StrongRetainInst>(I) && !isa<RetainValueInst>(I))
+        continue;
+
+      auto *Retain = cast<RefCountingInst>(I);
+      SILInstruction *Release = findForwardableRelease(Retain);
+      if (!Release)
+        continue;
+
+      DEBUG(llvm::dbgs() << "  Forward copy to call" << *Retain);
+      ++NumRetainForward;
+      if (&*II == Release)
+        ++II;
+      Retain->eraseFromParent();
+      Release->eraseFromParent();
+      Changed = true;
+    }
+  }
+  return Changed;
+}
+
 //===----------------------------------------------------------------------===//
 //                         CopyForwardingPass
 //===----------------------------------------------------------------------===//
@@ -1182,6 +1281,10 @@ class CopyForwardingPass : public SILFunctionTransform
       invalidateAnalysis(SILAnalysis::InvalidationKind::CallsAndInstructions);
     }
 
+    // Forward reference copies to the calls which consume them.
+    if (EnableCopyForwarding && forwardRetainsToCalls(getFunction()))
+      invalidateAnalysis(SILAnalysis::InvalidationKind::Instructions);
+
     // Perform Copy Forwarding.
     if (CopiedDefs.empty())
       return;
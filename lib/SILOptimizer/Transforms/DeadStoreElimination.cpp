@@ -65,6 +65,7 @@
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/BitDataflow.h"
 #include "swift/SILOptimizer/Utils/CFG.h"
 #include "swift/SILOptimizer/Utils/LoadStoreOptUtils.h"
 #include "swift/SILOptimizer/Utils/Local.h"
@@ -164,9 +165,11 @@ namespace {
 /// which is a large function.  
 constexpr unsigned MaxLSLocationBBMultiplicationNone = 256*256;
 
-/// we could run optimistic DSE on functions with less than 64 basic blocks
-/// and 64 locations which is a sizeable function.
-constexpr unsigned MaxLSLocationBBMultiplicationPessimistic = 64*64;
+/// we could run optimistic DSE on functions with less than 128 basic blocks
+/// and 128 locations which is a sizeable function. The iterative data flow
+/// operates on whole words of the bit vectors, so this is bounded by the
+/// cost of computing the genset and killset.
+constexpr unsigned MaxLSLocationBBMultiplicationPessimistic = 128*128;
 
 /// forward declaration.
 class DSEContext;
@@ -204,37 +207,37 @@ public:
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the location currently has an
   /// upward visible store at the end of the basic block.
-  llvm::SmallBitVector BBWriteSetOut;
+  llvm::BitVector BBWriteSetOut;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the location currently has an
   /// upward visible store in middle of the basic block.
-  llvm::SmallBitVector BBWriteSetMid;
+  llvm::BitVector BBWriteSetMid;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If a bit in the vector is set, then the location has an
   /// upward visible store at the beginning of the basic block.
-  llvm::SmallBitVector BBWriteSetIn;
+  llvm::BitVector BBWriteSetIn;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the current basic block
   /// generates an upward visible store.
-  llvm::SmallBitVector BBGenSet;
+  llvm::BitVector BBGenSet;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the current basic block
   /// kills an upward visible store.
-  llvm::SmallBitVector BBKillSet;
+  llvm::BitVector BBKillSet;
 
   /// A bit vector to keep the maximum number of stores that can reach a 
   /// certain point of the basic block. If a bit is set, that means there is
   /// potentially an upward visible store to the location at the particular
   /// point of the basic block.
-  llvm::SmallBitVector BBMaxStoreSet;
+  llvm::BitVector BBMaxStoreSet;
 
   /// If a bit in the vector is set, then the location is dead at the end of
   /// this basic block. 
-  llvm::SmallBitVector BBDeallocateLocation;
+  llvm::BitVector BBDeallocateLocation;
 
   /// The dead stores in the current basic block.
   llvm::DenseSet<SILInstruction *> DeadStores;
@@ -256,14 +259,18 @@ public:
   /// Initialize the bitvectors for the current basic block.
   void init(unsigned LocationNum, bool Optimistic);
 
-  /// Check whether the BBWriteSetIn has changed. If it does, we need to rerun
-  /// the data flow on this block's predecessors to reach fixed point.
-  bool updateBBWriteSetIn(llvm::SmallBitVector &X);
+  /// Returns the sets of this basic block for the iterative data flow with
+  /// the genset and killset, which flows backwards from BBWriteSetOut to
+  /// BBWriteSetIn.
+  BitDataflow::BlockSets getDataflowSets() {
+    return {BBWriteSetOut, BBWriteSetIn, BBGenSet, BBKillSet,
+            &BBDeallocateLocation};
+  }
 
   /// Functions to manipulate the write set.
-  void startTrackingLocation(llvm::SmallBitVector &BV, unsigned bit);
-  void stopTrackingLocation(llvm::SmallBitVector &BV, unsigned bit);
-  bool isTrackingLocation(llvm::SmallBitVector &BV, unsigned bit);
+  void startTrackingLocation(llvm::BitVector &BV, unsigned bit);
+  void stopTrackingLocation(llvm::BitVector &BV, unsigned bit);
+  bool isTrackingLocation(llvm::BitVector &BV, unsigned bit);
 
   /// Set the store bit for stack slot deallocated in this basic block. 
   void initStoreSetAtEndOfBlock(DSEContext &Ctx);
@@ -271,22 +278,15 @@ public:
 
 } // end anonymous namespace
 
-bool BlockState::updateBBWriteSetIn(llvm::SmallBitVector &X) {
-  if (BBWriteSetIn == X)
-    return false;
-  BBWriteSetIn = X;
-  return true;
-}
-
-void BlockState::startTrackingLocation(llvm::SmallBitVector &BV, unsigned i) {
+void BlockState::startTrackingLocation(llvm::BitVector &BV, unsigned i) {
   BV.set(i);
 }
 
-void BlockState::stopTrackingLocation(llvm::SmallBitVector &BV, unsigned i) {
+void BlockState::stopTrackingLocation(llvm::BitVector &BV, unsigned i) {
   BV.reset(i);
 }
 
-bool BlockState::isTrackingLocation(llvm::SmallBitVector &BV, unsigned i) {
+bool BlockState::isTrackingLocation(llvm::BitVector &BV, unsigned i) {
   return BV.test(i);
 }
 
@@ -425,6 +425,15 @@ private:
   /// Get the bit representing the location in the LocationVault.
   unsigned getLocationBit(const LSLocation &L);
 
+  /// Returns the backward data flow over the BBWriteSets of the function.
+  BitDataflow getDataflow() {
+    return BitDataflow(PM->getAnalysis<PostOrderAnalysis>()->get(F),
+                       BitDataflow::Direction::Backward,
+                       [this](SILBasicBlock *BB) {
+                         return getBlockState(BB)->getDataflowSets();
+                       });
+  }
+
 public:
   /// Constructor.
   DSEContext(SILFunction *F, SILModule *M, SILPassManager *PM,
@@ -456,10 +465,6 @@ public:
   /// Compute the genset and killset for the current basic block.
   void processBasicBlockForGenKillSet(SILBasicBlock *BB);
 
-  /// Compute the BBWriteSetOut and BBWriteSetIn for the current basic
-  /// block with the generated gen and kill set.
-  bool processBasicBlockWithGenKillSet(SILBasicBlock *BB);
-
   /// Intersect the successors' BBWriteSetIns.
   void mergeSuccessorLiveIns(SILBasicBlock *BB);
 
@@ -602,20 +607,6 @@ void DSEContext::processBasicBlockForGenKillSet(SILBasicBlock *BB) {
   }
 }
 
-bool DSEContext::processBasicBlockWithGenKillSet(SILBasicBlock *BB) {
-  // Compute the BBWriteSetOut at the end of the basic block.
-  mergeSuccessorLiveIns(BB);
-
-  // Compute the BBWriteSet at the beginning of the basic block.
-  BlockState *S = getBlockState(BB);
-  S->BBWriteSetMid = S->BBWriteSetOut;
-  S->BBWriteSetMid.reset(S->BBKillSet);
-  S->BBWriteSetMid |= S->BBGenSet;
- 
-  // If BBWriteSetIn changes, then keep iterating until reached a fixed point.
-  return S->updateBBWriteSetIn(S->BBWriteSetMid);
-}
-
 void DSEContext::processBasicBlockForDSE(SILBasicBlock *BB, bool Optimistic) {
   // If we know this is not a one iteration function which means its
   // its BBWriteSetIn and BBWriteSetOut have been computed and converged, 
@@ -665,18 +656,6 @@ void BlockState::initStoreSetAtEndOfBlock(DSEContext &Ctx) {
 }
 
 void DSEContext::mergeSuccessorLiveIns(SILBasicBlock *BB) {
-  // If basic block has no successor, then all local writes can be considered
-  // dead for block with no successor.
-  BlockState *C = getBlockState(BB);
-  if (BB->succ_empty()) {
-    C->BBWriteSetOut |= C->BBDeallocateLocation;
-    return;
-  }
-
-  // Use the first successor as the base condition.
-  auto Iter = BB->succ_begin();
-  C->BBWriteSetOut = getBlockState(*Iter)->BBWriteSetIn;
-
   /// Merge/intersection is very frequently performed, so it is important to
   /// make it as cheap as possible.
   ///
@@ -688,14 +667,11 @@ void DSEContext::mergeSuccessorLiveIns(SILBasicBlock *BB) {
   /// still possible that 2 LSLocations with different bases that happen to be
   /// the same object and field. In such case, we would miss a dead store
   /// opportunity. But this happens less often with canonicalization.
-  Iter = std::next(Iter);
-  for (auto EndIter = BB->succ_end(); Iter != EndIter; ++Iter) {
-    C->BBWriteSetOut &= getBlockState(*Iter)->BBWriteSetIn;
-  }
-
-  // We set the store bit at the end of the basic block in which a stack
-  // allocated location is deallocated.
-  C->BBWriteSetOut |= C->BBDeallocateLocation;
+  ///
+  /// All local writes can be considered dead for a block with no successor.
+  /// We also set the store bit at the end of the basic block in which a stack
+  /// allocated location is deallocated.
+  getDataflow().meet(BB);
 }
 
 void DSEContext::invalidateBaseForGenKillSet(SILValue B, BlockState *S) {
@@ -1109,27 +1085,7 @@ void DSEContext::runIterativeDSE() {
   // Process each basic block with the gen and kill set. Every time the
   // BBWriteSetIn of a basic block changes, the optimization is rerun on its
   // predecessors.
-  llvm::SmallVector<SILBasicBlock *, 16> WorkList;
-  llvm::DenseSet<SILBasicBlock *> HandledBBs;
-  // Push into reverse post order so that we can pop from the back and get
-  // post order.
-  for (SILBasicBlock *B : PO->getReversePostOrder()) {
-    WorkList.push_back(B);
-    HandledBBs.insert(B);
-  }
-  while (!WorkList.empty()) {
-    SILBasicBlock *BB = WorkList.pop_back_val();
-    HandledBBs.erase(BB);
-    if (processBasicBlockWithGenKillSet(BB)) {
-      for (auto X : BB->getPreds()) {
-        // We do not push basic block into the worklist if its already 
-        // in the worklist.
-        if (HandledBBs.find(X) != HandledBBs.end())
-          continue;
-        WorkList.push_back(X);
-      }
-    }
-  }
+  getDataflow().solve();
 }
 
 bool DSEContext::run() {
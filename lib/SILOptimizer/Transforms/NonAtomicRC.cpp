@@ -0,0 +1,106 @@
+//===--- NonAtomicRC.cpp - Use non-atomic RC for thread-local objects -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Marks reference counting instructions as [nonatomic] when no other thread
+// can observe the reference count they modify.
+//
+// An object allocated in a function that escape analysis shows never escapes
+// that function (not into globals, not through arguments, not via the return
+// value) can only be reached from the thread running the function, so its
+// retains and releases don't need to be atomic.
+//
+// With -assume-single-threaded every reference counting instruction is
+// marked, which gives an upper bound for what non-atomic reference counting
+// can save.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "nonatomic-rc"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SILOptimizer/Analysis/EscapeAnalysis.h"
+#include "swift/SILOptimizer/Analysis/RCIdentityAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+STATISTIC(NumNonAtomicRC, "Number of reference counting instructions made "
+                          "non-atomic");
+
+using namespace swift;
+
+/// Returns true if the object that \p RCI operates on is known not to be
+/// reachable from any other thread.
+static bool isThreadLocal(RefCountingInst *RCI, RCIdentityFunctionInfo *RCFI,
+                          EscapeAnalysis::ConnectionGraph *ConGraph,
+                          EscapeAnalysis *EA) {
+  SILValue Root = RCFI->getRCIdentityRoot(RCI->getOperand(0));
+  if (!isa<AllocRefInst>(Root))
+    return false;
+
+  auto *Node = ConGraph->getNodeOrNull(Root, EA);
+  return Node && !Node->escapes();
+}
+
+namespace {
+
+class NonAtomicRC : public SILFunctionTransform {
+
+  void run() override {
+    SILFunction *F = getFunction();
+    bool AssumeSingleThreaded =
+        F->getModule().getOptions().AssumeSingleThreaded;
+
+    DEBUG(llvm::dbgs() << "** NonAtomicRC on " << F->getName() << " **\n");
+
+    RCIdentityFunctionInfo *RCFI = nullptr;
+    EscapeAnalysis *EA = nullptr;
+    EscapeAnalysis::ConnectionGraph *ConGraph = nullptr;
+    if (!AssumeSingleThreaded) {
+      RCFI = PM->getAnalysis<RCIdentityAnalysis>()->get(F);
+      EA = PM->getAnalysis<EscapeAnalysis>();
+      ConGraph = EA->getConnectionGraph(F);
+      if (!ConGraph)
+        return;
+    }
+
+    bool Changed = false;
+    for (auto &BB : *F) {
+      for (auto &I : BB) {
+        auto *RCI = dyn_cast<RefCountingInst>(&I);
+        if (!RCI || RCI->isNonAtomic())
+          continue;
+
+        if (!AssumeSingleThreaded && !isThreadLocal(RCI, RCFI, ConGraph, EA))
+          continue;
+
+        DEBUG(llvm::dbgs() << "  making non-atomic: " << *RCI);
+        RCI->setNonAtomic();
+        ++NumNonAtomicRC;
+        Changed = true;
+      }
+    }
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::Instructions);
+  }
+
+  StringRef getName() override { return "NonAtomicRC"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createNonAtomicRC() {
+  return new NonAtomicRC();
+}
@@ -1105,7 +1105,9 @@ SILFunction *SILPerformanceInliner::getEligibleFunction(FullApplySite AI) {
     }
   }
 
-  // We can't inline external declarations.
+  // We can't inline external declarations. This includes functions whose
+  // serialized bodies the linker didn't load because they are too large to
+  // be worth inlining.
   if (Callee->empty() || Callee->isExternalDeclaration()) {
     return nullptr;
   }
@@ -1169,6 +1171,15 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
   if (Callee->getInlineStrategy() == AlwaysInline)
     return true;
 
+  // If the profile shows that the caller or the callee never ran, inlining
+  // only grows the code, so treat the call site like one in a cold block.
+  auto isNeverExecuted = [](SILFunction *F) {
+    auto Count = F->getEntryCount();
+    return Count && *Count == 0;
+  };
+  if (isNeverExecuted(AI.getFunction()) || isNeverExecuted(Callee))
+    return isProfitableInColdBlock(AI, Callee);
+
   SILLoopInfo *LI = LA->get(Callee);
   ShortestPathAnalysis *SPA = getSPA(Callee, LI);
   assert(SPA->isValid());
@@ -83,6 +83,7 @@
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/BitDataflow.h"
 #include "swift/SILOptimizer/Utils/CFG.h"
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "swift/SILOptimizer/Utils/LoadStoreOptUtils.h"
@@ -174,13 +175,15 @@ namespace {
 /// behavior or alias query we need to do in worst case is roughly linear to
 /// # of BBs x(times) # of locations.
 ///
-/// we could run RLE on functions with 128 basic blocks and 128 locations,
-/// which is a large function.  
-constexpr unsigned MaxLSLocationBBMultiplicationNone = 128*128;
+/// we could run RLE on functions with 256 basic blocks and 256 locations,
+/// which is a large function.
+constexpr unsigned MaxLSLocationBBMultiplicationNone = 256*256;
 
-/// we could run optimistic RLE on functions with less than 64 basic blocks
-/// and 64 locations which is a sizeable function.
-constexpr unsigned MaxLSLocationBBMultiplicationPessimistic = 64*64;
+/// we could run optimistic RLE on functions with less than 128 basic blocks
+/// and 128 locations which is a sizeable function. The iterative data flow
+/// operates on whole words of the bit vectors, so this is bounded by the
+/// cost of computing the genset and killset.
+constexpr unsigned MaxLSLocationBBMultiplicationPessimistic = 128*128;
 
 /// forward declaration.
 class RLEContext;
@@ -205,27 +208,27 @@ private:
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the location currently has an
   /// downward visible value at the beginning of the basic block.
-  llvm::SmallBitVector ForwardSetIn;
+  llvm::BitVector ForwardSetIn;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the location currently has an
   /// downward visible value at the end of the basic block.
-  llvm::SmallBitVector ForwardSetOut;
+  llvm::BitVector ForwardSetOut;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If we ignore all unknown write, what's the maximum set
   /// of available locations at the current position in the basic block.
-  llvm::SmallBitVector ForwardSetMax;
+  llvm::BitVector ForwardSetMax;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the basic block generates a
   /// value for the location.
-  llvm::SmallBitVector BBGenSet;
+  llvm::BitVector BBGenSet;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the basic block kills the
   /// value for the location.
-  llvm::SmallBitVector BBKillSet;
+  llvm::BitVector BBKillSet;
 
   /// This is map between LSLocations and their available values at the
   /// beginning of this basic block.
@@ -273,9 +276,9 @@ private:
                     SILValue Val, RLEKind Kind);
 
   /// BitVector manipulation functions.
-  void startTrackingLocation(llvm::SmallBitVector &BV, unsigned B);
-  void stopTrackingLocation(llvm::SmallBitVector &BV, unsigned B);
-  bool isTrackingLocation(llvm::SmallBitVector &BV, unsigned B);
+  void startTrackingLocation(llvm::BitVector &BV, unsigned B);
+  void stopTrackingLocation(llvm::BitVector &BV, unsigned B);
+  bool isTrackingLocation(llvm::BitVector &BV, unsigned B);
   void startTrackingValue(ValueTableMap &VM, unsigned L, unsigned V);
   void stopTrackingValue(ValueTableMap &VM, unsigned B);
 
@@ -321,10 +324,6 @@ public:
   /// predecessors' AvailSetMax.
   void mergePredecessorsAvailSetMax(RLEContext &Ctx);
 
-  /// Initialize the AvailSet by intersecting this basic block' predecessors'
-  /// AvailSet.
-  void mergePredecessorAvailSet(RLEContext &Ctx);
-
   /// Initialize the AvailSet and AvailVal of the current basic block.
   void mergePredecessorAvailSetAndValue(RLEContext &Ctx);
 
@@ -372,9 +371,11 @@ public:
                                   RLEKind Kind);
   void processBasicBlockWithKind(RLEContext &Ctx, RLEKind Kind);
 
-  /// Process the current basic block with the genset and killset. Return true
-  /// if the ForwardSetOut changes.
-  bool processBasicBlockWithGenKillSet();
+  /// Returns the sets of this basic block for the iterative data flow with
+  /// the genset and killset.
+  BitDataflow::BlockSets getDataflowSets() {
+    return {ForwardSetIn, ForwardSetOut, BBGenSet, BBKillSet, nullptr};
+  }
 
   /// Set up the value for redundant load elimination.
   bool setupRLE(RLEContext &Ctx, SILInstruction *I, SILValue Mem);
@@ -556,15 +557,15 @@ void BlockState::stopTrackingValue(ValueTableMap &VM, unsigned B) {
   VM.erase(B);
 }
  
-bool BlockState::isTrackingLocation(llvm::SmallBitVector &BV, unsigned B) {
+bool BlockState::isTrackingLocation(llvm::BitVector &BV, unsigned B) {
   return BV.test(B);
 }
  
-void BlockState::startTrackingLocation(llvm::SmallBitVector &BV, unsigned B) {
+void BlockState::startTrackingLocation(llvm::BitVector &BV, unsigned B) {
   BV.set(B);
 }
  
-void BlockState::stopTrackingLocation(llvm::SmallBitVector &BV, unsigned B) {
+void BlockState::stopTrackingLocation(llvm::BitVector &BV, unsigned B) {
   BV.reset(B);
 }
 
@@ -582,21 +583,6 @@ void BlockState::mergePredecessorsAvailSetMax(RLEContext &Ctx) {
   }
 }
 
-void BlockState::mergePredecessorAvailSet(RLEContext &Ctx) {
-  // Clear the state if the basic block has no predecessor.
-  if (BB->getPreds().begin() == BB->getPreds().end()) {
-    ForwardSetIn.reset();
-    return;
-  }
-
-  auto Iter = BB->pred_begin();
-  ForwardSetIn = Ctx.getBlockState(*Iter).ForwardSetOut;
-  Iter = std::next(Iter);
-  for (auto EndIter = BB->pred_end(); Iter != EndIter; ++Iter) {
-    ForwardSetIn &= Ctx.getBlockState(*Iter).ForwardSetOut;
-  }
-}
-
 void BlockState::mergePredecessorAvailSetAndValue(RLEContext &Ctx) {
   // Clear the state if the basic block has no predecessor.
   if (BB->getPreds().begin() == BB->getPreds().end()) {
@@ -636,12 +622,6 @@ void BlockState::processBasicBlockWithKind(RLEContext &Ctx, RLEKind Kind) {
   }
 }
 
-bool BlockState::processBasicBlockWithGenKillSet() {
-  ForwardSetIn.reset(BBKillSet);
-  ForwardSetIn |= BBGenSet;
-  return updateForwardSetOut();
-}
-
 SILValue BlockState::reduceValuesAtEndOfBlock(RLEContext &Ctx, LSLocation &L) {
   // First, collect current available locations and their corresponding values
   // into a map.
@@ -1333,34 +1313,11 @@ void RLEContext::processBasicBlocksWithGenKillSet() {
   // Process each basic block with the gen and kill set. Every time the
   // ForwardSetOut of a basic block changes, the optimization is rerun on its
   // successors.
-  llvm::SmallVector<SILBasicBlock *, 16> WorkList;
-  llvm::DenseSet<SILBasicBlock *> HandledBBs;
-
-  // Push into the worklist in post order so that we can pop from the back and
-  // get reverse post order.
-  for (SILBasicBlock *BB : PO->getPostOrder()) {
-    WorkList.push_back(BB);
-    HandledBBs.insert(BB);
-  }
-  while (!WorkList.empty()) {
-    SILBasicBlock *BB = WorkList.pop_back_val();
-    HandledBBs.erase(BB);
-
-    // Intersection.
-    BlockState &Forwarder = getBlockState(BB);
-    // Compute the ForwardSetIn at the beginning of the basic block.
-    Forwarder.mergePredecessorAvailSet(*this);
-
-    if (Forwarder.processBasicBlockWithGenKillSet()) {
-      for (auto &X : BB->getSuccessors()) {
-        // We do not push basic block into the worklist if its already
-        // in the worklist.
-        if (HandledBBs.find(X) != HandledBBs.end())
-          continue;
-        WorkList.push_back(X);
-      }
-    }
-  }
+  BitDataflow Dataflow(PO, BitDataflow::Direction::Forward,
+                       [&](SILBasicBlock *BB) {
+                         return getBlockState(BB).getDataflowSets();
+                       });
+  Dataflow.solve();
 }
 
 void RLEContext::processBasicBlocksForAvailValue() {
@@ -46,6 +46,9 @@ STATISTIC(NumAllocStackFound,    "Number of AllocStack found");
 STATISTIC(NumAllocStackCaptured, "Number of AllocStack captured");
 STATISTIC(NumInstRemoved,        "Number of Instructions removed");
 STATISTIC(NumPhiPlaced,          "Number of Phi blocks placed");
+STATISTIC(NumAllocStackPromoted, "Number of AllocStack promoted to registers");
+STATISTIC(NumEnumDataAccessesRewritten,
+          "Number of enum payload accesses rewritten to whole-enum values");
 
 namespace {
 
@@ -198,11 +201,154 @@ static bool isAddressForLoad(SILInstruction *I, SILBasicBlock *&singleBlock) {
   return true;
 }
 
+/// Returns true if the payload of \p Element can be accessed through the
+/// whole enum value, i.e. it is not stored in a box.
+static bool isDirectPayloadCase(EnumElementDecl *Element) {
+  return !Element->isIndirect() && !Element->getParentEnum()->isIndirect();
+}
+
+/// Returns the store which initializes the payload of the enum that \p IEAI
+/// injects a case with a payload into.
+///
+/// The store must be the only use of an init_enum_data_addr of the same case,
+/// and precede \p IEAI in its block without any other access to the enum in
+/// between. Returns null otherwise.
+static StoreInst *getPayloadStore(InjectEnumAddrInst *IEAI) {
+  SILValue Enum = IEAI->getOperand();
+  for (auto I = IEAI->getIterator(), B = IEAI->getParent()->begin();
+       I != B;) {
+    SILInstruction *Inst = &*--I;
+    for (auto &Op : Inst->getAllOperands()) {
+      if (Op.get() == Enum)
+        return nullptr;
+      auto *Data = dyn_cast<InitEnumDataAddrInst>(Op.get());
+      if (!Data || Data->getOperand() != Enum)
+        continue;
+
+      auto *SI = dyn_cast<StoreInst>(Inst);
+      if (!SI || SI->getDest() != Data || !Data->hasOneUse() ||
+          Data->getElement() != IEAI->getElement())
+        return nullptr;
+      return SI;
+    }
+  }
+  return nullptr;
+}
+
+/// Returns true if \p I accesses the payload of the loadable enum in \p ASI in
+/// a way that rewriteEnumDataAccesses can turn into loads and stores of the
+/// whole enum. Counts the payloads that are initialized and injected in
+/// \p NumInits and \p NumInjects. Sets \p singleBlock to null if \p I or the
+/// loads of the payload are not in \p singleBlock.
+static bool isEnumDataAccess(SILInstruction *I, AllocStackInst *ASI,
+                             SILBasicBlock *&singleBlock, unsigned &NumInits,
+                             unsigned &NumInjects) {
+  if (!ASI->getElementType().getEnumOrBoundGenericEnum() ||
+      !ASI->getElementType().isLoadable(ASI->getModule()))
+    return false;
+
+  // The payload is initialized by a single store, which is paired with an
+  // inject_enum_addr by getPayloadStore.
+  if (auto *IEDAI = dyn_cast<InitEnumDataAddrInst>(I)) {
+    if (!isDirectPayloadCase(IEDAI->getElement()) || !IEDAI->hasOneUse())
+      return false;
+    auto *SI = dyn_cast<StoreInst>(IEDAI->use_begin()->getUser());
+    if (!SI || SI->getDest() != IEDAI)
+      return false;
+    ++NumInits;
+    return true;
+  }
+
+  if (auto *IEAI = dyn_cast<InjectEnumAddrInst>(I)) {
+    if (!IEAI->getElement()->hasArgumentType())
+      return true;
+    if (!isDirectPayloadCase(IEAI->getElement()) || !getPayloadStore(IEAI))
+      return false;
+    ++NumInjects;
+    return true;
+  }
+
+  // The payload is only loaded.
+  if (auto *UTEDAI = dyn_cast<UncheckedTakeEnumDataAddrInst>(I)) {
+    if (!isDirectPayloadCase(UTEDAI->getElement()))
+      return false;
+    for (auto *Use : UTEDAI->getUses()) {
+      if (!isa<LoadInst>(Use->getUser()))
+        return false;
+      if (Use->getUser()->getParent() != singleBlock)
+        singleBlock = nullptr;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+/// Rewrites the accesses to the enum payload in \p ASI, which have been
+/// checked by isEnumDataAccess, into loads and stores of the whole enum:
+///
+///   %d = init_enum_data_addr %ASI, #E.c       %e = enum $E, #E.c, %v
+///   store %v to %d                       =>   store %e to %ASI
+///   inject_enum_addr %ASI, #E.c
+///
+///   %d = unchecked_take_enum_data_addr %ASI   %e = load %ASI
+///   %v = load %d                         =>   %v = unchecked_enum_data %e
+static void rewriteEnumDataAccesses(AllocStackInst *ASI) {
+  SmallVector<InjectEnumAddrInst *, 4> Injects;
+  SmallVector<UncheckedTakeEnumDataAddrInst *, 4> Takes;
+  for (auto *Use : ASI->getUses()) {
+    if (auto *IEAI = dyn_cast<InjectEnumAddrInst>(Use->getUser()))
+      Injects.push_back(IEAI);
+    else if (auto *UTEDAI =
+                 dyn_cast<UncheckedTakeEnumDataAddrInst>(Use->getUser()))
+      Takes.push_back(UTEDAI);
+  }
+
+  SILType EnumType = ASI->getElementType();
+  for (auto *IEAI : Injects) {
+    SILBuilderWithScope B(IEAI);
+    SILValue Payload;
+    StoreInst *SI = nullptr;
+    if (IEAI->getElement()->hasArgumentType()) {
+      SI = getPayloadStore(IEAI);
+      Payload = SI->getSrc();
+    }
+    auto *EI = B.createEnum(IEAI->getLoc(), Payload, IEAI->getElement(),
+                            EnumType);
+    B.createStore(IEAI->getLoc(), EI, ASI);
+    IEAI->eraseFromParent();
+    if (SI) {
+      auto *IEDAI = cast<InitEnumDataAddrInst>(SI->getDest());
+      SI->eraseFromParent();
+      IEDAI->eraseFromParent();
+    }
+    ++NumEnumDataAccessesRewritten;
+  }
+
+  for (auto *UTEDAI : Takes) {
+    while (!UTEDAI->use_empty()) {
+      auto *LI = cast<LoadInst>(UTEDAI->use_begin()->getUser());
+      SILBuilderWithScope B(LI);
+      auto *EnumVal = B.createLoad(LI->getLoc(), ASI);
+      auto *Data = B.createUncheckedEnumData(LI->getLoc(), EnumVal,
+                                             UTEDAI->getElement(),
+                                             LI->getType());
+      LI->replaceAllUsesWith(Data);
+      LI->eraseFromParent();
+    }
+    UTEDAI->eraseFromParent();
+    ++NumEnumDataAccessesRewritten;
+  }
+}
+
 /// Returns true if this AllocStacks is captured.
 /// Sets \p inSingleBlock to true if all uses of \p ASI are in a single block.
 static bool isCaptured(AllocStackInst *ASI, bool &inSingleBlock) {
   
   SILBasicBlock *singleBlock = ASI->getParent();
+
+  // Every payload that is initialized must be injected.
+  unsigned NumInits = 0, NumInjects = 0;
   
   // For all users of the AllocStack instruction.
   for (auto UI = ASI->use_begin(), E = ASI->use_end(); UI != E; ++UI) {
@@ -215,6 +361,11 @@ static bool isCaptured(AllocStackInst *ASI, bool &inSingleBlock) {
     if (isAddressForLoad(II, singleBlock))
       continue;
 
+    // So are accesses to the payload of an enum, which are rewritten into
+    // loads and stores.
+    if (isEnumDataAccess(II, ASI, singleBlock, NumInits, NumInjects))
+      continue;
+
     // We can store into an AllocStack (but not the pointer).
     if (StoreInst *SI = dyn_cast<StoreInst>(II))
       if (SI->getDest() == ASI)
@@ -236,6 +387,12 @@ static bool isCaptured(AllocStackInst *ASI, bool &inSingleBlock) {
     return true;
   }
 
+  if (NumInits != NumInjects) {
+    DEBUG(llvm::dbgs() << "*** AllocStack has an enum payload which is not "
+                          "injected: " << *ASI);
+    return true;
+  }
+
   // None of the users capture the AllocStack.
   inSingleBlock = (singleBlock != nullptr);
   return false;
@@ -842,6 +999,8 @@ bool MemoryToRegisters::run() {
         continue;
       }
 
+      rewriteEnumDataAccesses(ASI);
+
       // Remove write-only AllocStacks.
       if (isWriteOnlyAllocation(ASI)) {
         eraseUsesOfInstruction(ASI);
@@ -864,6 +1023,7 @@ bool MemoryToRegisters::run() {
         I++;
         ASI->eraseFromParent();
         NumInstRemoved++;
+        NumAllocStackPromoted++;
         Changed = true;
         continue;
       }
@@ -882,6 +1042,7 @@ bool MemoryToRegisters::run() {
       I++;
       ASI->eraseFromParent();
       NumInstRemoved++;
+      NumAllocStackPromoted++;
       Changed = true;
     }
   }
@@ -0,0 +1,850 @@
+//===--- SequenceFusion.cpp - Fuse chains of eager map and filter ---------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Chains like `a.map(f).map(g)` and `a.filter(p).filter(q)` build an
+// intermediate array that nothing but the next call reads. This pass rewrites
+// such a pair into one call whose closure composes the two, as if the user had
+// written `a.map { g(f($0)) }` or `a.filter { p($0) && q($0) }`, so that the
+// elements are visited once and the intermediate array is never allocated.
+//
+// The calls are recognized by the "sequence.map" and "sequence.filter"
+// semantics attributes of the default implementations in the standard
+// library. The pass runs before generic specialization, so the calls still
+// have their substitutions and a fused map can be called with a different
+// result type.
+//
+// The fused call runs the two closures interleaved instead of one after the
+// other, so both of them must be free of side effects that the other one, or
+// the code between the two calls, could observe.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "sequence-fusion"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/AST/Mangle.h"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SILOptimizer/Analysis/RCIdentityAnalysis.h"
+#include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/CFG.h"
+#include "swift/SILOptimizer/Utils/Local.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+STATISTIC(NumMapsFused, "Number of map calls fused with a preceding map");
+STATISTIC(NumFiltersFused,
+          "Number of filter calls fused with a preceding filter");
+
+using namespace swift;
+
+namespace {
+
+enum class SequenceOpKind { None, Map, Filter };
+
+/// Returns the kind of the eager sequence operation that \p AI calls.
+///
+/// Both operations are methods which take a closure and self and return a new
+/// array directly; anything else is left alone.
+static SequenceOpKind getSequenceOpKind(FullApplySite AI) {
+  SILFunction *Callee = AI.getReferencedFunction();
+  if (!Callee)
+    return SequenceOpKind::None;
+
+  SequenceOpKind Kind;
+  if (Callee->hasSemanticsAttr("sequence.map"))
+    Kind = SequenceOpKind::Map;
+  else if (Callee->hasSemanticsAttr("sequence.filter"))
+    Kind = SequenceOpKind::Filter;
+  else
+    return SequenceOpKind::None;
+
+  auto FnTy = AI.getSubstCalleeType();
+  if (AI.getArguments().size() != 2 || FnTy->getNumIndirectResults() != 0 ||
+      FnTy->getRepresentation() != SILFunctionTypeRepresentation::Method)
+    return SequenceOpKind::None;
+
+  auto ClosureTy = FnTy->getParameters()[0].getSILType()
+                       .getAs<SILFunctionType>();
+  if (!ClosureTy || !ClosureTy->isCalleeConsumed() ||
+      !ClosureTy->hasErrorResult())
+    return SequenceOpKind::None;
+
+  return Kind;
+}
+
+/// Turns a try_apply of a sequence operation whose error block is unreachable,
+/// which is how SILGen calls a rethrowing function with a closure that
+/// doesn't throw, into an apply, and merges the normal block into the
+/// current one.
+static bool convertNonThrowingTryApply(TryApplyInst *TAI) {
+  SILBasicBlock *ErrorBB = TAI->getErrorBB();
+  if (!isa<UnreachableInst>(&*ErrorBB->begin()))
+    return false;
+
+  SILBuilderWithScope Builder(TAI);
+  SmallVector<SILValue, 2> Args(TAI->getArguments().begin(),
+                                TAI->getArguments().end());
+  auto *AI = Builder.createApply(TAI->getLoc(), TAI->getCallee(),
+                                 TAI->getSubstCalleeSILType(),
+                                 TAI->getSubstCalleeType()->getSILResult(),
+                                 TAI->getSubstitutions(), Args,
+                                 /*isNonThrowing*/ true);
+  Builder.createBranch(TAI->getLoc(), TAI->getNormalBB(), {SILValue(AI)});
+  TAI->eraseFromParent();
+
+  if (ErrorBB->pred_empty())
+    removeDeadBlock(ErrorBB);
+  mergeBasicBlockWithSuccessor(AI->getParent(), nullptr, nullptr);
+  return true;
+}
+
+/// Returns true if calling the closure \p Closure can't have side effects
+/// that another closure, or the code around the call, could observe.
+///
+/// Writes to the closure's indirect results and to arguments that it owns are
+/// fine; writes to anything else, including captured variables, and releases
+/// which might run a deinit are not. If \p ReadsGlobalMemory is set to true,
+/// the closure may also read memory not passed to it.
+static bool hasNoObservableEffects(SILValue Closure, SideEffectAnalysis *SEA,
+                                   bool &ReadsGlobalMemory) {
+  while (true) {
+    if (auto *CFI = dyn_cast<ConvertFunctionInst>(Closure))
+      Closure = CFI->getOperand();
+    else if (auto *TTTF = dyn_cast<ThinToThickFunctionInst>(Closure))
+      Closure = TTTF->getOperand();
+    else
+      break;
+  }
+
+  SILFunction *Fn = nullptr;
+  auto *PAI = dyn_cast<PartialApplyInst>(Closure);
+  if (PAI)
+    Fn = PAI->getReferencedFunction();
+  else if (auto *FRI = dyn_cast<FunctionRefInst>(Closure))
+    Fn = FRI->getReferencedFunction();
+  if (!Fn)
+    return false;
+
+  // A reabstraction thunk only forwards to the closure it captures.
+  if (PAI && Fn->isThunk() == IsReabstractionThunk) {
+    for (SILValue Captured : PAI->getArguments()) {
+      if (Captured->getType().is<SILFunctionType>() &&
+          !hasNoObservableEffects(Captured, SEA, ReadsGlobalMemory))
+        return false;
+    }
+    return true;
+  }
+
+  const auto &Effects = SEA->getEffects(Fn);
+  const auto &GlobalEffects = Effects.getGlobalEffects();
+  if (GlobalEffects.mayWrite() || GlobalEffects.mayRelease())
+    return false;
+  ReadsGlobalMemory |= GlobalEffects.mayRead();
+
+  auto FnTy = Fn->getLoweredFunctionType();
+  unsigned NumIndirectResults = FnTy->getNumIndirectResults();
+  auto ParamEffects = Effects.getParameterEffects();
+  for (unsigned i = 0, e = ParamEffects.size(); i != e; ++i) {
+    if (!ParamEffects[i].mayWrite())
+      continue;
+    if (i < NumIndirectResults)
+      continue;
+    auto Params = FnTy->getParameters();
+    unsigned ParamIdx = i - NumIndirectResults;
+    if (ParamIdx < Params.size() &&
+        Params[ParamIdx].getConvention() == ParameterConvention::Indirect_In)
+      continue;
+    return false;
+  }
+  return true;
+}
+
+/// Builds the thunk which calls two closures in place of one.
+class FusedClosureBuilder {
+  SILModule &M;
+  SILLocation Loc;
+  IsFragile_t Fragile;
+
+  /// The type of the closure that the fused call expects.
+  CanSILFunctionType ClosureTy;
+  CanSILFunctionType FirstTy;
+  CanSILFunctionType SecondTy;
+
+  CanSILFunctionType getThunkType() const;
+  std::string getThunkName(SequenceOpKind Kind, CanSILFunctionType Ty) const;
+
+  bool canComposeTransforms() const;
+  bool canConjoinPredicates() const;
+
+  void emitComposedTransforms(SILBuilder &B, ArrayRef<SILArgument *> Args);
+  void emitConjoinedPredicates(SILBuilder &B, ArrayRef<SILArgument *> Args);
+
+public:
+  FusedClosureBuilder(SILFunction *Caller, CanSILFunctionType ClosureTy,
+                      SILValue First, SILValue Second)
+      : M(Caller->getModule()),
+        Loc(RegularLocation::getAutoGeneratedLocation()),
+        Fragile(Caller->isFragile()), ClosureTy(ClosureTy),
+        FirstTy(First->getType().castTo<SILFunctionType>()),
+        SecondTy(Second->getType().castTo<SILFunctionType>()) {}
+
+  /// Returns true if the closures have conventions that the thunk handles and
+  /// their types fit together.
+  bool canFuse(SequenceOpKind Kind) const;
+
+  /// Returns the thunk, which takes the closure's arguments followed by the
+  /// two closures.
+  SILFunction *getOrCreateThunk(SequenceOpKind Kind);
+};
+
+} // end anonymous namespace
+
+bool FusedClosureBuilder::canFuse(SequenceOpKind Kind) const {
+  // The thunk would need a generic signature of its own.
+  if (ClosureTy->hasArchetype() || FirstTy->hasArchetype() ||
+      SecondTy->hasArchetype())
+    return false;
+
+  for (auto Ty : {ClosureTy, FirstTy, SecondTy}) {
+    if (!Ty->isCalleeConsumed() || !Ty->hasErrorResult() ||
+        Ty->getAllResults().size() != 1)
+      return false;
+  }
+
+  if (Kind == SequenceOpKind::Map)
+    return canComposeTransforms();
+  return canConjoinPredicates();
+}
+
+/// A fused map calls the first transform with the closure's arguments and
+/// passes its result to the second, which returns the closure's result.
+bool FusedClosureBuilder::canComposeTransforms() const {
+  if (ClosureTy->getParameters() != FirstTy->getParameters() ||
+      ClosureTy->getAllResults() != SecondTy->getAllResults() ||
+      SecondTy->getParameters().size() != 1)
+    return false;
+
+  SILResultInfo Intermediate = FirstTy->getSingleResult();
+  SILParameterInfo SecondParam = SecondTy->getParameters()[0];
+  if (Intermediate.getType() != SecondParam.getType())
+    return false;
+
+  // Either the intermediate value is passed in memory...
+  if (Intermediate.isIndirect())
+    return SecondParam.getConvention() == ParameterConvention::Indirect_In;
+
+  // ...or it is passed directly, at +1.
+  if (SecondParam.getConvention() != ParameterConvention::Direct_Owned)
+    return false;
+  if (Intermediate.getConvention() == ResultConvention::Owned)
+    return true;
+  return Intermediate.getConvention() == ResultConvention::Unowned &&
+         M.Types.getTypeLowering(Intermediate.getSILType()).isTrivial();
+}
+
+/// A fused filter calls the second predicate only for elements that the first
+/// one accepts.
+bool FusedClosureBuilder::canConjoinPredicates() const {
+  if (ClosureTy->getParameters() != FirstTy->getParameters() ||
+      ClosureTy->getParameters() != SecondTy->getParameters() ||
+      ClosureTy->getAllResults() != FirstTy->getAllResults() ||
+      ClosureTy->getAllResults() != SecondTy->getAllResults() ||
+      ClosureTy->getParameters().size() != 1)
+    return false;
+
+  SILResultInfo Result = ClosureTy->getSingleResult();
+  if (Result.isIndirect() ||
+      Result.getType()->getAnyNominal() != M.getASTContext().getBoolDecl())
+    return false;
+
+  switch (ClosureTy->getParameters()[0].getConvention()) {
+  case ParameterConvention::Indirect_In:
+  case ParameterConvention::Indirect_In_Guaranteed:
+  case ParameterConvention::Direct_Owned:
+  case ParameterConvention::Direct_Unowned:
+  case ParameterConvention::Direct_Guaranteed:
+    return true;
+  case ParameterConvention::Indirect_Inout:
+  case ParameterConvention::Indirect_InoutAliasable:
+  case ParameterConvention::Direct_Deallocating:
+    return false;
+  }
+  llvm_unreachable("Unhandled ParameterConvention");
+}
+
+CanSILFunctionType FusedClosureBuilder::getThunkType() const {
+  SmallVector<SILParameterInfo, 4> Params(ClosureTy->getParameters().begin(),
+                                          ClosureTy->getParameters().end());
+  Params.push_back(SILParameterInfo(FirstTy, ParameterConvention::Direct_Owned));
+  Params.push_back(SILParameterInfo(SecondTy,
+                                    ParameterConvention::Direct_Owned));
+
+  auto ExtInfo = ClosureTy->getExtInfo().withRepresentation(
+      SILFunctionTypeRepresentation::Thin);
+  return SILFunctionType::get(nullptr, ExtInfo,
+                              ParameterConvention::Direct_Unowned, Params,
+                              ClosureTy->getAllResults(),
+                              ClosureTy->getOptionalErrorResult(),
+                              M.getASTContext());
+}
+
+std::string FusedClosureBuilder::getThunkName(SequenceOpKind Kind,
+                                              CanSILFunctionType Ty) const {
+  Mangle::Mangler Mangler;
+  Mangler.append("_TTSq");
+  Mangler.append(Kind == SequenceOpKind::Map ? "map" : "filter");
+  Mangler.append(Fragile ? "q" : "");
+  Mangler.append("_");
+  Mangler.mangleType(Ty, 0);
+  return Mangler.finalize();
+}
+
+SILFunction *FusedClosureBuilder::getOrCreateThunk(SequenceOpKind Kind) {
+  CanSILFunctionType ThunkTy = getThunkType();
+  SILFunction *Thunk = M.getOrCreateSharedFunction(
+      Loc, getThunkName(Kind, ThunkTy), ThunkTy, IsBare, IsNotTransparent,
+      Fragile, IsThunk);
+
+  // Re-use an existing thunk.
+  if (!Thunk->empty())
+    return Thunk;
+
+  SILBasicBlock *EntryBB = new (M) SILBasicBlock(Thunk);
+  SmallVector<SILArgument *, 4> Args;
+  for (unsigned i = 0, e = ThunkTy->getNumSILArguments(); i != e; ++i)
+    Args.push_back(new (M) SILArgument(EntryBB,
+                                       ThunkTy->getSILArgumentType(i)));
+
+  SILBuilder B(EntryBB);
+  if (Kind == SequenceOpKind::Map)
+    emitComposedTransforms(B, Args);
+  else
+    emitConjoinedPredicates(B, Args);
+  return Thunk;
+}
+
+/// Emits:
+///
+///   bb0(%results..., %args..., %first, %second):
+///     %tmp = alloc_stack $T                     // if T is passed in memory
+///     try_apply %first(%tmp, %args...), normal bb1, error bb3
+///   bb1(%t):
+///     try_apply %second(%results..., %tmp or %t), normal bb2, error bb4
+///   bb2(%u):
+///     dealloc_stack %tmp
+///     return %u
+///   bb3(%error):
+///     strong_release %second
+///     dealloc_stack %tmp
+///     throw %error
+///   bb4(%error):
+///     dealloc_stack %tmp
+///     throw %error
+void FusedClosureBuilder::emitComposedTransforms(
+    SILBuilder &B, ArrayRef<SILArgument *> Args) {
+  SILFunction *Thunk = B.getInsertionBB()->getParent();
+  unsigned NumResults = ClosureTy->getNumIndirectResults();
+  SILValue First = Args[Args.size() - 2];
+  SILValue Second = Args[Args.size() - 1];
+  auto ForwardedArgs = Args.slice(NumResults, Args.size() - 2 - NumResults);
+  SILType ErrorTy = SILType::getPrimitiveObjectType(
+      ClosureTy->getErrorResult().getType());
+
+  SILResultInfo Intermediate = FirstTy->getSingleResult();
+  AllocStackInst *Tmp = nullptr;
+  SmallVector<SILValue, 4> FirstArgs;
+  if (Intermediate.isIndirect()) {
+    Tmp = B.createAllocStack(
+        Loc, SILType::getPrimitiveObjectType(Intermediate.getType()));
+    FirstArgs.push_back(Tmp);
+  }
+  FirstArgs.append(ForwardedArgs.begin(), ForwardedArgs.end());
+
+  auto *FirstNormalBB = new (M) SILBasicBlock(Thunk);
+  auto *FirstResult = new (M) SILArgument(FirstNormalBB,
+                                          FirstTy->getSILResult());
+  auto *FirstErrorBB = new (M) SILBasicBlock(Thunk);
+  auto *FirstError = new (M) SILArgument(FirstErrorBB, ErrorTy);
+  B.createTryApply(Loc, First, First->getType(), {}, FirstArgs, FirstNormalBB,
+                   FirstErrorBB);
+
+  B.setInsertionPoint(FirstErrorBB);
+  B.createStrongRelease(Loc, Second, Atomicity::Atomic);
+  if (Tmp)
+    B.createDeallocStack(Loc, Tmp);
+  B.createThrow(Loc, FirstError);
+
+  B.setInsertionPoint(FirstNormalBB);
+  SmallVector<SILValue, 4> SecondArgs(Args.begin(), Args.begin() + NumResults);
+  SecondArgs.push_back(Tmp ? SILValue(Tmp) : SILValue(FirstResult));
+
+  auto *SecondNormalBB = new (M) SILBasicBlock(Thunk);
+  auto *SecondResult = new (M) SILArgument(SecondNormalBB,
+                                           SecondTy->getSILResult());
+  auto *SecondErrorBB = new (M) SILBasicBlock(Thunk);
+  auto *SecondError = new (M) SILArgument(SecondErrorBB, ErrorTy);
+  B.createTryApply(Loc, Second, Second->getType(), {}, SecondArgs,
+                   SecondNormalBB, SecondErrorBB);
+
+  B.setInsertionPoint(SecondErrorBB);
+  if (Tmp)
+    B.createDeallocStack(Loc, Tmp);
+  B.createThrow(Loc, SecondError);
+
+  B.setInsertionPoint(SecondNormalBB);
+  if (Tmp)
+    B.createDeallocStack(Loc, Tmp);
+  B.createReturn(Loc, SecondResult);
+}
+
+/// Emits:
+///
+///   bb0(%x, %first, %second):
+///     // Give the first predicate its own copy of %x if it consumes it.
+///     try_apply %first(%x'), normal bb1, error bb4
+///   bb1(%b : $Bool):
+///     %bit = struct_extract %b, #Bool._value
+///     cond_br %bit, bb2, bb3
+///   bb2:
+///     try_apply %second(%x), normal bb5, error bb6
+///   bb3:
+///     strong_release %second
+///     // Destroy %x if it was passed at +1.
+///     br bb5(%b)
+///   bb4(%error):
+///     strong_release %second
+///     // Destroy %x if it was passed at +1.
+///     throw %error
+///   bb5(%result : $Bool):
+///     return %result
+///   bb6(%error):
+///     throw %error
+void FusedClosureBuilder::emitConjoinedPredicates(
+    SILBuilder &B, ArrayRef<SILArgument *> Args) {
+  SILFunction *Thunk = B.getInsertionBB()->getParent();
+  SILValue Element = Args[0];
+  SILValue First = Args[1];
+  SILValue Second = Args[2];
+  SILType BoolTy = ClosureTy->getSILResult();
+  SILType ErrorTy = SILType::getPrimitiveObjectType(
+      ClosureTy->getErrorResult().getType());
+  ParameterConvention Convention =
+      ClosureTy->getParameters()[0].getConvention();
+
+  // Both predicates need the element, so the first can't consume it.
+  AllocStackInst *Copy = nullptr;
+  SILValue FirstArg = Element;
+  switch (Convention) {
+  case ParameterConvention::Indirect_In:
+    Copy = B.createAllocStack(Loc, Element->getType().getObjectType());
+    B.createCopyAddr(Loc, Element, Copy, IsNotTake, IsInitialization);
+    FirstArg = Copy;
+    break;
+  case ParameterConvention::Direct_Owned:
+    B.createRetainValue(Loc, Element, Atomicity::Atomic);
+    break;
+  default:
+    break;
+  }
+
+  // Destroys the element when the second predicate isn't called.
+  auto emitDestroyElement = [&]() {
+    if (Convention == ParameterConvention::Indirect_In)
+      B.createDestroyAddr(Loc, Element);
+    else if (Convention == ParameterConvention::Direct_Owned)
+      B.createReleaseValue(Loc, Element, Atomicity::Atomic);
+  };
+
+  auto *FirstNormalBB = new (M) SILBasicBlock(Thunk);
+  auto *FirstResult = new (M) SILArgument(FirstNormalBB, BoolTy);
+  auto *FirstErrorBB = new (M) SILBasicBlock(Thunk);
+  auto *FirstError = new (M) SILArgument(FirstErrorBB, ErrorTy);
+  B.createTryApply(Loc, First, First->getType(), {}, {FirstArg},
+                   FirstNormalBB, FirstErrorBB);
+
+  auto *ReturnBB = new (M) SILBasicBlock(Thunk);
+  auto *Result = new (M) SILArgument(ReturnBB, BoolTy);
+
+  B.setInsertionPoint(FirstErrorBB);
+  if (Copy)
+    B.createDeallocStack(Loc, Copy);
+  B.createStrongRelease(Loc, Second, Atomicity::Atomic);
+  emitDestroyElement();
+  B.createThrow(Loc, FirstError);
+
+  B.setInsertionPoint(FirstNormalBB);
+  if (Copy)
+    B.createDeallocStack(Loc, Copy);
+  auto *BoolDecl = cast<StructDecl>(M.getASTContext().getBoolDecl());
+  VarDecl *BitField = *BoolDecl->getStoredProperties().begin();
+  SILValue Bit = B.createStructExtract(Loc, FirstResult, BitField);
+  auto *AcceptedBB = new (M) SILBasicBlock(Thunk);
+  auto *RejectedBB = new (M) SILBasicBlock(Thunk);
+  B.createCondBranch(Loc, Bit, AcceptedBB, RejectedBB);
+
+  B.setInsertionPoint(RejectedBB);
+  B.createStrongRelease(Loc, Second, Atomicity::Atomic);
+  emitDestroyElement();
+  B.createBranch(Loc, ReturnBB, {SILValue(FirstResult)});
+
+  B.setInsertionPoint(AcceptedBB);
+  auto *SecondErrorBB = new (M) SILBasicBlock(Thunk);
+  auto *SecondError = new (M) SILArgument(SecondErrorBB, ErrorTy);
+  B.createTryApply(Loc, Second, Second->getType(), {}, {Element}, ReturnBB,
+                   SecondErrorBB);
+
+  B.setInsertionPoint(SecondErrorBB);
+  B.createThrow(Loc, SecondError);
+
+  B.setInsertionPoint(ReturnBB);
+  B.createReturn(Loc, Result);
+}
+
+namespace {
+
+/// Fuses one pair of sequence operations, the second of which operates on
+/// the result of the first.
+class SequenceOpFuser {
+  SideEffectAnalysis *SEA;
+  RCIdentityFunctionInfo *RCFI;
+
+  ApplyInst *First;
+  ApplyInst *Second;
+  SequenceOpKind Kind;
+
+  /// The instructions that only pass the intermediate array from the first
+  /// call to the second.
+  llvm::SmallSetVector<SILInstruction *, 8> Intermediate;
+
+  /// Releases of the first call's operands which are between the two calls
+  /// and have to be moved after the fused call.
+  SmallVector<SILInstruction *, 4> Deferred;
+
+  bool collectIntermediateUses(ValueBase *Def);
+  bool collectTemporaryUses(AllocStackInst *ASI);
+  bool canMoveAcrossCode(bool ClosuresReadGlobalMemory);
+  bool getFusedSubstitutions(SmallVectorImpl<Substitution> &Subs);
+
+public:
+  SequenceOpFuser(SideEffectAnalysis *SEA, RCIdentityFunctionInfo *RCFI,
+                  ApplyInst *First, ApplyInst *Second, SequenceOpKind Kind)
+      : SEA(SEA), RCFI(RCFI), First(First), Second(Second), Kind(Kind) {}
+
+  /// Replaces both calls with a single one, and returns it, or returns null
+  /// if they can't be fused.
+  ApplyInst *fuse();
+};
+
+} // end anonymous namespace
+
+/// The intermediate array may be retained, released and passed to the second
+/// call, directly or through a temporary, and nothing else.
+bool SequenceOpFuser::collectIntermediateUses(ValueBase *Def) {
+  for (auto *Use : Def->getUses()) {
+    auto *User = Use->getUser();
+    if (User == Second)
+      continue;
+
+    if (isa<RefCountingInst>(User) || isa<DebugValueInst>(User)) {
+      Intermediate.insert(User);
+      continue;
+    }
+
+    if (isa<StructExtractInst>(User) || isa<TupleExtractInst>(User)) {
+      if (!collectIntermediateUses(User))
+        return false;
+      Intermediate.insert(User);
+      continue;
+    }
+
+    if (auto *SI = dyn_cast<StoreInst>(User)) {
+      auto *ASI = dyn_cast<AllocStackInst>(SI->getDest());
+      if (!ASI || SI->getSrc() != SILValue(Def) || !collectTemporaryUses(ASI))
+        return false;
+      continue;
+    }
+
+    return false;
+  }
+  return true;
+}
+
+bool SequenceOpFuser::collectTemporaryUses(AllocStackInst *ASI) {
+  for (auto *Use : ASI->getUses()) {
+    auto *User = Use->getUser();
+    if (User == Second)
+      continue;
+    if (isa<StoreInst>(User) || isa<DestroyAddrInst>(User) ||
+        isa<DeallocStackInst>(User) || isa<DebugValueAddrInst>(User)) {
+      Intermediate.insert(User);
+      continue;
+    }
+    return false;
+  }
+  Intermediate.insert(ASI);
+  return true;
+}
+
+/// The fused call happens where the second call was, so the work of the first
+/// call moves down across the code between the two. That code may create the
+/// second closure, pass the intermediate array along and release what the
+/// first call was done with, but not write memory.
+bool SequenceOpFuser::canMoveAcrossCode(bool ClosuresReadGlobalMemory) {
+  SILValue FirstSelf = First->getSelfArgument();
+  SILValue FirstSelfRoot = RCFI->getRCIdentityRoot(FirstSelf);
+  SILValue FirstClosureRoot = RCFI->getRCIdentityRoot(First->getArgument(0));
+
+  for (auto II = std::next(SILBasicBlock::iterator(First)),
+            IE = SILBasicBlock::iterator(Second);
+       II != IE; ++II) {
+    SILInstruction *I = &*II;
+    if (Intermediate.count(I))
+      continue;
+
+    // The first call's self and closure now have to live until the fused
+    // call.
+    if (isa<DestroyAddrInst>(I) || isa<DeallocStackInst>(I)) {
+      if (I->getOperand(0) != FirstSelf)
+        return false;
+      Deferred.push_back(I);
+      continue;
+    }
+    if (isa<StrongReleaseInst>(I) || isa<ReleaseValueInst>(I)) {
+      SILValue Root = RCFI->getRCIdentityRoot(I->getOperand(0));
+      if (Root == FirstSelfRoot || Root == FirstClosureRoot) {
+        Deferred.push_back(I);
+        continue;
+      }
+      // A release elsewhere might run a deinit, which only matters if the
+      // closures can see what it does.
+      if (ClosuresReadGlobalMemory)
+        return false;
+      continue;
+    }
+
+    if (isa<AllocStackInst>(I))
+      return false;
+
+    if (isa<FunctionRefInst>(I) || isa<ThinToThickFunctionInst>(I) ||
+        isa<ConvertFunctionInst>(I) || isa<PartialApplyInst>(I) ||
+        isa<StrongRetainInst>(I) || isa<RetainValueInst>(I) ||
+        isa<DebugValueInst>(I) || isa<DebugValueAddrInst>(I) ||
+        !I->mayHaveSideEffects())
+      continue;
+
+    return false;
+  }
+  return true;
+}
+
+/// A fused map has the first map's self and the second map's result type.
+///
+/// The result type is the innermost generic parameter of the method, and it
+/// comes last in the substitutions because it is unconstrained and has no
+/// associated types.
+bool SequenceOpFuser::getFusedSubstitutions(
+    SmallVectorImpl<Substitution> &Subs) {
+  auto FirstSubs = First->getSubstitutions();
+  Subs.append(FirstSubs.begin(), FirstSubs.end());
+  if (Kind == SequenceOpKind::Filter)
+    return true;
+
+  // A specialized map can't be called with another result type.
+  if (!First->hasSubstitutions() || !Second->hasSubstitutions())
+    return false;
+
+  auto *Sig = First->getOrigCalleeType()->getGenericSignature();
+  if (!Sig)
+    return false;
+  Type LastDependentType;
+  unsigned NumDependentTypes = 0;
+  for (Type DependentType : Sig->getAllDependentTypes()) {
+    LastDependentType = DependentType;
+    ++NumDependentTypes;
+  }
+  if (NumDependentTypes != Subs.size() ||
+      !LastDependentType->isEqual(Sig->getGenericParams().back()) ||
+      !Subs.back().getConformances().empty())
+    return false;
+
+  const Substitution &SecondResultSub = Second->getSubstitutions().back();
+  if (!SecondResultSub.getConformances().empty())
+    return false;
+  Subs.back() = Substitution(SecondResultSub.getReplacement(),
+                             SecondResultSub.getConformances());
+  return true;
+}
+
+ApplyInst *SequenceOpFuser::fuse() {
+  SILFunction *F = First->getFunction();
+  SILModule &M = F->getModule();
+  SILValue FirstClosure = First->getArgument(0);
+  SILValue SecondClosure = Second->getArgument(0);
+
+  if (!collectIntermediateUses(First))
+    return nullptr;
+
+  bool ReadsGlobalMemory = false;
+  if (!hasNoObservableEffects(FirstClosure, SEA, ReadsGlobalMemory) ||
+      !hasNoObservableEffects(SecondClosure, SEA, ReadsGlobalMemory))
+    return nullptr;
+
+  if (!canMoveAcrossCode(ReadsGlobalMemory))
+    return nullptr;
+
+  SmallVector<Substitution, 8> Subs;
+  if (!getFusedSubstitutions(Subs))
+    return nullptr;
+
+  SILType FnTy = First->getCallee()->getType();
+  SILType SubstFnTy = Subs.empty() ? FnTy : FnTy.substGenericArgs(M, Subs);
+  auto SubstFnFTy = SubstFnTy.castTo<SILFunctionType>();
+  if (SubstFnFTy->getSILResult() != Second->getType())
+    return nullptr;
+
+  SILParameterInfo ClosureParam = SubstFnFTy->getParameters()[0];
+  auto ClosureTy = ClosureParam.getSILType().castTo<SILFunctionType>();
+  FusedClosureBuilder Builder(F, ClosureTy, FirstClosure, SecondClosure);
+  if (!Builder.canFuse(Kind))
+    return nullptr;
+
+  DEBUG(llvm::dbgs() << "  fusing " << *First << "    with " << *Second);
+  SILFunction *Thunk = Builder.getOrCreateThunk(Kind);
+
+  // The partial_apply consumes the closures. If the calls only borrowed
+  // them, the caller still releases them, so they need an extra retain.
+  SILBuilderWithScope B(Second);
+  SILLocation Loc = Second->getLoc();
+  if (ClosureParam.isGuaranteed()) {
+    SILBuilderWithScope(First).createStrongRetain(First->getLoc(), FirstClosure,
+                                                  Atomicity::Atomic);
+    B.createStrongRetain(Loc, SecondClosure, Atomicity::Atomic);
+  }
+  auto *ThunkRef = B.createFunctionRef(Loc, Thunk);
+  auto *Closure = B.createPartialApply(Loc, ThunkRef, ThunkRef->getType(), {},
+                                       {FirstClosure, SecondClosure},
+                                       ClosureParam.getSILType());
+  auto *Fused = B.createApply(Loc, First->getCallee(), SubstFnTy,
+                              SubstFnFTy->getSILResult(), Subs,
+                              {Closure, First->getSelfArgument()},
+                              SubstFnFTy->hasErrorResult());
+  SILInstruction *InsertPt = Fused;
+  if (ClosureParam.isGuaranteed())
+    InsertPt = SILBuilderWithScope(std::next(SILBasicBlock::iterator(Fused)))
+                   .createStrongRelease(Loc, Closure, Atomicity::Atomic);
+  for (auto *I : Deferred) {
+    I->moveAfter(InsertPt);
+    InsertPt = I;
+  }
+
+  Second->replaceAllUsesWith(Fused);
+  Second->eraseFromParent();
+
+  // The users of each value were collected before the value itself.
+  for (auto *I : Intermediate)
+    I->eraseFromParent();
+  First->eraseFromParent();
+
+  if (Kind == SequenceOpKind::Map)
+    ++NumMapsFused;
+  else
+    ++NumFiltersFused;
+  return Fused;
+}
+
+namespace {
+
+class SequenceFusion : public SILFunctionTransform {
+  /// Returns the sequence operation that produced the self argument of \p AI,
+  /// if it is in the same block.
+  static ApplyInst *getProducer(ApplyInst *AI) {
+    SILValue Self = AI->getSelfArgument();
+    if (auto *ASI = dyn_cast<AllocStackInst>(Self)) {
+      StoreInst *Init = nullptr;
+      for (auto *Use : ASI->getUses()) {
+        if (auto *SI = dyn_cast<StoreInst>(Use->getUser())) {
+          if (Init)
+            return nullptr;
+          Init = SI;
+        }
+      }
+      if (!Init)
+        return nullptr;
+      Self = Init->getSrc();
+    }
+
+    auto *Producer = dyn_cast<ApplyInst>(Self);
+    if (!Producer || Producer->getParent() != AI->getParent())
+      return nullptr;
+    return Producer;
+  }
+
+  void run() override {
+    SILFunction *F = getFunction();
+    auto *SEA = PM->getAnalysis<SideEffectAnalysis>();
+    auto *RCFI = PM->getAnalysis<RCIdentityAnalysis>()->get(F);
+
+    // Calls of rethrowing functions start out as try_apply.
+    bool ChangedCFG = false;
+    SmallVector<TryApplyInst *, 8> TryApplies;
+    for (auto &BB : *F)
+      if (auto *TAI = dyn_cast<TryApplyInst>(BB.getTerminator()))
+        if (getSequenceOpKind(TAI) != SequenceOpKind::None)
+          TryApplies.push_back(TAI);
+    for (auto *TAI : TryApplies)
+      ChangedCFG |= convertNonThrowingTryApply(TAI);
+    if (ChangedCFG)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
+
+    bool Changed = false;
+    for (auto &BB : *F) {
+      for (auto II = BB.begin(); II != BB.end();) {
+        auto *AI = dyn_cast<ApplyInst>(&*II);
+        ++II;
+        if (!AI || !AI->isNonThrowing())
+          continue;
+
+        SequenceOpKind Kind = getSequenceOpKind(AI);
+        if (Kind == SequenceOpKind::None)
+          continue;
+
+        ApplyInst *Producer = getProducer(AI);
+        if (!Producer || !Producer->isNonThrowing() ||
+            getSequenceOpKind(Producer) != Kind)
+          continue;
+
+        if (auto *Fused = SequenceOpFuser(SEA, RCFI, Producer, AI, Kind)
+                              .fuse()) {
+          // The fused call may in turn be the first of another pair.
+          II = std::next(SILBasicBlock::iterator(Fused));
+          Changed = true;
+        }
+      }
+    }
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::CallsAndInstructions);
+  }
+
+  StringRef getName() override { return "Sequence Fusion"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createSequenceFusion() {
+  return new SequenceFusion();
+}
@@ -42,6 +42,8 @@ STATISTIC(NumConstantFolded, "Number of terminators constant folded");
 STATISTIC(NumDeadArguments, "Number of unused arguments removed");
 STATISTIC(NumSROAArguments, "Number of aggregate argument levels split by "
                             "SROA");
+STATISTIC(NumJumpThreadsOverBudget, "Number of jump threads skipped because "
+                                    "the function's budget was used up");
 
 //===----------------------------------------------------------------------===//
 //                             CFG Simplification
@@ -54,6 +56,17 @@ STATISTIC(NumSROAArguments, "Number of aggregate argument levels split by "
 ///
 static unsigned MaxIterationsOfDominatorBasedSimplify = 10;
 
+/// Jump threading duplicates blocks, and every duplicate may enable more
+/// threading. To keep SimplifyCFG roughly linear in the size of the function,
+/// the number of instructions it may duplicate is limited to this many per
+/// instruction of the function, but at least MinJumpThreadingBudget.
+static llvm::cl::opt<unsigned> JumpThreadingBudgetPerInst(
+    "sil-jump-threading-budget-per-inst", llvm::cl::init(4),
+    llvm::cl::desc("Instructions jump threading may duplicate per "
+                   "instruction of the function"));
+
+static const unsigned MinJumpThreadingBudget = 256;
+
 namespace {
   class SimplifyCFG {
     SILFunction &Fn;
@@ -71,6 +84,9 @@ namespace {
     // Dominance and post-dominance info for the current function
     DominanceInfo *DT = nullptr;
 
+    // How many more instructions jump threading may duplicate.
+    unsigned JumpThreadingBudget = 0;
+
     bool ShouldVerify;
     bool EnableJumpThread;
   public:
@@ -141,11 +157,24 @@ namespace {
         LoopHeaders.erase(BB);
     }
 
+    /// Returns true and charges the jump threading budget if \p BB may be
+    /// duplicated by jump threading.
+    bool spendJumpThreadingBudget(SILBasicBlock *BB) {
+      unsigned Cost = std::distance(BB->begin(), BB->end());
+      if (Cost > JumpThreadingBudget) {
+        ++NumJumpThreadsOverBudget;
+        return false;
+      }
+      JumpThreadingBudget -= Cost;
+      return true;
+    }
+
     bool simplifyBlocks();
     bool canonicalizeSwitchEnums();
     bool simplifyThreadedTerminators();
     bool dominatorBasedSimplifications(SILFunction &Fn,
-                                       DominanceInfo *DT);
+                                       DominanceInfo *DT,
+                                       bool &ChangedCFG);
     bool dominatorBasedSimplify(DominanceAnalysis *DA);
 
     /// \brief Remove the basic block if it has no predecessors. Returns true
@@ -311,6 +340,8 @@ public:
 
   ThreadInfo() = default;
 
+  SILBasicBlock *getDest() const { return Dest; }
+
   void threadEdge() {
     DEBUG(llvm::dbgs() << "thread edge from bb" << Src->getDebugID() <<
           " to bb" << Dest->getDebugID() << '\n');
@@ -568,9 +599,10 @@ static bool tryDominatorBasedSimplifications(
 }
 
 /// Propagate values of branched upon values along the outgoing edges down the
-/// dominator tree.
+/// dominator tree. Sets \p ChangedCFG if any edge was jump threaded.
 bool SimplifyCFG::dominatorBasedSimplifications(SILFunction &Fn,
-                                                DominanceInfo *DT) {
+                                                DominanceInfo *DT,
+                                                bool &ChangedCFG) {
   bool Changed = false;
   // Collect jump threadable edges and propagate outgoing edge values of
   // conditional branches/switches.
@@ -588,8 +620,11 @@ bool SimplifyCFG::dominatorBasedSimplifications(SILFunction &Fn,
     return Changed;
 
   for (auto &ThreadInfo : JumpThreadableEdges) {
+    if (!spendJumpThreadingBudget(ThreadInfo.getDest()))
+      continue;
     ThreadInfo.threadEdge();
     Changed = true;
+    ChangedCFG = true;
   }
 
   return Changed;
@@ -662,7 +697,8 @@ bool SimplifyCFG::dominatorBasedSimplify(DominanceAnalysis *DA) {
     // Do dominator based simplification of terminator condition. This does not
     // and MUST NOT change the CFG without updating the dominator tree to
     // reflect such change.
-    if (tryCheckedCastBrJumpThreading(&Fn, DT, BlocksForWorklist)) {
+    if (tryCheckedCastBrJumpThreading(&Fn, DT, BlocksForWorklist,
+                                      JumpThreadingBudget)) {
       for (auto BB: BlocksForWorklist)
         addToWorklist(BB);
 
@@ -686,14 +722,18 @@ bool SimplifyCFG::dominatorBasedSimplify(DominanceAnalysis *DA) {
       DT->verify();
 
     // Jump thread.
-    if (dominatorBasedSimplifications(Fn, DT)) {
+    bool ChangedCFG = false;
+    if (dominatorBasedSimplifications(Fn, DT, ChangedCFG)) {
       DominanceInfo *InvalidDT = DT;
       DT = nullptr;
       HasChangedInCurrentIter = true;
       // Simplify terminators.
-      simplifyThreadedTerminators();
+      ChangedCFG |= simplifyThreadedTerminators();
       DT = InvalidDT;
-      DT->recalculate(Fn);
+      // Only propagating values into their uses leaves the dominator tree
+      // intact, so recomputing it is only needed if the CFG changed.
+      if (ChangedCFG)
+        DT->recalculate(Fn);
     }
 
     Changed |= HasChangedInCurrentIter;
@@ -957,6 +997,9 @@ bool SimplifyCFG::tryJumpThreading(BranchInst *BI) {
   if (!isa<SwitchEnumInst>(DestBB->getTerminator()) && DestIsLoopHeader)
     return false;
 
+  if (!spendJumpThreadingBudget(DestBB))
+    return false;
+
   DEBUG(llvm::dbgs() << "jump thread from bb" << SrcBB->getDebugID() <<
         " to bb" << DestBB->getDebugID() << '\n');
 
@@ -2718,6 +2761,12 @@ bool SimplifyCFG::run() {
 
   DT = nullptr;
 
+  unsigned NumInsts = 0;
+  for (auto &BB : Fn)
+    NumInsts += std::distance(BB.begin(), BB.end());
+  JumpThreadingBudget = std::max(NumInsts * JumpThreadingBudgetPerInst,
+                                 MinJumpThreadingBudget);
+
   // Perform SROA on BB arguments.
   Changed |= splitBBArguments(Fn);
 
@@ -392,6 +392,22 @@ static bool tryToSpeculateTarget(FullApplySite AI,
     Subs.erase(RemovedIt, Subs.end());
   }
 
+  // If the default case can be devirtualized, subclasses which inherit the
+  // implementation of the static class don't need a dedicated check, because
+  // the default case calls the same implementation. Drop them so that the
+  // limited number of checks is spent on subclasses which override the method.
+  bool PrunedSubs = false;
+  if (isDefaultCaseKnown(CHA, AI, CD, Subs)) {
+    auto *Method = CMI->getMember().getFuncDecl();
+    auto *StaticImpl = CD->findImplementingMethod(Method);
+    auto RemovedIt = std::remove_if(Subs.begin(), Subs.end(),
+        [&Method, &StaticImpl](ClassDecl *Sub) {
+          return Sub->findImplementingMethod(Method) == StaticImpl;
+        });
+    PrunedSubs = RemovedIt != Subs.end();
+    Subs.erase(RemovedIt, Subs.end());
+  }
+
   // Number of subclasses which cannot be handled by checked_cast_br checks.
   int NotHandledSubsNum = 0;
   if (Subs.size() > MaxNumSpeculativeTargets) {
@@ -459,7 +475,9 @@ static bool tryToSpeculateTarget(FullApplySite AI,
   // checks.
 
   // TODO: The ordering of checks may benefit from using a PGO, because
-  // the most probable alternatives could be checked first.
+  // the most probable alternatives could be checked first. Until then,
+  // subclasses which don't override the method are not checked at all if the
+  // default case can be devirtualized (see above).
 
   for (auto S : Subs) {
     DEBUG(llvm::dbgs() << "Inserting a speculative call for class "
@@ -507,7 +525,7 @@ static bool tryToSpeculateTarget(FullApplySite AI,
   // implementation which is not covered by checked_cast_br checks yet.
   // So, it is safe to replace a class_method invocation by
   // a direct call of this remaining implementation.
-  if (LastCCBI && SubTypeValue == LastCCBI->getOperand()) {
+  if (!PrunedSubs && LastCCBI && SubTypeValue == LastCCBI->getOperand()) {
     // Remove last checked_cast_br, because it will always succeed.
     SILBuilderWithScope B(LastCCBI);
     auto CastedValue = B.createUncheckedBitCast(LastCCBI->getLoc(),
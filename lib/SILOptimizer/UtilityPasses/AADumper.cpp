@@ -95,6 +95,11 @@ class SILAADumper : public SILModuleTransform {
       }
           llvm::outs() << "\n";
     }
+
+    DEBUG(AliasAnalysis *AA = PM->getAnalysis<AliasAnalysis>();
+          auto &Stats = AA->getAliasCacheStatistics();
+          llvm::dbgs() << "Alias cache: " << Stats.NumHits
+                       << " hits in " << Stats.NumQueries << " queries\n");
   }
 
   StringRef getName() override { return "AA Dumper"; }
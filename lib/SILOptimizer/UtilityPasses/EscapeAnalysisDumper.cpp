@@ -14,9 +14,17 @@
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/Analysis/EscapeAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Timer.h"
 
 using namespace swift;
 
+static llvm::cl::opt<bool> PrintTiming(
+    "escapes-dump-timing", llvm::cl::init(false),
+    llvm::cl::desc("Print how long it takes to get the connection graph of "
+                   "each function"));
+
 namespace {
 
 /// Dumps the escape information of all functions in the module.
@@ -33,7 +41,16 @@ class EscapeAnalysisDumper : public SILModuleTransform {
     llvm::outs() << "Escape information of module\n";
     for (auto &F : *getModule()) {
       if (!F.isExternalDeclaration()) {
+        // The time includes building the graphs of callees which were not
+        // visited before.
+        auto Start = llvm::TimeRecord::getCurrentTime(/*Start=*/true);
         auto *ConnectionGraph = EA->getConnectionGraph(&F);
+        if (PrintTiming) {
+          auto End = llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+          double Millis = (End.getWallTime() - Start.getWallTime()) * 1000;
+          llvm::outs() << "Time to get CG of " << F.getName() << ": "
+                       << llvm::format("%.3f", Millis) << " ms\n";
+        }
         ConnectionGraph->print(llvm::outs());
       }
     }
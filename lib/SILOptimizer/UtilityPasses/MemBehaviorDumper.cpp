@@ -90,6 +90,11 @@ class MemBehaviorDumper : public SILModuleTransform {
       }
       llvm::outs() << "\n";
     }
+
+    DEBUG(AliasAnalysis *AA = PM->getAnalysis<AliasAnalysis>();
+          auto &Stats = AA->getMemoryBehaviorCacheStatistics();
+          llvm::dbgs() << "Memory behavior cache: " << Stats.NumHits
+                       << " hits in " << Stats.NumQueries << " queries\n");
   }
 
   StringRef getName() override { return "Memory Behavior Dumper"; }
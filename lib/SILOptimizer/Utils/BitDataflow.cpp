@@ -0,0 +1,101 @@
+//===--- BitDataflow.cpp - Gen/kill data flow over bit vectors ------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/SILOptimizer/Utils/BitDataflow.h"
+#include "swift/SILOptimizer/Analysis/PostOrderAnalysis.h"
+#include "swift/SIL/SILBasicBlock.h"
+
+using namespace swift;
+
+void BitDataflow::meet(SILBasicBlock *BB) {
+  BlockSets Sets = GetSets(BB);
+  bool First = true;
+  auto meetWith = [&](SILBasicBlock *Neighbor) {
+    if (First) {
+      Sets.Entry = GetSets(Neighbor).Exit;
+      First = false;
+      return;
+    }
+    Sets.Entry &= GetSets(Neighbor).Exit;
+  };
+
+  if (Dir == Direction::Forward) {
+    for (SILBasicBlock *Pred : BB->getPreds())
+      meetWith(Pred);
+  } else {
+    for (SILBasicBlock *Succ : BB->getSuccessorBlocks())
+      meetWith(Succ);
+  }
+
+  // Nothing flows into a block without neighbors.
+  if (First)
+    Sets.Entry.reset();
+
+  if (Sets.Boundary)
+    Sets.Entry |= *Sets.Boundary;
+}
+
+bool BitDataflow::transfer(SILBasicBlock *BB) {
+  meet(BB);
+
+  BlockSets Sets = GetSets(BB);
+  Scratch = Sets.Entry;
+  Scratch.reset(Sets.Kill);
+  Scratch |= Sets.Gen;
+  if (Scratch == Sets.Exit)
+    return false;
+  Sets.Exit.swap(Scratch);
+  return true;
+}
+
+void BitDataflow::solve() {
+  // Blocks are identified by their post order number. Unreachable blocks are
+  // not part of the problem.
+  std::vector<SILBasicBlock *> WorkList;
+  std::vector<bool> InWorkList(PO->size(), true);
+
+  // Push the blocks so that popping from the back visits every block after
+  // its neighbors in the direction of the flow, as far as possible.
+  if (Dir == Direction::Forward) {
+    for (SILBasicBlock *BB : PO->getPostOrder())
+      WorkList.push_back(BB);
+  } else {
+    for (SILBasicBlock *BB : PO->getReversePostOrder())
+      WorkList.push_back(BB);
+  }
+
+  auto push = [&](SILBasicBlock *BB) {
+    auto Num = PO->getPONumber(BB);
+    if (!Num || InWorkList[*Num])
+      return;
+    InWorkList[*Num] = true;
+    WorkList.push_back(BB);
+  };
+
+  while (!WorkList.empty()) {
+    SILBasicBlock *BB = WorkList.back();
+    WorkList.pop_back();
+    InWorkList[*PO->getPONumber(BB)] = false;
+
+    if (!transfer(BB))
+      continue;
+
+    // The Exit set changed, so the neighbors downstream have to be revisited.
+    if (Dir == Direction::Forward) {
+      for (SILBasicBlock *Succ : BB->getSuccessorBlocks())
+        push(Succ);
+    } else {
+      for (SILBasicBlock *Pred : BB->getPreds())
+        push(Pred);
+    }
+  }
+}
@@ -47,6 +47,9 @@ class CheckedCastBrJumpThreading {
   // after jump-threading is done.
   SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist;
 
+  // How many more instructions may be cloned.
+  unsigned &Budget;
+
   // Information for transforming a single checked_cast_br.
   // This is the output of the optimization's analysis phase.
   struct Edit {
@@ -107,8 +110,9 @@ class CheckedCastBrJumpThreading {
 
 public:
   CheckedCastBrJumpThreading(SILFunction *Fn, DominanceInfo *DT,
-                             SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist)
-      : Fn(Fn), DT(DT), BlocksForWorklist(BlocksForWorklist) { }
+                             SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist,
+                             unsigned &Budget)
+      : Fn(Fn), DT(DT), BlocksForWorklist(BlocksForWorklist), Budget(Budget) { }
 
   void optimizeFunction();
 };
@@ -570,8 +574,9 @@ bool CheckedCastBrJumpThreading::trySimplify(CheckedCastBranchInst *CCBI) {
 
     // We only need to clone the BB if not all of its
     // predecessors are in the same group.
-    if (TotalPreds != SuccessPreds.size() &&
-        TotalPreds != numUnknownPreds) {
+    bool NeedsClone = TotalPreds != SuccessPreds.size() &&
+                      TotalPreds != numUnknownPreds;
+    if (NeedsClone) {
       // Check some cloning related constraints.
       if (!checkCloningConstraints())
         return false;
@@ -593,6 +598,13 @@ bool CheckedCastBrJumpThreading::trySimplify(CheckedCastBranchInst *CCBI) {
         return false;
       }
     }
+
+    if (NeedsClone) {
+      unsigned Cost = std::distance(BB->begin(), BB->end());
+      if (Cost > Budget)
+        return false;
+      Budget -= Cost;
+    }
     // If we have predecessors, where it is not known if they are reached over
     // success or failure path, we cannot eliminate a checked_cast_br.
     // We have to generate new dedicated BBs as landing BBs for all
@@ -682,8 +694,10 @@ void CheckedCastBrJumpThreading::optimizeFunction() {
 namespace swift {
 
 bool tryCheckedCastBrJumpThreading(SILFunction *Fn, DominanceInfo *DT,
-                        SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist) {
-  CheckedCastBrJumpThreading CCBJumpThreading(Fn, DT, BlocksForWorklist);
+                        SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist,
+                        unsigned &Budget) {
+  CheckedCastBrJumpThreading CCBJumpThreading(Fn, DT, BlocksForWorklist,
+                                              Budget);
   CCBJumpThreading.optimizeFunction();
   return !BlocksForWorklist.empty();
 }
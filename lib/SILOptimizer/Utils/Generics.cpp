@@ -174,6 +174,21 @@ SILFunction *GenericFuncSpecializer::lookupSpecialization() {
                        << "\n");
     return SpecializedF;
   }
+  // Call a specialization exported by an imported module, if allowed.
+  // Exported specializations are never fragile, so they can only be used
+  // from non-fragile code.
+  if (M.getOptions().UseExportedSpecializations && !Fragile &&
+      M.getOptions().Optimization >= SILOptions::SILOptMode::Optimize) {
+    if (SILFunction *SpecializedF =
+            M.hasFunction(ClonedName, SILLinkage::PublicExternal)) {
+      assert(ReInfo.getSpecializedType()
+             == SpecializedF->getLoweredFunctionType() &&
+             "Exported specialization does not match expected type.");
+      DEBUG(llvm::dbgs() << "Found an exported specialization for: "
+                         << ClonedName << "\n");
+      return SpecializedF;
+    }
+  }
   DEBUG(llvm::dbgs() << "Could not find an existing specialization for: "
                      << ClonedName << "\n");
   return nullptr;
@@ -572,9 +587,9 @@ static void keepSpecializationAsPublic(SILFunction *F) {
 
 /// Link a specialization for generating prespecialized code.
 ///
-/// For now, it is performed only for specializations in the
-/// standard library. But in the future, one could think of
-/// maintaining a cache of optimized specializations.
+/// This is performed for whitelisted specializations in the standard library,
+/// and for all non-fragile specializations of a module compiled with
+/// -sil-export-specializations.
 ///
 /// Mark specializations as public, so that they can be used by user
 /// applications. These specializations are generated during -O compilation of
@@ -583,6 +598,13 @@ static void keepSpecializationAsPublic(SILFunction *F) {
 static bool linkSpecialization(SILModule &M, SILFunction *F) {
   if (F->isKeepAsPublic())
     return true;
+  // Specializations found in other modules are exported by those modules.
+  if (M.getOptions().ExportSpecializations && !F->isFragile() &&
+      F->isDefinition() && !isAvailableExternally(F->getLinkage()) &&
+      M.getOptions().Optimization >= SILOptions::SILOptMode::Optimize) {
+    keepSpecializationAsPublic(F);
+    return true;
+  }
   // Do not remove functions from the white-list. Keep them around.
   // Change their linkage to public, so that other applications can refer to it.
   if (M.getOptions().Optimization >= SILOptions::SILOptMode::Optimize &&
@@ -12,6 +12,7 @@
 
 #define DEBUG_TYPE "sil-inliner"
 #include "swift/SILOptimizer/Utils/SILInliner.h"
+#include "swift/SILOptimizer/Utils/ConstantFolding.h"
 #include "swift/SIL/SILDebugScope.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Debug.h"
@@ -196,6 +197,84 @@ void SILInliner::visitDebugValueAddrInst(DebugValueAddrInst *Inst) {
   return SILCloner<SILInliner>::visitDebugValueAddrInst(Inst);
 }
 
+// The stdlib's integer operators are transparent and wrap their builtins in
+// struct and tuple projections. When mandatory inlining, look through those
+// projections and fold builtins of literal operands while cloning, instead of
+// emitting instructions that constant propagation immediately deletes.
+
+void SILInliner::visitStructExtractInst(StructExtractInst *Inst) {
+  if (IKind == InlineKind::MandatoryInline) {
+    if (auto *SI = dyn_cast<StructInst>(getOpValue(Inst->getOperand()))) {
+      ValueMap.insert({Inst, SI->getFieldValue(Inst->getField())});
+      return;
+    }
+  }
+  TypeSubstCloner<SILInliner>::visitStructExtractInst(Inst);
+}
+
+void SILInliner::visitTupleExtractInst(TupleExtractInst *Inst) {
+  if (IKind == InlineKind::MandatoryInline) {
+    if (auto *TI = dyn_cast<TupleInst>(getOpValue(Inst->getOperand()))) {
+      ValueMap.insert({Inst, TI->getElement(Inst->getFieldNo())});
+      return;
+    }
+  }
+  TypeSubstCloner<SILInliner>::visitTupleExtractInst(Inst);
+}
+
+void SILInliner::visitBuiltinInst(BuiltinInst *Inst) {
+  if (IKind == InlineKind::MandatoryInline) {
+    if (auto *Folded = foldIntegerBuiltin(Inst)) {
+      doPostProcess(Inst, Folded);
+      return;
+    }
+  }
+  TypeSubstCloner<SILInliner>::visitBuiltinInst(Inst);
+}
+
+/// Fold an integer comparison or bitwise operation whose cloned operands are
+/// both integer literals. Operations that can produce diagnostics, like
+/// arithmetic with overflow checks or shifts, are left to the diagnostic
+/// constant propagation pass.
+SILInstruction *SILInliner::foldIntegerBuiltin(BuiltinInst *Inst) {
+  auto Args = Inst->getArguments();
+  if (Args.size() != 2)
+    return nullptr;
+
+  auto *LHS = dyn_cast<IntegerLiteralInst>(getOpValue(Args[0]));
+  auto *RHS = dyn_cast<IntegerLiteralInst>(getOpValue(Args[1]));
+  if (!LHS || !RHS)
+    return nullptr;
+
+  APInt Result;
+  BuiltinValueKind ID = Inst->getBuiltinInfo().ID;
+  switch (ID) {
+  case BuiltinValueKind::ICMP_EQ:
+  case BuiltinValueKind::ICMP_NE:
+  case BuiltinValueKind::ICMP_SLT:
+  case BuiltinValueKind::ICMP_SGT:
+  case BuiltinValueKind::ICMP_SLE:
+  case BuiltinValueKind::ICMP_SGE:
+  case BuiltinValueKind::ICMP_ULT:
+  case BuiltinValueKind::ICMP_UGT:
+  case BuiltinValueKind::ICMP_ULE:
+  case BuiltinValueKind::ICMP_UGE:
+    Result = constantFoldComparison(LHS->getValue(), RHS->getValue(), ID);
+    break;
+  case BuiltinValueKind::And:
+  case BuiltinValueKind::Or:
+  case BuiltinValueKind::Xor:
+    Result = constantFoldBitOperation(LHS->getValue(), RHS->getValue(), ID);
+    break;
+  default:
+    return nullptr;
+  }
+
+  getBuilder().setCurrentDebugScope(getOpScope(Inst->getDebugScope()));
+  return getBuilder().createIntegerLiteral(getOpLocation(Inst->getLoc()),
+                                           getOpType(Inst->getType()), Result);
+}
+
 const SILDebugScope *
 SILInliner::getOrCreateInlineScope(const SILDebugScope *CalleeScope) {
   assert(CalleeScope);
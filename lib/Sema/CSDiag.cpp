@@ -5857,6 +5857,15 @@ bool ConstraintSystem::salvage(SmallVectorImpl<Solution> &viable, Expr *expr) {
   if (getExpressionTooComplex()) {
     TC.diagnose(expr->getLoc(), diag::expression_too_complex).
     highlight(expr->getSourceRange());
+
+    // Point at the sub-expression that gave the solver the most choices,
+    // since that's usually the one worth splitting out or annotating.
+    unsigned numChoices;
+    Expr *anchor = getLargestDisjunctionAnchor(numChoices);
+    if (anchor && anchor != expr && anchor->getLoc().isValid())
+      TC.diagnose(anchor->getLoc(), diag::expression_too_complex_choices,
+                  numChoices)
+        .highlight(anchor->getSourceRange());
     return true;
   }
 
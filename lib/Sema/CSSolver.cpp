@@ -15,9 +15,11 @@
 //===----------------------------------------------------------------------===//
 #include "ConstraintSystem.h"
 #include "ConstraintGraph.h"
+#include "swift/Basic/Statistic.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include <algorithm>
 #include <memory>
 #include <tuple>
 using namespace swift;
@@ -417,6 +419,17 @@ ConstraintSystem::SolverState::~SolverState() {
   // Write our local statistics back to the overall statistics.
   #define CS_STATISTIC(Name, Description) JOIN2(Overall,Name) += Name;
   #include "ConstraintSolverStats.def"
+  #define CS_STATISTIC(Name, Description) CS.LastSolveStatistics.Name = Name;
+  #include "ConstraintSolverStats.def"
+
+  if (auto *stats = CS.getTypeChecker().Context.Stats) {
+    auto &counters = stats->getFrontendCounters();
+    ++counters.NumConstraintSystemsSolved;
+    counters.NumSolverStatesExplored += NumStatesExplored;
+    counters.NumSolverTypeVariablesBound += NumTypeVariablesBound;
+    counters.NumSolverDisjunctions += NumDisjunctions;
+    counters.NumSolverSimplifiedConstraints += NumSimplifiedConstraints;
+  }
 
   // Update the "largest" statistics if this system is larger than the
   // previous one.  
@@ -1051,14 +1064,11 @@ static bool tryTypeVariableBindings(
   auto &tc = cs.getTypeChecker();
   ++cs.solverState->NumTypeVariablesBound;
   
-  // If the solver has allocated an excessive amount of memory when solving for
-  // this expression, short-circuit the binding operation and mark the parent
-  // expression as "too complex".
-  if (cs.TC.Context.getSolverMemory() >
-        cs.TC.Context.LangOpts.SolverMemoryThreshold) {
-    cs.setExpressionTooComplex(true);
+  // If the solver has allocated an excessive amount of memory or explored too
+  // many states when solving for this expression, short-circuit the binding
+  // operation and mark the parent expression as "too complex".
+  if (cs.exceededSolverLimits())
     return true;
-  }
 
   for (unsigned tryCount = 0; !anySolved && !bindings.empty(); ++tryCount) {
     // Try each of the bindings in turn.
@@ -1248,6 +1258,21 @@ ConstraintSystem::solveSingle(FreeTypeVariableBinding allowFreeTypeVariables) {
   return std::move(solutions[0]);
 }
 
+bool ConstraintSystem::exceededSolverLimits() {
+  if (getExpressionTooComplex())
+    return true;
+
+  const LangOptions &langOpts = TC.getLangOpts();
+  if (TC.Context.getSolverMemory() > langOpts.SolverMemoryThreshold ||
+      (langOpts.SolverStateLimit != 0 &&
+       solverState->NumStatesExplored > langOpts.SolverStateLimit)) {
+    setExpressionTooComplex(true);
+    return true;
+  }
+
+  return false;
+}
+
 bool ConstraintSystem::solve(SmallVectorImpl<Solution> &solutions,
                              FreeTypeVariableBinding allowFreeTypeVariables) {
   assert(!solverState && "use solveRec for recursive calls");
@@ -1581,6 +1606,117 @@ static bool shortCircuitDisjunctionAt(Constraint *constraint,
   return false;
 }
 
+/// Returns the canonical type of \p type if it is a non-generic struct or
+/// enum type, between which and any other such type there is no implicit
+/// conversion, or null otherwise.
+static CanType getConcreteValueType(Type type) {
+  if (!type)
+    return CanType();
+  CanType canType = type->getRValueType()->getCanonicalType();
+  if (isa<StructType>(canType) || isa<EnumType>(canType))
+    return canType;
+  return CanType();
+}
+
+/// Collects the types of the arguments already known for the call whose
+/// overload is chosen by \p disjunction, one for each argument, with a null
+/// type for those not yet known.
+///
+/// \returns false if the disjunction doesn't choose the overload of a call
+/// with a simple argument list.
+static bool getKnownArgumentTypes(ConstraintSystem &cs, Constraint *disjunction,
+                                  SmallVectorImpl<CanType> &argTypes) {
+  auto choices = disjunction->getNestedConstraints();
+  if (choices.empty() ||
+      choices.front()->getKind() != ConstraintKind::BindOverload)
+    return false;
+
+  auto fnTypeVar = choices.front()->getFirstType()->getAs<TypeVariableType>();
+  if (!fnTypeVar)
+    return false;
+  fnTypeVar = cs.getRepresentative(fnTypeVar);
+
+  // Find the application of the overloaded function.
+  SmallVector<Constraint *, 8> constraints;
+  cs.getConstraintGraph().gatherConstraints(fnTypeVar, constraints);
+  for (auto constraint : constraints) {
+    if (constraint->getKind() != ConstraintKind::ApplicableFunction)
+      continue;
+
+    auto appliedTypeVar =
+      constraint->getSecondType()->getAs<TypeVariableType>();
+    if (!appliedTypeVar || cs.getRepresentative(appliedTypeVar) != fnTypeVar)
+      continue;
+
+    Type input = constraint->getFirstType()->castTo<FunctionType>()->getInput();
+    if (auto tuple = dyn_cast<TupleType>(input.getPointer())) {
+      for (auto &elt : tuple->getElements()) {
+        if (elt.isVararg())
+          return false;
+        argTypes.push_back(getConcreteValueType(cs.simplifyType(elt.getType())));
+      }
+    } else if (auto paren = dyn_cast<ParenType>(input.getPointer())) {
+      argTypes.push_back(
+        getConcreteValueType(cs.simplifyType(paren->getUnderlyingType())));
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+/// Determine whether the overload chosen by \p constraint can't be applied
+/// to arguments of \p argTypes, because one of them is a concrete value type
+/// other than that of its parameter, to which it can't be converted.
+static bool isIncompatibleOverloadChoice(Constraint *constraint,
+                                         ArrayRef<CanType> argTypes) {
+  if (constraint->getKind() != ConstraintKind::BindOverload)
+    return false;
+
+  auto choice = constraint->getOverloadChoice();
+  if (choice.getKind() != OverloadChoiceKind::Decl)
+    return false;
+
+  // Members are curried on their base; leave them to the solver.
+  auto decl = dyn_cast<FuncDecl>(choice.getDecl());
+  if (!decl || !decl->hasType() || decl->getDeclContext()->isTypeContext())
+    return false;
+
+  auto fnType = decl->getType()->getAs<AnyFunctionType>();
+  if (!fnType)
+    return false;
+
+  SmallVector<Type, 4> paramTypes;
+  Type input = fnType->getInput();
+  if (auto tuple = dyn_cast<TupleType>(input.getPointer())) {
+    for (auto &elt : tuple->getElements()) {
+      if (elt.isVararg() || elt.hasDefaultArg())
+        return false;
+      paramTypes.push_back(elt.getType());
+    }
+  } else if (auto paren = dyn_cast<ParenType>(input.getPointer())) {
+    paramTypes.push_back(paren->getUnderlyingType());
+  } else {
+    return false;
+  }
+
+  if (paramTypes.size() != argTypes.size())
+    return false;
+
+  for (unsigned i : indices(paramTypes)) {
+    if (!argTypes[i])
+      continue;
+
+    CanType paramType = getConcreteValueType(paramTypes[i]);
+    if (paramType && paramType != argTypes[i])
+      return true;
+  }
+
+  return false;
+}
+
 bool ConstraintSystem::solveSimplified(
        SmallVectorImpl<Solution> &solutions,
        FreeTypeVariableBinding allowFreeTypeVariables) {
@@ -1684,10 +1820,32 @@ bool ConstraintSystem::solveSimplified(
     }
   }
 
+  // Remember the sub-expression with the most choices, so that it can be
+  // pointed at if the expression turns out to be too complex.
+  if (bestSize > largestDisjunctionSize) {
+    if (auto locator = disjunction->getLocator()) {
+      if (auto anchor = locator->getAnchor()) {
+        largestDisjunctionAnchor = anchor;
+        largestDisjunctionSize = bestSize;
+      }
+    }
+  }
+
   // Remove this disjunction constraint from the list.
   auto afterDisjunction = InactiveConstraints.erase(disjunction);
   CG.removeConstraint(disjunction);
 
+  // If this disjunction picks the overload of a call whose arguments are
+  // partly known, find them so that overloads which can't accept them aren't
+  // tried. When recording fixes, every choice is tried, so that the fixes
+  // that make the closest ones work can be diagnosed.
+  SmallVector<CanType, 4> knownArgTypes;
+  bool canPruneChoices =
+    !solverState->recordFixes &&
+    getKnownArgumentTypes(*this, disjunction, knownArgTypes) &&
+    std::any_of(knownArgTypes.begin(), knownArgTypes.end(),
+                [](CanType type) { return bool(type); });
+
   // Try each of the constraints within the disjunction.
   Constraint *firstSolvedConstraint = nullptr;
   ++solverState->NumDisjunctions;
@@ -1695,6 +1853,12 @@ bool ConstraintSystem::solveSimplified(
   for (auto index : indices(constraints)) {
     auto constraint = constraints[index];
 
+    if (canPruneChoices &&
+        isIncompatibleOverloadChoice(constraint, knownArgTypes)) {
+      ++solverState->NumDisjunctionTermsPruned;
+      continue;
+    }
+
     // We already have a solution; check whether we should
     // short-circuit the disjunction.
     if (firstSolvedConstraint &&
@@ -1702,7 +1866,7 @@ bool ConstraintSystem::solveSimplified(
       break;
     
     // If the expression was deemed "too complex", stop now and salvage.
-    if (getExpressionTooComplex())
+    if (exceededSolverLimits())
       break;
 
     // Try to solve the system with this option in the disjunction.
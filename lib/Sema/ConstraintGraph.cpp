@@ -571,76 +571,82 @@ void ConstraintGraph::gatherConstraints(
 
 #pragma mark Algorithms
 
-/// Depth-first search for connected components
-static void connectedComponentsDFS(ConstraintGraph &cg,
-                                   ConstraintGraphNode &node,
-                                   unsigned component,
-                                   SmallVectorImpl<unsigned> &components) {
-  // Local function that recurses on the given set of type variables.
-  auto visitAdjacencies = [&](ArrayRef<TypeVariableType *> typeVars) {
-    for (auto adj : typeVars) {
-      auto nodeAndIndex = cg.lookupNode(adj);
-      // If we've already seen this node in this component, we're done.
-      unsigned &curComponent = components[nodeAndIndex.second];
-      if (curComponent == component)
-        continue;
+namespace {
+  /// A union-find structure over the nodes of the constraint graph, by index.
+  class NodeUnionFind {
+    SmallVector<unsigned, 16> Parent;
+    SmallVector<unsigned, 16> Size;
+
+  public:
+    explicit NodeUnionFind(unsigned numNodes) : Size(numNodes, 1) {
+      Parent.reserve(numNodes);
+      for (unsigned i = 0; i != numNodes; ++i)
+        Parent.push_back(i);
+    }
 
-      // Mark this node as part of this connected component, then recurse.
-      assert(curComponent == components.size() && "Already in a component?");
-      curComponent = component;
-      connectedComponentsDFS(cg, nodeAndIndex.first, component, components);
+    unsigned find(unsigned node) {
+      // Halve the path on the way up, so later finds are shorter.
+      while (Parent[node] != node) {
+        Parent[node] = Parent[Parent[node]];
+        node = Parent[node];
+      }
+      return node;
     }
-  };
 
-  // Recurse to mark adjacent nodes as part of this connected component.
-  visitAdjacencies(node.getAdjacencies());
-
-  // Figure out the representative for this type variable.
-  auto &cs = cg.getConstraintSystem();
-  auto typeVarRep = cs.getRepresentative(node.getTypeVariable());
-  if (typeVarRep == node.getTypeVariable()) {
-    // This type variable is the representative of its set; visit all of the
-    // other type variables in the same equivalence class.
-    visitAdjacencies(node.getEquivalenceClass().slice(1));
-  } else {
-    // Otherwise, visit the representative of the set.
-    visitAdjacencies(typeVarRep);
-  }
+    void merge(unsigned node1, unsigned node2) {
+      node1 = find(node1);
+      node2 = find(node2);
+      if (node1 == node2)
+        return;
+      if (Size[node1] < Size[node2])
+        std::swap(node1, node2);
+      Parent[node2] = node1;
+      Size[node1] += Size[node2];
+    }
+  };
 }
 
 unsigned ConstraintGraph::computeConnectedComponents(
            SmallVectorImpl<TypeVariableType *> &typeVars,
            SmallVectorImpl<unsigned> &components) {
-  // Track those type variables that the caller cares about.
-  llvm::SmallPtrSet<TypeVariableType *, 4> typeVarSubset(typeVars.begin(),
-                                                         typeVars.end());
-  typeVars.clear();
-
-  // Initialize the components with component == # of type variables,
-  // a sentinel value indicating
   unsigned numTypeVariables = TypeVariables.size();
-  components.assign(numTypeVariables, numTypeVariables);
 
-  // Perform a depth-first search from each type variable to identify
-  // what component it is in.
-  unsigned numComponents = 0;
+  // Track those type variables that the caller cares about, by their index
+  // in the graph.
+  bool onlySubset = !typeVars.empty();
+  SmallVector<bool, 16> inSubset(onlySubset ? numTypeVariables : 0, false);
+  for (auto typeVar : typeVars) {
+    auto &impl = typeVar->getImpl();
+    if (impl.getGraphNode())
+      inSubset[impl.getGraphIndex()] = true;
+  }
+  typeVars.clear();
+
+  // Join each node with the nodes it's adjacent to, and with the
+  // representative of its equivalence class. This visits each adjacency once,
+  // without recursing, and without a set of visited nodes.
+  NodeUnionFind nodes(numTypeVariables);
   for (unsigned i = 0; i != numTypeVariables; ++i) {
     auto typeVar = TypeVariables[i];
+    auto &node = *typeVar->getImpl().getGraphNode();
+    for (auto adj : node.getAdjacencies())
+      nodes.merge(i, lookupNode(adj).second);
 
-    // Look up the node for this type variable.
-    auto nodeAndIndex = lookupNode(typeVar);
-
-    // If we're already assigned a component for this node, skip it.
-    unsigned &curComponent = components[nodeAndIndex.second];
-    if (curComponent != numTypeVariables)
-      continue;
-
-    // Record this component.
-    unsigned component = numComponents++;
+    auto typeVarRep = CS.getRepresentative(typeVar);
+    if (typeVarRep != typeVar)
+      nodes.merge(i, lookupNode(typeVarRep).second);
+  }
 
-    // Note that this node is part of this component, then visit it.
-    curComponent = component;
-    connectedComponentsDFS(*this, nodeAndIndex.first, component, components);
+  // Number the components in the order of their first type variable, with
+  // component == # of type variables as a sentinel for "not yet numbered".
+  components.assign(numTypeVariables, numTypeVariables);
+  SmallVector<unsigned, 16> rootComponent(numTypeVariables, numTypeVariables);
+  unsigned numComponents = 0;
+  for (unsigned i = 0; i != numTypeVariables; ++i) {
+    unsigned &component = rootComponent[nodes.find(i)];
+    if (component == numTypeVariables)
+      component = numComponents++;
+    components[i] = component;
   }
 
   // Figure out which components have unbound type variables; these
@@ -653,7 +659,7 @@ unsigned ConstraintGraph::computeConnectedComponents(
 
     // If we only care about a subset, and this type variable isn't in that
     // subset, skip it.
-    if (!typeVarSubset.empty() && typeVarSubset.count(TypeVariables[i]) == 0)
+    if (onlySubset && !inSubset[i])
       continue;
 
     componentHasUnboundTypeVar[components[i]] = true;
@@ -908,9 +908,15 @@ private:
   unsigned TypeCounter = 0;
   
   /// \brief The expression being solved has exceeded the solver's memory
-  /// threshold.
+  /// threshold or state limit.
   bool expressionExceededThreshold = false;
 
+  /// \brief The sub-expression whose disjunction had the most choices among
+  /// those the solver tried, and the number of choices, used to point at
+  /// the likely cause of an expression being too complex.
+  Expr *largestDisjunctionAnchor = nullptr;
+  unsigned largestDisjunctionSize = 0;
+
   /// \brief Cached member lookups.
   llvm::DenseMap<std::pair<Type, DeclName>, Optional<LookupResult>>
     MemberLookups;
@@ -990,6 +996,18 @@ private:
   SmallVector<std::pair<ConstraintLocator *, ArchetypeType *>, 4>
     OpenedExistentialTypes;
 
+public:
+  /// Counts of the work done by the solver.
+  struct SolverStatistics {
+    #define CS_STATISTIC(Name, Description) unsigned Name = 0;
+    #include "ConstraintSolverStats.def"
+  };
+
+  /// The work done by the last call to solve(), which is kept after the
+  /// solver state is gone so that callers can report it.
+  SolverStatistics LastSolveStatistics;
+
+private:
   /// \brief Describes the current solver state.
   struct SolverState {
     SolverState(ConstraintSystem &cs);
@@ -2080,6 +2098,11 @@ public:
   void setExpressionTooComplex(bool tc) {
     expressionExceededThreshold = tc;
   }
+
+  /// \brief Determine whether the solver has used more memory or explored
+  /// more states than it is allowed to for this expression, marking the
+  /// expression as too complex if so.
+  bool exceededSolverLimits();
   
   /// \brief Reorder the disjunctive clauses for a given expression to
   /// increase the likelihood that a favored constraint will be successfully
@@ -2092,6 +2115,13 @@ public:
     return expressionExceededThreshold;
   }
 
+  /// \brief Returns the sub-expression whose disjunction had the most choices
+  /// among those the solver tried, or null if it tried none.
+  Expr *getLargestDisjunctionAnchor(unsigned &numChoices) const {
+    numChoices = largestDisjunctionSize;
+    return largestDisjunctionAnchor;
+  }
+
   LLVM_ATTRIBUTE_DEPRECATED(
       void dump() LLVM_ATTRIBUTE_USED,
       "only for use within the debugger");
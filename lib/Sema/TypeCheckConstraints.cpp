@@ -37,6 +37,7 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/Timer.h"
 #include <iterator>
 #include <map>
 #include <memory>
@@ -1261,8 +1262,26 @@ solveForExpression(Expr *&expr, DeclContext *dc, Type convertType,
     cs.print(log);
   }
 
-  // Attempt to solve the constraint system.
-  if (cs.solve(viable, allowFreeTypeVariables) ||
+  // Attempt to solve the constraint system, timing it if we've been asked to
+  // report the slowest expressions.
+  bool timeSolve = getLangOpts().DebugSlowestExpressions != 0;
+  llvm::TimeRecord solveStart;
+  if (timeSolve)
+    solveStart = llvm::TimeRecord::getCurrentTime();
+
+  bool failed = cs.solve(viable, allowFreeTypeVariables);
+
+  if (timeSolve) {
+    llvm::TimeRecord solveEnd = llvm::TimeRecord::getCurrentTime(false);
+    auto &stats = cs.LastSolveStatistics;
+    recordExpressionSolve(expr->getSourceRange(),
+                          (solveEnd.getWallTime() -
+                           solveStart.getWallTime()) * 1000,
+                          stats.NumStatesExplored, stats.NumDisjunctions,
+                          stats.NumTypeVariablesBound);
+  }
+
+  if (failed ||
       (viable.size() != 1 &&
        !options.contains(TypeCheckExprFlags::AllowUnresolvedTypeVariables))) {
     if (options.contains(TypeCheckExprFlags::SuppressDiagnostics))
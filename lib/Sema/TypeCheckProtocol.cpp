@@ -31,10 +31,17 @@
 #include "swift/Sema/IDETypeChecking.h"
 #include "llvm/ADT/ScopedHashTable.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/SaveAndRestore.h"
 
 using namespace swift;
 
+#define DEBUG_TYPE "Conformance lookup"
+STATISTIC(NumConformanceCacheHits,
+          "# of conformance lookups answered from the type checker's cache");
+STATISTIC(NumConformanceCacheMisses,
+          "# of conformance lookups performed by the type checker");
+
 namespace {
   struct RequirementMatch;
   struct RequirementCheck;
@@ -4065,9 +4072,37 @@ bool TypeChecker::conformsToProtocol(Type T, ProtocolDecl *Proto,
     }
   };
 
-  // Look up conformance in the module.
+  // Look up conformance in the module, unless we've already done so.
   Module *M = topLevelContext->getParentModule();
-  auto lookupResult = M->lookupConformance(T, Proto, this);
+  Optional<ProtocolConformanceRef> lookupResult;
+  if (T->hasTypeVariable() || T->hasUnresolvedType() || T->is<ErrorType>()) {
+    lookupResult = M->lookupConformance(T, Proto, this);
+  } else {
+    if (ConformanceCacheGeneration != Context.getCurrentGeneration()) {
+      ConformanceCache.clear();
+      ConformanceCacheGeneration = Context.getCurrentGeneration();
+    }
+
+    auto key = std::make_pair(std::make_pair(T.getPointer(), Proto), M);
+    auto known = ConformanceCache.find(key);
+    if (known != ConformanceCache.end()) {
+      ++NumConformanceCacheHits;
+      lookupResult = known->second;
+    } else {
+      ++NumConformanceCacheMisses;
+      lookupResult = M->lookupConformance(T, Proto, this);
+
+      // A negative answer isn't stable while the nominal type's inheritance
+      // clause is still being resolved, so only cache it afterwards.
+      auto nominal = T->getAnyNominal();
+      if (lookupResult ||
+          !nominal ||
+          (nominal->checkedInheritanceClause() &&
+           !nominal->isBeingTypeChecked()))
+        ConformanceCache[key] = lookupResult;
+    }
+  }
+
   if (!lookupResult) {
     if (ComplainLoc.isValid())
       diagnoseConformanceFailure(*this, T, Proto, DC, ComplainLoc);
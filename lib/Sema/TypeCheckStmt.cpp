@@ -26,6 +26,7 @@
 #include "swift/Basic/Range.h"
 #include "swift/Basic/STLExtras.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/Basic/TraceEvents.h"
 #include "swift/Parse/Lexer.h"
 #include "swift/Parse/LocalContext.h"
 #include "llvm/ADT/DenseMap.h"
@@ -1256,6 +1257,18 @@ bool TypeChecker::typeCheckAbstractFunctionBody(AbstractFunctionDecl *AFD) {
   if (DebugTimeFunctionBodies || WarnLongFunctionBodies)
     timer.emplace(AFD, DebugTimeFunctionBodies, WarnLongFunctionBodies);
 
+  Optional<TraceSpan> span;
+  if (TraceSpan::isEnabled()) {
+    DeclName name = AFD->getFullName();
+    if (!name)
+      if (auto *method = dyn_cast<FuncDecl>(AFD))
+        name = method->getAccessorStorageDecl()->getFullName();
+    std::string detail;
+    llvm::raw_string_ostream detailOS(detail);
+    detailOS << name;
+    span.emplace("Type-check function body", detailOS.str());
+  }
+
   if (typeCheckAbstractFunctionBodyUntil(AFD, SourceLoc()))
     return true;
   
@@ -24,6 +24,7 @@
 #include "swift/AST/Identifier.h"
 #include "swift/AST/ModuleLoader.h"
 #include "swift/AST/NameLookup.h"
+#include "swift/AST/PhaseTimer.h"
 #include "swift/AST/PrettyStackTrace.h"
 #include "swift/AST/TypeRefinementContext.h"
 #include "swift/Basic/STLExtras.h"
@@ -39,6 +40,7 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Support/Format.h"
 #include <algorithm>
 
 using namespace swift;
@@ -54,6 +56,9 @@ TypeChecker::TypeChecker(ASTContext &Ctx, DiagnosticEngine &Diags)
 }
 
 TypeChecker::~TypeChecker() {
+  if (unsigned limit = Context.LangOpts.DebugSlowestExpressions)
+    dumpSlowestExpressions(limit);
+
   auto clangImporter =
     static_cast<ClangImporter *>(Context.getClangModuleLoader());
   clangImporter->clearTypeResolver();
@@ -61,6 +66,29 @@ TypeChecker::~TypeChecker() {
   Context.setLazyResolver(nullptr);
 }
 
+void TypeChecker::dumpSlowestExpressions(unsigned limit) {
+  if (ExpressionSolveRecords.empty())
+    return;
+
+  std::stable_sort(ExpressionSolveRecords.begin(),
+                   ExpressionSolveRecords.end(),
+                   [](const ExpressionSolveRecord &lhs,
+                      const ExpressionSolveRecord &rhs) {
+    return lhs.WallTimeInMS > rhs.WallTimeInMS;
+  });
+
+  auto &out = llvm::errs();
+  limit = std::min<size_t>(limit, ExpressionSolveRecords.size());
+  for (auto &record : llvm::makeArrayRef(ExpressionSolveRecords)
+                          .slice(0, limit)) {
+    out << llvm::format("%0.1f", record.WallTimeInMS) << "ms\t";
+    record.Range.print(out, Context.SourceMgr, /*PrintText=*/false);
+    out << "\t" << record.NumStatesExplored << " states, "
+        << record.NumDisjunctions << " disjunctions, "
+        << record.NumTypeVariablesBound << " type variables bound\n";
+  }
+}
+
 void TypeChecker::handleExternalDecl(Decl *decl) {
   if (auto SD = dyn_cast<StructDecl>(decl)) {
     addImplicitConstructors(SD);
@@ -390,6 +418,11 @@ static void bindExtensionDecl(ExtensionDecl *ED, TypeChecker &TC) {
   extendedNominal->addExtension(ED);
 }
 
+static bool isTypeCheckingCancelled(ASTContext &Ctx) {
+  auto &ShouldCancel = Ctx.ShouldCancelTypeChecking;
+  return ShouldCancel && ShouldCancel();
+}
+
 static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
   unsigned currentFunctionIdx = 0;
   unsigned currentExternalDef = TC.Context.LastCheckedExternalDefinition;
@@ -406,6 +439,14 @@ static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
       // but that gets tricky with synthesized function bodies.
       if (AFD->isBodyTypeChecked()) continue;
 
+      // The client no longer wants the result; leave the remaining bodies
+      // unchecked. Capture computation and error-handling checks below
+      // require checked bodies, so skip those as well.
+      if (isTypeCheckingCancelled(TC.Context)) {
+        TC.Context.LastCheckedExternalDefinition = currentExternalDef;
+        return;
+      }
+
       PrettyStackTraceDecl StackEntry("type-checking", AFD);
       TC.typeCheckAbstractFunctionBody(AFD);
 
@@ -423,6 +464,11 @@ static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
         // but that gets tricky with synthesized function bodies.
         if (AFD->isBodyTypeChecked()) continue;
 
+        if (isTypeCheckingCancelled(TC.Context)) {
+          TC.Context.LastCheckedExternalDefinition = currentExternalDef;
+          return;
+        }
+
         PrettyStackTraceDecl StackEntry("type-checking", AFD);
         TC.typeCheckAbstractFunctionBody(AFD);
         continue;
@@ -541,19 +587,20 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
   if (SF.ASTStage == SourceFile::TypeChecked)
     return;
 
+  auto &Ctx = SF.getASTContext();
+
   // Make sure that name binding has been completed before doing any type
   // checking.
   {
-    SharedTimer timer("Name binding");
+    SharedPhaseTimer timer(Ctx, "Name binding");
     performNameBinding(SF, StartElem);
   }
 
-  auto &Ctx = SF.getASTContext();
   {
     // NOTE: The type checker is scoped to be torn down before AST
     // verification.
     TypeChecker TC(Ctx);
-    SharedTimer timer("Type checking / Semantic analysis");
+    SharedPhaseTimer timer(Ctx, "Type checking / Semantic analysis");
 
     TC.setWarnLongFunctionBodies(WarnLongFunctionBodies);
     if (Options.contains(TypeCheckingFlags::DebugTimeFunctionBodies))
@@ -641,6 +688,10 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
   // Verify that we've checked types correctly.
   SF.ASTStage = SourceFile::TypeChecked;
 
+  // Bodies left unchecked by a cancelled request would fail verification.
+  if (isTypeCheckingCancelled(Ctx))
+    return;
+
   {
     SharedTimer timer("AST verification");
     // Verify the SourceFile.
@@ -456,6 +456,19 @@ public:
   /// completed before type checking is considered complete.
   llvm::SetVector<NormalProtocolConformance *> UsedConformances;
 
+  /// The results of looking up conformances in a module, keyed by the
+  /// (sugared) type and protocol, then the module.
+  ///
+  /// Negative results are cached once the type's inheritance clause has
+  /// been checked. The cache is cleared whenever the
+  /// ASTContext generation changes, since newly loaded modules can add
+  /// conformances.
+  llvm::DenseMap<std::pair<std::pair<TypeBase *, ProtocolDecl *>, Module *>,
+                 Optional<ProtocolConformanceRef>> ConformanceCache;
+
+  /// The ASTContext generation that ConformanceCache reflects.
+  unsigned ConformanceCacheGeneration = 0;
+
   /// The list of nominal type declarations that have been validated
   /// during type checking.
   llvm::SetVector<NominalTypeDecl *> ValidatedTypes;
@@ -614,6 +627,19 @@ private:
   /// when executing scripts.
   bool InImmediateMode = false;
 
+  /// The cost of solving the constraint system of an expression.
+  struct ExpressionSolveRecord {
+    SourceRange Range;
+    double WallTimeInMS;
+    unsigned NumStatesExplored;
+    unsigned NumDisjunctions;
+    unsigned NumTypeVariablesBound;
+  };
+
+  /// The expressions solved so far, recorded when
+  /// LangOptions::DebugSlowestExpressions is set.
+  std::vector<ExpressionSolveRecord> ExpressionSolveRecords;
+
   /// A helper to construct and typecheck call to super.init().
   ///
   /// \returns NULL if the constructed expression does not typecheck.
@@ -639,6 +665,21 @@ public:
     WarnLongFunctionBodies = timeInMS;
   }
 
+  /// Records the time and solver work taken to solve the constraint system
+  /// for the expression at \p range, for the report of the slowest
+  /// expressions.
+  void recordExpressionSolve(SourceRange range, double wallTimeInMS,
+                             unsigned numStatesExplored,
+                             unsigned numDisjunctions,
+                             unsigned numTypeVariablesBound) {
+    ExpressionSolveRecords.push_back({range, wallTimeInMS, numStatesExplored,
+                                      numDisjunctions, numTypeVariablesBound});
+  }
+
+  /// Prints the \p limit expressions that took the longest to solve, slowest
+  /// first, to llvm::errs().
+  void dumpSlowestExpressions(unsigned limit);
+
   bool getInImmediateMode() {
     return InImmediateMode;
   }
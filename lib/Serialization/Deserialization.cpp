@@ -16,6 +16,7 @@
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/ForeignErrorConvention.h"
 #include "swift/AST/PrettyStackTrace.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Parse/Parser.h"
 #include "swift/Serialization/BCReadingExtras.h"
@@ -1824,6 +1825,9 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
   if (declOrOffset.isComplete())
     return declOrOffset;
 
+  if (auto *stats = getContext().Stats)
+    ++stats->getFrontendCounters().NumDeclsDeserialized;
+
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(declOrOffset);
   auto entry = DeclTypeCursor.advance();
@@ -3350,6 +3354,9 @@ Type ModuleFile::getType(TypeID TID) {
   if (typeOrOffset.isComplete())
     return typeOrOffset;
 
+  if (auto *stats = getContext().Stats)
+    ++stats->getFrontendCounters().NumTypesDeserialized;
+
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(typeOrOffset);
   auto entry = DeclTypeCursor.advance();
@@ -4104,6 +4111,33 @@ void ModuleFile::loadAllMembers(Decl *D, uint64_t contextData) {
   }
 }
 
+bool ModuleFile::canLoadNamedMembers(const Decl *D, uint64_t contextData) {
+  // Protocol members are loaded together with the default witness table.
+  return MembersByName && !isa<ProtocolDecl>(D);
+}
+
+void ModuleFile::loadNamedMembers(const Decl *D, Identifier N,
+                                  uint64_t contextData,
+                                  SmallVectorImpl<ValueDecl *> &members) {
+  PrettyStackTraceDecl trace("loading members for", D);
+  assert(canLoadNamedMembers(D, contextData));
+
+  auto iter = MembersByName->find(N);
+  if (iter == MembersByName->end())
+    return;
+
+  for (auto entry : *iter) {
+    // D itself has been deserialized, so entries whose context hasn't been
+    // are for some other type or extension.
+    auto &parent = Decls[entry.first - 1];
+    if (!parent.isComplete() || parent.get() != D)
+      continue;
+
+    if (auto member = dyn_cast_or_null<ValueDecl>(getDecl(entry.second)))
+      members.push_back(member);
+  }
+}
+
 void
 ModuleFile::loadAllConformances(const Decl *D, uint64_t contextData,
                           SmallVectorImpl<ProtocolConformance*> &conformances) {
@@ -14,6 +14,8 @@
 #include "DeserializeSIL.h"
 #include "swift/Serialization/ModuleFile.h"
 #include "SILFormat.h"
+#include "swift/AST/ASTContext.h"
+#include "swift/Basic/Statistic.h"
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SIL/SILDebugScope.h"
@@ -379,13 +381,13 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
   DeclID clangNodeOwnerID;
   TypeID funcTyID;
   unsigned rawLinkage, isTransparent, isFragile, isThunk, isGlobal,
-    inlineStrategy, effect, numSpecAttrs;
+    inlineStrategy, effect, numSpecAttrs, bodySize;
   ArrayRef<uint64_t> SemanticsIDs;
   // TODO: read fragile
   SILFunctionLayout::readRecord(scratch, rawLinkage, isTransparent, isFragile,
                                 isThunk, isGlobal, inlineStrategy, effect,
-                                numSpecAttrs, funcTyID, clangNodeOwnerID,
-                                SemanticsIDs);
+                                numSpecAttrs, bodySize, funcTyID,
+                                clangNodeOwnerID, SemanticsIDs);
 
   if (funcTyID == 0) {
     DEBUG(llvm::dbgs() << "SILFunction typeID is 0.\n");
@@ -461,6 +463,7 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
          "SILFunction to be deserialized starts being empty.");
 
   fn->setBare(IsBare);
+  fn->setSerializedBodySize(bodySize);
   if (!fn->hasLocation()) fn->setLocation(loc);
 
   const SILDebugScope *DS = fn->getDebugScope();
@@ -536,6 +539,8 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
   }
 
   NumDeserializedFunc++;
+  if (auto *stats = SILMod.getASTContext().Stats)
+    ++stats->getFrontendCounters().NumSILFunctionsDeserialized;
 
   assert(!(fn->getContextGenericParams() && !fn->empty())
          && "function already has context generic params?!");
@@ -1863,11 +1868,11 @@ bool SILDeserializer::hasSILFunction(StringRef Name,
   DeclID clangOwnerID;
   TypeID funcTyID;
   unsigned rawLinkage, isTransparent, isFragile, isThunk, isGlobal,
-    inlineStrategy, effect, numSpecAttrs;
+    inlineStrategy, effect, numSpecAttrs, bodySize;
   ArrayRef<uint64_t> SemanticsIDs;
   SILFunctionLayout::readRecord(scratch, rawLinkage, isTransparent, isFragile,
                                 isThunk, isGlobal, inlineStrategy, effect,
-                                numSpecAttrs, funcTyID, clangOwnerID,
+                                numSpecAttrs, bodySize, funcTyID, clangOwnerID,
                                 SemanticsIDs);
   auto linkage = fromStableSILLinkage(rawLinkage);
   if (!linkage) {
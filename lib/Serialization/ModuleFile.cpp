@@ -339,6 +339,51 @@ public:
   }
 };
 
+/// Used to deserialize entries in the on-disk table of members by name.
+class ModuleFile::DeclMemberTableInfo {
+public:
+  using internal_key_type = StringRef;
+  using external_key_type = Identifier;
+  using data_type = SmallVector<std::pair<DeclID, DeclID>, 8>;
+  using hash_value_type = uint32_t;
+  using offset_type = unsigned;
+
+  internal_key_type GetInternalKey(external_key_type ID) {
+    return ID.str();
+  }
+
+  hash_value_type ComputeHash(internal_key_type key) {
+    return llvm::HashString(key);
+  }
+
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<unsigned, unsigned> ReadKeyDataLength(const uint8_t *&data) {
+    unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+    unsigned dataLength = endian::readNext<uint32_t, little, unaligned>(data);
+    return { keyLength, dataLength };
+  }
+
+  static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+    return StringRef(reinterpret_cast<const char *>(data), length);
+  }
+
+  static data_type ReadData(internal_key_type key, const uint8_t *data,
+                            unsigned length) {
+    data_type result;
+    while (length > 0) {
+      DeclID parentID = endian::readNext<uint32_t, little, unaligned>(data);
+      DeclID memberID = endian::readNext<uint32_t, little, unaligned>(data);
+      result.push_back({ parentID, memberID });
+      length -= 8;
+    }
+
+    return result;
+  }
+};
+
 /// Used to deserialize entries in the on-disk decl hash table.
 class ModuleFile::LocalDeclTableInfo {
 public:
@@ -388,6 +433,18 @@ ModuleFile::readDeclTable(ArrayRef<uint64_t> fields, StringRef blobData) {
                                                 base + sizeof(uint32_t), base));
 }
 
+std::unique_ptr<ModuleFile::SerializedDeclMemberTable>
+ModuleFile::readDeclMemberTable(ArrayRef<uint64_t> fields,
+                                StringRef blobData) {
+  uint32_t tableOffset;
+  index_block::DeclListLayout::readRecord(fields, tableOffset);
+  auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  using OwnedTable = std::unique_ptr<SerializedDeclMemberTable>;
+  return OwnedTable(SerializedDeclMemberTable::Create(base + tableOffset,
+    base + sizeof(uint32_t), base));
+}
+
 std::unique_ptr<ModuleFile::SerializedLocalDeclTable>
 ModuleFile::readLocalDeclTable(ArrayRef<uint64_t> fields, StringRef blobData) {
   uint32_t tableOffset;
@@ -486,20 +543,16 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
 
       switch (kind) {
       case index_block::DECL_OFFSETS:
-        assert(blobData.empty());
-        Decls.assign(scratch.begin(), scratch.end());
+        Decls.assign(blobData);
         break;
       case index_block::DECL_CONTEXT_OFFSETS:
-        assert(blobData.empty());
-        DeclContexts.assign(scratch.begin(), scratch.end());
+        DeclContexts.assign(blobData);
         break;
       case index_block::TYPE_OFFSETS:
-        assert(blobData.empty());
-        Types.assign(scratch.begin(), scratch.end());
+        Types.assign(blobData);
         break;
       case index_block::IDENTIFIER_OFFSETS:
-        assert(blobData.empty());
-        Identifiers.assign(scratch.begin(), scratch.end());
+        Identifiers.assign(blobData);
         break;
       case index_block::TOP_LEVEL_DECLS:
         TopLevelDecls = readDeclTable(scratch, blobData);
@@ -527,12 +580,13 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
         LocalTypeDecls = readLocalDeclTable(scratch, blobData);
         break;
       case index_block::LOCAL_DECL_CONTEXT_OFFSETS:
-        assert(blobData.empty());
-        LocalDeclContexts.assign(scratch.begin(), scratch.end());
+        LocalDeclContexts.assign(blobData);
         break;
       case index_block::NORMAL_CONFORMANCE_OFFSETS:
-        assert(blobData.empty());
-        NormalConformances.assign(scratch.begin(), scratch.end());
+        NormalConformances.assign(blobData);
+        break;
+      case index_block::DECL_MEMBER_NAMES:
+        MembersByName = readDeclMemberTable(scratch, blobData);
         break;
 
       default:
@@ -1657,9 +1711,10 @@ Identifier ModuleFile::getDiscriminatorForPrivateValue(const ValueDecl *D) {
 void ModuleFile::verify() const {
 #ifndef NDEBUG
   const auto &Context = getContext();
-  for (const Serialized<Decl*> &next : Decls)
+  Decls.forEachCreated([&](const Serialized<Decl*> &next) {
     if (next.isComplete() && swift::shouldVerify(next, Context))
       swift::verify(next);
+  });
 #endif
 }
 
@@ -247,6 +247,7 @@ namespace sil_block {
                      BCFixed<2>, // inlineStrategy
                      BCFixed<2>, // side effect info.
                      BCFixed<2>, // number of specialize attributes
+                     BCVBR<8>,   // number of instructions in the body
                      TypeIDField,// SILFunctionType
                      DeclIDField,// ClangNode owner
                      BCArray<IdentifierIDField> // Semantics Attribute
@@ -50,6 +50,9 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/YAMLParser.h"
 
+#include <atomic>
+#include <functional>
+#include <thread>
 #include <vector>
 
 using namespace swift;
@@ -145,6 +148,49 @@ namespace {
     }
   };
 
+  /// Used to serialize the on-disk table of members by name.
+  class DeclMemberTableInfo {
+  public:
+    using key_type = Identifier;
+    using key_type_ref = key_type;
+    using data_type = Serializer::DeclMemberTableData;
+    using data_type_ref = const data_type &;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      assert(!key.empty());
+      return llvm::HashString(key.str());
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      // Common names like "init" can have more members than a 16-bit data
+      // length allows for.
+      uint32_t keyLength = key.str().size();
+      uint32_t dataLength = sizeof(uint32_t) * 2 * data.size();
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint32_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      out << key.str();
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      static_assert(declIDFitsIn32Bits(), "DeclID too large");
+      endian::Writer<little> writer(out);
+      for (auto entry : data) {
+        writer.write<uint32_t>(entry.first);
+        writer.write<uint32_t>(entry.second);
+      }
+    }
+  };
+
   using LocalTypeHashTableGenerator =
     llvm::OnDiskChainedHashTableGenerator<LocalDeclTableInfo>;
 
@@ -1247,9 +1293,14 @@ static bool shouldSerializeMember(Decl *D) {
   }
 }
 
-void Serializer::writeMembers(DeclRange members, bool isClass) {
+void Serializer::writeMembers(const Decl *parent, DeclRange members,
+                              bool isClass) {
   using namespace decls_block;
 
+  // Protocol members are always loaded together, along with the default
+  // witness table.
+  DeclID parentID = isa<ProtocolDecl>(parent) ? DeclID(0) : addDeclRef(parent);
+
   unsigned abbrCode = DeclTypeAbbrCodes[MembersLayout::Code];
   SmallVector<DeclID, 16> memberIDs;
   for (auto member : members) {
@@ -1259,6 +1310,13 @@ void Serializer::writeMembers(DeclRange members, bool isClass) {
     DeclID memberID = addDeclRef(member);
     memberIDs.push_back(memberID);
 
+    if (parentID) {
+      if (auto VD = dyn_cast<ValueDecl>(member)) {
+        if (VD->hasName())
+          MembersByName[VD->getName()].push_back({parentID, memberID});
+      }
+    }
+
     if (isClass) {
       if (auto VD = dyn_cast<ValueDecl>(member)) {
         if (VD->canBeAccessedByDynamicLookup()) {
@@ -2088,7 +2146,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(extension->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(extension->getGenericRequirements());
-    writeMembers(extension->getMembers(), isClassExtension);
+    writeMembers(extension, extension->getMembers(), isClassExtension);
     writeConformances(conformances, DeclTypeAbbrCodes);
 
     break;
@@ -2267,7 +2325,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theStruct->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theStruct->getGenericRequirements());
-    writeMembers(theStruct->getMembers(), false);
+    writeMembers(theStruct, theStruct->getMembers(), false);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2301,7 +2359,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theEnum->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theEnum->getGenericRequirements());
-    writeMembers(theEnum->getMembers(), false);
+    writeMembers(theEnum, theEnum->getMembers(), false);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2338,7 +2396,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(theClass->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(theClass->getGenericRequirements());
-    writeMembers(theClass->getMembers(), true);
+    writeMembers(theClass, theClass->getMembers(), true);
     writeConformances(conformances, DeclTypeAbbrCodes);
     break;
   }
@@ -2374,7 +2432,7 @@ void Serializer::writeDecl(const Decl *D) {
 
     writeGenericParams(proto->getGenericParams(), DeclTypeAbbrCodes);
     writeRequirements(proto->getGenericRequirements());
-    writeMembers(proto->getMembers(), true);
+    writeMembers(proto, proto->getMembers(), true);
     writeDefaultWitnessTable(proto, DeclTypeAbbrCodes);
     break;
   }
@@ -3389,48 +3447,96 @@ void Serializer::writeAllIdentifiers() {
 
 void Serializer::writeOffsets(const index_block::OffsetsLayout &Offsets,
                               const std::vector<BitOffset> &values) {
-  Offsets.emit(ScratchRecord, getOffsetRecordCode(values), values);
+  // Write fixed-width offsets, so that readers can index into the module
+  // file directly rather than decoding the whole array up front.
+  llvm::SmallString<4096> blob;
+  {
+    llvm::raw_svector_ostream blobStream(blob);
+    endian::Writer<little> writer(blobStream);
+    for (auto value : values)
+      writer.write<uint32_t>(value);
+  }
+  Offsets.emit(ScratchRecord, getOffsetRecordCode(values), blob);
 }
 
-/// Writes an in-memory decl table to an on-disk representation, using the
-/// given layout.
+namespace {
+  /// An on-disk hash table that has been encoded but not yet written to the
+  /// bitstream.
+  ///
+  /// Encoding only reads the already-populated in-memory table, so the
+  /// tables of the index block can be encoded concurrently.
+  struct EncodedHashTable {
+    uint32_t TableOffset = 0;
+    llvm::SmallString<4096> Blob;
+  };
+} // end anonymous namespace
+
+/// Encodes the hash table in \p generator into \p encoded.
+template <typename Info>
+static void
+encodeHashTable(llvm::OnDiskChainedHashTableGenerator<Info> &generator,
+                EncodedHashTable &encoded) {
+  llvm::raw_svector_ostream blobStream(encoded.Blob);
+  // Make sure that no bucket is at offset 0
+  endian::Writer<little>(blobStream).write<uint32_t>(0);
+  encoded.TableOffset = generator.Emit(blobStream);
+}
+
+/// Encodes an in-memory decl table into its on-disk representation.
+static void encodeDeclTable(const Serializer::DeclTable &table,
+                            EncodedHashTable &encoded) {
+  llvm::OnDiskChainedHashTableGenerator<DeclTableInfo> generator;
+  for (auto &entry : table)
+    generator.insert(entry.first, entry.second);
+  encodeHashTable(generator, encoded);
+}
+
+/// Encodes the in-memory table of members by name into its on-disk
+/// representation.
+static void encodeDeclMemberTable(const Serializer::DeclMemberTable &table,
+                                  EncodedHashTable &encoded) {
+  llvm::OnDiskChainedHashTableGenerator<DeclMemberTableInfo> generator;
+  for (auto &entry : table)
+    generator.insert(entry.first, entry.second);
+  encodeHashTable(generator, encoded);
+}
+
+/// Writes an encoded decl table using the given layout, unless the in-memory
+/// table it came from was empty.
 static void writeDeclTable(const index_block::DeclListLayout &DeclList,
                            index_block::RecordKind kind,
-                           const Serializer::DeclTable &table) {
-  if (table.empty())
+                           const EncodedHashTable &encoded,
+                           bool isEmpty) {
+  if (isEmpty)
     return;
 
   SmallVector<uint64_t, 8> scratch;
-  llvm::SmallString<4096> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::OnDiskChainedHashTableGenerator<DeclTableInfo> generator;
-    for (auto &entry : table)
-      generator.insert(entry.first, entry.second);
-
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    // Make sure that no bucket is at offset 0
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
-  }
-
-  DeclList.emit(scratch, kind, tableOffset, hashTableBlob);
+  DeclList.emit(scratch, kind, encoded.TableOffset, encoded.Blob);
 }
 
-static void writeLocalDeclTable(const index_block::DeclListLayout &DeclList,
-                                index_block::RecordKind kind,
-                                LocalTypeHashTableGenerator &generator) {
-  SmallVector<uint64_t, 8> scratch;
-  llvm::SmallString<4096> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    // Make sure that no bucket is at offset 0
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
+/// Runs each of \p tasks, spread across up to \p numThreads threads
+/// including the calling one.
+static void runConcurrently(ArrayRef<std::function<void()>> tasks,
+                            unsigned numThreads) {
+  if (numThreads <= 1) {
+    for (auto &task : tasks)
+      task();
+    return;
   }
 
-  DeclList.emit(scratch, kind, tableOffset, hashTableBlob);
+  std::atomic<size_t> nextTask(0);
+  auto worker = [&] {
+    for (size_t i = nextTask++; i < tasks.size(); i = nextTask++)
+      tasks[i]();
+  };
+
+  std::vector<std::thread> threads;
+  unsigned numWorkers = std::min<size_t>(numThreads, tasks.size());
+  for (unsigned i = 1; i < numWorkers; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &thread : threads)
+    thread.join();
 }
 
 namespace {
@@ -3852,8 +3958,9 @@ namespace {
   };
 } // end anonymous namespace
 
-static void writeObjCMethodTable(const index_block::ObjCMethodTableLayout &out,
-                                 Serializer::ObjCMethodTable &objcMethods) {
+static void
+encodeObjCMethodTable(const Serializer::ObjCMethodTable &objcMethods,
+                      EncodedHashTable &encoded) {
   // Collect all of the Objective-C selectors in the method table.
   std::vector<ObjCSelector> selectors;
   for (const auto &entry : objcMethods) {
@@ -3865,21 +3972,9 @@ static void writeObjCMethodTable(const index_block::ObjCMethodTableLayout &out,
 
   // Create the on-disk hash table.
   llvm::OnDiskChainedHashTableGenerator<ObjCMethodTableInfo> generator;
-  llvm::SmallString<32> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    for (auto selector : selectors) {
-      generator.insert(selector, objcMethods[selector]);
-    }
-
-    // Make sure that no bucket is at offset 0
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
-  }
-
-  SmallVector<uint64_t, 8> scratch;
-  out.emit(scratch, tableOffset, hashTableBlob);
+  for (auto selector : selectors)
+    generator.insert(selector, objcMethods.find(selector)->second);
+  encodeHashTable(generator, encoded);
 }
 
 /// Add operator methods from the given declaration type.
@@ -3940,7 +4035,7 @@ static void addOperatorsAndTopLevel(Serializer &S, Range members,
   }
 }
 
-void Serializer::writeAST(ModuleOrSourceFile DC) {
+void Serializer::writeAST(ModuleOrSourceFile DC, unsigned numThreads) {
   DeclTable topLevelDecls, extensionDecls, operatorDecls, operatorMethodDecls;
   ObjCMethodTable objcMethods;
   LocalTypeHashTableGenerator localTypeGenerator;
@@ -4037,18 +4132,47 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
     writeOffsets(Offsets, LocalDeclContextOffsets);
     writeOffsets(Offsets, NormalConformanceOffsets);
 
+    // Every decl and type has an ID by now, so the hash tables can be
+    // encoded independently of each other. Emit them in a fixed order
+    // afterwards to keep the output deterministic.
+    EncodedHashTable topLevelTable, operatorTable, extensionTable,
+      classMembersTable, operatorMethodTable, memberNamesTable,
+      localTypeTable, objcMethodTable;
+    std::function<void()> encoders[] = {
+      [&] { encodeDeclTable(topLevelDecls, topLevelTable); },
+      [&] { encodeDeclTable(operatorDecls, operatorTable); },
+      [&] { encodeDeclTable(extensionDecls, extensionTable); },
+      [&] { encodeDeclTable(ClassMembersByName, classMembersTable); },
+      [&] { encodeDeclTable(operatorMethodDecls, operatorMethodTable); },
+      [&] { encodeDeclMemberTable(MembersByName, memberNamesTable); },
+      [&] {
+        if (hasLocalTypes)
+          encodeHashTable(localTypeGenerator, localTypeTable);
+      },
+      [&] { encodeObjCMethodTable(objcMethods, objcMethodTable); },
+    };
+    runConcurrently(encoders, numThreads);
+
     index_block::DeclListLayout DeclList(Out);
-    writeDeclTable(DeclList, index_block::TOP_LEVEL_DECLS, topLevelDecls);
-    writeDeclTable(DeclList, index_block::OPERATORS, operatorDecls);
-    writeDeclTable(DeclList, index_block::EXTENSIONS, extensionDecls);
-    writeDeclTable(DeclList, index_block::CLASS_MEMBERS, ClassMembersByName);
-    writeDeclTable(DeclList, index_block::OPERATOR_METHODS, operatorMethodDecls);
-    if (hasLocalTypes)
-      writeLocalDeclTable(DeclList, index_block::LOCAL_TYPE_DECLS,
-                          localTypeGenerator);
+    writeDeclTable(DeclList, index_block::TOP_LEVEL_DECLS, topLevelTable,
+                   topLevelDecls.empty());
+    writeDeclTable(DeclList, index_block::OPERATORS, operatorTable,
+                   operatorDecls.empty());
+    writeDeclTable(DeclList, index_block::EXTENSIONS, extensionTable,
+                   extensionDecls.empty());
+    writeDeclTable(DeclList, index_block::CLASS_MEMBERS, classMembersTable,
+                   ClassMembersByName.empty());
+    writeDeclTable(DeclList, index_block::OPERATOR_METHODS,
+                   operatorMethodTable, operatorMethodDecls.empty());
+    writeDeclTable(DeclList, index_block::DECL_MEMBER_NAMES, memberNamesTable,
+                   MembersByName.empty());
+    writeDeclTable(DeclList, index_block::LOCAL_TYPE_DECLS, localTypeTable,
+                   !hasLocalTypes);
 
     index_block::ObjCMethodTableLayout ObjCMethodTable(Out);
-    writeObjCMethodTable(ObjCMethodTable, objcMethods);
+    SmallVector<uint64_t, 8> scratch;
+    ObjCMethodTable.emit(scratch, objcMethodTable.TableOffset,
+                         objcMethodTable.Blob);
 
     if (entryPointClassID.hasValue()) {
       index_block::EntryPointLayout EntryPoint(Out);
@@ -4086,7 +4210,7 @@ void Serializer::writeToStream(raw_ostream &os, ModuleOrSourceFile DC,
     S.writeHeader(options);
     S.writeInputBlock(options);
     S.writeSIL(SILMod, options.SerializeAllSIL);
-    S.writeAST(DC);
+    S.writeAST(DC, options.NumThreads);
   }
 
   S.writeToStream(os);
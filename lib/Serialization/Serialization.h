@@ -113,6 +113,11 @@ public:
   /// table.
   using DeclTable = llvm::MapVector<Identifier, DeclTableData>;
 
+  using DeclMemberTableData = SmallVector<std::pair<DeclID, DeclID>, 4>;
+  /// The in-memory representation of what will eventually be an on-disk hash
+  /// table of members, keyed by name, along with the contexts they are in.
+  using DeclMemberTable = llvm::MapVector<Identifier, DeclMemberTableData>;
+
   /// Returns the declaration the given generic parameter list is associated
   /// with.
   const Decl *getGenericContext(const GenericParamList *paramList);
@@ -129,6 +134,12 @@ private:
   /// This is used for id-style lookup.
   DeclTable ClassMembersByName;
 
+  /// A map from identifiers to the members of nominal types and extensions
+  /// with the given name, and the IDs of the types and extensions.
+  ///
+  /// This is used to load only the members with a particular name.
+  DeclMemberTable MembersByName;
+
   /// The queue of types and decls that need to be serialized.
   ///
   /// This is a queue and not simply a vector because serializing one
@@ -254,10 +265,11 @@ private:
 
   /// Writes an array of members for a decl context.
   ///
+  /// \param parent The nominal type or extension containing the members
   /// \param members The decls within the context
   /// \param isClass True if the context could be a class context (class,
   ///        class extension, or protocol).
-  void writeMembers(DeclRange members, bool isClass);
+  void writeMembers(const Decl *parent, DeclRange members, bool isClass);
 
   /// Write a default witness table for a protocol.
   ///
@@ -330,7 +342,10 @@ private:
   void writeSIL(const SILModule *M, bool serializeAllSIL);
 
   /// Top-level entry point for serializing a module.
-  void writeAST(ModuleOrSourceFile DC);
+  ///
+  /// \param numThreads The number of threads that may be used to encode the
+  /// module's lookup tables.
+  void writeAST(ModuleOrSourceFile DC, unsigned numThreads = 0);
 
   void writeToStream(raw_ostream &os);
 
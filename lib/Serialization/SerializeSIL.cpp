@@ -351,12 +351,21 @@ void SILSerializer::writeSILFunction(const SILFunction &F, bool DeclOnly) {
     clangNodeOwnerID = S.addDeclRef(F.getClangNodeOwner());
 
   unsigned numSpecAttrs = NoBody ? 0 : F.getSpecializeAttrs().size();
+
+  // Record the size of the body, so that readers can judge whether it's
+  // worth loading.
+  unsigned bodySize = 0;
+  if (!NoBody)
+    for (const SILBasicBlock &BB : F)
+      bodySize += std::distance(BB.begin(), BB.end());
+
   SILFunctionLayout::emitRecord(
       Out, ScratchRecord, abbrCode, toStableSILLinkage(Linkage),
       (unsigned)F.isTransparent(), (unsigned)F.isFragile(),
       (unsigned)F.isThunk(), (unsigned)F.isGlobalInit(),
       (unsigned)F.getInlineStrategy(), (unsigned)F.getEffectsKind(),
-      (unsigned)numSpecAttrs, FnID, clangNodeOwnerID, SemanticsIDs);
+      (unsigned)numSpecAttrs, bodySize, FnID, clangNodeOwnerID,
+      SemanticsIDs);
 
   if (NoBody)
     return;
@@ -1868,6 +1877,12 @@ void SILSerializer::writeSILBlock(const SILModule *SILMod) {
 
     addMandatorySILFunction(&F, emitDeclarationsForOnoneSupport);
     processSILFunctionWorklist();
+
+    // Exported specializations are only serialized as declarations, so that
+    // importing modules can find and call them.
+    if (SILMod->getOptions().ExportSpecializations && F.isKeepAsPublic() &&
+        hasPublicVisibility(F.getLinkage()) && !F.isExternalDeclaration())
+      addReferencedSILFunction(&F, /*DeclOnly*/ true);
   }
 
   // Now write function declarations for every function we've
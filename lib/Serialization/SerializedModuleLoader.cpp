@@ -44,10 +44,16 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
                 llvm::SmallVectorImpl<char> &Scratch) {
   // Try to open the module file first.  If we fail, don't even look for the
   // module documentation file.
+  //
+  // Neither file needs a null terminator, which lets the buffers be mapped
+  // read-only (and shared with other processes) rather than copied into
+  // memory.
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()),
+                                /*FileSize=*/-1,
+                                /*RequiresNullTerminator=*/false);
   if (!ModuleOrErr)
     return ModuleOrErr.getError();
 
@@ -56,7 +62,9 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleDocFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleDocOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()),
+                                /*FileSize=*/-1,
+                                /*RequiresNullTerminator=*/false);
   if (!ModuleDocOrErr &&
       ModuleDocOrErr.getError() != std::errc::no_such_file_or_directory) {
     return ModuleDocOrErr.getError();
@@ -67,11 +75,29 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   return std::error_code();
 }
 
-static std::error_code
-findModule(ASTContext &ctx, AccessPathElem moduleID,
-           std::unique_ptr<llvm::MemoryBuffer> &moduleBuffer,
-           std::unique_ptr<llvm::MemoryBuffer> &moduleDocBuffer,
-           bool &isFramework) {
+bool SerializedModuleLoader::searchPathMayContain(StringRef directory,
+                                                  StringRef name) {
+  if (!ReadModuleLocationMap) {
+    ReadModuleLocationMap = true;
+    StringRef mapPath = Ctx.SearchPathOpts.ModuleLocationMapPath;
+    if (!mapPath.empty()) {
+      // A map which can't be used only means that the directories have to be
+      // listed here.
+      auto mapOrErr = llvm::MemoryBuffer::getFile(mapPath);
+      if (mapOrErr)
+        SearchPathContents.read(mapOrErr.get()->getBuffer());
+    }
+  }
+
+  SearchPathContents.addDirectory(directory);
+  return SearchPathContents.mayContain(directory, name);
+}
+
+std::error_code SerializedModuleLoader::findModule(
+    AccessPathElem moduleID,
+    std::unique_ptr<llvm::MemoryBuffer> &moduleBuffer,
+    std::unique_ptr<llvm::MemoryBuffer> &moduleDocBuffer,
+    bool &isFramework) {
   llvm::SmallString<64> moduleFilename(moduleID.first.str());
   moduleFilename += '.';
   moduleFilename += SERIALIZED_MODULE_EXTENSION;
@@ -83,7 +109,7 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
   // FIXME: Which name should we be using here? Do we care about CPU subtypes?
   // FIXME: At the very least, don't hardcode "arch".
   llvm::SmallString<16> archFile{
-      ctx.LangOpts.getPlatformConditionValue("arch")};
+      Ctx.LangOpts.getPlatformConditionValue("arch")};
   llvm::SmallString<16> archDocFile{archFile};
   if (!archFile.empty()) {
     archFile += '.';
@@ -97,7 +123,9 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
   llvm::SmallString<128> currPath;
 
   isFramework = false;
-  for (auto path : ctx.SearchPathOpts.ImportSearchPaths) {
+  for (auto path : Ctx.SearchPathOpts.ImportSearchPaths) {
+    if (!searchPathMayContain(path, moduleFilename))
+      continue;
     auto err = openModuleFiles(path,
                                moduleFilename.str(), moduleDocFilename.str(),
                                moduleBuffer, moduleDocBuffer,
@@ -119,7 +147,9 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
     moduleFramework += ".framework";
     isFramework = true;
 
-    for (auto path : ctx.SearchPathOpts.FrameworkSearchPaths) {
+    for (auto path : Ctx.SearchPathOpts.FrameworkSearchPaths) {
+      if (!searchPathMayContain(path, moduleFramework))
+        continue;
       currPath = path;
       llvm::sys::path::append(currPath, moduleFramework.str(),
                               "Modules", moduleFilename.str());
@@ -133,12 +163,15 @@ findModule(ASTContext &ctx, AccessPathElem moduleID,
   }
 
   // If we're not allowed to look in the runtime library import path, stop.
-  if (ctx.SearchPathOpts.SkipRuntimeLibraryImportPath)
+  if (Ctx.SearchPathOpts.SkipRuntimeLibraryImportPath)
     return std::make_error_code(std::errc::no_such_file_or_directory);
 
   // Search the runtime import path.
   isFramework = false;
-  return openModuleFiles(ctx.SearchPathOpts.RuntimeLibraryImportPath,
+  if (!searchPathMayContain(Ctx.SearchPathOpts.RuntimeLibraryImportPath,
+                            moduleFilename))
+    return std::make_error_code(std::errc::no_such_file_or_directory);
+  return openModuleFiles(Ctx.SearchPathOpts.RuntimeLibraryImportPath,
                          moduleFilename.str(), moduleDocFilename.str(),
                          moduleBuffer, moduleDocBuffer, scratch);
 }
@@ -378,7 +411,7 @@ Module *SerializedModuleLoader::loadModule(SourceLoc importLoc,
 
   // Otherwise look on disk.
   if (!moduleInputBuffer) {
-    if (std::error_code err = findModule(Ctx, moduleID, moduleInputBuffer,
+    if (std::error_code err = findModule(moduleID, moduleInputBuffer,
                                          moduleDocInputBuffer,
                                          isFramework)) {
       if (err != std::errc::no_such_file_or_directory) {
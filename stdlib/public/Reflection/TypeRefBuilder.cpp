@@ -28,6 +28,11 @@ using namespace reflection;
 
 TypeRefBuilder::TypeRefBuilder() : TC(*this) {}
 
+TypeRefBuilder::~TypeRefBuilder() {
+  for (auto TR : TypeRefPool)
+    TR->~TypeRef();
+}
+
 const AssociatedTypeDescriptor * TypeRefBuilder::
 lookupAssociatedTypes(const std::string &MangledTypeName,
                       const DependentMemberTypeRef *DependentMember) {
@@ -226,9 +231,15 @@ TypeRefBuilder::dumpTypeRef(const std::string &MangledName,
   OS << '\n';
 }
 
-void TypeRefBuilder::dumpFieldSection(std::ostream &OS) {
+void TypeRefBuilder::dumpFieldSection(std::ostream &OS, size_t Begin,
+                                      size_t End) {
+  size_t Index = 0;
   for (const auto &sections : ReflectionInfos) {
     for (const auto &descriptor : sections.fieldmd) {
+      if (Index >= End)
+        return;
+      if (Index++ < Begin)
+        continue;
       auto TypeName
         = Demangle::demangleTypeAsString(descriptor.getMangledTypeName());
       OS << TypeName << '\n';
@@ -248,9 +259,15 @@ void TypeRefBuilder::dumpFieldSection(std::ostream &OS) {
   }
 }
 
-void TypeRefBuilder::dumpAssociatedTypeSection(std::ostream &OS) {
+void TypeRefBuilder::dumpAssociatedTypeSection(std::ostream &OS, size_t Begin,
+                                               size_t End) {
+  size_t Index = 0;
   for (const auto &sections : ReflectionInfos) {
     for (const auto &descriptor : sections.assocty) {
+      if (Index >= End)
+        return;
+      if (Index++ < Begin)
+        continue;
       auto conformingTypeName = Demangle::demangleTypeAsString(
         descriptor.getMangledConformingTypeName());
       auto protocolName = Demangle::demangleTypeAsString(
@@ -267,9 +284,15 @@ void TypeRefBuilder::dumpAssociatedTypeSection(std::ostream &OS) {
   }
 }
 
-void TypeRefBuilder::dumpBuiltinTypeSection(std::ostream &OS) {
+void TypeRefBuilder::dumpBuiltinTypeSection(std::ostream &OS, size_t Begin,
+                                            size_t End) {
+  size_t Index = 0;
   for (const auto &sections : ReflectionInfos) {
     for (const auto &descriptor : sections.builtin) {
+      if (Index >= End)
+        return;
+      if (Index++ < Begin)
+        continue;
       auto typeName = Demangle::demangleTypeAsString(
         descriptor.getMangledTypeName());
 
@@ -308,9 +331,15 @@ void ClosureContextInfo::dump(std::ostream &OS) const {
   OS << "\n";
 }
 
-void TypeRefBuilder::dumpCaptureSection(std::ostream &OS) {
+void TypeRefBuilder::dumpCaptureSection(std::ostream &OS, size_t Begin,
+                                        size_t End) {
+  size_t Index = 0;
   for (const auto &sections : ReflectionInfos) {
     for (const auto &descriptor : sections.capture) {
+      if (Index >= End)
+        return;
+      if (Index++ < Begin)
+        continue;
       auto info = getClosureContextInfo(descriptor);
       info.dump(OS);
     }
@@ -39,6 +39,11 @@ struct _SwiftEmptyArrayStorage {
 extern SWIFT_RUNTIME_STDLIB_INTERFACE
 struct _SwiftEmptyArrayStorage _swiftEmptyArrayStorage;
 
+/// The storage of the strings of one ASCII character, which String shares
+/// instead of allocating. Character c is at offset 2 * c, followed by a NUL.
+extern SWIFT_RUNTIME_STDLIB_INTERFACE
+__swift_uint8_t _swift_stdlib_singleASCIIStringStorage[256];
+
 extern SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_uint64_t _swift_stdlib_HashingDetail_fixedSeedOverride;
 
@@ -56,15 +56,22 @@ class StrongRefCount {
   // The next bit is the deallocating marker.
   // The remaining bits are the reference count.
   // refCount == RC_ONE means reference count == 1.
+  //
+  // An object whose top bit is set is immortal: it is never deallocated,
+  // and retains and releases of it leave the reference count untouched so
+  // that objects shared by every thread don't bounce between caches.
   enum : uint32_t {
     RC_PINNED_FLAG = 0x1,
     RC_DEALLOCATING_FLAG = 0x2,
+    RC_IMMORTAL_FLAG = 0x80000000,
 
     RC_FLAGS_COUNT = 2,
     RC_FLAGS_MASK = 3,
     RC_COUNT_MASK = ~RC_FLAGS_MASK,
 
-    RC_ONE = RC_FLAGS_MASK + 1
+    RC_ONE = RC_FLAGS_MASK + 1,
+
+    RC_IMMORTAL_VALUE = RC_IMMORTAL_FLAG | RC_ONE
   };
 
   static_assert(RC_ONE == RC_DEALLOCATING_FLAG << 1,
@@ -76,6 +83,7 @@ class StrongRefCount {
 
  public:
   enum Initialized_t { Initialized };
+  enum Immortal_t { Immortal };
 
   // StrongRefCount must be trivially constructible to avoid ObjC++
   // destruction overhead at runtime. Use StrongRefCount(Initialized) to produce
@@ -86,28 +94,46 @@ class StrongRefCount {
   constexpr StrongRefCount(Initialized_t)
     : refCount(RC_ONE) { }
 
+  // Refcount of a statically-allocated object that is never deallocated.
+  constexpr StrongRefCount(Immortal_t)
+    : refCount(RC_IMMORTAL_VALUE) { }
+
   void init() {
     refCount = RC_ONE;
   }
 
+  // Return true if the object is immortal. Immortality is set when the
+  // object is created and never changes afterwards.
+  bool isImmortal() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_IMMORTAL_FLAG;
+  }
+
   // Increment the reference count.
   void increment() {
+    if (isImmortal())
+      return;
     __atomic_fetch_add(&refCount, RC_ONE, __ATOMIC_RELAXED);
   }
 
   void incrementNonAtomic() {
     uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    if (val & RC_IMMORTAL_FLAG)
+      return;
     val += RC_ONE;
     __atomic_store_n(&refCount, val, __ATOMIC_RELAXED);
   }
 
   // Increment the reference count by n.
   void increment(uint32_t n) {
+    if (isImmortal())
+      return;
     __atomic_fetch_add(&refCount, n << RC_FLAGS_COUNT, __ATOMIC_RELAXED);
   }
 
   void incrementNonAtomic(uint32_t n) {
     uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    if (val & RC_IMMORTAL_FLAG)
+      return;
     val += n << RC_FLAGS_COUNT;
     __atomic_store_n(&refCount, val, __ATOMIC_RELAXED);
  }
@@ -124,8 +150,9 @@ class StrongRefCount {
   bool tryIncrementAndPin() {
     uint32_t oldval = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
     while (true) {
-      // If the flag is already set, just fail.
-      if (oldval & RC_PINNED_FLAG) {
+      // If the flag is already set, just fail. Immortal objects are never
+      // pinned, so they fail too.
+      if (oldval & (RC_PINNED_FLAG | RC_IMMORTAL_FLAG)) {
         return false;
       }
 
@@ -142,8 +169,9 @@ class StrongRefCount {
 
   bool tryIncrementAndPinNonAtomic() {
     uint32_t oldval = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
-    // If the flag is already set, just fail.
-    if (oldval & RC_PINNED_FLAG) {
+    // If the flag is already set, just fail. Immortal objects are never
+    // pinned, so they fail too.
+    if (oldval & (RC_PINNED_FLAG | RC_IMMORTAL_FLAG)) {
       return false;
     }
 
@@ -154,14 +182,26 @@ class StrongRefCount {
   }
 
   // Increment the reference count, unless the object is deallocating.
+  //
+  // An object whose count has dropped to zero is about to be deallocated
+  // even if the deallocating flag isn't set yet, and must not be revived:
+  // its memory can be freed as soon as the flag is set, while the thread
+  // that released it is still setting the flag.
   bool tryIncrement() {
-    // FIXME: this could be better on LL/SC architectures like arm64
-    uint32_t oldval = __atomic_fetch_add(&refCount, RC_ONE, __ATOMIC_RELAXED);
-    if (oldval & RC_DEALLOCATING_FLAG) {
-      __atomic_fetch_sub(&refCount, RC_ONE, __ATOMIC_RELAXED);
-      return false;
-    } else {
-      return true;
+    uint32_t oldval = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    while (true) {
+      if (oldval & RC_IMMORTAL_FLAG)
+        return true;
+      if ((oldval & RC_DEALLOCATING_FLAG) || !(oldval & RC_COUNT_MASK))
+        return false;
+
+      uint32_t newval = oldval + RC_ONE;
+      if (__atomic_compare_exchange(&refCount, &oldval, &newval, 0,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        return true;
+      }
+
+      // Try again; oldval has been updated with the value we saw.
     }
   }
 
@@ -215,6 +255,12 @@ class StrongRefCount {
     return getCount() == 1;
   }
 
+  // Return whether the reference count is exactly 1 and no flag is set:
+  // the object is neither pinned, immortal nor being deallocated.
+  bool isUniquelyReferencedAndUnflagged() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) == RC_ONE;
+  }
+
   // Return whether the reference count is exactly 1 or the pin flag
   // is set.  During deallocation the reference count is undefined.
   bool isUniquelyReferencedOrPinned() const {
@@ -244,6 +290,8 @@ private:
     // it's already set.
     constexpr uint32_t quantum =
       (ClearPinnedFlag ? RC_ONE + RC_PINNED_FLAG : RC_ONE);
+    if (isImmortal())
+      return false;
     uint32_t newval = __atomic_sub_fetch(&refCount, quantum, __ATOMIC_RELEASE);
 
     assert((!ClearPinnedFlag || !(newval & RC_PINNED_FLAG)) &&
@@ -282,6 +330,8 @@ private:
     constexpr uint32_t quantum =
       (ClearPinnedFlag ? RC_ONE + RC_PINNED_FLAG : RC_ONE);
     uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    if (val & RC_IMMORTAL_FLAG)
+      return false;
     val -= quantum;
     __atomic_store_n(&refCount, val, __ATOMIC_RELEASE);
     uint32_t newval = refCount;
@@ -320,6 +370,8 @@ private:
     // If we're being asked to clear the pinned flag, we can assume
     // it's already set.
     uint32_t delta = (n << RC_FLAGS_COUNT) + (ClearPinnedFlag ? RC_PINNED_FLAG : 0);
+    if (isImmortal())
+      return false;
     uint32_t newval = __atomic_sub_fetch(&refCount, delta, __ATOMIC_RELEASE);
 
     assert((!ClearPinnedFlag || !(newval & RC_PINNED_FLAG)) &&
@@ -357,6 +409,8 @@ private:
     // it's already set.
     uint32_t delta = (n << RC_FLAGS_COUNT) + (ClearPinnedFlag ? RC_PINNED_FLAG : 0);
     uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    if (val & RC_IMMORTAL_FLAG)
+      return false;
     val -= delta;
     __atomic_store_n(&refCount, val, __ATOMIC_RELEASE);
     uint32_t newval = val;
@@ -397,9 +451,10 @@ private:
 class WeakRefCount {
   uint32_t refCount;
 
+  // The low bit is set once the object has a weak reference side table.
+  // The remaining bits are the reference count.
   enum : uint32_t {
-    // There isn't really a flag here.
-    RC_UNUSED_FLAG = 1,
+    RC_SIDE_TABLE_FLAG = 1,
 
     RC_FLAGS_COUNT = 1,
     RC_FLAGS_MASK = 1,
@@ -471,8 +526,20 @@ class WeakRefCount {
     return (oldval & RC_COUNT_MASK) == subval;
   }
 
+  // Record that the object has a weak reference side table.
+  void setHasSideTable() {
+    __atomic_fetch_or(&refCount, RC_SIDE_TABLE_FLAG, __ATOMIC_RELAXED);
+  }
+
+  // Return true if the object has a weak reference side table.
+  bool hasSideTable() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_SIDE_TABLE_FLAG;
+  }
+
   // Return weak reference count.
-  // Note that this is not equal to the number of outstanding weak pointers.
+  // Note that this is not equal to the number of outstanding weak pointers:
+  // it counts unowned references, and weak references only hold the side
+  // table.
   uint32_t getCount() const {
     return __atomic_load_n(&refCount, __ATOMIC_RELAXED) >> RC_FLAGS_COUNT;
   }
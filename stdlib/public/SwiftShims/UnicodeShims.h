@@ -86,6 +86,21 @@ SWIFT_RUNTIME_STDLIB_INTERFACE
 __attribute__((__pure__)) __swift_intptr_t
 _swift_stdlib_unicode_hash_ascii(const char *Str, __swift_int32_t Length);
 
+/// Checks that the buffer holds well-formed UTF-8, and if it does, stores
+/// the number of UTF-16 code units that it transcodes to. The buffer holds
+/// only ASCII exactly when that number is \p Length.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+bool _swift_stdlib_unicode_measureUTF8(const __swift_uint8_t *Str,
+                                       __swift_intptr_t Length,
+                                       __swift_intptr_t *UTF16Length);
+
+/// Transcodes well-formed UTF-8 to UTF-16. \p Dest must have room for the
+/// number of code units reported by _swift_stdlib_unicode_measureUTF8.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+void _swift_stdlib_unicode_transcodeUTF8ToUTF16(const __swift_uint8_t *Src,
+                                                __swift_intptr_t Length,
+                                                __swift_uint16_t *Dest);
+
 SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_int32_t _swift_stdlib_unicode_strToUpper(
   __swift_uint16_t *Destination, __swift_int32_t DestinationCapacity,
@@ -137,6 +137,14 @@ extension _ArrayBuffer {
     return nil
   }
 
+  /// Always returns `false`: storage that may be shared with Objective-C
+  /// can't move.
+  internal mutating func _tryReallocateUniqueBuffer(
+    minimumCapacity: Int
+  ) -> Bool {
+    return false
+  }
+
   public mutating func isMutableAndUniquelyReferenced() -> Bool {
     return isUniquelyReferenced()
   }
@@ -140,6 +140,10 @@ public struct OpaquePointer : Equatable, Hashable {
   public var hashValue: Int {
     return Int(Builtin.ptrtoint_Word(_rawValue))
   }
+
+  public var _mixedHashValue: Int {
+    return _mixIntFast(hashValue)
+  }
 }
 
 extension OpaquePointer : CustomDebugStringConvertible {
@@ -368,6 +368,11 @@ extension String {
     switch c._representation {
     case let .small(_63bits):
       let value = Character._smallValue(_63bits)
+      if Bool(Builtin.cmp_uge_Int63(_63bits, _minASCIICharReprBuiltin)) {
+        self = String(
+          _StringCore(_singleASCII: UTF8.CodeUnit(truncatingBitPattern: value)))
+        return
+      }
       let smallUTF8 = Character._SmallUTF8(value)
       self = String._fromWellFormedCodeUnitSequence(
         UTF8.self, input: smallUTF8)
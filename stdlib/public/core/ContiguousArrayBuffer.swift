@@ -182,6 +182,11 @@ final class _ContiguousArrayStorage<Element> : _ContiguousArrayStorage1 {
   }
 }
 
+@_silgen_name("swift_reallocUniqueObject")
+internal func _swift_reallocUniqueObject(
+  _ object: Builtin.NativeObject, size: Int, alignmentMask: Int
+) -> Builtin.NativeObject
+
 @_fixed_layout
 public struct _ContiguousArrayBuffer<Element> : _ArrayBufferProtocol {
 
@@ -300,6 +305,44 @@ public struct _ContiguousArrayBuffer<Element> : _ArrayBufferProtocol {
     return nil
   }
 
+  /// Grows the storage to hold at least `minimumCapacity` elements by
+  /// reallocating it, which the allocator can often do in place, instead of
+  /// copying the elements to a new buffer. Returns `false`, leaving the
+  /// buffer as it was, if the runtime can't reallocate the storage.
+  ///
+  /// - Precondition: The buffer is uniquely referenced and its elements are
+  ///   POD.
+  internal mutating func _tryReallocateUniqueBuffer(
+    minimumCapacity: Int
+  ) -> Bool {
+    _sanityCheck(_isPOD(Element.self))
+    _sanityCheck(isUniquelyReferenced())
+    // The empty array storage is a static object.
+    if capacity == 0 {
+      return false
+    }
+
+    typealias Storage = ManagedBufferPointer<_ArrayBody, Element>
+    let requiredSize = Storage._elementOffset
+      + minimumCapacity * strideof(Element.self)
+
+    // Hand our reference to the runtime and take back the one it returns,
+    // which may be to an object at a new address.
+    let address = Builtin.addressof(&__bufferPointer._nativeBuffer)
+    let object: Builtin.NativeObject = Builtin.take(address)
+    Builtin.initialize(
+      _swift_reallocUniqueObject(
+        object, size: requiredSize, alignmentMask: Storage._alignmentMask),
+      address)
+
+    let newCapacity = __bufferPointer.capacity
+    if newCapacity < minimumCapacity {
+      return false
+    }
+    _initStorageHeader(count: count, capacity: newCapacity)
+    return true
+  }
+
   public mutating func isMutableAndUniquelyReferenced() -> Bool {
     return isUniquelyReferenced()
   }
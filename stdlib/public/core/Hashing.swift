@@ -126,6 +126,51 @@ func _mixInt(_ value: Int) -> Int {
 #endif
 }
 
+/// Mixes the bits of `value` with a single multiplication, for types whose
+/// hash value is simply their value, such as integers and pointers.
+///
+/// Multiplying by an odd constant spreads every bit of the input over the
+/// high bits of the product; swapping the bytes brings those down to the low
+/// bits, which are the ones that select a bucket in a hash table whose size
+/// is a power of two.  This is much cheaper than `_mixInt`, at the price of
+/// weaker avalanche: keys that differ only in their top few bits fall into
+/// the same few buckets of a small table.
+@_transparent
+public // @testable
+func _mixIntFast(_ value: Int) -> Int {
+  let seed: UInt64 = _HashingDetail.getExecutionSeed()
+#if arch(i386) || arch(arm)
+  let product = (UInt32(bitPattern: Int32(value)) ^
+    UInt32(truncatingBitPattern: seed)) &* 0x9e37_79b9
+  return Int(Int32(bitPattern: product.byteSwapped))
+#elseif arch(x86_64) || arch(arm64) || arch(powerpc64) || arch(powerpc64le) || arch(s390x)
+  let product = (UInt64(bitPattern: Int64(value)) ^ seed) &*
+    0x9e37_79b9_7f4a_7c15
+  return Int(Int64(bitPattern: product.byteSwapped))
+#endif
+}
+
+/// Returns the tag that marks the entry of a key with the given mixed hash
+/// value in a Dictionary or Set, with its high bit set.
+///
+/// The low bits of the mixed hash value select the bucket, and the top bits
+/// left by `_mixIntFast` only depend on the low byte of the key, which is the
+/// same for all aligned pointers.  Multiplying by an odd constant makes the
+/// top bits depend on every bit of the mixed hash value.
+@_transparent
+public // @testable
+func _hashTag(_ mixedHashValue: Int) -> UInt8 {
+  let product = UInt(bitPattern: mixedHashValue) &* 0x9e37_79b9
+  return UInt8(truncatingBitPattern:
+    product >> UInt(8 * sizeof(UInt.self) - 7)) | 0x80
+}
+
+extension Hashable {
+  public var _mixedHashValue: Int {
+    return _mixInt(hashValue)
+  }
+}
+
 /// Given a hash value, returns an integer value within the given range that
 /// corresponds to a hash value.
 ///
@@ -1063,6 +1063,14 @@ public protocol Hashable : Equatable {
   /// Hash values are not guaranteed to be equal across different executions of
   /// your program. Do not save hash values to use during a future execution.
   var hashValue: Int { get }
+
+  /// The hash value with its bits mixed, for use as an index into a hash
+  /// table whose size is a power of two.
+  ///
+  /// The default implementation mixes `hashValue` with `_mixInt`. Types
+  /// whose hash value is simply their value, such as integers and pointers,
+  /// use the cheaper `_mixIntFast` instead.
+  var _mixedHashValue: Int { get }
 }
 
 //===----------------------------------------------------------------------===//
@@ -40,6 +40,10 @@ public struct ObjectIdentifier : Hashable, Comparable {
     return Int(Builtin.ptrtoint_Word(_value))
   }
 
+  public var _mixedHashValue: Int {
+    return _mixIntFast(hashValue)
+  }
+
   /// Construct an instance that uniquely identifies the class instance `x`.
   public init(_ x: AnyObject) {
     self._value = Builtin.bridgeToRawPointer(x)
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+import SwiftShims
+
 @_versioned
 struct _StringBufferIVars {
   internal init(_elementWidth: Int) {
@@ -91,6 +93,15 @@ public struct _StringBuffer {
     Input : Collection, // Sequence?
     Encoding : UnicodeCodec,
     Input.Iterator.Element == Encoding.CodeUnit {
+    // Well-formed UTF-8 in contiguous memory is validated and transcoded in
+    // bulk by the runtime.
+    if Encoding.self == UTF8.self,
+        let utf8 = input as? UnsafeBufferPointer<UTF8.CodeUnit>,
+        let result = _fromWellFormedUTF8(
+          utf8, minimumCapacity: minimumCapacity) {
+      return (result, false)
+    }
+
     // Determine how many UTF-16 code units we'll need
     let inputStream = input.makeIterator()
     guard let (utf16Count, isAscii) = UTF16.transcodedLength(
@@ -135,6 +146,36 @@ public struct _StringBuffer {
     }
   }
 
+  /// Returns a buffer holding `input` if it is well-formed UTF-8, or nil if
+  /// it isn't and needs to be decoded one scalar at a time.
+  static func _fromWellFormedUTF8(
+    _ input: UnsafeBufferPointer<UTF8.CodeUnit>, minimumCapacity: Int
+  ) -> _StringBuffer? {
+    guard let start = input.baseAddress else {
+      return nil
+    }
+    var utf16Count = 0
+    if !_swift_stdlib_unicode_measureUTF8(start, input.count, &utf16Count) {
+      return nil
+    }
+
+    let isASCII = utf16Count == input.count
+    let result = _StringBuffer(
+        capacity: max(utf16Count, minimumCapacity),
+        initialSize: utf16Count,
+        elementWidth: isASCII ? 1 : 2)
+    if isASCII {
+      _memcpy(
+        dest: UnsafeMutablePointer(result.start),
+        src: UnsafeMutablePointer(start),
+        size: UInt(input.count))
+    } else {
+      _swift_stdlib_unicode_transcodeUTF8ToUTF16(
+        start, input.count, result._storage.baseAddress)
+    }
+    return result
+  }
+
   /// A pointer to the start of this buffer's data area.
   public // @testable
   var start: UnsafeMutablePointer<_RawByte> {
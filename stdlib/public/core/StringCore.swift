@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+import SwiftShims
+
 /// The core implementation of a highly-optimizable String that
 /// can store both ASCII and UTF-16, and can wrap native Swift
 /// _StringBuffer or NSString instances.
@@ -183,6 +185,23 @@ public struct _StringCore {
     _invariantCheck()
   }
 
+  /// Create the implementation of a string holding the single ASCII code
+  /// unit `u`.
+  ///
+  /// The string refers to storage shared by the whole process, so creating
+  /// it allocates nothing and it has no owner to retain.
+  init(_singleASCII u: UTF8.CodeUnit) {
+    _sanityCheck(u < 0x80, "not an ASCII code unit")
+    let storage = UnsafeMutablePointer<UTF8.CodeUnit>(
+      Builtin.addressof(&_swift_stdlib_singleASCIIStringStorage))
+    self = _StringCore(
+      baseAddress: OpaquePointer(storage + 2 * Int(u)),
+      count: 1,
+      elementShift: 0,
+      hasCocoaBuffer: false,
+      owner: nil)
+  }
+
   //===--------------------------------------------------------------------===//
   // Properties
 
@@ -65,6 +65,10 @@ extension String {
 
 extension String {
   public init(_ _c: UnicodeScalar) {
+    if _c.value < 0x80 {
+      self = String(_StringCore(_singleASCII: UTF8.CodeUnit(_c.value)))
+      return
+    }
     self = String(repeating: _c, count: 1)
   }
 }
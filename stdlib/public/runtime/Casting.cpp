@@ -18,12 +18,14 @@
 #include "swift/Basic/Demangle.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Enum.h"
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
-#include "llvm/ADT/DenseMap.h"
+#include "swift/Runtime/Statistics.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/PointerIntPair.h"
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
@@ -314,58 +316,78 @@ static void _buildNameForMetadata(const Metadata *type,
 std::string swift::nameForMetadata(const Metadata *type,
                                    bool qualified) {
   std::string result;
+  // Most names fit, so the builders rarely have to reallocate.
+  result.reserve(64);
   _buildNameForMetadata(type, TypeSyntaxLevel::Type, qualified, result);
   return result;
 }
 
-SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
-extern "C"
-TwoWordPair<const char *, uintptr_t>::Return
-swift_getTypeName(const Metadata *type, bool qualified) {
-  using Pair = TwoWordPair<const char *, uintptr_t>;
-  using Key = llvm::PointerIntPair<const Metadata *, 1, bool>;
+namespace {
+  using TypeNameCacheKey = llvm::PointerIntPair<const Metadata *, 1, bool>;
+
+  /// The name of a type, with the null-terminated name tail-allocated so
+  /// that it lives exactly as long as the cache does.
+  struct TypeNameCacheEntry {
+  private:
+    TypeNameCacheKey Key;
+    size_t Length;
+
+  public:
+    TypeNameCacheEntry(TypeNameCacheKey key, const std::string &name)
+      : Key(key), Length(name.size()) {
+      memcpy(getName(), name.c_str(), Length + 1);
+    }
 
-  static StaticReadWriteLock TypeNameCacheLock;
-  static Lazy<llvm::DenseMap<Key, std::pair<const char *, size_t>>>
-    TypeNameCache;
-  
-  Key key(type, qualified);
-  auto &cache = TypeNameCache.get();
+    char *getName() {
+      return reinterpret_cast<char *>(this + 1);
+    }
+    const char *getName() const {
+      return reinterpret_cast<const char *>(this + 1);
+    }
+    size_t getLength() const { return Length; }
 
-  // Attempt read-only lookup of cache entry.
-  {
-    StaticScopedReadLock guard(TypeNameCacheLock);
+    int compareWithKey(TypeNameCacheKey key) const {
+      if (key != Key)
+        return (uintptr_t(key.getOpaqueValue()) <
+                uintptr_t(Key.getOpaqueValue()) ? -1 : 1);
+      return 0;
+    }
 
-    auto found = cache.find(key);
-    if (found != cache.end()) {
-      auto result = found->second;
-      return Pair{result.first, result.second};
+    long getKeyIntValueForDump() const {
+      return reinterpret_cast<long>(Key.getOpaqueValue());
     }
-  }
 
-  // Read-only lookup failed to find item, we may need to create it.
-  {
-    StaticScopedWriteLock guard(TypeNameCacheLock);
+    static size_t getKeyHash(TypeNameCacheKey key) {
+      return llvm::hash_value(key.getOpaqueValue());
+    }
 
-    // Do lookup again just to make sure it wasn't created by another
-    // thread before we acquired the write lock.
-    auto found = cache.find(key);
-    if (found != cache.end()) {
-      auto result = found->second;
-      return Pair{result.first, result.second};
+    static size_t getExtraAllocationSize(TypeNameCacheKey key,
+                                         const std::string &name) {
+      return name.size() + 1;
     }
+  };
+}
 
-    // Build the metadata name.
-    auto name = nameForMetadata(type, qualified);
-    // Copy it to memory we can reference forever.
-    auto size = name.size();
-    auto result = (char *)malloc(size + 1);
-    memcpy(result, name.data(), size);
-    result[size] = 0;
+/// The names handed out by swift_getTypeName. Lookups don't take a lock, so
+/// asking for the name of the same type again is just a hash table probe.
+static Lazy<ConcurrentMap<TypeNameCacheEntry>> TypeNames;
 
-    cache.insert({key, {result, size}});
-    return Pair{result, size};
-  }
+SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
+extern "C"
+TwoWordPair<const char *, uintptr_t>::Return
+swift_getTypeName(const Metadata *type, bool qualified) {
+  using Pair = TwoWordPair<const char *, uintptr_t>;
+
+  TypeNameCacheKey key(type, qualified);
+  auto &cache = TypeNames.get();
+  if (auto entry = cache.find(key))
+    return Pair{entry->getName(), entry->getLength()};
+
+  // Build the name outside of the map. If another thread races us, the
+  // map keeps whichever entry got there first.
+  auto name = nameForMetadata(type, qualified);
+  auto entry = cache.getOrInsert(key, name).first;
+  return Pair{entry->getName(), entry->getLength()};
 }
 
 /// Report a dynamic cast failure.
@@ -646,6 +668,100 @@ static bool _conformsToProtocols(const OpaqueValue *value,
   return true;
 }
 
+namespace {
+  struct ExistentialCastCacheKey {
+    const Metadata *Type;
+    const ExistentialTypeMetadata *Target;
+  };
+
+  /// A successful cast of a concrete type to an existential type, together
+  /// with the witness tables that the existential container needs. The
+  /// witness tables are tail-allocated.
+  struct ExistentialCastCacheEntry {
+  private:
+    const Metadata *Type;
+    const ExistentialTypeMetadata *Target;
+    unsigned NumWitnessTables;
+
+    const WitnessTable **getWitnessTablesBuffer() {
+      return reinterpret_cast<const WitnessTable **>(this + 1);
+    }
+    const WitnessTable * const *getWitnessTablesBuffer() const {
+      return reinterpret_cast<const WitnessTable * const *>(this + 1);
+    }
+
+  public:
+    ExistentialCastCacheEntry(ExistentialCastCacheKey key,
+                              const WitnessTable * const *witnessTables,
+                              unsigned numWitnessTables)
+      : Type(key.Type), Target(key.Target),
+        NumWitnessTables(numWitnessTables) {
+      memcpy(getWitnessTablesBuffer(), witnessTables,
+             numWitnessTables * sizeof(const WitnessTable *));
+    }
+
+    int compareWithKey(const ExistentialCastCacheKey &key) const {
+      if (key.Type != Type) {
+        return (uintptr_t(key.Type) < uintptr_t(Type) ? -1 : 1);
+      } else if (key.Target != Target) {
+        return (uintptr_t(key.Target) < uintptr_t(Target) ? -1 : 1);
+      } else {
+        return 0;
+      }
+    }
+
+    static size_t getKeyHash(const ExistentialCastCacheKey &key) {
+      return llvm::hash_combine(key.Type, key.Target);
+    }
+
+    static size_t getExtraAllocationSize(const ExistentialCastCacheKey &key,
+                                    const WitnessTable * const *witnessTables,
+                                    unsigned numWitnessTables) {
+      return numWitnessTables * sizeof(const WitnessTable *);
+    }
+
+    void copyWitnessTables(const WitnessTable **conformances) const {
+      memcpy(conformances, getWitnessTablesBuffer(),
+             NumWitnessTables * sizeof(const WitnessTable *));
+    }
+  };
+}
+
+/// Successful casts from a type to an existential. Failures aren't cached,
+/// since images loaded later may add the missing conformances.
+static Lazy<ConcurrentMap<ExistentialCastCacheEntry>> ExistentialCasts;
+
+/// Check whether a type conforms to all of the protocols of the given
+/// existential type, filling in a list of conformances, and remember the
+/// answer for the next cast between the same pair of types.
+static bool _conformsToExistential(const OpaqueValue *value,
+                                   const Metadata *type,
+                                   const ExistentialTypeMetadata *targetType,
+                                   const WitnessTable **conformances) {
+  ExistentialCastCacheKey key{type, targetType};
+  if (auto entry = ExistentialCasts->find(key)) {
+    entry->copyWitnessTables(conformances);
+    return true;
+  }
+
+  if (!_conformsToProtocols(value, type, targetType->Protocols, conformances))
+    return false;
+
+  // Conformance to an Objective-C protocol can depend on the class of the
+  // particular instance, so only cache answers that depend on the type alone.
+  unsigned numWitnessTables = 0;
+  for (unsigned i = 0, n = targetType->Protocols.NumProtocols; i != n; ++i) {
+    const ProtocolDescriptor *protocol = targetType->Protocols[i];
+    if (protocol->Flags.needsWitnessTable())
+      ++numWitnessTables;
+    else if (protocol->Flags.getSpecialProtocol() != SpecialProtocol::AnyObject)
+      return true;
+  }
+
+  ExistentialCasts->getOrInsert(key, conformances, numWitnessTables);
+  return true;
+}
+
 static bool shouldDeallocateSource(bool castSucceeded, DynamicCastFlags flags) {
   return (castSucceeded && (flags & DynamicCastFlags::TakeOnSuccess)) ||
         (!castSucceeded && (flags & DynamicCastFlags::DestroyOnFailure));
@@ -966,9 +1082,8 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
     }
 
     // Check for protocol conformances and fill in the witness tables.
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              destExistential->getWitnessTables())) {
+    if (!_conformsToExistential(srcDynamicValue, srcDynamicType, targetType,
+                                destExistential->getWitnessTables())) {
       return _fail(src, srcType, targetType, flags, srcDynamicType);
     }
 
@@ -985,9 +1100,8 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
       reinterpret_cast<OpaqueExistentialContainer*>(dest);
 
     // Check for protocol conformances and fill in the witness tables.
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              destExistential->getWitnessTables()))
+    if (!_conformsToExistential(srcDynamicValue, srcDynamicType, targetType,
+                                destExistential->getWitnessTables()))
       return _fail(src, srcType, targetType, flags, srcDynamicType);
 
     // Fill in the type and value.
@@ -1009,9 +1123,8 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
     // one we need.
     assert(targetType->Protocols.NumProtocols == 1);
     const WitnessTable *errorWitness;
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              &errorWitness))
+    if (!_conformsToExistential(srcDynamicValue, srcDynamicType, targetType,
+                                &errorWitness))
       return _fail(src, srcType, targetType, flags, srcDynamicType);
     
     BoxPair destBox = swift_allocError(srcDynamicType, errorWitness,
@@ -2049,6 +2162,7 @@ bool swift::swift_dynamicCast(OpaqueValue *dest,
                               const Metadata *targetType,
                               DynamicCastFlags flags)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  countRuntimeStatistic(RuntimeStatistic::DynamicCasts);
   auto unwrapResult = checkDynamicCastFromOptional(dest, src, srcType,
                                                    targetType, flags);
   srcType = unwrapResult.payloadType;
@@ -2484,11 +2598,60 @@ static bool _dynamicCastClassToValueViaObjCBridgeable(
 extern "C" const _ObjectiveCBridgeableWitnessTable
 _TWPVs19_BridgeableMetatypes21_ObjectiveCBridgeables;
 
+namespace {
+  /// A type's conformance to _ObjectiveCBridgeable.
+  class BridgeWitnessCacheEntry {
+    const Metadata *Type;
+
+  public:
+    const _ObjectiveCBridgeableWitnessTable *Witness;
+
+    BridgeWitnessCacheEntry(const Metadata *type,
+                            const _ObjectiveCBridgeableWitnessTable *witness)
+      : Type(type), Witness(witness) {}
+
+    int compareWithKey(const Metadata *type) const {
+      if (type != Type)
+        return (uintptr_t(type) < uintptr_t(Type) ? -1 : 1);
+      return 0;
+    }
+
+    long getKeyIntValueForDump() const {
+      return reinterpret_cast<long>(Type);
+    }
+
+    static size_t getKeyHash(const Metadata *type) {
+      return llvm::hash_value(type);
+    }
+
+    static size_t getExtraAllocationSize(
+                     const Metadata *type,
+                     const _ObjectiveCBridgeableWitnessTable *witness) {
+      return 0;
+    }
+  };
+}
+
+/// The bridge witnesses that have been found. Bridging a collection of
+/// non-verbatim elements looks up the element type's witness once per
+/// element, and this saves each of those lookups from going through the
+/// general conformance cache. Only conformances that were found are
+/// remembered, because images loaded later can add a conformance.
+static Lazy<ConcurrentMap<BridgeWitnessCacheEntry>> BridgeWitnesses;
+
 static const _ObjectiveCBridgeableWitnessTable *
 findBridgeWitness(const Metadata *T) {
+  auto &cache = BridgeWitnesses.get();
+  if (auto entry = cache.find(T))
+    return entry->Witness;
+
   auto w = swift_conformsToProtocol(T, &_TMps21_ObjectiveCBridgeable);
-  if (LLVM_LIKELY(w))
-    return reinterpret_cast<const _ObjectiveCBridgeableWitnessTable *>(w);
+  if (LLVM_LIKELY(w)) {
+    auto witness =
+      reinterpret_cast<const _ObjectiveCBridgeableWitnessTable *>(w);
+    cache.getOrInsert(T, witness);
+    return witness;
+  }
   // Class and ObjC existential metatypes can be bridged, but metatypes can't
   // directly conform to protocols yet. Use a stand-in conformance for a type
   // that looks like a metatype value if the metatype can be bridged.
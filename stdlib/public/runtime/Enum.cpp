@@ -49,29 +49,47 @@ static unsigned getNumTagBytes(size_t size, unsigned emptyCases,
           numTags < 65536 ? 2 : 4);
 }
 
-/// This is a small and fast implementation of memcpy with a constant count. It
-/// should be a performance win for small constant values where the function
-/// can be inlined, the loop unrolled and the memory accesses merged.
-template <unsigned count> static void small_memcpy(void *dest, const void *src) {
-  uint8_t *d8 = (uint8_t*)dest, *s8 = (uint8_t*)src;
-  for (unsigned i = 0; i < count; i++) {
-    *d8++ = *s8++;
+/// The number of extra tag bytes of a single-payload enum whose payload is
+/// \p payloadSize bytes and that has \p extraCases cases not represented by
+/// extra inhabitants. Payloads of four bytes or more, the overwhelmingly
+/// common case, always need exactly one.
+static inline unsigned getNumSinglePayloadTagBytes(size_t payloadSize,
+                                                   unsigned extraCases) {
+  if (LLVM_LIKELY(payloadSize >= 4))
+    return 1;
+  return getNumTagBytes(payloadSize, extraCases, 1 /*payload case*/);
+}
+
+/// Loads a tag that is stored in \p TagTy's size in native byte order.
+template <typename TagTy>
+static inline unsigned loadTag(const void *addr) {
+  TagTy tag;
+  memcpy(&tag, addr, sizeof(TagTy));
+  return tag;
+}
+
+template <typename TagTy>
+static inline void storeTag(void *addr, unsigned tag) {
+  TagTy truncated = tag;
+  memcpy(addr, &truncated, sizeof(TagTy));
+}
+
+static inline unsigned loadTag(const void *addr, unsigned numBytes) {
+  switch (numBytes) {
+  case 1: return loadTag<uint8_t>(addr);
+  case 2: return loadTag<uint16_t>(addr);
+  case 4: return loadTag<uint32_t>(addr);
   }
+  crash("Tagbyte values should be 1, 2 or 4.");
 }
 
-static inline void small_memcpy(void *dest, const void *src, unsigned count) {
-  // This is specialization of the memcpy line below with
-  // specialization for values of 1, 2 and 4.
-  // memcpy(dst, src, count)
-  if (count == 1) {
-    small_memcpy<1>(dest, src);
-  } else if (count == 2) {
-    small_memcpy<2>(dest, src);
-  } else if (count == 4) {
-    small_memcpy<4>(dest, src);
-  } else {
-    crash("Tagbyte values should be 1, 2 or 4.");
+static inline void storeTag(void *addr, unsigned tag, unsigned numBytes) {
+  switch (numBytes) {
+  case 1: return storeTag<uint8_t>(addr, tag);
+  case 2: return storeTag<uint16_t>(addr, tag);
+  case 4: return storeTag<uint32_t>(addr, tag);
   }
+  crash("Tagbyte values should be 1, 2 or 4.");
 }
 
 void
@@ -153,17 +171,9 @@ swift::swift_getEnumCaseSinglePayload(const OpaqueValue *value,
   if (emptyCases > payloadNumExtraInhabitants) {
     auto *valueAddr = reinterpret_cast<const uint8_t*>(value);
     auto *extraTagBitAddr = valueAddr + payloadSize;
-    unsigned extraTagBits = 0;
-    unsigned numBytes = getNumTagBytes(payloadSize,
-                                       emptyCases-payloadNumExtraInhabitants,
-                                       1 /*payload case*/);
-
-#if defined(__BIG_ENDIAN__)
-    small_memcpy(reinterpret_cast<uint8_t*>(&extraTagBits) + 4 - numBytes,
-                 extraTagBitAddr, numBytes);
-#else
-    small_memcpy(&extraTagBits, extraTagBitAddr, numBytes);
-#endif
+    unsigned numBytes = getNumSinglePayloadTagBytes(
+        payloadSize, emptyCases - payloadNumExtraInhabitants);
+    unsigned extraTagBits = loadTag(extraTagBitAddr, numBytes);
 
     // If the extra tag bits are zero, we have a valid payload or
     // extra inhabitant (checked below). If nonzero, form the case index from
@@ -214,8 +224,8 @@ swift::swift_storeEnumTagSinglePayload(OpaqueValue *value,
   auto *valueAddr = reinterpret_cast<uint8_t*>(value);
   auto *extraTagBitAddr = valueAddr + payloadSize;
   unsigned numExtraTagBytes = emptyCases > payloadNumExtraInhabitants
-    ? getNumTagBytes(payloadSize, emptyCases - payloadNumExtraInhabitants,
-                     1 /*payload case*/)
+    ? getNumSinglePayloadTagBytes(payloadSize,
+                                  emptyCases - payloadNumExtraInhabitants)
     : 0;
 
   // For payload or extra inhabitant cases, zero-initialize the extra tag bits,
@@ -263,15 +273,12 @@ swift::swift_storeEnumTagSinglePayload(OpaqueValue *value,
          numPayloadTagBytes);
   if (payloadSize > 4)
     memset(valueAddr + 4, 0, payloadSize - 4);
-  memcpy(extraTagBitAddr,
-         reinterpret_cast<uint8_t*>(&extraTagIndex) + 4 - numExtraTagBytes,
-         numExtraTagBytes);
 #else
   memcpy(valueAddr, &payloadIndex, std::min(size_t(4), payloadSize));
   if (payloadSize > 4)
     memset(valueAddr + 4, 0, payloadSize - 4);
-  memcpy(extraTagBitAddr, &extraTagIndex, numExtraTagBytes);
 #endif
+  storeTag(extraTagBitAddr, extraTagIndex, numExtraTagBytes);
 }
 
 void
@@ -315,130 +322,128 @@ swift::swift_initEnumMetadataMultiPayload(ValueWitnessTable *vwtable,
   installCommonValueWitnesses(vwtable);
 }
 
-namespace {
-struct MultiPayloadLayout {
-  size_t payloadSize;
-  size_t numTagBytes;
-};
-}
-
-static MultiPayloadLayout getMultiPayloadLayout(const EnumMetadata *enumType) {
-  size_t payloadSize = enumType->getPayloadSize();
-  size_t totalSize = enumType->getValueWitnesses()->size;
-  return {payloadSize, totalSize - payloadSize};
-}
-
-static void storeMultiPayloadTag(OpaqueValue *value,
-                                 MultiPayloadLayout layout,
-                                 unsigned tag) {
-  auto tagBytes = reinterpret_cast<char *>(value) + layout.payloadSize;
-#if defined(__BIG_ENDIAN__)
-  small_memcpy(tagBytes,
-               reinterpret_cast<char *>(&tag) + 4 - layout.numTagBytes,
-               layout.numTagBytes);
-#else
-  small_memcpy(tagBytes, &tag, layout.numTagBytes);
-#endif
-}
-
-static void storeMultiPayloadValue(OpaqueValue *value,
-                                   MultiPayloadLayout layout,
+static void storeMultiPayloadValue(OpaqueValue *value, size_t payloadSize,
                                    unsigned payloadValue) {
   auto bytes = reinterpret_cast<char *>(value);
 #if defined(__BIG_ENDIAN__)
   unsigned numPayloadValueBytes =
-      std::min(layout.payloadSize, sizeof(payloadValue));
+      std::min(payloadSize, sizeof(payloadValue));
   memcpy(bytes,
          reinterpret_cast<char *>(&payloadValue) + 4 - numPayloadValueBytes,
          numPayloadValueBytes);
 #else
-  memcpy(bytes, &payloadValue,
-         std::min(layout.payloadSize, sizeof(payloadValue)));
+  memcpy(bytes, &payloadValue, std::min(payloadSize, sizeof(payloadValue)));
 #endif
   // If the payload is larger than the value, zero out the rest.
-  if (layout.payloadSize > sizeof(payloadValue))
+  if (payloadSize > sizeof(payloadValue))
     memset(bytes + sizeof(payloadValue), 0,
-           layout.payloadSize - sizeof(payloadValue));
-}
-
-static unsigned loadMultiPayloadTag(const OpaqueValue *value,
-                                    MultiPayloadLayout layout) {
-  auto tagBytes = reinterpret_cast<const char *>(value) + layout.payloadSize;
-
-  unsigned tag = 0;
-#if defined(__BIG_ENDIAN__)
-  small_memcpy(reinterpret_cast<char *>(&tag) + 4 - layout.numTagBytes,
-               tagBytes, layout.numTagBytes);
-#else
-  small_memcpy(&tag, tagBytes, layout.numTagBytes);
-#endif
-
-  return tag;
+           payloadSize - sizeof(payloadValue));
 }
 
 static unsigned loadMultiPayloadValue(const OpaqueValue *value,
-                                      MultiPayloadLayout layout) {
+                                      size_t payloadSize) {
   auto bytes = reinterpret_cast<const char *>(value);
   unsigned payloadValue = 0;
 #if defined(__BIG_ENDIAN__)
   unsigned numPayloadValueBytes =
-      std::min(layout.payloadSize, sizeof(payloadValue));
+      std::min(payloadSize, sizeof(payloadValue));
   memcpy(reinterpret_cast<char *>(&payloadValue) + 4 - numPayloadValueBytes,
          bytes, numPayloadValueBytes);
 #else
-  memcpy(&payloadValue, bytes,
-         std::min(layout.payloadSize, sizeof(payloadValue)));
+  memcpy(&payloadValue, bytes, std::min(payloadSize, sizeof(payloadValue)));
 #endif
   return payloadValue;
 }
 
+// The tag of a multi-payload enum is stored right after the payload area, in
+// the bytes by which the enum is bigger than its largest payload. The number
+// of tag bytes is fixed when the metadata is initialized, so each entry point
+// reads the payload size and the enum size, which
+// swift_initEnumMetadataMultiPayload stored, and dispatches once to a
+// routine specialized for the width of the tag.
+
+template <typename TagTy>
+static void storeEnumTagMultiPayload(OpaqueValue *value, size_t payloadSize,
+                                     unsigned numPayloads,
+                                     unsigned whichCase) {
+  auto tagBytes = reinterpret_cast<char *>(value) + payloadSize;
+  if (LLVM_LIKELY(whichCase < numPayloads)) {
+    // For a payload case, store the tag after the payload area.
+    storeTag<TagTy>(tagBytes, whichCase);
+    return;
+  }
+
+  // For an empty case, factor out the parts that go in the payload and
+  // tag areas.
+  unsigned whichEmptyCase = whichCase - numPayloads;
+  unsigned whichTag, whichPayloadValue;
+  if (payloadSize >= 4) {
+    whichTag = numPayloads;
+    whichPayloadValue = whichEmptyCase;
+  } else {
+    unsigned numPayloadBits = payloadSize * CHAR_BIT;
+    whichTag = numPayloads + (whichEmptyCase >> numPayloadBits);
+    whichPayloadValue = whichEmptyCase & ((1U << numPayloadBits) - 1U);
+  }
+  storeTag<TagTy>(tagBytes, whichTag);
+  storeMultiPayloadValue(value, payloadSize, whichPayloadValue);
+}
+
+template <typename TagTy>
+static unsigned getEnumCaseMultiPayload(const OpaqueValue *value,
+                                        size_t payloadSize,
+                                        unsigned numPayloads) {
+  auto tagBytes = reinterpret_cast<const char *>(value) + payloadSize;
+  unsigned tag = loadTag<TagTy>(tagBytes);
+  if (LLVM_LIKELY(tag < numPayloads)) {
+    // If the tag indicates a payload, then we're done.
+    return tag;
+  }
+
+  // Otherwise, the other part of the discriminator is in the payload.
+  unsigned payloadValue = loadMultiPayloadValue(value, payloadSize);
+  if (payloadSize >= 4)
+    return numPayloads + payloadValue;
+
+  unsigned numPayloadBits = payloadSize * CHAR_BIT;
+  return (payloadValue | (tag - numPayloads) << numPayloadBits)
+         + numPayloads;
+}
+
 void
 swift::swift_storeEnumTagMultiPayload(OpaqueValue *value,
                                       const EnumMetadata *enumType,
                                       unsigned whichCase) {
-  auto layout = getMultiPayloadLayout(enumType);
+  size_t payloadSize = enumType->getPayloadSize();
+  size_t numTagBytes = enumType->getValueWitnesses()->size - payloadSize;
   unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
-  if (whichCase < numPayloads) {
-    // For a payload case, store the tag after the payload area.
-    storeMultiPayloadTag(value, layout, whichCase);
-  } else {
-    // For an empty case, factor out the parts that go in the payload and
-    // tag areas.
-    unsigned whichEmptyCase = whichCase - numPayloads;
-    unsigned whichTag, whichPayloadValue;
-    if (layout.payloadSize >= 4) {
-      whichTag = numPayloads;
-      whichPayloadValue = whichEmptyCase;
-    } else {
-      unsigned numPayloadBits = layout.payloadSize * CHAR_BIT;
-      whichTag = numPayloads + (whichEmptyCase >> numPayloadBits);
-      whichPayloadValue = whichEmptyCase & ((1U << numPayloads) - 1U);
-    }
-    storeMultiPayloadTag(value, layout, whichTag);
-    storeMultiPayloadValue(value, layout, whichPayloadValue);
+  switch (numTagBytes) {
+  case 1:
+    return storeEnumTagMultiPayload<uint8_t>(value, payloadSize, numPayloads,
+                                             whichCase);
+  case 2:
+    return storeEnumTagMultiPayload<uint16_t>(value, payloadSize, numPayloads,
+                                              whichCase);
+  case 4:
+    return storeEnumTagMultiPayload<uint32_t>(value, payloadSize, numPayloads,
+                                              whichCase);
   }
+  crash("Tagbyte values should be 1, 2 or 4.");
 }
 
 unsigned
 swift::swift_getEnumCaseMultiPayload(const OpaqueValue *value,
                                      const EnumMetadata *enumType) {
-  auto layout = getMultiPayloadLayout(enumType);
+  size_t payloadSize = enumType->getPayloadSize();
+  size_t numTagBytes = enumType->getValueWitnesses()->size - payloadSize;
   unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
-
-  unsigned tag = loadMultiPayloadTag(value, layout);
-  if (tag < numPayloads) {
-    // If the tag indicates a payload, then we're done.
-    return tag;
-  } else {
-    // Otherwise, the other part of the discriminator is in the payload.
-    unsigned payloadValue = loadMultiPayloadValue(value, layout);
-    
-    if (layout.payloadSize >= 4) {
-      return numPayloads + payloadValue;
-    } else {
-      unsigned numPayloadBits = layout.payloadSize * CHAR_BIT;
-      return (payloadValue | (tag - numPayloads) << numPayloadBits)
-             + numPayloads;
-    }
+  switch (numTagBytes) {
+  case 1:
+    return getEnumCaseMultiPayload<uint8_t>(value, payloadSize, numPayloads);
+  case 2:
+    return getEnumCaseMultiPayload<uint16_t>(value, payloadSize, numPayloads);
+  case 4:
+    return getEnumCaseMultiPayload<uint32_t>(value, payloadSize, numPayloads);
   }
+  crash("Tagbyte values should be 1, 2 or 4.");
 }
@@ -18,7 +18,10 @@
 //===----------------------------------------------------------------------===//
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
 #include "swift/Runtime/Debug.h"
+#include "swift/Runtime/HeapObject.h"
 #include "ErrorObject.h"
 #include "Private.h"
 
@@ -26,6 +29,103 @@
 
 using namespace swift;
 
+// Errors are usually thrown and caught on the same thread, and a throwing
+// loop allocates and frees one box per iteration. Small boxes are therefore
+// recycled through a short per-thread list instead of going back to the
+// heap. The leak checker has to see every allocation, so it turns this off.
+#if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
+#define SWIFT_ERROR_BOX_CACHE 0
+#else
+#define SWIFT_ERROR_BOX_CACHE 1
+#endif
+
+#if SWIFT_ERROR_BOX_CACHE
+
+namespace {
+  /// Every recycled box is allocated with this size and alignment, so that
+  /// any of them can hold any small error value.
+  enum : size_t {
+    CachedErrorBoxSize = 64,
+    CachedErrorBoxAlignMask = 15,
+  };
+
+  /// The most boxes a thread keeps around for reuse.
+  enum : unsigned { MaxCachedErrorBoxes = 4 };
+
+  struct ErrorBoxCache {
+    unsigned Count;
+    HeapObject *Boxes[MaxCachedErrorBoxes];
+  };
+} // end anonymous namespace
+
+static void destroyErrorBoxCache(void *ptr) {
+  auto cache = static_cast<ErrorBoxCache *>(ptr);
+  for (unsigned i = 0; i != cache->Count; ++i)
+    swift_slowDealloc(cache->Boxes[i], CachedErrorBoxSize,
+                      CachedErrorBoxAlignMask);
+  free(cache);
+}
+
+static pthread_key_t getErrorBoxCacheKey() {
+  static const pthread_key_t key = [] {
+    pthread_key_t key;
+    if (pthread_key_create(&key, destroyErrorBoxCache) != 0)
+      crash("unable to create error box cache thread key");
+    return key;
+  }();
+  return key;
+}
+
+static ErrorBoxCache *getErrorBoxCache() {
+  auto key = getErrorBoxCacheKey();
+  auto cache = static_cast<ErrorBoxCache *>(pthread_getspecific(key));
+  if (LLVM_LIKELY(cache != nullptr))
+    return cache;
+
+  cache = static_cast<ErrorBoxCache *>(calloc(1, sizeof(ErrorBoxCache)));
+  if (!cache) crash("Could not allocate memory.");
+  pthread_setspecific(key, cache);
+  return cache;
+}
+
+static bool isCachedErrorBoxSize(std::pair<size_t, size_t> sizeAndAlign) {
+  return sizeAndAlign.first <= CachedErrorBoxSize &&
+         sizeAndAlign.second <= CachedErrorBoxAlignMask;
+}
+
+/// Allocate a box from the current thread's cache, or from the heap with the
+/// cached box size if the cache is empty.
+static HeapObject *allocCachedErrorBox(const HeapMetadata *metadata) {
+  auto cache = getErrorBoxCache();
+  if (cache->Count == 0)
+    return swift_allocObject(metadata, CachedErrorBoxSize,
+                             CachedErrorBoxAlignMask);
+
+  auto object = cache->Boxes[--cache->Count];
+  object->metadata = metadata;
+  object->refCount.init();
+  object->weakRefCount.init();
+  return object;
+}
+
+/// Return a dead box to the current thread's cache. Returns false if the
+/// box has to be released through swift_deallocObject instead.
+static bool recycleCachedErrorBox(HeapObject *object) {
+  // Outstanding unowned or weak references keep the memory alive, so only a
+  // box nobody else can observe any more is reusable.
+  if (object->weakRefCount.hasSideTable() ||
+      object->weakRefCount.getCount() != 1)
+    return false;
+
+  auto cache = getErrorBoxCache();
+  if (cache->Count == MaxCachedErrorBoxes)
+    return false;
+  cache->Boxes[cache->Count++] = object;
+  return true;
+}
+
+#endif
+
 /// Determine the size and alignment of an ErrorProtocol box containing the given
 /// type.
 static std::pair<size_t, size_t>
@@ -53,6 +153,13 @@ static void _destroyErrorObject(HeapObject *obj) {
   
   // Deallocate the buffer.
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
+#if SWIFT_ERROR_BOX_CACHE
+  if (isCachedErrorBoxSize(sizeAndAlign)) {
+    if (!recycleCachedErrorBox(obj))
+      swift_deallocObject(obj, CachedErrorBoxSize, CachedErrorBoxAlignMask);
+    return;
+  }
+#endif
   swift_deallocObject(obj, sizeAndAlign.first, sizeAndAlign.second);
 }
 
@@ -71,8 +178,15 @@ swift::swift_allocError(const swift::Metadata *type,
                         bool isTake) {
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
   
+#if SWIFT_ERROR_BOX_CACHE
+  auto allocated = isCachedErrorBoxSize(sizeAndAlign)
+    ? allocCachedErrorBox(&ErrorProtocolMetadata)
+    : swift_allocObject(&ErrorProtocolMetadata,
+                        sizeAndAlign.first, sizeAndAlign.second);
+#else
   auto allocated = swift_allocObject(&ErrorProtocolMetadata,
                                      sizeAndAlign.first, sizeAndAlign.second);
+#endif
   
   auto error = reinterpret_cast<SwiftError*>(allocated);
   
@@ -94,6 +208,13 @@ swift::swift_allocError(const swift::Metadata *type,
 void
 swift::swift_deallocError(SwiftError *error, const Metadata *type) {
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
+#if SWIFT_ERROR_BOX_CACHE
+  if (isCachedErrorBoxSize(sizeAndAlign)) {
+    if (!recycleCachedErrorBox(error))
+      swift_deallocObject(error, CachedErrorBoxSize, CachedErrorBoxAlignMask);
+    return;
+  }
+#endif
   swift_deallocObject(error, sizeAndAlign.first, sizeAndAlign.second);
 }
 
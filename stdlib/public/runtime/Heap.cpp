@@ -17,22 +17,403 @@
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Heap.h"
 #include "Private.h"
+#include "swift/Basic/Lazy.h"
 #include "swift/Runtime/Debug.h"
+#include "swift/Runtime/Mutex.h"
+#include <atomic>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#elif defined(__FreeBSD__)
+#include <malloc_np.h>
+#else
+#include <malloc.h>
+#endif
 
 using namespace swift;
 
+// The alignment that the system malloc guarantees for every allocation.
+#if defined(__APPLE__)
+#define MALLOC_ALIGN_MASK 15
+#else
+#define MALLOC_ALIGN_MASK (2 * sizeof(void*) - 1)
+#endif
+
+// The size-class allocator reserves a large range of address space up front,
+// so it is only available on 64-bit targets with mmap.
+#if defined(__LP64__) && \
+    (defined(__APPLE__) || defined(__linux__) || defined(__FreeBSD__))
+#define SWIFT_SIZE_CLASS_ALLOCATOR_SUPPORTED 1
+#include <pthread.h>
+#include <sys/mman.h>
+#else
+#define SWIFT_SIZE_CLASS_ALLOCATOR_SUPPORTED 0
+#endif
+
+// Whether the size-class allocator is used when the environment doesn't say.
+#ifndef SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR_DEFAULT
+#define SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR_DEFAULT 0
+#endif
+
+static void *systemAlloc(size_t size, size_t alignMask) {
+  void *p;
+  if (alignMask <= MALLOC_ALIGN_MASK) {
+    p = malloc(size);
+  } else if (posix_memalign(&p, alignMask + 1, size) != 0) {
+    p = nullptr;
+  }
+  if (!p) swift::crash("Could not allocate memory.");
+  return p;
+}
+
+#if SWIFT_SIZE_CLASS_ALLOCATOR_SUPPORTED
+
+/// The bounds of the address range reserved by the size-class allocator.
+/// These are only set if the allocator is enabled, and never change after
+/// that, so an allocation belongs to it exactly when it falls in the range.
+static std::atomic<uintptr_t> SizeClassRegionBegin(0);
+static std::atomic<uintptr_t> SizeClassRegionEnd(0);
+
+static bool isSizeClassAllocation(const void *ptr) {
+  auto address = reinterpret_cast<uintptr_t>(ptr);
+  return address >= SizeClassRegionBegin.load(std::memory_order_relaxed) &&
+         address < SizeClassRegionEnd.load(std::memory_order_relaxed);
+}
+
+namespace {
+
+/// An allocator for small objects with per-thread caches of size-segregated
+/// free lists.
+///
+/// Memory is carved out of 64KB slabs, each dedicated to one size class,
+/// inside a single reserved address range. The size class of an allocation
+/// is recovered from the slab it lives in rather than from the size passed
+/// to swift_slowDealloc, because callers such as swift_unownedRelease only
+/// know the instance size of tail-allocated objects. Memory is never
+/// returned to the system.
+///
+/// Allocation and deallocation normally only touch the calling thread's
+/// cache. Threads exchange free objects in batches through a shared list
+/// per size class, which is the only place a lock is taken.
+class SizeClassHeap {
+public:
+  static constexpr size_t MaxSmallSize = 1024;
+
+private:
+  static constexpr unsigned SlabShift = 16;
+  static constexpr size_t SlabSize = size_t(1) << SlabShift;
+  static constexpr size_t RegionSize = size_t(1) << 35;
+  static constexpr size_t NumSlabs = RegionSize / SlabSize;
+  static constexpr unsigned NumSizeClasses = 20;
+
+  /// The number of objects a thread moves to or from a shared list at once.
+  static constexpr unsigned BatchSize = 64;
+
+  static const uint16_t ClassSizes[NumSizeClasses];
+
+  /// A free object. Every size class can hold at least two pointers.
+  struct FreeObject {
+    FreeObject *Next;
+    /// In the first object of a batch on a shared list, the next batch.
+    FreeObject *NextBatch;
+  };
+
+  struct SharedList {
+    StaticMutex Lock;
+    FreeObject *Batches = nullptr;
+  };
+
+  struct ThreadCache {
+    FreeObject *Free[NumSizeClasses];
+    unsigned NumFree[NumSizeClasses];
+    /// The unallocated part of the slab the thread is carving objects from.
+    char *BumpNext[NumSizeClasses];
+    char *BumpEnd[NumSizeClasses];
+  };
+
+  bool Enabled = false;
+  char *Region = nullptr;
+  /// For each slab, one more than its size class, or 0 if the slab is
+  /// unused.
+  uint8_t *SlabClasses = nullptr;
+  std::atomic<size_t> NextSlab;
+  SharedList Shared[NumSizeClasses];
+  uint8_t ClassForSize[MaxSmallSize / 16 + 1];
+  pthread_key_t CacheKey;
+
+  static void destroyThreadCache(void *cache);
+
+  ThreadCache *getThreadCache() {
+    auto cache = static_cast<ThreadCache*>(pthread_getspecific(CacheKey));
+    if (LLVM_LIKELY(cache != nullptr))
+      return cache;
+
+    cache = static_cast<ThreadCache*>(calloc(1, sizeof(ThreadCache)));
+    if (!cache) swift::crash("Could not allocate memory.");
+    pthread_setspecific(CacheKey, cache);
+    return cache;
+  }
+
+  unsigned getSizeClass(const void *ptr) const {
+    auto slab = (reinterpret_cast<const char*>(ptr) - Region) >> SlabShift;
+    assert(SlabClasses[slab] != 0 && "pointer into an unused slab");
+    return SlabClasses[slab] - 1;
+  }
+
+  /// Detach up to BatchSize objects from the front of the cache's free list
+  /// for \p sizeClass and hand them to the shared list.
+  void releaseBatch(ThreadCache *cache, unsigned sizeClass);
+
+  void *refill(ThreadCache *cache, unsigned sizeClass);
+
+public:
+  SizeClassHeap();
+
+  bool isEnabled() const { return Enabled; }
+
+  /// Allocate \p size bytes aligned to \p alignMask, or return null if the
+  /// request is too large to be served by a size class.
+  void *allocate(size_t size, size_t alignMask) {
+    if (alignMask > MALLOC_ALIGN_MASK) {
+      // Objects in power-of-two size classes are aligned to their size,
+      // since slabs are aligned to the slab size.
+      size_t alignedSize = 16;
+      while (alignedSize < size || alignedSize <= alignMask)
+        alignedSize <<= 1;
+      size = alignedSize;
+    }
+    if (size > MaxSmallSize)
+      return nullptr;
+
+    unsigned sizeClass = ClassForSize[(size + 15) / 16];
+    ThreadCache *cache = getThreadCache();
+    if (FreeObject *object = cache->Free[sizeClass]) {
+      cache->Free[sizeClass] = object->Next;
+      --cache->NumFree[sizeClass];
+      return object;
+    }
+    if (cache->BumpNext[sizeClass] != cache->BumpEnd[sizeClass]) {
+      void *object = cache->BumpNext[sizeClass];
+      cache->BumpNext[sizeClass] += ClassSizes[sizeClass];
+      return object;
+    }
+    return refill(cache, sizeClass);
+  }
+
+  void deallocate(void *ptr, size_t size) {
+    unsigned sizeClass = getSizeClass(ptr);
+    assert(size <= ClassSizes[sizeClass] && "size doesn't fit allocation");
+    ThreadCache *cache = getThreadCache();
+    auto object = static_cast<FreeObject*>(ptr);
+    object->Next = cache->Free[sizeClass];
+    cache->Free[sizeClass] = object;
+    if (++cache->NumFree[sizeClass] > 2 * BatchSize)
+      releaseBatch(cache, sizeClass);
+  }
+
+  size_t getUsableSize(const void *ptr) const {
+    return ClassSizes[getSizeClass(ptr)];
+  }
+};
+
+} // end anonymous namespace
+
+const uint16_t SizeClassHeap::ClassSizes[NumSizeClasses] = {
+  16, 32, 48, 64, 80, 96, 112, 128,
+  160, 192, 224, 256,
+  320, 384, 448, 512,
+  640, 768, 896, 1024,
+};
+
+SizeClassHeap::SizeClassHeap() : NextSlab(0) {
+  bool enabled = SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR_DEFAULT;
+  if (const char *value = getenv("SWIFT_SIZE_CLASS_ALLOCATOR"))
+    enabled = value[0] != '\0' && strcmp(value, "0") != 0;
+  if (!enabled)
+    return;
+
+  for (unsigned sizeClass = 0, i = 0; i <= MaxSmallSize / 16; ++i) {
+    while (ClassSizes[sizeClass] < i * 16)
+      ++sizeClass;
+    ClassForSize[i] = sizeClass;
+  }
+
+#ifdef MAP_NORESERVE
+  int flags = MAP_PRIVATE | MAP_ANON | MAP_NORESERVE;
+#else
+  int flags = MAP_PRIVATE | MAP_ANON;
+#endif
+
+  // Reserve one extra slab so that the region can be aligned to the slab
+  // size. Pages are only committed once they are touched.
+  void *reserved = mmap(nullptr, RegionSize + SlabSize,
+                        PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (reserved == MAP_FAILED)
+    return;
+  void *slabClasses = mmap(nullptr, NumSlabs, PROT_READ | PROT_WRITE,
+                           flags, -1, 0);
+  if (slabClasses == MAP_FAILED) {
+    munmap(reserved, RegionSize + SlabSize);
+    return;
+  }
+  if (pthread_key_create(&CacheKey, destroyThreadCache) != 0) {
+    munmap(reserved, RegionSize + SlabSize);
+    munmap(slabClasses, NumSlabs);
+    return;
+  }
+
+  auto begin = (reinterpret_cast<uintptr_t>(reserved) + SlabSize - 1)
+                 & ~uintptr_t(SlabSize - 1);
+  Region = reinterpret_cast<char*>(begin);
+  SlabClasses = static_cast<uint8_t*>(slabClasses);
+  Enabled = true;
+
+  SizeClassRegionBegin.store(begin, std::memory_order_relaxed);
+  SizeClassRegionEnd.store(begin + RegionSize, std::memory_order_relaxed);
+}
+
+void SizeClassHeap::releaseBatch(ThreadCache *cache, unsigned sizeClass) {
+  FreeObject *batch = cache->Free[sizeClass];
+  if (!batch)
+    return;
+
+  FreeObject *last = batch;
+  unsigned count = 1;
+  while (count < BatchSize && last->Next) {
+    last = last->Next;
+    ++count;
+  }
+  cache->Free[sizeClass] = last->Next;
+  cache->NumFree[sizeClass] -= count;
+  last->Next = nullptr;
+
+  auto &shared = Shared[sizeClass];
+  shared.Lock.withLock([&] {
+    batch->NextBatch = shared.Batches;
+    shared.Batches = batch;
+  });
+}
+
+void *SizeClassHeap::refill(ThreadCache *cache, unsigned sizeClass) {
+  // Take a batch that another thread released, if there is one.
+  auto &shared = Shared[sizeClass];
+  FreeObject *batch = nullptr;
+  shared.Lock.withLock([&] {
+    batch = shared.Batches;
+    if (batch)
+      shared.Batches = batch->NextBatch;
+  });
+
+  if (batch) {
+    unsigned count = 0;
+    for (auto object = batch->Next; object; object = object->Next)
+      ++count;
+    cache->Free[sizeClass] = batch->Next;
+    cache->NumFree[sizeClass] = count;
+    return batch;
+  }
+
+  // Otherwise, start carving up a fresh slab.
+  size_t slab = NextSlab.fetch_add(1, std::memory_order_relaxed);
+  if (slab >= NumSlabs)
+    return nullptr;
+  SlabClasses[slab] = sizeClass + 1;
+
+  size_t objectSize = ClassSizes[sizeClass];
+  char *slabBegin = Region + (slab << SlabShift);
+  cache->BumpNext[sizeClass] = slabBegin + objectSize;
+  cache->BumpEnd[sizeClass] = slabBegin + (SlabSize / objectSize) * objectSize;
+  return slabBegin;
+}
+
+static Lazy<SizeClassHeap> SizeClassAllocator;
+
+void SizeClassHeap::destroyThreadCache(void *cachePtr) {
+  auto &heap = SizeClassAllocator.unsafeGetAlreadyInitialized();
+  auto cache = static_cast<ThreadCache*>(cachePtr);
+
+  for (unsigned sizeClass = 0; sizeClass != NumSizeClasses; ++sizeClass) {
+    // Put the rest of the thread's slab on its free list, so that it isn't
+    // lost along with the thread.
+    size_t objectSize = ClassSizes[sizeClass];
+    for (char *next = cache->BumpNext[sizeClass];
+         next != cache->BumpEnd[sizeClass]; next += objectSize) {
+      auto object = reinterpret_cast<FreeObject*>(next);
+      object->Next = cache->Free[sizeClass];
+      cache->Free[sizeClass] = object;
+    }
+
+    while (cache->Free[sizeClass])
+      heap.releaseBatch(cache, sizeClass);
+  }
+
+  free(cache);
+}
+
+#endif // SWIFT_SIZE_CLASS_ALLOCATOR_SUPPORTED
+
 SWIFT_RT_ENTRY_VISIBILITY
 void *swift::swift_slowAlloc(size_t size, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
-  // FIXME: use posix_memalign if alignMask is larger than the system guarantee.
-  void *p = malloc(size);
-  if (!p) swift::crash("Could not allocate memory.");
-  return p;
+#if SWIFT_SIZE_CLASS_ALLOCATOR_SUPPORTED
+  if (size <= SizeClassHeap::MaxSmallSize &&
+      alignMask < SizeClassHeap::MaxSmallSize) {
+    auto &heap = SizeClassAllocator.get();
+    if (heap.isEnabled())
+      if (void *p = heap.allocate(size, alignMask))
+        return p;
+  }
+#endif
+  return systemAlloc(size, alignMask);
 }
 
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_slowDealloc(void *ptr, size_t bytes, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+#if SWIFT_SIZE_CLASS_ALLOCATOR_SUPPORTED
+  if (isSizeClassAllocation(ptr)) {
+    SizeClassAllocator.unsafeGetAlreadyInitialized().deallocate(ptr, bytes);
+    return;
+  }
+#endif
   free(ptr);
 }
+
+void *swift::_swift_slowRealloc(void *ptr, size_t bytes, size_t alignMask) {
+  // realloc only guarantees malloc's alignment.
+  if (alignMask > MALLOC_ALIGN_MASK)
+    return nullptr;
+
+  size_t usableSize = _swift_slowAllocUsableSize(ptr);
+  if (usableSize >= bytes)
+    return ptr;
+
+#if SWIFT_SIZE_CLASS_ALLOCATOR_SUPPORTED
+  // Size classes can't grow, so move to a bigger allocation.
+  if (isSizeClassAllocation(ptr)) {
+    void *newPtr = swift_slowAlloc(bytes, alignMask);
+    memcpy(newPtr, ptr, usableSize);
+    SizeClassAllocator.unsafeGetAlreadyInitialized().deallocate(ptr,
+                                                                usableSize);
+    return newPtr;
+  }
+#endif
+
+  void *newPtr = realloc(ptr, bytes);
+  if (!newPtr) swift::crash("Could not allocate memory.");
+  return newPtr;
+}
+
+size_t swift::_swift_slowAllocUsableSize(const void *ptr) {
+#if SWIFT_SIZE_CLASS_ALLOCATOR_SUPPORTED
+  if (isSizeClassAllocation(ptr))
+    return SizeClassAllocator.unsafeGetAlreadyInitialized().getUsableSize(ptr);
+#endif
+#if defined(__APPLE__)
+  return malloc_size(ptr);
+#else
+  return malloc_usable_size(const_cast<void *>(ptr));
+#endif
+}
@@ -18,12 +18,17 @@
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Heap.h"
 #include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/Statistics.h"
 #include "swift/ABI/System.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/MathExtras.h"
 #include "MetadataCache.h"
 #include "Private.h"
 #include "swift/Runtime/Debug.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
@@ -59,6 +64,7 @@ SWIFT_RT_ENTRY_IMPL(swift_allocObject)(HeapMetadata const *metadata,
                                        size_t requiredAlignmentMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
   assert(isAlignmentMask(requiredAlignmentMask));
+  countRuntimeStatistic(RuntimeStatistic::ObjectAllocations);
   auto object = reinterpret_cast<HeapObject *>(
       SWIFT_RT_ENTRY_CALL(swift_slowAlloc)(requiredSize,
                                            requiredAlignmentMask));
@@ -84,13 +90,37 @@ swift::swift_initStackObject(HeapMetadata const *metadata,
 
 }
 
+HeapObject *swift::swift_reallocUniqueObject(HeapObject *object,
+                                             size_t requiredSize,
+                                             size_t requiredAlignmentMask) {
+  assert(isAlignmentMask(requiredAlignmentMask));
+#if SWIFT_OBJC_INTEROP || SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
+  // The Objective-C runtime and the leak checker remember objects by
+  // address, behind the reference counts' back.
+  return object;
+#else
+  // A weak reference count of exactly one means no unowned references and
+  // no weak references, which would hold a side table. It also rules out
+  // stack-promoted objects, which start with a weak count of two.
+  if (!object->refCount.isUniquelyReferencedAndUnflagged() ||
+      object->weakRefCount.getCount() != 1 ||
+      object->weakRefCount.hasSideTable())
+    return object;
+
+  void *newObject = _swift_slowRealloc(object, requiredSize,
+                                       requiredAlignmentMask);
+  return newObject ? static_cast<HeapObject *>(newObject) : object;
+#endif
+}
+
 void
 swift::swift_verifyEndOfLifetime(HeapObject *object) {
   if (object->refCount.getCount() != 0)
     swift::fatalError(/* flags = */ 0,
                       "fatal error: stack object escaped\n");
   
-  if (object->weakRefCount.getCount() != 1)
+  if (object->weakRefCount.getCount() != 1 ||
+      object->weakRefCount.hasSideTable())
     swift::fatalError(/* flags = */ 0,
                       "fatal error: weak/unowned reference to stack object\n");
 }
@@ -245,6 +275,7 @@ void swift::swift_nonatomic_retain(HeapObject *object) {
 SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_nonatomic_retain)(HeapObject *object) {
+  countRuntimeStatistic(RuntimeStatistic::Retains);
   _swift_nonatomic_retain_inlined(object);
 }
 
@@ -257,6 +288,7 @@ void swift::swift_nonatomic_release(HeapObject *object) {
 SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_nonatomic_release)(HeapObject *object) {
+  countRuntimeStatistic(RuntimeStatistic::Releases);
   if (object  &&  object->refCount.decrementShouldDeallocateNonAtomic()) {
     // TODO: Use non-atomic _swift_release_dealloc?
     _swift_release_dealloc(object);
@@ -267,6 +299,7 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_retain)(HeapObject *object)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  countRuntimeStatistic(RuntimeStatistic::Retains);
   _swift_retain_inlined(object);
 }
 
@@ -281,6 +314,7 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_retain_n)(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  countRuntimeStatistic(RuntimeStatistic::Retains);
   if (object) {
     object->refCount.increment(n);
   }
@@ -297,6 +331,7 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_nonatomic_retain_n)(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  countRuntimeStatistic(RuntimeStatistic::Retains);
   if (object) {
     object->refCount.incrementNonAtomic(n);
   }
@@ -313,6 +348,7 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_release)(HeapObject *object)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  countRuntimeStatistic(RuntimeStatistic::Releases);
   if (object  &&  object->refCount.decrementShouldDeallocate()) {
     _swift_release_dealloc(object);
   }
@@ -328,6 +364,7 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_release_n)(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  countRuntimeStatistic(RuntimeStatistic::Releases);
   if (object && object->refCount.decrementShouldDeallocateN(n)) {
     _swift_release_dealloc(object);
   }
@@ -347,6 +384,7 @@ SWIFT_RT_ENTRY_IMPL_VISIBILITY
 extern "C"
 void SWIFT_RT_ENTRY_IMPL(swift_nonatomic_release_n)(HeapObject *object, uint32_t n)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  countRuntimeStatistic(RuntimeStatistic::Releases);
   if (object && object->refCount.decrementShouldDeallocateNNonAtomic(n)) {
     _swift_release_dealloc(object);
   }
@@ -635,6 +673,8 @@ static inline void memset_pattern8(void *b, const void *pattern8, size_t len) {
 }
 #endif
 
+static void detachSideTable(HeapObject *object);
+
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_deallocObject(HeapObject *object,
                                 size_t allocatedSize,
@@ -642,6 +682,7 @@ void swift::swift_deallocObject(HeapObject *object,
     SWIFT_CC(RegisterPreservingCC_IMPL) {
   assert(isAlignmentMask(allocatedAlignMask));
   assert(object->refCount.isDeallocating());
+  countRuntimeStatistic(RuntimeStatistic::ObjectDeallocations);
 #ifdef SWIFT_RUNTIME_CLOBBER_FREED_OBJECTS
   memset_pattern8((uint8_t *)object + sizeof(HeapObject),
                   "\xAB\xAD\x1D\xEA\xF4\xEE\xD0\bB9",
@@ -651,6 +692,11 @@ void swift::swift_deallocObject(HeapObject *object,
   // If we are tracking leaks, stop tracking this object.
   SWIFT_LEAKS_STOP_TRACKING_OBJECT(object);
 
+  // Weak references don't keep the object's memory alive; they are cleared
+  // through the side table, which outlives the object.
+  if (object->weakRefCount.hasSideTable())
+    detachSideTable(object);
+
   // Drop the initial weak retain of the object.
   //
   // If the outstanding weak retain count is 1 (i.e. only the initial
@@ -727,143 +773,201 @@ void swift::swift_deallocObject(HeapObject *object,
 
 enum: uintptr_t {
   WR_NATIVE = 1<<(swift::heap_object_abi::ObjCReservedLowBits),
-  WR_READING = 1<<(swift::heap_object_abi::ObjCReservedLowBits+1),
 
   WR_NATIVEMASK = WR_NATIVE | swift::heap_object_abi::ObjCReservedBitsMask,
 };
 
-static_assert(WR_READING < alignof(void*),
-              "weakref lock bit mustn't interfere with real pointer bits");
-
 enum: short {
   WR_SPINLIMIT = 64,
 };
 
-bool swift::isNativeSwiftWeakReference(WeakReference *ref) {
-  return (ref->Value & WR_NATIVEMASK) == WR_NATIVE;
-}
+namespace {
 
-void swift::swift_weakInit(WeakReference *ref, HeapObject *value) {
-  ref->Value = (uintptr_t)value | WR_NATIVE;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(value);
-}
+/// The out-of-line state shared by all of the native weak references to an
+/// object. Weak references point at the side table instead of the object, so
+/// they don't keep the object's memory alive: when the object is deallocated
+/// the side table forgets it, and only the side table lingers until the last
+/// weak reference to it goes away.
+class WeakReferenceSideTable {
+  /// The object, or null once it has been deallocated.
+  std::atomic<HeapObject *> Object;
 
-void swift::swift_weakAssign(WeakReference *ref, HeapObject *newValue) {
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(newValue);
-  auto oldValue = (HeapObject*) (ref->Value & ~WR_NATIVE);
-  ref->Value = (uintptr_t)newValue | WR_NATIVE;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(oldValue);
-}
+  /// The number of loads that may be looking at the object. Deallocation
+  /// waits for them before the object's memory is freed.
+  std::atomic<uint32_t> Readers;
 
-HeapObject *swift::swift_weakLoadStrong(WeakReference *ref) {
-  if (ref->Value == (uintptr_t)nullptr) {
-    return nullptr;
+  /// One for each weak reference, plus one until the object is deallocated.
+  std::atomic<uint32_t> RefCount;
+
+public:
+  explicit WeakReferenceSideTable(HeapObject *object)
+    : Object(object), Readers(0), RefCount(1) {}
+
+  void retain() {
+    RefCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void release() {
+    if (RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete this;
+  }
+
+  /// Returns the object, retained, or null if it has begun deallocation.
+  HeapObject *tryRetainObject() {
+    // Sequentially consistent, so that either detach() sees this reader,
+    // or this reader sees the null detach() stored.
+    Readers.fetch_add(1, std::memory_order_seq_cst);
+    HeapObject *object = Object.load(std::memory_order_seq_cst);
+    HeapObject *result = object ? swift_tryRetain(object) : nullptr;
+    Readers.fetch_sub(1, std::memory_order_release);
+    return result;
   }
 
-  // ref might be visible to other threads
-  auto ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
+  /// Forget the object, which is being deallocated, once no load can be
+  /// looking at it any more, and drop the object's reference to the table.
+  void detach() {
+    Object.store(nullptr, std::memory_order_seq_cst);
     short c = 0;
-    while (__atomic_load_n(&ref->Value, __ATOMIC_RELAXED) & WR_READING) {
+    while (Readers.load(std::memory_order_acquire) != 0) {
       if (++c == WR_SPINLIMIT) {
         sched_yield();
         c -= 1;
       }
     }
-    ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
+    release();
   }
+};
 
-  auto object = (HeapObject*)(ptr & ~WR_NATIVE);
-  if (object == nullptr) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    return nullptr;
+/// A lock-protected map from objects to their side tables. Objects are
+/// spread over several of these to keep the locks uncontended.
+struct SideTableStripe {
+  Mutex Lock;
+  llvm::DenseMap<HeapObject *, WeakReferenceSideTable *> Tables;
+};
+
+} // end anonymous namespace
+
+static const unsigned NumSideTableStripes = 8;
+static Lazy<std::array<SideTableStripe, NumSideTableStripes>> SideTableStripes;
+
+static SideTableStripe &getSideTableStripe(HeapObject *object) {
+  // The low bits of an object's address are always zero.
+  auto index = (uintptr_t(object) >> 4) % NumSideTableStripes;
+  return SideTableStripes.get()[index];
+}
+
+/// Returns the side table for a live object, creating it if needed, with an
+/// extra reference for the caller.
+static WeakReferenceSideTable *retainSideTable(HeapObject *object) {
+  auto &stripe = getSideTableStripe(object);
+  WeakReferenceSideTable *table;
+  stripe.Lock.withLock([&] {
+    auto &entry = stripe.Tables[object];
+    if (!entry) {
+      entry = new WeakReferenceSideTable(object);
+      object->weakRefCount.setHasSideTable();
+    }
+    table = entry;
+    table->retain();
+  });
+  return table;
+}
+
+/// Disconnects a deallocating object from its side table.
+static void detachSideTable(HeapObject *object) {
+  auto &stripe = getSideTableStripe(object);
+  WeakReferenceSideTable *table = nullptr;
+  stripe.Lock.withLock([&] {
+    auto found = stripe.Tables.find(object);
+    if (found != stripe.Tables.end()) {
+      table = found->second;
+      stripe.Tables.erase(found);
+    }
+  });
+  if (table)
+    table->detach();
+}
+
+static WeakReferenceSideTable *getSideTable(WeakReference *ref) {
+  return (WeakReferenceSideTable *)(ref->Value & ~WR_NATIVE);
+}
+
+static void setSideTable(WeakReference *ref, WeakReferenceSideTable *table) {
+  ref->Value = (uintptr_t)table | WR_NATIVE;
+}
+
+bool swift::isNativeSwiftWeakReference(WeakReference *ref) {
+  return (ref->Value & WR_NATIVEMASK) == WR_NATIVE;
+}
+
+void swift::swift_weakInit(WeakReference *ref, HeapObject *value) {
+  // A weak reference formed during deinit is already nil.
+  if (!value || value->refCount.isDeallocating()) {
+    setSideTable(ref, nullptr);
+    return;
   }
-  if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
+  setSideTable(ref, retainSideTable(value));
+}
+
+void swift::swift_weakAssign(WeakReference *ref, HeapObject *newValue) {
+  auto oldTable = getSideTable(ref);
+  swift_weakInit(ref, newValue);
+  if (oldTable)
+    oldTable->release();
+}
+
+HeapObject *swift::swift_weakLoadStrong(WeakReference *ref) {
+  auto table = getSideTable(ref);
+  if (!table)
     return nullptr;
-  }
-  auto result = swift_tryRetain(object);
-  __atomic_store_n(&ref->Value, ptr, __ATOMIC_RELAXED);
-  return result;
+  return table->tryRetainObject();
 }
 
 HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
-  auto object = (HeapObject*) (ref->Value & ~WR_NATIVE);
-  if (object == nullptr) return nullptr;
-  auto result = swift_tryRetain(object);
+  auto table = getSideTable(ref);
+  if (!table)
+    return nullptr;
+  auto result = table->tryRetainObject();
   ref->Value = (uintptr_t)nullptr;
-  swift_unownedRelease(object);
+  table->release();
   return result;
 }
 
 void swift::swift_weakDestroy(WeakReference *ref) {
-  auto tmp = (HeapObject*) (ref->Value & ~WR_NATIVE);
+  auto table = getSideTable(ref);
   ref->Value = (uintptr_t)nullptr;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(tmp);
+  if (table)
+    table->release();
 }
 
 void swift::swift_weakCopyInit(WeakReference *dest, WeakReference *src) {
-  if (src->Value == (uintptr_t)nullptr) {
-    dest->Value = (uintptr_t)nullptr;
-    return;
-  }
-
-  // src might be visible to other threads
-  auto ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&src->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        sched_yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  }
-
-  auto object = (HeapObject*)(ptr & ~WR_NATIVE);
-  if (object == nullptr) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    dest->Value = (uintptr_t)nullptr;
-  } else if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-    dest->Value = (uintptr_t)nullptr;
-  } else {
-    SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(object);
-    __atomic_store_n(&src->Value, ptr, __ATOMIC_RELAXED);
-    dest->Value = (uintptr_t)object | WR_NATIVE;
-  }
+  auto table = getSideTable(src);
+  if (table)
+    table->retain();
+  setSideTable(dest, table);
 }
 
 void swift::swift_weakTakeInit(WeakReference *dest, WeakReference *src) {
-  auto object = (HeapObject*) (src->Value & ~WR_NATIVE);
-  if (object == nullptr) {
-    dest->Value = (uintptr_t)nullptr;
-  } else if (object->refCount.isDeallocating()) {
-    dest->Value = (uintptr_t)nullptr;
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  } else {
-    dest->Value = (uintptr_t)object | WR_NATIVE;
-  }
+  setSideTable(dest, getSideTable(src));
   src->Value = (uintptr_t)nullptr;
 }
 
 void swift::swift_weakCopyAssign(WeakReference *dest, WeakReference *src) {
-  if (dest->Value) {
-    auto object = (HeapObject*) (dest->Value & ~WR_NATIVE);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (dest == src)
+    return;
+  auto oldTable = getSideTable(dest);
   swift_weakCopyInit(dest, src);
+  if (oldTable)
+    oldTable->release();
 }
 
 void swift::swift_weakTakeAssign(WeakReference *dest, WeakReference *src) {
-  if (dest->Value) {
-    auto object = (HeapObject*) (dest->Value & ~WR_NATIVE);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (dest == src)
+    return;
+  auto oldTable = getSideTable(dest);
   swift_weakTakeInit(dest, src);
+  if (oldTable)
+    oldTable->release();
 }
 
 void swift::_swift_abortRetainUnowned(const void *object) {
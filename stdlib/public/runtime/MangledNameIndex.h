@@ -0,0 +1,126 @@
+//===--- MangledNameIndex.h - Index of types by mangled name ----*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A hash index from mangled nominal type names to the type metadata records
+// or conformance records that describe them, so that looking a type up by
+// name doesn't have to walk every record of every loaded image.
+//
+//===----------------------------------------------------------------------===//
+#ifndef SWIFT_RUNTIME_MANGLEDNAMEINDEX_H
+#define SWIFT_RUNTIME_MANGLEDNAMEINDEX_H
+
+#include "swift/Runtime/Concurrent.h"
+#include "swift/Runtime/Metadata.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringRef.h"
+#include "Private.h"
+#include <atomic>
+
+namespace swift {
+
+/// An insert-only index from mangled type names to metadata. Lookups are
+/// lock-free. Records are added a section at a time by indexNewSections,
+/// which must be called under the lock that guards the list of sections;
+/// the first record found for a name wins, as it did when the sections were
+/// searched linearly.
+class MangledNameIndex {
+  struct Entry {
+  private:
+    llvm::StringRef Name;
+    const Metadata *Metadata;
+    const NominalTypeDescriptor *Descriptor;
+
+  public:
+    Entry(llvm::StringRef name, const ::swift::Metadata *metadata,
+          const NominalTypeDescriptor *descriptor)
+      : Name(name), Metadata(metadata), Descriptor(descriptor) {}
+
+    int compareWithKey(llvm::StringRef aName) const {
+      return aName.compare(Name);
+    }
+
+    static size_t getKeyHash(llvm::StringRef aName) {
+      // llvm::hash_value(StringRef) is defined out of line in a library
+      // the runtime doesn't link against.
+      return llvm::hash_combine_range(aName.begin(), aName.end());
+    }
+
+    template <class... T>
+    static size_t getExtraAllocationSize(T &&... ignored) {
+      return 0;
+    }
+
+    /// Produce the metadata for the entry, calling the type's accessor if
+    /// only its nominal type descriptor is known.
+    const ::swift::Metadata *getMetadata() const {
+      if (Metadata)
+        return Metadata;
+      return _matchMetadataByMangledTypeName(Name, nullptr, Descriptor);
+    }
+  };
+
+  ConcurrentMap<Entry> Map;
+
+  /// The number of sections that have been added to the index.
+  std::atomic<size_t> NumIndexedSections;
+
+  template <class Record>
+  void addRecord(const Record &record) {
+    const Metadata *metadata = record.getCanonicalTypeMetadata();
+    const NominalTypeDescriptor *ntd;
+    if (metadata) {
+      ntd = metadata->getNominalTypeDescriptor();
+    } else {
+      ntd = record.getNominalTypeDescriptor();
+      // Without metadata, only a non-generic type's accessor can produce
+      // any; a later record for the same name may still do better.
+      if (!ntd || ntd->GenericParams.isGeneric() || !ntd->getAccessFunction())
+        return;
+    }
+    if (!ntd)
+      return;
+
+    llvm::StringRef name = ntd->Name.get();
+    Map.getOrInsert(name, metadata, metadata ? nullptr : ntd);
+  }
+
+public:
+  constexpr MangledNameIndex() : NumIndexedSections(0) {}
+
+  /// Returns true if the index covers the first \p numSections sections.
+  bool isUpToDate(size_t numSections) const {
+    return NumIndexedSections.load(std::memory_order_acquire) == numSections;
+  }
+
+  /// Add any sections in \p sections that are not indexed yet. The caller
+  /// must hold the lock guarding \p sections.
+  template <class SectionList>
+  void indexNewSections(const SectionList &sections) {
+    size_t i = NumIndexedSections.load(std::memory_order_relaxed);
+    for (size_t e = sections.size(); i != e; ++i) {
+      for (const auto &record : sections[i])
+        addRecord(record);
+    }
+    NumIndexedSections.store(i, std::memory_order_release);
+  }
+
+  /// Look up the metadata for the type with the given mangled name.
+  const Metadata *lookup(llvm::StringRef typeName) {
+    if (auto entry = Map.find(typeName))
+      return entry->getMetadata();
+    return nullptr;
+  }
+};
+
+} // end namespace swift
+
+#endif // SWIFT_RUNTIME_MANGLEDNAMEINDEX_H
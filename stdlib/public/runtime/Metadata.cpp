@@ -22,12 +22,14 @@
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/Statistics.h"
 #include "swift/Strings.h"
 #include "MetadataCache.h"
 #include <algorithm>
 #include <condition_variable>
 #include <new>
 #include <cctype>
+#include <pthread.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include "llvm/ADT/DenseMap.h"
@@ -56,15 +58,64 @@
 using namespace swift;
 using namespace metadataimpl;
 
+namespace {
+  /// The page a thread is currently bump-allocating metadata from. The
+  /// header lives at the start of the page it describes.
+  struct MetadataAllocationPage {
+    char *Next;
+    char *End;
+  };
+} // end anonymous namespace
+
+static pthread_key_t getMetadataAllocationPageKey() {
+  static const pthread_key_t key = [] {
+    pthread_key_t key;
+    // Pages outlive their threads; the unused tail of a page whose thread
+    // has exited is simply abandoned, like the tail of any retired page.
+    if (pthread_key_create(&key, nullptr) != 0)
+      crash("unable to create metadata allocator thread key");
+    return key;
+  }();
+  return key;
+}
+
+/// The head of the list of allocators that have allocated anything.
+static std::atomic<MetadataAllocator *> RegisteredMetadataAllocators;
+
+void MetadataAllocator::registerAllocator() {
+  auto head = RegisteredMetadataAllocators.load(std::memory_order_relaxed);
+  do {
+    NextAllocator = head;
+  } while (!RegisteredMetadataAllocators.compare_exchange_weak(
+               head, this, std::memory_order_release,
+               std::memory_order_relaxed));
+}
+
+void MetadataAllocator::forEachAllocator(
+                  llvm::function_ref<void(const MetadataAllocator &)> fn) {
+  for (auto allocator =
+           RegisteredMetadataAllocators.load(std::memory_order_acquire);
+       allocator; allocator = allocator->NextAllocator)
+    fn(*allocator);
+}
+
 void *MetadataAllocator::alloc(size_t size) {
 #if defined(__APPLE__)
   const uintptr_t PageSizeMask = vm_page_mask;
 #else
   static const uintptr_t PageSizeMask = sysconf(_SC_PAGESIZE) - 1;
 #endif
-  // If the requested size is a page or larger, map page(s) for it
-  // specifically.
-  if (LLVM_UNLIKELY(size > PageSizeMask)) {
+  size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+  // Register this allocator with the debugging list the first time it
+  // hands out memory. Exactly one thread sees the count leave zero.
+  if (BytesAllocated.fetch_add(size, std::memory_order_relaxed) == 0 &&
+      size != 0)
+    registerAllocator();
+
+  // If the requested size doesn't fit in a fresh page alongside the page
+  // header, map page(s) for it specifically.
+  if (LLVM_UNLIKELY(size > PageSizeMask + 1 - sizeof(MetadataAllocationPage))) {
     auto mem = mmap(nullptr, (size + PageSizeMask) & ~PageSizeMask,
                     PROT_READ|PROT_WRITE, MAP_ANON|MAP_PRIVATE,
                     VM_TAG_FOR_SWIFT_METADATA, 0);
@@ -73,43 +124,46 @@ void *MetadataAllocator::alloc(size_t size) {
     return mem;
   }
 
-  uintptr_t curValue = NextValue.load(std::memory_order_relaxed);
-  while (true) {
-    char *next = reinterpret_cast<char*>(curValue);
-    char *end = next + size;
-  
-    // If we wrap over the end of the page, allocate a new page.
-    void *allocation = nullptr;
-    if (LLVM_UNLIKELY(((uintptr_t)next & ~PageSizeMask)
-                        != (((uintptr_t)end & ~PageSizeMask)))) {
-      // Allocate a new page if we haven't already.
-      allocation = mmap(nullptr, PageSizeMask + 1,
-                        PROT_READ|PROT_WRITE,
-                        MAP_ANON|MAP_PRIVATE,
-                        VM_TAG_FOR_SWIFT_METADATA,
-                        /*offset*/ 0);
-
-      if (allocation == MAP_FAILED)
-        crash("unable to allocate memory for metadata cache");
-
-      next = (char*) allocation;
-      end = next + size;
-    }
-
-    // Swap it into place.
-    if (LLVM_LIKELY(std::atomic_compare_exchange_weak_explicit(
-            &NextValue, &curValue, reinterpret_cast<uintptr_t>(end),
-            std::memory_order_relaxed, std::memory_order_relaxed))) {
-      return next;
-    }
+  // Bump-allocate from this thread's page. Nothing else ever touches it, so
+  // no synchronization is needed; the metadata is published to other threads
+  // through the caches' own release/acquire handoff.
+  auto key = getMetadataAllocationPageKey();
+  auto page = static_cast<MetadataAllocationPage *>(pthread_getspecific(key));
+  if (LLVM_UNLIKELY(!page || size_t(page->End - page->Next) < size)) {
+    auto mem = mmap(nullptr, PageSizeMask + 1,
+                    PROT_READ|PROT_WRITE, MAP_ANON|MAP_PRIVATE,
+                    VM_TAG_FOR_SWIFT_METADATA, /*offset*/ 0);
+    if (mem == MAP_FAILED)
+      crash("unable to allocate memory for metadata cache");
 
-    // If that didn't succeed, and we allocated, free the allocation.
-    // This potentially causes us to perform multiple mmaps under contention,
-    // but it keeps the fast path pristine.
-    if (allocation) {
-      munmap(allocation, PageSizeMask + 1);
-    }
+    page = static_cast<MetadataAllocationPage *>(mem);
+    page->Next = reinterpret_cast<char *>(page + 1);
+    page->End = reinterpret_cast<char *>(mem) + PageSizeMask + 1;
+    pthread_setspecific(key, page);
   }
+
+  char *result = page->Next;
+  page->Next += size;
+  return result;
+}
+
+/// The number of queues waiters for metadata cache entries are spread over.
+static const size_t NumMetadataWaitQueues = 64;
+static MetadataWaitQueue MetadataWaitQueues[NumMetadataWaitQueues];
+
+MetadataWaitQueue &swift::getMetadataWaitQueue(const void *entry) {
+  // Entries are at least pointer-aligned, so the low bits carry nothing.
+  auto bits = reinterpret_cast<uintptr_t>(entry) / alignof(void *);
+  return MetadataWaitQueues[(bits ^ (bits >> 6)) % NumMetadataWaitQueues];
+}
+
+void swift::swift_enumerateMetadataAllocations(
+                          void (*callback)(const char *name, size_t bytes,
+                                           void *context),
+                          void *context) {
+  MetadataAllocator::forEachAllocator([&](const MetadataAllocator &allocator) {
+    callback(allocator.getName(), allocator.getBytesAllocated(), context);
+  });
 }
 
 namespace {
@@ -280,6 +334,7 @@ swift::swift_getGenericMetadata(GenericMetadata *pattern,
   auto entry = getCache(pattern).findOrAdd(genericArgs, numGenericArgs,
     [&]() -> GenericCacheEntry* {
       // Create new metadata to cache.
+      countRuntimeStatistic(RuntimeStatistic::MetadataInstantiations);
       auto metadata = pattern->CreateFunction(pattern, arguments);
       auto entry = GenericCacheEntry::getFromMetadata(pattern, metadata);
       entry->Value = metadata;
@@ -289,6 +344,28 @@ swift::swift_getGenericMetadata(GenericMetadata *pattern,
   return entry->Value;
 }
 
+const Metadata *
+swift::swift_registerGenericMetadata(GenericMetadata *pattern,
+                                     const void *arguments,
+                                     const Metadata *metadata) {
+  auto genericArgs = (const void * const *) arguments;
+  size_t numGenericArgs = pattern->NumKeyArguments;
+
+  auto &cache = getCache(pattern);
+  auto entry = cache.findOrAdd(genericArgs, numGenericArgs,
+    [&]() -> GenericCacheEntry* {
+      // The metadata is not allocated together with the entry, so the
+      // entry only holds the key.
+      auto entry = GenericCacheEntry::allocate(cache.getAllocator(),
+                                               genericArgs, numGenericArgs,
+                                               /*payloadSize*/ 0);
+      entry->Value = metadata;
+      return entry;
+    });
+
+  return entry->Value;
+}
+
 namespace {
   class ObjCClassCacheEntry : public CacheEntry<ObjCClassCacheEntry> {
     FullMetadata<ObjCClassWrapperMetadata> Metadata;
@@ -891,14 +968,6 @@ static int tuple_getExtraInhabitantIndex(const OpaqueValue *tuple,
 }
 
 /// Various standard witness table for tuples.
-static const ValueWitnessTable tuple_witnesses_pod_inline = {
-#define TUPLE_WITNESS(NAME) &tuple_##NAME<true, true>,
-  FOR_ALL_FUNCTION_VALUE_WITNESSES(TUPLE_WITNESS)
-#undef TUPLE_WITNESS
-  0,
-  ValueWitnessFlags(),
-  0
-};
 static const ValueWitnessTable tuple_witnesses_nonpod_inline = {
 #define TUPLE_WITNESS(NAME) &tuple_##NAME<false, true>,
   FOR_ALL_FUNCTION_VALUE_WITNESSES(TUPLE_WITNESS)
@@ -907,14 +976,6 @@ static const ValueWitnessTable tuple_witnesses_nonpod_inline = {
   ValueWitnessFlags(),
   0
 };
-static const ValueWitnessTable tuple_witnesses_pod_noninline = {
-#define TUPLE_WITNESS(NAME) &tuple_##NAME<true, false>,
-  FOR_ALL_FUNCTION_VALUE_WITNESSES(TUPLE_WITNESS)
-#undef TUPLE_WITNESS
-  0,
-  ValueWitnessFlags(),
-  0
-};
 static const ValueWitnessTable tuple_witnesses_nonpod_noninline = {
 #define TUPLE_WITNESS(NAME) &tuple_##NAME<false, false>,
   FOR_ALL_FUNCTION_VALUE_WITNESSES(TUPLE_WITNESS)
@@ -1034,42 +1095,30 @@ swift::swift_getTupleTypeMetadata(size_t numElements,
 
       // Copy the function witnesses in, either from the proposed
       // witnesses or from the standard table.
+      bool useCommonWitnesses = false;
       if (!proposedWitnesses) {
         // For a tuple with a single element, just use the witnesses for
         // the element type.
         if (numElements == 1) {
           proposedWitnesses = elements[0]->getValueWitnesses();
 
-          // Otherwise, use generic witnesses (when we can't pattern-match
-          // into something better).
-        } else if (layout.flags.isInlineStorage()
-                   && layout.flags.isPOD()) {
-          if (layout.size == 8 && layout.flags.getAlignmentMask() == 7)
-            proposedWitnesses = &_TWVBi64_;
-          else if (layout.size == 4 && layout.flags.getAlignmentMask() == 3)
-            proposedWitnesses = &_TWVBi32_;
-          else if (layout.size == 2 && layout.flags.getAlignmentMask() == 1)
-            proposedWitnesses = &_TWVBi16_;
-          else if (layout.size == 1)
-            proposedWitnesses = &_TWVBi8_;
-          else
-            proposedWitnesses = &tuple_witnesses_pod_inline;
-        } else if (layout.flags.isInlineStorage()
-                   && !layout.flags.isPOD()) {
+          // Otherwise, use generic witnesses, and let
+          // installCommonValueWitnesses replace the ones that can be done
+          // with memcpy or memmove.
+        } else if (layout.flags.isInlineStorage()) {
           proposedWitnesses = &tuple_witnesses_nonpod_inline;
-        } else if (!layout.flags.isInlineStorage()
-                   && layout.flags.isPOD()) {
-          proposedWitnesses = &tuple_witnesses_pod_noninline;
+          useCommonWitnesses = true;
         } else {
-          assert(!layout.flags.isInlineStorage()
-                 && !layout.flags.isPOD());
           proposedWitnesses = &tuple_witnesses_nonpod_noninline;
+          useCommonWitnesses = true;
         }
       }
 #define ASSIGN_TUPLE_WITNESS(NAME) \
       witnesses->NAME = proposedWitnesses->NAME;
       FOR_ALL_FUNCTION_VALUE_WITNESSES(ASSIGN_TUPLE_WITNESS)
 #undef ASSIGN_TUPLE_WITNESS
+      if (useCommonWitnesses)
+        installCommonValueWitnesses(witnesses);
 
       // We have extra inhabitants if the first element does.
       // FIXME: generalize this.
@@ -1579,7 +1628,7 @@ static ClassMetadata *_swift_initializeSuperclass(ClassMetadata *theClass,
 #if SWIFT_OBJC_INTEROP
 static MetadataAllocator &getResilientMetadataAllocator() {
   // This should be constant-initialized, but this is safe.
-  static MetadataAllocator allocator;
+  static MetadataAllocator allocator("ResilientMetadata");
   return allocator;
 }
 #endif
@@ -2286,20 +2335,10 @@ const ExistentialTypeMetadata *
 swift::swift_getExistentialTypeMetadata(size_t numProtocols,
                                         const ProtocolDescriptor **protocols)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
-  // Sort the protocol set.
-  std::sort(protocols, protocols + numProtocols);
-
-  // Calculate the class constraint and number of witness tables for the
-  // protocol set.
-  unsigned numWitnessTables = 0;
-  ProtocolClassConstraint classConstraint = ProtocolClassConstraint::Any;
-  for (auto p : make_range(protocols, protocols + numProtocols)) {
-    if (p->Flags.needsWitnessTable()) {
-      ++numWitnessTables;
-    }
-    if (p->Flags.getClassConstraint() == ProtocolClassConstraint::Class)
-      classConstraint = ProtocolClassConstraint::Class;
-  }
+  // Sort the protocol set, which usually has one protocol or is already in
+  // order.
+  if (!std::is_sorted(protocols, protocols + numProtocols))
+    std::sort(protocols, protocols + numProtocols);
 
   // Search the cache.
 
@@ -2308,6 +2347,18 @@ swift::swift_getExistentialTypeMetadata(size_t numProtocols,
   auto &E = Existentials.get();
   auto entry = E.Types.findOrAdd(protocolArgs, numProtocols,
     [&]() -> ExistentialCacheEntry* {
+      // Calculate the class constraint and number of witness tables for the
+      // protocol set.
+      unsigned numWitnessTables = 0;
+      ProtocolClassConstraint classConstraint = ProtocolClassConstraint::Any;
+      for (auto p : make_range(protocols, protocols + numProtocols)) {
+        if (p->Flags.needsWitnessTable()) {
+          ++numWitnessTables;
+        }
+        if (p->Flags.getClassConstraint() == ProtocolClassConstraint::Class)
+          classConstraint = ProtocolClassConstraint::Class;
+      }
+
       // Create a new entry for the cache.
       auto entry = ExistentialCacheEntry::allocate(E.Types.getAllocator(),
                              protocolArgs, numProtocols,
@@ -17,6 +17,7 @@
 #include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
+#include <atomic>
 #include <condition_variable>
 #include <thread>
 
@@ -26,21 +27,43 @@
 
 namespace swift {
 
+/// A lock and condition that threads waiting for another thread to finish
+/// building a metadata cache entry park on.
+struct MetadataWaitQueue {
+  StaticMutex Lock;
+  StaticConditionVariable Queue;
+};
+
+/// Returns the queue to wait on for the cache entry at \p entry. Entries are
+/// spread over a fixed set of queues shared by all the caches, so finishing
+/// an entry only wakes the threads waiting for it and for the few entries
+/// that share its queue, rather than every waiter of the cache.
+MetadataWaitQueue &getMetadataWaitQueue(const void *entry);
+
 /// A bump pointer for metadata allocations. Since metadata is (currently)
-/// never released, it does not support deallocation. This allocator by itself
-/// is not thread-safe; in concurrent uses, allocations must be guarded by
-/// a lock, such as the per-metadata-cache lock used to guard metadata
-/// instantiations. All allocations are pointer-aligned.
+/// never released, it does not support deallocation. All allocations are
+/// pointer-aligned.
+///
+/// The allocator is thread-safe and does not take a lock: every thread bumps
+/// through a page of its own, shared by all of the allocators in the process.
+/// Each allocator only keeps count of the bytes it has handed out, which
+/// swift_enumerateMetadataAllocations reports for debugging.
 class MetadataAllocator {
-  /// Address of the next available space. The allocator grabs a page at a time,
-  /// so the need for a new page can be determined by page alignment.
-  ///
-  /// Initializing to -1 instead of nullptr ensures that the first allocation
-  /// triggers a page allocation since it will always span a "page" boundary.
-  std::atomic<uintptr_t> NextValue;
-  
+  /// The number of bytes allocated so far.
+  std::atomic<size_t> BytesAllocated;
+
+  /// The name reported for this allocator.
+  const char *Name;
+
+  /// The next allocator in the list of allocators that have allocated
+  /// anything. Written once, before the allocator is published.
+  MetadataAllocator *NextAllocator;
+
+  void registerAllocator();
+
 public:
-  constexpr MetadataAllocator() : NextValue(~(uintptr_t)0) {}
+  constexpr MetadataAllocator(const char *name = "MetadataAllocator")
+    : BytesAllocated(0), Name(name), NextAllocator(nullptr) {}
 
   // Don't copy or move, please.
   MetadataAllocator(const MetadataAllocator &) = delete;
@@ -49,6 +72,16 @@ public:
   MetadataAllocator &operator=(MetadataAllocator &&) = delete;
   
   void *alloc(size_t size);
+
+  const char *getName() const { return Name; }
+
+  size_t getBytesAllocated() const {
+    return BytesAllocated.load(std::memory_order_relaxed);
+  }
+
+  /// Call the given function on every allocator that has allocated memory.
+  static void forEachAllocator(
+                  llvm::function_ref<void(const MetadataAllocator &)> fn);
 };
 
 // A wrapper around a pointer to a metadata cache entry that provides
@@ -202,18 +235,29 @@ template <class ValueTy> class MetadataCache {
     size_t Hash;
     unsigned KeyLength;
 
-    /// Does this entry have a value, or is it currently undergoing
-    /// initialization?
-    ///
-    /// This (and the following field) is ever modified under the lock,
-    /// but it can be read from any thread, including while the lock
-    /// is held.
-    std::atomic<bool> HasValue;
-    union {
-      ValueTy *Value;
-      std::thread::id InitializingThread;
+    enum : uint8_t {
+      /// The value is being built, and no thread waits for it.
+      Initializing,
+      /// The value is being built, and threads wait for it on the entry's
+      /// wait queue.
+      InitializingWithWaiters,
+      /// The value has been built.
+      Initialized,
     };
 
+    /// The initialization state of this entry. Only the thread building
+    /// the value sets it to Initialized; waiters only move it from
+    /// Initializing to InitializingWithWaiters, under the lock of the
+    /// entry's wait queue.
+    std::atomic<uint8_t> State;
+
+    /// The value, once State is Initialized.
+    ValueTy *Value;
+
+    /// The thread building the value. This isn't in a union with Value,
+    /// because waiters read it while the value is being set without a lock.
+    std::thread::id InitializingThread;
+
     const void **getKeyDataBuffer() {
       return reinterpret_cast<const void **>(this + 1);
     }
@@ -222,8 +266,8 @@ template <class ValueTy> class MetadataCache {
     }
   public:
     Entry(const Key &key)
-      : Hash(key.Hash), KeyLength(key.KeyData.size()), HasValue(false) {
-      InitializingThread = std::this_thread::get_id();
+      : Hash(key.Hash), KeyLength(key.KeyData.size()), State(Initializing),
+        Value(nullptr), InitializingThread(std::this_thread::get_id()) {
       memcpy(getKeyDataBuffer(), key.KeyData.begin(),
              KeyLength * sizeof(void*));
     }
@@ -244,6 +288,10 @@ template <class ValueTy> class MetadataCache {
       return key.KeyData.size() * sizeof(void*);
     }
 
+    static size_t getKeyHash(const Key &key) {
+      return key.Hash;
+    }
+
     int compareWithKey(const Key &key) const {
       // Order by hash first, then by the actual key data.
       if (key.Hash != Hash) {
@@ -254,15 +302,33 @@ template <class ValueTy> class MetadataCache {
     }
 
     ValueTy *getValue() const {
-      if (HasValue.load(std::memory_order_acquire)) {
+      if (State.load(std::memory_order_acquire) == Initialized) {
         return Value;
       }
       return nullptr;
     }
 
-    void setValue(ValueTy *value) {
+    /// Records that a thread is about to wait for the value. Must be called
+    /// with the entry's wait queue locked.
+    ///
+    /// \returns false if the value has been set already, so there is
+    /// nothing to wait for.
+    bool addWaiter() {
+      uint8_t state = Initializing;
+      if (State.compare_exchange_strong(state, InitializingWithWaiters,
+                                        std::memory_order_acquire,
+                                        std::memory_order_acquire))
+        return true;
+      return state != Initialized;
+    }
+
+    /// Publishes the value.
+    ///
+    /// \returns true if threads wait for it, and need to be woken up.
+    bool setValue(ValueTy *value) {
       Value = value;
-      HasValue.store(true, std::memory_order_release);
+      return State.exchange(Initialized, std::memory_order_acq_rel) ==
+             InitializingWithWaiters;
     }
   };
 
@@ -271,32 +337,30 @@ template <class ValueTy> class MetadataCache {
 
   static_assert(sizeof(Map) == 2 * sizeof(void*),
                 "offset of Head is not at proper offset");
+  static_assert(sizeof(std::atomic<const ValueTy *>) == sizeof(void*),
+                "Head must be laid out as a plain pointer");
 
   /// The head of a linked list connecting all the metadata cache entries.
+  /// Values of different keys are built concurrently, so they are pushed
+  /// onto the list atomically.
   /// TODO: Remove this when LLDB is able to understand the final data
   /// structure for the metadata cache.
-  const ValueTy *Head;
-
-  struct ConcurrencyControl {
-    Mutex Lock;
-    ConditionVariable Queue;
-  };
-  std::unique_ptr<ConcurrencyControl> Concurrency;
+  std::atomic<const ValueTy *> Head;
 
   /// Allocator for entries of this cache.
   MetadataAllocator Allocator;
   
 public:
-  MetadataCache() : Concurrency(new ConcurrencyControl()) {}
+  MetadataCache()
+    : Allocator(ValueTy::getName()) {}
   ~MetadataCache() {}
 
   /// Caches are not copyable.
   MetadataCache(const MetadataCache &other) = delete;
   MetadataCache &operator=(const MetadataCache &other) = delete;
 
-  /// Get the allocator for metadata in this cache.
-  /// The allocator can only be safely used while the cache is locked during
-  /// an addMetadataEntry call.
+  /// Get the allocator for metadata in this cache. The allocator may be
+  /// used from any thread.
   MetadataAllocator &getAllocator() { return Allocator; }
 
   /// Look up a cached metadata entry. If a cache match exists, return it.
@@ -334,11 +398,13 @@ public:
       }
 
       // Otherwise, we have to grab the lock and wait for the value to
-      // appear there.  Note that we have to check again immediately
-      // after acquiring the lock to prevent a race.
-      auto concurrency = Concurrency.get();
-      concurrency->Lock.withLockOrWait(concurrency->Queue, [&, this] {
-        if ((value = entry->getValue())) {
+      // appear there.  Registering as a waiter under the lock checks again
+      // for the value, and tells the building thread that it has to wake
+      // us up.
+      auto &waitQueue = getMetadataWaitQueue(entry);
+      waitQueue.Lock.withLockOrWait(waitQueue.Queue, [&, this] {
+        if (!entry->addWaiter()) {
+          value = entry->getValue();
           return true; // found a value, done waiting
         }
 
@@ -363,18 +429,25 @@ public:
     auto value = builder();
 
     // Update the linked list.
-    value->Next = Head;
-    Head = value;
+    auto head = Head.load(std::memory_order_relaxed);
+    do {
+      value->Next = head;
+    } while (!Head.compare_exchange_weak(head, value,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed));
 
 #if SWIFT_DEBUG_RUNTIME
         printf("%s(%p): created %p\n",
                ValueTy::getName(), (void*) this, value);
 #endif
 
-    // Acquire the lock, set the value, and notify any waiters.
-    auto concurrency = Concurrency.get();
-    concurrency->Lock.withLockThenNotifyAll(
-        concurrency->Queue, [&entry, &value] { entry->setValue(value); });
+    // Set the value. Only if other threads wait for it, acquire the lock
+    // and notify them; threads building other entries never contend with
+    // this one.
+    if (entry->setValue(value)) {
+      auto &waitQueue = getMetadataWaitQueue(entry);
+      waitQueue.Lock.withLockThenNotifyAll(waitQueue.Queue, [] {});
+    }
 
     return value;
   }
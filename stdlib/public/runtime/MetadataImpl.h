@@ -659,6 +659,10 @@ struct AggregateBox {
   }
 
   static char *initializeWithTake(char *dest, char *src) {
+    if (isBitwiseTakable) {
+      std::memcpy(dest, src, size);
+      return dest;
+    }
     return Helper::initializeWithTake(dest, src);
   }
     
@@ -692,7 +696,7 @@ struct AggregateBox {
     return r;
   }
   static char *initializeArrayWithTakeFrontToBack(char *dest, char *src, size_t n) {
-    if (isPOD) {
+    if (isBitwiseTakable) {
       std::memmove(dest, src, n * stride);
       return dest;
     }
@@ -705,7 +709,7 @@ struct AggregateBox {
     return r;
   }
   static char *initializeArrayWithTakeBackToFront(char *dest, char *src, size_t n) {
-    if (isPOD) {
+    if (isBitwiseTakable) {
       std::memmove(dest, src, n * stride);
       return dest;
     }
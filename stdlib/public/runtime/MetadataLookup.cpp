@@ -21,9 +21,11 @@
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/StringExtras.h"
+#include "MangledNameIndex.h"
 #include "Private.h"
 
 #if defined(__APPLE__) && defined(__MACH__)
@@ -82,6 +84,12 @@ namespace {
       return aName.compare(Name);
     }
 
+    static size_t getKeyHash(llvm::StringRef aName) {
+      // llvm::hash_value(StringRef) is defined out of line in a library
+      // the runtime doesn't link against.
+      return llvm::hash_combine_range(aName.begin(), aName.end());
+    }
+
     template <class... T>
     static size_t getExtraAllocationSize(T &&... ignored) {
       return 0;
@@ -104,10 +112,13 @@ static void _addImageTypeMetadataRecordsBlock(const uint8_t *records,
 
 struct TypeMetadataState {
   ConcurrentMap<TypeMetadataCacheEntry> Cache;
+  MangledNameIndex NameIndex;
   std::vector<TypeMetadataSection> SectionsToScan;
+  /// The size of SectionsToScan, readable without taking the lock.
+  std::atomic<size_t> NumSectionsToScan;
   Mutex SectionsToScanLock;
 
-  TypeMetadataState() {
+  TypeMetadataState() : NumSectionsToScan(0) {
     SectionsToScan.reserve(16);
 #if defined(__APPLE__) && defined(__MACH__)
     _initializeCallbacksToInspectDylib();
@@ -128,6 +139,8 @@ _registerTypeMetadataRecords(TypeMetadataState &T,
                              const TypeMetadataRecord *end) {
   ScopedLock guard(T.SectionsToScanLock);
   T.SectionsToScan.push_back(TypeMetadataSection{begin, end});
+  T.NumSectionsToScan.store(T.SectionsToScan.size(),
+                            std::memory_order_release);
 }
 
 static void _addImageTypeMetadataRecordsBlock(const uint8_t *records,
@@ -228,26 +241,17 @@ swift::_matchMetadataByMangledTypeName(const llvm::StringRef typeName,
 
 // returns the type metadata for the type named by typeName
 static const Metadata *
-_searchTypeMetadataRecords(const TypeMetadataState &T,
+_searchTypeMetadataRecords(TypeMetadataState &T,
                            const llvm::StringRef typeName) {
-  unsigned sectionIdx = 0;
-  unsigned endSectionIdx = T.SectionsToScan.size();
-  const Metadata *foundMetadata = nullptr;
-
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = T.SectionsToScan[sectionIdx];
-    for (const auto &record : section) {
-      if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
-
-      if (foundMetadata != nullptr)
-        return foundMetadata;
-    }
+  // Index the sections of any images loaded since the last lookup.
+  if (!T.NameIndex.isUpToDate(
+          T.NumSectionsToScan.load(std::memory_order_acquire))) {
+    T.SectionsToScanLock.withLock([&] {
+      T.NameIndex.indexNewSections(T.SectionsToScan);
+    });
   }
 
-  return nullptr;
+  return T.NameIndex.lookup(typeName);
 }
 
 static const Metadata *
@@ -261,9 +265,7 @@ _typeByMangledName(const llvm::StringRef typeName) {
     return Value->getMetadata();
 
   // Check type metadata records
-  T.SectionsToScanLock.withLock([&] {
-    foundMetadata = _searchTypeMetadataRecords(T, typeName);
-  });
+  foundMetadata = _searchTypeMetadataRecords(T, typeName);
 
   // Check protocol conformances table. Note that this has no support for
   // resolving generic types yet.
@@ -0,0 +1,117 @@
+//===--- MutexFutex.cpp - Supports Mutex.h using futexes ------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Mutex and ConditionVariable implementations built directly on Linux
+// futexes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Mutex.h"
+
+#if SWIFT_MUTEX_USE_FUTEX
+
+#include "swift/Runtime/Debug.h"
+#include <climits>
+#include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace swift;
+
+/// How many times a thread checks whether a locked mutex has been released
+/// before it goes to sleep.
+static const unsigned MutexSpinCount = 100;
+
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#endif
+}
+
+void swift::futexWait(std::atomic<uint32_t> &word, uint32_t expected) {
+  // EAGAIN means the word no longer held the expected value, and EINTR a
+  // signal; both are spurious wakeups the callers deal with.
+  if (syscall(SYS_futex, &word, FUTEX_WAIT_PRIVATE, expected, nullptr,
+              nullptr, 0) != 0 && errno != EAGAIN && errno != EINTR) {
+    fatalError(/* flags = */ 0, "'futex(FUTEX_WAIT)' failed with error %d\n",
+               errno);
+  }
+}
+
+void swift::futexWake(std::atomic<uint32_t> &word, int count) {
+  if (syscall(SYS_futex, &word, FUTEX_WAKE_PRIVATE, count, nullptr,
+              nullptr, 0) < 0) {
+    fatalError(/* flags = */ 0, "'futex(FUTEX_WAKE)' failed with error %d\n",
+               errno);
+  }
+}
+
+void ConditionPlatformHelper::notifyOne(ConditionHandle &condition) {
+  asAtomic(condition).fetch_add(1, std::memory_order_release);
+  futexWake(asAtomic(condition), 1);
+}
+
+void ConditionPlatformHelper::notifyAll(ConditionHandle &condition) {
+  asAtomic(condition).fetch_add(1, std::memory_order_release);
+  futexWake(asAtomic(condition), INT_MAX);
+}
+
+void ConditionPlatformHelper::wait(ConditionHandle &condition,
+                                   MutexHandle &mutex) {
+  // Notifiers hold the mutex, so reading the sequence number before
+  // releasing it guarantees that no notification is missed.
+  uint32_t sequence = asAtomic(condition).load(std::memory_order_relaxed);
+  MutexPlatformHelper::unlock(mutex);
+  futexWait(asAtomic(condition), sequence);
+
+  // Other waiters may have been woken together with this one.
+  MutexPlatformHelper::lockContended(mutex);
+}
+
+void MutexPlatformHelper::lockContended(MutexHandle &mutex) {
+  auto &state = asAtomic(mutex);
+  while (state.exchange(Contended, std::memory_order_acquire) != Unlocked)
+    futexWait(state, Contended);
+}
+
+void MutexPlatformHelper::lockSlow(MutexHandle &mutex) {
+  auto &state = asAtomic(mutex);
+
+  // The owner will likely release the mutex soon, so spinning is cheaper than
+  // sleeping. Once another thread sleeps on the mutex, the wait is not going
+  // to be short, so sleep right away.
+  for (unsigned spins = 0; spins != MutexSpinCount; ++spins) {
+    uint32_t current = state.load(std::memory_order_relaxed);
+    if (current == Contended)
+      break;
+    if (current == Unlocked &&
+        state.compare_exchange_weak(current, Locked,
+                                    std::memory_order_acquire,
+                                    std::memory_order_relaxed))
+      return;
+    cpuRelax();
+  }
+
+  lockContended(mutex);
+}
+
+void MutexPlatformHelper::unlockSlow(MutexHandle &mutex, uint32_t previous) {
+  if (previous == Unlocked) {
+    fatalError(/* flags = */ 0, "unlocking a mutex that is not locked\n");
+  }
+  futexWake(asAtomic(mutex), 1);
+}
+
+#endif
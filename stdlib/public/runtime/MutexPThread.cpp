@@ -62,6 +62,7 @@ static const char *errorName(int errorcode) {
   }
 }
 
+#if !SWIFT_MUTEX_USE_FUTEX
 void ConditionPlatformHelper::init(pthread_cond_t &condition) {
   reportError(pthread_cond_init(&condition, nullptr));
 }
@@ -108,6 +109,7 @@ bool MutexPlatformHelper::try_lock(pthread_mutex_t &mutex) {
   returnTrueOrReportError(pthread_mutex_trylock(&mutex),
                           /* returnFalseOnEBUSY = */ true);
 }
+#endif // !SWIFT_MUTEX_USE_FUTEX
 
 void ReadWriteLockPlatformHelper::init(pthread_rwlock_t &rwlock) {
   reportError(pthread_rwlock_init(&rwlock, nullptr));
@@ -28,6 +28,44 @@ using namespace swift;
 #include <dispatch/dispatch.h>
 static_assert(std::is_same<swift_once_t, dispatch_once_t>::value,
               "swift_once_t and dispatch_once_t must stay in sync");
+#else
+
+#include "swift/Runtime/Mutex.h"
+#include <atomic>
+
+static_assert(sizeof(std::atomic<swift_once_t>) == sizeof(swift_once_t),
+              "swift_once_t must be usable as an atomic word");
+
+enum : swift_once_t {
+  OnceNotStarted = 0,
+  OnceRunning = 1,
+  /// Running, and other threads may be asleep waiting for it to finish.
+  OnceRunningWithWaiters = 2,
+  OnceDone = ~swift_once_t(0),
+};
+
+#if SWIFT_MUTEX_USE_FUTEX
+#include <climits>
+
+/// Threads wait for a once function running on another thread by sleeping on
+/// the half of the predicate that holds the low bits, which tell all the
+/// states apart.
+static std::atomic<uint32_t> &
+getFutexWord(std::atomic<swift_once_t> *state) {
+  auto words = reinterpret_cast<std::atomic<uint32_t> *>(state);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return words[sizeof(swift_once_t) / sizeof(uint32_t) - 1];
+#else
+  return words[0];
+#endif
+}
+#else
+/// Guards the wait for a once function running on another thread. Waiting is
+/// rare, so one lock and condition serve every predicate.
+static StaticMutex OnceWaitLock;
+static StaticConditionVariable OnceWaitCondition;
+#endif
+
 #endif
 // The compiler generates the swift_once_t values as word-sized zero-initialized
 // variables, so we want to make sure swift_once_t isn't larger than the
@@ -41,15 +79,43 @@ static_assert(sizeof(swift_once_t) <= sizeof(void*),
 void swift::swift_once(swift_once_t *predicate, void (*fn)(void *)) {
 #if defined(__APPLE__)
   dispatch_once_f(predicate, nullptr, fn);
-#elif defined(__CYGWIN__)
-  _swift_once_f(predicate, nullptr, fn);
 #else
-  // FIXME: We're relying here on the coincidence that libstdc++ uses pthread's
-  // pthread_once, and that on glibc pthread_once follows a compatible init
-  // process (the token is a word that is atomically incremented from 0 to
-  // 1 to 2 during initialization) to work. We should implement our own version
-  // that we can rely on to continue to work that way.
-  // For more information, see rdar://problem/18499385
-  std::call_once(*predicate, [fn]() { fn(nullptr); });
+  // IRGen inlines this check, so the call is normally only made before the
+  // function has finished running.
+  auto state = reinterpret_cast<std::atomic<swift_once_t> *>(predicate);
+  if (LLVM_LIKELY(state->load(std::memory_order_acquire) == OnceDone))
+    return;
+
+  swift_once_t expected = OnceNotStarted;
+  if (state->compare_exchange_strong(expected, OnceRunning,
+                                     std::memory_order_acquire)) {
+    fn(nullptr);
+#if SWIFT_MUTEX_USE_FUTEX
+    if (state->exchange(OnceDone, std::memory_order_release) ==
+        OnceRunningWithWaiters)
+      futexWake(getFutexWord(state), INT_MAX);
+#else
+    OnceWaitLock.withLockThenNotifyAll(OnceWaitCondition, [&] {
+      state->store(OnceDone, std::memory_order_release);
+    });
+#endif
+    return;
+  }
+
+#if SWIFT_MUTEX_USE_FUTEX
+  // Only sleep once the running thread is sure to wake us up.
+  while (expected != OnceDone) {
+    if (expected == OnceRunning &&
+        !state->compare_exchange_weak(expected, OnceRunningWithWaiters,
+                                      std::memory_order_acquire))
+      continue;
+    futexWait(getFutexWord(state), uint32_t(OnceRunningWithWaiters));
+    expected = state->load(std::memory_order_acquire);
+  }
+#else
+  OnceWaitLock.withLockOrWait(OnceWaitCondition, [&] {
+    return state->load(std::memory_order_acquire) == OnceDone;
+  });
+#endif
 #endif
 }
@@ -19,6 +19,9 @@
 #include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/Statistics.h"
+#include "llvm/ADT/Hashing.h"
+#include "MangledNameIndex.h"
 #include "Private.h"
 
 #if defined(__APPLE__) && defined(__MACH__)
@@ -29,7 +32,9 @@
 #include <link.h>
 #endif
 
+#include <algorithm>
 #include <dlfcn.h>
+#include <vector>
 
 using namespace swift;
 
@@ -159,6 +164,88 @@ namespace {
     }
   };
 
+  /// An entry in the lookup index of a protocol's conformance records.
+  struct ConformanceIndexEntry {
+    /// Either the canonical Metadata* or the NominalTypeDescriptor* the
+    /// record applies to.
+    const void *Type;
+    const ProtocolConformanceRecord *Record;
+
+    bool operator<(const ConformanceIndexEntry &other) const {
+      return uintptr_t(Type) < uintptr_t(other.Type);
+    }
+  };
+
+  /// The conformance records registered for a single protocol.
+  ///
+  /// Records are bucketed by protocol as images are registered, which only
+  /// requires reading each record's protocol reference. The more expensive
+  /// work of resolving the records' types is deferred until a lookup for
+  /// the protocol misses the cache.
+  struct ProtocolConformanceBucket {
+  private:
+    const ProtocolDescriptor *Proto;
+
+    /// The number of records that have been registered for the protocol.
+    /// Cached negative results for the protocol are valid only as long as
+    /// this doesn't change. This can be read without holding
+    /// SectionsToScanLock.
+    std::atomic<uintptr_t> Generation;
+
+    /// The registered records, in registration order.
+    std::vector<const ProtocolConformanceRecord *> Records;
+
+    /// The records that apply to a specific type, sorted by type. This
+    /// covers the first NumIndexed entries of Records.
+    std::vector<ConformanceIndexEntry> Index;
+    size_t NumIndexed;
+
+  public:
+    ProtocolConformanceBucket(const ProtocolDescriptor *proto)
+      : Proto(proto), Generation(0), NumIndexed(0) {}
+
+    int compareWithKey(const ProtocolDescriptor *proto) const {
+      if (proto != Proto)
+        return (uintptr_t(proto) < uintptr_t(Proto) ? -1 : 1);
+      return 0;
+    }
+
+    static size_t getKeyHash(const ProtocolDescriptor *proto) {
+      return llvm::hash_value(proto);
+    }
+
+    template <class... Args>
+    static size_t getExtraAllocationSize(Args &&... ignored) {
+      return 0;
+    }
+
+    uintptr_t getGeneration() const {
+      return Generation.load(std::memory_order_acquire);
+    }
+
+    /// Add a newly-registered record. Must be called with
+    /// SectionsToScanLock held.
+    void addRecord(const ProtocolConformanceRecord *record) {
+      Records.push_back(record);
+      Generation.store(Records.size(), std::memory_order_release);
+    }
+
+    /// Resolve the types of any records added since the last call and add
+    /// them to the index. Must be called with SectionsToScanLock held.
+    void indexPendingRecords();
+
+    /// Call \p fn with every record that applies to \p type, which is a
+    /// Metadata* or a NominalTypeDescriptor*. Must be called with
+    /// SectionsToScanLock held.
+    template <class Fn>
+    void forEachRecord(const void *type, const Fn &fn) const {
+      ConformanceIndexEntry key{type, nullptr};
+      auto range = std::equal_range(Index.begin(), Index.end(), key);
+      for (auto i = range.first; i != range.second; ++i)
+        fn(*i->Record);
+    }
+  };
+
   struct ConformanceCacheKey {
     /// Either a Metadata* or a NominalTypeDescriptor*.
     const void *Type;
@@ -193,6 +280,10 @@ namespace {
       }
     }
 
+    static size_t getKeyHash(const ConformanceCacheKey &key) {
+      return llvm::hash_combine(key.Type, key.Proto);
+    }
+
     template <class... Args>
     static size_t getExtraAllocationSize(Args &&... ignored) {
       return 0;
@@ -241,10 +332,14 @@ static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
 
 struct ConformanceState {
   ConcurrentMap<ConformanceCacheEntry> Cache;
+  ConcurrentMap<ProtocolConformanceBucket> Buckets;
+  MangledNameIndex NameIndex;
   std::vector<ConformanceSection> SectionsToScan;
+  /// The size of SectionsToScan, readable without taking the lock.
+  std::atomic<size_t> NumSectionsToScan;
   Mutex SectionsToScanLock;
   
-  ConformanceState() {
+  ConformanceState() : NumSectionsToScan(0) {
     SectionsToScan.reserve(16);
 #if defined(__APPLE__) && defined(__MACH__)
     _initializeCallbacksToInspectDylib();
@@ -267,7 +362,7 @@ struct ConformanceState {
   }
 
   void cacheFailure(const void *type, const ProtocolDescriptor *proto) {
-    uintptr_t failureGeneration = SectionsToScan.size();
+    uintptr_t failureGeneration = getGeneration(proto);
     auto result = Cache.getOrInsert(ConformanceCacheKey(type, proto),
                                     (const WitnessTable *) nullptr,
                                     failureGeneration);
@@ -282,6 +377,13 @@ struct ConformanceState {
                                     const ProtocolDescriptor *proto) {
     return Cache.find(ConformanceCacheKey(type, proto));
   }
+
+  /// Get the generation number of the records registered for \p proto.
+  uintptr_t getGeneration(const ProtocolDescriptor *proto) {
+    if (auto bucket = Buckets.find(proto))
+      return bucket->getGeneration();
+    return 0;
+  }
 };
 
 static Lazy<ConformanceState> Conformances;
@@ -292,6 +394,23 @@ _registerProtocolConformances(ConformanceState &C,
                               const ProtocolConformanceRecord *end) {
   ScopedLock guard(C.SectionsToScanLock);
   C.SectionsToScan.push_back(ConformanceSection{begin, end});
+  C.NumSectionsToScan.store(C.SectionsToScan.size(),
+                            std::memory_order_release);
+
+  // Bucket the records by protocol, so that lookups only have to consider
+  // records for the protocol they're asking about, and so that loading an
+  // image only invalidates negative cache entries for the protocols it
+  // actually adds conformances to.
+  ProtocolConformanceBucket *bucket = nullptr;
+  const ProtocolDescriptor *bucketProto = nullptr;
+  for (auto record = begin; record != end; ++record) {
+    auto proto = record->getProtocol();
+    if (!bucket || proto != bucketProto) {
+      bucket = C.Buckets.getOrInsert(proto).first;
+      bucketProto = proto;
+    }
+    bucket->addRecord(record);
+  }
 }
 
 static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
@@ -442,6 +561,81 @@ swift::swift_registerProtocolConformances(const ProtocolConformanceRecord *begin
   _registerProtocolConformances(C, begin, end);
 }
 
+void ProtocolConformanceBucket::indexPendingRecords() {
+  if (NumIndexed == Records.size())
+    return;
+
+  size_t oldIndexSize = Index.size();
+  for (; NumIndexed != Records.size(); ++NumIndexed) {
+    auto &record = *Records[NumIndexed];
+
+    // If the record applies to a specific type, index it by the type's
+    // canonical metadata.
+    if (auto metadata = record.getCanonicalTypeMetadata()) {
+      Index.push_back({metadata, &record});
+
+    // If the record provides a nondependent witness table for all instances
+    // of a generic type, index it by the nominal type descriptor.
+    // TODO: "Nondependent witness table" probably deserves its own flag.
+    // An accessor function might still be necessary even if the witness table
+    // can be shared.
+    } else if (record.getTypeKind()
+                 == TypeMetadataRecordKind::UniqueNominalTypeDescriptor
+               && record.getConformanceKind()
+                 == ProtocolConformanceReferenceKind::WitnessTable) {
+      Index.push_back({record.getNominalTypeDescriptor(), &record});
+    }
+
+    // Universal records and weak-linked classes that aren't present never
+    // match a lookup, so they aren't indexed.
+  }
+
+  // Sort the new entries and merge them into the existing index.
+  auto middle = Index.begin() + oldIndexSize;
+  std::sort(middle, Index.end());
+  std::inplace_merge(Index.begin(), middle, Index.end());
+}
+
+/// Pull the records in \p bucket that apply to \p type, its superclasses,
+/// or their nominal type descriptors into the cache.
+static void cacheRelatedConformances(ConformanceState &C,
+                                     const ProtocolConformanceBucket &bucket,
+                                     const Metadata *type,
+                                     const ProtocolDescriptor *protocol) {
+  while (true) {
+    // Records for this specific type.
+    bucket.forEachRecord(type, [&](const ProtocolConformanceRecord &record) {
+      auto metadata = record.getCanonicalTypeMetadata();
+      auto witness = record.getWitnessTable(metadata);
+      if (witness) {
+        C.cacheSuccess(metadata, protocol, witness);
+      } else {
+        C.cacheFailure(metadata, protocol);
+      }
+    });
+
+    // For generic and resilient types, nondependent conformances
+    // are keyed by the nominal type descriptor rather than the
+    // metadata.
+    if (auto *description = type->getNominalTypeDescriptor().get()) {
+      bucket.forEachRecord(description,
+                           [&](const ProtocolConformanceRecord &record) {
+        C.cacheSuccess(description, protocol, record.getStaticWitnessTable());
+      });
+    }
+
+    // If the type is a class, try its superclass.
+    if (const ClassMetadata *classType = type->getClassObject()) {
+      if (classHasSuperclass(classType)) {
+        type = swift_getObjCClassMetadata(classType->SuperClass);
+        continue;
+      }
+    }
+
+    break;
+  }
+}
+
 /// Search the witness table in the ConformanceCache. \returns a pair of the
 /// WitnessTable pointer and a boolean value True if a definitive value is
 /// found. \returns false if the type or its superclasses were not found in
@@ -472,7 +666,7 @@ recur_inside_cache_lock:
         foundEntry = Value;
 
       // If we got a cached negative response, check the generation number.
-      if (Value->getFailureGeneration() == C.SectionsToScan.size()) {
+      if (Value->getFailureGeneration() == C.getGeneration(protocol)) {
         // We found an entry with a negative value.
         return std::make_pair(nullptr, true);
       }
@@ -507,54 +701,19 @@ recur_inside_cache_lock:
   return std::make_pair(nullptr, false);
 }
 
-/// Checks if a given candidate is a type itself, one of its
-/// superclasses or a related generic type.
-///
-/// This check is supposed to use the same logic that is used
-/// by searchInConformanceCache.
-///
-/// \param candidate Pointer to a Metadata or a NominalTypeDescriptor.
-///
-static
-bool isRelatedType(const Metadata *type, const void *candidate,
-                   bool candidateIsMetadata) {
-
-  while (true) {
-    if (type == candidate && candidateIsMetadata)
-      return true;
-
-    // If the type is resilient or generic, see if there's a witness table
-    // keyed off the nominal type descriptor.
-    auto *description = type->getNominalTypeDescriptor().get();
-    if (description == candidate && !candidateIsMetadata)
-      return true;
-
-    // If the type is a class, try its superclass.
-    if (const ClassMetadata *classType = type->getClassObject()) {
-      if (classHasSuperclass(classType)) {
-        type = swift_getObjCClassMetadata(classType->SuperClass);
-        continue;
-      }
-    }
-
-    break;
-  }
-
-  return false;
-}
-
 const WitnessTable *
 swift::swift_conformsToProtocol(const Metadata *type,
                                 const ProtocolDescriptor *protocol) {
+  countRuntimeStatistic(RuntimeStatistic::ConformanceLookups);
   auto &C = Conformances.get();
   auto origType = type;
-  unsigned numSections = 0;
+  uintptr_t scannedGeneration = 0;
   ConformanceCacheEntry *foundEntry;
 
 recur:
   // See if we have a cached conformance. The ConcurrentMap data structure
   // allows us to insert and search the map concurrently without locking.
-  // We do lock the slow path because the SectionsToScan data structure is not
+  // We do lock the slow path because the protocol's record index is not
   // concurrent.
   auto FoundConformance = searchInConformanceCache(type, protocol, foundEntry);
   // The negative answer does not always mean that there is no conformance,
@@ -572,7 +731,9 @@ recur:
 
   // If we have no new information to pull in (and nobody else pulled in
   // new information while we waited on the lock), we're done.
-  if (C.SectionsToScan.size() == numSections) {
+  auto bucket = C.Buckets.find(protocol);
+  uintptr_t generation = bucket ? bucket->getGeneration() : 0;
+  if (generation == scannedGeneration) {
     if (failedGeneration != ConformanceCacheGeneration) {
       // Someone else pulled in new conformances while we were waiting.
       // Start over with our newly-populated cache.
@@ -589,61 +750,11 @@ recur:
     return nullptr;
   }
 
-  // Update the last known number of sections to scan.
-  numSections = C.SectionsToScan.size();
-
-  // Scan only sections that were not scanned yet.
-  unsigned sectionIdx = foundEntry ? foundEntry->getFailureGeneration() : 0;
-  unsigned endSectionIdx = C.SectionsToScan.size();
-
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = C.SectionsToScan[sectionIdx];
-    // Eagerly pull records for nondependent witnesses into our cache.
-    for (const auto &record : section) {
-      // If the record applies to a specific type, cache it.
-      if (auto metadata = record.getCanonicalTypeMetadata()) {
-        auto P = record.getProtocol();
-
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
-
-        if (!isRelatedType(type, metadata, /*isMetadata=*/true))
-          continue;
-
-        // Store the type-protocol pair in the cache.
-        auto witness = record.getWitnessTable(metadata);
-        if (witness) {
-          C.cacheSuccess(metadata, P, witness);
-        } else {
-          C.cacheFailure(metadata, P);
-        }
-
-      // If the record provides a nondependent witness table for all instances
-      // of a generic type, cache it for the generic pattern.
-      // TODO: "Nondependent witness table" probably deserves its own flag.
-      // An accessor function might still be necessary even if the witness table
-      // can be shared.
-      } else if (record.getTypeKind()
-                   == TypeMetadataRecordKind::UniqueNominalTypeDescriptor
-                 && record.getConformanceKind()
-                   == ProtocolConformanceReferenceKind::WitnessTable) {
-
-        auto R = record.getNominalTypeDescriptor();
-        auto P = record.getProtocol();
-
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
-
-        if (!isRelatedType(type, R, /*isMetadata=*/false))
-          continue;
-
-        // Store the type-protocol pair in the cache.
-        C.cacheSuccess(R, P, record.getStaticWitnessTable());
-      }
-    }
-  }
+  // Update the last known generation of the protocol's records, and pull
+  // in the records for the type.
+  scannedGeneration = generation;
+  bucket->indexPendingRecords();
+  cacheRelatedConformances(C, *bucket, type, protocol);
   ++ConformanceCacheGeneration;
 
   C.SectionsToScanLock.unlock();
@@ -655,27 +766,13 @@ recur:
 const Metadata *
 swift::_searchConformancesByMangledTypeName(const llvm::StringRef typeName) {
   auto &C = Conformances.get();
-  const Metadata *foundMetadata = nullptr;
 
-  ScopedLock guard(C.SectionsToScanLock);
-
-  unsigned sectionIdx = 0;
-  unsigned endSectionIdx = C.SectionsToScan.size();
-
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = C.SectionsToScan[sectionIdx];
-    for (const auto &record : section) {
-      if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
-
-      if (foundMetadata != nullptr)
-        break;
-    }
-    if (foundMetadata != nullptr)
-      break;
+  // Index the sections of any images loaded since the last lookup.
+  if (!C.NameIndex.isUpToDate(
+          C.NumSectionsToScan.load(std::memory_order_acquire))) {
+    ScopedLock guard(C.SectionsToScanLock);
+    C.NameIndex.indexNewSections(C.SectionsToScan);
   }
 
-  return foundMetadata;
+  return C.NameIndex.lookup(typeName);
 }
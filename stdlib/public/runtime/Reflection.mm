@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Reflection.h"
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
@@ -18,6 +20,7 @@
 #include "swift/Basic/Demangle.h"
 #include "swift/Runtime/Debug.h"
 #include "swift/Runtime/Portability.h"
+#include "llvm/ADT/Hashing.h"
 #include "Private.h"
 #include <cassert>
 #include <cstdio>
@@ -450,16 +453,79 @@ void swift_TupleMirror_subscript(String *outString,
   new (outMirror) Mirror(reflect(owner, eltData, elt.Type));
 }
   
-// Get a field name from a doubly-null-terminated list.
-static const char *getFieldName(const char *fieldNames, size_t i) {
-  const char *fieldName = fieldNames;
-  for (size_t j = 0; j < i; ++j) {
-    size_t len = strlen(fieldName);
-    assert(len != 0);
-    fieldName += len + 1;
+/// A field or case name, with its length so that turning it into a String
+/// doesn't have to scan it again.
+struct FieldName {
+  const char *Name;
+  size_t Length;
+};
+
+/// The names in a doubly-null-terminated list of field or case names, indexed
+/// once so that reflecting a value's children doesn't rescan the list for
+/// every child.
+class FieldNameTableEntry {
+  const char *Key;
+  size_t NumNames;
+
+public:
+  FieldNameTableEntry(const char *fieldNames, size_t numNames)
+    : Key(fieldNames), NumNames(numNames) {
+    const char *fieldName = fieldNames;
+    for (size_t i = 0; i != numNames; ++i) {
+      size_t len = strlen(fieldName);
+      assert(len != 0);
+      getNames()[i] = FieldName{fieldName, len};
+      fieldName += len + 1;
+    }
   }
 
-  return fieldName;
+  FieldName *getNames() {
+    return reinterpret_cast<FieldName *>(this + 1);
+  }
+
+  const FieldName &getName(size_t i) {
+    assert(i < NumNames && "field name index out of range");
+    return getNames()[i];
+  }
+
+  int compareWithKey(const char *key) const {
+    if (key != Key)
+      return (uintptr_t(key) < uintptr_t(Key) ? -1 : 1);
+    return 0;
+  }
+
+  long getKeyIntValueForDump() const {
+    return reinterpret_cast<long>(Key);
+  }
+
+  static size_t getKeyHash(const char *key) {
+    return llvm::hash_value(key);
+  }
+
+  static size_t getExtraAllocationSize(const char *fieldNames,
+                                       size_t numNames) {
+    return numNames * sizeof(FieldName);
+  }
+};
+
+/// The indexed name lists, keyed by the list itself. Every instantiation of
+/// a generic type shares its nominal type descriptor, and with it one entry.
+static Lazy<ConcurrentMap<FieldNameTableEntry>> FieldNameTables;
+
+// Get a field name from a doubly-null-terminated list of \p numNames names.
+static const FieldName &getFieldName(const char *fieldNames, size_t numNames,
+                                     size_t i) {
+  auto &tables = FieldNameTables.get();
+  auto entry = tables.find(fieldNames);
+  if (!entry)
+    entry = tables.getOrInsert(fieldNames, numNames).first;
+  return entry->getName(i);
+}
+
+static String makeFieldNameString(const char *fieldNames, size_t numNames,
+                                  size_t i) {
+  auto &fieldName = getFieldName(fieldNames, numNames, i);
+  return String(fieldName.Name, fieldName.Length);
 }
 
 // -- Struct destructuring.
@@ -484,7 +550,7 @@ void swift_StructMirror_subscript(String *outString,
                                   const Metadata *type) {
   auto Struct = static_cast<const StructMetadata *>(type);
   
-  if (i < 0 || (size_t)i > Struct->Description->Struct.NumFields)
+  if (i < 0 || (size_t)i >= Struct->Description->Struct.NumFields)
     swift::crash("Swift mirror subscript bounds check failure");
   
   // Load the type and offset from their respective vectors.
@@ -494,7 +560,9 @@ void swift_StructMirror_subscript(String *outString,
   auto bytes = reinterpret_cast<const char*>(value);
   auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + fieldOffset);
 
-  new (outString) String(getFieldName(Struct->Description->Struct.FieldNames, i));
+  new (outString) String(makeFieldNameString(
+      Struct->Description->Struct.FieldNames,
+      Struct->Description->Struct.NumFields, i));
 
   // 'owner' is consumed by this call.
   assert(!fieldType.isIndirect() && "indirect struct fields not implemented");
@@ -565,7 +633,8 @@ const char *swift_EnumMirror_caseName(HeapObject *owner,
 
   swift_release(owner);
 
-  return getFieldName(Description.CaseNames, tag);
+  return getFieldName(Description.CaseNames, Description.getNumCases(),
+                      tag).Name;
 }
 
 SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
@@ -648,7 +717,8 @@ void swift_EnumMirror_subscript(String *outString,
     swift_release(pair.first);
   }
 
-  new (outString) String(getFieldName(Description.CaseNames, tag));
+  new (outString) String(makeFieldNameString(Description.CaseNames,
+                                             Description.getNumCases(), tag));
   new (outMirror) Mirror(reflect(owner, value, payloadType));
 }
   
@@ -700,7 +770,7 @@ void swift_ClassMirror_subscript(String *outString,
     --i;
   }
   
-  if (i < 0 || (size_t)i > Clas->getDescription()->Class.NumFields)
+  if (i < 0 || (size_t)i >= Clas->getDescription()->Class.NumFields)
     swift::crash("Swift mirror subscript bounds check failure");
   
   // Load the type and offset from their respective vectors.
@@ -727,7 +797,9 @@ void swift_ClassMirror_subscript(String *outString,
   auto bytes = *reinterpret_cast<const char * const*>(value);
   auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + fieldOffset);
   
-  new (outString) String(getFieldName(Clas->getDescription()->Class.FieldNames, i));
+  new (outString) String(makeFieldNameString(
+      Clas->getDescription()->Class.FieldNames,
+      Clas->getDescription()->Class.NumFields, i));
   // 'owner' is consumed by this call.
   new (outMirror) Mirror(reflect(owner, fieldData, fieldType.getType()));
 }
@@ -0,0 +1,190 @@
+//===--- Statistics.cpp - Swift Runtime Statistics ------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Per-thread counters of runtime calls, enabled by SWIFT_RUNTIME_STATISTICS.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Statistics.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Debug.h"
+#include "swift/Runtime/Mutex.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Counting relies on pthread keys to find each thread's block and to fold
+// it into the totals when the thread exits.
+#if defined(_WIN32) && !defined(__CYGWIN__)
+#define SWIFT_RUNTIME_STATISTICS_SUPPORTED 0
+#else
+#define SWIFT_RUNTIME_STATISTICS_SUPPORTED 1
+#include <pthread.h>
+#endif
+
+using namespace swift;
+
+std::atomic<int> swift::_swift_runtimeStatisticsState(1);
+
+static const unsigned NumStatistics = 0
+#define RUNTIME_STATISTIC(Id, Description) + 1
+#include "swift/Runtime/Statistics.def"
+  ;
+
+static const char * const StatisticDescriptions[NumStatistics] = {
+#define RUNTIME_STATISTIC(Id, Description) Description,
+#include "swift/Runtime/Statistics.def"
+};
+
+namespace {
+
+/// The counters of one thread. Only the owning thread writes them, so they
+/// can be bumped without a locked instruction; other threads only read them
+/// when computing the totals.
+struct ThreadStatistics {
+  std::atomic<uint64_t> Counts[NumStatistics];
+  ThreadStatistics *Prev;
+  ThreadStatistics *Next;
+};
+
+class StatisticsRegistry {
+  bool Enabled = false;
+
+#if SWIFT_RUNTIME_STATISTICS_SUPPORTED
+  pthread_key_t Key;
+
+  /// Guards Threads and Retired.
+  Mutex Lock;
+
+  /// The blocks of the threads that have counted something.
+  ThreadStatistics *Threads = nullptr;
+
+  /// The counts of the threads that have exited.
+  uint64_t Retired[NumStatistics] = {};
+
+  static void destroyThreadStatistics(void *block);
+#endif
+
+public:
+  StatisticsRegistry();
+
+  bool isEnabled() const { return Enabled; }
+
+  void count(RuntimeStatistic stat);
+
+  void getTotals(uint64_t (&totals)[NumStatistics]);
+};
+
+} // end anonymous namespace
+
+static Lazy<StatisticsRegistry> Registry;
+
+static void dumpStatisticsAtExit() {
+  swift_dumpRuntimeStatistics();
+}
+
+StatisticsRegistry::StatisticsRegistry() {
+#if SWIFT_RUNTIME_STATISTICS_SUPPORTED
+  if (const char *value = getenv("SWIFT_RUNTIME_STATISTICS"))
+    Enabled = value[0] != '\0' && strcmp(value, "0") != 0;
+  if (Enabled && pthread_key_create(&Key, destroyThreadStatistics) != 0)
+    Enabled = false;
+  if (Enabled)
+    atexit(dumpStatisticsAtExit);
+#endif
+
+  _swift_runtimeStatisticsState.store(Enabled ? 2 : 0,
+                                      std::memory_order_relaxed);
+}
+
+void StatisticsRegistry::count(RuntimeStatistic stat) {
+#if SWIFT_RUNTIME_STATISTICS_SUPPORTED
+  auto block = static_cast<ThreadStatistics*>(pthread_getspecific(Key));
+  if (LLVM_UNLIKELY(!block)) {
+    block = static_cast<ThreadStatistics*>(calloc(1, sizeof(ThreadStatistics)));
+    if (!block) swift::crash("Could not allocate memory.");
+    Lock.withLock([&] {
+      block->Next = Threads;
+      if (Threads)
+        Threads->Prev = block;
+      Threads = block;
+    });
+    pthread_setspecific(Key, block);
+  }
+
+  auto &counter = block->Counts[unsigned(stat)];
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+#endif
+}
+
+#if SWIFT_RUNTIME_STATISTICS_SUPPORTED
+void StatisticsRegistry::destroyThreadStatistics(void *blockPtr) {
+  auto &registry = Registry.unsafeGetAlreadyInitialized();
+  auto block = static_cast<ThreadStatistics*>(blockPtr);
+
+  registry.Lock.withLock([&] {
+    for (unsigned i = 0; i != NumStatistics; ++i)
+      registry.Retired[i] += block->Counts[i].load(std::memory_order_relaxed);
+    if (block->Prev)
+      block->Prev->Next = block->Next;
+    else
+      registry.Threads = block->Next;
+    if (block->Next)
+      block->Next->Prev = block->Prev;
+  });
+  free(block);
+}
+#endif
+
+void StatisticsRegistry::getTotals(uint64_t (&totals)[NumStatistics]) {
+  memset(totals, 0, sizeof(totals));
+#if SWIFT_RUNTIME_STATISTICS_SUPPORTED
+  if (!Enabled)
+    return;
+
+  Lock.withLock([&] {
+    for (unsigned i = 0; i != NumStatistics; ++i)
+      totals[i] = Retired[i];
+    for (auto block = Threads; block; block = block->Next)
+      for (unsigned i = 0; i != NumStatistics; ++i)
+        totals[i] += block->Counts[i].load(std::memory_order_relaxed);
+  });
+#endif
+}
+
+void swift::_swift_countRuntimeStatistic(RuntimeStatistic stat) {
+  auto &registry = Registry.get();
+  if (registry.isEnabled())
+    registry.count(stat);
+}
+
+bool swift_runtimeStatistics(SwiftRuntimeStatistics *stats) {
+  auto &registry = Registry.get();
+  uint64_t totals[NumStatistics];
+  registry.getTotals(totals);
+
+  unsigned i = 0;
+#define RUNTIME_STATISTIC(Id, Description) stats->Id = totals[i++];
+#include "swift/Runtime/Statistics.def"
+  return registry.isEnabled();
+}
+
+void swift_dumpRuntimeStatistics() {
+  uint64_t totals[NumStatistics];
+  Registry.get().getTotals(totals);
+
+  fprintf(stderr, "Swift runtime statistics:\n");
+  for (unsigned i = 0; i != NumStatistics; ++i)
+    fprintf(stderr, "%20llu %s\n", (unsigned long long)totals[i],
+            StatisticDescriptions[i]);
+}
@@ -0,0 +1,48 @@
+//===--- FloatingPointDigits.h - Decimal conversions ------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Conversions between binary floating-point values and their decimal digits
+// that don't go through libc or depend on the current locale.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_STUBS_FLOATINGPOINTDIGITS_H
+#define SWIFT_STUBS_FLOATINGPOINTDIGITS_H
+
+#include <cstdint>
+
+namespace swift {
+
+/// The decimal value Significand * 10^Exponent.
+struct DecimalDigits {
+  uint64_t Significand;
+  int Exponent;
+};
+
+/// Returns the decimal value with the fewest significant digits that rounds
+/// to the magnitude of \p value, choosing the one closest to \p value if
+/// there are several. The value must be finite; its sign is ignored.
+/// Zero is returned as 0 * 10^0.
+DecimalDigits shortestDecimalDigits(double value);
+DecimalDigits shortestDecimalDigits(float value);
+
+/// Parses the decimal number at the start of \p str the way strtod would in
+/// the C locale, and returns the end of the number, if the number has at
+/// most 19 significant digits and its value is zero or a normal number.
+/// Otherwise returns null and leaves \p result unchanged; strtod should be
+/// used instead.
+const char *parseDecimal(const char *str, double &result);
+const char *parseDecimal(const char *str, float &result);
+
+} // end namespace swift
+
+#endif // SWIFT_STUBS_FLOATINGPOINTDIGITS_H
@@ -30,6 +30,9 @@ swift::_SwiftEmptyArrayStorage swift::_swiftEmptyArrayStorage = {
   // HeapObject header;
   {
     &_TMCs18_EmptyArrayStorage, // isa pointer
+    // Every empty array in the process shares this object, so don't make
+    // threads contend on its reference count.
+    StrongRefCount::Immortal
   },
   
   // _SwiftArrayBodyStorage body;
@@ -39,6 +42,21 @@ swift::_SwiftEmptyArrayStorage swift::_swiftEmptyArrayStorage = {
   }
 };
 
+#define ASCII_1(c) (c), 0
+#define ASCII_4(c) ASCII_1(c), ASCII_1(c + 1), ASCII_1(c + 2), ASCII_1(c + 3)
+#define ASCII_16(c) ASCII_4(c), ASCII_4(c + 4), ASCII_4(c + 8), ASCII_4(c + 12)
+#define ASCII_64(c) \
+  ASCII_16(c), ASCII_16(c + 16), ASCII_16(c + 32), ASCII_16(c + 48)
+
+__swift_uint8_t swift::_swift_stdlib_singleASCIIStringStorage[256] = {
+  ASCII_64(0), ASCII_64(64)
+};
+
+#undef ASCII_64
+#undef ASCII_16
+#undef ASCII_4
+#undef ASCII_1
+
 __swift_uint64_t swift::_swift_stdlib_HashingDetail_fixedSeedOverride = 0;
 
 /// Backing storage for Swift.Process.arguments.
@@ -16,6 +16,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "swift/Runtime/Heap.h"
 #include "../SwiftShims/LibcShims.h"
 
 using namespace swift;
@@ -60,24 +61,10 @@ int swift::_swift_stdlib_close(int fd) {
   return close(fd);
 }
 
-#if defined(__APPLE__)
-#include <malloc/malloc.h>
 size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
-  return malloc_size(ptr);
+  // Swift objects aren't necessarily allocated by malloc, so ask the runtime.
+  return swift::_swift_slowAllocUsableSize(ptr);
 }
-#elif defined(__GNU_LIBRARY__) || defined(__CYGWIN__) || defined(__ANDROID__)
-#include <malloc.h>
-size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
-  return malloc_usable_size(const_cast<void *>(ptr));
-}
-#elif defined(__FreeBSD__)
-#include <malloc_np.h>
-size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
-  return malloc_usable_size(const_cast<void *>(ptr));
-}
-#else
-#error No malloc_size analog known for this platform/libc.
-#endif
 
 static std::mt19937 &getGlobalMT19937() {
   static std::mt19937 MersenneRandom;
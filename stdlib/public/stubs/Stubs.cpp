@@ -56,39 +56,103 @@ static long double swift_strtold_l(const char *nptr,
 #else
 #include <xlocale.h>
 #endif
+#include <cmath>
 #include <limits>
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/MathExtras.h"
 #include "swift/Runtime/Debug.h"
 #include "swift/Basic/Lazy.h"
 
 #include "../SwiftShims/RuntimeShims.h"
 #include "../SwiftShims/RuntimeStubs.h"
+#include "FloatingPointDigits.h"
+
+/// The two-digit decimal strings "00" through "99", in order.
+static const char DecimalDigitPairs[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+/// Returns the number of digits needed to write \p Value, which is at least
+/// one, in the given radix.
+static unsigned countDigits(uint64_t Value, unsigned Radix) {
+  if (Radix == 10) {
+    // Count four digits at a time; most values have few digits.
+    unsigned Count = 1;
+    for (;;) {
+      if (Value < 10)
+        return Count;
+      if (Value < 100)
+        return Count + 1;
+      if (Value < 1000)
+        return Count + 2;
+      if (Value < 10000)
+        return Count + 3;
+      Value /= 10000;
+      Count += 4;
+    }
+  }
+  if ((Radix & (Radix - 1)) == 0) {
+    unsigned Shift = llvm::countTrailingZeros(Radix);
+    unsigned Bits = Value == 0 ? 1 : 64 - llvm::countLeadingZeros(Value);
+    return (Bits + Shift - 1) / Shift;
+  }
+  unsigned Count = 1;
+  for (; Value >= Radix; Value /= Radix)
+    ++Count;
+  return Count;
+}
 
+/// Writes \p Value in the given radix, preceded by a minus sign if
+/// \p Negative, and returns the number of characters written. The length is
+/// computed up front so that the digits can be written in place from the end.
 static uint64_t uint64ToStringImpl(char *Buffer, uint64_t Value,
                                    int64_t Radix, bool Uppercase,
                                    bool Negative) {
-  char *P = Buffer;
-  uint64_t Y = Value;
-
-  if (Y == 0) {
-    *P++ = '0';
-  } else if (Radix == 10) {
-    while (Y) {
-      *P++ = '0' + char(Y % 10);
-      Y /= 10;
+  unsigned Radix32 = Radix;
+  unsigned Length = countDigits(Value, Radix32) + Negative;
+  char *P = Buffer + Length;
+
+  if (Radix32 == 10) {
+    // Two digits per division.
+    while (Value >= 100) {
+      unsigned Pair = unsigned(Value % 100) * 2;
+      Value /= 100;
+      *--P = DecimalDigitPairs[Pair + 1];
+      *--P = DecimalDigitPairs[Pair];
     }
-  } else {
-    unsigned Radix32 = Radix;
-    while (Y) {
-      *P++ = llvm::hexdigit(Y % Radix32, !Uppercase);
-      Y /= Radix32;
+    if (Value >= 10) {
+      unsigned Pair = unsigned(Value) * 2;
+      *--P = DecimalDigitPairs[Pair + 1];
+      *--P = DecimalDigitPairs[Pair];
+    } else {
+      *--P = '0' + char(Value);
     }
+  } else if ((Radix32 & (Radix32 - 1)) == 0) {
+    // Power-of-two radixes, hexadecimal in particular, need no division.
+    unsigned Shift = llvm::countTrailingZeros(Radix32);
+    uint64_t Mask = Radix32 - 1;
+    do {
+      *--P = llvm::hexdigit(unsigned(Value & Mask), !Uppercase);
+      Value >>= Shift;
+    } while (Value);
+  } else {
+    do {
+      *--P = llvm::hexdigit(unsigned(Value % Radix32), !Uppercase);
+      Value /= Radix32;
+    } while (Value);
   }
 
   if (Negative)
-    *P++ = '-';
-  std::reverse(Buffer, P);
-  return size_t(P - Buffer);
+    *--P = '-';
+  return Length;
 }
 
 SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
@@ -174,6 +238,90 @@ static int swift_snprintf_l(char *Str, size_t StrSize, locale_t Locale,
 }
 #endif
 
+static bool swift_shortestDecimalDigits(float Value,
+                                        swift::DecimalDigits &Result) {
+  Result = swift::shortestDecimalDigits(Value);
+  return true;
+}
+
+static bool swift_shortestDecimalDigits(double Value,
+                                        swift::DecimalDigits &Result) {
+  Result = swift::shortestDecimalDigits(Value);
+  return true;
+}
+
+static bool swift_shortestDecimalDigits(long double Value,
+                                        swift::DecimalDigits &Result) {
+  return false;
+}
+
+/// Print \p Decimal the way printf's "%.<Precision>g" would print a value
+/// with the same digits, followed by ".0" if that doesn't produce a
+/// fractional part or an exponent. \p Decimal must not have trailing zeros.
+static uint64_t swift_decimalToString(char *Buffer, bool Negative,
+                                      swift::DecimalDigits Decimal,
+                                      int Precision) {
+  char Digits[20];
+  char *EndDigits = Digits + sizeof(Digits);
+  char *FirstDigit = EndDigits;
+  uint64_t Y = Decimal.Significand;
+  do {
+    *--FirstDigit = '0' + char(Y % 10);
+    Y /= 10;
+  } while (Y);
+  int NumDigits = EndDigits - FirstDigit;
+
+  // The exponent of the leading digit.
+  int LeadingExponent = 0;
+  if (Decimal.Significand != 0)
+    LeadingExponent = Decimal.Exponent + NumDigits - 1;
+
+  char *P = Buffer;
+  if (Negative)
+    *P++ = '-';
+
+  if (LeadingExponent < -4 || LeadingExponent >= Precision) {
+    *P++ = FirstDigit[0];
+    if (NumDigits > 1) {
+      *P++ = '.';
+      memcpy(P, FirstDigit + 1, NumDigits - 1);
+      P += NumDigits - 1;
+    }
+    *P++ = 'e';
+    *P++ = LeadingExponent < 0 ? '-' : '+';
+    int AbsExponent = LeadingExponent < 0 ? -LeadingExponent : LeadingExponent;
+    if (AbsExponent >= 100)
+      *P++ = '0' + char(AbsExponent / 100);
+    *P++ = '0' + char(AbsExponent / 10 % 10);
+    *P++ = '0' + char(AbsExponent % 10);
+    return P - Buffer;
+  }
+
+  int IntegerDigits = LeadingExponent + 1;
+  if (IntegerDigits <= 0) {
+    *P++ = '0';
+    *P++ = '.';
+    for (int i = IntegerDigits; i != 0; ++i)
+      *P++ = '0';
+    memcpy(P, FirstDigit, NumDigits);
+    P += NumDigits;
+  } else if (NumDigits > IntegerDigits) {
+    memcpy(P, FirstDigit, IntegerDigits);
+    P += IntegerDigits;
+    *P++ = '.';
+    memcpy(P, FirstDigit + IntegerDigits, NumDigits - IntegerDigits);
+    P += NumDigits - IntegerDigits;
+  } else {
+    memcpy(P, FirstDigit, NumDigits);
+    P += NumDigits;
+    for (int i = NumDigits; i != IntegerDigits; ++i)
+      *P++ = '0';
+    *P++ = '.';
+    *P++ = '0';
+  }
+  return P - Buffer;
+}
+
 template <typename T>
 static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
                                             T Value, const char *Format, 
@@ -185,7 +333,28 @@ static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
   if (Debug) {
     Precision = std::numeric_limits<T>::max_digits10;
   }
-  
+
+  // Print floats and doubles with the shortest digits that read back as the
+  // same value. The non-debug description rounds to digits10 digits, which
+  // gives the same result whenever the shortest digits are no longer than
+  // that and the value has full precision; otherwise fall back to printf.
+  swift::DecimalDigits Decimal;
+  if (std::isfinite(Value) && swift_shortestDecimalDigits(Value, Decimal)) {
+    int NumDigits = 1;
+    if (Decimal.Significand != 0) {
+      while (Decimal.Significand % 10 == 0) {
+        Decimal.Significand /= 10;
+        ++Decimal.Exponent;
+      }
+      for (uint64_t Y = Decimal.Significand; Y >= 10; Y /= 10)
+        ++NumDigits;
+    }
+    if (Debug ||
+        (NumDigits <= Precision && std::fpclassify(Value) != FP_SUBNORMAL))
+      return swift_decimalToString(Buffer, std::signbit(Value), Decimal,
+                                   Precision);
+  }
+
 #if defined(__CYGWIN__)
   // Cygwin does not support uselocale(), but we can use the locale feature 
   // in stringstream object.
@@ -379,12 +548,29 @@ __mulodi4(di_int a, di_int b, int* overflow)
 }
 #endif
 
+static const char *swift_parseDecimal(const char *nptr, double *outResult) {
+  return swift::parseDecimal(nptr, *outResult);
+}
+
+static const char *swift_parseDecimal(const char *nptr, float *outResult) {
+  return swift::parseDecimal(nptr, *outResult);
+}
+
+static const char *swift_parseDecimal(const char *nptr,
+                                      long double *outResult) {
+  return nullptr;
+}
+
 #if defined(__CYGWIN__)
 // Cygwin does not support uselocale(), but we can use the locale feature 
 // in stringstream object.
 template <typename T>
 static const char *_swift_stdlib_strtoX_clocale_impl(
     const char *nptr, T *outResult) {
+  // Most numbers can be parsed without the C library.
+  if (const char *EndPtr = swift_parseDecimal(nptr, outResult))
+    return EndPtr;
+
   std::istringstream ValueStream(nptr);
   ValueStream.imbue(std::locale::classic());
   T ParsedValue;
@@ -422,6 +608,10 @@ static const char *_swift_stdlib_strtoX_clocale_impl(
     const char * nptr, T* outResult, T huge,
     T (*posixImpl)(const char *, char **, locale_t)
 ) {
+  // Most numbers can be parsed without the C library or a locale.
+  if (const char *EndPtr = swift_parseDecimal(nptr, outResult))
+    return EndPtr;
+
   char *EndPtr;
   errno = 0;
   const auto result = posixImpl(nptr, &EndPtr, getCLocale());
@@ -25,6 +25,15 @@
 #include <unicode/ucol.h>
 #include <unicode/ucoleitr.h>
 #include <unicode/uiter.h>
+#include <unicode/uset.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "llvm/Support/MathExtras.h"
 
 #include "../SwiftShims/UnicodeShims.h"
 
@@ -67,30 +76,51 @@ static const UCollator *GetRootCollator() {
   return RootCollator;
 }
 
-/// This class caches the collation element results for the ASCII subset of
-/// unicode.
-class ASCIICollation {
-  int32_t CollationTable[128];
+/// This class caches the collation element results for the characters that
+/// always produce the same single collation element, whatever surrounds them:
+/// the ASCII subset of unicode, and the characters below U+0300 that have one
+/// collation element and aren't part of a contraction. Strings made only of
+/// such characters are already in NFC and contain no combining marks, so they
+/// can be collated and hashed one character at a time without ICU.
+class FastCollation {
 public:
+  /// Characters below this value may have a cached collation element.
+  static const uint16_t Limit = 0x300;
 
-  static const ASCIICollation *getTable() {
+private:
+  /// The collation element of each character, or UCOL_NULLORDER if the
+  /// character isn't handled by the table.
+  int32_t CollationTable[Limit];
+
+public:
+  static const FastCollation *getTable() {
     // We are reallying on C++11's guaranteed of thread safe static variable
     // initialization.
-    static ASCIICollation collation;
+    static FastCollation collation;
     return &collation;
   }
 
-  /// Maps an ASCII character to a collation element priority as would be
-  /// returned by a call to ucol_next().
-  int32_t map(unsigned char c) const {
+  /// Maps a character to a collation element priority as would be returned
+  /// by a call to ucol_next().
+  /// - Precondition: isCovered(c)
+  int32_t map(uint16_t c) const {
     return CollationTable[c];
   }
 
+  /// Returns true if the table has the collation element for \p c.
+  bool isCovered(uint16_t c) const {
+    return c < Limit && CollationTable[c] != UCOL_NULLORDER;
+  }
+
+  /// Returns true if the table has the collation element for every
+  /// character in the string.
+  bool isCovered(const uint16_t *Str, int32_t Length) const;
+
 private:
-  /// Construct the ASCII collation table.
-  ASCIICollation() {
+  /// Construct the collation table.
+  FastCollation() {
     const UCollator *Collator = GetRootCollator();
-    for (unsigned char c = 0; c < 128; ++c) {
+    for (uint16_t c = 0; c < Limit; ++c) {
       UErrorCode ErrorCode = U_ZERO_ERROR;
       intptr_t NumCollationElts = 0;
 #if defined(__CYGWIN__) || defined(_MSC_VER)
@@ -103,6 +133,8 @@ private:
       UCollationElements *CollationIterator =
           ucol_openElements(Collator, Buffer, 1, &ErrorCode);
 
+      // Completely ignorable characters produce no element at all.
+      CollationTable[c] = 0;
       while (U_SUCCESS(ErrorCode)) {
         intptr_t Elem = ucol_next(CollationIterator, &ErrorCode);
         if (Elem != UCOL_NULLORDER) {
@@ -114,16 +146,246 @@ private:
       }
 
       ucol_closeElements(CollationIterator);
-      if (U_FAILURE(ErrorCode) || NumCollationElts != 1) {
+      if (U_FAILURE(ErrorCode) || (c < 0x80 && NumCollationElts > 1)) {
         swift::crash("Error setting up the ASCII collation table");
       }
+      if (NumCollationElts > 1)
+        CollationTable[c] = UCOL_NULLORDER;
+    }
+
+    // A character that can be part of a contraction has to be looked at
+    // together with its neighbors. No contraction is made of ASCII
+    // characters alone, so leaving out the others is enough.
+    UErrorCode ErrorCode = U_ZERO_ERROR;
+    USet *Contractions = uset_openEmpty();
+    ucol_getContractionsAndExpansions(Collator, Contractions, nullptr,
+                                      /*addPrefixes=*/true, &ErrorCode);
+    if (U_FAILURE(ErrorCode)) {
+      swift::crash("Error setting up the ASCII collation table");
     }
+    for (int32_t i = 0, e = uset_getItemCount(Contractions); i != e; ++i) {
+      UChar32 Start, End;
+      UChar Str[32];
+      ErrorCode = U_ZERO_ERROR;
+      int32_t Length = uset_getItem(Contractions, i, &Start, &End,
+                                    Str, 32, &ErrorCode);
+      if (Length == 0) {
+        for (UChar32 c = Start; c <= End && c < Limit; ++c)
+          if (c >= 0x80)
+            CollationTable[c] = UCOL_NULLORDER;
+        continue;
+      }
+      // An element too long for the buffer is reported as an error; leave
+      // out every character below the limit, to be safe.
+      if (U_FAILURE(ErrorCode)) {
+        for (uint16_t c = 0x80; c < Limit; ++c)
+          CollationTable[c] = UCOL_NULLORDER;
+        break;
+      }
+      for (int32_t j = 0; j < Length; ++j)
+        if (Str[j] >= 0x80 && Str[j] < Limit)
+          CollationTable[Str[j]] = UCOL_NULLORDER;
+    }
+    uset_close(Contractions);
   }
 
-  ASCIICollation &operator=(const ASCIICollation &) = delete;
-  ASCIICollation(const ASCIICollation &) = delete;
+  FastCollation &operator=(const FastCollation &) = delete;
+  FastCollation(const FastCollation &) = delete;
 };
 
+//===----------------------------------------------------------------------===//
+// Vectorized scanning
+//===----------------------------------------------------------------------===//
+
+/// Returns true if every byte of the string is ASCII.
+static bool isASCII(const char *Str, int32_t Length) {
+  int32_t i = 0;
+#if defined(__SSE2__)
+  __m128i Bits = _mm_setzero_si128();
+  for (; i + 16 <= Length; i += 16)
+    Bits = _mm_or_si128(Bits, _mm_loadu_si128(
+                                  reinterpret_cast<const __m128i *>(Str + i)));
+  if (_mm_movemask_epi8(Bits) != 0)
+    return false;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  uint8x16_t Bits = vdupq_n_u8(0);
+  for (; i + 16 <= Length; i += 16)
+    Bits = vorrq_u8(Bits, vld1q_u8(reinterpret_cast<const uint8_t *>(Str + i)));
+  if (vmaxvq_u8(Bits) >= 0x80)
+    return false;
+#endif
+  unsigned char Bits8 = 0;
+  for (; i < Length; ++i)
+    Bits8 |= static_cast<unsigned char>(Str[i]);
+  return Bits8 < 0x80;
+}
+
+/// Returns true if every code unit of the string is less than \p Limit.
+static bool isBelow(const uint16_t *Str, int32_t Length, uint16_t Limit) {
+  int32_t i = 0;
+#if defined(__SSE2__)
+  // SSE2 has no unsigned 16-bit comparison, but a saturating subtraction of
+  // Limit - 1 is non-zero exactly for the units that are too large.
+  const __m128i Max = _mm_set1_epi16(static_cast<short>(Limit - 1));
+  __m128i Excess = _mm_setzero_si128();
+  for (; i + 8 <= Length; i += 8)
+    Excess = _mm_or_si128(
+        Excess, _mm_subs_epu16(_mm_loadu_si128(
+                                   reinterpret_cast<const __m128i *>(Str + i)),
+                               Max));
+  if (_mm_movemask_epi8(_mm_cmpeq_epi16(Excess, _mm_setzero_si128())) !=
+      0xFFFF)
+    return false;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  uint16x8_t Largest = vdupq_n_u16(0);
+  for (; i + 8 <= Length; i += 8)
+    Largest = vmaxq_u16(Largest, vld1q_u16(Str + i));
+  if (vmaxvq_u16(Largest) >= Limit)
+    return false;
+#endif
+  for (; i < Length; ++i)
+    if (Str[i] >= Limit)
+      return false;
+  return true;
+}
+
+/// Returns the length of the longest common prefix of two strings of at
+/// least \p Length code units.
+static int32_t commonPrefixLength(const char *Left, const char *Right,
+                                  int32_t Length) {
+  int32_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 16 <= Length; i += 16) {
+    int Equal = _mm_movemask_epi8(_mm_cmpeq_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Left + i)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Right + i))));
+    if (Equal != 0xFFFF)
+      return i + llvm::countTrailingZeros(unsigned(~Equal));
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for (; i + 16 <= Length; i += 16) {
+    uint8x16_t Equal =
+        vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t *>(Left + i)),
+                 vld1q_u8(reinterpret_cast<const uint8_t *>(Right + i)));
+    if (vminvq_u8(Equal) != 0xFF)
+      break;
+  }
+#endif
+  while (i < Length && Left[i] == Right[i])
+    ++i;
+  return i;
+}
+
+static int32_t commonPrefixLength(const uint16_t *Left, const uint16_t *Right,
+                                  int32_t Length) {
+  int32_t i = 0;
+#if defined(__SSE2__)
+  for (; i + 8 <= Length; i += 8) {
+    int Equal = _mm_movemask_epi8(_mm_cmpeq_epi16(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Left + i)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Right + i))));
+    if (Equal != 0xFFFF)
+      return i + llvm::countTrailingZeros(unsigned(~Equal)) / 2;
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  for (; i + 8 <= Length; i += 8) {
+    uint16x8_t Equal = vceqq_u16(vld1q_u16(Left + i), vld1q_u16(Right + i));
+    if (vminvq_u16(Equal) != 0xFFFF)
+      break;
+  }
+#endif
+  while (i < Length && Left[i] == Right[i])
+    ++i;
+  return i;
+}
+
+bool FastCollation::isCovered(const uint16_t *Str, int32_t Length) const {
+  if (isBelow(Str, Length, 0x80))
+    return true;
+  if (!isBelow(Str, Length, Limit))
+    return false;
+  for (int32_t i = 0; i < Length; ++i)
+    if (CollationTable[Str[i]] == UCOL_NULLORDER)
+      return false;
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Collation without ICU
+//===----------------------------------------------------------------------===//
+
+static inline uint16_t codeUnit(char c) {
+  return static_cast<unsigned char>(c);
+}
+
+static inline uint16_t codeUnit(uint16_t c) {
+  return c;
+}
+
+/// The weight of a collation element at the given strength: the primary
+/// weight at level 0, the secondary at level 1 and the tertiary, without
+/// the case bits, at level 2.
+static inline uint32_t weightAtLevel(int32_t Elem, unsigned Level) {
+  uint32_t Bits = Elem;
+  switch (Level) {
+  case 0:
+    return Bits >> 16;
+  case 1:
+    return (Bits >> 8) & 0xFF;
+  default:
+    return Bits & 0x3F;
+  }
+}
+
+/// Compares two strings covered by the fast collation table the way the
+/// root collator does at tertiary strength: by all of their primary weights,
+/// then by all of their secondary weights, then by their tertiary weights.
+/// Zero weights don't take part at their level.
+template <typename LeftChar, typename RightChar>
+static int32_t compareWeights(const FastCollation *Table,
+                              const LeftChar *Left, int32_t LeftLength,
+                              const RightChar *Right, int32_t RightLength) {
+  for (unsigned Level = 0; Level != 3; ++Level) {
+    int32_t i = 0, j = 0;
+    for (;;) {
+      uint32_t LeftWeight = 0, RightWeight = 0;
+      while (i < LeftLength &&
+             !(LeftWeight = weightAtLevel(Table->map(codeUnit(Left[i])),
+                                          Level)))
+        ++i;
+      while (j < RightLength &&
+             !(RightWeight = weightAtLevel(Table->map(codeUnit(Right[j])),
+                                           Level)))
+        ++j;
+      if (i == LeftLength || j == RightLength) {
+        if (i == LeftLength && j == RightLength)
+          break;
+        return i == LeftLength ? -1 : 1;
+      }
+      if (LeftWeight != RightWeight)
+        return LeftWeight < RightWeight ? -1 : 1;
+      ++i;
+      ++j;
+    }
+  }
+  return 0;
+}
+
+/// Compares two strings of the same encoding that are covered by the fast
+/// collation table. Each character's collation element doesn't depend on its
+/// neighbors, so a common prefix adds the same weights to both strings at
+/// every level and can be skipped.
+template <typename CharType>
+static int32_t compareWithTable(const FastCollation *Table,
+                                const CharType *Left, int32_t LeftLength,
+                                const CharType *Right, int32_t RightLength) {
+  int32_t Prefix = commonPrefixLength(Left, Right,
+                                      std::min(LeftLength, RightLength));
+  return compareWeights(
+      Table, Left + Prefix, LeftLength - Prefix,
+      Right + Prefix, RightLength - Prefix);
+}
+
 /// Compares the strings via the Unicode Collation Algorithm on the root locale.
 /// Results are the usual string comparison results:
 ///  <0 the left string is less than the right string.
@@ -134,6 +396,12 @@ swift::_swift_stdlib_unicode_compare_utf16_utf16(const uint16_t *LeftString,
                                                  int32_t LeftLength,
                                                  const uint16_t *RightString,
                                                  int32_t RightLength) {
+  const FastCollation *Table = FastCollation::getTable();
+  if (Table->isCovered(LeftString, LeftLength) &&
+      Table->isCovered(RightString, RightLength))
+    return compareWithTable(Table, LeftString, LeftLength,
+                            RightString, RightLength);
+
 #if defined(__CYGWIN__) || defined(_MSC_VER)
   // ICU UChar type is platform dependent. In Cygwin, it is defined
   // as wchar_t which size is 2. It seems that the underlying binary
@@ -158,6 +426,12 @@ swift::_swift_stdlib_unicode_compare_utf8_utf16(const char *LeftString,
                                                 int32_t LeftLength,
                                                 const uint16_t *RightString,
                                                 int32_t RightLength) {
+  const FastCollation *Table = FastCollation::getTable();
+  if (isASCII(LeftString, LeftLength) &&
+      Table->isCovered(RightString, RightLength))
+    return compareWeights(Table, LeftString, LeftLength,
+                          RightString, RightLength);
+
   UCharIterator LeftIterator;
   UCharIterator RightIterator;
   UErrorCode ErrorCode = U_ZERO_ERROR;
@@ -188,6 +462,10 @@ swift::_swift_stdlib_unicode_compare_utf8_utf8(const char *LeftString,
                                                int32_t LeftLength,
                                                const char *RightString,
                                                int32_t RightLength) {
+  if (isASCII(LeftString, LeftLength) && isASCII(RightString, RightLength))
+    return compareWithTable(FastCollation::getTable(), LeftString, LeftLength,
+                            RightString, RightLength);
+
   UCharIterator LeftIterator;
   UCharIterator RightIterator;
   UErrorCode ErrorCode = U_ZERO_ERROR;
@@ -217,6 +495,16 @@ swift::_swift_stdlib_unicode_compare_utf8_utf8(const char *LeftString,
 #define HASH_R 47
 #endif
 
+static inline intptr_t hashElement(intptr_t HashState, intptr_t Elem) {
+  Elem *= HASH_M;
+  Elem ^= Elem >> HASH_R;
+  Elem *= HASH_M;
+
+  HashState *= HASH_M;
+  HashState ^= Elem;
+  return HashState;
+}
+
 static intptr_t hashChunk(const UCollator *Collator, intptr_t HashState,
                           const uint16_t *Str, uint32_t Length,
                           UErrorCode *ErrorCode) {
@@ -234,12 +522,7 @@ static intptr_t hashChunk(const UCollator *Collator, intptr_t HashState,
     if (Elem == 0)
       continue;
     if (Elem != UCOL_NULLORDER) {
-      Elem *= HASH_M;
-      Elem ^= Elem >> HASH_R;
-      Elem *= HASH_M;
-
-      HashState *= HASH_M;
-      HashState ^= Elem;
+      HashState = hashElement(HashState, Elem);
     } else {
       break;
     }
@@ -248,6 +531,22 @@ static intptr_t hashChunk(const UCollator *Collator, intptr_t HashState,
   return HashState;
 }
 
+/// Hashes the collation elements of a string covered by the fast collation
+/// table, giving the same result as hashChunk.
+template <typename CharType>
+static intptr_t hashWithTable(const FastCollation *Table, intptr_t HashState,
+                              const CharType *Str, int32_t Length) {
+  for (int32_t Pos = 0; Pos < Length; ++Pos) {
+    intptr_t Elem = Table->map(codeUnit(Str[Pos]));
+    // Ignore zero valued collation elements. They don't participate in the
+    // ordering relation.
+    if (Elem == 0)
+      continue;
+    HashState = hashElement(HashState, Elem);
+  }
+  return HashState;
+}
+
 static intptr_t hashFinish(intptr_t HashState) {
   HashState ^= HashState >> HASH_R;
   HashState *= HASH_M;
@@ -257,6 +556,10 @@ static intptr_t hashFinish(intptr_t HashState) {
 
 intptr_t
 swift::_swift_stdlib_unicode_hash(const uint16_t *Str, int32_t Length) {
+  const FastCollation *Table = FastCollation::getTable();
+  if (Table->isCovered(Str, Length))
+    return hashFinish(hashWithTable(Table, HASH_SEED, Str, Length));
+
   UErrorCode ErrorCode = U_ZERO_ERROR;
   intptr_t HashState = HASH_SEED;
   HashState = hashChunk(GetRootCollator(), HashState, Str, Length, &ErrorCode);
@@ -269,25 +572,9 @@ swift::_swift_stdlib_unicode_hash(const uint16_t *Str, int32_t Length) {
 
 intptr_t swift::_swift_stdlib_unicode_hash_ascii(const char *Str,
                                                  int32_t Length) {
-  const ASCIICollation *Table = ASCIICollation::getTable();
-  intptr_t HashState = HASH_SEED;
-  int32_t Pos = 0;
-  while (Pos < Length) {
-    const char c = Str[Pos++];
-    assert((c & 0x80) == 0 && "This table only exists for the ASCII subset");
-    intptr_t Elem = Table->map(c);
-    // Ignore zero valued collation elements. They don't participate in the
-    // ordering relation.
-    if (Elem == 0)
-      continue;
-    Elem *= HASH_M;
-    Elem ^= Elem >> HASH_R;
-    Elem *= HASH_M;
-
-    HashState *= HASH_M;
-    HashState ^= Elem;
-  }
-  return hashFinish(HashState);
+  assert(isASCII(Str, Length) && "This table only exists for the ASCII subset");
+  return hashFinish(
+      hashWithTable(FastCollation::getTable(), HASH_SEED, Str, Length));
 }
 
 /// Convert the unicode string to uppercase. This function will return the
@@ -0,0 +1,181 @@
+//===--- UnicodeTranscoding.cpp - Bulk UTF-8 validation and transcoding ---===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Kernels that validate UTF-8 and transcode it to UTF-16 a buffer at a time.
+// Runs of ASCII, which are most of the text that passes through String, are
+// handled 16 bytes at a time with SSE2 or NEON, or a word at a time
+// elsewhere; the rest is decoded one scalar at a time.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../SwiftShims/UnicodeShims.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define SWIFT_TRANSCODING_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SWIFT_TRANSCODING_NEON 1
+#endif
+
+using namespace swift;
+
+/// Returns the length of the run of ASCII at the start of the buffer.
+static inline __swift_intptr_t countASCII(const __swift_uint8_t *Str,
+                                          __swift_intptr_t Length) {
+  __swift_intptr_t i = 0;
+#if SWIFT_TRANSCODING_SSE2
+  for (; i + 16 <= Length; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Str + i));
+    if (int nonASCII = _mm_movemask_epi8(bytes))
+      return i + __builtin_ctz(nonASCII);
+  }
+#elif SWIFT_TRANSCODING_NEON
+  for (; i + 16 <= Length; i += 16) {
+    if (vmaxvq_u8(vld1q_u8(Str + i)) >= 0x80)
+      break;
+  }
+#endif
+  for (; i + 8 <= Length; i += 8) {
+    __swift_uint64_t word;
+    memcpy(&word, Str + i, sizeof(word));
+    if (word & 0x8080808080808080ULL)
+      break;
+  }
+  for (; i < Length; ++i)
+    if (Str[i] & 0x80)
+      break;
+  return i;
+}
+
+/// Copies ASCII bytes into UTF-16 code units.
+static inline void widenASCII(const __swift_uint8_t *Src,
+                              __swift_uint16_t *Dest,
+                              __swift_intptr_t Length) {
+  __swift_intptr_t i = 0;
+#if SWIFT_TRANSCODING_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= Length; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(Dest + i),
+                     _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(Dest + i + 8),
+                     _mm_unpackhi_epi8(bytes, zero));
+  }
+#elif SWIFT_TRANSCODING_NEON
+  for (; i + 16 <= Length; i += 16) {
+    uint8x16_t bytes = vld1q_u8(Src + i);
+    vst1q_u16(Dest + i, vmovl_u8(vget_low_u8(bytes)));
+    vst1q_u16(Dest + i + 8, vmovl_high_u8(bytes));
+  }
+#endif
+  for (; i < Length; ++i)
+    Dest[i] = Src[i];
+}
+
+static inline bool isContinuation(__swift_uint8_t byte) {
+  return (byte & 0xC0) == 0x80;
+}
+
+/// Returns the length of the well-formed multi-byte sequence at the start of
+/// the buffer, or 0 if it is ill-formed. The checks are those of table 3-7
+/// of the Unicode Standard, which exclude overlong forms, surrogates and
+/// values past U+10FFFF.
+static inline unsigned
+getMultiByteSequenceLength(const __swift_uint8_t *Str,
+                           __swift_intptr_t Length) {
+  __swift_uint8_t lead = Str[0];
+  if (lead >= 0xC2 && lead <= 0xDF)
+    return Length >= 2 && isContinuation(Str[1]) ? 2 : 0;
+
+  if (lead >= 0xE0 && lead <= 0xEF) {
+    if (Length < 3)
+      return 0;
+    __swift_uint8_t second = Str[1];
+    if (lead == 0xE0 ? (second < 0xA0 || second > 0xBF)
+        : lead == 0xED ? (second < 0x80 || second > 0x9F)
+        : !isContinuation(second))
+      return 0;
+    return isContinuation(Str[2]) ? 3 : 0;
+  }
+
+  if (lead >= 0xF0 && lead <= 0xF4) {
+    if (Length < 4)
+      return 0;
+    __swift_uint8_t second = Str[1];
+    if (lead == 0xF0 ? (second < 0x90 || second > 0xBF)
+        : lead == 0xF4 ? (second < 0x80 || second > 0x8F)
+        : !isContinuation(second))
+      return 0;
+    return isContinuation(Str[2]) && isContinuation(Str[3]) ? 4 : 0;
+  }
+
+  return 0;
+}
+
+bool swift::_swift_stdlib_unicode_measureUTF8(const __swift_uint8_t *Str,
+                                              __swift_intptr_t Length,
+                                              __swift_intptr_t *UTF16Length) {
+  __swift_intptr_t i = 0;
+  __swift_intptr_t utf16Length = 0;
+  while (i < Length) {
+    if (Str[i] < 0x80) {
+      __swift_intptr_t run = countASCII(Str + i, Length - i);
+      i += run;
+      utf16Length += run;
+      continue;
+    }
+    unsigned sequenceLength = getMultiByteSequenceLength(Str + i, Length - i);
+    if (sequenceLength == 0)
+      return false;
+    i += sequenceLength;
+    // Only scalars outside the BMP need a surrogate pair.
+    utf16Length += sequenceLength == 4 ? 2 : 1;
+  }
+  *UTF16Length = utf16Length;
+  return true;
+}
+
+void swift::_swift_stdlib_unicode_transcodeUTF8ToUTF16(
+    const __swift_uint8_t *Src, __swift_intptr_t Length,
+    __swift_uint16_t *Dest) {
+  __swift_intptr_t i = 0;
+  while (i < Length) {
+    __swift_uint8_t lead = Src[i];
+    if (lead < 0x80) {
+      __swift_intptr_t run = countASCII(Src + i, Length - i);
+      widenASCII(Src + i, Dest, run);
+      i += run;
+      Dest += run;
+      continue;
+    }
+
+    if (lead < 0xE0) {
+      *Dest++ = ((lead & 0x1F) << 6) | (Src[i + 1] & 0x3F);
+      i += 2;
+    } else if (lead < 0xF0) {
+      *Dest++ = ((lead & 0x0F) << 12) | ((Src[i + 1] & 0x3F) << 6) |
+                (Src[i + 2] & 0x3F);
+      i += 3;
+    } else {
+      __swift_uint32_t scalar = ((lead & 0x07) << 18) |
+                                ((Src[i + 1] & 0x3F) << 12) |
+                                ((Src[i + 2] & 0x3F) << 6) |
+                                (Src[i + 3] & 0x3F);
+      scalar -= 0x10000;
+      *Dest++ = 0xD800 | (scalar >> 10);
+      *Dest++ = 0xDC00 | (scalar & 0x3FF);
+      i += 4;
+    }
+  }
+}
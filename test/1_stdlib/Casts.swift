@@ -46,4 +46,33 @@ CastsTests.test("No overrelease of existential boxes in failed casts") {
     bar(err)
 }
 
+protocol Q1 { func q1() -> Int }
+protocol Q2 { func q2() -> Int }
+struct ConformsToQ1Q2 : Q1, Q2 {
+    func q1() -> Int { return 1 }
+    func q2() -> Int { return 2 }
+}
+class ClassConformsToQ1Q2 : Q1, Q2 {
+    func q1() -> Int { return 10 }
+    func q2() -> Int { return 20 }
+}
+
+CastsTests.test("Repeated casts to existentials use the right witness tables") {
+    // The runtime remembers successful casts between a type and an
+    // existential; make sure later casts still get the right conformances.
+    let values: [Any] = [ConformsToQ1Q2(), ClassConformsToQ1Q2(), 42]
+    for _ in 0..<3 {
+        var sum = 0
+        for value in values {
+            if let q = value as? protocol<Q1, Q2> {
+                sum += q.q1() + q.q2()
+            }
+            if let q = value as? Q2 {
+                sum += q.q2()
+            }
+        }
+        expectEqual(3 + 30 + 2 + 20, sum)
+    }
+}
+
 runAllTests()
@@ -143,5 +143,55 @@ ErrorProtocolTests.test("existential in lvalue") {
   expectEqual(0, LifetimeTracked.instances)
 }
 
+enum SmallError : ErrorProtocol {
+  case Code(Int)
+}
+
+struct LargeError : ErrorProtocol {
+  var a = 0, b = 1, c = 2, d = 3, e = 4, f = 5
+}
+
+ErrorProtocolTests.test("reused error boxes") {
+  expectEqual(0, LifetimeTracked.instances)
+  do {
+    // Keep more errors alive at once than a thread caches, and free them
+    // in between throws of other sizes, so that boxes are reused while other
+    // boxes are still in use.
+    var errors: [ErrorProtocol] = []
+    for i in 0..<20 {
+      do {
+        if i % 3 == 0 {
+          throw LifetimeError.MistakeOfALifetime(LifetimeTracked(i),
+                                                 yearsIncarcerated: i)
+        } else if i % 3 == 1 {
+          throw LargeError()
+        }
+        throw SmallError.Code(i)
+      } catch {
+        errors.append(error)
+      }
+      if i % 7 == 6 {
+        errors.removeAll()
+      }
+    }
+    expectEqual(6, errors.count)
+    for (i, error) in zip(14..<20, errors) {
+      switch error {
+      case LifetimeError.MistakeOfALifetime(let tracked, let years):
+        expectEqual(i, tracked.value)
+        expectEqual(i, years)
+      case let large as LargeError:
+        expectEqual(1, i % 3)
+        expectEqual(5, large.f)
+      case SmallError.Code(let code):
+        expectEqual(i, code)
+      default:
+        expectUnreachable()
+      }
+    }
+  }
+  expectEqual(0, LifetimeTracked.instances)
+}
+
 runAllTests()
 
@@ -777,6 +777,46 @@ mirrors.test("ObjC") {
 }
 #endif
 
+struct ManyFields<T> {
+  var first: T
+  var second = 2
+  var third = "three"
+  var fourth: T
+}
+
+enum ManyCases {
+  case empty
+  case one(Int)
+  case two(String)
+  case other
+}
+
+mirrors.test("FieldNames") {
+  // Children can be visited in any order, and repeatedly.
+  let m = Mirror(reflecting: ManyFields(first: 1, fourth: 4))
+  let labels = ["first", "second", "third", "fourth"]
+  for i in [3, 0, 2, 1, 3] {
+    let child = m.children[
+      m.children.index(m.children.startIndex, offsetBy: numericCast(i))]
+    expectEqual(labels[i], child.label)
+  }
+  expectEqual(labels, m.children.map { $0.label! })
+
+  // Different instantiations of a generic type share their field names.
+  let n = Mirror(reflecting: ManyFields(first: "1", fourth: "4"))
+  expectEqual(labels, n.children.map { $0.label! })
+  expectEqual("4", n.children.map { $0.value as! String }.last)
+
+  expectEqual("empty", String(ManyCases.empty))
+  expectEqual("other", String(ManyCases.other))
+  expectEqual(["two"], Mirror(reflecting: ManyCases.two("2")).children.map {
+    $0.label!
+  })
+  expectEqual(["one"], Mirror(reflecting: ManyCases.one(1)).children.map {
+    $0.label!
+  })
+}
+
 mirrors.test("String.init") {
   expectEqual("42", String(42))
   expectEqual("42", String("42"))
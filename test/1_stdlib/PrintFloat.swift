@@ -205,10 +205,15 @@ PrintTests.test("Printable") {
   expectPrinted("1.25e-17", asFloat80(0.0000000000000000125))
 #endif
 
-  expectDebugPrinted("1.10000002", asFloat32(1.1))
-  expectDebugPrinted("1.24999998e+17", asFloat32(125000000000000000.0))
+  expectDebugPrinted("1.1", asFloat32(1.1))
+  expectDebugPrinted("1.25e+17", asFloat32(125000000000000000.0))
   expectDebugPrinted("1.25", asFloat32(1.25))
-  expectDebugPrinted("1.24999997e-05", asFloat32(0.0000125))
+  expectDebugPrinted("1.25e-05", asFloat32(0.0000125))
+  expectDebugPrinted("100000000.0", asFloat32(100000000.0))
+  expectDebugPrinted("1e+09", asFloat32(1000000000.0))
+  expectDebugPrinted("3.4028235e+38", Float.greatestFiniteMagnitude)
+  expectDebugPrinted("1e-45", Float.leastNonzeroMagnitude)
+  expectDebugPrinted("-0.0", -asFloat32(0.0))
   expectDebugPrinted("inf", Float.infinity)
   expectDebugPrinted("-inf", -Float.infinity)
   expectDebugPrinted("nan", Float.nan)
@@ -228,10 +233,18 @@ PrintTests.test("Printable") {
   expectDebugPrinted("snan(0x1fffff)", Float(bitPattern: 0x7fbf_ffff))
 #endif
 
-  expectDebugPrinted("1.1000000000000001", asFloat64(1.1))
+  expectDebugPrinted("1.1", asFloat64(1.1))
   expectDebugPrinted("1.25e+17", asFloat64(125000000000000000.0))
   expectDebugPrinted("1.25", asFloat64(1.25))
-  expectDebugPrinted("1.2500000000000001e-05", asFloat64(0.0000125))
+  expectDebugPrinted("1.25e-05", asFloat64(0.0000125))
+  expectDebugPrinted("0.30000000000000004", asFloat64(0.1) + asFloat64(0.2))
+  expectDebugPrinted("10000000000000000.0", asFloat64(10000000000000000.0))
+  expectDebugPrinted("1e+17", asFloat64(100000000000000000.0))
+  expectDebugPrinted("0.0001", asFloat64(0.0001))
+  expectDebugPrinted("1e-05", asFloat64(0.00001))
+  expectDebugPrinted("1.7976931348623157e+308", Double.greatestFiniteMagnitude)
+  expectDebugPrinted("5e-324", Double.leastNonzeroMagnitude)
+  expectDebugPrinted("-0.0", -asFloat64(0.0))
   expectDebugPrinted("inf", Double.infinity)
   expectDebugPrinted("-inf", -Double.infinity)
   expectDebugPrinted("nan", Double.nan)
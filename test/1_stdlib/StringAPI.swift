@@ -76,6 +76,12 @@ let comparisonTests = [
   ComparisonTest(.lt, "a", "a\u{301}"),
   ComparisonTest(.lt, "a", "\u{e1}"),
 
+  // U+00E9 LATIN SMALL LETTER E WITH ACUTE
+  ComparisonTest(.lt, "cafe", "caf\u{e9}"),
+  ComparisonTest(.lt, "caf\u{e9}", "cafes"),
+  ComparisonTest(.eq, "caf\u{e9}", "cafe\u{301}"),
+  ComparisonTest(.lt, "r\u{e9}sum\u{e9}", "r\u{e9}sum\u{e9}s"),
+
   // U+304B HIRAGANA LETTER KA
   // U+304C HIRAGANA LETTER GA
   // U+3099 COMBINING KATAKANA-HIRAGANA VOICED SOUND MARK
@@ -0,0 +1,14 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -parse -I %S/Inputs/custom-modules -module-cache-path %t %s -print-stats 2>&1 | FileCheck %s
+
+// REQUIRES: asserts
+
+// CHECK-DAG: {{[0-9]+}} Swift lookup table{{ *}}- # of base names available in serialized lookup tables
+// CHECK-DAG: {{[0-9]+}} Swift lookup table{{ *}}- # of base names loaded from serialized lookup tables
+// CHECK-DAG: {{[0-9]+}} Swift lookup table{{ *}}- # of declarations and macros resolved from serialized lookup tables
+// CHECK-DAG: {{[0-9]+}} Swift lookup table{{ *}}- # of enum classifications loaded from serialized lookup tables
+
+import TypeAndValue
+
+_ = testEnum
@@ -0,0 +1,18 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -emit-pch -import-objc-header %S/Inputs/sdk-bridging-header.h -o %t/sdk-bridging-header.pch
+// RUN: %target-swift-frontend -parse -verify %s -import-objc-header %t/sdk-bridging-header.pch
+
+// RUN: not %target-swift-frontend -emit-pch -o %t/no-header.pch 2>&1 | FileCheck -check-prefix=CHECK-NO-HEADER %s
+// CHECK-NO-HEADER: error: this mode requires an Objective-C header (-import-objc-header)
+
+// REQUIRES: objc_interop
+
+import Foundation
+
+let `true` = Predicate.`true`()
+let not = Predicate.not()
+let and = Predicate.and([])
+let or = Predicate.or([not, and])
+
+_ = Predicate.foobar() // expected-error{{type 'Predicate' has no member 'foobar'}}
@@ -0,0 +1,32 @@
+// RUN: %target-parse-verify-swift
+
+// Overloads whose parameters can't accept arguments of an already-known
+// concrete type are skipped by the solver; make sure the right overload is
+// still chosen.
+
+struct Meters {}
+struct Feet {}
+enum Direction { case up, down }
+
+func measure(_ m: Meters, _ d: Direction) -> Meters { return m }
+func measure(_ f: Feet, _ d: Direction) -> Feet { return f }
+func measure<T>(_ t: T, _ d: Int) -> T { return t }
+func measure(_ s: String, _ d: Direction) -> String { return s }
+
+let m = Meters()
+let f = Feet()
+let dir = Direction.up
+
+let _: Meters = measure(m, dir)
+let _: Feet = measure(f, dir)
+let _: Feet = measure(f, 1)
+let _: String = measure("x", dir)
+
+infix operator +++ { associativity left }
+func +++(lhs: Meters, rhs: Meters) -> Meters { return lhs }
+func +++(lhs: Feet, rhs: Feet) -> Feet { return lhs }
+func +++(lhs: Int, rhs: Int) -> Int { return lhs }
+
+let _: Meters = m +++ m +++ m
+let _: Feet = f +++ f +++ f
+let _: Int = 1 +++ 2 +++ 3
@@ -0,0 +1,12 @@
+; This is not really a Swift source file: -*- Text -*-
+
+%t.input: "A ---> B" ==> "A"
+RUN: sed -ne '/--->/s/ *--->.*$//p' < %S/Inputs/manglings.txt > %t.input
+RUN: cat %t.input %t.input > %t.twice
+
+RUN: swift-demangle < %t.twice > %t.serial
+RUN: swift-demangle -j=4 -chunk-size=256 -input-file=%t.twice > %t.parallel
+RUN: diff %t.serial %t.parallel
+
+RUN: swift-demangle -j=4 -chunk-size=256 -input-file=%t.twice -stats 2>&1 > /dev/null | FileCheck %s
+CHECK: Demangled {{[0-9]+}} symbols ({{[1-9][0-9]*}} cached) in {{[0-9.]+}} MB of text on 4 threads in {{[0-9.]+}}s: {{[0-9.]+}} MB/s
@@ -0,0 +1,7 @@
+; This is not really a Swift source file: -*- Text -*-
+
+%t.input: "A ---> B" ==> "A"
+RUN: sed -ne '/--->/s/ *--->.*$//p' < %S/Inputs/manglings.txt > %t.input
+
+RUN: swift-demangle -benchmark-iterations=10 < %t.input | FileCheck %s
+CHECK: Demangled {{[0-9]+}} names ({{[0-9]+}} characters) in {{[0-9.]+}}s: {{[0-9]+}} names/s
@@ -0,0 +1,4 @@
+# Dependencies after compilation:
+provides-top-level: [a, b]
+provides-fingerprints: [[same, provides-top-level, a], [after, provides-top-level, b]]
+interface-hash: "after"
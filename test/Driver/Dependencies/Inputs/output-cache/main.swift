@@ -0,0 +1,3 @@
+# Dependencies after compilation:
+provides-top-level: [a]
+depends-external: ["./external.swiftmodule"]
@@ -0,0 +1,2 @@
+# Dependencies after compilation:
+provides-top-level: [b]
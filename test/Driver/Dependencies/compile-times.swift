@@ -0,0 +1,23 @@
+/// main, other; other took longer to compile last time
+
+// RUN: rm -rf %t && cp -r %S/Inputs/independent/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-IN-ORDER %s
+// RUN: FileCheck -check-prefix=CHECK-RECORD %s < %t/main~buildrecord.swiftdeps
+
+// CHECK-IN-ORDER: Handled main.swift
+// CHECK-IN-ORDER: Handled other.swift
+
+// CHECK-RECORD: compile_times:
+// CHECK-RECORD-DAG: "./main.swift": {{[0-9]+$}}
+// CHECK-RECORD-DAG: "./other.swift": {{[0-9]+$}}
+
+// The compile times are used even when the rest of the record is stale.
+// RUN: echo '{version: "bogus", compile_times: {"./main.swift": 1000000, "./other.swift": 10000000}}' > %t/main~buildrecord.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -v -driver-time-compilation 2>&1 | FileCheck -check-prefix=CHECK-SLOWEST-FIRST %s
+
+// CHECK-SLOWEST-FIRST: Handled other.swift
+// CHECK-SLOWEST-FIRST: Handled main.swift
+// CHECK-SLOWEST-FIRST: Ran jobs for {{[0-9.]+}} seconds of wall time with 1 parallel commands
+// CHECK-SLOWEST-FIRST-NEXT: {{[0-9.]+}} core-seconds busy, {{[0-9.]+}} core-seconds idle
@@ -0,0 +1,41 @@
+/// other ==> main
+
+// RUN: rm -rf %t && cp -r %S/Inputs/one-way/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -enable-incremental-file-hashing ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-FIRST %s
+// RUN: FileCheck -check-prefix=CHECK-RECORD %s < %t/main~buildrecord.swiftdeps
+
+// CHECK-FIRST-NOT: warning
+// CHECK-FIRST: Handled main.swift
+// CHECK-FIRST: Handled other.swift
+
+// CHECK-RECORD: content_hashes:
+// CHECK-RECORD-DAG: "./main.swift": "{{[0-9a-f]+}}"
+// CHECK-RECORD-DAG: "./other.swift": "{{[0-9a-f]+}}"
+
+// Touching a file without changing it doesn't rebuild it.
+// RUN: touch -t 201401240006 %t/other.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -enable-incremental-file-hashing ./main.swift ./other.swift -module-name main -j1 -v -driver-show-incremental 2>&1 | FileCheck -check-prefix=CHECK-TOUCHED %s
+
+// CHECK-TOUCHED: Contents of other.swift unchanged despite new modification time
+// CHECK-TOUCHED-NOT: Handled
+
+// The new modification time was recorded, so the contents aren't read again.
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -enable-incremental-file-hashing ./main.swift ./other.swift -module-name main -j1 -v -driver-show-incremental 2>&1 | FileCheck -check-prefix=CHECK-SAME %s
+
+// CHECK-SAME-NOT: Contents of
+// CHECK-SAME-NOT: Handled
+
+// RUN: echo '# changed' >> %t/other.swift
+// RUN: touch -t 201401240007 %t/other.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -enable-incremental-file-hashing ./main.swift ./other.swift -module-name main -j1 -v -driver-show-incremental 2>&1 | FileCheck -check-prefix=CHECK-CHANGED %s
+
+// CHECK-CHANGED-NOT: Contents of
+// CHECK-CHANGED: Handled other.swift
+
+// Without the option, a touched file is rebuilt as before.
+// RUN: touch -t 201401240008 %t/other.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-NO-HASHING %s
+
+// CHECK-NO-HASHING: Handled other.swift
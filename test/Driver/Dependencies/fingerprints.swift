@@ -0,0 +1,26 @@
+/// changes ==> uses-a | changes ==> uses-b
+/// Only the fingerprint of the declaration that uses-b depends on changes.
+
+// RUN: rm -rf %t && cp -r %S/Inputs/fingerprints/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// Generate the build record...
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./changes.swift ./uses-a.swift ./uses-b.swift -module-name main -j1 -v
+
+// ...then reset the .swiftdeps files.
+// RUN: cp -r %S/Inputs/fingerprints/*.swiftdeps %t
+
+// RUN: touch -t 201401240006 %t/changes.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./changes.swift ./uses-a.swift ./uses-b.swift -module-name main -j1 -v -driver-show-incremental > %t/output.txt 2>&1
+// RUN: FileCheck -check-prefix=CHECK-HANDLED %s < %t/output.txt
+// RUN: FileCheck -check-prefix=CHECK-HANDLED-NEG %s < %t/output.txt
+// RUN: FileCheck -check-prefix=CHECK-INCREMENTAL %s < %t/output.txt
+
+// CHECK-HANDLED: Handled changes.swift
+// CHECK-HANDLED: Handled uses-b.swift
+// CHECK-HANDLED-NEG-NOT: Handled uses-a.swift
+
+// CHECK-INCREMENTAL: changes.swift provides top-level name 'a', but its fingerprint is unchanged
+// CHECK-INCREMENTAL: Queuing uses-b.swift because of dependencies discovered later
+// CHECK-INCREMENTAL-NEXT: changes.swift provides top-level name 'b'
+// CHECK-INCREMENTAL-NOT: Queuing uses-a.swift
@@ -0,0 +1,39 @@
+/// main ==> external, other
+
+// RUN: rm -rf %t && cp -r %S/Inputs/output-cache/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json ./main.swift ./other.swift -module-name main -j1 -output-cache-path %t/cache -parseable-output 2>&1 | FileCheck -check-prefix=CHECK-MISS %s
+
+// CHECK-MISS-DAG: "kind": "began"
+// CHECK-MISS-DAG: "kind": "finished"
+// CHECK-MISS-NOT: "kind": "cached"
+// CHECK-MISS: "kind": "output-cache",
+// CHECK-MISS-NEXT: "name": "compile",
+// CHECK-MISS-NEXT: "hits": 0,
+// CHECK-MISS-NEXT: "misses": 2
+
+// RUN: rm %t/main.o %t/other.o %t/main.swiftdeps %t/other.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json ./main.swift ./other.swift -module-name main -j1 -output-cache-path %t/cache -parseable-output 2>&1 | FileCheck -check-prefix=CHECK-HIT %s
+// RUN: ls %t/main.o %t/other.o
+// RUN: diff %t/main.swift %t/main.swiftdeps
+// RUN: diff %t/other.swift %t/other.swiftdeps
+
+// CHECK-HIT-NOT: "kind": "began"
+// CHECK-HIT: "kind": "cached",
+// CHECK-HIT: "output": "Handled main.swift\n"
+// CHECK-HIT: "kind": "cached",
+// CHECK-HIT: "output": "Handled other.swift\n"
+// CHECK-HIT-NOT: "kind": "began"
+// CHECK-HIT: "kind": "output-cache",
+// CHECK-HIT-NEXT: "name": "compile",
+// CHECK-HIT-NEXT: "hits": 2,
+// CHECK-HIT-NEXT: "misses": 0
+
+// Only the job that depends on the external file runs again when it changes.
+// RUN: echo "version 2" > %t/external.swiftmodule
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json ./main.swift ./other.swift -module-name main -j1 -output-cache-path %t/cache -v 2>&1 | FileCheck -check-prefix=CHECK-EXTERNAL %s
+
+// CHECK-EXTERNAL-NOT: -primary-file ./other.swift
+// CHECK-EXTERNAL: -primary-file ./main.swift
+// CHECK-EXTERNAL-NOT: -primary-file ./other.swift
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t && cp -r %S/Inputs/independent/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift -j1 -parseable-output 2>&1 | FileCheck %s
+
+// CHECK: {{^{$}}
+// CHECK: "kind": "finished"
+// CHECK: "name": "compile"
+// CHECK: "output": "Handled main.swift\n"
+// CHECK-NEXT: "usage": {
+// CHECK-NEXT: "wall-usec": {{[0-9]+}},
+// CHECK-NEXT: "user-usec": {{[0-9]+}},
+// CHECK-NEXT: "system-usec": {{[0-9]+}},
+// CHECK-NEXT: "max-rss": {{[1-9][0-9]*}}
+// CHECK-NEXT: },
+// CHECK-NEXT: "exit-status": 0
+// CHECK-NEXT: {{^}$}}
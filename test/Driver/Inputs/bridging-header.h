@@ -0,0 +1 @@
+static inline int bridged(void) { return 0; }
@@ -0,0 +1,13 @@
+// RUN: %swiftc_driver -c -module-name main %S/Inputs/main.swift %S/Inputs/lib.swift %s %S/Inputs/single_int.swift -enable-batch-mode -j2 -driver-skip-execution -v 2>&1 | FileCheck %s
+// RUN: %swiftc_driver -c -module-name main %S/Inputs/main.swift %S/Inputs/lib.swift %s %S/Inputs/single_int.swift -enable-batch-mode -j2 -driver-skip-execution -driver-use-filelists -v 2>&1 | FileCheck -check-prefix=FILELIST %s
+// RUN: %swiftc_driver -c -module-name main %S/Inputs/main.swift %S/Inputs/lib.swift %s %S/Inputs/single_int.swift -enable-batch-mode -disable-batch-mode -j2 -driver-skip-execution -v 2>&1 | FileCheck -check-prefix=DISABLED %s
+
+// CHECK: -frontend -c -primary-file {{[^ ]*}}/Inputs/main.swift -primary-file {{[^ ]*}}/Inputs/lib.swift {{[^ ]*}}/batch_mode.swift {{[^ ]*}}/Inputs/single_int.swift {{.*}} -o {{[^ ]*}}main{{[^ ]*}}.o -o {{[^ ]*}}lib{{[^ ]*}}.o
+// CHECK-NEXT: -frontend -c {{[^ ]*}}/Inputs/main.swift {{[^ ]*}}/Inputs/lib.swift -primary-file {{[^ ]*}}/batch_mode.swift -primary-file {{[^ ]*}}/Inputs/single_int.swift {{.*}} -o {{[^ ]*}}batch_mode{{[^ ]*}}.o -o {{[^ ]*}}single_int{{[^ ]*}}.o
+// CHECK-NOT: -frontend
+
+// FILELIST: -frontend -c -filelist {{[^ ]*}} -primary-file {{[^ ]*}}/Inputs/main.swift -primary-file {{[^ ]*}}/Inputs/lib.swift {{.*}} -output-filelist {{[^ ]*}} -output-filelist {{[^ ]*}}
+// FILELIST-NEXT: -frontend -c -filelist {{[^ ]*}} -primary-file {{[^ ]*}}/batch_mode.swift -primary-file {{[^ ]*}}/Inputs/single_int.swift {{.*}} -output-filelist {{[^ ]*}} -output-filelist {{[^ ]*}}
+
+// DISABLED-COUNT-4: -frontend -c {{.*}} -primary-file
+// DISABLED-NOT: -frontend
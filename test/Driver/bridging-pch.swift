@@ -0,0 +1,20 @@
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header %S/Inputs/bridging-header.h -c %s %S/Inputs/lib.swift 2>&1 | FileCheck %s -check-prefix=NOPCHACT
+// NOPCHACT-NOT: generate-pch
+// NOPCHACT: 0: input, "{{.*}}bridging-pch.swift", swift
+// NOPCHACT: 1: compile, {0}, object
+
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header %S/Inputs/bridging-header.h -enable-bridging-pch -c %s %S/Inputs/lib.swift 2>&1 | FileCheck %s -check-prefix=PCHACT
+// PCHACT: 0: input, "{{.*}}bridging-header.h", objc-header
+// PCHACT: 1: generate-pch, {0}, pch
+// PCHACT: 2: input, "{{.*}}bridging-pch.swift", swift
+// PCHACT: 3: compile, {2, 1}, object
+// PCHACT: 4: input, "{{.*}}lib.swift", swift
+// PCHACT: 5: compile, {4, 1}, object
+
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header %S/Inputs/bridging-header.h -enable-bridging-pch -whole-module-optimization -c %s %S/Inputs/lib.swift 2>&1 | FileCheck %s -check-prefix=WMOACT
+// WMOACT-NOT: generate-pch
+
+// RUN: %swiftc_driver -### -import-objc-header %S/Inputs/bridging-header.h -enable-bridging-pch -c %s %S/Inputs/lib.swift 2>&1 | FileCheck %s -check-prefix=PCHJOB
+// PCHJOB: {{.*}}swift -frontend {{.*}}-emit-pch -import-objc-header {{.*}}bridging-header.h -o [[PCH:.*\.pch]]
+// PCHJOB: {{.*}}swift -frontend {{.*}}-primary-file {{.*}}bridging-pch.swift {{.*}}-import-objc-header [[PCH]]
+// PCHJOB: {{.*}}swift -frontend {{.*}}-primary-file {{.*}}lib.swift {{.*}}-import-objc-header [[PCH]]
@@ -36,6 +36,7 @@
 // RUN: not %swiftc_driver -driver-print-jobs -c -target x86_64-apple-macosx10.9 %s %t/driver-compile.swift 2>&1 | FileCheck -check-prefix DUPLICATE-NAME %s
 
 // RUN: %swiftc_driver -driver-print-jobs -c -target x86_64-apple-macosx10.9 %s %S/../Inputs/empty.swift -module-name main -driver-use-filelists 2>&1 | FileCheck -check-prefix=FILELIST %s
+// RUN: %swiftc_driver -driver-print-jobs -c -target x86_64-apple-macosx10.9 %s %S/../Inputs/empty.swift -module-name main -I /path/to/modules -driver-use-module-location-map 2>&1 | FileCheck -check-prefix=LOCATION-MAP %s
 
 // RUN: rm -rf %t && mkdir -p %t/DISTINCTIVE-PATH/usr/bin/
 // RUN: ln %swift_driver_plain %t/DISTINCTIVE-PATH/usr/bin/swiftc
@@ -113,6 +114,11 @@
 // FILELIST: -primary-file {{.*/(driver-compile.swift|empty.swift)}}
 // FILELIST: -output-filelist {{[^-]}}
 
+// LOCATION-MAP: bin/swift
+// LOCATION-MAP: -module-location-map [[MAP:(["][^"]+|[^ ]+)module-locations([^"]+["]|[^ ]+)]]
+// LOCATION-MAP-NEXT: bin/swift
+// LOCATION-MAP: -module-location-map [[MAP]]
+
 // UPDATE-CODE: DISTINCTIVE-PATH/usr/bin/swift-update
 // UPDATE-CODE: -c{{ }}
 // UPDATE-CODE: -o {{.+}}.remap
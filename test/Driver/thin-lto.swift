@@ -0,0 +1,11 @@
+// RUN: %swiftc_driver -driver-print-jobs -thin-lto -target x86_64-unknown-linux-gnu %s 2>&1 | FileCheck -check-prefix=CHECK -check-prefix=CHECK-LINUX %s
+// RUN: %swiftc_driver -driver-print-jobs -thin-lto -target x86_64-apple-macosx10.9 %s 2>&1 | FileCheck -check-prefix=CHECK -check-prefix=CHECK-DARWIN %s
+
+// CHECK: swift
+// CHECK: -frontend{{.*}} -thin-lto
+
+// CHECK-LINUX: swift-autolink-extract
+// CHECK-LINUX: clang++{{"? }}{{.*}} -flto=thin
+
+// CHECK-DARWIN: {{.*}}ld{{"? }}
+// CHECK-DARWIN-NOT: -flto
@@ -0,0 +1 @@
+func otherFunction() -> Int { return 1 }
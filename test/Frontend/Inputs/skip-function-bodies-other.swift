@@ -0,0 +1,13 @@
+func otherFunc() -> Int {
+  let x =
+}
+
+@_transparent
+func transparentFunc() -> Int {
+  let y =
+}
+
+@inline(__always)
+func alwaysInlineFunc() -> Int {
+  let z =
+}
@@ -0,0 +1,18 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-swift-frontend -emit-bc -module-name main -primary-file %S/Inputs/batch_mode-other.swift -primary-file %s -o %t/other.bc -o %t/main.bc -emit-reference-dependencies-path %t/other.swiftdeps -emit-reference-dependencies-path %t/main.swiftdeps -emit-yaml-reference-dependencies
+// RUN: ls %t/other.bc %t/main.bc
+// RUN: FileCheck -check-prefix=CHECK-OTHER %s < %t/other.swiftdeps
+// RUN: FileCheck -check-prefix=CHECK-MAIN %s < %t/main.swiftdeps
+
+// CHECK-OTHER-LABEL: provides-top-level:
+// CHECK-OTHER-NEXT: "otherFunction"
+// CHECK-OTHER-NOT: "mainFunction"
+
+// CHECK-MAIN-LABEL: provides-top-level:
+// CHECK-MAIN-NEXT: "mainFunction"
+// CHECK-MAIN-NOT: "otherFunction"
+
+// RUN: not %target-swift-frontend -emit-bc -module-name main -primary-file %S/Inputs/batch_mode-other.swift -primary-file %s -o %t/other.bc -o %t/main.bc -emit-reference-dependencies-path %t/main.swiftdeps 2>&1 | FileCheck -check-prefix=CHECK-COUNT %s
+// CHECK-COUNT: error: expected one '-emit-reference-dependencies-path' for each of the 2 primary files, but found 1
+
+func mainFunction() -> Int { return 2 }
@@ -3,9 +3,9 @@
 // RUN: rm -rf %t && mkdir %t
 
 // RUN: %target-swift-frontend -emit-dependencies-path - -parse %S/../Inputs/empty\ file.swift | FileCheck -check-prefix=CHECK-BASIC %s
-// RUN: %target-swift-frontend -emit-reference-dependencies-path - -parse -primary-file %S/../Inputs/empty\ file.swift | FileCheck -check-prefix=CHECK-BASIC-YAML %s
+// RUN: %target-swift-frontend -emit-reference-dependencies-path - -emit-yaml-reference-dependencies -parse -primary-file %S/../Inputs/empty\ file.swift | FileCheck -check-prefix=CHECK-BASIC-YAML %s
 
-// RUN: %target-swift-frontend -emit-dependencies-path %t.d -emit-reference-dependencies-path %t.swiftdeps -parse -primary-file %S/../Inputs/empty\ file.swift
+// RUN: %target-swift-frontend -emit-dependencies-path %t.d -emit-reference-dependencies-path %t.swiftdeps -emit-yaml-reference-dependencies -parse -primary-file %S/../Inputs/empty\ file.swift
 // RUN: FileCheck -check-prefix=CHECK-BASIC %s < %t.d
 // RUN: FileCheck -check-prefix=CHECK-BASIC-YAML %s < %t.swiftdeps
 
@@ -19,6 +19,11 @@
 // CHECK-BASIC-YAML: "{{.*}}/Swift.swiftmodule"
 // CHECK-BASIC-YAML-NOT: {{:$}}
 
+// RUN: %target-swift-frontend -emit-reference-dependencies-path %t-binary.swiftdeps -parse -primary-file %S/../Inputs/empty\ file.swift
+// RUN: head -c 4 %t-binary.swiftdeps | FileCheck -check-prefix=CHECK-BINARY %s
+
+// CHECK-BINARY: SWDP
+
 
 // RUN: %target-swift-frontend -emit-dependencies-path %t.d -emit-reference-dependencies-path %t.swiftdeps -parse %S/../Inputs/empty\ file.swift 2>&1 | FileCheck -check-prefix=NO-PRIMARY-FILE %s
 
@@ -39,7 +44,7 @@
 // CHECK-MULTIPLE-OUTPUTS-NOT: :
 
 // RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -import-objc-header %S/Inputs/dependencies/extra-header.h -emit-dependencies-path - -parse %s | FileCheck -check-prefix=CHECK-IMPORT %s
-// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -import-objc-header %S/Inputs/dependencies/extra-header.h -emit-reference-dependencies-path - -parse -primary-file %s | FileCheck -check-prefix=CHECK-IMPORT-YAML %s
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -import-objc-header %S/Inputs/dependencies/extra-header.h -emit-reference-dependencies-path - -emit-yaml-reference-dependencies -parse -primary-file %s | FileCheck -check-prefix=CHECK-IMPORT-YAML %s
 
 // CHECK-IMPORT-LABEL: - :
 // CHECK-IMPORT: dependencies.swift
@@ -67,7 +72,7 @@
 // CHECK-IMPORT-YAML-NOT: {{:$}}
 
 // RUN: not %target-swift-frontend(mock-sdk: %clang-importer-sdk) -DERROR -import-objc-header %S/Inputs/dependencies/extra-header.h -emit-dependencies-path - -parse %s | FileCheck -check-prefix=CHECK-IMPORT %s
-// RUN: not %target-swift-frontend(mock-sdk: %clang-importer-sdk) -DERROR -import-objc-header %S/Inputs/dependencies/extra-header.h -emit-reference-dependencies-path - -parse -primary-file %s | FileCheck -check-prefix=CHECK-IMPORT-YAML %s
+// RUN: not %target-swift-frontend(mock-sdk: %clang-importer-sdk) -DERROR -import-objc-header %S/Inputs/dependencies/extra-header.h -emit-reference-dependencies-path - -emit-yaml-reference-dependencies -parse -primary-file %s | FileCheck -check-prefix=CHECK-IMPORT-YAML %s
 
 
 import Foundation
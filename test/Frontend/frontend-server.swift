@@ -0,0 +1,22 @@
+// REQUIRES: OS=linux-gnu
+// RUN: rm -rf %t && mkdir %t
+
+// With no server listening, the job runs locally.
+// RUN: env SWIFT_FRONTEND_SERVER=%t/none %target-swift-frontend -emit-ir -module-name main -primary-file %s -o %t/local.ll
+
+// RUN: %swift_driver_plain -frontend-server %t/socket 5 < /dev/null > /dev/null 2>&1 &
+// RUN: for i in `seq 50`; do test -S %t/socket && break; sleep 0.1; done
+// RUN: env SWIFT_FRONTEND_SERVER=%t/socket %target-swift-frontend -emit-ir -module-name main -primary-file %s -o %t/first.ll
+// RUN: env SWIFT_FRONTEND_SERVER=%t/socket %target-swift-frontend -emit-ir -module-name main -primary-file %s -o %t/second.ll
+// RUN: cmp %t/local.ll %t/first.ll
+// RUN: cmp %t/local.ll %t/second.ll
+
+// Diagnostics and the exit status come back from the server.
+// RUN: not env SWIFT_FRONTEND_SERVER=%t/socket %target-swift-frontend -parse -module-name main -primary-file %s -D BROKEN 2>&1 | FileCheck %s
+// CHECK: error: use of unresolved identifier 'undefinedName'
+
+func mainFunction() -> Int { return 2 }
+
+#if BROKEN
+let x = undefinedName
+#endif
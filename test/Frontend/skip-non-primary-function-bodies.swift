@@ -0,0 +1,16 @@
+// The bodies of functions in other files are only lexed, unless they may be
+// inlined, so only their errors are diagnosed.
+// RUN: not %target-swift-frontend -parse -primary-file %s %S/Inputs/skip-function-bodies-other.swift 2>&1 | FileCheck %s
+// RUN: not %target-swift-frontend -parse -primary-file %s %S/Inputs/skip-function-bodies-other.swift -parse-all-function-bodies 2>&1 | FileCheck -check-prefix=CHECK-ALL %s
+
+// CHECK-NOT: skip-function-bodies-other.swift:2:
+// CHECK: skip-function-bodies-other.swift:7:{{[0-9]+}}: error: expected initial value after '='
+// CHECK: skip-function-bodies-other.swift:12:{{[0-9]+}}: error: expected initial value after '='
+
+// CHECK-ALL: skip-function-bodies-other.swift:2:{{[0-9]+}}: error: expected initial value after '='
+// CHECK-ALL: skip-function-bodies-other.swift:7:{{[0-9]+}}: error: expected initial value after '='
+// CHECK-ALL: skip-function-bodies-other.swift:12:{{[0-9]+}}: error: expected initial value after '='
+
+func primaryFunc() -> Int {
+  return otherFunc() + transparentFunc() + alwaysInlineFunc()
+}
@@ -369,16 +369,17 @@ func testCondFail(_ b: Bool, c: Bool) {
 
 // CHECK-LABEL: define hidden void @_TF8builtins8testOnce{{.*}}(i8*, i8*) {{.*}} {
 // CHECK:         [[PRED_PTR:%.*]] = bitcast i8* %0 to [[WORD:i64|i32]]*
-// CHECK-objc:    [[PRED:%.*]] = load {{.*}} [[WORD]]* [[PRED_PTR]]
-// CHECK-objc:    [[IS_DONE:%.*]] = icmp eq [[WORD]] [[PRED]], -1
-// CHECK-objc:    br i1 [[IS_DONE]], label %[[DONE:.*]], label %[[NOT_DONE:.*]]
-// CHECK-objc:  [[NOT_DONE]]:
+// CHECK-objc:   [[PRED:%.*]] = load [[WORD]], [[WORD]]* [[PRED_PTR]], align
+// CHECK-native: [[PRED:%.*]] = load atomic [[WORD]], [[WORD]]* [[PRED_PTR]] acquire, align
+// CHECK:         [[IS_DONE:%.*]] = icmp eq [[WORD]] [[PRED]], -1
+// CHECK:         br i1 [[IS_DONE]], label %[[DONE:.*]], label %[[NOT_DONE:.*]], !prof
+// CHECK:       [[NOT_DONE]]:
 // CHECK:         call void @swift_once([[WORD]]* [[PRED_PTR]], i8* %1)
-// CHECK-objc:    br label %[[DONE]]
-// CHECK-objc:  [[DONE]]:
-// CHECK-objc:    [[PRED:%.*]] = load {{.*}} [[WORD]]* [[PRED_PTR]]
-// CHECK-objc:    [[IS_DONE:%.*]] = icmp eq [[WORD]] [[PRED]], -1
-// CHECK-objc:    call void @llvm.assume(i1 [[IS_DONE]])
+// CHECK:         br label %[[DONE]]
+// CHECK:       [[DONE]]:
+// CHECK:         [[PRED:%.*]] = load {{.*}} [[WORD]]* [[PRED_PTR]]
+// CHECK:         [[IS_DONE:%.*]] = icmp eq [[WORD]] [[PRED]], -1
+// CHECK:         call void @llvm.assume(i1 [[IS_DONE]])
 
 func testOnce(_ p: Builtin.RawPointer, f: @convention(thin) () -> ()) {
   Builtin.once(p, f)
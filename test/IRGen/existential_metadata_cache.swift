@@ -0,0 +1,37 @@
+// RUN: %target-swift-frontend -primary-file %s -emit-ir | FileCheck %s
+
+// Existential metadata with a static protocol list is fetched through a
+// lazily cached accessor, so generic code calls into the runtime for it at
+// most once, no matter how often it runs.
+
+protocol P {}
+protocol Q {}
+
+func takeType<T>(_: T.Type) {}
+
+// CHECK-LABEL: define hidden void @_TF26existential_metadata_cache9manyTypes
+// CHECK-NOT:     swift_getExistentialTypeMetadata
+// CHECK:         call %swift.type* @_TMaP26existential_metadata_cache1P_()
+// CHECK-NOT:     swift_getExistentialTypeMetadata
+// CHECK:         call %swift.type* @_TMaP26existential_metadata_cache1P{{.*}}1Q_()
+// CHECK-NOT:     swift_getExistentialTypeMetadata
+// CHECK:         ret void
+func manyTypes<T>(_: T.Type, count: Int) {
+  for _ in 0..<count {
+    takeType(T.self)
+    takeType(P.self)
+    takeType(protocol<P, Q>.self)
+  }
+}
+
+// CHECK-LABEL: define linkonce_odr hidden %swift.type* @_TMaP26existential_metadata_cache1P_()
+// CHECK:         [[CACHE:%.*]] = load %swift.type*, %swift.type** @_TMLP26existential_metadata_cache1P_
+// CHECK-NEXT:    [[ISNULL:%.*]] = icmp eq %swift.type* [[CACHE]], null
+// CHECK-NEXT:    br i1 [[ISNULL]], label %cacheIsNull, label %cont
+// CHECK:       cacheIsNull:
+// CHECK:         call %swift.type* @rt_swift_getExistentialTypeMetadata(
+// CHECK:         store atomic %swift.type* {{%.*}}, %swift.type** @_TMLP26existential_metadata_cache1P_ release
+
+// CHECK-LABEL: define linkonce_odr hidden %swift.type* @_TMaP26existential_metadata_cache1P{{.*}}1Q_()
+// CHECK:         load %swift.type*, %swift.type** @_TMLP26existential_metadata_cache1P{{.*}}1Q_
+// CHECK:         call %swift.type* @rt_swift_getExistentialTypeMetadata(i64 2,
@@ -17,6 +17,10 @@
 
 // CHECK: define hidden i8* @_TF12lazy_globalsau1xSi() {{.*}} {
 // CHECK: entry:
+// CHECK:   [[PRED:%.*]] = load {{(atomic )?}}i64, i64* @globalinit_[[T]]_token0
+// CHECK:   [[IS_DONE:%.*]] = icmp eq i64 [[PRED]], -1
+// CHECK:   br i1 [[IS_DONE]], label %once_done, label %once_not_done
+// CHECK: once_not_done:
 // CHECK:   call void @swift_once(i64* @globalinit_[[T]]_token0, i8* bitcast (void ()* @globalinit_[[T]]_func0 to i8*))
 // CHECK:   ret i8* bitcast (%Si* @_Tv12lazy_globals1xSi to i8*)
 // CHECK: }
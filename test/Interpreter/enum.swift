@@ -553,5 +553,45 @@ presentEitherOr(EitherOr<(), String>.Right("foo")) // CHECK-NEXT: Right(foo)
 // CHECK-NEXT: Right(foo)
 presentEitherOrsOf(t: (), u: "foo")
 
+// With payloads smaller than four bytes, the index of an empty case is split
+// between the payload area and the tag.
+enum SmallPayloads<T, U> {
+  case A(T)
+  case B(U)
+  case E0, E1, E2, E3, E4, E5
+}
+
+@inline(never)
+func presentSmallPayloads<T, U>(_ e: SmallPayloads<T, U>) {
+  switch e {
+  case .A(let a): print("A(\(a))")
+  case .B(let b): print("B(\(b))")
+  case .E0: print("E0")
+  case .E1: print("E1")
+  case .E2: print("E2")
+  case .E3: print("E3")
+  case .E4: print("E4")
+  case .E5: print("E5")
+  }
+}
+
+@inline(never)
+func presentSmallPayloadsOf<T, U>(t: T, u: U) {
+  presentSmallPayloads(SmallPayloads<T, U>.A(t))
+  presentSmallPayloads(SmallPayloads<T, U>.B(u))
+  presentSmallPayloads(SmallPayloads<T, U>.E0)
+  presentSmallPayloads(SmallPayloads<T, U>.E3)
+  presentSmallPayloads(SmallPayloads<T, U>.E4)
+  presentSmallPayloads(SmallPayloads<T, U>.E5)
+}
+
+// CHECK-NEXT: A(1)
+// CHECK-NEXT: B(2)
+// CHECK-NEXT: E0
+// CHECK-NEXT: E3
+// CHECK-NEXT: E4
+// CHECK-NEXT: E5
+presentSmallPayloadsOf(t: 1 as UInt8, u: 2 as Int8)
+
 // CHECK-NEXT: done
 print("done")
@@ -0,0 +1,41 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: env SWIFT_RUNTIME_STATISTICS=1 %target-run %t/a.out 2>&1 | FileCheck %s
+// RUN: %target-run %t/a.out 2>&1 | FileCheck %s -check-prefix=DISABLED
+// REQUIRES: executable_test
+
+class Node {
+  var next: Node?
+  init(next: Node?) { self.next = next }
+}
+
+protocol P {}
+struct Box<T> : P {}
+
+var list: Node? = nil
+for _ in 0..<100 {
+  list = Node(next: list)
+}
+list = nil
+
+let values: [Any] = [Box<Int>(), Box<String>(), 1, "two"]
+var conforming = 0
+for value in values {
+  if value is P {
+    conforming += 1
+  }
+}
+
+print("conforming: \(conforming)")
+// CHECK: conforming: 2
+// CHECK: Swift runtime statistics:
+// CHECK: {{[1-9][0-9]*}} retains
+// CHECK: {{[1-9][0-9]*}} releases
+// CHECK: {{[1-9][0-9][0-9]+}} object allocations
+// CHECK: {{[1-9][0-9][0-9]+}} object deallocations
+// CHECK: {{[1-9][0-9]*}} dynamic casts
+// CHECK: {{[1-9][0-9]*}} protocol conformance lookups
+// CHECK: {{[1-9][0-9]*}} generic metadata instantiations
+
+// DISABLED: conforming: 2
+// DISABLED-NOT: Swift runtime statistics
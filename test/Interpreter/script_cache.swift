@@ -0,0 +1,29 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-jit-run %s -script-cache-path %t/cache -Xllvm -debug-only=swift-immediate -- first 2>&1 | FileCheck -check-prefix=MISS %s
+// RUN: ls %t/cache | FileCheck -check-prefix=FILES %s
+// RUN: %target-jit-run %s -script-cache-path %t/cache -Xllvm -debug-only=swift-immediate -- second 2>&1 | FileCheck -check-prefix=HIT %s
+// RUN: %target-jit-run %s -script-cache-path %t/cache -Xllvm -debug-only=swift-immediate -D CHANGED -- third 2>&1 | FileCheck -check-prefix=CHANGED %s
+// REQUIRES: swift_interpreter
+// REQUIRES: asserts
+
+// MISS-NOT: Running script from cache entry
+// MISS-DAG: Stored script in cache entry
+// MISS-DAG: hello first
+
+// FILES: {{^[0-9a-f]+}}.manifest
+// FILES: {{^[0-9a-f]+}}.o
+
+// HIT-NOT: Stored script in cache entry
+// HIT: Running script from cache entry
+// HIT-NOT: Stored script in cache entry
+// HIT: hello second
+
+// CHANGED-NOT: Running script from cache entry
+// CHANGED-DAG: Stored script in cache entry
+// CHANGED-DAG: changed third
+
+#if CHANGED
+print("changed \(Process.arguments[1])")
+#else
+print("hello \(Process.arguments[1])")
+#endif
@@ -0,0 +1,45 @@
+; RUN: %swift-llvm-opt -swift-llvm-arc-optimize -swift-llvm-arc-opts-print-counts %s 2>%t.counts | FileCheck %s
+; RUN: FileCheck --check-prefix=COUNTS %s < %t.counts
+
+target datalayout = "e-p:64:64:64-S128-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f128:128:128-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+target triple = "x86_64-apple-macosx10.9"
+
+%swift.refcounted = type { %swift.heapmetadata*, i64 }
+%swift.heapmetadata = type { i64 (%swift.refcounted*)*, i64 (%swift.refcounted*)* }
+
+declare void @swift_release(%swift.refcounted* nocapture)
+declare void @swift_retain(%swift.refcounted* ) nounwind
+declare void @unknown_func()
+
+; COUNTS: ARC ops in interleaved_pairs: 5 before, 1 after
+; CHECK-LABEL: @interleaved_pairs(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: call void @swift_release(%swift.refcounted* %C)
+; CHECK-NEXT: ret void
+define void @interleaved_pairs(%swift.refcounted* %A, %swift.refcounted* %B, %swift.refcounted* %C) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  tail call void @swift_release(%swift.refcounted* %A)
+  tail call void @swift_retain(%swift.refcounted* %B)
+  tail call void @swift_release(%swift.refcounted* %C)
+  tail call void @swift_release(%swift.refcounted* %B)
+  ret void
+}
+
+; A retain of another object may be the same object dynamically.
+; COUNTS: ARC ops in retain_of_other_object: 3 before, 3 after
+; CHECK-LABEL: @retain_of_other_object(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: call void @swift_retain(%swift.refcounted* %A)
+; CHECK-NEXT: call void @swift_retain(%swift.refcounted* %B)
+; CHECK-NEXT: call void @unknown_func()
+; CHECK-NEXT: call void @swift_release(%swift.refcounted* %A)
+; CHECK-NEXT: ret void
+define void @retain_of_other_object(%swift.refcounted* %A, %swift.refcounted* %B) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  tail call void @swift_retain(%swift.refcounted* %B)
+  call void @unknown_func()
+  tail call void @swift_release(%swift.refcounted* %A)
+  ret void
+}
@@ -16,3 +16,26 @@ entry:
   %3 = add i8 %1, %2
   ret i8 %3
 }
+
+%swift.type = type { i64 }
+%swift.refcounted = type { %swift.type*, i32, i32 }
+%C4main1C = type <{ %swift.refcounted, i64 }>
+
+; Stored properties never overlap the header of another object.
+; CHECK-LABEL: define{{( protected)?}} i64 @test_eliminate_metadata_load_over_field_store(%C4main1C*, %C4main1C*) {
+; CHECK: load %swift.type*
+; CHECK-NOT: load %swift.type*
+; CHECK: ret
+define i64 @test_eliminate_metadata_load_over_field_store(%C4main1C*, %C4main1C*) {
+entry:
+  %isa1 = getelementptr inbounds %C4main1C, %C4main1C* %0, i32 0, i32 0, i32 0
+  %m1 = load %swift.type*, %swift.type** %isa1
+  %field = getelementptr inbounds %C4main1C, %C4main1C* %1, i32 0, i32 1
+  store i64 0, i64* %field
+  %isa2 = getelementptr inbounds %C4main1C, %C4main1C* %0, i32 0, i32 0, i32 0
+  %m2 = load %swift.type*, %swift.type** %isa2
+  %i1 = ptrtoint %swift.type* %m1 to i64
+  %i2 = ptrtoint %swift.type* %m2 to i64
+  %r = add i64 %i1, %i2
+  ret i64 %r
+}
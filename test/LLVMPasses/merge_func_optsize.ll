@@ -0,0 +1,54 @@
+; RUN: %swift-llvm-opt -swift-merge-functions -swiftmergefunc-threshold=30 -swiftmergefunc-size-threshold=4 %s | FileCheck %s
+
+@g1 = external global i32
+@g2 = external global i32
+
+; Functions which are optimized for size are merged with the size threshold.
+
+; CHECK-LABEL: define i32 @size_func1(i32 %x, i32 %y)
+; CHECK: %1 = tail call i32 @size_func1_merged(i32 %x, i32 %y, i32* @g1)
+; CHECK: ret i32 %1
+define i32 @size_func1(i32 %x, i32 %y) optsize {
+  %sum = add i32 %x, %y
+  %sum2 = add i32 %sum, %y
+  %l = load i32, i32* @g1, align 4
+  %sum3 = add i32 %sum2, %l
+  ret i32 %sum3
+}
+
+; CHECK-LABEL: define i32 @size_func2(i32 %x, i32 %y)
+; CHECK: %1 = tail call i32 @size_func1_merged(i32 %x, i32 %y, i32* @g2)
+; CHECK: ret i32 %1
+define i32 @size_func2(i32 %x, i32 %y) optsize {
+  %sum = add i32 %x, %y
+  %sum2 = add i32 %sum, %y
+  %l = load i32, i32* @g2, align 4
+  %sum3 = add i32 %sum2, %l
+  ret i32 %sum3
+}
+
+; Other functions still need to reach the normal threshold.
+
+; CHECK-LABEL: define i32 @speed_func1(i32 %x, i32 %y)
+; CHECK-NOT: call
+; CHECK: ret i32
+define i32 @speed_func1(i32 %x, i32 %y) {
+  %sum = add i32 %x, %y
+  %sum2 = add i32 %sum, %y
+  %l = load i32, i32* @g1, align 4
+  %sum3 = add i32 %sum2, %l
+  ret i32 %sum3
+}
+
+; CHECK-LABEL: define i32 @speed_func2(i32 %x, i32 %y)
+; CHECK-NOT: call
+; CHECK: ret i32
+define i32 @speed_func2(i32 %x, i32 %y) {
+  %sum = add i32 %x, %y
+  %sum2 = add i32 %sum, %y
+  %l = load i32, i32* @g2, align 4
+  %sum3 = add i32 %sum2, %l
+  ret i32 %sum3
+}
+
+; CHECK-LABEL: define internal i32 @size_func1_merged(i32, i32, i32*)
@@ -0,0 +1,9 @@
+// RUN: %target-swift-frontend -parse -debug-slowest-expressions 2 %s 2>&1 | FileCheck %s
+
+// CHECK: {{[0-9]+\.[0-9]}}ms{{	}}[{{.*}}]{{	}}{{[0-9]+}} states, {{[0-9]+}} disjunctions, {{[0-9]+}} type variables bound
+// CHECK-NEXT: {{[0-9]+\.[0-9]}}ms{{	}}[{{.*}}]{{	}}{{[0-9]+}} states, {{[0-9]+}} disjunctions, {{[0-9]+}} type variables bound
+// CHECK-NOT: states,
+
+let a = 1 + 2 * 3 - 4
+let b = [1, 2, 3].map { $0 * 2 }
+let c = "x" + "y"
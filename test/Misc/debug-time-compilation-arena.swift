@@ -0,0 +1,10 @@
+// RUN: %target-swift-frontend -parse -debug-time-compilation %s 2>&1 | FileCheck %s
+
+// CHECK: Swift compilation permanent arena growth (bytes)
+// CHECK-DAG: {{[0-9]+}}  Parsing
+// CHECK-DAG: {{[0-9]+}}  Name binding
+// CHECK-DAG: {{[0-9]+}}  Type checking / Semantic analysis
+// CHECK: {{[0-9]+}}  Total
+// CHECK-NEXT: {{[0-9]+}}  Largest constraint solver arena
+
+let x = [1, 2, 3].map { $0 + 1 }
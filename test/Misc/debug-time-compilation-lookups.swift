@@ -0,0 +1,10 @@
+// RUN: %target-swift-frontend -parse -debug-time-compilation %s 2>&1 | FileCheck %s
+
+// CHECK: Swift compilation imported module lookups
+// CHECK: {{[0-9]+}}  Answered by a source file's lookup cache
+// CHECK-NEXT: {{[0-9]+}}  Looked up and remembered
+// CHECK-NEXT: {{[0-9.]+}}%  Hit rate
+
+func f(_ x: Int, _ y: Int) -> Int { return x + y }
+func g(_ x: Int, _ y: Int) -> Int { return x + y }
+let s: String = "\(f(1, 2)) \(g(3, 4))"
@@ -0,0 +1,22 @@
+// RUN: %target-swift-frontend -emit-silgen -debug-time-compilation %s 2>&1 | FileCheck %s
+
+// Every function after the first one reuses the cleanup stack storage of the
+// function emitted before it.
+
+// CHECK: Swift compilation SILGen cleanup stacks
+// CHECK: {{[0-9]+}}  Functions emitted
+// CHECK-NEXT: {{[1-9][0-9]*}}  Functions that reused a cleanup stack
+// CHECK-NEXT: {{[0-9]+}}  Cleanup stack reallocations
+// CHECK-NEXT: {{[0-9]+}}  Largest cleanup stack (bytes)
+
+class C {}
+
+func first(_ x: C, _ y: C) -> C {
+  let z = x
+  return y
+}
+
+func second(_ x: C, _ y: C) -> C {
+  let z = y
+  return x
+}
@@ -0,0 +1,13 @@
+// RUN: %target-swift-frontend -emit-sil -debug-time-compilation %s 2>&1 | FileCheck %s
+
+// Both functions have the generic signature <T>, so the second one reuses
+// the dependent type lowerings of the first.
+
+// CHECK: Swift compilation dependent type lowerings
+// CHECK: {{[0-9]+}}  Generic signatures
+// CHECK-NEXT: {{[1-9][0-9]*}}  Generic contexts that reused cached lowerings
+// CHECK-NEXT: {{[0-9]+}}  Lowerings created
+// CHECK-NEXT: {{[1-9][0-9]*}}  Lowerings found in the cache
+
+func first<T>(_ x: T, _ y: (T) -> T) -> (T, T) { return (x, y(x)) }
+func second<T>(_ x: T, _ y: (T) -> T) -> (T, T) { return (y(x), x) }
@@ -0,0 +1,5 @@
+// RUN: %target-parse-verify-swift -solver-state-limit 1
+
+func f(_ x: Int, _ y: Int, _ z: Int) -> Int {
+  return x + y * z - x / y // expected-error{{expression was too complex to be solved in reasonable time; consider breaking up the expression into distinct sub-expressions}} expected-note{{possible overloads or conversions; consider giving it an explicit type}}
+}
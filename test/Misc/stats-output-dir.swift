@@ -0,0 +1,22 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -c -o %t/main.o -module-name main -stats-output-dir %t/stats %s
+// RUN: cat %t/stats/stats-swift-frontend-main-*.json | FileCheck %s
+// RUN: %swiftc_driver -driver-print-jobs -stats-output-dir %t/stats %s 2>&1 | FileCheck -check-prefix=DRIVER %s
+
+// CHECK: {
+// CHECK-DAG: "AST.NumSourceBuffers": {{[1-9][0-9]*}}
+// CHECK-DAG: "AST.NumTopLevelDecls": {{[1-9][0-9]*}}
+// CHECK-DAG: "AST.NumDeclsDeserialized": {{[1-9][0-9]*}}
+// CHECK-DAG: "Sema.NumConstraintSystemsSolved": {{[1-9][0-9]*}}
+// CHECK-DAG: "SILModule.NumSILGenFunctions": {{[1-9][0-9]*}}
+// CHECK-DAG: "SILModule.NumSILOptInstructions": {{[1-9][0-9]*}}
+// CHECK-DAG: "IRModule.NumIRInsts": {{[1-9][0-9]*}}
+// CHECK-DAG: "time.SILGen": {{[0-9]+\.[0-9]+}}
+// CHECK-DAG: "time.IRGen": {{[0-9]+\.[0-9]+}}
+// CHECK-DAG: "arena.Parsing": {{[0-9]+}}
+// CHECK: }
+
+// DRIVER: -frontend{{.*}} -stats-output-dir
+
+let x = [1, 2, 3].map { $0 + 1 }
+print(x)
@@ -0,0 +1,22 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -c -o %t/main.o -module-name main -trace-output-dir %t/trace %s
+// RUN: cat %t/trace/trace-swift-frontend-main-*.json | FileCheck %s
+// RUN: %swiftc_driver -driver-print-jobs -trace-output-dir %t/trace %s 2>&1 | FileCheck -check-prefix=DRIVER %s
+
+// CHECK: {"traceEvents":[
+// CHECK: {"ph":"M","name":"process_name",{{.*}}"args":{"name":"swift-frontend main"}}
+// CHECK-DAG: "name":"Parse file",{{.*}}"args":{"detail":"{{.*}}trace-output-dir.swift"}
+// CHECK-DAG: "name":"Parsing",
+// CHECK-DAG: "name":"Type-check function body",{{.*}}"args":{"detail":"increment(_:)"}
+// CHECK-DAG: "name":"SILGen function",{{.*}}"args":{"detail":"_TF4main9incrementFSiSi"}
+// CHECK-DAG: "name":"IRGen function",{{.*}}"args":{"detail":"_TF4main9incrementFSiSi"}
+// CHECK-DAG: "name":"LLVM module",{{.*}}"args":{"detail":"{{[^"]+}}"}
+// CHECK-DAG: "name":"IRGen",{{.*}}"ts":{{[0-9]+}},"dur":{{[0-9]+}}}
+// CHECK: ]}
+
+// DRIVER: -frontend{{.*}} -trace-output-dir
+
+func increment(_ x: Int) -> Int {
+  return x + 1
+}
+print(increment(1))
@@ -10,12 +10,13 @@
 
 // REQUIRES: objc_interop
 
-// CHECK-DAG: @import ctypes.bits;
-// CHECK-DAG: @import Foundation;
-// CHECK-DAG: @import Base;
-// CHECK-DAG: @import Base.ImplicitSub.ExSub;
-// CHECK-DAG: @import Base.ExplicitSub;
-// CHECK-DAG: @import Base.ExplicitSub.ExSub;
+// Imports are sorted by name, whichever declarations use them.
+// CHECK-LABEL: @import Base;
+// CHECK-NEXT: @import Base.ExplicitSub;
+// CHECK-NEXT: @import Base.ExplicitSub.ExSub;
+// CHECK-NEXT: @import Base.ImplicitSub.ExSub;
+// CHECK-NEXT: @import Foundation;
+// CHECK-NEXT: @import ctypes.bits;
 
 // NEGATIVE-NOT: ctypes;
 // NEGATIVE-NOT: ImSub;
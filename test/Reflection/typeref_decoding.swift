@@ -2,6 +2,11 @@
 // RUN: %target-build-swift %S/Inputs/ConcreteTypes.swift %S/Inputs/GenericTypes.swift %S/Inputs/Protocols.swift %S/Inputs/Extensions.swift %S/Inputs/Closures.swift -parse-as-library -emit-module -emit-library -module-name TypesToReflect -o %t/libTypesToReflect.%target-dylib-extension
 // RUN: %target-swift-reflection-dump -binary-filename %t/libTypesToReflect.%target-dylib-extension | FileCheck %s
 
+// Splitting the dump between threads doesn't change it.
+// RUN: %target-swift-reflection-dump -num-threads=1 -binary-filename %t/libTypesToReflect.%target-dylib-extension > %t/serial.txt
+// RUN: %target-swift-reflection-dump -num-threads=7 -binary-filename %t/libTypesToReflect.%target-dylib-extension > %t/parallel.txt
+// RUN: diff %t/serial.txt %t/parallel.txt
+
 // CHECK: FIELDS:
 // CHECK: =======
 // CHECK: TypesToReflect.Box
@@ -0,0 +1,5 @@
+// RUN: not %target-swift-frontend -emit-silgen -profile-use %S/Inputs/does-not-exist.profdata %s 2>&1 | FileCheck %s
+
+// CHECK: error: error reading profile data '{{.*}}does-not-exist.profdata'
+
+func foo() {}
@@ -0,0 +1,4 @@
+@inline(never)
+public func genericIdentity<T>(_ x: T) -> T {
+  return x
+}
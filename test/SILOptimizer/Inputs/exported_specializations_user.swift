@@ -0,0 +1,6 @@
+import ExportedGeneric
+
+@inline(never)
+public func identityOfInt(_ x: Int) -> Int {
+  return genericIdentity(x)
+}
@@ -0,0 +1,21 @@
+public struct Config {
+  public let limit: Int32
+
+  // No other module can create a Config without calling one of the
+  // initializers below, because it cannot initialize this property.
+  let seed: Int32
+
+  public let scale: Int32
+
+  public init() {
+    limit = 100
+    seed = 1
+    scale = 2
+  }
+
+  public init(seed: Int32, scale: Int32) {
+    limit = 100
+    self.seed = seed
+    self.scale = scale
+  }
+}
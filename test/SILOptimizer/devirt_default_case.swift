@@ -130,9 +130,13 @@ class Base4 {
 // B has its own implementation.
 @inline(never)
 func foo(_ a: A3) -> Int {
-// Check that call to A3.f() can be devirtualized.
+// Check that call to A3.f() can be devirtualized, and that C, D and E are
+// not checked for, because the default case handles them.
 //
 // CHECK-NORMAL: sil{{( hidden)?}} [noinline] @_TTSf4g___TF19devirt_default_case3fooFCS_2A3Si
+// CHECK-NORMAL-NOT: checked_cast_br [exact] {{.*}} to $C3
+// CHECK-NORMAL-NOT: checked_cast_br [exact] {{.*}} to $D3
+// CHECK-NORMAL-NOT: checked_cast_br [exact] {{.*}} to $E3
 // CHECK-NORMAL: function_ref @{{.*}}TFC19devirt_default_case2B31f
 // CHECK-NORMAL: function_ref @{{.*}}TFC19devirt_default_case2A31f
 // CHECK-NORMAL-NOT: class_method
@@ -0,0 +1,25 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-swift-frontend -O -parse-as-library -sil-serialize-all -module-name ExportedGeneric %S/Inputs/exported_specializations_generic.swift -emit-module-path %t/ExportedGeneric.swiftmodule
+// RUN: %target-swift-frontend -O -parse-as-library -I %t -sil-export-specializations -module-name ExportedUser %S/Inputs/exported_specializations_user.swift -emit-module-path %t/ExportedUser.swiftmodule
+// RUN: %target-swift-frontend -O -I %t -sil-use-exported-specializations %s -emit-sil | FileCheck %s
+// RUN: %target-swift-frontend -O -I %t %s -emit-sil | FileCheck %s -check-prefix=LOCAL
+
+// Check that a generic specialization exported by an imported module is
+// called instead of being created again.
+
+import ExportedGeneric
+import ExportedUser
+
+// CHECK-LABEL: sil [noinline] @_TF24exported_specializations4testFSiSi
+// CHECK: function_ref @_TTSg5Si___TF15ExportedGeneric15genericIdentity
+// CHECK: return
+@inline(never)
+public func test(_ x: Int) -> Int {
+  return genericIdentity(x) + identityOfInt(x)
+}
+
+// CHECK: sil public_external @_TTSg5Si___TF15ExportedGeneric15genericIdentity
+
+// Without -sil-use-exported-specializations the specialization is created
+// locally.
+// LOCAL: sil shared [noinline] @_TTSg5Si___TF15ExportedGeneric15genericIdentity
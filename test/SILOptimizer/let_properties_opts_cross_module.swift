@@ -0,0 +1,31 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -O -parse-as-library -emit-module -module-name let_properties_opts_other_module -o %t %S/Inputs/let_properties_opts_other_module.swift
+// RUN: %target-sil-opt -enable-sil-verify-all %t/let_properties_opts_other_module.swiftmodule | FileCheck -check-prefix=SUMMARY %s
+// RUN: %target-swift-frontend -O -emit-sil -I %t %s | FileCheck %s
+
+// Test that the values of let properties of other modules are propagated
+// when the other module recorded them.
+
+import let_properties_opts_other_module
+
+// The module has a value summary only for the property that is always
+// initialized to the same value.
+// SUMMARY-LABEL: sil shared [fragile] [_semantics "letprop.value"] @_TIvV31let_properties_opts_other_module6Config5limitVs5Int32k : $@convention(thin) () -> Int32
+// SUMMARY: integer_literal $Builtin.Int32, 100
+// SUMMARY-NOT: @_TIvV31let_properties_opts_other_module6Config5scale
+
+// CHECK-LABEL: sil @_TF32let_properties_opts_cross_module8getLimit
+// CHECK-NOT: struct_extract
+// CHECK: integer_literal $Builtin.Int32, 100
+// CHECK-NOT: struct_extract
+// CHECK: return
+public func getLimit(_ c: Config) -> Int32 {
+  return c.limit
+}
+
+// CHECK-LABEL: sil @_TF32let_properties_opts_cross_module8getScale
+// CHECK: struct_extract %0 : $Config, #Config.scale
+// CHECK: return
+public func getScale(_ c: Config) -> Int32 {
+  return c.scale
+}
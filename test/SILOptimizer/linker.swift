@@ -2,8 +2,12 @@
 // RUN: mkdir %t
 // RUN: %target-swift-frontend -emit-module %S/Inputs/linker_pass_input.swift -o %t/Swift.swiftmodule -parse-stdlib -parse-as-library -module-name Swift -sil-serialize-all -module-link-name swiftCore
 // RUN: %target-swift-frontend %s -O -I %t -sil-debug-serialization -o - -emit-sil | FileCheck %s
+// RUN: %target-swift-frontend %s -O -I %t -sil-debug-serialization -o - -emit-sil -Xllvm -sil-link-eager-body-size-limit=0 | FileCheck %s -check-prefix=DEFER
 
 // CHECK: sil public_external [fragile] @_TFs11doSomethingFT_T_ : $@convention(thin) () -> () {
+
+// Non-generic bodies larger than the limit are left in their module.
+// DEFER: sil {{.*}}@_TFs11doSomethingFT_T_ : $@convention(thin) () -> (){{$}}
 doSomething()
 
 // Make sure we are not linking doSomething2 because it is marked with 'noimport'
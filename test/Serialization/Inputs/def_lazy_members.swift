@@ -0,0 +1,18 @@
+public struct Counter {
+  public var count: Int
+  public init(count: Int) { self.count = count }
+  public func incremented() -> Counter { return Counter(count: count + 1) }
+  public func decremented() -> Counter { return Counter(count: count - 1) }
+  public static func zero() -> Counter { return Counter(count: 0) }
+}
+
+extension Counter {
+  public func doubled() -> Counter { return Counter(count: count * 2) }
+  public var isZero: Bool { return count == 0 }
+}
+
+public class Box {
+  public var counter = Counter(count: 0)
+  public init() {}
+  public func reset() { counter = Counter.zero() }
+}
@@ -0,0 +1,17 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_lazy_members.swift
+// RUN: llvm-bcanalyzer %t/def_lazy_members.swiftmodule | FileCheck %s -check-prefix=BCANALYZER
+// RUN: %target-swift-frontend -parse -I %t %s -print-stats 2>&1 | FileCheck %s -check-prefix=STATS
+
+// REQUIRES: asserts
+
+// BCANALYZER-NOT: UnknownCode
+
+// STATS: {{[0-9]+}} Name lookup{{ *}}- # of lookups that loaded serialized members by name
+
+import def_lazy_members
+
+let c = Counter(count: 1).incremented().doubled()
+let z: Bool = c.isZero
+Box().reset()
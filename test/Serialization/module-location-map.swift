@@ -0,0 +1,25 @@
+// RUN: rm -rf %t && mkdir -p %t/modules %t/empty
+// RUN: %target-swift-frontend -emit-module -o %t/modules %S/Inputs/def_struct.swift
+
+// RUN: %target-swift-frontend -parse %s -I %t/empty -I %t/modules
+
+// A map which says that the directory is empty keeps the module from being
+// found, even though it is there.
+// RUN: echo "swift-module-location-map 1" > %t/empty.map
+// RUN: echo "d %t/modules" >> %t/empty.map
+// RUN: not %target-swift-frontend -parse %s -I %t/empty -I %t/modules -module-location-map %t/empty.map 2>&1 | FileCheck -check-prefix=NOT-FOUND %s
+// NOT-FOUND: error: no such module 'def_struct'
+
+// RUN: echo "swift-module-location-map 1" > %t/found.map
+// RUN: echo "d %t/empty" >> %t/found.map
+// RUN: echo "d %t/modules" >> %t/found.map
+// RUN: echo "e def_struct.swiftmodule" >> %t/found.map
+// RUN: %target-swift-frontend -parse %s -I %t/empty -I %t/modules -module-location-map %t/found.map
+
+// Directories the map doesn't list, and maps which can't be read, fall back
+// to the file system.
+// RUN: %target-swift-frontend -parse %s -I %t/empty -I %t/modules -module-location-map %t/nonexistent.map
+// RUN: echo "garbage" > %t/bad.map
+// RUN: %target-swift-frontend -parse %s -I %t/empty -I %t/modules -module-location-map %t/bad.map
+
+import def_struct
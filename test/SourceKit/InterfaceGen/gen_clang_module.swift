@@ -50,6 +50,14 @@ var x: FooClassBase
 // CHECK2: Foo{{$}}
 // CHECK2-NEXT: /<interface-gen>
 
+// Opening the interface again reuses the interface printed by the first
+// request; the declarations it refers to must still resolve.
+// RUN: %sourcekitd-test -req=interface-gen-open -module Foo -- -I %t.overlays -F %S/../Inputs/libIDE-mock-sdk \
+// RUN:         %mcp_opt %clang-importer-sdk \
+// RUN:      == -req=interface-gen-open -module Foo -- -I %t.overlays -F %S/../Inputs/libIDE-mock-sdk \
+// RUN:         %mcp_opt %clang-importer-sdk \
+// RUN:      == -req=cursor -pos=230:20 | FileCheck -check-prefix=CHECK2 %s
+
 // RUN: %sourcekitd-test -req=interface-gen-open -module Foo -- -I %t.overlays -F %S/../Inputs/libIDE-mock-sdk \
 // RUN:         %mcp_opt %clang-importer-sdk \
 // RUN:      == -req=find-usr -usr "c:objc(cs)FooClassDerived(im)fooInstanceFunc0" | FileCheck -check-prefix=CHECK-USR %s
@@ -0,0 +1,15 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -primary-file %s -module-name emit_sib -O -parse-as-library -emit-sib -o %t/all.sib
+// RUN: %target-sil-extract %t/all.sib -module-name emit_sib -func="_TF8emit_sib4keepFT_Si" -emit-sib -o %t/extracted.sib
+// RUN: %target-sil-opt %t/extracted.sib -module-name emit_sib | FileCheck %s
+
+// CHECK-LABEL: sil {{.*}}@_TF8emit_sib4keepFT_Si : $@convention(thin) () -> Int {
+// CHECK-NOT: sil {{.*}}@_TF8emit_sib4dropFT_Si : $@convention(thin) () -> Int {
+
+public func keep() -> Int {
+  return 1
+}
+
+public func drop() -> Int {
+  return 2
+}
@@ -373,6 +373,17 @@ public:
                            ArrayRef<const char *> Args,
                            StringRef Hash) = 0;
 
+  /// Indexes each of \p Filenames, reporting to the consumer at the same
+  /// index in \p Consumers, and returns once all of them are done.
+  ///
+  /// Files are indexed concurrently, so each consumer receives its results
+  /// on a different thread as soon as they are produced. Files which have not
+  /// started yet when \p IsCancelled returns true fail instead.
+  virtual void indexSources(ArrayRef<std::string> Filenames,
+                            ArrayRef<IndexingConsumer *> Consumers,
+                            ArrayRef<const char *> Args,
+                            std::function<bool()> IsCancelled) = 0;
+
   virtual void codeComplete(llvm::MemoryBuffer *InputBuf, unsigned Offset,
                             CodeCompletionConsumer &Consumer,
                             ArrayRef<const char *> Args) = 0;
@@ -14,6 +14,7 @@
 #define LLVM_SOURCEKIT_LIB_SUPPORT_FUZZYSTRINGMATCHER_H
 
 #include "SourceKit/Core/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/BitVector.h"
 #include <string>
 
@@ -32,6 +33,9 @@ class FuzzyStringMatcher {
   double maxScore; ///< The maximum possible raw score for this pattern.
   /// If (and only if) c is in pattern, charactersInPattern[c] == 1
   llvm::BitVector charactersInPattern;
+  /// The lowercased characters of the pattern, folded into 64 bits by
+  /// getCharacterMaskBit().
+  uint64_t patternCharacterMask = 0;
 
 public:
   bool normalize = false; ///< Whether to normalize scores to [0, 1].
@@ -45,8 +49,20 @@ public:
   /// the candidate's score.
   bool matchesCandidate(StringRef candidate) const;
 
+  /// Quickly rejects candidates which do not contain every character of the
+  /// pattern, ignoring order and case.
+  ///
+  /// This may return true for candidates which do not match, but never false
+  /// for candidates which do.
+  bool mayMatchCandidate(StringRef candidate) const;
+
   /// Calculates the numerical score for \p candidate.
   double scoreCandidate(StringRef candidate) const;
+
+  /// Calculates the numerical scores for all of \p candidates and stores
+  /// them in \p scores, which must have the same size.
+  void scoreCandidates(ArrayRef<StringRef> candidates,
+                       llvm::MutableArrayRef<double> scores) const;
 };
 
 } // end namespace SourceKit
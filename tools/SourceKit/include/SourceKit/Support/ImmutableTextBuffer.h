@@ -21,12 +21,17 @@
 #include "llvm/Support/Mutex.h"
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace llvm {
   class MemoryBuffer;
   class SourceMgr;
 }
 
+namespace clang {
+  class RewriteRope;
+}
+
 namespace SourceKit {
 
 class ImmutableTextUpdate;
@@ -73,6 +78,11 @@ class ImmutableTextBuffer : public ImmutableTextUpdate {
   std::unique_ptr<llvm::SourceMgr> SrcMgr;
   unsigned BufId;
 
+  /// The offsets at which each line starts, computed on the first
+  /// getLineAndColumn() call so that later calls are a binary search.
+  mutable std::vector<unsigned> LineStarts;
+  mutable llvm::sys::Mutex LineStartsMtx;
+
 public:
   explicit ImmutableTextBuffer(std::unique_ptr<llvm::MemoryBuffer> MemBuf,
                                uint64_t Stamp);
@@ -180,6 +190,15 @@ private:
       const ImmutableTextSnapshot &Snap);
   void refresh();
   friend class ImmutableTextSnapshot;
+
+  /// The text at \c CachedRopeEnd, kept so that the buffer of a later
+  /// snapshot only needs to apply the updates made since.
+  llvm::sys::Mutex RopeMtx;
+  std::unique_ptr<clang::RewriteRope> CachedRope;
+  ImmutableTextUpdateRef CachedRopeEnd;
+
+public:
+  ~EditableTextBuffer();
 };
 
 class EditableTextBufferManager {
@@ -16,6 +16,7 @@
 #include "SourceKit/Support/UIdent.h"
 #include "llvm/ADT/Optional.h"
 
+#include <chrono>
 #include <vector>
 
 namespace SourceKit {
@@ -50,6 +51,9 @@ enum class OperationKind : uint64_t {
 
   CodeCompletionInit,
 };
+
+static const unsigned NumOperationKinds =
+    unsigned(OperationKind::CodeCompletionInit) + 1;
   
 typedef std::vector<std::pair<std::string, std::string>> StringPairs;
 
@@ -95,12 +99,55 @@ void operationFinished(uint64_t OpId);
 // Register trace consumer.
 void registerConsumer(TraceConsumer *Consumer);
 
-// Class that utilizes the RAII idiom for the operations being traced
+/// Latencies of one kind of event, in microseconds. The percentiles are
+/// upper bounds which are at most 25% above the exact value.
+struct LatencyStatistics {
+  uint64_t Count = 0;
+  uint64_t P50 = 0;
+  uint64_t P90 = 0;
+  uint64_t P99 = 0;
+  uint64_t Max = 0;
+};
+
+/// The statistics collected since the process started. They are recorded
+/// whether or not tracing is enabled.
+struct Statistics {
+  /// The execution time of each OperationKind.
+  LatencyStatistics Operations[NumOperationKinds];
+  /// The time AST requests spent in the AST build queue.
+  LatencyStatistics ASTQueueWait;
+  /// The number of AST requests which were served by a cached AST, and the
+  /// number which had to build one.
+  uint64_t ASTCacheHits = 0;
+  uint64_t ASTBuilds = 0;
+};
+
+// Record the execution time of an operation; done by TracedOperation.
+void recordOperationLatency(OperationKind OpKind, uint64_t Microseconds);
+
+// Record the time an AST request waited to be executed.
+void recordASTQueueWait(uint64_t Microseconds);
+
+// Record whether an AST request had to build an AST.
+void recordASTRequest(bool CacheHit);
+
+// Get a snapshot of the statistics.
+Statistics getStatistics();
+
+// Class that utilizes the RAII idiom for the operations being traced.
+//
+// The execution time from construction to finish() is always recorded in
+// the statistics. The trace consumers are only informed if start() was
+// called, which clients should only do if enabled() returns true.
 class TracedOperation final {
+  OperationKind OpKind;
+  std::chrono::steady_clock::time_point StartTime;
   llvm::Optional<uint64_t> OpId;
+  bool Finished = false;
 
 public:
-  TracedOperation() {}
+  explicit TracedOperation(OperationKind OpKind)
+    : OpKind(OpKind), StartTime(std::chrono::steady_clock::now()) {}
   ~TracedOperation() {
     finish();
   }
@@ -110,14 +157,26 @@ public:
   TracedOperation(const TracedOperation &) = delete;
   TracedOperation &operator=(const TracedOperation &) = delete;
 
-  void start(OperationKind OpKind,
-             const SwiftInvocation &Inv,
+  bool enabled() const {
+    return trace::enabled();
+  }
+
+  void start(const SwiftInvocation &Inv,
              const StringPairs &OpArgs = StringPairs()) {
-    finish();
+    assert(!OpId.hasValue() && !Finished);
     OpId = startOperation(OpKind, Inv, OpArgs);
   }
 
   void finish() {
+    if (Finished)
+      return;
+    Finished = true;
+
+    auto Elapsed = std::chrono::steady_clock::now() - StartTime;
+    recordOperationLatency(OpKind,
+        std::chrono::duration_cast<std::chrono::microseconds>(Elapsed)
+            .count());
+
     if (OpId.hasValue()) {
       operationFinished(OpId.getValue());
       OpId.reset();
@@ -21,6 +21,14 @@ using clang::toLowercase;
 using clang::isUppercase;
 using clang::isLowercase;
 
+/// Returns the bit for \p c in a 64-bit character set, ignoring case.
+///
+/// Different characters may share a bit, which only makes the set a
+/// conservative approximation.
+static uint64_t getCharacterMaskBit(char c) {
+  return uint64_t(1) << (static_cast<unsigned char>(toLowercase(c)) & 63);
+}
+
 FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
     : pattern(pattern_), charactersInPattern(1 << (sizeof(char) * 8)) {
   lowercasePattern.reserve(pattern.size());
@@ -31,6 +39,7 @@ FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
     lowercasePattern.push_back(lower);
     charactersInPattern.set(static_cast<unsigned char>(lower));
     charactersInPattern.set(static_cast<unsigned char>(toUppercase(c)));
+    patternCharacterMask |= getCharacterMaskBit(c);
   }
   assert(pattern.size() == lowercasePattern.size());
 
@@ -163,6 +172,32 @@ struct CandidateSpecificMatcher {
 };
 } // end anonymous namespace
 
+bool FuzzyStringMatcher::mayMatchCandidate(StringRef candidate) const {
+  // Accumulate the candidate's character set eight bytes at a time, without
+  // branches, and stop as soon as it covers the pattern.
+  uint64_t candidateMask = 0;
+  const char *p = candidate.begin(), *end = candidate.end();
+  for (; end - p >= 8; p += 8) {
+    candidateMask |= getCharacterMaskBit(p[0]) | getCharacterMaskBit(p[1]) |
+                     getCharacterMaskBit(p[2]) | getCharacterMaskBit(p[3]) |
+                     getCharacterMaskBit(p[4]) | getCharacterMaskBit(p[5]) |
+                     getCharacterMaskBit(p[6]) | getCharacterMaskBit(p[7]);
+    if ((patternCharacterMask & ~candidateMask) == 0)
+      return true;
+  }
+  for (; p != end; ++p)
+    candidateMask |= getCharacterMaskBit(*p);
+  return (patternCharacterMask & ~candidateMask) == 0;
+}
+
+void FuzzyStringMatcher::scoreCandidates(
+    ArrayRef<StringRef> candidates,
+    llvm::MutableArrayRef<double> scores) const {
+  assert(candidates.size() == scores.size());
+  for (unsigned i = 0, e = candidates.size(); i != e; ++i)
+    scores[i] = scoreCandidate(candidates[i]);
+}
+
 double FuzzyStringMatcher::scoreCandidate(StringRef candidate) const {
   double finalScore = 0.0;
   if (candidate.empty() || pattern.empty() || candidate.size() < pattern.size())
@@ -188,6 +223,11 @@ double FuzzyStringMatcher::scoreCandidate(StringRef candidate) const {
     return finalScore;
   }
 
+  // A candidate without all of the pattern's characters cannot match. Reject
+  // it before building the candidate's tables.
+  if (!mayMatchCandidate(candidate))
+    return finalScore;
+
   // FIXME: path separators would be handled here, jumping straight to the last
   // component if the pattern doesn't contain a separator.
 
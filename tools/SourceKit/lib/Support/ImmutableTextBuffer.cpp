@@ -14,6 +14,7 @@
 #include "clang/Rewrite/Core/RewriteRope.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
+#include <algorithm>
 
 using namespace SourceKit;
 using namespace llvm;
@@ -51,12 +52,31 @@ const llvm::MemoryBuffer *ImmutableTextBuffer::getInternalBuffer() const {
 
 std::pair<unsigned, unsigned>
 ImmutableTextBuffer::getLineAndColumn(unsigned ByteOffset) const {
-  auto Buf = SrcMgr->getMemoryBuffer(BufId);
-  if (ByteOffset > Buf->getBufferSize())
+  StringRef Text = getText();
+  if (ByteOffset > Text.size())
     return std::make_pair(0, 0);
 
-  SMLoc Loc = SMLoc::getFromPointer(Buf->getBufferStart() + ByteOffset);
-  return SrcMgr->getLineAndColumn(Loc, 0);
+  {
+    llvm::sys::ScopedLock L(LineStartsMtx);
+    if (LineStarts.empty()) {
+      LineStarts.push_back(0);
+      for (size_t Pos = Text.find('\n'); Pos != StringRef::npos;
+           Pos = Text.find('\n', Pos + 1))
+        LineStarts.push_back(Pos + 1);
+    }
+  }
+
+  // The last line starting at or before the offset.
+  auto LineIt = std::upper_bound(LineStarts.begin(), LineStarts.end(),
+                                 ByteOffset);
+  unsigned LineStart = *std::prev(LineIt);
+  unsigned Line = LineIt - LineStarts.begin();
+
+  // Like SourceMgr, start counting columns after a '\r' as well.
+  size_t CR = Text.slice(LineStart, ByteOffset).find_last_of('\r');
+  if (CR != StringRef::npos)
+    LineStart += CR + 1;
+  return std::make_pair(Line, ByteOffset - LineStart + 1);
 }
 
 ReplaceImmutableTextUpdate::ReplaceImmutableTextUpdate(
@@ -125,6 +145,8 @@ EditableTextBuffer::EditableTextBuffer(StringRef Filename, StringRef Text) {
   CurrUpd = Root;
 }
 
+EditableTextBuffer::~EditableTextBuffer() {}
+
 ImmutableTextSnapshotRef EditableTextBuffer::getSnapshot() const {
   return new ImmutableTextSnapshot(const_cast<EditableTextBuffer*>(this), Root,
                                    CurrUpd);
@@ -198,33 +220,48 @@ ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     if (auto Buf = dyn_cast<ImmutableTextBuffer>(Next))
       return Buf;
 
-  // Check if a buffer was created in the middle of the snapshot updates.
-  ImmutableTextBufferRef StartBuf = Snap.BufferStart;
-  ImmutableTextUpdateRef Upd = StartBuf;  
-  while (Upd != Snap.DiffEnd) {
-    Upd = Upd->Next;
-    if (auto Buf = dyn_cast<ImmutableTextBuffer>(Upd))
-      StartBuf = Buf;
-  }
-  StringRef StartText = StartBuf->getText();
+  llvm::sys::ScopedLock RopeLock(RopeMtx);
 
-  RewriteRope Rope;
   auto applyUpdate = [&](const ImmutableTextUpdateRef &Upd) {
     if (auto ReplaceUpd = dyn_cast<ReplaceImmutableTextUpdate>(Upd)) {
-      Rope.erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
+      CachedRope->erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
       StringRef Text = ReplaceUpd->getText();
-      Rope.insert(ReplaceUpd->getByteOffset(), Text.begin(), Text.end());
+      CachedRope->insert(ReplaceUpd->getByteOffset(), Text.begin(),
+                         Text.end());
     }
   };
 
-  Rope.assign(StartText.begin(), StartText.end());
-  Upd = StartBuf;
+  // If the cached rope is for an earlier point of this snapshot's history,
+  // only the updates made since need to be applied.
+  ImmutableTextUpdateRef Upd = CachedRopeEnd;
+  while (Upd && Upd != Snap.DiffEnd)
+    Upd = Upd->Next;
+
+  if (Upd) {
+    Upd = CachedRopeEnd;
+  } else {
+    // Check if a buffer was created in the middle of the snapshot updates.
+    ImmutableTextBufferRef StartBuf = Snap.BufferStart;
+    Upd = StartBuf;
+    while (Upd != Snap.DiffEnd) {
+      Upd = Upd->Next;
+      if (auto Buf = dyn_cast<ImmutableTextBuffer>(Upd))
+        StartBuf = Buf;
+    }
+    StringRef StartText = StartBuf->getText();
+
+    CachedRope.reset(new RewriteRope());
+    CachedRope->assign(StartText.begin(), StartText.end());
+    Upd = StartBuf;
+  }
+
   while (Upd != Snap.DiffEnd) {
     Upd = Upd->Next;
     applyUpdate(Upd);
   }
+  CachedRopeEnd = Snap.DiffEnd;
 
-  auto MemBuf = getMemBufferFromRope(getFilename(), Rope);
+  auto MemBuf = getMemBufferFromRope(getFilename(), *CachedRope);
   ImmutableTextBufferRef ImmBuf = new ImmutableTextBuffer(std::move(MemBuf),
                                                           Snap.getStamp());
 
@@ -14,6 +14,7 @@
 
 #include "swift/Frontend/Frontend.h"
 
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/YAMLTraits.h"
 
@@ -38,6 +39,102 @@ struct TraceConsumerListNode {
 };
 static std::atomic<TraceConsumerListNode *> consumers(nullptr);
 
+//===----------------------------------------------------------------------===//
+// Statistics
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// A histogram of latencies which is updated without locks.
+///
+/// Values below 4 get a bucket each. Above that, every power of two range is
+/// split into 4 buckets by the two bits after the leading one, so a bucket's
+/// upper bound is at most 25% larger than the values in it.
+class LatencyHistogram {
+  static const unsigned SubBucketBits = 2;
+  static const unsigned NumSubBuckets = 1 << SubBucketBits;
+  static const unsigned NumBuckets = 64 * NumSubBuckets;
+
+  std::atomic<uint64_t> Buckets[NumBuckets];
+  std::atomic<uint64_t> Max;
+
+  static unsigned getBucket(uint64_t Value) {
+    if (Value < NumSubBuckets)
+      return Value;
+    unsigned Log = 63 - llvm::countLeadingZeros(Value);
+    unsigned Sub = (Value >> (Log - SubBucketBits)) & (NumSubBuckets - 1);
+    return ((Log - SubBucketBits + 1) << SubBucketBits) + Sub;
+  }
+
+  static uint64_t getUpperBound(unsigned Bucket) {
+    if (Bucket < NumSubBuckets)
+      return Bucket;
+    unsigned Log = (Bucket >> SubBucketBits) + SubBucketBits - 1;
+    uint64_t Sub = Bucket & (NumSubBuckets - 1);
+    uint64_t Width = uint64_t(1) << (Log - SubBucketBits);
+    return ((NumSubBuckets | Sub) << (Log - SubBucketBits)) + Width - 1;
+  }
+
+public:
+  LatencyHistogram() {
+    for (auto &Bucket : Buckets)
+      Bucket.store(0, std::memory_order_relaxed);
+    Max.store(0, std::memory_order_relaxed);
+  }
+
+  void add(uint64_t Value) {
+    Buckets[getBucket(Value)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t OldMax = Max.load(std::memory_order_relaxed);
+    while (OldMax < Value &&
+           !Max.compare_exchange_weak(OldMax, Value,
+                                      std::memory_order_relaxed))
+      ;
+  }
+
+  /// Computes the statistics from a snapshot of the buckets. Concurrent
+  /// updates may or may not be included.
+  trace::LatencyStatistics getStatistics() const {
+    uint64_t Counts[NumBuckets];
+    trace::LatencyStatistics Stats;
+    for (unsigned I = 0; I != NumBuckets; ++I) {
+      Counts[I] = Buckets[I].load(std::memory_order_relaxed);
+      Stats.Count += Counts[I];
+    }
+    if (Stats.Count == 0)
+      return Stats;
+    Stats.Max = Max.load(std::memory_order_relaxed);
+
+    auto getPercentile = [&](unsigned Percent) -> uint64_t {
+      uint64_t Rank = (Stats.Count * Percent + 99) / 100;
+      uint64_t Seen = 0;
+      for (unsigned I = 0; I != NumBuckets; ++I) {
+        Seen += Counts[I];
+        if (Seen >= Rank)
+          return std::min(getUpperBound(I), Stats.Max);
+      }
+      return Stats.Max;
+    };
+    Stats.P50 = getPercentile(50);
+    Stats.P90 = getPercentile(90);
+    Stats.P99 = getPercentile(99);
+    return Stats;
+  }
+};
+
+struct StatisticsStorage {
+  LatencyHistogram Operations[trace::NumOperationKinds];
+  LatencyHistogram ASTQueueWait;
+  std::atomic<uint64_t> ASTCacheHits{0};
+  std::atomic<uint64_t> ASTBuilds{0};
+};
+
+} // end anonymous namespace
+
+static StatisticsStorage &getStatisticsStorage() {
+  static StatisticsStorage Storage;
+  return Storage;
+}
+
 
 //===----------------------------------------------------------------------===//
 // Trace commands
@@ -91,3 +188,32 @@ void trace::registerConsumer(trace::TraceConsumer *Consumer) {
                                             std::memory_order_release,
                                             std::memory_order_relaxed));
 }
+
+void trace::recordOperationLatency(trace::OperationKind OpKind,
+                                   uint64_t Microseconds) {
+  assert(unsigned(OpKind) < NumOperationKinds);
+  getStatisticsStorage().Operations[unsigned(OpKind)].add(Microseconds);
+}
+
+void trace::recordASTQueueWait(uint64_t Microseconds) {
+  getStatisticsStorage().ASTQueueWait.add(Microseconds);
+}
+
+void trace::recordASTRequest(bool CacheHit) {
+  auto &Storage = getStatisticsStorage();
+  if (CacheHit)
+    Storage.ASTCacheHits.fetch_add(1, std::memory_order_relaxed);
+  else
+    Storage.ASTBuilds.fetch_add(1, std::memory_order_relaxed);
+}
+
+trace::Statistics trace::getStatistics() {
+  auto &Storage = getStatisticsStorage();
+  trace::Statistics Stats;
+  for (unsigned I = 0; I != NumOperationKinds; ++I)
+    Stats.Operations[I] = Storage.Operations[I].getStatistics();
+  Stats.ASTQueueWait = Storage.ASTQueueWait.getStatistics();
+  Stats.ASTCacheHits = Storage.ASTCacheHits.load(std::memory_order_relaxed);
+  Stats.ASTBuilds = Storage.ASTBuilds.load(std::memory_order_relaxed);
+  return Stats;
+}
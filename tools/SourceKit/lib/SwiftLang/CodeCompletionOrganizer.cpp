@@ -216,9 +216,10 @@ public:
   void addCompletionsWithFilter(ArrayRef<Completion *> completions,
                                 StringRef filterText, Options options,
                                 const FilterRules &rules,
-                                Completion *&exactMatch);
+                                Completion *&exactMatch,
+                                std::vector<Completion *> *matches);
 
-  void sort(Options options);
+  void sort(Options options, unsigned numResultsNeeded);
 
   void groupOverloads() {
     groupStemsRecursive(
@@ -291,18 +292,20 @@ void CodeCompletionOrganizer::preSortCompletions(
 
 void CodeCompletionOrganizer::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText,
-    const FilterRules &rules, Completion *&exactMatch) {
+    const FilterRules &rules, Completion *&exactMatch,
+    std::vector<Completion *> *matches) {
   impl.addCompletionsWithFilter(completions, filterText, options, rules,
-                                exactMatch);
+                                exactMatch, matches);
 }
 
-void CodeCompletionOrganizer::groupAndSort(const Options &options) {
+void CodeCompletionOrganizer::groupAndSort(const Options &options,
+                                           unsigned numResultsNeeded) {
   if (options.groupStems)
     impl.groupStems();
   else if (options.groupOverloads)
     impl.groupOverloads();
 
-  impl.sort(options);
+  impl.sort(options, numResultsNeeded);
 }
 
 CodeCompletionViewRef CodeCompletionOrganizer::takeResultsView() {
@@ -508,7 +511,8 @@ bool FilterRules::hideCompletion(SwiftResult *completion, StringRef name, void *
 
 void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText, Options options,
-    const FilterRules &rules, Completion *&exactMatch) {
+    const FilterRules &rules, Completion *&exactMatch,
+    std::vector<Completion *> *matches) {
   assert(rootGroup);
 
   auto &contents = rootGroup->contents;
@@ -596,6 +600,9 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
       match = completion->getName().startswith_lower(filterText);
     }
 
+    if (match && matches)
+      matches->push_back(completion);
+
     bool isExactMatch = match && completion->getName().equals_lower(filterText);
 
     if (isExactMatch) {
@@ -946,8 +953,13 @@ static void sortTopN(const Options &options, Group *group,
   }
 }
 
+/// Sorts the contents of \p group and its subgroups.
+///
+/// If \p numResultsNeeded is not zero, only that many of the best results of
+/// \p group itself are sorted to the front.
 static void sortRecursive(const Options &options, Group *group,
-                          bool hasExpectedTypes) {
+                          bool hasExpectedTypes,
+                          unsigned numResultsNeeded = 0) {
   // Sort all of the subgroups first, and fill in the bucket for each result.
   auto &contents = group->contents;
   double best = -1.0;
@@ -975,7 +987,8 @@ static void sortRecursive(const Options &options, Group *group,
     return;
   }
 
-  std::sort(contents.begin(), contents.end(), [=](const std::unique_ptr<Item> &a_, const std::unique_ptr<Item> &b_) {
+  auto compare = [=](const std::unique_ptr<Item> &a_,
+                     const std::unique_ptr<Item> &b_) {
     Item &a = *a_;
     Item &b = *b_;
 
@@ -1023,11 +1036,35 @@ static void sortRecursive(const Options &options, Group *group,
       return true;
 
     return compareResultName(a, b) < 0;
-  });
+  };
+
+  // sortTopN may move up to showTopNonLiteralResults results from after the
+  // literals at the front, so sort those as well.
+  unsigned numToSort = numResultsNeeded;
+  if (numToSort != 0)
+    numToSort += options.showTopNonLiteralResults;
+  if (numToSort == 0 || numToSort >= contents.size()) {
+    std::sort(contents.begin(), contents.end(), compare);
+    return;
+  }
+
+  std::partial_sort(contents.begin(), contents.begin() + numToSort,
+                    contents.end(), compare);
+
+  // If the literals at the front fill all of the needed results, sortTopN
+  // looks for the first non-literal further down the list.
+  auto best = getResultBucket(*contents.front(), hasExpectedTypes);
+  if ((best == ResultBucket::Literal ||
+       best == ResultBucket::LiteralTypeMatch) &&
+      getResultBucket(*contents[numResultsNeeded - 1], hasExpectedTypes) ==
+          best)
+    std::sort(contents.begin() + numToSort, contents.end(), compare);
 }
 
-void CodeCompletionOrganizer::Impl::sort(Options options) {
-  sortRecursive(options, rootGroup.get(), completionHasExpectedTypes);
+void CodeCompletionOrganizer::Impl::sort(Options options,
+                                         unsigned numResultsNeeded) {
+  sortRecursive(options, rootGroup.get(), completionHasExpectedTypes,
+                numResultsNeeded);
   if (options.showTopNonLiteralResults != 0)
     sortTopN(options, rootGroup.get(), completionHasExpectedTypes);
 }
@@ -86,12 +86,21 @@ public:
   /// Add \p completions to the organizer, removing any results that don't match
   /// \p filterText and returning \p exactMatch if there is an exact match.
   ///
+  /// If \p matches is not null and \p filterText is not empty, it is filled
+  /// with the completions that matched \p filterText, in order, so that they
+  /// can be filtered again for a longer filter text.
+  ///
   /// Precondition: \p completions should be sorted with preSortCompletions().
   void addCompletionsWithFilter(ArrayRef<Completion *> completions,
                                 StringRef filterText, const FilterRules &rules,
-                                Completion *&exactMatch);
+                                Completion *&exactMatch,
+                                std::vector<Completion *> *matches = nullptr);
 
-  void groupAndSort(const Options &options);
+  /// Groups and sorts the results.
+  ///
+  /// If \p numResultsNeeded is not zero, only the first \p numResultsNeeded
+  /// top-level results are guaranteed to be in order.
+  void groupAndSort(const Options &options, unsigned numResultsNeeded = 0);
 
   /// Finishes the results and returns them.
   /// For convenience, this returns a shared_ptr, but it is uniquely referenced.
@@ -20,6 +20,7 @@
 #include "SourceKit/Support/Logging.h"
 #include "SourceKit/Support/Tracing.h"
 
+#include "swift/AST/ClangModuleLoader.h"
 #include "swift/Basic/Cache.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
@@ -29,6 +30,7 @@
 // This is included only for createLazyResolver(). Move to different header ?
 #include "swift/Sema/IDETypeChecking.h"
 
+#include "clang/AST/ASTContext.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -234,6 +236,9 @@ class ASTProducer : public ThreadSafeRefCountedBase<ASTProducer> {
   ThreadSafeRefCntPtr<ASTUnit> AST;
   SmallVector<std::pair<std::string, BufferStamp>, 8> DependencyStamps;
   std::vector<std::pair<SwiftASTConsumerRef, const void*>> QueuedConsumers;
+  /// Number of builds dispatched on the AST build queue that have not
+  /// started yet.
+  std::atomic<unsigned> PendingBuilds{ 0 };
   llvm::sys::Mutex Mtx;
 
 public:
@@ -257,19 +262,36 @@ public:
 
   size_t getMemoryCost() const {
     // FIXME: Report the memory cost of the overall CompilerInstance.
-    if (AST && AST->getCompilerInstance().hasASTContext())
-      return AST->Impl.CompInst.getASTContext().getTotalMemory();
+    if (AST && AST->getCompilerInstance().hasASTContext()) {
+      ASTContext &Ctx = AST->Impl.CompInst.getASTContext();
+      size_t Cost = Ctx.getTotalMemory();
+      // The imported Clang modules are owned by this AST as well, and are
+      // often larger than the Swift AST.
+      if (auto *ClangLoader = Ctx.getClangModuleLoader()) {
+        clang::ASTContext &ClangCtx = ClangLoader->getClangASTContext();
+        Cost += ClangCtx.getASTAllocatedMemory() +
+                ClangCtx.getSideTableAllocatedMemory();
+      }
+      return Cost;
+    }
     return sizeof(*this) + sizeof(*AST);
   }
 
 private:
   ASTUnitRef getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
                             ArrayRef<ImmutableTextSnapshotRef> Snapshots,
-                            std::string &Error);
+                            std::string &Error, bool &Cancelled);
 
   ASTUnitRef createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                            ArrayRef<ImmutableTextSnapshotRef> Snapshots,
-                           std::string &Error);
+                           std::string &Error, bool &Cancelled);
+
+  bool isSuperseded(SwiftASTManager::Implementation &MgrImpl,
+                    ArrayRef<FileContent> Contents);
+
+  bool inputsHaveSameText(SwiftASTManager::Implementation &MgrImpl,
+                          ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+                          ArrayRef<BufferStamp> InputStamps);
 };
 
 typedef IntrusiveRefCntPtr<ASTProducer> ASTProducerRef;
@@ -564,17 +586,33 @@ void ASTProducer::getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
   SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
   Snapshots.append(Snaps.begin(), Snaps.end());
 
-  MgrImpl.ASTBuildQueue.dispatch([ThisProducer, &MgrImpl, Snapshots, Receiver] {
+  auto QueuedTime = std::chrono::steady_clock::now();
+  ++PendingBuilds;
+  MgrImpl.ASTBuildQueue.dispatch([ThisProducer, &MgrImpl, Snapshots, Receiver,
+                                  QueuedTime] {
+    --ThisProducer->PendingBuilds;
+    auto Wait = std::chrono::steady_clock::now() - QueuedTime;
+    trace::recordASTQueueWait(
+        std::chrono::duration_cast<std::chrono::microseconds>(Wait).count());
+
     std::string Error;
-    ASTUnitRef Unit = ThisProducer->getASTUnitImpl(MgrImpl, Snapshots, Error);
+    bool Cancelled = false;
+    ASTUnitRef Unit = ThisProducer->getASTUnitImpl(MgrImpl, Snapshots, Error,
+                                                   Cancelled);
+    // A build queued after this one will hand its AST to the consumers that
+    // are still waiting.
+    if (Cancelled)
+      return;
     Receiver(Unit, Error);
   }, /*isStackDeep=*/true);
 }
 
 ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
                                    ArrayRef<ImmutableTextSnapshotRef> Snapshots,
-                                   std::string &Error) {
-  if (!AST || shouldRebuild(MgrImpl, Snapshots)) {
+                                   std::string &Error, bool &Cancelled) {
+  bool NeedsBuild = !AST || shouldRebuild(MgrImpl, Snapshots);
+  trace::recordASTRequest(/*CacheHit=*/!NeedsBuild);
+  if (NeedsBuild) {
     bool IsRebuild = AST != nullptr;
     const InvocationOptions &Opts = InvokRef->Impl.Opts;
 
@@ -588,7 +626,7 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
       Log->getOS() << Opts.Invok.getModuleName() << '/' << Opts.PrimaryFile;
     }
 
-    auto NewAST = createASTUnit(MgrImpl, Snapshots, Error);
+    auto NewAST = createASTUnit(MgrImpl, Snapshots, Error, Cancelled);
     {
       // FIXME: ThreadSafeRefCntPtr is racy.
       llvm::sys::ScopedLock L(Mtx);
@@ -652,8 +690,14 @@ bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
       InputStamps.push_back(MgrImpl.getBufferStamp(File));
   }
   assert(InputStamps.size() == Invok.Opts.Invok.getInputFilenames().size());
-  if (Stamps != InputStamps)
-    return true;
+  if (Stamps != InputStamps) {
+    // An edit may have been undone, or a file saved without changes. Keep
+    // the AST if the text it was built from is still the same.
+    if (!inputsHaveSameText(MgrImpl, Snapshots, InputStamps))
+      return true;
+    LOG_INFO_FUNC(High, "reusing AST, input text unchanged");
+    Stamps.assign(InputStamps.begin(), InputStamps.end());
+  }
 
   for (auto &Dependency : DependencyStamps) {
     if (Dependency.second != MgrImpl.getBufferStamp(Dependency.first))
@@ -663,6 +707,45 @@ bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
   return false;
 }
 
+/// Returns true if the inputs whose stamps changed still have the text that
+/// the current AST was built from.
+bool ASTProducer::inputsHaveSameText(
+    SwiftASTManager::Implementation &MgrImpl,
+    ArrayRef<ImmutableTextSnapshotRef> Snapshots,
+    ArrayRef<BufferStamp> InputStamps) {
+  const SwiftInvocation::Implementation &Invok = InvokRef->Impl;
+  ArrayRef<std::string> Filenames = Invok.Opts.Invok.getInputFilenames();
+  CompilerInstance &CompIns = AST->getCompilerInstance();
+  ArrayRef<unsigned> BufferIDs = CompIns.getInputBufferIDs();
+  if (BufferIDs.size() != Filenames.size() ||
+      Stamps.size() != Filenames.size())
+    return false;
+
+  SourceManager &SM = CompIns.getSourceMgr();
+  for (unsigned I = 0, E = Filenames.size(); I != E; ++I) {
+    if (Stamps[I] == InputStamps[I])
+      continue;
+    StringRef OldText = SM.extractText(SM.getRangeForBuffer(BufferIDs[I]));
+
+    const std::string &File = Filenames[I];
+    auto SnapIt = std::find_if(Snapshots.begin(), Snapshots.end(),
+        [&](const ImmutableTextSnapshotRef &Snap) {
+          return Snap->getFilename() == File;
+        });
+    if (SnapIt != Snapshots.end()) {
+      if ((*SnapIt)->getBuffer()->getText() != OldText)
+        return false;
+      continue;
+    }
+
+    std::string Error;
+    FileContent Content = MgrImpl.getFileContent(File, Error);
+    if (!Content.Buffer || Content.Buffer->getBuffer() != OldText)
+      return false;
+  }
+  return true;
+}
+
 static void collectModuleDependencies(Module *TopMod,
     llvm::SmallPtrSetImpl<Module *> &Visited,
     SmallVectorImpl<std::string> &Filenames) {
@@ -714,9 +797,26 @@ static void collectModuleDependencies(Module *TopMod,
 
 static std::atomic<uint64_t> ASTUnitGeneration{ 0 };
 
+bool ASTProducer::isSuperseded(SwiftASTManager::Implementation &MgrImpl,
+                               ArrayRef<FileContent> Contents) {
+  // Without another build in the queue nobody would pick up the consumers
+  // waiting on this one.
+  if (PendingBuilds == 0)
+    return false;
+
+  for (auto &Content : Contents) {
+    if (!Content.Snapshot)
+      continue;
+    StringRef Filename = Content.Snapshot->getFilename();
+    if (MgrImpl.getBufferStamp(Filename) != Content.Stamp)
+      return true;
+  }
+  return false;
+}
+
 ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
                                       ArrayRef<ImmutableTextSnapshotRef> Snapshots,
-                                      std::string &Error) {
+                                      std::string &Error, bool &Cancelled) {
   Stamps.clear();
   DependencyStamps.clear();
 
@@ -785,15 +885,31 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
     return nullptr;
   }
 
-  trace::TracedOperation TracedOp;
-  if (trace::enabled()) {
-    TracedOp.start(trace::OperationKind::PerformSema, TraceInfo);
+  trace::TracedOperation TracedOp(trace::OperationKind::PerformSema);
+  if (TracedOp.enabled()) {
+    TracedOp.start(TraceInfo);
   }
 
   CloseClangModuleFiles scopedCloseFiles(
       *CompIns.getASTContext().getClangModuleLoader());
   Consumer.setInputBufferIDs(ASTRef->getCompilerInstance().getInputBufferIDs());
+
+  // Stop type-checking function bodies once the user has edited one of the
+  // documents again and a build for the new text is already queued.
+  ASTContext &Ctx = CompIns.getASTContext();
+  Ctx.ShouldCancelTypeChecking = [&]() -> bool {
+    if (!Cancelled)
+      Cancelled = isSuperseded(MgrImpl, Contents);
+    return Cancelled;
+  };
   CompIns.performSema();
+  Ctx.ShouldCancelTypeChecking = nullptr;
+
+  if (Cancelled) {
+    LOG_INFO_FUNC(High, "AST build superseded by a newer edit");
+    Error = "AST build cancelled";
+    return nullptr;
+  }
 
   llvm::SmallPtrSet<Module *, 16> Visited;
   SmallVector<std::string, 8> Filenames;
@@ -110,8 +110,8 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
                                   ArrayRef<const char *> Args,
                                   std::string &Error) {
 
-  trace::TracedOperation TracedOp;
-  if (trace::enabled()) {
+  trace::TracedOperation InitOp(trace::OperationKind::CodeCompletionInit);
+  if (InitOp.enabled()) {
     trace::SwiftInvocation SwiftArgs;
     trace::initTraceInfo(SwiftArgs,
                          UnresolvedInputFile->getBufferIdentifier(),
@@ -119,10 +119,10 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
     SwiftArgs.addFile(UnresolvedInputFile->getBufferIdentifier(),
                       UnresolvedInputFile->getBuffer());
 
-    TracedOp.start(trace::OperationKind::CodeCompletionInit, SwiftArgs,
-                   { std::make_pair("Offset", std::to_string(Offset)),
-                     std::make_pair("InputBufferSize",
-                                    std::to_string(UnresolvedInputFile->getBufferSize()))});
+    InitOp.start(SwiftArgs,
+                 { std::make_pair("Offset", std::to_string(Offset)),
+                   std::make_pair("InputBufferSize",
+                                  std::to_string(UnresolvedInputFile->getBufferSize()))});
   }
   
   // Resolve symlinks for the input file; we resolve them for the input files
@@ -184,9 +184,10 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
     return true;
   }
 
-  TracedOp.finish();
+  InitOp.finish();
 
-  if (trace::enabled()) {
+  trace::TracedOperation TracedOp(trace::OperationKind::CodeCompletion);
+  if (TracedOp.enabled()) {
     trace::SwiftInvocation SwiftArgs;
     trace::initTraceInfo(SwiftArgs, InputFile->getBufferIdentifier(), Args);
     trace::initTraceFiles(SwiftArgs, CI);
@@ -199,7 +200,7 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
                     }
                   });
 
-    TracedOp.start(trace::OperationKind::CodeCompletion, SwiftArgs,
+    TracedOp.start(SwiftArgs,
                    {std::make_pair("OriginalOffset", std::to_string(Offset)),
                     std::make_pair("Offset",
                       std::to_string(CodeCompletionOffset))});
@@ -693,6 +694,24 @@ ArrayRef<Completion *> CodeCompletion::SessionCache::getSortedCompletions() {
   llvm::sys::ScopedLock L(mtx);
   return sortedCompletions;
 }
+std::vector<Completion *>
+CodeCompletion::SessionCache::getCompletionsToFilter(StringRef filterText,
+                                                     bool fuzzy) {
+  llvm::sys::ScopedLock L(mtx);
+  // Both prefix and fuzzy matching only match a subset of the previous
+  // matches when characters are appended to the filter text.
+  if (!lastFilterText.empty() && fuzzy == lastFilterWasFuzzy &&
+      filterText.startswith_lower(lastFilterText))
+    return lastFilterMatches;
+  return sortedCompletions;
+}
+void CodeCompletion::SessionCache::setFilterMatches(
+    StringRef filterText, bool fuzzy, std::vector<Completion *> &&matches) {
+  llvm::sys::ScopedLock L(mtx);
+  lastFilterText = filterText;
+  lastFilterWasFuzzy = fuzzy;
+  lastFilterMatches = std::move(matches);
+}
 llvm::MemoryBuffer *CodeCompletion::SessionCache::getBuffer() {
   llvm::sys::ScopedLock L(mtx);
   return buffer.get();
@@ -1004,9 +1023,19 @@ static void transformAndForwardResults(
   bool hasEarlyInnerResults =
       session->getCompletionKind() == CompletionKind::PostfixExpr;
 
-  if (!hasEarlyInnerResults) {
+  if (!hasEarlyInnerResults && filterText.empty()) {
     organizer.addCompletionsWithFilter(session->getSortedCompletions(),
                                        filterText, rules, exactMatch);
+  } else if (!hasEarlyInnerResults) {
+    // Each keystroke usually appends to the filter text, so only filter the
+    // results that matched the previous request.
+    bool fuzzy = options.fuzzyMatching &&
+                 filterText.size() >= options.minFuzzyLength;
+    std::vector<Completion *> matches;
+    organizer.addCompletionsWithFilter(
+        session->getCompletionsToFilter(filterText, fuzzy), filterText, rules,
+        exactMatch, &matches);
+    session->setFilterMatches(filterText, fuzzy, std::move(matches));
   }
 
   if (hasEarlyInnerResults &&
@@ -1032,7 +1061,9 @@ static void transformAndForwardResults(
                                        CodeCompletion::FilterRules(), exactMatch);
   }
 
-  organizer.groupAndSort(options);
+  // Only the results that are returned need to be in order.
+  unsigned numResultsNeeded = maxResults ? resultOffset + maxResults : 0;
+  organizer.groupAndSort(options, numResultsNeeded);
 
   if ((options.addInnerResults || options.addInnerOperators) &&
       exactMatch && exactMatch->getKind() == Completion::Declaration) {
@@ -1091,7 +1122,7 @@ static void transformAndForwardResults(
     CodeCompletion::Options noGroupOpts = options;
     noGroupOpts.groupStems = false;
     noGroupOpts.groupOverloads = false;
-    organizer.groupAndSort(noGroupOpts);
+    organizer.groupAndSort(noGroupOpts, numResultsNeeded);
   }
 
   // Build the final results view.
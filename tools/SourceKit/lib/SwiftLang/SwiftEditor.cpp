@@ -485,13 +485,13 @@ public:
   void parse() {
     auto &P = Parser->getParser();
 
-    trace::TracedOperation TracedOp;
-    if (trace::enabled()) {
+    trace::TracedOperation TracedOp(trace::OperationKind::SimpleParse);
+    if (TracedOp.enabled()) {
       trace::SwiftInvocation Info;
       initArgsAndPrimaryFile(Info);
       auto Text = SM.getLLVMSourceMgr().getMemoryBuffer(BufferID)->getBuffer();
       Info.Files.push_back(std::make_pair(PrimaryFile, Text));
-      TracedOp.start(trace::OperationKind::SimpleParse, Info);
+      TracedOp.start(Info);
     }
 
     bool Done = false;
@@ -861,13 +861,13 @@ public:
     }
     unsigned BufferID = AstUnit->getPrimarySourceFile().getBufferID().getValue();
 
-    trace::TracedOperation TracedOp;
-    if (trace::enabled()) {
+    trace::TracedOperation TracedOp(trace::OperationKind::AnnotAndDiag);
+    if (TracedOp.enabled()) {
       trace::SwiftInvocation SwiftArgs;
       SemaInfoRef->getInvocation()->raw(SwiftArgs.Args.Args,
                                         SwiftArgs.Args.PrimaryFile);
       trace::initTraceFiles(SwiftArgs, CompIns);
-      TracedOp.start(trace::OperationKind::AnnotAndDiag, SwiftArgs);
+      TracedOp.start(SwiftArgs);
     }
 
     SemanticAnnotator Annotator(CompIns.getSourceMgr(), BufferID);
@@ -1233,15 +1233,24 @@ public:
 
     ++NestingLevel;
     SourceLoc StartLoc = Node.Range.getStart();
+    unsigned Offset = SrcManager.getLocOffsetInBuffer(StartLoc, BufferID);
+    // Note that the length can span multiple lines.
+    unsigned Length = Node.Range.getByteLength();
+
+    // Most nodes of a large file are outside of the affected range. Skip them
+    // before computing their line numbers, which requires scanning the
+    // buffer. The affected range starts at the first edited line, so these
+    // are the same conditions as the line-based ones below.
+    if (EditedLineRange.isValid() &&
+        (Offset + Length <= AffectedRange.first ||
+         Offset > AffectedRange.first + AffectedRange.second))
+      return true;
+
     auto StartLineAndColumn = SrcManager.getLineAndColumn(StartLoc);
     auto EndLineAndColumn = SrcManager.getLineAndColumn(Node.Range.getEnd());
     unsigned StartLine = StartLineAndColumn.first;
     unsigned EndLine = EndLineAndColumn.second > 1 ? EndLineAndColumn.first
                                                    : EndLineAndColumn.first - 1;
-    unsigned Offset = SrcManager.getByteDistance(
-                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
-    // Note that the length can span multiple lines.
-    unsigned Length = Node.Range.getByteLength();
 
     SwiftSyntaxToken Token(StartLineAndColumn.second, Length,
                            Node.Kind);
@@ -1301,26 +1310,24 @@ public:
       SyntaxMap.addTokenForLine(StartLine, Token);
 
     // Add consumer entry.
-    unsigned ByteOffset = SrcManager.getLocOffsetInBuffer(Node.Range.getStart(),
-                                                          BufferID);
     UIdent Kind = SwiftLangSupport::getUIDForSyntaxNodeKind(Node.Kind);
     if (NestingLevel > 1) {
       assert(!ConsumerSyntaxMap.empty());
       auto &Last = ConsumerSyntaxMap.back();
-      mergeSplitRanges(Last.Offset, Last.Length, ByteOffset, Length,
+      mergeSplitRanges(Last.Offset, Last.Length, Offset, Length,
                        [&](unsigned BeforeOff, unsigned BeforeLen,
                            unsigned AfterOff, unsigned AfterLen) {
         auto LastKind = Last.Kind;
         ConsumerSyntaxMap.pop_back();
         if (BeforeLen)
           ConsumerSyntaxMap.emplace_back(BeforeOff, BeforeLen, LastKind);
-        ConsumerSyntaxMap.emplace_back(ByteOffset, Length, Kind);
+        ConsumerSyntaxMap.emplace_back(Offset, Length, Kind);
         if (AfterLen)
           ConsumerSyntaxMap.emplace_back(AfterOff, AfterLen, LastKind);
       });
     }
     else
-      ConsumerSyntaxMap.emplace_back(ByteOffset, Length, Kind);
+      ConsumerSyntaxMap.emplace_back(Offset, Length, Kind);
 
     return true;
   }
@@ -1686,11 +1693,11 @@ void SwiftEditorDocument::parse(ImmutableTextSnapshotRef Snapshot,
 void SwiftEditorDocument::readSyntaxInfo(EditorConsumer &Consumer) {
   llvm::sys::ScopedLock L(Impl.AccessMtx);
 
-  trace::TracedOperation TracedOp;
-  if (trace::enabled()) {
+  trace::TracedOperation TracedOp(trace::OperationKind::ReadSyntaxInfo);
+  if (TracedOp.enabled()) {
     trace::SwiftInvocation Info;
     Impl.buildSwiftInv(Info);
-    TracedOp.start(trace::OperationKind::ReadSyntaxInfo, Info);
+    TracedOp.start(Info);
   }
 
   Impl.ParserDiagnostics = Impl.SyntaxInfo->getDiagnostics();
@@ -1712,11 +1719,11 @@ void SwiftEditorDocument::readSyntaxInfo(EditorConsumer &Consumer) {
 
 void SwiftEditorDocument::readSemanticInfo(ImmutableTextSnapshotRef Snapshot,
                                            EditorConsumer& Consumer) {
-  trace::TracedOperation TracedOp;
-  if (trace::enabled()) {
+  trace::TracedOperation TracedOp(trace::OperationKind::ReadSemanticInfo);
+  if (TracedOp.enabled()) {
     trace::SwiftInvocation Info;
     Impl.buildSwiftInv(Info);
-    TracedOp.start(trace::OperationKind::ReadSemanticInfo, Info);
+    TracedOp.start(Info);
   }
 
   std::vector<SwiftSemanticToken> SemaToks;
@@ -1777,8 +1784,8 @@ void SwiftEditorDocument::formatText(unsigned Line, unsigned Length,
   SourceManager &SM = SyntaxInfo->getSourceManager();
   unsigned BufID = SyntaxInfo->getBufferID();
 
-  trace::TracedOperation TracedOp;
-  if (trace::enabled()) {
+  trace::TracedOperation TracedOp(trace::OperationKind::FormatText);
+  if (TracedOp.enabled()) {
     trace::SwiftInvocation SwiftArgs;
     // Compiler arguments do not matter
     auto Buf = SM.getLLVMSourceMgr().getMemoryBuffer(BufID);
@@ -1793,7 +1800,7 @@ void SwiftEditorDocument::formatText(unsigned Line, unsigned Length,
                      std::to_string(Impl.FormatOptions.TabWidth)),
       std::make_pair("UseTabs",
                      std::to_string(Impl.FormatOptions.UseTabs))};
-    TracedOp.start(trace::OperationKind::FormatText, SwiftArgs, OpArgs);
+    TracedOp.start(SwiftArgs, OpArgs);
   }
 
   LineRange inputRange = LineRange(Line, Length);
@@ -1827,8 +1834,8 @@ void SwiftEditorDocument::expandPlaceholder(unsigned Offset, unsigned Length,
     return;
   }
 
-  trace::TracedOperation TracedOp;
-  if (trace::enabled()) {
+  trace::TracedOperation TracedOp(trace::OperationKind::ExpandPlaceholder);
+  if (TracedOp.enabled()) {
     trace::SwiftInvocation SwiftArgs;
     SyntaxInfo->initArgsAndPrimaryFile(SwiftArgs);
     auto Buf = SM.getLLVMSourceMgr().getMemoryBuffer(BufID);
@@ -1836,7 +1843,7 @@ void SwiftEditorDocument::expandPlaceholder(unsigned Offset, unsigned Length,
     trace::StringPairs OpArgs = {
       std::make_pair("Offset", std::to_string(Offset)),
       std::make_pair("Length", std::to_string(Length))};
-    TracedOp.start(trace::OperationKind::ExpandPlaceholder, SwiftArgs, OpArgs);
+    TracedOp.start(SwiftArgs, OpArgs);
   }
 
   PlaceholderExpansionScanner Scanner(SM);
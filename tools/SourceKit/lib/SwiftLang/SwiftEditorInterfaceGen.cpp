@@ -16,6 +16,7 @@
 
 #include "swift/AST/ASTPrinter.h"
 #include "swift/AST/ASTWalker.h"
+#include "swift/AST/ClangModuleLoader.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/IDE/ModuleInterfacePrinting.h"
@@ -23,6 +24,8 @@
 #include "swift/IDE/Utils.h"
 #include "swift/Strings.h"
 
+#include "clang/AST/ASTContext.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ConvertUTF.h"
 
@@ -67,9 +70,14 @@ public:
     llvm::StringMap<TextDecl> USRMap;
   };
 
+  struct FileStamp {
+    std::string Path;
+    uint64_t ModTime;
+    uint64_t Size;
+  };
+
   // Hold an AstUnit so that the Decl* we have are always valid.
   ASTUnitRef AstUnit;
-  std::string DocumentName;
   bool IsModule = false;
   std::string ModuleOrHeaderName;
   CompilerInvocation Invocation;
@@ -79,12 +87,15 @@ public:
   SourceTextInfo Info;
   // This is the non-typechecked AST for the generated interface source.
   CompilerInstance TextCI;
+  // The files of the module the interface was printed from.
+  std::vector<FileStamp> ModuleFileStamps;
 };
 
 typedef SwiftInterfaceGenContext::Implementation::TextRange TextRange;
 typedef SwiftInterfaceGenContext::Implementation::TextReference TextReference;
 typedef SwiftInterfaceGenContext::Implementation::TextDecl TextDecl;
 typedef SwiftInterfaceGenContext::Implementation::SourceTextInfo SourceTextInfo;
+typedef SwiftInterfaceGenContext::Implementation::FileStamp FileStamp;
 
 static Module *getModuleByFullName(ASTContext &Ctx, StringRef ModuleName) {
   SmallVector<std::pair<Identifier, SourceLoc>, 4>
@@ -270,6 +281,28 @@ static void reportSemanticAnnotations(const SourceTextInfo &IFaceInfo,
   }
 }
 
+static bool getFileStamp(StringRef Path, FileStamp &Stamp) {
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(Path, Status))
+    return true;
+  Stamp.Path = Path;
+  Stamp.ModTime = Status.getLastModificationTime().toEpochTime();
+  Stamp.Size = Status.getSize();
+  return false;
+}
+
+static void collectModuleFileStamps(Module *Mod,
+                                    std::vector<FileStamp> &Stamps) {
+  for (auto *File : Mod->getFiles()) {
+    auto *LF = dyn_cast<LoadedFile>(File);
+    if (!LF)
+      continue;
+    FileStamp Stamp;
+    if (!getFileStamp(LF->getFilename(), Stamp))
+      Stamps.push_back(std::move(Stamp));
+  }
+}
+
 static bool getModuleInterfaceInfo(ASTContext &Ctx,
                                    StringRef ModuleName,
                                    Optional<StringRef> Group,
@@ -327,6 +360,7 @@ static bool getModuleInterfaceInfo(ASTContext &Ctx,
                           Group.hasValue() && SynthesizedExtensions);
 
   Info.Text = OS.str();
+  collectModuleFileStamps(Mod, Impl.ModuleFileStamps);
   return false;
 }
 
@@ -355,8 +389,9 @@ SwiftInterfaceGenContext::createForSwiftSource(StringRef DocumentName,
                                                StringRef SourceFileName,
                                                ASTUnitRef AstUnit,
                                                std::string &ErrMsg) {
-  SwiftInterfaceGenContextRef IFaceGenCtx{ new SwiftInterfaceGenContext() };
-  IFaceGenCtx->Impl.DocumentName = DocumentName;
+  SwiftInterfaceGenContextRef IFaceGenCtx{
+    new SwiftInterfaceGenContext(std::make_shared<Implementation>()) };
+  IFaceGenCtx->DocumentName = DocumentName;
   IFaceGenCtx->Impl.IsModule = true;
   IFaceGenCtx->Impl.ModuleOrHeaderName = SourceFileName;
   IFaceGenCtx->Impl.AstUnit = AstUnit;
@@ -383,8 +418,9 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
                                  std::string &ErrMsg,
                                  bool SynthesizedExtensions,
                                  Optional<StringRef> InterestedUSR) {
-  SwiftInterfaceGenContextRef IFaceGenCtx{ new SwiftInterfaceGenContext() };
-  IFaceGenCtx->Impl.DocumentName = DocumentName;
+  SwiftInterfaceGenContextRef IFaceGenCtx{
+    new SwiftInterfaceGenContext(std::make_shared<Implementation>()) };
+  IFaceGenCtx->DocumentName = DocumentName;
   IFaceGenCtx->Impl.IsModule = IsModule;
   IFaceGenCtx->Impl.ModuleOrHeaderName = ModuleOrHeaderName;
   IFaceGenCtx->Impl.Invocation = Invocation;
@@ -438,15 +474,23 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
   return IFaceGenCtx;
 }
 
-SwiftInterfaceGenContext::SwiftInterfaceGenContext()
-  : Impl(*new Implementation) {
+SwiftInterfaceGenContextRef
+SwiftInterfaceGenContext::createSharing(StringRef DocumentName,
+                                        SwiftInterfaceGenContextRef Generated) {
+  SwiftInterfaceGenContextRef IFaceGenCtx{
+    new SwiftInterfaceGenContext(Generated->SharedImpl) };
+  IFaceGenCtx->DocumentName = DocumentName;
+  return IFaceGenCtx;
 }
-SwiftInterfaceGenContext::~SwiftInterfaceGenContext() {
-  delete &Impl;
+
+SwiftInterfaceGenContext::SwiftInterfaceGenContext(
+    std::shared_ptr<Implementation> Impl)
+  : SharedImpl(std::move(Impl)), Impl(*SharedImpl) {
 }
+SwiftInterfaceGenContext::~SwiftInterfaceGenContext() = default;
 
 StringRef SwiftInterfaceGenContext::getDocumentName() const {
-  return Impl.DocumentName;
+  return DocumentName;
 }
 
 StringRef SwiftInterfaceGenContext::getModuleOrHeaderName() const {
@@ -490,6 +534,34 @@ bool SwiftInterfaceGenContext::matches(StringRef ModuleName,
   return true;
 }
 
+bool SwiftInterfaceGenContext::isUpToDate() const {
+  for (auto &Stamp : Impl.ModuleFileStamps) {
+    FileStamp Current;
+    if (getFileStamp(Stamp.Path, Current))
+      return false;
+    if (Current.ModTime != Stamp.ModTime || Current.Size != Stamp.Size)
+      return false;
+  }
+  return true;
+}
+
+size_t SwiftInterfaceGenContext::getMemoryCost() const {
+  size_t Cost = sizeof(Impl) + Impl.Info.Text.size();
+  if (Impl.TextCI.hasASTContext())
+    Cost += Impl.TextCI.getASTContext().getTotalMemory();
+  if (Impl.Instance.hasASTContext()) {
+    ASTContext &Ctx = Impl.Instance.getASTContext();
+    Cost += Ctx.getTotalMemory();
+    // The imported Clang modules are only used by this interface.
+    if (auto *ClangLoader = Ctx.getClangModuleLoader()) {
+      clang::ASTContext &ClangCtx = ClangLoader->getClangASTContext();
+      Cost += ClangCtx.getASTAllocatedMemory() +
+              ClangCtx.getSideTableAllocatedMemory();
+    }
+  }
+  return Cost;
+}
+
 void SwiftInterfaceGenContext::reportEditorInfo(EditorConsumer &Consumer) const {
   Consumer.handleSourceText(Impl.Info.Text);
   reportSyntacticAnnotations(Impl.TextCI, Consumer);
@@ -586,6 +658,39 @@ SwiftInterfaceGenMap::find(StringRef ModuleName,
 // EditorOpenInterface
 //===----------------------------------------------------------------------===//
 
+/// Returns the key identifying the printed interface of \p ModuleName, or an
+/// empty string if the printed text cannot be determined up front.
+static std::string getInterfaceCacheKey(StringRef ModuleName,
+                                        Optional<StringRef> Group,
+                                        bool SynthesizedExtensions,
+                                        Optional<StringRef> InterestedUSR,
+                                        const CompilerInvocation &Invok) {
+  // The group is looked up from the USR after the module is loaded.
+  if (!Group && InterestedUSR)
+    return std::string();
+
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  auto add = [&](StringRef Str) { OS << Str << '\0'; };
+  add(ModuleName);
+  add(Group ? *Group : "<all>");
+  add(Group && SynthesizedExtensions ? "synthesized" : "");
+  add(Invok.getTargetTriple());
+  add(Invok.getSDKPath());
+  const SearchPathOptions &SPOpts = Invok.getSearchPathOptions();
+  for (auto &Path : SPOpts.ImportSearchPaths)
+    add(Path);
+  add("<frameworks>");
+  for (auto &Path : SPOpts.FrameworkSearchPaths)
+    add(Path);
+  add("<clang>");
+  const ClangImporterOptions &ClangOpts = Invok.getClangImporterOptions();
+  add(ClangOpts.ModuleCachePath);
+  for (auto &Arg : ClangOpts.ExtraArgs)
+    add(Arg);
+  return OS.str();
+}
+
 void SwiftLangSupport::editorOpenInterface(EditorConsumer &Consumer,
                                            StringRef Name,
                                            StringRef ModuleName,
@@ -606,31 +711,51 @@ void SwiftLangSupport::editorOpenInterface(EditorConsumer &Consumer,
     return;
   }
 
-  trace::TracedOperation TracedOp;
-  if (trace::enabled()) {
+  trace::TracedOperation TracedOp(trace::OperationKind::OpenInterface);
+  if (TracedOp.enabled()) {
     trace::SwiftInvocation SwiftArgs;
     SwiftArgs.Args.Args.assign(Args.begin(), Args.end());
     // NOTE: do not use primary file
     // NOTE: do not use files
-    TracedOp.start(trace::OperationKind::OpenInterface, SwiftArgs,
+    TracedOp.start(SwiftArgs,
                    {std::make_pair("Name", Name),
                     std::make_pair("ModuleName", ModuleName)});
   }
 
   Invocation.getClangImporterOptions().ImportForwardDeclarations = true;
 
-  std::string ErrMsg;
-  auto IFaceGenRef = SwiftInterfaceGenContext::create(Name,
-                                                      /*IsModule=*/true,
-                                                      ModuleName,
-                                                      Group,
-                                                      Invocation,
-                                                      ErrMsg,
-                                                      SynthesizedExtensions,
-                                                      InterestedUSR);
+  // Printing a large module takes seconds; share the interface with an
+  // earlier request for the same module if the module was not rebuilt since.
+  std::string CacheKey = getInterfaceCacheKey(ModuleName, Group,
+                                              SynthesizedExtensions,
+                                              InterestedUSR, Invocation);
+  SwiftInterfaceGenContextRef IFaceGenRef;
+  if (!CacheKey.empty()) {
+    if (auto Cached = IFaceGenCache.get(CacheKey)) {
+      if (Cached.getValue()->isUpToDate())
+        IFaceGenRef = SwiftInterfaceGenContext::createSharing(Name,
+                                                              *Cached);
+      else
+        IFaceGenCache.remove(CacheKey);
+    }
+  }
+
   if (!IFaceGenRef) {
-    Consumer.handleRequestError(ErrMsg.c_str());
-    return;
+    std::string ErrMsg;
+    IFaceGenRef = SwiftInterfaceGenContext::create(Name,
+                                                   /*IsModule=*/true,
+                                                   ModuleName,
+                                                   Group,
+                                                   Invocation,
+                                                   ErrMsg,
+                                                   SynthesizedExtensions,
+                                                   InterestedUSR);
+    if (!IFaceGenRef) {
+      Consumer.handleRequestError(ErrMsg.c_str());
+      return;
+    }
+    if (!CacheKey.empty())
+      IFaceGenCache.set(CacheKey, IFaceGenRef);
   }
 
   IFaceGenContexts.set(Name, IFaceGenRef);
@@ -676,13 +801,13 @@ void SwiftLangSupport::editorOpenSwiftSourceInterface(StringRef Name,
     Consumer->handleRequestError(Error.c_str());
     return;
   }
-  trace::TracedOperation TracedOp;
-  if (trace::enabled()) {
+  trace::TracedOperation TracedOp(trace::OperationKind::OpenInterface);
+  if (TracedOp.enabled()) {
     trace::SwiftInvocation SwiftArgs;
     SwiftArgs.Args.Args.assign(Args.begin(), Args.end());
     // NOTE: do not use primary file
     // NOTE: do not use files
-    TracedOp.start(trace::OperationKind::OpenInterface, SwiftArgs,
+    TracedOp.start(SwiftArgs,
                    {std::make_pair("Name", Name),
                      std::make_pair("SourceName", SourceName)});
   }
@@ -715,13 +840,13 @@ void SwiftLangSupport::editorOpenHeaderInterface(EditorConsumer &Consumer,
     return;
   }
 
-  trace::TracedOperation TracedOp;
-  if (trace::enabled()) {
+  trace::TracedOperation TracedOp(trace::OperationKind::OpenHeaderInterface);
+  if (TracedOp.enabled()) {
     trace::SwiftInvocation SwiftArgs;
     SwiftArgs.Args.Args.assign(Args.begin(), Args.end());
     // NOTE: do not use primary file
     // NOTE: do not use files
-    TracedOp.start(trace::OperationKind::OpenHeaderInterface, SwiftArgs,
+    TracedOp.start(SwiftArgs,
                    {std::make_pair("Name", Name),
                     std::make_pair("HeaderName", HeaderName)});
   }
@@ -123,8 +123,8 @@ static void indexModule(llvm::MemoryBuffer *Input,
                         IndexingConsumer &IdxConsumer,
                         CompilerInstance &CI,
                         ArrayRef<const char *> Args) {
-  trace::TracedOperation TracedOp;
-  if (trace::enabled()) {
+  trace::TracedOperation TracedOp(trace::OperationKind::IndexModule);
+  if (TracedOp.enabled()) {
     trace::SwiftInvocation SwiftArgs;
     SwiftArgs.Args.Args.assign(Args.begin(), Args.end());
     SwiftArgs.Args.PrimaryFile = Input->getBufferIdentifier();
@@ -132,7 +132,7 @@ static void indexModule(llvm::MemoryBuffer *Input,
     trace::StringPairs OpArgs;
     OpArgs.push_back(std::make_pair("ModuleName", ModuleName));
     OpArgs.push_back(std::make_pair("Hash", Hash));
-    TracedOp.start(trace::OperationKind::IndexModule, SwiftArgs, OpArgs);
+    TracedOp.start(SwiftArgs, OpArgs);
   }
 
   ASTContext &Ctx = CI.getASTContext();
@@ -246,12 +246,12 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
   if (CI.setup(Invocation))
     return;
 
-  trace::TracedOperation TracedOp;
-  if (trace::enabled()) {
+  trace::TracedOperation TracedOp(trace::OperationKind::IndexSource);
+  if (TracedOp.enabled()) {
     trace::SwiftInvocation SwiftArgs;
     trace::initTraceInfo(SwiftArgs, InputFile, Args);
     trace::initTraceFiles(SwiftArgs, CI);
-    TracedOp.start(trace::OperationKind::IndexSource, SwiftArgs);
+    TracedOp.start(SwiftArgs);
   }
 
   CI.performSema();
@@ -269,3 +269,27 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
   SKIndexDataConsumer IdxDataConsumer(IdxConsumer);
   index::indexSourceFile(CI.getPrimarySourceFile(), Hash, IdxDataConsumer);
 }
+
+void SwiftLangSupport::indexSources(ArrayRef<std::string> Filenames,
+                                    ArrayRef<IndexingConsumer *> Consumers,
+                                    ArrayRef<const char *> Args,
+                                    std::function<bool()> IsCancelled) {
+  assert(Filenames.size() == Consumers.size());
+
+  // Every file gets its own CompilerInstance, so they can be indexed
+  // independently. The work items may refer to the arguments since we wait
+  // for all of them below.
+  WorkQueue Queue{ WorkQueue::Dequeuing::Concurrent,
+                   "sourcekit.swift.IndexSources" };
+  for (unsigned I = 0, E = Filenames.size(); I != E; ++I) {
+    Queue.dispatch([&, I] {
+      if (IsCancelled && IsCancelled()) {
+        Consumers[I]->failed("indexing cancelled");
+        return;
+      }
+      indexSource(Filenames[I], *Consumers[I], Args, /*Hash=*/StringRef());
+    }, /*isStackDeep=*/true);
+  }
+
+  Queue.dispatchBarrierSync([] {});
+}
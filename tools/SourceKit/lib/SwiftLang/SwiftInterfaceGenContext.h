@@ -16,6 +16,7 @@
 #include "SourceKit/Core/LLVM.h"
 #include "swift/AST/Module.h"
 #include "swift/Basic/ThreadSafeRefCounted.h"
+#include <memory>
 #include <string>
 
 namespace swift {
@@ -47,6 +48,11 @@ public:
                                                           ASTUnitRef AstUnit,
                                                           std::string &ErrMsg);
 
+  /// Creates a context for \p DocumentName that shares the generated
+  /// interface of \p Generated instead of printing it again.
+  static SwiftInterfaceGenContextRef
+  createSharing(StringRef DocumentName, SwiftInterfaceGenContextRef Generated);
+
   ~SwiftInterfaceGenContext();
 
   StringRef getDocumentName() const;
@@ -55,6 +61,12 @@ public:
 
   bool matches(StringRef ModuleName, const swift::CompilerInvocation &Invok);
 
+  /// Returns false if one of the files the interface was printed from was
+  /// modified since.
+  bool isUpToDate() const;
+
+  size_t getMemoryCost() const;
+
   void reportEditorInfo(EditorConsumer &Consumer) const;
 
   struct ResolvedEntity {
@@ -84,9 +96,11 @@ public:
   class Implementation;
 
 private:
+  std::string DocumentName;
+  std::shared_ptr<Implementation> SharedImpl;
   Implementation &Impl;
 
-  SwiftInterfaceGenContext();
+  explicit SwiftInterfaceGenContext(std::shared_ptr<Implementation> Impl);
 };
 
 } // namespace SourceKit.
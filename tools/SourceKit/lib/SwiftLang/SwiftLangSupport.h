@@ -19,6 +19,7 @@
 #include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/ThreadSafeRefCntPtr.h"
 #include "SourceKit/Support/Tracing.h"
+#include "swift/Basic/Cache.h"
 #include "swift/Basic/ThreadSafeRefCounted.h"
 #include "swift/IDE/Formatting.h"
 #include "swift/Index/IndexSymbol.h"
@@ -48,6 +49,27 @@ namespace ide {
   enum class SyntaxStructureElementKind : uint8_t;
   class CodeCompletionConsumer;
 }
+
+namespace sys {
+
+template <>
+struct CacheKeyHashInfo<std::string> {
+  static uintptr_t getHashValue(const std::string &Key) {
+    return llvm::hash_value(llvm::StringRef(Key));
+  }
+  static bool isEqual(void *LHS, void *RHS) {
+    return *static_cast<std::string*>(LHS) == *static_cast<std::string*>(RHS);
+  }
+};
+
+template <>
+struct CacheValueCostInfo<SourceKit::SwiftInterfaceGenContext> {
+  static size_t getCost(const SourceKit::SwiftInterfaceGenContext &IFaceGen) {
+    return IFaceGen.getMemoryCost();
+  }
+};
+
+} // namespace sys
 }
 
 namespace SourceKit {
@@ -134,6 +156,11 @@ class SessionCache : public ThreadSafeRefCountedBase<SessionCache> {
   CompletionKind completionKind;
   bool completionHasExpectedTypes;
   FilterRules filterRules;
+  /// The filter text of a previous request, whether it was matched fuzzily,
+  /// and the sorted completions that matched it.
+  std::string lastFilterText;
+  bool lastFilterWasFuzzy = false;
+  std::vector<Completion *> lastFilterMatches;
   llvm::sys::Mutex mtx;
 
 public:
@@ -147,6 +174,14 @@ public:
         filterRules(std::move(filterRules)) {}
   void setSortedCompletions(std::vector<Completion *> &&completions);
   ArrayRef<Completion *> getSortedCompletions();
+  /// Returns the sorted completions that can match \p filterText.
+  ///
+  /// If \p filterText extends the filter text of a previous request that was
+  /// matched the same way, only the completions that matched it are returned.
+  std::vector<Completion *> getCompletionsToFilter(StringRef filterText,
+                                                   bool fuzzy);
+  void setFilterMatches(StringRef filterText, bool fuzzy,
+                        std::vector<Completion *> &&matches);
   llvm::MemoryBuffer *getBuffer();
   ArrayRef<std::string> getCompilerArgs();
   const FilterRules &getFilterRules();
@@ -209,6 +244,10 @@ class SwiftLangSupport : public LangSupport {
   std::unique_ptr<SwiftASTManager> ASTMgr;
   SwiftEditorDocumentFileMap EditorDocuments;
   SwiftInterfaceGenMap IFaceGenContexts;
+  /// Module interfaces printed recently, keyed by module name, printing
+  /// options and the search settings of the invocation.
+  swift::sys::Cache<std::string, SwiftInterfaceGenContextRef> IFaceGenCache{
+    "sourcekit.swift.InterfaceGenCache" };
   ThreadSafeRefCntPtr<SwiftCompletionCache> CCCache;
   ThreadSafeRefCntPtr<SwiftPopularAPI> PopularAPI;
   CodeCompletion::SessionCacheMap CCSessions;
@@ -293,6 +332,11 @@ public:
   void indexSource(StringRef Filename, IndexingConsumer &Consumer,
                    ArrayRef<const char *> Args, StringRef Hash) override;
 
+  void indexSources(ArrayRef<std::string> Filenames,
+                    ArrayRef<IndexingConsumer *> Consumers,
+                    ArrayRef<const char *> Args,
+                    std::function<bool()> IsCancelled) override;
+
   void codeComplete(llvm::MemoryBuffer *InputBuf, unsigned Offset,
                     SourceKit::CodeCompletionConsumer &Consumer,
                     ArrayRef<const char *> Args) override;
@@ -922,12 +922,13 @@ static void resolveCursor(SwiftLangSupport &Lang,
         return;
       }
 
-      trace::TracedOperation TracedOp;
-      if (trace::enabled()) {
+      trace::TracedOperation TracedOp(
+          trace::OperationKind::CursorInfoForSource);
+      if (TracedOp.enabled()) {
         trace::SwiftInvocation SwiftArgs;
         ASTInvok->raw(SwiftArgs.Args.Args, SwiftArgs.Args.PrimaryFile);
         trace::initTraceFiles(SwiftArgs, CompIns);
-        TracedOp.start(trace::OperationKind::CursorInfoForSource, SwiftArgs,
+        TracedOp.start(SwiftArgs,
                        {std::make_pair("Offset", std::to_string(Offset))});
       }
 
@@ -988,8 +989,9 @@ void SwiftLangSupport::getCursorInfo(
     std::function<void(const CursorInfo &)> Receiver) {
 
   if (auto IFaceGenRef = IFaceGenContexts.get(InputFile)) {
-    trace::TracedOperation TracedOp;
-    if (trace::enabled()) {
+    trace::TracedOperation TracedOp(
+        trace::OperationKind::CursorInfoForIFaceGen);
+    if (TracedOp.enabled()) {
       trace::SwiftInvocation SwiftArgs;
       trace::initTraceInfo(SwiftArgs, InputFile, Args);
       // Do we need to record any files? If yes -- which ones?
@@ -997,8 +999,7 @@ void SwiftLangSupport::getCursorInfo(
         std::make_pair("DocumentName", IFaceGenRef->getDocumentName()),
         std::make_pair("ModuleOrHeaderName", IFaceGenRef->getModuleOrHeaderName()),
         std::make_pair("Offset", std::to_string(Offset))};
-      TracedOp.start(trace::OperationKind::CursorInfoForIFaceGen,
-                     SwiftArgs, OpArgs);
+      TracedOp.start(SwiftArgs, OpArgs);
     }
 
     SwiftInterfaceGenContext::ResolvedEntity Entity;
@@ -1083,12 +1084,13 @@ resolveCursorFromUSR(SwiftLangSupport &Lang, StringRef InputFile, StringRef USR,
       unsigned BufferID =
           AstUnit->getPrimarySourceFile().getBufferID().getValue();
 
-      trace::TracedOperation TracedOp;
-      if (trace::enabled()) {
+      trace::TracedOperation TracedOp(
+          trace::OperationKind::CursorInfoForSource);
+      if (TracedOp.enabled()) {
         trace::SwiftInvocation SwiftArgs;
         ASTInvok->raw(SwiftArgs.Args.Args, SwiftArgs.Args.PrimaryFile);
         trace::initTraceFiles(SwiftArgs, CompIns);
-        TracedOp.start(trace::OperationKind::CursorInfoForSource, SwiftArgs,
+        TracedOp.start(SwiftArgs,
                        {std::make_pair("USR", USR)});
       }
 
@@ -1265,16 +1267,16 @@ void SwiftLangSupport::findRelatedIdentifiersInFile(
       auto &CompInst = AstUnit->getCompilerInstance();
       auto &SrcFile = AstUnit->getPrimarySourceFile();
 
-      trace::TracedOperation TracedOp;
+      trace::TracedOperation TracedOp(trace::OperationKind::RelatedIdents);
 
       SmallVector<std::pair<unsigned, unsigned>, 8> Ranges;
 
       auto Action = [&]() {
-        if (trace::enabled()) {
+        if (TracedOp.enabled()) {
           trace::SwiftInvocation SwiftArgs;
           Invok->raw(SwiftArgs.Args.Args, SwiftArgs.Args.PrimaryFile);
           trace::initTraceFiles(SwiftArgs, CompInst);
-          TracedOp.start(trace::OperationKind::RelatedIdents, SwiftArgs,
+          TracedOp.start(SwiftArgs,
                         {std::make_pair("Offset", std::to_string(Offset))});
         }
 
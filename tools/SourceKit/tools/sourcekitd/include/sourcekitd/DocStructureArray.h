@@ -0,0 +1,61 @@
+//===--- DocStructureArray.h - ----------------------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SOURCEKITD_DOCSTRUCTURE_ARRAY_H
+#define LLVM_SOURCEKITD_DOCSTRUCTURE_ARRAY_H
+
+#include "sourcekitd/Internal.h"
+
+namespace sourcekitd {
+
+VariantFunctions *getVariantFunctionsForDocStructureArray();
+
+/// Builds the 'key.substructure' tree of a document in a single buffer.
+///
+/// Every node is stored once in a flat array; the nested 'key.substructure',
+/// 'key.elements', 'key.inheritedtypes' and 'key.attributes' arrays are
+/// ranges into other flat arrays of the same buffer.
+class DocStructureArrayBuilder {
+public:
+  DocStructureArrayBuilder();
+  ~DocStructureArrayBuilder();
+
+  void beginSubStructure(unsigned Offset, unsigned Length,
+                         SourceKit::UIdent Kind,
+                         SourceKit::UIdent AccessLevel,
+                         SourceKit::UIdent SetterAccessLevel,
+                         unsigned NameOffset, unsigned NameLength,
+                         unsigned BodyOffset, unsigned BodyLength,
+                         llvm::StringRef DisplayName,
+                         llvm::StringRef TypeName,
+                         llvm::StringRef RuntimeName,
+                         llvm::StringRef SelectorName,
+                         llvm::ArrayRef<llvm::StringRef> InheritedTypes,
+                         llvm::ArrayRef<SourceKit::UIdent> Attrs);
+
+  void addElement(SourceKit::UIdent Kind, unsigned Offset, unsigned Length);
+
+  void endSubStructure();
+
+  /// Returns true if no top-level structure was added.
+  bool empty() const;
+
+  std::unique_ptr<llvm::MemoryBuffer> createBuffer();
+
+private:
+  struct Implementation;
+  Implementation &Impl;
+};
+
+}
+
+#endif
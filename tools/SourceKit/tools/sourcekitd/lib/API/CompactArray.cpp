@@ -55,6 +55,14 @@ void CompactArrayBuilderImpl::addImpl(Optional<llvm::StringRef> Val) {
   }
 }
 
+void CompactArrayBuilderImpl::addImpl(Optional<UIdent> Val) {
+  if (Val.hasValue()) {
+    addImpl(Val.getValue());
+  } else {
+    addScalar(sourcekitd_uid_t(nullptr), EntriesBuffer);
+  }
+}
+
 unsigned CompactArrayBuilderImpl::getOffsetForString(StringRef Str) {
   if (Str.empty())
     return 0;
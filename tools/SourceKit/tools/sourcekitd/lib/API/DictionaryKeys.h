@@ -118,6 +118,13 @@ extern SourceKit::UIdent KeyObsoleted;
 extern SourceKit::UIdent KeyRemoveCache;
 extern SourceKit::UIdent KeyTypeInterface;
 extern SourceKit::UIdent KeyModuleGroups;
+extern SourceKit::UIdent KeyCount;
+extern SourceKit::UIdent KeyLatencyP50;
+extern SourceKit::UIdent KeyLatencyP90;
+extern SourceKit::UIdent KeyLatencyP99;
+extern SourceKit::UIdent KeyLatencyMax;
+extern SourceKit::UIdent KeyASTBuilds;
+extern SourceKit::UIdent KeyASTCacheHits;
 
 /// \brief Used for determining the printing order of dictionary keys.
 bool compareDictKeys(SourceKit::UIdent LHS, SourceKit::UIdent RHS);
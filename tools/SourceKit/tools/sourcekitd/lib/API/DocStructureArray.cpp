@@ -0,0 +1,571 @@
+//===--- DocStructureArray.cpp --------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "sourcekitd/DocStructureArray.h"
+#include "sourcekitd/CompactArray.h"
+#include "SourceKit/Core/LLVM.h"
+#include "SourceKit/Support/UIdent.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <array>
+#include <tuple>
+
+#include "DictionaryKeys.h"
+
+using namespace SourceKit;
+using namespace sourcekitd;
+
+namespace {
+
+/// The flat arrays making up a DocStructureArray buffer. The buffer starts
+/// with the offset of each of them, as a uint64_t.
+enum class ArrayKind : unsigned {
+  /// One entry per node, in the order they were begun. Entry 0 is the
+  /// document itself.
+  Structures,
+  /// The elements and substructure ranges of each node.
+  NodeRanges,
+  Elements,
+  InheritedTypes,
+  Attributes,
+  /// Indices into Structures; the children of a node are contiguous.
+  SubStructures,
+  Count
+};
+
+} // end anonymous namespace
+
+struct DocStructureArrayBuilder::Implementation {
+  typedef CompactArrayBuilder<Optional<UIdent>,     // Kind
+                              unsigned,             // Offset
+                              unsigned,             // Length
+                              Optional<UIdent>,     // AccessLevel
+                              Optional<UIdent>,     // SetterAccessLevel
+                              unsigned,             // NameOffset
+                              unsigned,             // NameLength
+                              unsigned,             // BodyOffset
+                              unsigned,             // BodyLength
+                              Optional<StringRef>,  // DisplayName
+                              Optional<StringRef>,  // TypeName
+                              Optional<StringRef>,  // RuntimeName
+                              Optional<StringRef>,  // SelectorName
+                              unsigned,             // InheritedTypesStart
+                              unsigned,             // NumInheritedTypes
+                              unsigned,             // AttributesStart
+                              unsigned>             // NumAttributes
+      StructureArrayBuilderTy;
+
+  /// A node which has been begun but not ended yet. Its elements and children
+  /// are collected here so that they end up contiguous in the buffer.
+  struct OpenNode {
+    unsigned Index;
+    SmallVector<unsigned, 8> SubStructures;
+    SmallVector<std::tuple<UIdent, unsigned, unsigned>, 4> Elements;
+
+    explicit OpenNode(unsigned Index) : Index(Index) {}
+  };
+
+  StructureArrayBuilderTy Structures;
+  CompactArrayBuilder<UIdent, unsigned, unsigned> Elements;
+  CompactArrayBuilder<StringRef> InheritedTypes;
+  CompactArrayBuilder<UIdent> Attributes;
+  CompactArrayBuilder<unsigned> SubStructures;
+
+  unsigned NumElements = 0;
+  unsigned NumInheritedTypes = 0;
+  unsigned NumAttributes = 0;
+  unsigned NumSubStructures = 0;
+
+  /// ElementsStart, NumElements, SubStructuresStart and NumSubStructures of
+  /// every node, filled in when the node is closed.
+  std::vector<std::array<unsigned, 4>> NodeRanges;
+  SmallVector<OpenNode, 8> Stack;
+
+  Implementation() {
+    // The document itself.
+    Structures.addEntry(None, 0, 0, None, None, 0, 0, 0, 0,
+                        None, None, None, None, 0, 0, 0, 0);
+    NodeRanges.push_back({{ 0, 0, 0, 0 }});
+    Stack.push_back(OpenNode(0));
+  }
+
+  void close(const OpenNode &Node) {
+    NodeRanges[Node.Index] = {{ NumElements, unsigned(Node.Elements.size()),
+                                NumSubStructures,
+                                unsigned(Node.SubStructures.size()) }};
+    for (auto &Elem : Node.Elements)
+      Elements.addEntry(std::get<0>(Elem), std::get<1>(Elem),
+                        std::get<2>(Elem));
+    NumElements += Node.Elements.size();
+    for (unsigned Child : Node.SubStructures)
+      SubStructures.addEntry(Child);
+    NumSubStructures += Node.SubStructures.size();
+  }
+};
+
+DocStructureArrayBuilder::DocStructureArrayBuilder()
+  : Impl(*new Implementation()) {
+
+}
+
+DocStructureArrayBuilder::~DocStructureArrayBuilder() {
+  delete &Impl;
+}
+
+static Optional<StringRef> getOptionalString(StringRef Str) {
+  if (Str.empty())
+    return None;
+  return Str;
+}
+
+static Optional<UIdent> getOptionalUID(UIdent UID) {
+  if (!UID.isValid())
+    return None;
+  return UID;
+}
+
+void DocStructureArrayBuilder::beginSubStructure(
+    unsigned Offset, unsigned Length, UIdent Kind, UIdent AccessLevel,
+    UIdent SetterAccessLevel, unsigned NameOffset, unsigned NameLength,
+    unsigned BodyOffset, unsigned BodyLength, StringRef DisplayName,
+    StringRef TypeName, StringRef RuntimeName, StringRef SelectorName,
+    ArrayRef<StringRef> InheritedTypes, ArrayRef<UIdent> Attrs) {
+  unsigned Index = Impl.NodeRanges.size();
+  Impl.NodeRanges.push_back({{ 0, 0, 0, 0 }});
+  Impl.Stack.back().SubStructures.push_back(Index);
+
+  Impl.Structures.addEntry(Kind, Offset, Length,
+                           getOptionalUID(AccessLevel),
+                           getOptionalUID(SetterAccessLevel),
+                           NameOffset, NameLength, BodyOffset, BodyLength,
+                           getOptionalString(DisplayName),
+                           getOptionalString(TypeName),
+                           getOptionalString(RuntimeName),
+                           getOptionalString(SelectorName),
+                           Impl.NumInheritedTypes, InheritedTypes.size(),
+                           Impl.NumAttributes, Attrs.size());
+
+  for (StringRef TypeName : InheritedTypes)
+    Impl.InheritedTypes.addEntry(TypeName);
+  Impl.NumInheritedTypes += InheritedTypes.size();
+  for (UIdent Attr : Attrs)
+    Impl.Attributes.addEntry(Attr);
+  Impl.NumAttributes += Attrs.size();
+
+  Impl.Stack.push_back(Implementation::OpenNode(Index));
+}
+
+void DocStructureArrayBuilder::addElement(UIdent Kind, unsigned Offset,
+                                          unsigned Length) {
+  assert(Impl.Stack.size() > 1 && "elements belong to a substructure");
+  Impl.Stack.back().Elements.push_back(std::make_tuple(Kind, Offset, Length));
+}
+
+void DocStructureArrayBuilder::endSubStructure() {
+  assert(Impl.Stack.size() > 1 && "unbalanced endSubStructure");
+  Impl.close(Impl.Stack.back());
+  Impl.Stack.pop_back();
+}
+
+bool DocStructureArrayBuilder::empty() const {
+  return Impl.Stack.front().SubStructures.empty();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> DocStructureArrayBuilder::createBuffer() {
+  assert(Impl.Stack.size() == 1 && "unbalanced beginSubStructure");
+  Impl.close(Impl.Stack.front());
+
+  CompactArrayBuilder<unsigned, unsigned, unsigned, unsigned> NodeRanges;
+  for (auto &Ranges : Impl.NodeRanges)
+    NodeRanges.addEntry(Ranges[0], Ranges[1], Ranges[2], Ranges[3]);
+
+  const unsigned NumArrays = unsigned(ArrayKind::Count);
+  std::unique_ptr<llvm::MemoryBuffer> Arrays[NumArrays] = {
+    Impl.Structures.createBuffer(),
+    NodeRanges.createBuffer(),
+    Impl.Elements.createBuffer(),
+    Impl.InheritedTypes.createBuffer(),
+    Impl.Attributes.createBuffer(),
+    Impl.SubStructures.createBuffer(),
+  };
+
+  // Keep every array 8-byte aligned, since each starts with its size.
+  uint64_t Offsets[NumArrays];
+  uint64_t Size = sizeof(Offsets);
+  for (unsigned I = 0; I != NumArrays; ++I) {
+    Offsets[I] = Size;
+    Size = llvm::alignTo(Size + Arrays[I]->getBufferSize(), sizeof(uint64_t));
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> Buf;
+  Buf = llvm::MemoryBuffer::getNewMemBuffer(Size);
+  char *BufPtr = (char*)Buf->getBufferStart();
+  memcpy(BufPtr, Offsets, sizeof(Offsets));
+  for (unsigned I = 0; I != NumArrays; ++I)
+    memcpy(BufPtr + Offsets[I], Arrays[I]->getBufferStart(),
+           Arrays[I]->getBufferSize());
+
+  return Buf;
+}
+
+namespace {
+
+class DocStructureArrayReader {
+  const char *Buf;
+
+public:
+  typedef CompactArrayReader<sourcekitd_uid_t,
+                             unsigned,
+                             unsigned,
+                             sourcekitd_uid_t,
+                             sourcekitd_uid_t,
+                             unsigned,
+                             unsigned,
+                             unsigned,
+                             unsigned,
+                             const char *,
+                             const char *,
+                             const char *,
+                             const char *,
+                             unsigned,
+                             unsigned,
+                             unsigned,
+                             unsigned> StructureReaderTy;
+  typedef CompactArrayReader<unsigned,
+                             unsigned,
+                             unsigned,
+                             unsigned> NodeRangesReaderTy;
+  typedef CompactArrayReader<sourcekitd_uid_t,
+                             unsigned,
+                             unsigned> ElementReaderTy;
+  typedef CompactArrayReader<const char *> InheritedTypeReaderTy;
+  typedef CompactArrayReader<sourcekitd_uid_t> AttributeReaderTy;
+  typedef CompactArrayReader<unsigned> SubStructureReaderTy;
+
+  explicit DocStructureArrayReader(void *Buf) : Buf((const char *)Buf) {}
+
+  void *getArray(ArrayKind Kind) const {
+    uint64_t Offset;
+    memcpy(&Offset, Buf + sizeof(uint64_t) * unsigned(Kind), sizeof(Offset));
+    return (void *)(Buf + Offset);
+  }
+
+  void readNodeRanges(size_t Node, unsigned &ElementsStart,
+                      unsigned &NumElements, unsigned &SubStructuresStart,
+                      unsigned &NumSubStructures) const {
+    NodeRangesReaderTy(getArray(ArrayKind::NodeRanges))
+        .readEntries(Node, ElementsStart, NumElements, SubStructuresStart,
+                     NumSubStructures);
+  }
+};
+
+/// Variant functions for one of the nested arrays of a node. The variant
+/// holds the buffer and the index of the node.
+template <typename T>
+struct DocStructureArrayFuncs {
+  static sourcekitd_variant_type_t get_type(sourcekitd_variant_t var) {
+    return SOURCEKITD_VARIANT_TYPE_ARRAY;
+  }
+
+  static size_t array_get_count(sourcekitd_variant_t array) {
+    DocStructureArrayReader Reader((void*)array.data[1]);
+    unsigned Start, Count;
+    T::getRange(Reader, array.data[2], Start, Count);
+    return Count;
+  }
+
+  static sourcekitd_variant_t
+  array_get_value(sourcekitd_variant_t array, size_t index) {
+    DocStructureArrayReader Reader((void*)array.data[1]);
+    unsigned Start, Count;
+    T::getRange(Reader, array.data[2], Start, Count);
+    assert(index < Count);
+    return T::getValue(Reader, array.data[1], Start + index);
+  }
+
+  static VariantFunctions Funcs;
+};
+
+/// Variant functions for a dictionary in one of the flat arrays. The variant
+/// holds the buffer and the index of the entry.
+template <typename T>
+struct DocStructureDictFuncs {
+  static sourcekitd_variant_type_t get_type(sourcekitd_variant_t var) {
+    return SOURCEKITD_VARIANT_TYPE_DICTIONARY;
+  }
+
+  static bool dictionary_apply(
+        sourcekitd_variant_t dict,
+        sourcekitd_variant_dictionary_applier_t applier) {
+    DocStructureArrayReader Reader((void*)dict.data[1]);
+    return T::apply(Reader, dict.data[1], dict.data[2], applier);
+  }
+
+  static sourcekitd_variant_t makeVariant(uint64_t Buf, size_t Index) {
+    return {{ (uintptr_t)&Funcs, Buf, Index }};
+  }
+
+  static VariantFunctions Funcs;
+};
+
+#define APPLY(K, Ty, Field)                              \
+  do {                                                   \
+    sourcekitd_uid_t key = SKDUIDFromUIdent(K);          \
+    sourcekitd_variant_t var = make##Ty##Variant(Field); \
+    if (!applier(key, var)) return false;                \
+  } while (0)
+
+#define APPLY_ARRAY(K, Ty)                                   \
+  do {                                                       \
+    sourcekitd_uid_t key = SKDUIDFromUIdent(K);              \
+    sourcekitd_variant_t var =                               \
+        {{ (uintptr_t)&DocStructureArrayFuncs<Ty>::Funcs,    \
+           Buf, Index }};                                    \
+    if (!applier(key, var)) return false;                    \
+  } while (0)
+
+struct Element {
+  static bool apply(const DocStructureArrayReader &Reader, uint64_t Buf,
+                    size_t Index,
+                    sourcekitd_variant_dictionary_applier_t applier) {
+    sourcekitd_uid_t Kind;
+    unsigned Offset;
+    unsigned Length;
+    DocStructureArrayReader::ElementReaderTy(
+        Reader.getArray(ArrayKind::Elements))
+        .readEntries(Index, Kind, Offset, Length);
+
+    APPLY(KeyKind, UID, Kind);
+    APPLY(KeyOffset, Int, Offset);
+    APPLY(KeyLength, Int, Length);
+    return true;
+  }
+};
+
+struct InheritedType {
+  static bool apply(const DocStructureArrayReader &Reader, uint64_t Buf,
+                    size_t Index,
+                    sourcekitd_variant_dictionary_applier_t applier) {
+    const char *Name;
+    DocStructureArrayReader::InheritedTypeReaderTy(
+        Reader.getArray(ArrayKind::InheritedTypes))
+        .readEntries(Index, Name);
+
+    APPLY(KeyName, String, Name);
+    return true;
+  }
+};
+
+struct Attribute {
+  static bool apply(const DocStructureArrayReader &Reader, uint64_t Buf,
+                    size_t Index,
+                    sourcekitd_variant_dictionary_applier_t applier) {
+    sourcekitd_uid_t Attr;
+    DocStructureArrayReader::AttributeReaderTy(
+        Reader.getArray(ArrayKind::Attributes))
+        .readEntries(Index, Attr);
+
+    APPLY(KeyAttribute, UID, Attr);
+    return true;
+  }
+};
+
+struct Structure;
+
+/// The 'key.substructure' array of a node.
+struct SubStructureArray {
+  static void getRange(const DocStructureArrayReader &Reader, size_t Node,
+                       unsigned &Start, unsigned &Count) {
+    unsigned ElementsStart, NumElements;
+    Reader.readNodeRanges(Node, ElementsStart, NumElements, Start, Count);
+  }
+
+  static sourcekitd_variant_t getValue(const DocStructureArrayReader &Reader,
+                                       uint64_t Buf, size_t Index) {
+    unsigned Child;
+    DocStructureArrayReader::SubStructureReaderTy(
+        Reader.getArray(ArrayKind::SubStructures))
+        .readEntries(Index, Child);
+    return DocStructureDictFuncs<Structure>::makeVariant(Buf, Child);
+  }
+};
+
+/// The 'key.elements' array of a node.
+struct ElementArray {
+  static void getRange(const DocStructureArrayReader &Reader, size_t Node,
+                       unsigned &Start, unsigned &Count) {
+    unsigned SubStructuresStart, NumSubStructures;
+    Reader.readNodeRanges(Node, Start, Count, SubStructuresStart,
+                          NumSubStructures);
+  }
+
+  static sourcekitd_variant_t getValue(const DocStructureArrayReader &Reader,
+                                       uint64_t Buf, size_t Index) {
+    return DocStructureDictFuncs<Element>::makeVariant(Buf, Index);
+  }
+};
+
+static void readStructure(const DocStructureArrayReader &Reader, size_t Node,
+                          unsigned &InheritedTypesStart,
+                          unsigned &NumInheritedTypes,
+                          unsigned &AttributesStart,
+                          unsigned &NumAttributes) {
+  sourcekitd_uid_t Kind, AccessLevel, SetterAccessLevel;
+  unsigned Offset, Length, NameOffset, NameLength, BodyOffset, BodyLength;
+  const char *DisplayName, *TypeName, *RuntimeName, *SelectorName;
+  DocStructureArrayReader::StructureReaderTy(
+      Reader.getArray(ArrayKind::Structures))
+      .readEntries(Node, Kind, Offset, Length, AccessLevel, SetterAccessLevel,
+                   NameOffset, NameLength, BodyOffset, BodyLength,
+                   DisplayName, TypeName, RuntimeName, SelectorName,
+                   InheritedTypesStart, NumInheritedTypes,
+                   AttributesStart, NumAttributes);
+}
+
+/// The 'key.inheritedtypes' array of a node.
+struct InheritedTypeArray {
+  static void getRange(const DocStructureArrayReader &Reader, size_t Node,
+                       unsigned &Start, unsigned &Count) {
+    unsigned AttributesStart, NumAttributes;
+    readStructure(Reader, Node, Start, Count, AttributesStart, NumAttributes);
+  }
+
+  static sourcekitd_variant_t getValue(const DocStructureArrayReader &Reader,
+                                       uint64_t Buf, size_t Index) {
+    return DocStructureDictFuncs<InheritedType>::makeVariant(Buf, Index);
+  }
+};
+
+/// The 'key.attributes' array of a node.
+struct AttributeArray {
+  static void getRange(const DocStructureArrayReader &Reader, size_t Node,
+                       unsigned &Start, unsigned &Count) {
+    unsigned InheritedTypesStart, NumInheritedTypes;
+    readStructure(Reader, Node, InheritedTypesStart, NumInheritedTypes,
+                  Start, Count);
+  }
+
+  static sourcekitd_variant_t getValue(const DocStructureArrayReader &Reader,
+                                       uint64_t Buf, size_t Index) {
+    return DocStructureDictFuncs<Attribute>::makeVariant(Buf, Index);
+  }
+};
+
+struct Structure {
+  static bool apply(const DocStructureArrayReader &Reader, uint64_t Buf,
+                    size_t Index,
+                    sourcekitd_variant_dictionary_applier_t applier) {
+    sourcekitd_uid_t Kind, AccessLevel, SetterAccessLevel;
+    unsigned Offset, Length, NameOffset, NameLength, BodyOffset, BodyLength;
+    const char *DisplayName, *TypeName, *RuntimeName, *SelectorName;
+    unsigned InheritedTypesStart, NumInheritedTypes;
+    unsigned AttributesStart, NumAttributes;
+    DocStructureArrayReader::StructureReaderTy(
+        Reader.getArray(ArrayKind::Structures))
+        .readEntries(Index, Kind, Offset, Length, AccessLevel,
+                     SetterAccessLevel, NameOffset, NameLength, BodyOffset,
+                     BodyLength, DisplayName, TypeName, RuntimeName,
+                     SelectorName, InheritedTypesStart, NumInheritedTypes,
+                     AttributesStart, NumAttributes);
+    unsigned ElementsStart, NumElements, SubStructuresStart, NumSubStructures;
+    Reader.readNodeRanges(Index, ElementsStart, NumElements,
+                          SubStructuresStart, NumSubStructures);
+
+    APPLY(KeyOffset, Int, Offset);
+    APPLY(KeyLength, Int, Length);
+    APPLY(KeyKind, UID, Kind);
+    if (AccessLevel)
+      APPLY(KeyAccessibility, UID, AccessLevel);
+    if (SetterAccessLevel)
+      APPLY(KeySetterAccessibility, UID, SetterAccessLevel);
+    APPLY(KeyNameOffset, Int, NameOffset);
+    APPLY(KeyNameLength, Int, NameLength);
+    if (BodyOffset != 0 || BodyLength != 0) {
+      APPLY(KeyBodyOffset, Int, BodyOffset);
+      APPLY(KeyBodyLength, Int, BodyLength);
+    }
+    if (DisplayName)
+      APPLY(KeyName, String, DisplayName);
+    if (TypeName)
+      APPLY(KeyTypeName, String, TypeName);
+    if (RuntimeName)
+      APPLY(KeyRuntimeName, String, RuntimeName);
+    if (SelectorName)
+      APPLY(KeySelectorName, String, SelectorName);
+    if (NumInheritedTypes)
+      APPLY_ARRAY(KeyInheritedTypes, InheritedTypeArray);
+    if (NumAttributes)
+      APPLY_ARRAY(KeyAttributes, AttributeArray);
+    if (NumSubStructures)
+      APPLY_ARRAY(KeySubStructure, SubStructureArray);
+    if (NumElements)
+      APPLY_ARRAY(KeyElements, ElementArray);
+    return true;
+  }
+};
+
+#undef APPLY
+#undef APPLY_ARRAY
+
+template <typename T>
+VariantFunctions DocStructureArrayFuncs<T>::Funcs = {
+  get_type,
+  nullptr/*DocStructArray_array_apply*/,
+  nullptr/*DocStructArray_array_get_bool*/,
+  array_get_count,
+  nullptr/*DocStructArray_array_get_int64*/,
+  nullptr/*DocStructArray_array_get_string*/,
+  nullptr/*DocStructArray_array_get_uid*/,
+  array_get_value,
+  nullptr/*DocStructArray_bool_get_value*/,
+  nullptr/*DocStructArray_dictionary_apply*/,
+  nullptr/*DocStructArray_dictionary_get_bool*/,
+  nullptr/*DocStructArray_dictionary_get_int64*/,
+  nullptr/*DocStructArray_dictionary_get_string*/,
+  nullptr/*DocStructArray_dictionary_get_value*/,
+  nullptr/*DocStructArray_dictionary_get_uid*/,
+  nullptr/*DocStructArray_string_get_length*/,
+  nullptr/*DocStructArray_string_get_ptr*/,
+  nullptr/*DocStructArray_int64_get_value*/,
+  nullptr/*DocStructArray_uid_get_value*/
+};
+
+template <typename T>
+VariantFunctions DocStructureDictFuncs<T>::Funcs = {
+  get_type,
+  nullptr/*DocStruct_array_apply*/,
+  nullptr/*DocStruct_array_get_bool*/,
+  nullptr/*DocStruct_array_get_count*/,
+  nullptr/*DocStruct_array_get_int64*/,
+  nullptr/*DocStruct_array_get_string*/,
+  nullptr/*DocStruct_array_get_uid*/,
+  nullptr/*DocStruct_array_get_value*/,
+  nullptr/*DocStruct_bool_get_value*/,
+  dictionary_apply,
+  nullptr/*DocStruct_dictionary_get_bool*/,
+  nullptr/*DocStruct_dictionary_get_int64*/,
+  nullptr/*DocStruct_dictionary_get_string*/,
+  nullptr/*DocStruct_dictionary_get_value*/,
+  nullptr/*DocStruct_dictionary_get_uid*/,
+  nullptr/*DocStruct_string_get_length*/,
+  nullptr/*DocStruct_string_get_ptr*/,
+  nullptr/*DocStruct_int64_get_value*/,
+  nullptr/*DocStruct_uid_get_value*/
+};
+
+} // end anonymous namespace
+
+/// The variant for the custom buffer is the 'key.substructure' array of the
+/// document, which is node 0.
+VariantFunctions *sourcekitd::getVariantFunctionsForDocStructureArray() {
+  return &DocStructureArrayFuncs<SubStructureArray>::Funcs;
+}
@@ -12,6 +12,7 @@
 
 #include "DictionaryKeys.h"
 #include "sourcekitd/CodeCompletionResultsArray.h"
+#include "sourcekitd/DocStructureArray.h"
 #include "sourcekitd/DocSupportAnnotationArray.h"
 #include "sourcekitd/TokenAnnotationsArray.h"
 
@@ -20,6 +21,7 @@
 #include "SourceKit/Core/NotificationCenter.h"
 #include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/Logging.h"
+#include "SourceKit/Support/Tracing.h"
 #include "SourceKit/Support/UIdent.h"
 
 #include "swift/Basic/DemangleWrappers.h"
@@ -101,6 +103,7 @@ static LazySKDUID RequestBuildSettingsRegister(
     "source.request.buildsettings.register");
 static LazySKDUID RequestModuleGroups(
     "source.request.module.groups");
+static LazySKDUID RequestStatistics("source.request.statistics");
 
 static LazySKDUID KindExpr("source.lang.swift.expr");
 static LazySKDUID KindStmt("source.lang.swift.stmt");
@@ -146,6 +149,8 @@ static SourceKit::Context &getGlobalContext() {
   return *GlobalCtx;
 }
 
+static sourcekitd_response_t reportStatistics();
+
 static sourcekitd_response_t demangleNames(ArrayRef<const char *> MangledNames,
                                            bool Simplified);
 
@@ -318,6 +323,10 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     ::exit(1);
   }
 
+  if (ReqUID == RequestStatistics) {
+    return Rec(reportStatistics());
+  }
+
   if (ReqUID == RequestDemangle) {
     SmallVector<const char *, 8> MangledNames;
     bool Failed = Req.getStringArray(KeyNames, MangledNames, /*isOptional=*/true);
@@ -735,6 +744,90 @@ handleSemanticRequest(RequestDict Req,
   return Rec(createErrorRequestInvalid(ErrBuf.c_str()));
 }
 
+//===----------------------------------------------------------------------===//
+// Statistics
+//===----------------------------------------------------------------------===//
+
+static UIdent getUIDForOperationKind(trace::OperationKind OpKind) {
+  static UIdent SimpleParse("source.statistic.simple_parse");
+  static UIdent PerformSema("source.statistic.perform_sema");
+  static UIdent AnnotAndDiag("source.statistic.annot_and_diag");
+  static UIdent ReadSyntaxInfo("source.statistic.read_syntax_info");
+  static UIdent ReadDiagnostics("source.statistic.read_diagnostics");
+  static UIdent ReadSemanticInfo("source.statistic.read_semantic_info");
+  static UIdent IndexModule("source.statistic.index_module");
+  static UIdent IndexSource("source.statistic.index_source");
+  static UIdent CursorInfoForIFaceGen(
+      "source.statistic.cursor_info_for_iface_gen");
+  static UIdent CursorInfoForSource("source.statistic.cursor_info_for_source");
+  static UIdent ExpandPlaceholder("source.statistic.expand_placeholder");
+  static UIdent FormatText("source.statistic.format_text");
+  static UIdent RelatedIdents("source.statistic.related_idents");
+  static UIdent CodeCompletion("source.statistic.code_completion");
+  static UIdent OpenInterface("source.statistic.open_interface");
+  static UIdent OpenHeaderInterface("source.statistic.open_header_interface");
+  static UIdent CodeCompletionInit("source.statistic.code_completion_init");
+
+  switch (OpKind) {
+  case trace::OperationKind::SimpleParse: return SimpleParse;
+  case trace::OperationKind::PerformSema: return PerformSema;
+  case trace::OperationKind::AnnotAndDiag: return AnnotAndDiag;
+  case trace::OperationKind::ReadSyntaxInfo: return ReadSyntaxInfo;
+  case trace::OperationKind::ReadDiagnostics: return ReadDiagnostics;
+  case trace::OperationKind::ReadSemanticInfo: return ReadSemanticInfo;
+  case trace::OperationKind::IndexModule: return IndexModule;
+  case trace::OperationKind::IndexSource: return IndexSource;
+  case trace::OperationKind::CursorInfoForIFaceGen:
+    return CursorInfoForIFaceGen;
+  case trace::OperationKind::CursorInfoForSource: return CursorInfoForSource;
+  case trace::OperationKind::ExpandPlaceholder: return ExpandPlaceholder;
+  case trace::OperationKind::FormatText: return FormatText;
+  case trace::OperationKind::RelatedIdents: return RelatedIdents;
+  case trace::OperationKind::CodeCompletion: return CodeCompletion;
+  case trace::OperationKind::OpenInterface: return OpenInterface;
+  case trace::OperationKind::OpenHeaderInterface: return OpenHeaderInterface;
+  case trace::OperationKind::CodeCompletionInit: return CodeCompletionInit;
+  }
+  llvm_unreachable("unhandled operation kind");
+}
+
+static void fillDictionaryForLatency(ResponseBuilder::Dictionary Elem,
+                                     UIdent Kind,
+                                     const trace::LatencyStatistics &Stats) {
+  Elem.set(KeyKind, Kind);
+  Elem.set(KeyCount, Stats.Count);
+  Elem.set(KeyLatencyP50, Stats.P50);
+  Elem.set(KeyLatencyP90, Stats.P90);
+  Elem.set(KeyLatencyP99, Stats.P99);
+  Elem.set(KeyLatencyMax, Stats.Max);
+}
+
+/// Reports the latencies of the operations which have run in this process,
+/// in microseconds. Kinds which did not run yet are omitted.
+static sourcekitd_response_t reportStatistics() {
+  static UIdent ASTQueueWait("source.statistic.ast_queue_wait");
+
+  trace::Statistics Stats = trace::getStatistics();
+
+  ResponseBuilder RespBuilder;
+  auto Dict = RespBuilder.getDictionary();
+  auto Results = Dict.setArray(KeyResults);
+  for (unsigned I = 0; I != trace::NumOperationKinds; ++I) {
+    if (Stats.Operations[I].Count == 0)
+      continue;
+    fillDictionaryForLatency(Results.appendDictionary(),
+                             getUIDForOperationKind(trace::OperationKind(I)),
+                             Stats.Operations[I]);
+  }
+  if (Stats.ASTQueueWait.Count != 0)
+    fillDictionaryForLatency(Results.appendDictionary(), ASTQueueWait,
+                             Stats.ASTQueueWait);
+
+  Dict.set(KeyASTBuilds, Stats.ASTBuilds);
+  Dict.set(KeyASTCacheHits, Stats.ASTCacheHits);
+  return RespBuilder.createResponse();
+}
+
 //===----------------------------------------------------------------------===//
 // Index
 //===----------------------------------------------------------------------===//
@@ -1686,19 +1779,12 @@ class SKEditorConsumer : public EditorConsumer {
   ResponseBuilder::Dictionary Dict;
   TokenAnnotationsArrayBuilder SyntaxMap;
   TokenAnnotationsArrayBuilder SemanticAnnotations;
-
-  struct StructureNode {
-    ResponseBuilder::Dictionary Dict;
-    ResponseBuilder::Array SubStructures;
-    ResponseBuilder::Array Elements;
-
-    explicit StructureNode(ResponseBuilder::Dictionary Dict) : Dict(Dict) {}
-  };
-  std::vector<StructureNode> Structures;
+  DocStructureArrayBuilder DocStructure;
   ResponseBuilder::Array Diags;
   sourcekitd_response_t Error = nullptr;
 
   bool EnableSyntaxMap;
+  bool EnableStructure;
   bool EnableDiagnostics;
   bool SyntacticOnly;
 
@@ -1707,12 +1793,11 @@ public:
                    bool EnableStructure, bool EnableDiagnostics,
                    bool SyntacticOnly)
   : EnableSyntaxMap(EnableSyntaxMap),
+    EnableStructure(EnableStructure),
     EnableDiagnostics(EnableDiagnostics),
     SyntacticOnly(SyntacticOnly) {
 
     Dict = RespBuilder.getDictionary();
-    if (EnableStructure)
-      Structures.push_back(StructureNode{Dict});
   }
 
   SKEditorConsumer(ResponseReceiver RespReceiver, bool EnableSyntaxMap,
@@ -1900,6 +1985,11 @@ sourcekitd_response_t SKEditorConsumer::createResponse() {
         CustomBufferKind::TokenAnnotationsArray,
         SemanticAnnotations.createBuffer());
   }
+  if (EnableStructure && !DocStructure.empty()) {
+    Dict.setCustomBuffer(KeySubStructure,
+        CustomBufferKind::DocStructureArray,
+        DocStructure.createBuffer());
+  }
 
   return RespBuilder.createResponse();
 }
@@ -1946,59 +2036,20 @@ SKEditorConsumer::beginDocumentSubStructure(unsigned Offset,
                                             StringRef SelectorName,
                                             ArrayRef<StringRef> InheritedTypes,
                                             ArrayRef<UIdent> Attrs) {
-  if (Structures.empty())
+  if (!EnableStructure)
     return true;
 
-  auto &Parent = Structures.back();
-  if (Parent.SubStructures.isNull())
-    Parent.SubStructures = Parent.Dict.setArray(KeySubStructure);
-  auto Node = Parent.SubStructures.appendDictionary();
-  Node.set(KeyOffset, Offset);
-  Node.set(KeyLength, Length);
-  Node.set(KeyKind, Kind);
-  if (AccessLevel.isValid())
-    Node.set(KeyAccessibility, AccessLevel);
-  if (SetterAccessLevel.isValid())
-    Node.set(KeySetterAccessibility, SetterAccessLevel);
-  Node.set(KeyNameOffset, NameOffset);
-  Node.set(KeyNameLength, NameLength);
-  if (BodyOffset != 0 || BodyLength !=0) {
-    Node.set(KeyBodyOffset, BodyOffset);
-    Node.set(KeyBodyLength, BodyLength);
-  }
-
-  if (!DisplayName.empty())
-    Node.set(KeyName, DisplayName);
-
-  if (!TypeName.empty())
-    Node.set(KeyTypeName,TypeName);
-
-  if (!RuntimeName.empty())
-    Node.set(KeyRuntimeName, RuntimeName);
-
-  if (!SelectorName.empty())
-    Node.set(KeySelectorName, SelectorName);
-
-  if (!InheritedTypes.empty()) {
-    auto TypeArray = Node.setArray(KeyInheritedTypes);
-    for (const StringRef &TypeName : InheritedTypes) {
-      TypeArray.appendDictionary().set(KeyName, TypeName);
-    }
-  }
-  if (!Attrs.empty()) {
-    auto AttrArray = Node.setArray(KeyAttributes);
-    for (auto Attr : Attrs) {
-      auto AttrDict = AttrArray.appendDictionary();
-      AttrDict.set(KeyAttribute, Attr);
-    }
-  }
-  Structures.push_back(StructureNode{Node});
+  DocStructure.beginSubStructure(Offset, Length, Kind, AccessLevel,
+                                 SetterAccessLevel, NameOffset, NameLength,
+                                 BodyOffset, BodyLength, DisplayName, TypeName,
+                                 RuntimeName, SelectorName, InheritedTypes,
+                                 Attrs);
   return true;
 }
 
 bool SKEditorConsumer::endDocumentSubStructure() {
-  if (!Structures.empty())
-    Structures.pop_back();
+  if (EnableStructure)
+    DocStructure.endSubStructure();
 
   return true;
 }
@@ -2006,16 +2057,9 @@ bool SKEditorConsumer::endDocumentSubStructure() {
 bool SKEditorConsumer::handleDocumentSubStructureElement(UIdent Kind,
                                                          unsigned Offset,
                                                          unsigned Length) {
-  if (Structures.empty())
-    return true;
+  if (EnableStructure)
+    DocStructure.addElement(Kind, Offset, Length);
 
-  auto &Parent = Structures.back();
-  if (Parent.Elements.isNull())
-    Parent.Elements = Parent.Dict.setArray(KeyElements);
-  auto Node = Parent.Elements.appendDictionary();
-  Node.set(KeyKind, Kind);
-  Node.set(KeyOffset, Offset);
-  Node.set(KeyLength, Length);
   return true;
 }
 
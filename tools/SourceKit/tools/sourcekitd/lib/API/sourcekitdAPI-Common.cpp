@@ -131,6 +131,13 @@ UIdent sourcekitd::KeyObsoleted("key.obsoleted");
 UIdent sourcekitd::KeyRemoveCache("key.removecache");
 UIdent sourcekitd::KeyTypeInterface("key.typeinterface");
 UIdent sourcekitd::KeyModuleGroups("key.modulegroups");
+UIdent sourcekitd::KeyCount("key.count");
+UIdent sourcekitd::KeyLatencyP50("key.latency.p50");
+UIdent sourcekitd::KeyLatencyP90("key.latency.p90");
+UIdent sourcekitd::KeyLatencyP99("key.latency.p99");
+UIdent sourcekitd::KeyLatencyMax("key.latency.max");
+UIdent sourcekitd::KeyASTBuilds("key.ast_builds");
+UIdent sourcekitd::KeyASTCacheHits("key.ast_cache_hits");
 
 /// \brief Order for the keys to use when emitting the debug description of
 /// dictionaries.
@@ -12,6 +12,7 @@
 
 #include "DictionaryKeys.h"
 #include "sourcekitd/CodeCompletionResultsArray.h"
+#include "sourcekitd/DocStructureArray.h"
 #include "sourcekitd/DocSupportAnnotationArray.h"
 #include "sourcekitd/TokenAnnotationsArray.h"
 #include "sourcekitd/Logging.h"
@@ -292,16 +293,18 @@ void ResponseBuilder::Dictionary::setCustomBuffer(
       SourceKit::UIdent Key,
       CustomBufferKind Kind, std::unique_ptr<llvm::MemoryBuffer> MemBuf) {
 
-  std::unique_ptr<llvm::MemoryBuffer> CustomBuf;
-  CustomBuf = llvm::MemoryBuffer::getNewUninitMemBuffer(
-      sizeof(uint64_t) + MemBuf->getBufferSize());
-  char *BufPtr = (char*)CustomBuf->getBufferStart();
+  // Assemble the kind and the contents in a single allocation and hand it
+  // over to XPC, instead of letting xpc_data_create() copy it once more.
+  size_t Size = sizeof(uint64_t) + MemBuf->getBufferSize();
+  char *BufPtr = (char*)malloc(Size);
   *reinterpret_cast<uint64_t*>(BufPtr) = (uint64_t)Kind;
-  BufPtr += sizeof(uint64_t);
-  memcpy(BufPtr, MemBuf->getBufferStart(), MemBuf->getBufferSize());
+  memcpy(BufPtr + sizeof(uint64_t), MemBuf->getBufferStart(),
+         MemBuf->getBufferSize());
 
-  xpc_object_t xdata = xpc_data_create(CustomBuf->getBufferStart(),
-                                       CustomBuf->getBufferSize());
+  dispatch_data_t ddata = dispatch_data_create(BufPtr, Size, nullptr,
+                                               DISPATCH_DATA_DESTRUCTOR_FREE);
+  xpc_object_t xdata = xpc_data_create_with_dispatch_data(ddata);
+  dispatch_release(ddata);
   xpc_dictionary_set_value(Impl, Key.c_str(), xdata);
   xpc_release(xdata);
 }
@@ -686,6 +689,8 @@ static sourcekitd_variant_type_t XPCVar_get_type(sourcekitd_variant_t var) {
       return SOURCEKITD_VARIANT_TYPE_ARRAY;
     case CustomBufferKind::CodeCompletionResultsArray:
       return SOURCEKITD_VARIANT_TYPE_ARRAY;
+    case CustomBufferKind::DocStructureArray:
+      return SOURCEKITD_VARIANT_TYPE_ARRAY;
     }
   }
   
@@ -821,6 +826,9 @@ static sourcekitd_variant_t variantFromXPCObject(xpc_object_t obj) {
     case CustomBufferKind::CodeCompletionResultsArray:
       return {{ (uintptr_t)getVariantFunctionsForCodeCompletionResultsArray(),
                 (uintptr_t)CUSTOM_BUF_START(obj), 0 }};
+    case CustomBufferKind::DocStructureArray:
+      return {{ (uintptr_t)getVariantFunctionsForDocStructureArray(),
+                (uintptr_t)CUSTOM_BUF_START(obj), 0 }};
     }
   }
 
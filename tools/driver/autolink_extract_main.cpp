@@ -23,13 +23,18 @@
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/Option/Options.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Object/Archive.h"
+#include "llvm/Object/IRObjectFile.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Object/ELFObjectFile.h"
 
@@ -106,6 +111,16 @@ public:
   }
 };
 
+// Append the null-terminated entries of an autolink section to 'LinkerFlags'.
+static void appendAutolinkEntries(llvm::StringRef SectionData,
+                                  std::vector<std::string> &LinkerFlags) {
+  llvm::SmallVector<llvm::StringRef, 4> SplitFlags;
+  SectionData.split(SplitFlags, llvm::StringRef("\0", 1), -1,
+                    /*KeepEmpty=*/false);
+  for (const auto &Flag : SplitFlags)
+    LinkerFlags.push_back(Flag);
+}
+
 // Look inside the binary 'Bin' and append any linker flags found in its
 // ".swift1_autolink_entries" section to 'LinkerFlags'. If 'Bin' is an archive,
 // recursively look inside all children within the archive. Return 'true' if
@@ -113,6 +128,7 @@ public:
 static bool extractLinkerFlags(const llvm::object::Binary *Bin,
                                CompilerInstance &Instance,
                                StringRef BinaryFileName,
+                               llvm::LLVMContext &Context,
                                std::vector<std::string> &LinkerFlags) {
   if (auto *ObjectFile = llvm::dyn_cast<llvm::object::ELFObjectFileBase>(Bin)) {
     // Search for the section we hold autolink entries in
@@ -122,20 +138,25 @@ static bool extractLinkerFlags(const llvm::object::Binary *Bin,
       if (SectionName == ".swift1_autolink_entries") {
         llvm::StringRef SectionData;
         Section.getContents(SectionData);
-
-        // entries are null-terminated, so extract them and push them into
-        // the set.
-        llvm::SmallVector<llvm::StringRef, 4> SplitFlags;
-        SectionData.split(SplitFlags, llvm::StringRef("\0", 1), -1,
-                          /*KeepEmpty=*/false);
-        for (const auto &Flag : SplitFlags)
-          LinkerFlags.push_back(Flag);
+        appendAutolinkEntries(SectionData, LinkerFlags);
       }
     }
     return false;
+  } else if (auto *IRObject = llvm::dyn_cast<llvm::object::IRObjectFile>(Bin)) {
+    // Objects compiled with -thin-lto are bitcode. The entries are the
+    // initializer of the global which IRGen put into the autolink section.
+    for (auto &Global : IRObject->getModule().globals()) {
+      if (Global.getSection() != ".swift1_autolink_entries")
+        continue;
+      auto *Entries = llvm::dyn_cast_or_null<llvm::ConstantDataSequential>(
+          Global.getInitializer());
+      if (Entries)
+        appendAutolinkEntries(Entries->getRawDataValues(), LinkerFlags);
+    }
+    return false;
   } else if (auto *Archive = llvm::dyn_cast<llvm::object::Archive>(Bin)) {
     for (const auto &Child : Archive->children()) {
-      auto ChildBinary = Child->getAsBinary();
+      auto ChildBinary = Child->getAsBinary(&Context);
       // FIXME: BinaryFileName below should instead be ld-style names for
       // object files in archives, e.g. "foo.a(bar.o)".
       if (!ChildBinary) {
@@ -145,7 +166,7 @@ static bool extractLinkerFlags(const llvm::object::Binary *Bin,
         return true;
       }
       if (extractLinkerFlags(ChildBinary->get(), Instance, BinaryFileName,
-                             LinkerFlags)) {
+                             Context, LinkerFlags)) {
         return true;
       }
     }
@@ -177,17 +198,28 @@ int autolink_extract_main(ArrayRef<const char *> Args, const char *Argv0,
 
   std::vector<std::string> LinkerFlags;
 
-  // Extract the linker flags from the objects.
+  // Extract the linker flags from the objects. A context is needed to read
+  // bitcode objects.
+  llvm::LLVMContext Context;
   for (const auto &BinaryFileName : Invocation.getInputFilenames()) {
-    auto BinaryOwner = llvm::object::createBinary(BinaryFileName);
-    if (!BinaryOwner) {
+    auto Buffer = llvm::MemoryBuffer::getFile(BinaryFileName);
+    if (!Buffer) {
+      Instance.getDiags().diagnose(SourceLoc(), diag::error_open_input_file,
+                                   BinaryFileName,
+                                   Buffer.getError().message());
+      return 1;
+    }
+
+    auto Binary = llvm::object::createBinary((*Buffer)->getMemBufferRef(),
+                                             &Context);
+    if (!Binary) {
       Instance.getDiags().diagnose(SourceLoc(), diag::error_open_input_file,
                                    BinaryFileName,
-                                   BinaryOwner.getError().message());
+                                   Binary.getError().message());
       return 1;
     }
 
-    if (extractLinkerFlags(BinaryOwner->getBinary(), Instance, BinaryFileName,
+    if (extractLinkerFlags(Binary->get(), Instance, BinaryFileName, Context,
                            LinkerFlags)) {
       return 1;
     }
@@ -24,6 +24,7 @@
 #include "swift/Driver/Job.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
+#include "swift/FrontendTool/FrontendServer.h"
 #include "swift/FrontendTool/FrontendTool.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/CommandLine.h"
@@ -153,10 +154,32 @@ int main(int argc_, const char **argv_) {
   if (argv.size() > 1){
     StringRef FirstArg(argv[1]);
     if (FirstArg == "-frontend") {
-      return performFrontend(llvm::makeArrayRef(argv.data()+2,
-                                                argv.data()+argv.size()),
+      auto FrontendArgs = llvm::makeArrayRef(argv.data()+2,
+                                             argv.data()+argv.size());
+      // Hand the job to a frontend server if one has been set up, and run it
+      // here if that doesn't work out.
+      if (const char *SocketPath = getenv("SWIFT_FRONTEND_SERVER")) {
+        int Result;
+        if (forwardToFrontendServer(SocketPath, FrontendArgs, argv[0],
+                                    (void *)(intptr_t)getExecutablePath,
+                                    Result))
+          return Result;
+      }
+      return performFrontend(FrontendArgs,
                              argv[0], (void *)(intptr_t)getExecutablePath);
     }
+    if (FirstArg == "-frontend-server") {
+      unsigned IdleTimeout = 600;
+      if (argv.size() < 3 || argv.size() > 4 ||
+          (argv.size() == 4 &&
+           StringRef(argv[3]).getAsInteger(10, IdleTimeout))) {
+        llvm::errs() << "usage: " << argv[0]
+                     << " -frontend-server <socket> [<idle seconds>]\n";
+        return 1;
+      }
+      return runFrontendServer(argv[2], IdleTimeout,
+                               argv[0], (void *)(intptr_t)getExecutablePath);
+    }
     if (FirstArg == "-modulewrap") {
       return modulewrap_main(llvm::makeArrayRef(argv.data()+2,
                                                 argv.data()+argv.size()),
@@ -17,6 +17,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "swift/Strings.h"
 #include "swift/Subsystems.h"
 #include "swift/Basic/Demangle.h"
 #include "swift/Basic/LLVMInitialize.h"
@@ -25,6 +26,7 @@
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/Serialization/SerializedModuleLoader.h"
 #include "swift/Serialization/SerializedSILLoader.h"
+#include "swift/Serialization/SerializationOptions.h"
 #include "swift/SILOptimizer/Analysis/Analysis.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
@@ -51,6 +53,9 @@ static llvm::cl::opt<bool>
 EmitVerboseSIL("emit-verbose-sil",
                llvm::cl::desc("Emit locations during sil emission."));
 
+static llvm::cl::opt<bool>
+EmitSIB("emit-sib", llvm::cl::desc("Emit serialized AST + SIL file(s)"));
+
 static llvm::cl::opt<std::string>
 FunctionName("func", llvm::cl::desc("Function name to extract."));
 
@@ -225,6 +230,24 @@ int main(int argc, char **argv) {
   if (!FunctionName.empty())
     removeUnwantedFunctions(CI.getSILModule(), FunctionName);
 
+  if (EmitSIB) {
+    llvm::SmallString<128> OutputFile;
+    if (OutputFilename.getNumOccurrences()) {
+      OutputFile = OutputFilename;
+    } else {
+      OutputFile = CI.getMainModule()->getName().str();
+      llvm::sys::path::replace_extension(OutputFile, SIB_EXTENSION);
+    }
+
+    SerializationOptions serializationOpts;
+    serializationOpts.OutputPath = OutputFile.c_str();
+    serializationOpts.SerializeAllSIL = true;
+    serializationOpts.IsSIB = true;
+
+    serialize(CI.getMainModule(), serializationOpts, CI.getSILModule());
+    return CI.getASTContext().hadError();
+  }
+
   std::error_code EC;
   llvm::raw_fd_ostream OS(OutputFilename, EC, llvm::sys::fs::F_None);
   if (EC) {
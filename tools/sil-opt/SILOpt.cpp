@@ -128,6 +128,17 @@ RemoveRuntimeAsserts("remove-runtime-asserts",
                      llvm::cl::init(false),
                      llvm::cl::desc("Remove runtime assertions (cond_fail)."));
 
+static llvm::cl::opt<bool>
+AssumeSingleThreaded("assume-single-threaded", llvm::cl::Hidden,
+                     llvm::cl::init(false),
+                     llvm::cl::desc("Assume that code will be executed in a "
+                                    "single-threaded environment"));
+
+static llvm::cl::opt<bool>
+WholeProgram("whole-program", llvm::cl::Hidden, llvm::cl::init(false),
+             llvm::cl::desc("Assume that an executable module is the whole "
+                            "program"));
+
 static llvm::cl::opt<bool>
 EmitVerboseSIL("emit-verbose-sil",
                llvm::cl::desc("Emit locations during sil emission."));
@@ -224,6 +235,8 @@ int main(int argc, char **argv) {
   SILOpts.VerifyAll = EnableSILVerifyAll;
   SILOpts.RemoveRuntimeAsserts = RemoveRuntimeAsserts;
   SILOpts.AssertConfig = AssertConfId;
+  SILOpts.AssumeSingleThreaded = AssumeSingleThreaded;
+  SILOpts.WholeProgram = WholeProgram;
   if (OptimizationGroup != OptGroup::Diagnostics)
     SILOpts.Optimization = SILOptions::SILOptMode::Optimize;
 
@@ -15,15 +15,22 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/DemangleWrappers.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Regex.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <string>
+#include <thread>
+#include <vector>
 
 static llvm::cl::opt<bool>
 ExpandMode("expand",
@@ -49,6 +56,30 @@ static llvm::cl::opt<bool>
 Simplified("simplified",
            llvm::cl::desc("Don't display module names or implicit self types"));
 
+static llvm::cl::opt<unsigned>
+BenchmarkIterations("benchmark-iterations",
+           llvm::cl::desc("Demangle the input names this many times and report the throughput instead of the demanglings"),
+           llvm::cl::init(0));
+
+static llvm::cl::opt<std::string>
+InputFilename("input-file",
+           llvm::cl::desc("Read the text to demangle from this file instead of stdin"),
+           llvm::cl::init("-"));
+
+static llvm::cl::opt<unsigned>
+NumThreads("j",
+           llvm::cl::desc("Demangle the input text on this many threads"),
+           llvm::cl::init(1));
+
+static llvm::cl::opt<unsigned>
+ChunkSize("chunk-size",
+           llvm::cl::desc("Split the input text into chunks of about this many bytes"),
+           llvm::cl::init(1 << 20), llvm::cl::Hidden);
+
+static llvm::cl::opt<bool>
+PrintStats("stats",
+           llvm::cl::desc("Print how fast the input text was demangled to stderr"));
+
 static llvm::cl::list<std::string>
 InputNames(llvm::cl::Positional, llvm::cl::desc("[mangled name...]"),
                llvm::cl::ZeroOrMore);
@@ -60,32 +91,58 @@ static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
     hadLeadingUnderscore = true;
     name = name.substr(1);
   }
+  // None of the nodes outlive this function.
+  swift::Demangle::NodeArena arena;
   swift::Demangle::NodePointer pointer =
       swift::demangle_wrappers::demangleSymbolAsNode(name);
   if (ExpandMode || TreeOnly) {
-    llvm::outs() << "Demangling for " << name << '\n';
-    swift::demangle_wrappers::NodeDumper(pointer).print(llvm::outs());
+    os << "Demangling for " << name << '\n';
+    swift::demangle_wrappers::NodeDumper(pointer).print(os);
   }
   if (RemangleMode) {
-    if (hadLeadingUnderscore) llvm::outs() << '_';
+    if (hadLeadingUnderscore) os << '_';
     // Just reprint the original mangled name if it didn't demangle.
     // This makes it easier to share the same database between the
     // mangling and demangling tests.
     if (!pointer) {
-      llvm::outs() << name;
+      os << name;
     } else {
-      llvm::outs() << swift::Demangle::mangleNode(pointer);
+      os << swift::Demangle::mangleNode(pointer);
     }
     return;
   }
   if (!TreeOnly) {
     std::string string = swift::Demangle::nodeToString(pointer, options);
     if (!CompactMode)
-      llvm::outs() << name << " ---> ";
-    llvm::outs() << (string.empty() ? name : llvm::StringRef(string));
+      os << name << " ---> ";
+    os << (string.empty() ? name : llvm::StringRef(string));
   }
 }
 
+/// Demangle \p names to strings \p iterations times over, and print how
+/// long it took.
+static void benchmark(llvm::ArrayRef<llvm::StringRef> names,
+                      unsigned iterations,
+                      const swift::Demangle::DemangleOptions &options) {
+  size_t totalLength = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i != iterations; ++i) {
+    for (llvm::StringRef name : names) {
+      totalLength += swift::Demangle::demangleSymbolAsString(
+          name.data(), name.size(), options).size();
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double seconds = std::chrono::duration<double>(end - start).count();
+  size_t count = names.size() * size_t(iterations);
+  llvm::outs() << "Demangled " << count << " names ("
+               << totalLength << " characters) in "
+               << llvm::format("%.3f", seconds) << "s: "
+               << llvm::format("%.0f", seconds > 0 ? count / seconds : 0.0)
+               << " names/s\n";
+}
+
 static llvm::StringRef substrBefore(llvm::StringRef whole,
                                     llvm::StringRef part) {
   return whole.slice(0, part.data() - whole.data());
@@ -96,6 +153,130 @@ static llvm::StringRef substrAfter(llvm::StringRef whole,
   return whole.substr((part.data() - whole.data()) + part.size());
 }
 
+namespace {
+/// Demangles the symbols in pieces of text on one thread.
+class TextDemangler {
+  const swift::Demangle::DemangleOptions &Options;
+
+  // This doesn't handle Unicode symbols, but maybe that's okay.
+  llvm::Regex MaybeSymbol{"_T[_a-zA-Z0-9$]+"};
+
+  /// The demanglings of the symbols seen so far. Crash logs repeat the same
+  /// symbols over and over again, so most lookups hit.
+  llvm::StringMap<std::string> Cache;
+
+  /// Bounds the memory taken by the cache of a long run.
+  static const unsigned MaxCacheSize = 1 << 16;
+
+public:
+  size_t NumSymbols = 0;
+  size_t NumCacheHits = 0;
+
+  explicit TextDemangler(const swift::Demangle::DemangleOptions &options)
+    : Options(options) {}
+
+  /// Copies \p text to \p os with every symbol replaced by its demangling.
+  void demangleText(llvm::StringRef text, llvm::raw_ostream &os) {
+    llvm::SmallVector<llvm::StringRef, 1> matches;
+    while (MaybeSymbol.match(text, &matches)) {
+      llvm::StringRef name = matches.front();
+      os << substrBefore(text, name);
+      ++NumSymbols;
+
+      auto found = Cache.find(name);
+      if (found != Cache.end()) {
+        ++NumCacheHits;
+        os << found->getValue();
+      } else {
+        if (Cache.size() >= MaxCacheSize)
+          Cache.clear();
+        std::string &demangled = Cache[name];
+        llvm::raw_string_ostream demangledStream(demangled);
+        demangle(demangledStream, name, Options);
+        os << demangledStream.str();
+      }
+      text = substrAfter(text, name);
+    }
+    os << text;
+  }
+};
+} // end anonymous namespace
+
+/// Splits \p text into pieces of about \p chunkSize bytes that end at the end
+/// of a line, so that no symbol straddles two of them.
+static std::vector<llvm::StringRef> splitIntoChunks(llvm::StringRef text,
+                                                    size_t chunkSize) {
+  std::vector<llvm::StringRef> chunks;
+  while (!text.empty()) {
+    size_t end = text.find('\n', std::min(chunkSize, text.size()) - 1);
+    end = (end == llvm::StringRef::npos) ? text.size() : end + 1;
+    chunks.push_back(text.substr(0, end));
+    text = text.substr(end);
+  }
+  return chunks;
+}
+
+/// Copies \p text to stdout with every symbol replaced by its demangling.
+///
+/// The text is split into chunks, which \p numThreads threads demangle into
+/// separate buffers. The buffers are written out in order a batch at a time,
+/// so the output is the same as if a single thread had done all the work.
+static void demangleText(llvm::StringRef text, unsigned numThreads,
+                         const swift::Demangle::DemangleOptions &options) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<llvm::StringRef> chunks =
+      splitIntoChunks(text, std::max(1u, unsigned(ChunkSize)));
+  numThreads = std::max(1u, std::min(numThreads, unsigned(chunks.size())));
+
+  std::vector<TextDemangler> demanglers;
+  demanglers.reserve(numThreads);
+  for (unsigned t = 0; t != numThreads; ++t)
+    demanglers.emplace_back(options);
+  std::vector<std::string> outputs(numThreads * 4);
+  for (size_t batchStart = 0; batchStart < chunks.size();
+       batchStart += outputs.size()) {
+    size_t batchSize = std::min(outputs.size(), chunks.size() - batchStart);
+    std::atomic<size_t> nextChunk(0);
+    auto work = [&](TextDemangler *demangler) {
+      for (size_t i = nextChunk++; i < batchSize; i = nextChunk++) {
+        llvm::raw_string_ostream os(outputs[i]);
+        demangler->demangleText(chunks[batchStart + i], os);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < numThreads; ++t)
+      threads.push_back(std::thread(work, &demanglers[t]));
+    work(&demanglers[0]);
+    for (std::thread &thread : threads)
+      thread.join();
+
+    for (size_t i = 0; i != batchSize; ++i) {
+      llvm::outs() << outputs[i];
+      outputs[i].clear();
+    }
+  }
+  llvm::outs().flush();
+
+  if (!PrintStats)
+    return;
+  size_t numSymbols = 0, numCacheHits = 0;
+  for (auto &demangler : demanglers) {
+    numSymbols += demangler.NumSymbols;
+    numCacheHits += demangler.NumCacheHits;
+  }
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  double megabytes = text.size() / (1024.0 * 1024.0);
+  llvm::errs() << "Demangled " << numSymbols << " symbols ("
+               << numCacheHits << " cached) in "
+               << llvm::format("%.2f", megabytes) << " MB of text on "
+               << numThreads << " threads in "
+               << llvm::format("%.3f", seconds) << "s: "
+               << llvm::format("%.2f", seconds > 0 ? megabytes / seconds : 0.0)
+               << " MB/s\n";
+}
+
 int main(int argc, char **argv) {
 #if defined(__CYGWIN__)
   // Cygwin clang 3.5.2 with '-O3' generates CRASHING BINARY,
@@ -111,23 +292,32 @@ int main(int argc, char **argv) {
 
   if (InputNames.empty()) {
     CompactMode = true;
-    auto input = llvm::MemoryBuffer::getSTDIN();
+    // Large files are mapped rather than read.
+    auto input = llvm::MemoryBuffer::getFileOrSTDIN(InputFilename);
     if (!input) {
       llvm::errs() << input.getError().message() << '\n';
       return EXIT_FAILURE;
     }
     llvm::StringRef inputContents = input.get()->getBuffer();
 
-    // This doesn't handle Unicode symbols, but maybe that's okay.
-    llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
-    llvm::SmallVector<llvm::StringRef, 1> matches;
-    while (maybeSymbol.match(inputContents, &matches)) {
-      llvm::outs() << substrBefore(inputContents, matches.front());
-      demangle(llvm::outs(), matches.front(), options);
-      inputContents = substrAfter(inputContents, matches.front());
+    if (BenchmarkIterations) {
+      // This doesn't handle Unicode symbols, but maybe that's okay.
+      llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
+      llvm::SmallVector<llvm::StringRef, 1> matches;
+      std::vector<llvm::StringRef> names;
+      while (maybeSymbol.match(inputContents, &matches)) {
+        names.push_back(matches.front());
+        inputContents = substrAfter(inputContents, matches.front());
+      }
+      benchmark(names, BenchmarkIterations, options);
+      return EXIT_SUCCESS;
     }
-    llvm::outs() << inputContents;
 
+    demangleText(inputContents, NumThreads, options);
+
+  } else if (BenchmarkIterations) {
+    std::vector<llvm::StringRef> names(InputNames.begin(), InputNames.end());
+    benchmark(names, BenchmarkIterations, options);
   } else {
     for (llvm::StringRef name : InputNames) {
       demangle(llvm::outs(), name, options);
@@ -29,6 +29,8 @@
 #include <algorithm>
 #include <iostream>
 #include <csignal>
+#include <sstream>
+#include <thread>
 
 using llvm::dyn_cast;
 using llvm::StringRef;
@@ -65,6 +67,12 @@ BinaryFilename("binary-filename", llvm::cl::desc("Filenames of the binary files"
 static llvm::cl::opt<std::string>
 Architecture("arch", llvm::cl::desc("Architecture to inspect in the binary"),
              llvm::cl::Required);
+
+static llvm::cl::opt<unsigned>
+NumThreads("num-threads",
+           llvm::cl::desc("Number of threads used to dump the reflection "
+                          "sections (0 to use one per hardware thread)"),
+           llvm::cl::init(0));
 } // end namespace options
 
 template<typename T>
@@ -132,9 +140,86 @@ static ReflectionInfo findReflectionInfo(const ObjectFile *objectFile) {
   };
 }
 
+template <typename Section>
+static size_t countRecords(ArrayRef<ReflectionInfo> infos,
+                           Section ReflectionInfo::*section) {
+  size_t count = 0;
+  for (auto &info : infos)
+    for (auto i = (info.*section).begin(), e = (info.*section).end();
+         i != e; ++i)
+      ++count;
+  return count;
+}
+
+/// Dump the reflection sections of all of the images, splitting the records
+/// of each section between worker threads. Each worker has its own
+/// TypeRefBuilder and writes into its own buffer, and the buffers are
+/// printed in order, so the output is the same as a dump on one thread.
+static void dumpAllSectionsInParallel(ArrayRef<ReflectionInfo> infos,
+                                      unsigned numThreads,
+                                      std::ostream &OS) {
+  using DumpFn = void (TypeRefBuilder::*)(std::ostream &, size_t, size_t);
+  struct SectionDump {
+    const char *Title;
+    size_t NumRecords;
+    DumpFn Dump;
+  };
+  SectionDump sections[] = {
+    {"FIELDS:\n"
+     "=======\n",
+     countRecords(infos, &ReflectionInfo::fieldmd),
+     &TypeRefBuilder::dumpFieldSection},
+    {"ASSOCIATED TYPES:\n"
+     "=================\n",
+     countRecords(infos, &ReflectionInfo::assocty),
+     &TypeRefBuilder::dumpAssociatedTypeSection},
+    {"BUILTIN TYPES:\n"
+     "==============\n",
+     countRecords(infos, &ReflectionInfo::builtin),
+     &TypeRefBuilder::dumpBuiltinTypeSection},
+    {"CAPTURE DESCRIPTORS:\n"
+     "====================\n",
+     countRecords(infos, &ReflectionInfo::capture),
+     &TypeRefBuilder::dumpCaptureSection},
+  };
+  const unsigned numSections = llvm::array_lengthof(sections);
+
+  // One buffer per section per worker.
+  std::vector<std::ostringstream> buffers(numSections * numThreads);
+
+  auto work = [&](unsigned thread) {
+    TypeRefBuilder builder;
+    for (auto &info : infos)
+      builder.addReflectionInfo(info);
+
+    for (unsigned i = 0; i != numSections; ++i) {
+      auto &section = sections[i];
+      size_t begin = section.NumRecords * thread / numThreads;
+      size_t end = section.NumRecords * (thread + 1) / numThreads;
+      if (begin != end)
+        (builder.*section.Dump)(buffers[i * numThreads + thread], begin, end);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned thread = 1; thread < numThreads; ++thread)
+    workers.emplace_back(work, thread);
+  work(0);
+  for (auto &worker : workers)
+    worker.join();
+
+  for (unsigned i = 0; i != numSections; ++i) {
+    OS << sections[i].Title;
+    for (unsigned thread = 0; thread != numThreads; ++thread)
+      OS << buffers[i * numThreads + thread].str();
+    OS << '\n';
+  }
+}
+
 static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
                                     StringRef arch,
                                     ActionType action,
+                                    unsigned numThreads,
                                     std::ostream &OS) {
   // Note: binaryOrError and objectOrError own the memory for our ObjectFile;
   // once they go out of scope, we can no longer do anything.
@@ -143,6 +228,7 @@ static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
 
   // Construct the TypeRefBuilder
   TypeRefBuilder builder;
+  std::vector<ReflectionInfo> infos;
 
   for (auto binaryFilename : binaryFilenames) {
     auto binaryOwner = unwrap(createBinary(binaryFilename));
@@ -161,7 +247,8 @@ static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
       objectFile = objectOwner.get();
     }
 
-    builder.addReflectionInfo(findReflectionInfo(objectFile));
+    infos.push_back(findReflectionInfo(objectFile));
+    builder.addReflectionInfo(infos.back());
 
     // Retain the objects that own section memory
     binaryOwners.push_back(std::move(binaryOwner));
@@ -171,7 +258,12 @@ static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
   switch (action) {
   case ActionType::DumpReflectionSections:
     // Dump everything
-    builder.dumpAllSections(OS);
+    if (numThreads == 0)
+      numThreads = std::max(std::thread::hardware_concurrency(), 1U);
+    if (numThreads == 1)
+      builder.dumpAllSections(OS);
+    else
+      dumpAllSectionsInParallel(infos, numThreads, OS);
     break;
   case ActionType::DumpTypeLowering: {
     for (std::string line; std::getline(std::cin, line); ) {
@@ -208,6 +300,7 @@ int main(int argc, char *argv[]) {
   return doDumpReflectionSections(options::BinaryFilename,
                                   options::Architecture,
                                   options::Action,
+                                  options::NumThreads,
                                   std::cout);
 }
 
@@ -0,0 +1,78 @@
+//===--- CacheTest.cpp - for swift/Basic/Cache.h --------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Cache.h"
+#include "gtest/gtest.h"
+
+using namespace swift::sys;
+
+TEST(Cache, SetGetRemove) {
+  Cache<int, int> C("swift.test.Cache");
+  EXPECT_FALSE(C.get(1).hasValue());
+
+  C.set(1, 10);
+  C.set(2, 20);
+  EXPECT_EQ(10, C.get(1).getValue());
+  EXPECT_EQ(20, C.get(2).getValue());
+
+  C.set(1, 11);
+  EXPECT_EQ(11, C.get(1).getValue());
+
+  EXPECT_TRUE(C.remove(1));
+  EXPECT_FALSE(C.remove(1));
+  EXPECT_FALSE(C.get(1).hasValue());
+
+  C.clear();
+  EXPECT_FALSE(C.get(2).hasValue());
+}
+
+// libcache decides on its own when to evict.
+#if !defined(__APPLE__)
+
+TEST(Cache, EvictsLeastRecentlyUsed) {
+  Cache<int, int> C("swift.test.Cache");
+  C.setCostLimit(3 * sizeof(int));
+
+  C.set(1, 10);
+  C.set(2, 20);
+  C.set(3, 30);
+  EXPECT_TRUE(C.get(1).hasValue());
+
+  // 2 is now the least recently used entry.
+  C.set(4, 40);
+  EXPECT_FALSE(C.get(2).hasValue());
+  EXPECT_TRUE(C.get(1).hasValue());
+  EXPECT_TRUE(C.get(3).hasValue());
+  EXPECT_TRUE(C.get(4).hasValue());
+
+  CacheStatistics Stats = C.getStatistics();
+  EXPECT_EQ(1u, Stats.Evictions);
+  EXPECT_EQ(3 * sizeof(int), Stats.TotalCost);
+  EXPECT_EQ(1u, Stats.Misses);
+  EXPECT_EQ(4u, Stats.Hits);
+}
+
+TEST(Cache, Purge) {
+  Cache<int, int> C("swift.test.Cache");
+  C.set(1, 10);
+  C.set(2, 20);
+
+  C.purge();
+  EXPECT_FALSE(C.get(1).hasValue());
+  EXPECT_FALSE(C.get(2).hasValue());
+
+  CacheStatistics Stats = C.getStatistics();
+  EXPECT_EQ(2u, Stats.Evictions);
+  EXPECT_EQ(0u, Stats.TotalCost);
+}
+
+#endif
@@ -208,3 +208,41 @@ TEST(ClusteredBitVector, FlipAllBig) {
   EXPECT_EQ(true, vec[7]);
   EXPECT_EQ(1u, vec.count());
 }
+
+TEST(ClusteredBitVector, ClearBitsSetIn) {
+  ClusteredBitVector vec, mask;
+  vec.appendSetBits(130);
+  mask.appendClearBits(130);
+  mask.setBit(3);
+  mask.setBit(64);
+  mask.setBit(129);
+  EXPECT_EQ(true, vec.anyCommon(mask));
+  vec.clearBitsSetIn(mask);
+  EXPECT_EQ(127u, vec.count());
+  EXPECT_EQ(false, vec[3]);
+  EXPECT_EQ(false, vec[64]);
+  EXPECT_EQ(false, vec[129]);
+  EXPECT_EQ(true, vec[128]);
+  EXPECT_EQ(false, vec.anyCommon(mask));
+
+  vec.clearAll();
+  EXPECT_EQ(130u, vec.size());
+  EXPECT_EQ(true, vec.none());
+}
+
+TEST(ClusteredBitVector, FindSet) {
+  ClusteredBitVector vec;
+  vec.appendClearBits(200);
+  EXPECT_FALSE(vec.findFirstSet().hasValue());
+  EXPECT_FALSE(vec.findLastSet().hasValue());
+
+  vec.setBit(5);
+  vec.setBit(70);
+  vec.setBit(191);
+  EXPECT_EQ(5u, vec.findFirstSet().getValue());
+  EXPECT_EQ(70u, vec.findNextSet(5).getValue());
+  EXPECT_EQ(70u, vec.findFirstSet(70).getValue());
+  EXPECT_EQ(191u, vec.findNextSet(70).getValue());
+  EXPECT_FALSE(vec.findNextSet(191).hasValue());
+  EXPECT_EQ(191u, vec.findLastSet().getValue());
+}
@@ -11,3 +11,25 @@ TEST(Demangle, DemangleWrappers) {
       demangleSymbolAsString(MangledName));
 }
 
+
+TEST(Demangle, NodeArena) {
+  using swift::Demangle::NodeArena;
+  using swift::Demangle::nodeToString;
+  const char *MangledName = "_TFC3foo3bar3basfT3zimCS_3zim_T_";
+  std::string Expected = nodeToString(demangleSymbolAsNode(MangledName));
+  EXPECT_EQ("foo.bar.bas (zim : foo.zim) -> ()", Expected);
+
+  EXPECT_EQ(nullptr, NodeArena::getCurrent());
+  {
+    NodeArena Outer;
+    EXPECT_EQ(&Outer, NodeArena::getCurrent());
+    {
+      NodeArena Inner;
+      EXPECT_EQ(&Inner, NodeArena::getCurrent());
+      EXPECT_EQ(Expected, nodeToString(demangleSymbolAsNode(MangledName)));
+    }
+    EXPECT_EQ(&Outer, NodeArena::getCurrent());
+    EXPECT_EQ(Expected, demangleSymbolAsString(MangledName));
+  }
+  EXPECT_EQ(nullptr, NodeArena::getCurrent());
+}
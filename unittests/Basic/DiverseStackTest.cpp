@@ -0,0 +1,63 @@
+//===--- DiverseStackTest.cpp ---------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/DiverseStack.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+
+namespace {
+struct Entry {
+  int Value;
+  char Padding[12];
+  Entry(int Value) : Value(Value) {}
+  size_t allocated_size() const { return sizeof(Entry); }
+};
+} // end anonymous namespace
+
+TEST(DiverseStack, ReserveKeepsContents) {
+  DiverseStack<Entry, 32> Stack;
+  Stack.push<Entry>(1);
+  Stack.push<Entry>(2);
+  EXPECT_EQ(32u, Stack.capacity_in_bytes());
+
+  Stack.reserve(100);
+  EXPECT_EQ(112u, Stack.capacity_in_bytes());
+  EXPECT_EQ(2 * sizeof(Entry), Stack.size_in_bytes());
+  EXPECT_EQ(2, Stack.top().Value);
+  Stack.pop();
+  EXPECT_EQ(1, Stack.top().Value);
+
+  // Reserving less than the capacity does nothing.
+  Stack.reserve(16);
+  EXPECT_EQ(112u, Stack.capacity_in_bytes());
+}
+
+TEST(DiverseStack, MoveAfterClearReusesStorage) {
+  DiverseStack<Entry, 32> Stack;
+  for (int i = 0; i != 10; ++i)
+    Stack.push<Entry>(i);
+  size_t Capacity = Stack.capacity_in_bytes();
+  EXPECT_LE(10 * sizeof(Entry), Capacity);
+
+  Stack.clear();
+  EXPECT_TRUE(Stack.empty());
+  EXPECT_EQ(Capacity, Stack.capacity_in_bytes());
+
+  DiverseStack<Entry, 32> Other(std::move(Stack));
+  EXPECT_TRUE(Other.empty());
+  EXPECT_EQ(Capacity, Other.capacity_in_bytes());
+  for (int i = 0; i != 10; ++i)
+    Other.push<Entry>(i);
+  EXPECT_EQ(Capacity, Other.capacity_in_bytes());
+  EXPECT_EQ(9, Other.top().Value);
+}
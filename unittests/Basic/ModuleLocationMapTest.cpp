@@ -0,0 +1,93 @@
+//===--- ModuleLocationMapTest.cpp - for ModuleLocationMap.h --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/ModuleLocationMap.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+
+namespace {
+/// A temporary directory holding the given empty files.
+class TempDirRAII {
+public:
+  llvm::SmallString<128> Path;
+
+  explicit TempDirRAII(ArrayRef<StringRef> Files) {
+    EXPECT_FALSE(llvm::sys::fs::createUniqueDirectory("module-locations",
+                                                      Path));
+    for (StringRef File : Files) {
+      llvm::SmallString<128> FilePath(Path);
+      llvm::sys::path::append(FilePath, File);
+      std::error_code EC;
+      llvm::raw_fd_ostream OS(FilePath, EC, llvm::sys::fs::F_None);
+      EXPECT_FALSE(EC);
+    }
+  }
+  ~TempDirRAII() {
+    llvm::sys::fs::remove_directories(Path);
+  }
+};
+} // end anonymous namespace
+
+TEST(ModuleLocationMap, ListsDirectories) {
+  TempDirRAII Dir({"Foo.swiftmodule", "Bar.framework"});
+  llvm::SmallString<128> Missing(Dir.Path);
+  llvm::sys::path::append(Missing, "missing");
+
+  ModuleLocationMap Map;
+  EXPECT_TRUE(Map.mayContain(Dir.Path, "Baz.swiftmodule"));
+
+  Map.addDirectory(Dir.Path);
+  Map.addDirectory(Missing);
+  EXPECT_TRUE(Map.mayContain(Dir.Path, "Foo.swiftmodule"));
+  EXPECT_TRUE(Map.mayContain(Dir.Path, "bar.FRAMEWORK"));
+  EXPECT_FALSE(Map.mayContain(Dir.Path, "Baz.swiftmodule"));
+  EXPECT_FALSE(Map.mayContain(Missing, "Foo.swiftmodule"));
+  EXPECT_TRUE(Map.mayContain("/not/listed", "Foo.swiftmodule"));
+}
+
+TEST(ModuleLocationMap, RoundTrips) {
+  TempDirRAII Dir({"Foo.swiftmodule"});
+
+  ModuleLocationMap Map;
+  Map.addDirectory(Dir.Path);
+  std::string Contents;
+  llvm::raw_string_ostream OS(Contents);
+  Map.write(OS);
+  OS.flush();
+
+  // The directory is gone, so only the map knows what was in it.
+  ASSERT_FALSE(llvm::sys::fs::remove_directories(Dir.Path));
+
+  ModuleLocationMap ReadMap;
+  EXPECT_FALSE(ReadMap.read(Contents));
+  EXPECT_TRUE(ReadMap.hasDirectory(Dir.Path));
+  EXPECT_TRUE(ReadMap.mayContain(Dir.Path, "Foo.swiftmodule"));
+  EXPECT_FALSE(ReadMap.mayContain(Dir.Path, "Bar.swiftmodule"));
+}
+
+TEST(ModuleLocationMap, RejectsMalformedMaps) {
+  ModuleLocationMap Map;
+  EXPECT_TRUE(Map.read(""));
+  EXPECT_TRUE(Map.read("swift-module-location-map 0\nd /a\n"));
+  EXPECT_TRUE(Map.read("swift-module-location-map 1\ne Foo.swiftmodule\n"));
+  EXPECT_TRUE(Map.read("swift-module-location-map 1\nd /a\nx /b\n"));
+  EXPECT_FALSE(Map.hasDirectory("/a"));
+
+  EXPECT_FALSE(Map.read("swift-module-location-map 1\nd /a\nu /b\n"));
+  EXPECT_FALSE(Map.mayContain("/a", "Foo.swiftmodule"));
+  EXPECT_TRUE(Map.mayContain("/b", "Foo.swiftmodule"));
+}
@@ -85,3 +85,53 @@ TEST(SourceManager, RangeContains) {
   EXPECT_TRUE(SM.rangeContains(R_ad, R_bc));
 }
 
+
+TEST(SourceManager, LineAndColumn) {
+  SourceManager SM;
+  StringRef Source = "a\nbc\n\ndef\r\ng\rh";
+  unsigned ID = SM.addMemBufferCopy(Source);
+  SourceLoc Start = SM.getLocForBufferStart(ID);
+
+  // Each offset with its expected line and column, as llvm::SourceMgr
+  // computes them.
+  std::vector<std::pair<unsigned, unsigned>> Expected = {
+    {1, 1}, {1, 2},
+    {2, 1}, {2, 2}, {2, 3},
+    {3, 1},
+    {4, 1}, {4, 2}, {4, 3}, {4, 4}, {4, 1},
+    {5, 1}, {5, 2}, {5, 1}, {5, 2},
+  };
+  ASSERT_EQ(Source.size() + 1, Expected.size());
+
+  // Query in source order, in reverse, and alternating between two buffers.
+  for (unsigned i = 0, e = Expected.size(); i != e; ++i)
+    EXPECT_EQ(Expected[i], SM.getLineAndColumn(Start.getAdvancedLoc(i)));
+  for (unsigned i = Expected.size(); i != 0; --i)
+    EXPECT_EQ(Expected[i - 1],
+              SM.getLineAndColumn(Start.getAdvancedLoc(i - 1), ID));
+
+  unsigned OtherID = SM.addMemBufferCopy("x\ny");
+  SourceLoc OtherStart = SM.getLocForBufferStart(OtherID);
+  for (unsigned i = 0, e = Expected.size(); i != e; ++i) {
+    EXPECT_EQ(Expected[i], SM.getLineAndColumn(Start.getAdvancedLoc(i)));
+    EXPECT_EQ(2U, SM.getLineNumber(OtherStart.getAdvancedLoc(2)));
+  }
+}
+
+TEST(SourceManager, LineAndColumnLargeBuffer) {
+  SourceManager SM;
+  std::string Source;
+  for (unsigned i = 0; i != 10000; ++i)
+    Source += "let x = 1\n";
+  unsigned ID = SM.addMemBufferCopy(Source);
+  SourceLoc Start = SM.getLocForBufferStart(ID);
+
+  for (unsigned i = 0, e = Source.size(); i != e; ++i) {
+    auto LineAndCol = SM.getLineAndColumn(Start.getAdvancedLoc(i), ID);
+    EXPECT_EQ(i / 10 + 1, LineAndCol.first);
+    EXPECT_EQ(i % 10 + 1, LineAndCol.second);
+  }
+  for (unsigned i = Source.size(); i != 0; i -= 8)
+    EXPECT_EQ((i - 1) / 10 + 1,
+              SM.getLineNumber(Start.getAdvancedLoc(i - 1), ID));
+}
@@ -0,0 +1,198 @@
+//===--- TaskQueueTests.cpp - for swift/Basic/TaskQueue.h -----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/TaskQueue.h"
+#include "swift/Basic/LLVM.h"
+#include "llvm/Config/config.h"
+#include "gtest/gtest.h"
+
+#if LLVM_ON_UNIX && !defined(__CYGWIN__)
+#include <algorithm>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace swift;
+using namespace swift::sys;
+
+namespace {
+/// Sets MAKEFLAGS for the lifetime of the object.
+class MakeFlagsRAII {
+  bool HadPrevious;
+  std::string Previous;
+
+public:
+  explicit MakeFlagsRAII(const char *Value) {
+    const char *Current = getenv("MAKEFLAGS");
+    HadPrevious = Current != nullptr;
+    if (HadPrevious)
+      Previous = Current;
+    if (Value)
+      setenv("MAKEFLAGS", Value, 1);
+    else
+      unsetenv("MAKEFLAGS");
+  }
+  ~MakeFlagsRAII() {
+    if (HadPrevious)
+      setenv("MAKEFLAGS", Previous.c_str(), 1);
+    else
+      unsetenv("MAKEFLAGS");
+  }
+};
+
+const char *const SleepArgs[] = { "-c", "sleep 0.2" };
+const char *const PrintMakeFlagsArgs[] = { "-c", "echo \"$MAKEFLAGS\"" };
+
+TEST(TaskQueue, JobServerClientTakesTokens) {
+  int Fds[2];
+  ASSERT_EQ(0, pipe(Fds));
+  ASSERT_EQ(1, write(Fds[1], "+", 1));
+
+  std::string MakeFlags = "-j --jobserver-auth=" + std::to_string(Fds[0]) +
+                          "," + std::to_string(Fds[1]);
+  MakeFlagsRAII Flags(MakeFlags.c_str());
+
+  TaskQueue TQ(4);
+  for (unsigned i = 0; i != 4; ++i)
+    TQ.addTask("/bin/sh", SleepArgs);
+
+  // One task runs on the implicit token, and one on the token in the pipe.
+  unsigned Running = 0, MaxRunning = 0;
+  bool Failed = TQ.execute(
+      [&](ProcessId, void *) { MaxRunning = std::max(MaxRunning, ++Running); },
+      [&](ProcessId, int, StringRef, const TaskResourceUsage &, void *) {
+        --Running;
+        return TaskFinishedResponse::ContinueExecution;
+      });
+  EXPECT_FALSE(Failed);
+  EXPECT_EQ(2U, MaxRunning);
+
+  // The token has been put back.
+  fcntl(Fds[0], F_SETFL, O_NONBLOCK);
+  char Tokens[4];
+  EXPECT_EQ(1, read(Fds[0], Tokens, sizeof(Tokens)));
+  EXPECT_EQ('+', Tokens[0]);
+
+  close(Fds[0]);
+  close(Fds[1]);
+}
+
+TEST(TaskQueue, JobServerClientIgnoresClosedFds) {
+  int Fds[2];
+  ASSERT_EQ(0, pipe(Fds));
+  std::string MakeFlags = "--jobserver-fds=" + std::to_string(Fds[0]) + "," +
+                          std::to_string(Fds[1]);
+  close(Fds[0]);
+  close(Fds[1]);
+  MakeFlagsRAII Flags(MakeFlags.c_str());
+
+  TaskQueue TQ(2);
+  for (unsigned i = 0; i != 2; ++i)
+    TQ.addTask("/bin/sh", SleepArgs);
+
+  unsigned Running = 0, MaxRunning = 0;
+  bool Failed = TQ.execute(
+      [&](ProcessId, void *) { MaxRunning = std::max(MaxRunning, ++Running); },
+      [&](ProcessId, int, StringRef, const TaskResourceUsage &, void *) {
+        --Running;
+        return TaskFinishedResponse::ContinueExecution;
+      });
+  EXPECT_FALSE(Failed);
+  EXPECT_EQ(2U, MaxRunning);
+}
+
+TEST(TaskQueue, JobServerServer) {
+  MakeFlagsRAII Flags(nullptr);
+
+  TaskQueue TQ(2);
+  TQ.setServesJobs();
+  TQ.addTask("/bin/sh", PrintMakeFlagsArgs);
+
+  std::string Output;
+  bool Failed = TQ.execute(nullptr,
+                           [&](ProcessId, int, StringRef TaskOutput,
+                               const TaskResourceUsage &, void *) {
+    Output = TaskOutput;
+    return TaskFinishedResponse::ContinueExecution;
+  });
+  EXPECT_FALSE(Failed);
+  EXPECT_NE(std::string::npos, Output.find("--jobserver-auth="));
+
+  // The environment is restored afterwards.
+  EXPECT_EQ(nullptr, getenv("MAKEFLAGS"));
+}
+
+TEST(TaskQueue, ReportsResourceUsage) {
+  TaskQueue TQ(1);
+  TQ.addTask("/bin/sh", SleepArgs);
+
+  TaskResourceUsage Usage;
+  bool Failed = TQ.execute(nullptr,
+                           [&](ProcessId, int, StringRef,
+                               const TaskResourceUsage &TaskUsage, void *) {
+    Usage = TaskUsage;
+    return TaskFinishedResponse::ContinueExecution;
+  });
+  EXPECT_FALSE(Failed);
+  EXPECT_TRUE(Usage.HasWallTime);
+  EXPECT_GE(Usage.WallTime, 200000U);
+  EXPECT_TRUE(Usage.HasProcessUsage);
+  EXPECT_NE(0U, Usage.MaxRSS);
+}
+TEST(TaskQueue, OutputDoesNotBlockOtherTasks) {
+  // The first task writes its output long before it exits. Reading that
+  // output must not keep the queue from noticing the second task exit.
+  const char *const SlowArgs[] = { "-c", "echo slow; sleep 1" };
+  const char *const FastArgs[] = { "-c", "sleep 0.2; echo fast" };
+  TaskQueue TQ(2);
+  TQ.addTask("/bin/sh", SlowArgs);
+  TQ.addTask("/bin/sh", FastArgs);
+
+  std::vector<std::string> Outputs;
+  bool Failed = TQ.execute(nullptr,
+                           [&](ProcessId, int, StringRef TaskOutput,
+                               const TaskResourceUsage &, void *) {
+    Outputs.push_back(TaskOutput);
+    return TaskFinishedResponse::ContinueExecution;
+  });
+  EXPECT_FALSE(Failed);
+  ASSERT_EQ(2U, Outputs.size());
+  EXPECT_EQ("fast\n", Outputs[0]);
+  EXPECT_EQ("slow\n", Outputs[1]);
+}
+
+TEST(TaskQueue, LaunchThroughput) {
+  // Not a pass/fail benchmark, but the time this takes is a measure of the
+  // cost of launching and reaping a task.
+  const unsigned NumTasks = 500;
+  const char *const TrueArgs[] = { "-c", "echo $$" };
+  TaskQueue TQ(8);
+  for (unsigned i = 0; i != NumTasks; ++i)
+    TQ.addTask("/bin/sh", TrueArgs);
+
+  unsigned NumFinished = 0;
+  bool Failed = TQ.execute(nullptr,
+                           [&](ProcessId Pid, int Result, StringRef TaskOutput,
+                               const TaskResourceUsage &, void *) {
+    EXPECT_EQ(0, Result);
+    EXPECT_EQ(std::to_string(Pid) + "\n", TaskOutput);
+    ++NumFinished;
+    return TaskFinishedResponse::ContinueExecution;
+  });
+  EXPECT_FALSE(Failed);
+  EXPECT_EQ(NumTasks, NumFinished);
+}
+} // end anonymous namespace
+
+#endif
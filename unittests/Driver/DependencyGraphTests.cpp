@@ -1,8 +1,11 @@
 #include "swift/Driver/DependencyGraph.h"
+#include "swift/Basic/ReferenceDependencies.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace swift;
 using LoadResult = DependencyGraphImpl::LoadResult;
+using reference_dependencies::Section;
 
 TEST(DependencyGraph, BasicLoad) {
   DependencyGraph<uintptr_t> graph;
@@ -790,3 +793,207 @@ TEST(DependencyGraph, ChainedExternalPreMarked) {
   EXPECT_TRUE(graph.isMarked(0));
   EXPECT_FALSE(graph.isMarked(1));
 }
+
+static std::string
+writeBinary(const reference_dependencies::Writer &writer) {
+  std::string result;
+  llvm::raw_string_ostream out(result);
+  writer.write(out);
+  return out.str();
+}
+
+TEST(DependencyGraph, BinaryDependent) {
+  DependencyGraph<uintptr_t> graph;
+
+  reference_dependencies::Writer provider;
+  provider.addEntry(Section::ProvidesTopLevel, "a");
+  provider.addMemberEntry(Section::ProvidesMember, "b", "bb");
+  provider.addEntry(Section::InterfaceHash, "hash");
+  std::string providerData = writeBinary(provider);
+
+  reference_dependencies::Writer memberDependent;
+  memberDependent.addMemberEntry(Section::DependsMember, "b", "bb");
+  reference_dependencies::Writer privateDependent;
+  privateDependent.addEntry(Section::DependsTopLevel, "a",
+                            /*isCascading=*/false);
+  privateDependent.addEntry(Section::ProvidesTopLevel, "c");
+  reference_dependencies::Writer indirectDependent;
+  indirectDependent.addEntry(Section::DependsTopLevel, "c");
+
+  EXPECT_EQ(graph.loadFromString(0, providerData), LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, writeBinary(memberDependent)),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, writeBinary(privateDependent)),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, writeBinary(indirectDependent)),
+            LoadResult::UpToDate);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(contains(marked, 1));
+  EXPECT_TRUE(contains(marked, 2));
+  EXPECT_FALSE(graph.isMarked(3));
+
+  // Reloading the same file changes nothing.
+  EXPECT_EQ(graph.loadFromString(0, providerData), LoadResult::UpToDate);
+
+  reference_dependencies::Writer changedProvider;
+  changedProvider.addEntry(Section::ProvidesTopLevel, "a");
+  changedProvider.addEntry(Section::InterfaceHash, "other hash");
+  EXPECT_EQ(graph.loadFromString(0, writeBinary(changedProvider)),
+            LoadResult::AffectsDownstream);
+}
+
+TEST(DependencyGraph, BinaryExternal) {
+  DependencyGraph<uintptr_t> graph;
+
+  reference_dependencies::Writer writer;
+  writer.addEntry(Section::DependsExternal, "/foo");
+  writer.addEntry(Section::DependsExternal, "/bar");
+  EXPECT_EQ(graph.loadFromString(0, writeBinary(writer)),
+            LoadResult::UpToDate);
+
+  EXPECT_TRUE(contains(graph.getExternalDependencies(), "/foo"));
+  EXPECT_TRUE(contains(graph.getExternalDependencies(), "/bar"));
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markExternal(marked, "/bar");
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_TRUE(graph.isMarked(0));
+}
+
+TEST(DependencyGraph, BinaryMalformed) {
+  DependencyGraph<uintptr_t> graph;
+
+  reference_dependencies::Writer writer;
+  writer.addEntry(Section::ProvidesTopLevel, "a");
+  std::string data = writeBinary(writer);
+
+  std::string truncated = data.substr(0, data.size() - 1);
+  EXPECT_EQ(graph.loadFromString(0, truncated), LoadResult::HadError);
+
+  std::string wrongVersion = data;
+  wrongVersion[4] += 1;
+  EXPECT_EQ(graph.loadFromString(1, wrongVersion), LoadResult::HadError);
+
+  std::string badSection = data;
+  badSection[reference_dependencies::HeaderSize] = char(0xFF);
+  EXPECT_EQ(graph.loadFromString(2, badSection), LoadResult::HadError);
+
+  EXPECT_EQ(graph.loadFromString(3, data), LoadResult::UpToDate);
+}
+
+TEST(DependencyGraph, UnchangedFingerprints) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b, c]\n"
+                                 "provides-fingerprints: "
+                                 "[[1, provides-top-level, a], "
+                                 "[2, provides-top-level, b]]\n"
+                                 "interface-hash: before"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, "depends-top-level: [c]"),
+            LoadResult::UpToDate);
+
+  // Only the fingerprint of 'b' changes. 'c' has no fingerprint, so it is
+  // always considered changed.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b, c]\n"
+                                 "provides-fingerprints: "
+                                 "[[1, provides-top-level, a], "
+                                 "[3, provides-top-level, b]]\n"
+                                 "interface-hash: after"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(contains(marked, 2));
+  EXPECT_TRUE(contains(marked, 3));
+  EXPECT_FALSE(graph.isMarked(1));
+}
+
+TEST(DependencyGraph, UnchangedFingerprintsOnlyFromStartNode) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a]\n"
+                                 "provides-fingerprints: "
+                                 "[[1, provides-top-level, a]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a]\n"
+                                 "provides-fingerprints: "
+                                 "[[2, provides-top-level, a]]"),
+            LoadResult::UpToDate);
+
+  const char *providesB =
+      "depends-top-level: [a]\n"
+      "provides-top-level: [b]\n"
+      "provides-fingerprints: [[1, provides-top-level, b]]";
+  EXPECT_EQ(graph.loadFromString(1, providesB), LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, providesB), LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+
+  // Node 1 hasn't been rebuilt yet, so its entries are followed even though
+  // their fingerprints are unchanged.
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(contains(marked, 1));
+  EXPECT_TRUE(contains(marked, 2));
+}
+
+TEST(DependencyGraph, BinaryFingerprints) {
+  DependencyGraph<uintptr_t> graph;
+
+  reference_dependencies::Writer before;
+  before.addEntry(Section::ProvidesNominal, "a");
+  before.addFingerprint("1");
+  before.addMemberEntry(Section::ProvidesMember, "a", "aa");
+  before.addFingerprint("1");
+  reference_dependencies::Writer after;
+  after.addEntry(Section::ProvidesNominal, "a");
+  after.addFingerprint("1");
+  after.addMemberEntry(Section::ProvidesMember, "a", "aa");
+  after.addFingerprint("2");
+
+  EXPECT_EQ(graph.loadFromString(0, writeBinary(before)),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-nominal: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-member: [[a, aa]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(0, writeBinary(after)),
+            LoadResult::UpToDate);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_EQ(2u, marked.front());
+  EXPECT_FALSE(graph.isMarked(1));
+}
+
+TEST(DependencyGraph, FingerprintWithoutEntry) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-fingerprints: "
+                                 "[[1, provides-top-level, a]]\n"),
+            LoadResult::HadError);
+
+  reference_dependencies::Writer writer;
+  writer.addEntry(Section::ProvidesTopLevel, "a");
+  writer.addFingerprint("1");
+  std::string data = writeBinary(writer);
+  // Turn the provides record into a depends record.
+  data[reference_dependencies::HeaderSize] = char(Section::DependsTopLevel);
+  EXPECT_EQ(graph.loadFromString(1, data), LoadResult::HadError);
+}
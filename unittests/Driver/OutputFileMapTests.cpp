@@ -0,0 +1,70 @@
+#include "swift/Driver/OutputFileMap.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+using namespace swift::driver;
+
+static StringRef getOutput(const OutputFileMap &OFM, StringRef Input,
+                           types::ID Kind) {
+  const TypeToPathMap *Map = OFM.getOutputMapForInput(Input);
+  if (!Map)
+    return "<no input>";
+  auto Iter = Map->find(Kind);
+  if (Iter == Map->end())
+    return "<no output>";
+  return Iter->second;
+}
+
+TEST(OutputFileMap, BasicJSON) {
+  auto OFM = OutputFileMap::loadFromBuffer(
+      "{\n"
+      "  \"\": {\"swift-dependencies\": \"/build/master.swiftdeps\"},\n"
+      "  \"/src/a.swift\": {\n"
+      "    \"object\": \"/build/a.o\",\n"
+      "    \"swift-dependencies\": \"/build/a.swiftdeps\",\n"
+      "    \"completely-bogus-type\": \"/build/a.bogus\"\n"
+      "  },\n"
+      "  \"/src/b.swift\": {}\n"
+      "}\n");
+  ASSERT_TRUE(OFM != nullptr);
+
+  EXPECT_EQ("/build/master.swiftdeps",
+            getOutput(*OFM, "", types::TY_SwiftDeps));
+  EXPECT_EQ("/build/a.o", getOutput(*OFM, "/src/a.swift", types::TY_Object));
+  EXPECT_EQ("/build/a.swiftdeps",
+            getOutput(*OFM, "/src/a.swift", types::TY_SwiftDeps));
+  EXPECT_EQ(2U, OFM->getOutputMapForInput("/src/a.swift")->size());
+  EXPECT_EQ(0U, OFM->getOutputMapForInput("/src/b.swift")->size());
+  EXPECT_EQ(nullptr, OFM->getOutputMapForInput("/src/c.swift"));
+}
+
+TEST(OutputFileMap, Escapes) {
+  auto OFM = OutputFileMap::loadFromBuffer(
+      "{\"C:\\\\src\\/a \\\"1\\\".swift\": {\"object\": \"a\\tb.o\"},"
+      " \"\\u00e9.swift\": {\"object\": \"\\u00e9.o\"}}");
+  ASSERT_TRUE(OFM != nullptr);
+
+  EXPECT_EQ("a\tb.o",
+            getOutput(*OFM, "C:\\src/a \"1\".swift", types::TY_Object));
+  EXPECT_EQ("\xc3\xa9.o", getOutput(*OFM, "\xc3\xa9.swift", types::TY_Object));
+}
+
+TEST(OutputFileMap, YAML) {
+  auto OFM = OutputFileMap::loadFromBuffer(
+      "/src/a.swift:\n"
+      "  object: /build/a.o\n"
+      "'/src/b.swift': {object: '/build/b.o'}\n");
+  ASSERT_TRUE(OFM != nullptr);
+
+  EXPECT_EQ("/build/a.o", getOutput(*OFM, "/src/a.swift", types::TY_Object));
+  EXPECT_EQ("/build/b.o", getOutput(*OFM, "/src/b.swift", types::TY_Object));
+}
+
+TEST(OutputFileMap, Invalid) {
+  EXPECT_EQ(nullptr, OutputFileMap::loadFromBuffer(""));
+  EXPECT_EQ(nullptr, OutputFileMap::loadFromBuffer("[]"));
+  EXPECT_EQ(nullptr,
+            OutputFileMap::loadFromBuffer("{\"/src/a.swift\": \"/build/a.o\"}"));
+  EXPECT_EQ(nullptr,
+            OutputFileMap::loadFromBuffer("{\"/src/a.swift\": {\"object\": ["));
+}
@@ -111,6 +111,56 @@ TEST_F(LexerTest, StringLiteralWithNUL1) {
   EXPECT_EQ(Toks[1].getLength(), 0U);
 }
 
+TEST_F(LexerTest, LongComments) {
+  const char *Source =
+      "// A line comment that is long enough to be scanned a word at a time\n"
+      "/* A block comment /* with a nested one that is also long */ and\n"
+      "   more text after it, \xC3\xA9 and a * and / on their own */\n"
+      "(/*01234567*/)";
+  std::vector<tok> ExpectedTokens{
+    tok::comment, tok::comment, tok::l_paren, tok::comment, tok::r_paren
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens,
+                                     /*KeepComments=*/true);
+  EXPECT_EQ(Toks[0].getLength(), 69U);
+  EXPECT_EQ("/*01234567*/", Toks[3].getText());
+  EXPECT_TRUE(Toks[2].isAtStartOfLine());
+}
+
+TEST_F(LexerTest, LongStringLiterals) {
+  const char *Source =
+      "\"a string literal that's long, with 'quotes' in it\" "
+      "\"01234567\\\"89abcdef\\(x)01234567\" "
+      "'a single-quoted literal with \"quotes\" in it'";
+  std::vector<tok> ExpectedTokens{
+    tok::string_literal, tok::string_literal, tok::string_literal
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ("\"a string literal that's long, with 'quotes' in it\"",
+            Toks[0].getText());
+  EXPECT_EQ("\"01234567\\\"89abcdef\\(x)01234567\"", Toks[1].getText());
+}
+
+TEST_F(LexerTest, LongStringLiteralWithNewline) {
+  const char *Source = "\"a string literal without an end\nfoo";
+  std::vector<tok> ExpectedTokens{ tok::unknown, tok::identifier };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ(Toks[0].getLength(), 32U);
+  EXPECT_TRUE(Toks[1].isAtStartOfLine());
+}
+
+TEST_F(LexerTest, LongWhitespace) {
+  const char *Source = "aaa                  \t  \t   bbb\n                ccc";
+  std::vector<tok> ExpectedTokens{
+    tok::identifier, tok::identifier, tok::identifier
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
+  EXPECT_EQ("bbb", Toks[1].getText());
+  EXPECT_FALSE(Toks[1].isAtStartOfLine());
+  EXPECT_EQ("ccc", Toks[2].getText());
+  EXPECT_TRUE(Toks[2].isAtStartOfLine());
+}
+
 TEST_F(LexerTest, RestoreBasic) {
   const char *Source = "aaa \t\0 bbb ccc";
 
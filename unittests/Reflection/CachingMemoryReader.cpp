@@ -0,0 +1,138 @@
+//===--- CachingMemoryReader.cpp - CachingMemoryReader tests --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Remote/CachingMemoryReader.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+using namespace remote;
+
+namespace {
+
+/// A fake address space of a few pages starting at address 0x1000, in
+/// which every byte holds the low bits of its address.
+class FakeMemoryReader : public MemoryReader {
+public:
+  static const uint64_t Start = 0x1000;
+  static const uint64_t End = 0x4000;
+
+  unsigned Reads = 0;
+  unsigned Batches = 0;
+
+  uint8_t getPointerSize() override { return sizeof(void *); }
+  uint8_t getSizeSize() override { return sizeof(size_t); }
+
+  RemoteAddress getSymbolAddress(const std::string &name) override {
+    return RemoteAddress(uint64_t(0));
+  }
+
+  bool readBytes(RemoteAddress address, uint8_t *dest,
+                 uint64_t size) override {
+    ++Reads;
+    uint64_t start = address.getAddressData();
+    if (start < Start || start + size > End)
+      return false;
+    for (uint64_t i = 0; i != size; ++i)
+      dest[i] = uint8_t(start + i);
+    return true;
+  }
+
+  bool readBatch(llvm::ArrayRef<ReadRequest> requests) override {
+    ++Batches;
+    return MemoryReader::readBatch(requests);
+  }
+
+  bool readString(RemoteAddress address, std::string &dest) override {
+    return false;
+  }
+};
+
+} // end anonymous namespace
+
+TEST(CachingMemoryReaderTest, ReadsWholePagesOnce) {
+  auto fake = std::make_shared<FakeMemoryReader>();
+  CachingMemoryReader reader(fake, 0x1000);
+
+  uint32_t value;
+  ASSERT_TRUE(reader.readInteger(RemoteAddress(uint64_t(0x1010)), &value));
+  EXPECT_EQ(0x13121110U, value);
+  ASSERT_TRUE(reader.readInteger(RemoteAddress(uint64_t(0x1020)), &value));
+  EXPECT_EQ(0x23222120U, value);
+  EXPECT_EQ(1U, fake->Reads);
+
+  // A read across a page boundary needs the next page too.
+  ASSERT_TRUE(reader.readInteger(RemoteAddress(uint64_t(0x1ffe)), &value));
+  EXPECT_EQ(0x0100fffeU, value);
+  EXPECT_EQ(2U, fake->Reads);
+
+  auto &stats = reader.getStatistics();
+  EXPECT_EQ(12U, stats.BytesRequested);
+  EXPECT_EQ(0x2000U, stats.BytesRead);
+  EXPECT_EQ(2U, stats.PageMisses);
+  EXPECT_EQ(2U, stats.PageHits);
+}
+
+TEST(CachingMemoryReaderTest, FallsBackForUnreadablePages) {
+  auto fake = std::make_shared<FakeMemoryReader>();
+  CachingMemoryReader reader(fake, 0x1000);
+
+  // The page at 0x4000 can't be read, so the part of the read in the page
+  // before it comes from the cache and the rest fails.
+  uint32_t value;
+  EXPECT_FALSE(reader.readInteger(RemoteAddress(uint64_t(0x3ffe)), &value));
+  uint16_t half;
+  ASSERT_TRUE(reader.readInteger(RemoteAddress(uint64_t(0x3ffe)), &half));
+  EXPECT_EQ(0xfffeU, half);
+}
+
+TEST(CachingMemoryReaderTest, BatchesMissingPages) {
+  auto fake = std::make_shared<FakeMemoryReader>();
+  CachingMemoryReader reader(fake, 0x1000);
+
+  uint8_t a, b, c;
+  MemoryReader::ReadRequest requests[] = {
+    {RemoteAddress(uint64_t(0x1001)), &a, 1},
+    {RemoteAddress(uint64_t(0x3002)), &b, 1},
+    {RemoteAddress(uint64_t(0x1003)), &c, 1},
+  };
+  ASSERT_TRUE(reader.readBatch(requests));
+  EXPECT_EQ(0x01U, a);
+  EXPECT_EQ(0x02U, b);
+  EXPECT_EQ(0x03U, c);
+  EXPECT_EQ(1U, fake->Batches);
+  EXPECT_EQ(2U, fake->Reads);
+
+  // Everything is cached now.
+  ASSERT_TRUE(reader.readBatch(requests));
+  EXPECT_EQ(1U, fake->Batches);
+  EXPECT_EQ(2U, fake->Reads);
+}
+
+TEST(CachingMemoryReaderTest, EvictsOldestPage) {
+  auto fake = std::make_shared<FakeMemoryReader>();
+  CachingMemoryReader reader(fake, 0x1000, /*maxPages*/ 2);
+
+  uint8_t byte;
+  ASSERT_TRUE(reader.readInteger(RemoteAddress(uint64_t(0x1000)), &byte));
+  ASSERT_TRUE(reader.readInteger(RemoteAddress(uint64_t(0x2000)), &byte));
+  ASSERT_TRUE(reader.readInteger(RemoteAddress(uint64_t(0x3000)), &byte));
+  EXPECT_EQ(3U, fake->Reads);
+
+  ASSERT_TRUE(reader.readInteger(RemoteAddress(uint64_t(0x3001)), &byte));
+  EXPECT_EQ(3U, fake->Reads);
+  ASSERT_TRUE(reader.readInteger(RemoteAddress(uint64_t(0x1001)), &byte));
+  EXPECT_EQ(4U, fake->Reads);
+
+  reader.flush();
+  ASSERT_TRUE(reader.readInteger(RemoteAddress(uint64_t(0x3001)), &byte));
+  EXPECT_EQ(5U, fake->Reads);
+}
@@ -38,6 +38,22 @@ TEST(TypeRefTest, UniqueBuiltinTypeRef) {
   EXPECT_NE(BI2, BI3);
 }
 
+TEST(TypeRefTest, UniqueAcrossKinds) {
+  TypeRefBuilder Builder;
+
+  // TypeRefs of different kinds built from the same data are different.
+  auto BI = Builder.createBuiltinType(ABC);
+  auto FC = Builder.createForeignClassType(ABC);
+  auto OC = Builder.createObjCClassType(ABC);
+
+  EXPECT_NE(static_cast<const TypeRef *>(BI), FC);
+  EXPECT_NE(static_cast<const TypeRef *>(BI), OC);
+  EXPECT_NE(static_cast<const TypeRef *>(FC), OC);
+
+  EXPECT_EQ(FC, Builder.createForeignClassType(ABC));
+  EXPECT_EQ(OC, Builder.createObjCClassType(ABC));
+}
+
 TEST(TypeRefTest, UniqueNominalTypeRef) {
   TypeRefBuilder Builder;
 
@@ -11,9 +11,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "SourceKit/Support/FuzzyStringMatcher.h"
+#include "llvm/ADT/StringRef.h"
 #include "gtest/gtest.h"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
 
 using FuzzyStringMatcher = SourceKit::FuzzyStringMatcher;
+using llvm::StringRef;
 
 TEST(FuzzyStringMatcher, BasicMatching) {
   {
@@ -315,4 +321,48 @@ TEST(FuzzyStringMatcher, ShortUnconnectedMatches) {
   FuzzyStringMatcher m("abcd");
   EXPECT_GT(m.scoreCandidate("xaxbxcdxxxxxx"), m.scoreCandidate("xaxbxcxd"));
   EXPECT_GT(m.scoreCandidate("xaxbxc_d"), m.scoreCandidate("xaxbxcxd"));
-}
\ No newline at end of file
+}
+TEST(FuzzyStringMatcher, Prefilter) {
+  FuzzyStringMatcher m("abc");
+  EXPECT_TRUE(m.mayMatchCandidate("xaxbxc"));
+  EXPECT_TRUE(m.mayMatchCandidate("CBA")); // order is not checked
+  EXPECT_TRUE(m.mayMatchCandidate("someLongerNameWithABC"));
+  EXPECT_FALSE(m.mayMatchCandidate("ab"));
+  EXPECT_FALSE(m.mayMatchCandidate("someLongerNameWithoutIt"));
+  EXPECT_EQ(0.0, m.scoreCandidate("someLongerNameWithoutIt"));
+}
+
+TEST(FuzzyStringMatcher, ScoreCandidates) {
+  FuzzyStringMatcher m("abc");
+  StringRef candidates[] = {"abc", "xaxbxc", "xyz", "a_b_c"};
+  double scores[4];
+  m.scoreCandidates(candidates, scores);
+  for (unsigned i = 0; i < 4; ++i)
+    EXPECT_EQ(m.scoreCandidate(candidates[i]), scores[i]);
+  EXPECT_EQ(0.0, scores[2]);
+}
+
+// A microbenchmark for scoring a module-sized list of candidates, most of
+// which do not match.
+TEST(FuzzyStringMatcher, ScoreCandidatesThroughput) {
+  const unsigned numCandidates = 50000;
+  std::vector<std::string> names;
+  names.reserve(numCandidates);
+  for (unsigned i = 0; i < numCandidates; ++i)
+    names.push_back("someMethodName" + std::to_string(i) + "WithArguments");
+  names[numCandidates / 2] = "tableViewCellForRowAtIndexPath";
+  std::vector<StringRef> candidates(names.begin(), names.end());
+  std::vector<double> scores(numCandidates);
+
+  FuzzyStringMatcher m("tvcell");
+  auto start = std::chrono::steady_clock::now();
+  m.scoreCandidates(candidates, scores);
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start).count();
+
+  unsigned numMatches = std::count_if(scores.begin(), scores.end(),
+                                      [](double score) { return score > 0; });
+  EXPECT_EQ(1u, numMatches);
+  printf("FuzzyStringMatcher: %u candidates, %8lld us\n", numCandidates,
+         (long long)elapsed);
+}
@@ -43,3 +43,32 @@ TEST(EditableTextBuffer, Updates) {
 
   EXPECT_EQ(Buf->getFilename(), "/a/test");
 }
+
+TEST(EditableTextBuffer, IncrementalSnapshots) {
+  EditableTextBufferManager BufMgr;
+  EditableTextBufferRef EdBuf = BufMgr.getOrCreateBuffer("/a/test", "abc");
+  ImmutableTextSnapshotRef Old = EdBuf->insert(3, "d");
+  EXPECT_EQ(Old->getBuffer()->getText(), "abcd");
+
+  EdBuf->insert(4, "e");
+  ImmutableTextSnapshotRef New = EdBuf->erase(0, 1);
+  EXPECT_EQ(New->getBuffer()->getText(), "bcde");
+
+  // An older snapshot is still rebuilt from its own history.
+  EdBuf->replace(0, 1, "x");
+  EXPECT_EQ(Old->getBuffer()->getText(), "abcd");
+  EXPECT_EQ(EdBuf->getBuffer()->getText(), "xcde");
+}
+
+TEST(ImmutableTextBuffer, LineAndColumn) {
+  ImmutableTextBufferRef Buf =
+      new ImmutableTextBuffer("/a/test", "ab\ncd\r\n\nxyz", 0);
+  EXPECT_EQ(std::make_pair(1u, 1u), Buf->getLineAndColumn(0));
+  EXPECT_EQ(std::make_pair(1u, 3u), Buf->getLineAndColumn(2));
+  EXPECT_EQ(std::make_pair(2u, 1u), Buf->getLineAndColumn(3));
+  EXPECT_EQ(std::make_pair(2u, 3u), Buf->getLineAndColumn(5));
+  EXPECT_EQ(std::make_pair(2u, 1u), Buf->getLineAndColumn(6));
+  EXPECT_EQ(std::make_pair(3u, 1u), Buf->getLineAndColumn(7));
+  EXPECT_EQ(std::make_pair(4u, 4u), Buf->getLineAndColumn(11));
+  EXPECT_EQ(std::make_pair(0u, 0u), Buf->getLineAndColumn(12));
+}
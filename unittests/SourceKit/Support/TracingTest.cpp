@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "SourceKit/Support/Tracing.h"
+#include "gtest/gtest.h"
+
+using namespace SourceKit;
+
+TEST(TracingStatistics, Percentiles) {
+  for (uint64_t Value = 1; Value <= 100; ++Value)
+    trace::recordOperationLatency(trace::OperationKind::IndexModule, Value);
+
+  trace::Statistics Stats = trace::getStatistics();
+  const trace::LatencyStatistics &Index =
+      Stats.Operations[unsigned(trace::OperationKind::IndexModule)];
+  EXPECT_EQ(100u, Index.Count);
+  EXPECT_EQ(100u, Index.Max);
+  // The percentiles are bucket upper bounds, at most 25% above the exact
+  // value.
+  EXPECT_LE(50u, Index.P50);
+  EXPECT_GE(62u, Index.P50);
+  EXPECT_LE(90u, Index.P90);
+  EXPECT_GE(100u, Index.P90);
+  EXPECT_LE(99u, Index.P99);
+  EXPECT_GE(100u, Index.P99);
+
+  EXPECT_EQ(0u, Stats.Operations[unsigned(trace::OperationKind::FormatText)]
+                    .Count);
+}
+
+TEST(TracingStatistics, LargeValues) {
+  trace::recordASTQueueWait(0);
+  trace::recordASTQueueWait(UINT64_MAX);
+  trace::LatencyStatistics Wait = trace::getStatistics().ASTQueueWait;
+  EXPECT_EQ(2u, Wait.Count);
+  EXPECT_EQ(0u, Wait.P50);
+  EXPECT_EQ(UINT64_MAX, Wait.P99);
+  EXPECT_EQ(UINT64_MAX, Wait.Max);
+}
+
+TEST(TracingStatistics, TracedOperation) {
+  uint64_t Before = trace::getStatistics()
+      .Operations[unsigned(trace::OperationKind::RelatedIdents)].Count;
+  {
+    trace::TracedOperation TracedOp(trace::OperationKind::RelatedIdents);
+    EXPECT_FALSE(TracedOp.enabled());
+    TracedOp.finish();
+  }
+  uint64_t After = trace::getStatistics()
+      .Operations[unsigned(trace::OperationKind::RelatedIdents)].Count;
+  EXPECT_EQ(Before + 1, After);
+}
+
+TEST(TracingStatistics, ASTRequests) {
+  trace::Statistics Before = trace::getStatistics();
+  trace::recordASTRequest(/*CacheHit=*/true);
+  trace::recordASTRequest(/*CacheHit=*/true);
+  trace::recordASTRequest(/*CacheHit=*/false);
+  trace::Statistics After = trace::getStatistics();
+  EXPECT_EQ(Before.ASTCacheHits + 2, After.ASTCacheHits);
+  EXPECT_EQ(Before.ASTBuilds + 1, After.ASTBuilds);
+}
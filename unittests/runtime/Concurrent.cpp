@@ -0,0 +1,158 @@
+//===--- Concurrent.cpp - Concurrent data structure tests -----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Concurrent.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+struct IntEntry {
+  size_t Key;
+  IntEntry(size_t key) : Key(key) {}
+  int compareWithKey(size_t key) const {
+    return (key == Key ? 0 : (key < Key ? -1 : 1));
+  }
+  long getKeyIntValueForDump() const { return Key; }
+  static size_t getKeyHash(size_t key) {
+    // Spread sequential keys across the table.
+    return key * 0x9E3779B97F4A7C15ull;
+  }
+  static size_t getExtraAllocationSize(size_t key) { return 0; }
+};
+}
+
+TEST(Concurrent, ConcurrentMapGrowth) {
+  const size_t numElem = 10000;
+  const unsigned numThreads = 8;
+
+  ConcurrentMap<IntEntry> Map;
+  std::atomic<size_t> numInserted(0);
+
+  // Every thread inserts every key, so each key races against the others
+  // while the table is repeatedly grown underneath them.
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < numThreads; ++t) {
+    threads.push_back(std::thread([&, t] {
+      for (size_t i = 0; i < numElem; ++i) {
+        size_t key = (i + t * 977) % numElem;
+        auto result = Map.getOrInsert(key);
+        EXPECT_EQ(key, result.first->Key);
+        if (result.second)
+          ++numInserted;
+      }
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  // Each key was inserted exactly once, and entries didn't move.
+  EXPECT_EQ(numElem, numInserted.load());
+  for (size_t i = 0; i < numElem; ++i) {
+    auto entry = Map.find(i);
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(i, entry->Key);
+    EXPECT_EQ(entry, Map.getOrInsert(i).first);
+  }
+  EXPECT_FALSE(Map.find(numElem));
+}
+
+// Keys inserted before a table is grown must stay visible to lookups that
+// race with the growth.
+TEST(Concurrent, ConcurrentMapFindDuringGrowth) {
+  const size_t numElem = 20000;
+  const size_t numPresent = 8;
+
+  ConcurrentMap<IntEntry> Map;
+  for (size_t i = 0; i < numPresent; ++i)
+    Map.getOrInsert(i);
+
+  std::atomic<bool> done(false);
+  std::thread writer([&] {
+    for (size_t i = numPresent; i < numElem; ++i)
+      Map.getOrInsert(i);
+    done = true;
+  });
+
+  size_t misses = 0;
+  while (!done) {
+    for (size_t i = 0; i < numPresent; ++i)
+      if (!Map.find(i))
+        ++misses;
+  }
+  writer.join();
+  EXPECT_EQ(0u, misses);
+}
+
+// A lookup that started before the table was grown must find keys that
+// were inserted into the replacement table.
+TEST(Concurrent, ConcurrentMapFindInReplacedTable) {
+  const size_t numElem = 100;
+
+  ConcurrentMap<IntEntry> Map;
+  Map.getOrInsert(size_t(0));
+  auto snapshot = Map.getSnapshot();
+
+  // The first table has 16 slots, so this grows it several times.
+  for (size_t i = 1; i < numElem; ++i)
+    Map.getOrInsert(i);
+
+  for (size_t i = 0; i < numElem; ++i) {
+    IntEntry *entry = Map.find(i, snapshot);
+    ASSERT_TRUE(entry != nullptr);
+    EXPECT_EQ(i, entry->Key);
+  }
+  EXPECT_FALSE(Map.find(numElem, snapshot));
+}
+
+// A microbenchmark for the read path. Since lookups never take a lock or
+// write to shared memory, the total throughput should grow with the number
+// of threads until we run out of cores.
+TEST(Concurrent, ConcurrentMapLookupScaling) {
+  const size_t numElem = 4096;
+  const size_t lookupsPerThread = 1 << 20;
+
+  ConcurrentMap<IntEntry> Map;
+  for (size_t i = 0; i < numElem; ++i)
+    Map.getOrInsert(i);
+
+  for (unsigned numThreads = 1; numThreads <= 64; numThreads *= 2) {
+    std::atomic<bool> go(false);
+    std::atomic<size_t> numFound(0);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+      threads.push_back(std::thread([&, t] {
+        while (!go.load(std::memory_order_acquire))
+          std::this_thread::yield();
+        size_t found = 0;
+        for (size_t i = 0; i < lookupsPerThread; ++i)
+          if (Map.find((i * 31 + t) % numElem))
+            ++found;
+        numFound += found;
+      }));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto &thread : threads)
+      thread.join();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(numThreads * lookupsPerThread, numFound.load());
+    printf("ConcurrentMap lookups: %2u threads, %8lld us, %7.1f Mlookups/s\n",
+           numThreads, (long long)elapsed,
+           elapsed ? double(numThreads * lookupsPerThread) / elapsed : 0.0);
+  }
+}
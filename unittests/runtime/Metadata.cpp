@@ -13,6 +13,9 @@
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Concurrent.h"
 #include "gtest/gtest.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iterator>
 #include <functional>
 #include <sys/mman.h>
@@ -167,17 +170,20 @@ struct GenericMetadataTest {
   Instance Template;
 };
 
+static Metadata *createMetadataTest1(GenericMetadata *pattern,
+                                     const void *args) {
+  auto metadata = swift_allocateGenericValueMetadata(pattern, args);
+  auto metadataWords = reinterpret_cast<const void**>(metadata);
+  auto argsWords = reinterpret_cast<const void* const*>(args);
+  metadataWords[2] = argsWords[0];
+  return metadata;
+}
+
 GenericMetadataTest<StructMetadata> MetadataTest1 = {
   // Header
   {
     // allocation function
-    [](GenericMetadata *pattern, const void *args) -> Metadata * {
-      auto metadata = swift_allocateGenericValueMetadata(pattern, args);
-      auto metadataWords = reinterpret_cast<const void**>(metadata);
-      auto argsWords = reinterpret_cast<const void* const*>(args);
-      metadataWords[2] = argsWords[0];
-      return metadata;
-    },
+    createMetadataTest1,
     3 * sizeof(void*), // metadata size
     1, // num arguments
     0, // address point
@@ -225,6 +231,7 @@ TEST(Concurrent, ConcurrentMap) {
     int compareWithKey(size_t key) const {
       return (key == Key ? 0 : (key < Key ? -1 : 1));
     }
+    static size_t getKeyHash(size_t key) { return key; }
     static size_t getExtraAllocationSize(size_t key) { return 0; }
   };
 
@@ -289,6 +296,93 @@ TEST(MetadataTest, getGenericMetadata) {
     });
 }
 
+TEST(MetadataTest, getGenericMetadataDistinctKeys) {
+  auto metadataTemplate = (GenericMetadata*) &MetadataTest1;
+
+  // Every thread instantiates the pattern with an argument of its own, so
+  // all the entries are built concurrently.
+  static uint32_t Arguments[64];
+  std::atomic<unsigned> nextArgument(0);
+  auto results = RaceTest<const Metadata *, 64>(
+    [&]() -> const Metadata * {
+      void *args[] = { &Arguments[nextArgument++] };
+      auto inst = swift_getGenericMetadata(metadataTemplate, args);
+      auto fields = reinterpret_cast<void * const *>(inst);
+      EXPECT_EQ(args[0], fields[2]);
+      EXPECT_EQ(inst, swift_getGenericMetadata(metadataTemplate, args));
+      return inst;
+    });
+
+  std::sort(results.begin(), results.end());
+  EXPECT_EQ(results.end(), std::unique(results.begin(), results.end()));
+}
+
+uint32_t Global4 = 0;
+
+StructMetadata PrespecializedMetadataTest1 = {
+  MetadataKind::Struct,
+  reinterpret_cast<const NominalTypeDescriptor*>(&Global1),
+  nullptr
+};
+
+TEST(MetadataTest, registerGenericMetadata) {
+  auto metadataTemplate = (GenericMetadata*) &MetadataTest1;
+
+  void *args[] = { &Global4 };
+
+  // Registered metadata is returned without instantiating the pattern.
+  auto registered = swift_registerGenericMetadata(metadataTemplate, args,
+                                             &PrespecializedMetadataTest1);
+  EXPECT_EQ(&PrespecializedMetadataTest1, registered);
+
+  RaceTest_ExpectEqual<const Metadata *>(
+    [&]() -> const Metadata * {
+      auto inst = swift_getGenericMetadata(metadataTemplate, args);
+      EXPECT_EQ(&PrespecializedMetadataTest1, inst);
+      return inst;
+    });
+
+  // Registering metadata for an existing instantiation returns the
+  // instantiation.
+  args[0] = &Global2;
+  auto existing = swift_getGenericMetadata(metadataTemplate, args);
+  EXPECT_EQ(existing,
+            swift_registerGenericMetadata(metadataTemplate, args,
+                                          &PrespecializedMetadataTest1));
+}
+
+static size_t getMetadataBytesAllocated(const char *cacheName) {
+  struct Query {
+    const char *Name;
+    size_t Bytes;
+  } query = { cacheName, 0 };
+  swift_enumerateMetadataAllocations(
+    [](const char *name, size_t bytes, void *context) {
+      auto query = static_cast<Query *>(context);
+      if (strcmp(name, query->Name) == 0)
+        query->Bytes += bytes;
+    }, &query);
+  return query.Bytes;
+}
+
+TEST(MetadataTest, enumerateMetadataAllocations) {
+  auto metadataTemplate = (GenericMetadata*) &MetadataTest1;
+  void *args[] = { &Global2 };
+  swift_getGenericMetadata(metadataTemplate, args);
+
+  size_t before = getMetadataBytesAllocated("GenericCache");
+  EXPECT_NE(0u, before);
+
+  // A new instantiation is accounted to the cache, even when it is
+  // allocated from several threads at once.
+  args[0] = &Global1;
+  RaceTest_ExpectEqual<const Metadata *>(
+    [&]() -> const Metadata * {
+      return swift_getGenericMetadata(metadataTemplate, args);
+    });
+  EXPECT_LT(before, getMetadataBytesAllocated("GenericCache"));
+}
+
 FullMetadata<ClassMetadata> MetadataTest2 = {
   { { nullptr }, { &_TWVBo } },
   { { { MetadataKind::Class } }, nullptr, 0, ClassFlags(), nullptr, 0, 0, 0, 0, 0 }
@@ -553,6 +647,18 @@ ClassMetadata * const SuperclassWithPrefix_AddressPoint =
 
 static void destroySubclass(HeapObject *toDestroy) {}
 
+static Metadata *createGenericSubclass(GenericMetadata *pattern,
+                                       const void *args) {
+  auto metadata =
+    swift_allocateGenericClassMetadata(pattern, args,
+                                       SuperclassWithPrefix_AddressPoint);
+  char *bytes = (char*) metadata + sizeof(ClassMetadata);
+  auto metadataWords = reinterpret_cast<const void**>(bytes);
+  auto argsWords = reinterpret_cast<const void* const *>(args);
+  metadataWords[2] = argsWords[0];
+  return metadata;
+}
+
 struct {
   GenericMetadata Header;
   FullMetadata<ClassMetadata> Pattern;
@@ -560,16 +666,7 @@ struct {
 } GenericSubclass = {
   {
     // allocation function
-    [](GenericMetadata *pattern, const void *args) -> Metadata* {
-      auto metadata =
-        swift_allocateGenericClassMetadata(pattern, args,
-                                           SuperclassWithPrefix_AddressPoint);
-      char *bytes = (char*) metadata + sizeof(ClassMetadata);
-      auto metadataWords = reinterpret_cast<const void**>(bytes);
-      auto argsWords = reinterpret_cast<const void* const *>(args);
-      metadataWords[2] = argsWords[0];
-      return metadata;
-    },
+    createGenericSubclass,
     sizeof(GenericSubclass.Pattern) + sizeof(GenericSubclass.Suffix), // pattern size
     1, // num arguments
     sizeof(HeapMetadataHeader), // address point
@@ -789,6 +886,40 @@ TEST(MetadataTest, installCommonValueWitnesses_pod_indirect) {
   EXPECT_EQ(buf2.canary, (uintptr_t)0xA5A5A5A5U);
 }
 
+TEST(MetadataTest, getTupleTypeMetadata_commonValueWitnesses) {
+  // A POD tuple of a common size shares the builtin integer's witnesses.
+  auto podTuple = swift_getTupleTypeMetadata2(&_TMBi64_.base, &_TMBi64_.base,
+                                              nullptr, nullptr);
+  auto podWitnesses = podTuple->getValueWitnesses();
+  EXPECT_TRUE(podWitnesses->isPOD());
+  EXPECT_EQ(_TWVBi128_.initializeWithCopy, podWitnesses->initializeWithCopy);
+  EXPECT_EQ(_TWVBi128_.initializeArrayWithCopy,
+            podWitnesses->initializeArrayWithCopy);
+
+  // A bitwise-takable tuple moves overlapping arrays with memmove.
+  auto takableTuple = swift_getTupleTypeMetadata2(&_TMBo.base, &_TMBi8_.base,
+                                                  nullptr, nullptr);
+  auto takableWitnesses = takableTuple->getValueWitnesses();
+  EXPECT_FALSE(takableWitnesses->isPOD());
+  EXPECT_TRUE(takableWitnesses->isBitwiseTakable());
+  ASSERT_EQ(2 * sizeof(void*), takableWitnesses->stride);
+
+  uintptr_t words[8] = {1, 2, 3, 4, 5, 6, 0, 0};
+  takableWitnesses->initializeArrayWithTakeBackToFront(
+    reinterpret_cast<OpaqueValue *>(&words[2]),
+    reinterpret_cast<OpaqueValue *>(&words[0]), 3, takableTuple);
+  EXPECT_EQ(1U, words[2]);
+  EXPECT_EQ(3U, words[4]);
+  EXPECT_EQ(5U, words[6]);
+
+  takableWitnesses->initializeArrayWithTakeFrontToBack(
+    reinterpret_cast<OpaqueValue *>(&words[0]),
+    reinterpret_cast<OpaqueValue *>(&words[2]), 3, takableTuple);
+  EXPECT_EQ(1U, words[0]);
+  EXPECT_EQ(3U, words[2]);
+  EXPECT_EQ(5U, words[4]);
+}
+
 // We cannot construct RelativeDirectPointer instances, so define
 // a "shadow" struct for that purpose
 struct GenericWitnessTableStorage {
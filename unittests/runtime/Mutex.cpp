@@ -15,6 +15,7 @@
 #include <atomic>
 #include <chrono>
 #include <map>
+#include <mutex>
 #include <random>
 #include <thread>
 
@@ -944,3 +945,81 @@ TEST(StaticReadWriteLockTest, ReadWriteLockCacheExampleThreaded) {
   static StaticReadWriteLock lock;
   readWriteLockCacheExampleThreaded(lock);
 }
+
+// Contention benchmarks: every thread repeatedly takes the same lock to bump
+// a shared counter. They print the time per locked increment so the lock
+// implementations can be compared; only the final count is checked.
+
+template <typename M>
+void contentionBenchmark(const char *name, M &mutex) {
+  const int iterations = 100000;
+  for (int threadCount : {1, 2, 4, 8}) {
+    long counter = 0;
+    auto start = std::chrono::steady_clock::now();
+    threadedExecute(threadCount,
+                    [&](int) {
+                      for (int i = 0; i < iterations; ++i) {
+                        mutex.lock();
+                        ++counter;
+                        mutex.unlock();
+                      }
+                    },
+                    [] {});
+    auto end = std::chrono::steady_clock::now();
+
+    double nanoseconds =
+        std::chrono::duration<double, std::nano>(end - start).count();
+    printf("### %s, %d threads: %.1f ns per locked increment\n", name,
+           threadCount, nanoseconds / (threadCount * iterations));
+    ASSERT_EQ(counter, long(threadCount) * iterations);
+  }
+}
+
+TEST(MutexTest, ContentionBenchmark) {
+  Mutex mutex;
+  contentionBenchmark("Mutex", mutex);
+}
+
+TEST(StaticMutexTest, ContentionBenchmark) {
+  static StaticMutex mutex;
+  contentionBenchmark("StaticMutex", mutex);
+}
+
+TEST(StdMutexTest, ContentionBenchmark) {
+  std::mutex mutex;
+  contentionBenchmark("std::mutex", mutex);
+}
+
+// Every waiter waits for a value of its own, and each is set in turn with a
+// notifyAll, the way metadata cache entries are completed.
+TEST(MutexTest, ConditionWakeupBenchmark) {
+  const int threadCount = 8;
+  const int rounds = 1000;
+  Mutex mutex;
+  ConditionVariable condition;
+  int generation = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> waiters;
+  for (int t = 0; t < threadCount; ++t) {
+    waiters.push_back(std::thread([&, t] {
+      for (int round = 0; round < rounds; ++round) {
+        int target = round * threadCount + t + 1;
+        mutex.withLockOrWait(condition, [&] { return generation >= target; });
+      }
+    }));
+  }
+  for (int i = 0; i < threadCount * rounds; ++i) {
+    mutex.withLockThenNotifyAll(condition, [&] { ++generation; });
+  }
+  for (auto &waiter : waiters) {
+    waiter.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double nanoseconds =
+      std::chrono::duration<double, std::nano>(end - start).count();
+  printf("### ConditionVariable, %d waiters: %.1f ns per notifyAll\n",
+         threadCount, nanoseconds / (threadCount * rounds));
+  ASSERT_EQ(generation, threadCount * rounds);
+}
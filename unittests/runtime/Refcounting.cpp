@@ -246,3 +246,64 @@ TEST(RefcountingTest, nonatomic_unknown_retain_release_n) {
   EXPECT_EQ(1u, swift_retainCount(object));
 }
 
+
+TEST(RefcountingTest, immortal_retain_release) {
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+  object->refCount = StrongRefCount(StrongRefCount::Immortal);
+  uint32_t count = swift_retainCount(object);
+
+  swift_retain(object);
+  swift_retain_n(object, 32);
+  swift_nonatomic_retain(object);
+  swift_nonatomic_retain_n(object, 32);
+  EXPECT_EQ(count, swift_retainCount(object));
+
+  // Releasing an immortal object more often than it was retained never
+  // deallocates it.
+  for (unsigned i = 0; i < 4; ++i) {
+    swift_release(object);
+    swift_release_n(object, 32);
+    swift_nonatomic_release(object);
+    swift_nonatomic_release_n(object, 32);
+  }
+  EXPECT_EQ(0u, value);
+  EXPECT_EQ(count, swift_retainCount(object));
+  EXPECT_FALSE(swift_isUniquelyReferenced_nonNull_native(object));
+  EXPECT_EQ(nullptr, swift_tryPin(object));
+  EXPECT_EQ(object, swift_tryRetain(object));
+  EXPECT_EQ(count, swift_retainCount(object));
+}
+
+TEST(RefcountingTest, realloc_unique_object) {
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+
+  // A uniquely referenced object grows, keeping its contents.
+  auto grown = static_cast<TestObject *>(
+    swift_reallocUniqueObject(object, 1 << 16, alignof(TestObject) - 1));
+  EXPECT_EQ(&value, grown->Addr);
+  EXPECT_EQ(1u, grown->Value);
+  EXPECT_TRUE(swift_isUniquelyReferenced_nonNull_native(grown));
+#if SWIFT_OBJC_INTEROP
+  // Objects never move when Objective-C might know about them.
+  EXPECT_EQ(object, grown);
+#else
+  reinterpret_cast<char *>(grown)[(1 << 16) - 1] = 0;
+#endif
+
+  // Anything else that knows the object's address keeps it where it is.
+  swift_retain(grown);
+  EXPECT_EQ(grown, swift_reallocUniqueObject(grown, 1 << 17,
+                                             alignof(TestObject) - 1));
+  swift_release(grown);
+
+  swift_unownedRetain(grown);
+  EXPECT_EQ(grown, swift_reallocUniqueObject(grown, 1 << 17,
+                                             alignof(TestObject) - 1));
+  swift_unownedRelease(grown);
+
+  EXPECT_EQ(0u, value);
+  swift_release(grown);
+  EXPECT_EQ(1u, value);
+}
@@ -12,6 +12,10 @@
 
 #include <Foundation/NSObject.h>
 #include <objc/runtime.h>
+#include <malloc/malloc.h>
+#include <atomic>
+#include <thread>
+#include <vector>
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
 #include "gtest/gtest.h"
@@ -839,3 +843,81 @@ TEST(WeakTest, objc_unowned_takeAssign) {
   swift_unknownRelease(swift1);
   swift_unknownRelease(swift2);
 }
+
+static size_t getBytesInUse() {
+  malloc_statistics_t stats;
+  malloc_zone_statistics(nullptr, &stats);
+  return stats.size_in_use;
+}
+
+TEST(WeakTest, weak_doesnt_retain_memory) {
+  HeapObject *o1 = make_swift_object();
+
+  // Weak references go through the side table, not the unowned count.
+  WeakReference ref1, ref2;
+  swift_weakInit(&ref1, o1);
+  swift_weakCopyInit(&ref2, &ref1);
+  ASSERT_EQ(0U, getUnownedRetainCount(o1));
+
+  HeapObject *tmp = swift_weakLoadStrong(&ref2);
+  ASSERT_EQ(o1, tmp);
+  swift_release(tmp);
+
+  swift_release(o1);
+  ASSERT_EQ(nullptr, swift_weakLoadStrong(&ref1));
+  ASSERT_EQ(nullptr, swift_weakLoadStrong(&ref2));
+
+  swift_weakDestroy(&ref1);
+  swift_weakDestroy(&ref2);
+}
+
+TEST(WeakTest, weak_memory_retention_stress) {
+  const unsigned NumObjects = 10000;
+  const unsigned NumReaders = 4;
+
+  std::vector<HeapObject *> objects;
+  std::vector<WeakReference> refs(NumObjects * 2);
+  for (unsigned i = 0; i < NumObjects; ++i) {
+    objects.push_back(make_swift_object());
+    swift_weakInit(&refs[2 * i], objects[i]);
+    swift_weakInit(&refs[2 * i + 1], objects[i]);
+  }
+  size_t objectSize = malloc_size(objects[0]);
+  size_t bytesWithObjects = getBytesInUse();
+
+  // Release the objects while other threads keep loading the references;
+  // every load has to see either the object or nil.
+  std::atomic<bool> done(false);
+  std::atomic<unsigned> badLoads(0);
+  std::vector<std::thread> readers;
+  for (unsigned r = 0; r < NumReaders; ++r) {
+    readers.emplace_back([&] {
+      while (!done.load()) {
+        for (unsigned i = 0; i < NumObjects * 2; ++i) {
+          HeapObject *value = swift_weakLoadStrong(&refs[i]);
+          if (value && value != objects[i / 2])
+            ++badLoads;
+          swift_release(value);
+        }
+      }
+    });
+  }
+  for (unsigned i = 0; i < NumObjects; ++i)
+    swift_release(objects[i]);
+  done.store(true);
+  for (auto &reader : readers)
+    reader.join();
+
+  ASSERT_EQ(0U, badLoads.load());
+  for (auto &ref : refs)
+    ASSERT_EQ(nullptr, swift_weakLoadStrong(&ref));
+
+  // The objects' storage is gone even though the weak references aren't;
+  // only their side tables, which are smaller, are left.
+  size_t bytesWithSideTables = getBytesInUse();
+  ASSERT_LT(bytesWithSideTables + NumObjects * objectSize / 2,
+            bytesWithObjects);
+
+  for (auto &ref : refs)
+    swift_weakDestroy(&ref);
+}
@@ -70,6 +70,63 @@ HashingTestSuite.test("_mixInt/GoldenValues") {
 #endif
 }
 
+HashingTestSuite.test("_mixIntFast/GoldenValues") {
+#if arch(i386) || arch(arm)
+  expectEqual(0x25a5_6ab8, _mixIntFast(0x0))
+  expectEqual(0x6c2b_331a, _mixIntFast(0x1))
+  expectEqual(0x22e1_5da9, _mixIntFast(-1))
+#elseif arch(x86_64) || arch(arm64) || arch(powerpc64) || arch(powerpc64le) || arch(s390x)
+  expectEqual(Int(bitPattern: 0xd1d8_794e_65b4_722e), _mixIntFast(0x0))
+  expectEqual(Int(bitPattern: 0xbc5c_2fcf_ab3a_3b90), _mixIntFast(0x1))
+  expectEqual(0x1aab_3b32_e1d1_5533, _mixIntFast(-1))
+#else
+  fatalError("unimplemented")
+#endif
+}
+
+HashingTestSuite.test("_mixIntFast/LowBits") {
+  // Keys that differ only above the bits that select a bucket, like aligned
+  // pointers, should still spread over the buckets.
+  func countBuckets(_ keys: [Int], mask: Int) -> Int {
+    var buckets = Set<Int>()
+    for k in keys {
+      buckets.insert(_mixIntFast(k) & mask)
+    }
+    return buckets.count
+  }
+  let consecutive = Array(0..<768)
+  expectGE(countBuckets(consecutive, mask: 1023), 512)
+  expectGE(countBuckets(consecutive.map { $0 << 4 }, mask: 1023), 512)
+  expectGE(countBuckets(consecutive.map { $0 << 12 }, mask: 1023), 512)
+}
+
+HashingTestSuite.test("_hashTag/AlignedKeys") {
+  // Keys that only differ above their low byte, like aligned pointers,
+  // should still get different tags, so that the tags tell their entries
+  // apart.
+  func countTags(_ keys: [Int]) -> Int {
+    var tags = Set<UInt8>()
+    for k in keys {
+      let tag = _hashTag(k._mixedHashValue)
+      expectEqual(0x80, tag & 0x80)
+      tags.insert(tag)
+    }
+    return tags.count
+  }
+  let consecutive = Array(0..<1024)
+  expectGE(countTags(consecutive), 96)
+  expectGE(countTags(consecutive.map { $0 << 8 }), 96)
+  expectGE(countTags(consecutive.map { $0 << 16 }), 96)
+
+  class C {}
+  let objects = consecutive.map { _ in C() }
+  var tags = Set<UInt8>()
+  for o in objects {
+    tags.insert(_hashTag(ObjectIdentifier(o)._mixedHashValue))
+  }
+  expectGE(tags.count, 96)
+}
+
 HashingTestSuite.test("_squeezeHashValue/Int") {
   // Check that the function can return values that cover the whole range.
   func checkRange(_ r: Range<Int>) {
@@ -321,6 +321,62 @@ StringTests.test("_splitFirst") {
   expectEqual("bar", after)
 }
 
+StringTests.test("SingleASCII") {
+  // Strings of one ASCII character share static storage.
+  for value in 0..<0x80 {
+    let scalar = UnicodeScalar(UInt8(value))
+    let fromScalar = String(scalar)
+    let fromCharacter = String(Character(scalar))
+    expectEqual(1, fromScalar.utf8.count)
+    expectEqual(UInt8(value), fromScalar.utf8.first!)
+    expectEqual(fromScalar, fromCharacter)
+    expectEqual(fromScalar.hashValue, fromCharacter.hashValue)
+    expectNil(fromScalar._core._owner)
+    expectNil(fromCharacter._core._owner)
+  }
+
+  // Mutating one of them copies it out of the shared storage.
+  var s = String(Character("a"))
+  s.append("b")
+  s += String(UnicodeScalar("c"))
+  expectEqual("abc", s)
+  expectEqual("a", String(Character("a")))
+  expectEqual("c", String(UnicodeScalar("c")))
+
+  // Other characters still get their own storage.
+  expectEqual("\u{e9}", String(Character("\u{e9}")))
+  expectEqual("\r\n", String(Character("\r\n")))
+}
+
+StringTests.test("decodeCString/LongRuns") {
+  // Long enough to take the vector paths for ASCII runs, with multi-byte
+  // sequences of every length in between.
+  let ascii = String(repeating: "x" as UnicodeScalar, count: 37)
+  let expected = ascii + "\u{e9}" + ascii + "\u{20ac}" + ascii + "\u{1f600}"
+    + ascii
+  var utf8 = Array(expected.utf8)
+  utf8.append(0)
+  let decoded = utf8.withUnsafeBufferPointer {
+    String.decodeCString($0.baseAddress, as: UTF8.self,
+      repairingInvalidCodeUnits: false)
+  }
+  expectEqual(expected, decoded!.result)
+  expectFalse(decoded!.repairsMade)
+  expectEqual(Array(expected.utf16), Array(decoded!.result.utf16))
+
+  // An ill-formed sequence after a long ASCII run is still found.
+  utf8[ascii.utf8.count + 1] = 0xff
+  let repaired = utf8.withUnsafeBufferPointer {
+    String.decodeCString($0.baseAddress, as: UTF8.self)
+  }
+  expectTrue(repaired!.repairsMade)
+  let rejected = utf8.withUnsafeBufferPointer {
+    String.decodeCString($0.baseAddress, as: UTF8.self,
+      repairingInvalidCodeUnits: false)
+  }
+  expectNil(rejected)
+}
+
 StringTests.test("hasPrefix")
   .skip(.nativeRuntime("String.hasPrefix undefined without _runtime(_ObjC)"))
   .code {